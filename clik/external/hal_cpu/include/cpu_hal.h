@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "hal.h"
+#include "hal_async_queue.h"
 
 #define HAL_CPU_WI_MODE 1
 #define HAL_CPU_WG_MODE 2
@@ -44,9 +45,7 @@ struct cpu_barrier {
 class cpu_hal final : public hal::hal_device_t {
  public:
   cpu_hal(hal::hal_device_info_t *info, std::mutex &hal_lock);
-#if HAL_CPU_MODE == HAL_CPU_WI_MODE
   ~cpu_hal();
-#endif
 
   // Set up the hal device info - this is done as a static so that other classes
   // such as hal_client can set up the desired information directly
@@ -98,9 +97,55 @@ class cpu_hal final : public hal::hal_device_t {
   bool mem_write(hal::hal_addr_t dst, const void *src,
                  hal::hal_size_t size) override;
 
+  // kernels and memory transfers run on separate submission queues
+  bool async_supported() const override { return true; }
+
+  hal::hal_event_t mem_write_async(hal::hal_addr_t dst, const void *src,
+                                   hal::hal_size_t size,
+                                   const hal::hal_event_t *wait_events,
+                                   uint32_t num_wait_events) override;
+
+  hal::hal_event_t mem_read_async(void *dst, hal::hal_addr_t src,
+                                  hal::hal_size_t size,
+                                  const hal::hal_event_t *wait_events,
+                                  uint32_t num_wait_events) override;
+
+  hal::hal_event_t mem_copy_async(hal::hal_addr_t dst, hal::hal_addr_t src,
+                                  hal::hal_size_t size,
+                                  const hal::hal_event_t *wait_events,
+                                  uint32_t num_wait_events) override;
+
+  hal::hal_event_t mem_fill_async(hal::hal_addr_t dst, const void *pattern,
+                                  hal::hal_size_t pattern_size,
+                                  hal::hal_size_t size,
+                                  const hal::hal_event_t *wait_events,
+                                  uint32_t num_wait_events) override;
+
+  hal::hal_event_t kernel_exec_async(hal::hal_program_t program,
+                                     hal::hal_kernel_t kernel,
+                                     const hal::hal_ndrange_t *nd_range,
+                                     const hal::hal_arg_t *args,
+                                     uint32_t num_args, uint32_t work_dim,
+                                     const hal::hal_event_t *wait_events,
+                                     uint32_t num_wait_events) override;
+
+  bool event_wait(hal::hal_event_t event) override;
+
+  void event_release(hal::hal_event_t event) override;
+
  private:
+  enum : uint32_t { compute_queue = 0, transfer_queue = 1, num_queues = 2 };
+
   void kernel_entry(exec_state *state);
 
+  // Transfers without taking the HAL lock, used directly by the asynchronous
+  // transfer queue so that it can overlap with kernel execution.
+  bool copy_unlocked(hal::hal_addr_t dst, hal::hal_addr_t src,
+                     hal::hal_size_t size);
+  bool read_unlocked(void *dst, hal::hal_addr_t src, hal::hal_size_t size);
+  bool write_unlocked(hal::hal_addr_t dst, const void *src,
+                      hal::hal_size_t size);
+
   bool hal_debug() const { return debug; }
 
   std::mutex &hal_lock;
@@ -115,6 +160,10 @@ class cpu_hal final : public hal::hal_device_t {
 
   // Default number of threads for wg mode
   unsigned int wg_num_threads;
+
+  // Destroyed first so that no operation is running when the rest of the
+  // device is torn down
+  std::unique_ptr<hal::util::hal_async_queue_t> async_queue;
 };
 
 #endif
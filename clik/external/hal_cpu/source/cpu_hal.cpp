@@ -74,7 +74,9 @@ hal::hal_device_info_t &cpu_hal::setup_cpu_hal_device_info() {
 }
 
 cpu_hal::cpu_hal(hal::hal_device_info_t *info, std::mutex &hal_lock)
-    : hal::hal_device_t(info), hal_lock(hal_lock) {
+    : hal::hal_device_t(info),
+      hal_lock(hal_lock),
+      async_queue(new hal::util::hal_async_queue_t(num_queues)) {
 #if HAL_CPU_MODE == HAL_CPU_WI_MODE
   // Align local memory to 128 bytes as that is the largest data type
   // in OpenCL and we need any values placed in local memory to fit that
@@ -98,9 +100,13 @@ cpu_hal::cpu_hal(hal::hal_device_info_t *info, std::mutex &hal_lock)
 #endif
 }
 
+cpu_hal::~cpu_hal() {
+  // Complete any outstanding asynchronous operations first.
+  async_queue.reset();
 #if HAL_CPU_MODE == HAL_CPU_WI_MODE
-cpu_hal::~cpu_hal() { std::free(local_mem); }
+  std::free(local_mem);
 #endif
+}
 
 hal::hal_kernel_t cpu_hal::program_find_kernel(hal::hal_program_t program,
                                                const char *name) {
@@ -370,6 +376,11 @@ bool cpu_hal::mem_free(hal::hal_addr_t addr) {
 bool cpu_hal::mem_copy(hal::hal_addr_t dst, hal::hal_addr_t src,
                        hal::hal_size_t size) {
   std::lock_guard<std::mutex> locker(hal_lock);
+  return copy_unlocked(dst, src, size);
+}
+
+bool cpu_hal::copy_unlocked(hal::hal_addr_t dst, hal::hal_addr_t src,
+                            hal::hal_size_t size) {
   if (hal_debug()) {
     fprintf(stderr,
             "cpu_hal::mem_copy(dst=0x%08lx, src=0x%08lx, "
@@ -382,6 +393,11 @@ bool cpu_hal::mem_copy(hal::hal_addr_t dst, hal::hal_addr_t src,
 
 bool cpu_hal::mem_read(void *dst, hal::hal_addr_t src, hal::hal_size_t size) {
   std::lock_guard<std::mutex> locker(hal_lock);
+  return read_unlocked(dst, src, size);
+}
+
+bool cpu_hal::read_unlocked(void *dst, hal::hal_addr_t src,
+                            hal::hal_size_t size) {
   if (hal_debug()) {
     fprintf(stderr, "cpu_hal::mem_read(src=0x%08lx, size=%ld)\n", src, size);
   }
@@ -395,6 +411,11 @@ bool cpu_hal::mem_read(void *dst, hal::hal_addr_t src, hal::hal_size_t size) {
 bool cpu_hal::mem_write(hal::hal_addr_t dst, const void *src,
                         hal::hal_size_t size) {
   std::lock_guard<std::mutex> locker(hal_lock);
+  return write_unlocked(dst, src, size);
+}
+
+bool cpu_hal::write_unlocked(hal::hal_addr_t dst, const void *src,
+                             hal::hal_size_t size) {
   if (hal_debug()) {
     fprintf(stderr, "cpu_hal::mem_write(dst=0x%08lx, size=%ld)\n", dst, size);
   }
@@ -424,3 +445,79 @@ bool cpu_hal::mem_fill(hal::hal_addr_t dst, const void *pattern,
   }
   return true;
 }
+
+// Memory transfers only touch the memory they are given so they run on their
+// own queue, without taking the HAL lock, to overlap with kernel execution.
+hal::hal_event_t cpu_hal::mem_write_async(hal::hal_addr_t dst, const void *src,
+                                          hal::hal_size_t size,
+                                          const hal::hal_event_t *wait_events,
+                                          uint32_t num_wait_events) {
+  return async_queue->submit(
+      transfer_queue, [=]() { return write_unlocked(dst, src, size); },
+      wait_events, num_wait_events);
+}
+
+hal::hal_event_t cpu_hal::mem_read_async(void *dst, hal::hal_addr_t src,
+                                         hal::hal_size_t size,
+                                         const hal::hal_event_t *wait_events,
+                                         uint32_t num_wait_events) {
+  return async_queue->submit(
+      transfer_queue, [=]() { return read_unlocked(dst, src, size); },
+      wait_events, num_wait_events);
+}
+
+hal::hal_event_t cpu_hal::mem_copy_async(hal::hal_addr_t dst,
+                                         hal::hal_addr_t src,
+                                         hal::hal_size_t size,
+                                         const hal::hal_event_t *wait_events,
+                                         uint32_t num_wait_events) {
+  return async_queue->submit(
+      transfer_queue, [=]() { return copy_unlocked(dst, src, size); },
+      wait_events, num_wait_events);
+}
+
+hal::hal_event_t cpu_hal::mem_fill_async(hal::hal_addr_t dst,
+                                         const void *pattern,
+                                         hal::hal_size_t pattern_size,
+                                         hal::hal_size_t size,
+                                         const hal::hal_event_t *wait_events,
+                                         uint32_t num_wait_events) {
+  if (!pattern) {
+    return hal::hal_invalid_event;
+  }
+  auto pattern_copy = std::make_shared<std::vector<uint8_t>>(
+      (const uint8_t *)pattern, (const uint8_t *)pattern + pattern_size);
+  return async_queue->submit(
+      transfer_queue,
+      [=]() {
+        return mem_fill(dst, pattern_copy->data(), pattern_size, size);
+      },
+      wait_events, num_wait_events);
+}
+
+hal::hal_event_t cpu_hal::kernel_exec_async(
+    hal::hal_program_t program, hal::hal_kernel_t kernel,
+    const hal::hal_ndrange_t *nd_range, const hal::hal_arg_t *args,
+    uint32_t num_args, uint32_t work_dim, const hal::hal_event_t *wait_events,
+    uint32_t num_wait_events) {
+  if (!nd_range || (num_args > 0 && !args)) {
+    return hal::hal_invalid_event;
+  }
+  const hal::hal_ndrange_t nd_range_copy = *nd_range;
+  auto args_copy = std::make_shared<hal::util::hal_arg_copy_t>(args, num_args);
+  return async_queue->submit(
+      compute_queue,
+      [=]() {
+        return kernel_exec(program, kernel, &nd_range_copy, args_copy->data(),
+                           args_copy->size(), work_dim);
+      },
+      wait_events, num_wait_events);
+}
+
+bool cpu_hal::event_wait(hal::hal_event_t event) {
+  return async_queue->wait(event);
+}
+
+void cpu_hal::event_release(hal::hal_event_t event) {
+  async_queue->release(event);
+}
@@ -18,10 +18,12 @@
 #define _HAL_DEVICE_CLIENT_H
 
 #include <hal.h>
+#include <hal_async_queue.h>
 #include <hal_remote/hal_binary_decoder.h>
 #include <hal_remote/hal_transmitter.h>
 #include <hal_types.h>
 
+#include <memory>
 #include <mutex>
 
 namespace hal {
@@ -42,6 +44,9 @@ class hal_device_client : public hal::hal_device_t {
   hal_device_client(hal::hal_device_info_t *info, std::mutex &hal_lock,
                     hal::hal_transmitter *transmitter);
 
+  // @brief complete any outstanding asynchronous operations
+  ~hal_device_client() override;
+
   // @brief find program kernel based on `name`
   hal::hal_kernel_t program_find_kernel(hal::hal_program_t program,
                                         const char *name) override;
@@ -83,6 +88,44 @@ class hal_device_client : public hal::hal_device_t {
   // @brief write host memory to the target
   bool mem_write(hal::hal_addr_t dst, const void *src,
                  hal::hal_size_t size) override;
+
+  // @brief requests are sent to the server from a submission queue so the
+  // caller is not blocked on the transmitter
+  bool async_supported() const override { return true; }
+
+  hal::hal_event_t mem_write_async(hal::hal_addr_t dst, const void *src,
+                                   hal::hal_size_t size,
+                                   const hal::hal_event_t *wait_events,
+                                   uint32_t num_wait_events) override;
+
+  hal::hal_event_t mem_read_async(void *dst, hal::hal_addr_t src,
+                                  hal::hal_size_t size,
+                                  const hal::hal_event_t *wait_events,
+                                  uint32_t num_wait_events) override;
+
+  hal::hal_event_t mem_copy_async(hal::hal_addr_t dst, hal::hal_addr_t src,
+                                  hal::hal_size_t size,
+                                  const hal::hal_event_t *wait_events,
+                                  uint32_t num_wait_events) override;
+
+  hal::hal_event_t mem_fill_async(hal::hal_addr_t dst, const void *pattern,
+                                  hal::hal_size_t pattern_size,
+                                  hal::hal_size_t size,
+                                  const hal::hal_event_t *wait_events,
+                                  uint32_t num_wait_events) override;
+
+  hal::hal_event_t kernel_exec_async(hal::hal_program_t program,
+                                     hal::hal_kernel_t kernel,
+                                     const hal::hal_ndrange_t *nd_range,
+                                     const hal::hal_arg_t *args,
+                                     uint32_t num_args, uint32_t work_dim,
+                                     const hal::hal_event_t *wait_events,
+                                     uint32_t num_wait_events) override;
+
+  bool event_wait(hal::hal_event_t event) override;
+
+  void event_release(hal::hal_event_t event) override;
+
   bool hal_debug() { return debug; }
 
  protected:
@@ -94,6 +137,9 @@ class hal_device_client : public hal::hal_device_t {
   hal::hal_transmitter *transmitter;
   bool debug = false;
   std::mutex &hal_lock;
+  /// @brief The server handles one request at a time, so a single in-order
+  /// queue is used for all asynchronous operations.
+  std::unique_ptr<hal::util::hal_async_queue_t> async_queue;
 };
 }  // namespace hal
 #endif
@@ -22,12 +22,17 @@ namespace hal {
 hal_device_client::hal_device_client(hal::hal_device_info_t *info,
                                      std::mutex &hal_lock,
                                      hal::hal_transmitter *transmitter)
-    : hal::hal_device_t(info), transmitter(transmitter), hal_lock(hal_lock) {
+    : hal::hal_device_t(info),
+      transmitter(transmitter),
+      hal_lock(hal_lock),
+      async_queue(new hal::util::hal_async_queue_t(1)) {
   if (const char *env = getenv("CA_HAL_DEBUG")) {
     if (*env == '1') debug = true;
   }
 }
 
+hal_device_client::~hal_device_client() { async_queue.reset(); }
+
 hal::hal_addr_t hal_device_client::mem_alloc(hal::hal_size_t size,
                                              hal::hal_size_t alignment) {
   const std::lock_guard<std::mutex> locker(hal_lock);
@@ -226,6 +231,75 @@ bool hal_device_client::mem_read(void *dst, hal::hal_addr_t src,
   return ok;
 }
 
+hal::hal_event_t hal_device_client::mem_write_async(
+    hal::hal_addr_t dst, const void *src, hal::hal_size_t size,
+    const hal::hal_event_t *wait_events, uint32_t num_wait_events) {
+  return async_queue->submit(
+      0, [=]() { return mem_write(dst, src, size); }, wait_events,
+      num_wait_events);
+}
+
+hal::hal_event_t hal_device_client::mem_read_async(
+    void *dst, hal::hal_addr_t src, hal::hal_size_t size,
+    const hal::hal_event_t *wait_events, uint32_t num_wait_events) {
+  return async_queue->submit(
+      0, [=]() { return mem_read(dst, src, size); }, wait_events,
+      num_wait_events);
+}
+
+hal::hal_event_t hal_device_client::mem_copy_async(
+    hal::hal_addr_t dst, hal::hal_addr_t src, hal::hal_size_t size,
+    const hal::hal_event_t *wait_events, uint32_t num_wait_events) {
+  return async_queue->submit(
+      0, [=]() { return mem_copy(dst, src, size); }, wait_events,
+      num_wait_events);
+}
+
+hal::hal_event_t hal_device_client::mem_fill_async(
+    hal::hal_addr_t dst, const void *pattern, hal::hal_size_t pattern_size,
+    hal::hal_size_t size, const hal::hal_event_t *wait_events,
+    uint32_t num_wait_events) {
+  if (!pattern) {
+    return hal::hal_invalid_event;
+  }
+  auto pattern_copy = std::make_shared<std::vector<uint8_t>>(
+      static_cast<const uint8_t *>(pattern),
+      static_cast<const uint8_t *>(pattern) + pattern_size);
+  return async_queue->submit(
+      0,
+      [=]() {
+        return mem_fill(dst, pattern_copy->data(), pattern_size, size);
+      },
+      wait_events, num_wait_events);
+}
+
+hal::hal_event_t hal_device_client::kernel_exec_async(
+    hal::hal_program_t program, hal::hal_kernel_t kernel,
+    const hal::hal_ndrange_t *nd_range, const hal::hal_arg_t *args,
+    uint32_t num_args, uint32_t work_dim, const hal::hal_event_t *wait_events,
+    uint32_t num_wait_events) {
+  if (!nd_range || (num_args > 0 && !args)) {
+    return hal::hal_invalid_event;
+  }
+  const hal::hal_ndrange_t nd_range_copy = *nd_range;
+  auto args_copy = std::make_shared<hal::util::hal_arg_copy_t>(args, num_args);
+  return async_queue->submit(
+      0,
+      [=]() {
+        return kernel_exec(program, kernel, &nd_range_copy, args_copy->data(),
+                           args_copy->size(), work_dim);
+      },
+      wait_events, num_wait_events);
+}
+
+bool hal_device_client::event_wait(hal::hal_event_t event) {
+  return async_queue->wait(event);
+}
+
+void hal_device_client::event_release(hal::hal_event_t event) {
+  async_queue->release(event);
+}
+
 bool hal_device_client::receive_decode_reply(
     hal_binary_encoder::COMMAND expected_command, hal_binary_decoder &decoder) {
   hal_binary_encoder::COMMAND command;
@@ -206,6 +206,174 @@ struct hal_device_t {
   /// @param enable True to enable counter support, false to disable
   virtual void counter_set_enabled(bool enable) { (void)enable; };
 
+  /// @brief Query whether the `*_async` entry points are backed by submission
+  /// queues which execute operations concurrently with the caller.
+  ///
+  /// The default implementations of the `*_async` functions are a blocking
+  /// adapter over the synchronous API, so callers may use them with any HAL.
+  /// Callers should only go to the effort of pipelining work when this
+  /// returns `true`.
+  ///
+  /// @return Returns `true` if operations may overlap, otherwise `false`.
+  virtual bool async_supported() const { return false; }
+
+  /// @brief Asynchronously write host memory to the target.
+  ///
+  /// @param dst device address which is the write destination.
+  /// @param src host address which is the source memory location, it must
+  /// remain valid until the returned event has completed.
+  /// @param size is the number of bytes to be written.
+  /// @param wait_events is a list of events which must complete successfully
+  /// before the operation starts.
+  /// @param num_wait_events is the number of events in `wait_events`.
+  ///
+  /// @return Returns `hal_invalid_event` if the operation could not be
+  /// submitted, otherwise an event which must be released with
+  /// `event_release`.
+  virtual hal_event_t mem_write_async(hal_addr_t dst, const void *src,
+                                      hal_size_t size,
+                                      const hal_event_t *wait_events,
+                                      uint32_t num_wait_events) {
+    if (!wait_all(wait_events, num_wait_events)) {
+      return hal_invalid_event;
+    }
+    return mem_write(dst, src, size) ? hal_completed_event : hal_invalid_event;
+  }
+
+  /// @brief Asynchronously read memory from the target to the host.
+  ///
+  /// @param dst host address which is the read destination, it must remain
+  /// valid until the returned event has completed.
+  /// @param src device address which is the source memory location.
+  /// @param size is the number of bytes to be read.
+  /// @param wait_events is a list of events which must complete successfully
+  /// before the operation starts.
+  /// @param num_wait_events is the number of events in `wait_events`.
+  ///
+  /// @return Returns `hal_invalid_event` if the operation could not be
+  /// submitted, otherwise an event which must be released with
+  /// `event_release`.
+  virtual hal_event_t mem_read_async(void *dst, hal_addr_t src, hal_size_t size,
+                                     const hal_event_t *wait_events,
+                                     uint32_t num_wait_events) {
+    if (!wait_all(wait_events, num_wait_events)) {
+      return hal_invalid_event;
+    }
+    return mem_read(dst, src, size) ? hal_completed_event : hal_invalid_event;
+  }
+
+  /// @brief Asynchronously copy memory between target buffers.
+  ///
+  /// @param dst device address which is the copy destination.
+  /// @param src device address which is the copy source.
+  /// @param size is the total number of bytes to be transferred.
+  /// @param wait_events is a list of events which must complete successfully
+  /// before the operation starts.
+  /// @param num_wait_events is the number of events in `wait_events`.
+  ///
+  /// @return Returns `hal_invalid_event` if the operation could not be
+  /// submitted, otherwise an event which must be released with
+  /// `event_release`.
+  virtual hal_event_t mem_copy_async(hal_addr_t dst, hal_addr_t src,
+                                     hal_size_t size,
+                                     const hal_event_t *wait_events,
+                                     uint32_t num_wait_events) {
+    if (!wait_all(wait_events, num_wait_events)) {
+      return hal_invalid_event;
+    }
+    return mem_copy(dst, src, size) ? hal_completed_event : hal_invalid_event;
+  }
+
+  /// @brief Asynchronously fill memory with a repeating pattern.
+  ///
+  /// @param dst device address which is the fill destination.
+  /// @param pattern host address of the pattern, it is copied before this
+  /// function returns.
+  /// @param pattern_size is the number of bytes in the memory pattern.
+  /// @param size is the total number of bytes to be written.
+  /// @param wait_events is a list of events which must complete successfully
+  /// before the operation starts.
+  /// @param num_wait_events is the number of events in `wait_events`.
+  ///
+  /// @return Returns `hal_invalid_event` if the operation could not be
+  /// submitted, otherwise an event which must be released with
+  /// `event_release`.
+  virtual hal_event_t mem_fill_async(hal_addr_t dst, const void *pattern,
+                                     hal_size_t pattern_size, hal_size_t size,
+                                     const hal_event_t *wait_events,
+                                     uint32_t num_wait_events) {
+    if (!wait_all(wait_events, num_wait_events)) {
+      return hal_invalid_event;
+    }
+    return mem_fill(dst, pattern, pattern_size, size) ? hal_completed_event
+                                                      : hal_invalid_event;
+  }
+
+  /// @brief Asynchronously execute a kernel on the target.
+  ///
+  /// @param program is a handle to a previously loaded program, it must not be
+  /// freed until the returned event has completed.
+  /// @param kernel is a handle to a previously found kernel.
+  /// @param nd_range contains the work range to execute, it is copied before
+  /// this function returns.
+  /// @param args is a list of argument descriptors for the kernel, they and
+  /// the data they point to are copied before this function returns.
+  /// @param num_args is the number of argument descriptors provided.
+  /// @param work_dim specifies the work dimension for execution (1, 2 or 3).
+  /// @param wait_events is a list of events which must complete successfully
+  /// before the kernel starts.
+  /// @param num_wait_events is the number of events in `wait_events`.
+  ///
+  /// @return Returns `hal_invalid_event` if the operation could not be
+  /// submitted, otherwise an event which must be released with
+  /// `event_release`.
+  virtual hal_event_t kernel_exec_async(
+      hal_program_t program, hal_kernel_t kernel, const hal_ndrange_t *nd_range,
+      const hal_arg_t *args, uint32_t num_args, uint32_t work_dim,
+      const hal_event_t *wait_events, uint32_t num_wait_events) {
+    if (!wait_all(wait_events, num_wait_events)) {
+      return hal_invalid_event;
+    }
+    return kernel_exec(program, kernel, nd_range, args, num_args, work_dim)
+               ? hal_completed_event
+               : hal_invalid_event;
+  }
+
+  /// @brief Block until an asynchronous operation has completed.
+  ///
+  /// An event may be waited on any number of times until it is released.
+  /// An operation fails if any of the events it waited on failed.
+  ///
+  /// @param event is an event returned by one of the `*_async` functions.
+  ///
+  /// @return Returns `true` if the operation completed successfully, `false`
+  /// if it failed or `event` is not a valid event.
+  virtual bool event_wait(hal_event_t event) {
+    return event == hal_completed_event;
+  }
+
+  /// @brief Release an event returned by one of the `*_async` functions.
+  ///
+  /// Releasing an event does not wait for or cancel the operation, which still
+  /// runs to completion. Operations which were submitted with the event in
+  /// their wait list are unaffected, but the event must not be passed to any
+  /// further HAL calls.
+  ///
+  /// @param event is the event to release.
+  virtual void event_release(hal_event_t event) { (void)event; }
+
+ protected:
+  /// @brief Wait for every event in a list, used by the blocking adapter.
+  ///
+  /// @return Returns `false` if any event failed, otherwise `true`.
+  bool wait_all(const hal_event_t *events, uint32_t num_events) {
+    bool success = true;
+    for (uint32_t i = 0; i < num_events; i++) {
+      success &= event_wait(events[i]);
+    }
+    return success;
+  }
+
  private:
   /// @brief device_info is the default hal_device_info_t structure provided by
   /// the hal when this device was instanciated. it is returned by the base
@@ -218,7 +386,7 @@ struct hal_device_t {
 struct hal_t {
   /// @brief Current version of the HAL API. The version number needs to be
   /// bumped any time the interface is changed.
-  static constexpr uint32_t api_version = 6;
+  static constexpr uint32_t api_version = 7;
 
   /// @brief Return generic platform information.
   ///
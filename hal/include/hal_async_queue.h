@@ -0,0 +1,150 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief This is a utility class to assist a HAL implementation provide the
+/// `*_async` entry points of `hal_device_t`. It is optional and a HAL
+/// implementation is not required to use it.
+
+#ifndef HAL_ASYNC_QUEUE_H_INCLUDED
+#define HAL_ASYNC_QUEUE_H_INCLUDED
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "hal_types.h"
+
+namespace hal {
+/// @addtogroup hal
+/// @{
+
+namespace util {
+/// @addtogroup util
+/// @{
+
+/// @brief A set of in-order submission queues, each serviced by its own worker
+/// thread.
+///
+/// Operations submitted to the same queue run in submission order, operations
+/// on different queues only wait for each other through their event lists.
+/// A HAL would typically use one queue per independent engine on the device,
+/// e.g. one for kernel execution and one for DMA transfers.
+class hal_async_queue_t {
+ public:
+  /// @brief An operation to execute, returns `false` on failure.
+  using operation_t = std::function<bool()>;
+
+  /// @brief Constructor.
+  ///
+  /// @param num_queues is the number of submission queues to create.
+  explicit hal_async_queue_t(uint32_t num_queues);
+
+  /// @brief Destructor, completes all submitted operations.
+  ~hal_async_queue_t();
+
+  hal_async_queue_t(const hal_async_queue_t &) = delete;
+  hal_async_queue_t &operator=(const hal_async_queue_t &) = delete;
+
+  /// @brief Submit an operation to one of the queues.
+  ///
+  /// @param queue is the index of the queue to submit to.
+  /// @param operation is the operation to execute.
+  /// @param wait_events is a list of events which must complete before the
+  /// operation starts, the operation fails without running if any of them
+  /// failed.
+  /// @param num_wait_events is the number of events in `wait_events`.
+  ///
+  /// @return Returns `hal_invalid_event` if any of the wait events is invalid,
+  /// otherwise an event identifying the operation.
+  hal_event_t submit(uint32_t queue, operation_t operation,
+                     const hal_event_t *wait_events, uint32_t num_wait_events);
+
+  /// @brief Block until an operation has completed.
+  ///
+  /// @param event is an event returned by `submit`.
+  ///
+  /// @return Returns `true` if the operation succeeded, `false` if it failed
+  /// or `event` is not a valid event.
+  bool wait(hal_event_t event);
+
+  /// @brief Release an event, the operation itself is not affected.
+  ///
+  /// @param event is an event returned by `submit`.
+  void release(hal_event_t event);
+
+ private:
+  struct state_t {
+    bool complete = false;
+    bool success = false;
+  };
+
+  struct work_t {
+    std::shared_ptr<state_t> state;
+    operation_t operation;
+    std::vector<std::shared_ptr<state_t>> dependencies;
+  };
+
+  /// @brief Worker thread body servicing a single queue.
+  void run(uint32_t queue);
+
+  std::mutex mutex;
+  std::condition_variable condition_variable;
+  std::vector<std::deque<work_t>> queues;
+  std::unordered_map<hal_event_t, std::shared_ptr<state_t>> events;
+  hal_event_t next_event = hal_completed_event + 1;
+  bool terminate = false;
+  std::vector<std::thread> threads;
+};
+
+/// @brief A deep copy of a list of kernel argument descriptors, including the
+/// POD data they point to, for use once the caller's storage has gone away.
+class hal_arg_copy_t {
+ public:
+  /// @brief Constructor.
+  ///
+  /// @param args is an array of HAL argument descriptors.
+  /// @param num_args the number of argument descriptors provided.
+  hal_arg_copy_t(const hal_arg_t *args, uint32_t num_args);
+
+  hal_arg_copy_t(const hal_arg_copy_t &) = delete;
+  hal_arg_copy_t &operator=(const hal_arg_copy_t &) = delete;
+
+  /// @brief Returns the copied argument descriptors.
+  const hal_arg_t *data() const { return args.data(); }
+
+  /// @brief Returns the number of copied argument descriptors.
+  uint32_t size() const { return static_cast<uint32_t>(args.size()); }
+
+ private:
+  std::vector<hal_arg_t> args;
+  std::vector<uint8_t> pod_data;
+};
+
+/// @}
+}  // namespace util
+
+/// @}
+}  // namespace hal
+
+#endif  // HAL_ASYNC_QUEUE_H_INCLUDED
@@ -38,11 +38,17 @@ typedef uint64_t hal_word_t;
 typedef uint64_t hal_program_t;
 /// @brief A unique handle identifying a kernel.
 typedef uint64_t hal_kernel_t;
+/// @brief A handle identifying an asynchronously submitted operation.
+typedef uint64_t hal_event_t;
 
 enum {
   hal_nullptr = 0,
   hal_invalid_program = 0,
   hal_invalid_kernel = 0,
+  hal_invalid_event = 0,
+  /// @brief Event returned for operations which completed successfully before
+  /// being returned to the caller. It never needs to be waited on or released.
+  hal_completed_event = 1,
 };
 
 enum hal_arg_kind_t {
@@ -0,0 +1,162 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "hal_async_queue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace hal {
+/// @addtogroup hal
+/// @{
+
+namespace util {
+/// @addtogroup util
+/// @{
+
+hal_async_queue_t::hal_async_queue_t(uint32_t num_queues)
+    : queues(std::max<uint32_t>(num_queues, 1)) {
+  for (uint32_t queue = 0; queue < queues.size(); queue++) {
+    threads.emplace_back([this, queue]() { run(queue); });
+  }
+}
+
+hal_async_queue_t::~hal_async_queue_t() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    terminate = true;
+    condition_variable.notify_all();
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+hal_event_t hal_async_queue_t::submit(uint32_t queue, operation_t operation,
+                                      const hal_event_t *wait_events,
+                                      uint32_t num_wait_events) {
+  work_t work;
+  work.state = std::make_shared<state_t>();
+  work.operation = std::move(operation);
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  for (uint32_t i = 0; i < num_wait_events; i++) {
+    if (wait_events[i] == hal_completed_event) {
+      continue;
+    }
+    auto found = events.find(wait_events[i]);
+    if (found == events.end()) {
+      return hal_invalid_event;
+    }
+    if (!found->second->complete || !found->second->success) {
+      work.dependencies.push_back(found->second);
+    }
+  }
+
+  const hal_event_t event = next_event++;
+  events[event] = work.state;
+  queues[std::min<size_t>(queue, queues.size() - 1)].push_back(
+      std::move(work));
+  condition_variable.notify_all();
+  return event;
+}
+
+bool hal_async_queue_t::wait(hal_event_t event) {
+  if (event == hal_completed_event) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  auto found = events.find(event);
+  if (found == events.end()) {
+    return false;
+  }
+  // Keep the state alive in case the event is released while waiting.
+  const std::shared_ptr<state_t> state = found->second;
+  condition_variable.wait(lock, [&state]() { return state->complete; });
+  return state->success;
+}
+
+void hal_async_queue_t::release(hal_event_t event) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  events.erase(event);
+}
+
+void hal_async_queue_t::run(uint32_t queue) {
+  auto &pending = queues[queue];
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    condition_variable.wait(
+        lock, [&]() { return terminate || !pending.empty(); });
+    if (pending.empty()) {
+      // Only exit once everything submitted has been executed.
+      break;
+    }
+
+    // Operations only ever depend on earlier submissions, so waiting for the
+    // head of this queue can't deadlock with the other queues.
+    work_t &head = pending.front();
+    condition_variable.wait(lock, [&head]() {
+      return std::all_of(head.dependencies.begin(), head.dependencies.end(),
+                         [](const std::shared_ptr<state_t> &dependency) {
+                           return dependency->complete;
+                         });
+    });
+    const bool dependencies_succeeded =
+        std::all_of(head.dependencies.begin(), head.dependencies.end(),
+                    [](const std::shared_ptr<state_t> &dependency) {
+                      return dependency->success;
+                    });
+    work_t work = std::move(head);
+    pending.pop_front();
+
+    lock.unlock();
+    const bool success = dependencies_succeeded && work.operation();
+    // Destroy the operation's captured state outside of the lock.
+    work.operation = nullptr;
+    work.dependencies.clear();
+    lock.lock();
+
+    work.state->success = success;
+    work.state->complete = true;
+    condition_variable.notify_all();
+  }
+}
+
+hal_arg_copy_t::hal_arg_copy_t(const hal_arg_t *args, uint32_t num_args)
+    : args(args, args + num_args) {
+  size_t pod_size = 0;
+  for (const hal_arg_t &arg : this->args) {
+    if (arg.kind == hal_arg_value) {
+      pod_size += arg.size;
+    }
+  }
+  pod_data.resize(pod_size);
+  size_t offset = 0;
+  for (hal_arg_t &arg : this->args) {
+    if (arg.kind == hal_arg_value && arg.size) {
+      std::memcpy(pod_data.data() + offset, arg.pod_data, arg.size);
+      arg.pod_data = pod_data.data() + offset;
+      offset += arg.size;
+    }
+  }
+}
+
+/// @}
+}  // namespace util
+
+/// @}
+}  // namespace hal
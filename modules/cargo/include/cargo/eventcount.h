@@ -0,0 +1,176 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Spin then block waiting for a condition on shared state.
+
+#ifndef CARGO_EVENTCOUNT_H_INCLUDED
+#define CARGO_EVENTCOUNT_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef __linux__
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace cargo {
+/// @brief Lets threads wait for a predicate on some shared state to become
+/// true, without a mutex guarding the state.
+///
+/// Waiters first spin on the predicate for a bounded number of iterations,
+/// then block on a futex (or a condition variable where futexes aren't
+/// available). The spin bound adapts, growing while spinning keeps succeeding
+/// and shrinking when it doesn't. Any change to the shared state which can
+/// make a waited for predicate true must be followed by a call to
+/// `notify_all`, which costs a single atomic increment when nothing is
+/// blocked.
+///
+/// A waiter can observe its predicate become true before the corresponding
+/// `notify_all` returns, so the eventcount must outlive any state the waiter
+/// is allowed to destroy once woken.
+class eventcount {
+ public:
+  /// @brief Clock used for deadlines.
+  using clock = std::chrono::steady_clock;
+
+  /// @brief Default constructor.
+  eventcount() noexcept;
+
+  eventcount(const eventcount &) = delete;
+  eventcount &operator=(const eventcount &) = delete;
+
+  /// @brief Wake every blocked waiter so they re-evaluate their predicates.
+  void notify_all() noexcept {
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_seq_cst)) {
+      wake();
+    }
+  }
+
+  /// @brief Wait for a predicate to become true.
+  ///
+  /// @tparam Predicate Callable returning `bool`.
+  /// @param predicate Condition to wait for.
+  template <class Predicate>
+  void wait(Predicate predicate) {
+    (void)wait_until(predicate, clock::time_point::max());
+  }
+
+  /// @brief Wait for a predicate to become true, or for a timeout to expire.
+  ///
+  /// @tparam Predicate Callable returning `bool`.
+  /// @param predicate Condition to wait for.
+  /// @param timeout Maximum duration to wait for.
+  ///
+  /// @return Returns the value of the predicate when the wait finished.
+  template <class Predicate>
+  [[nodiscard]] bool wait_for(Predicate predicate,
+                              std::chrono::nanoseconds timeout) {
+    const auto now = clock::now();
+    if (timeout >= clock::time_point::max() - now) {
+      return wait_until(predicate, clock::time_point::max());
+    }
+    return wait_until(
+        predicate, now + std::chrono::duration_cast<clock::duration>(timeout));
+  }
+
+  /// @brief Wait for a predicate to become true, or for a deadline to pass.
+  ///
+  /// @tparam Predicate Callable returning `bool`.
+  /// @param predicate Condition to wait for.
+  /// @param deadline Point in time at which to give up, `time_point::max()`
+  /// waits forever.
+  ///
+  /// @return Returns the value of the predicate when the wait finished.
+  template <class Predicate>
+  [[nodiscard]] bool wait_until(Predicate predicate,
+                                clock::time_point deadline) {
+    if (spin(predicate, deadline)) {
+      return true;
+    }
+    for (;;) {
+      // Register as a waiter before sampling the epoch so that a notifier
+      // which changes the state after the predicate is checked either sees
+      // the waiter or changes the epoch before it's sampled.
+      waiters.fetch_add(1, std::memory_order_seq_cst);
+      const uint32_t key = epoch.load(std::memory_order_seq_cst);
+      const bool done = predicate();
+      const bool woken = done || block(key, deadline);
+      waiters.fetch_sub(1, std::memory_order_seq_cst);
+      if (done) {
+        return true;
+      }
+      if (!woken) {
+        return predicate();
+      }
+    }
+  }
+
+ private:
+  template <class Predicate>
+  bool spin(Predicate &predicate, clock::time_point deadline) {
+    const uint32_t limit = spin_limit.load(std::memory_order_relaxed);
+    const bool timed = deadline != clock::time_point::max();
+    for (uint32_t i = 0; i < limit; i++) {
+      if (predicate()) {
+        spin_limit.store(std::min(limit * 2, max_spins),
+                         std::memory_order_relaxed);
+        return true;
+      }
+      // Short timeouts must not be overrun by spinning.
+      if (timed && 0 == i % 64 && clock::now() >= deadline) {
+        return predicate();
+      }
+      relax();
+    }
+    spin_limit.store(std::max(limit / 2, min_spins()),
+                     std::memory_order_relaxed);
+    return predicate();
+  }
+
+  /// @brief Hint to the processor that the thread is spinning.
+  static void relax() noexcept;
+
+  /// @brief Block until the epoch is no longer `key` or `deadline` passes.
+  ///
+  /// @return Returns `false` if the deadline passed, `true` otherwise.
+  bool block(uint32_t key, clock::time_point deadline) noexcept;
+
+  /// @brief Wake every thread blocked in `block`.
+  void wake() noexcept;
+
+  /// @brief Lower bound of the adaptive spin limit, zero when there is only
+  /// one hardware thread as spinning can't help then.
+  static uint32_t min_spins() noexcept;
+
+  static constexpr uint32_t max_spins = 2048;
+
+  std::atomic<uint32_t> epoch{0};
+  std::atomic<uint32_t> waiters{0};
+  std::atomic<uint32_t> spin_limit;
+#ifndef __linux__
+  std::mutex mutex;
+  std::condition_variable condition_variable;
+#endif
+};
+}  // namespace cargo
+
+#endif  // CARGO_EVENTCOUNT_H_INCLUDED
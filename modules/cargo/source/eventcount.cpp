@@ -0,0 +1,108 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cargo/eventcount.h>
+
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace cargo {
+eventcount::eventcount() noexcept : spin_limit{std::min(256u, max_spins)} {
+  if (0 == min_spins()) {
+    spin_limit.store(0, std::memory_order_relaxed);
+  }
+}
+
+uint32_t eventcount::min_spins() noexcept {
+  static const uint32_t spins =
+      std::thread::hardware_concurrency() > 1 ? 16 : 0;
+  return spins;
+}
+
+void eventcount::relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#else
+  std::this_thread::yield();
+#endif
+}
+
+#ifdef __linux__
+bool eventcount::block(uint32_t key, clock::time_point deadline) noexcept {
+  struct timespec timeout;
+  struct timespec *timeout_ptr = nullptr;
+  if (deadline != clock::time_point::max()) {
+    const auto now = clock::now();
+    if (now >= deadline) {
+      return false;
+    }
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+    timeout.tv_sec = static_cast<time_t>(remaining.count() / 1000000000);
+    timeout.tv_nsec = static_cast<long>(remaining.count() % 1000000000);
+    timeout_ptr = &timeout;
+  }
+  // std::atomic<uint32_t> is lock free and has the same representation as
+  // uint32_t, so its address can be used as the futex word.
+  const long result =
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch),
+              FUTEX_WAIT_PRIVATE, key, timeout_ptr, nullptr, 0);
+  return !(-1 == result && ETIMEDOUT == errno);
+}
+
+void eventcount::wake() noexcept {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch), FUTEX_WAKE_PRIVATE,
+          INT_MAX, nullptr, nullptr, 0);
+}
+#else
+bool eventcount::block(uint32_t key, clock::time_point deadline) noexcept {
+  std::unique_lock<std::mutex> lock(mutex);
+  // The epoch is changed before the notifier takes the mutex, so checking it
+  // under the mutex can't miss a wake up.
+  if (epoch.load(std::memory_order_seq_cst) != key) {
+    return true;
+  }
+  if (deadline == clock::time_point::max()) {
+    condition_variable.wait(lock);
+    return true;
+  }
+  return std::cv_status::timeout !=
+         condition_variable.wait_until(lock, deadline);
+}
+
+void eventcount::wake() noexcept {
+  { const std::lock_guard<std::mutex> lock(mutex); }
+  condition_variable.notify_all();
+}
+#endif
+}  // namespace cargo
@@ -0,0 +1,79 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "cargo/eventcount.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(eventcount, wait_already_true) {
+  cargo::eventcount eventcount;
+  eventcount.wait([] { return true; });
+  ASSERT_TRUE(eventcount.wait_for([] { return true; },
+                                  std::chrono::nanoseconds(0)));
+}
+
+TEST(eventcount, wait_for_timeout) {
+  cargo::eventcount eventcount;
+  const auto timeout = std::chrono::milliseconds(10);
+  const auto start = cargo::eventcount::clock::now();
+  ASSERT_FALSE(eventcount.wait_for([] { return false; }, timeout));
+  ASSERT_GE(cargo::eventcount::clock::now() - start, timeout);
+}
+
+TEST(eventcount, wait_for_zero_timeout) {
+  cargo::eventcount eventcount;
+  ASSERT_FALSE(
+      eventcount.wait_for([] { return false; }, std::chrono::nanoseconds(0)));
+}
+
+TEST(eventcount, notify) {
+  cargo::eventcount eventcount;
+  std::atomic<bool> flag{false};
+  std::thread notifier{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    flag = true;
+    eventcount.notify_all();
+  }};
+  eventcount.wait([&] { return flag.load(); });
+  ASSERT_TRUE(flag);
+  notifier.join();
+}
+
+TEST(eventcount, notify_many) {
+  cargo::eventcount eventcount;
+  std::atomic<uint32_t> count{0};
+  constexpr uint32_t iterations = 1000;
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < 4; i++) {
+    waiters.emplace_back([&] {
+      for (uint32_t target = 1; target <= iterations; target++) {
+        eventcount.wait([&] { return count >= target; });
+      }
+    });
+  }
+  for (uint32_t i = 0; i < iterations; i++) {
+    count++;
+    eventcount.notify_all();
+  }
+  for (auto &waiter : waiters) {
+    waiter.join();
+  }
+  ASSERT_EQ(iterations, count);
+}
@@ -2729,6 +2729,10 @@ double __CL_BARRIER_ATTRIBUTES work_group_scan_inclusive_min(double x);
 double __CL_BARRIER_ATTRIBUTES work_group_scan_inclusive_max(double x);
 #endif  // __CA_BUILTINS_DOUBLE_SUPPORT
 
+#ifdef __opencl_c_pipes
+bool __CL_BUILTIN_ATTRIBUTES is_valid_reserve_id(reserve_id_t reserve_id);
+#endif
+
 /*-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-*/
 
 cl_mem_fence_flags __CL_BUILTIN_ATTRIBUTES get_fence(bool *ptr);
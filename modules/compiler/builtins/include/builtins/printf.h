@@ -40,6 +40,16 @@ namespace printf {
 /// integer types, printf will still behave correctly.
 enum struct type { DOUBLE, FLOAT, LONG, INT, SHORT, CHAR, STRING };
 
+/// @brief Size in bytes of the header at the start of each work-group's chunk
+/// of the printf buffer.
+///
+/// The header holds three 32-bit words: the number of bytes reserved in the
+/// chunk (including the header), the number of reserved bytes which did not
+/// fit in the chunk, and the number of bytes whose printf call has finished
+/// storing its arguments (including the header). A chunk only contains
+/// complete records when the sum of the last two words equals the first.
+constexpr uint32_t buffer_header_size = 12;
+
 /// @brief Struct containing data representing a single printf call.
 ///
 /// We keep the format string, the types of the arguments as well as the
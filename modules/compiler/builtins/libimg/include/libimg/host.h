@@ -95,6 +95,17 @@ HostImage* HostCreateImage(const cl_mem_flags flags,
 void HostInitializeImage(const cl_image_format& image_format,
                          const cl_image_desc& image_desc, HostImage* image);
 
+/// @brief Set the storage layout of an image.
+///
+/// Must be called before any data is stored in the image, existing image data
+/// is not converted to the new layout. Image storage for the new layout must be
+/// at least libimg::HostGetImageLayoutStorageSize() bytes.
+///
+/// @param image Image to set the layout of.
+/// @param layout One of the `IMG_LAYOUT_*` values, the tiled layouts must match
+/// the result of libimg::HostGetImageTiledLayout() for the image.
+void HostSetImageLayout(HostImage* image, const UInt layout);
+
 /// @brief Attach external image storage.
 ///
 /// @param image Image to attach external storage to.
@@ -251,6 +262,25 @@ uint64_t HostGetImageAllocationSize(const cl_mem_flags flags,
 size_t HostGetImageStorageSize(const cl_image_format& image_format,
                                const cl_image_desc& image_desc);
 
+/// @brief Query the tiled storage layout supported by an image.
+///
+/// @param image_desc Description of image dimensions.
+///
+/// @return `IMG_LAYOUT_TILED_2D` for 2D images, `IMG_LAYOUT_TILED_3D` for 3D
+/// images, or `IMG_LAYOUT_LINEAR` for image types which can not be tiled.
+UInt HostGetImageTiledLayout(const cl_image_desc& image_desc);
+
+/// @brief Query the required size to store the image data in a given layout.
+///
+/// @param image_format Description of pixel layout and storage.
+/// @param image_desc Description of image dimensions.
+/// @param layout One of the `IMG_LAYOUT_*` values.
+///
+/// @return Size in bytes of required image storage.
+size_t HostGetImageLayoutStorageSize(const cl_image_format& image_format,
+                                     const cl_image_desc& image_desc,
+                                     const UInt layout);
+
 /// @brief Calculate the size in bytes of a single image pixel.
 ///
 /// @param image_format OpenCL image format descriptor.
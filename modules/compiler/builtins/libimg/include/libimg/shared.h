@@ -199,6 +199,30 @@
 /// @brief Sampler, image_library's representation of sampler.
 typedef libimg::UInt Sampler;
 
+/// @brief Image storage layouts.
+///
+/// Specifies how the pixels of an image are arranged in memory, see
+/// ImageMetaData::layout.
+/// @weakgroup Layout
+/// @{
+
+/// @brief IMG_LAYOUT_LINEAR pixels are stored in row-major order, rows are
+/// `row_pitch` bytes apart and slices or layers `slice_pitch` bytes apart.
+#define IMG_LAYOUT_LINEAR 0x0
+/// @brief IMG_LAYOUT_TILED_2D pixels of a 2D image are stored in square tiles
+/// of `1 << IMG_TILE_2D_SHIFT` pixels a side. Both the tiles and the pixels
+/// within a tile are stored in row-major order.
+#define IMG_LAYOUT_TILED_2D 0x1
+/// @brief IMG_LAYOUT_TILED_3D pixels of a 3D image are stored in cubic tiles
+/// of `1 << IMG_TILE_3D_SHIFT` pixels a side. Both the tiles and the pixels
+/// within a tile are stored in row-major order.
+#define IMG_LAYOUT_TILED_3D 0x2
+/// @brief IMG_TILE_2D_SHIFT log2 of the side of a IMG_LAYOUT_TILED_2D tile.
+#define IMG_TILE_2D_SHIFT 3
+/// @brief IMG_TILE_3D_SHIFT log2 of the side of a IMG_LAYOUT_TILED_3D tile.
+#define IMG_TILE_3D_SHIFT 2
+/// @}
+
 /// @brief An image descriptor, used by both the host and kernel API's.
 typedef struct {
   /// @brief Description of the order of channels in the pixel.
@@ -219,8 +243,48 @@ typedef struct {
   libimg::Size row_pitch;
   /// @brief Size in bytes of a slice on the image.
   libimg::Size slice_pitch;
+  /// @brief Arrangement of the pixels in memory, one of the `IMG_LAYOUT_*`
+  /// values. The pitches above only describe IMG_LAYOUT_LINEAR images.
+  libimg::UInt layout;
 } ImageMetaData;
 
+/// @brief Calculate the offset in bytes of a pixel from the start of the image
+/// data.
+///
+/// @param[in] desc Description of the image.
+/// @param[in] x Coordinate of the pixel within a row.
+/// @param[in] y Row of the pixel, or array layer for 1D image arrays.
+/// @param[in] z Slice of the pixel, or array layer for 2D image arrays.
+///
+/// @return Returns the offset in bytes of the pixel.
+inline libimg::Size ImagePixelOffset(const ImageMetaData &desc,
+                                     libimg::Size x, libimg::Size y,
+                                     libimg::Size z) {
+  if (IMG_LAYOUT_TILED_2D == desc.layout) {
+    const libimg::Size mask = (1 << IMG_TILE_2D_SHIFT) - 1;
+    const libimg::Size tiles_x = (desc.width + mask) >> IMG_TILE_2D_SHIFT;
+    const libimg::Size tile =
+        (y >> IMG_TILE_2D_SHIFT) * tiles_x + (x >> IMG_TILE_2D_SHIFT);
+    const libimg::Size pixel = (tile << (2 * IMG_TILE_2D_SHIFT)) +
+                               ((y & mask) << IMG_TILE_2D_SHIFT) + (x & mask);
+    return pixel * desc.pixel_size;
+  }
+  if (IMG_LAYOUT_TILED_3D == desc.layout) {
+    const libimg::Size mask = (1 << IMG_TILE_3D_SHIFT) - 1;
+    const libimg::Size tiles_x = (desc.width + mask) >> IMG_TILE_3D_SHIFT;
+    const libimg::Size tiles_y = (desc.height + mask) >> IMG_TILE_3D_SHIFT;
+    const libimg::Size tile =
+        ((z >> IMG_TILE_3D_SHIFT) * tiles_y + (y >> IMG_TILE_3D_SHIFT)) *
+            tiles_x +
+        (x >> IMG_TILE_3D_SHIFT);
+    const libimg::Size pixel = (tile << (3 * IMG_TILE_3D_SHIFT)) +
+                               ((z & mask) << (2 * IMG_TILE_3D_SHIFT)) +
+                               ((y & mask) << IMG_TILE_3D_SHIFT) + (x & mask);
+    return pixel * desc.pixel_size;
+  }
+  return x * desc.pixel_size + y * desc.row_pitch + z * desc.slice_pitch;
+}
+
 /// @brief An image object, used by both the host and kernel API's.
 typedef struct {
   /// @brief Embedded description of the image data.
@@ -298,6 +298,55 @@ size_t libimg::HostGetImageStorageSize(const cl_image_format &image_format,
   return storageSize;
 }
 
+libimg::UInt libimg::HostGetImageTiledLayout(const cl_image_desc &image_desc) {
+  switch (image_desc.image_type) {
+    case CL_MEM_OBJECT_IMAGE2D:
+      return IMG_LAYOUT_TILED_2D;
+    case CL_MEM_OBJECT_IMAGE3D:
+      return IMG_LAYOUT_TILED_3D;
+    default:
+      // Array images are sampled one layer at a time, and 1D images already
+      // have ideal locality, so they are always linear.
+      return IMG_LAYOUT_LINEAR;
+  }
+}
+
+size_t libimg::HostGetImageLayoutStorageSize(
+    const cl_image_format &image_format, const cl_image_desc &image_desc,
+    const libimg::UInt layout) {
+  const size_t pixel_size = libimg::HostGetPixelSize(image_format);
+  switch (layout) {
+    case IMG_LAYOUT_LINEAR:
+      return libimg::HostGetImageStorageSize(image_format, image_desc);
+    case IMG_LAYOUT_TILED_2D: {
+      IMG_ASSERT(CL_MEM_OBJECT_IMAGE2D == image_desc.image_type,
+                 "Only 2D images can use the tiled 2D layout!");
+      const size_t mask = (size_t(1) << IMG_TILE_2D_SHIFT) - 1;
+      const size_t tiles_x =
+          (image_desc.image_width + mask) >> IMG_TILE_2D_SHIFT;
+      const size_t tiles_y =
+          (image_desc.image_height + mask) >> IMG_TILE_2D_SHIFT;
+      return (tiles_x * tiles_y * pixel_size) << (2 * IMG_TILE_2D_SHIFT);
+    }
+    case IMG_LAYOUT_TILED_3D: {
+      IMG_ASSERT(CL_MEM_OBJECT_IMAGE3D == image_desc.image_type,
+                 "Only 3D images can use the tiled 3D layout!");
+      const size_t mask = (size_t(1) << IMG_TILE_3D_SHIFT) - 1;
+      const size_t tiles_x =
+          (image_desc.image_width + mask) >> IMG_TILE_3D_SHIFT;
+      const size_t tiles_y =
+          (image_desc.image_height + mask) >> IMG_TILE_3D_SHIFT;
+      const size_t tiles_z =
+          (image_desc.image_depth + mask) >> IMG_TILE_3D_SHIFT;
+      return (tiles_x * tiles_y * tiles_z * pixel_size)
+             << (3 * IMG_TILE_3D_SHIFT);
+    }
+    default:
+      IMG_UNREACHABLE("Invalid image layout!");
+      return 0;
+  }
+}
+
 uint64_t libimg::HostGetImageAllocationSize(const cl_mem_flags flags,
                                             const cl_image_format &image_format,
                                             const cl_image_desc &image_desc) {
@@ -508,6 +557,19 @@ void libimg::HostInitializeImage(const cl_image_format &image_format,
     image->image.meta_data.slice_pitch =
         image->image.meta_data.row_pitch * image->image.meta_data.height;
   }
+
+  image->image.meta_data.layout = IMG_LAYOUT_LINEAR;
+}
+
+void libimg::HostSetImageLayout(libimg::HostImage *image,
+                                const libimg::UInt layout) {
+  IMG_ASSERT(IMG_LAYOUT_LINEAR == layout ||
+                 (IMG_LAYOUT_TILED_2D == layout &&
+                  CL_MEM_OBJECT_IMAGE2D == image->type) ||
+                 (IMG_LAYOUT_TILED_3D == layout &&
+                  CL_MEM_OBJECT_IMAGE3D == image->type),
+             "Image type does not support the requested layout!");
+  image->image.meta_data.layout = layout;
 }
 
 void libimg::HostAttachImageStorage(libimg::HostImage *image, void *ptr) {
@@ -558,44 +620,75 @@ void *libimg::HostGetImageKernelImagePtr(HostImage *image) {
   return &image->image;
 }
 
-void libimg::HostReadImage(const HostImage *image, const size_t origin[3],
-                           const size_t region[3], const size_t dst_row_pitch,
-                           const size_t dst_slice_pitch, uint8_t *dst) {
-  const ImageMetaData &desc = image->image.meta_data;
-
-  const uint8_t *src = image->image.raw_data + (origin[0] * desc.pixel_size);
-
-  const size_t row_size = region[0] * desc.pixel_size;
+// Calls `func(offset, x, y, z, count)` for each run of `count` pixels in the
+// region which is contiguous in the image storage, `offset` is the offset in
+// bytes of the run in the image storage and (x, y, z) the position of the run
+// relative to `origin`. Rows of linear images are a single run while rows of
+// tiled images are split at tile boundaries.
+template <typename Func>
+static void HostForEachPixelRun(const ImageMetaData &desc,
+                                const size_t origin[3], const size_t region[3],
+                                Func func) {
+  size_t tile_size = 0;
+  switch (desc.layout) {
+    case IMG_LAYOUT_TILED_2D:
+      tile_size = size_t(1) << IMG_TILE_2D_SHIFT;
+      break;
+    case IMG_LAYOUT_TILED_3D:
+      tile_size = size_t(1) << IMG_TILE_3D_SHIFT;
+      break;
+    default:
+      break;
+  }
 
   for (size_t z = 0; z < region[2]; ++z) {
-    const uint8_t *src_slice = src + ((z + origin[2]) * desc.slice_pitch);
-    uint8_t *dst_slice = dst + (z * dst_slice_pitch);
     for (size_t y = 0; y < region[1]; ++y) {
-      const uint8_t *src_row = src_slice + ((y + origin[1]) * desc.row_pitch);
-      uint8_t *dst_row = dst_slice + (y * dst_row_pitch);
-      std::memmove(dst_row, src_row, row_size);
+      size_t count = 0;
+      for (size_t x = 0; x < region[0]; x += count) {
+        const size_t image_x = origin[0] + x;
+        count = region[0] - x;
+        if (tile_size) {
+          const size_t tile_end = tile_size - (image_x & (tile_size - 1));
+          count = count < tile_end ? count : tile_end;
+        }
+        func(ImagePixelOffset(desc, image_x, origin[1] + y, origin[2] + z), x,
+             y, z, count);
+      }
     }
   }
 }
 
+void libimg::HostReadImage(const HostImage *image, const size_t origin[3],
+                           const size_t region[3], const size_t dst_row_pitch,
+                           const size_t dst_slice_pitch, uint8_t *dst) {
+  const ImageMetaData &desc = image->image.meta_data;
+  const uint8_t *src = image->image.raw_data;
+
+  HostForEachPixelRun(desc, origin, region,
+                      [&](size_t offset, size_t x, size_t y, size_t z,
+                          size_t count) {
+                        std::memmove(dst + (z * dst_slice_pitch) +
+                                         (y * dst_row_pitch) +
+                                         (x * desc.pixel_size),
+                                     src + offset, count * desc.pixel_size);
+                      });
+}
+
 void libimg::HostWriteImage(HostImage *image, const size_t origin[3],
                             const size_t region[3], const size_t src_row_pitch,
                             const size_t src_slice_pitch, const uint8_t *src) {
   const ImageMetaData &desc = image->image.meta_data;
-
-  uint8_t *dst = image->image.raw_data + (origin[0] * desc.pixel_size);
-
-  const size_t row_size = region[0] * desc.pixel_size;
-
-  for (size_t z = 0; z < region[2]; ++z) {
-    const uint8_t *src_slice = src + (z * src_slice_pitch);
-    uint8_t *dst_slice = dst + ((z + origin[2]) * desc.slice_pitch);
-    for (size_t y = 0; y < region[1]; ++y) {
-      const uint8_t *src_row = src_slice + (y * src_row_pitch);
-      uint8_t *dst_row = dst_slice + ((y + origin[1]) * desc.row_pitch);
-      std::memmove(dst_row, src_row, row_size);
-    }
-  }
+  uint8_t *dst = image->image.raw_data;
+
+  HostForEachPixelRun(desc, origin, region,
+                      [&](size_t offset, size_t x, size_t y, size_t z,
+                          size_t count) {
+                        std::memmove(dst + offset,
+                                     src + (z * src_slice_pitch) +
+                                         (y * src_row_pitch) +
+                                         (x * desc.pixel_size),
+                                     count * desc.pixel_size);
+                      });
 }
 
 static libimg::UInt4 ShuffleOrder(const libimg::UInt order,
@@ -708,19 +801,29 @@ void libimg::HostFillImage(HostImage *image, const void *fill_color,
     }
   }
 
-  uint8_t *dst = image->image.raw_data + (origin[0] * desc.pixel_size) +
-                 (origin[1] * desc.row_pitch) + (origin[2] * desc.slice_pitch);
-
-  for (size_t z = 0; z < region[2]; ++z) {
-    uint8_t *dst_slice = dst + (z * desc.slice_pitch);
-    for (size_t y = 0; y < region[1]; ++y) {
-      uint8_t *dst_row = dst_slice + (y * desc.row_pitch);
-      for (size_t x = 0; x < region[0]; ++x) {
-        uint8_t *dst_pixel = dst_row + (x * desc.pixel_size);
-        std::memcpy(dst_pixel, final_color, desc.pixel_size);
-      }
-    }
+  // Replicate the packed color so that runs of pixels are filled with a few
+  // large copies rather than one copy per pixel.
+  const size_t pattern_pixels = 64;
+  uint8_t pattern[pattern_pixels * sizeof(final_color)];
+  for (size_t x = 0; x < pattern_pixels; ++x) {
+    std::memcpy(pattern + (x * desc.pixel_size), final_color, desc.pixel_size);
   }
+
+  uint8_t *dst = image->image.raw_data;
+
+  HostForEachPixelRun(desc, origin, region,
+                      [&](size_t offset, size_t, size_t, size_t,
+                          size_t count) {
+                        uint8_t *dst_run = dst + offset;
+                        while (count) {
+                          const size_t pixels =
+                              count < pattern_pixels ? count : pattern_pixels;
+                          std::memcpy(dst_run, pattern,
+                                      pixels * desc.pixel_size);
+                          dst_run += pixels * desc.pixel_size;
+                          count -= pixels;
+                        }
+                      });
 }
 
 void libimg::HostCopyImage(const HostImage *src_image, HostImage *dst_image,
@@ -729,27 +832,53 @@ void libimg::HostCopyImage(const HostImage *src_image, HostImage *dst_image,
   const ImageMetaData &src_desc = src_image->image.meta_data;
   const ImageMetaData &dst_desc = dst_image->image.meta_data;
 
-  const uint8_t *const src =
-      src_image->image.raw_data + (src_origin[0] * src_desc.pixel_size);
-  uint8_t *const dst =
-      dst_image->image.raw_data + (dst_origin[0] * dst_desc.pixel_size);
-
-  const size_t z_max = region[2];
-  const size_t y_max = region[1];
-  const size_t x_size = region[0] * src_desc.pixel_size;
-
-  for (size_t z = 0; z < z_max; z++) {
-    const uint8_t *const src_slice =
-        src + ((z + src_origin[2]) * src_desc.slice_pitch);
-    uint8_t *const dst_slice =
-        dst + ((z + dst_origin[2]) * dst_desc.slice_pitch);
-    for (size_t y = 0; y < y_max; y++) {
-      const uint8_t *const src_row =
-          src_slice + ((y + src_origin[1]) * src_desc.row_pitch);
-      uint8_t *dst_row = dst_slice + ((y + dst_origin[1]) * dst_desc.row_pitch);
-      std::memmove(dst_row, src_row, x_size);
+  const uint8_t *const src = src_image->image.raw_data;
+  uint8_t *const dst = dst_image->image.raw_data;
+
+  // Rows of linear images are copied directly, and when whole rows of images
+  // with the same pitch are copied each slice is copied as a single block.
+  if (IMG_LAYOUT_LINEAR == src_desc.layout &&
+      IMG_LAYOUT_LINEAR == dst_desc.layout) {
+    const size_t row_size = region[0] * src_desc.pixel_size;
+    const bool whole_rows = row_size == src_desc.row_pitch &&
+                            row_size == dst_desc.row_pitch;
+    for (size_t z = 0; z < region[2]; ++z) {
+      const uint8_t *src_slice =
+          src + ImagePixelOffset(src_desc, src_origin[0], src_origin[1],
+                                 src_origin[2] + z);
+      uint8_t *dst_slice =
+          dst + ImagePixelOffset(dst_desc, dst_origin[0], dst_origin[1],
+                                 dst_origin[2] + z);
+      if (whole_rows) {
+        std::memmove(dst_slice, src_slice, row_size * region[1]);
+        continue;
+      }
+      for (size_t y = 0; y < region[1]; ++y) {
+        std::memmove(dst_slice + (y * dst_desc.row_pitch),
+                     src_slice + (y * src_desc.row_pitch), row_size);
+      }
     }
+    return;
   }
+
+  // Runs which are contiguous in the source image may not be contiguous in
+  // the destination image when the layouts differ, split them again.
+  HostForEachPixelRun(
+      src_desc, src_origin, region,
+      [&](size_t src_offset, size_t x, size_t y, size_t z, size_t count) {
+        const size_t run_origin[3] = {dst_origin[0] + x, dst_origin[1] + y,
+                                      dst_origin[2] + z};
+        const size_t run_region[3] = {count, 1, 1};
+        HostForEachPixelRun(dst_desc, run_origin, run_region,
+                            [&](size_t dst_offset, size_t run_x, size_t,
+                                size_t, size_t run_count) {
+                              std::memmove(
+                                  dst + dst_offset,
+                                  src + src_offset +
+                                      (run_x * src_desc.pixel_size),
+                                  run_count * src_desc.pixel_size);
+                            });
+      });
 }
 
 void libimg::HostCopyImageToBuffer(const HostImage *src_image, void *dst_buffer,
@@ -757,25 +886,10 @@ void libimg::HostCopyImageToBuffer(const HostImage *src_image, void *dst_buffer,
                                    const size_t region[3],
                                    const size_t dst_offset) {
   const ImageMetaData &desc = src_image->image.meta_data;
+  const size_t row_size = region[0] * desc.pixel_size;
 
-  const uint8_t *const src =
-      src_image->image.raw_data + (desc.pixel_size * src_origin[0]) +
-      (src_origin[1] * desc.row_pitch) + (src_origin[2] * desc.slice_pitch);
-  uint8_t *const dst = static_cast<uint8_t *>(dst_buffer) + dst_offset;
-
-  const size_t z_max = region[2];
-  const size_t y_max = region[1];
-  const size_t x_size = region[0] * desc.pixel_size;
-
-  uint8_t *dst_row = dst;
-  for (size_t z = 0; z < z_max; z++) {
-    const uint8_t *src_row = src + (desc.slice_pitch * z);
-    for (size_t y = 0; y < y_max; y++) {
-      std::memmove(dst_row, src_row, x_size);
-      dst_row += x_size;
-      src_row += desc.row_pitch;
-    }
-  }
+  HostReadImage(src_image, src_origin, region, row_size, row_size * region[1],
+                static_cast<uint8_t *>(dst_buffer) + dst_offset);
 }
 
 void libimg::HostCopyBufferToImage(const void *src_buffer, HostImage *dst_image,
@@ -783,29 +897,8 @@ void libimg::HostCopyBufferToImage(const void *src_buffer, HostImage *dst_image,
                                    const size_t dst_origin[3],
                                    const size_t region[3]) {
   const ImageMetaData &desc = dst_image->image.meta_data;
+  const size_t row_size = region[0] * desc.pixel_size;
 
-  const uint8_t *src = static_cast<const uint8_t *>(src_buffer) + src_offset;
-  uint8_t *dst = dst_image->image.raw_data;
-
-  const size_t z_max = dst_origin[2] + region[2];
-  const size_t y_max = dst_origin[1] + region[1];
-  const size_t x_size = region[0] * desc.pixel_size;
-
-  const size_t region_slice_pitch = region[1] * region[0] * desc.pixel_size;
-  const size_t region_row_pitch = region[0] * desc.pixel_size;
-
-  for (size_t z = dst_origin[2]; z < z_max; z++) {
-    const uint8_t *src_row = src;
-    uint8_t *dst_row = dst;
-
-    for (size_t y = dst_origin[1]; y < y_max; y++) {
-      std::memmove(dst_row, src_row, x_size);
-
-      src_row += region_row_pitch;
-      dst_row += desc.row_pitch;
-    }
-
-    src += region_slice_pitch;
-    dst += desc.slice_pitch;
-  }
+  HostWriteImage(dst_image, dst_origin, region, row_size, row_size * region[1],
+                 static_cast<const uint8_t *>(src_buffer) + src_offset);
 }
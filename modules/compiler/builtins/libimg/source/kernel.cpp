@@ -1808,6 +1808,20 @@ inline libimg::Int addressing_mode_CLAMP(libimg::Int coord, libimg::Int size) {
 
 inline libimg::Int addressing_mode_NONE(libimg::Int coord) { return coord; }
 
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
+/* Pixel addressing helpers.                                                 */
+/* Coordinates must be within the image, or slice of a 2D image array.      */
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
+inline libimg::Size pixel_offset(const ImageMetaData &desc, libimg::Int i,
+                                 libimg::Int j) {
+  return ImagePixelOffset(desc, i, j, 0);
+}
+
+inline libimg::Size pixel_offset(const ImageMetaData &desc, libimg::Int i,
+                                 libimg::Int j, libimg::Int k) {
+  return ImagePixelOffset(desc, i, j, k);
+}
+
 template <typename VecTy>
 VecTy border_color(const libimg::UInt channel_order) {
   switch (channel_order) {
@@ -2060,13 +2074,13 @@ inline VecTy image_1d_sampler_read_helper(const libimg::Float coord,
   return border_res;
 }
 
-template <typename VecTy, typename VecElemTy, typename VecAccessTy>
-inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
-                                          const Sampler sampler,
-                                          const ImageMetaData &desc,
-                                          const libimg::UChar *raw_image_data,
-                                          const VecTy border_res,
-                                          VecAccessTy read_vec4) {
+template <Sampler SamplerValue, typename VecTy, typename VecElemTy,
+          typename VecAccessTy>
+inline VecTy image_2d_sampler_read_specialized(
+    const libimg::Float2 &coord, const ImageMetaData &desc,
+    const libimg::UChar *raw_image_data, const VecTy border_res,
+    VecAccessTy read_vec4) {
+  const Sampler sampler = SamplerValue;
   const libimg::UInt filter_mode = get_sampler_filter_mode(sampler);
   const libimg::UInt addressing_mode = get_sampler_addressing_mode(sampler);
   const libimg::UInt normalized_coords = get_sampler_normalized_coords(sampler);
@@ -2124,8 +2138,7 @@ inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
             return border_res;
           }
 
-          const void *data =
-              &raw_image_data[desc.pixel_size * i + desc.row_pitch * j];
+          const void *data = &raw_image_data[pixel_offset(desc, i, j)];
           return read_vec4(data, desc.channel_order, desc.channel_type);
           break;
         }
@@ -2195,8 +2208,7 @@ inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
           break;
         }
       }
-      const void *data =
-          &raw_image_data[desc.pixel_size * i + desc.row_pitch * j];
+      const void *data = &raw_image_data[pixel_offset(desc, i, j)];
       return read_vec4(data, desc.channel_order, desc.channel_type);
     }
     case CLK_FILTER_LINEAR: {
@@ -2236,23 +2248,19 @@ inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
 
           t_i0j0 = (i0_outside || j0_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                   desc.row_pitch * j0],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i0, j0)],
                                    desc.channel_order, desc.channel_type);
           t_i1j0 = (i1_outside || j0_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                   desc.row_pitch * j0],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i1, j0)],
                                    desc.channel_order, desc.channel_type);
           t_i0j1 = (i0_outside || j1_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                   desc.row_pitch * j1],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i0, j1)],
                                    desc.channel_order, desc.channel_type);
           t_i1j1 = (i1_outside || j1_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                   desc.row_pitch * j1],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i1, j1)],
                                    desc.channel_order, desc.channel_type);
 
           break;
@@ -2280,23 +2288,19 @@ inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
 
           t_i0j0 = (i0_outside || j0_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                   desc.row_pitch * j0],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i0, j0)],
                                    desc.channel_order, desc.channel_type);
           t_i1j0 = (i1_outside || j0_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                   desc.row_pitch * j0],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i1, j0)],
                                    desc.channel_order, desc.channel_type);
           t_i0j1 = (i0_outside || j1_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                   desc.row_pitch * j1],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i0, j1)],
                                    desc.channel_order, desc.channel_type);
           t_i1j1 = (i1_outside || j1_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                   desc.row_pitch * j1],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i1, j1)],
                                    desc.channel_order, desc.channel_type);
           break;
         }
@@ -2323,23 +2327,19 @@ inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
 
           t_i0j0 = (i0_outside || j0_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                   desc.row_pitch * j0],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i0, j0)],
                                    desc.channel_order, desc.channel_type);
           t_i1j0 = (i1_outside || j0_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                   desc.row_pitch * j0],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i1, j0)],
                                    desc.channel_order, desc.channel_type);
           t_i0j1 = (i0_outside || j1_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                   desc.row_pitch * j1],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i0, j1)],
                                    desc.channel_order, desc.channel_type);
           t_i1j1 = (i1_outside || j1_outside)
                        ? border_res
-                       : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                   desc.row_pitch * j1],
+                       : read_vec4(&raw_image_data[pixel_offset(desc, i1, j1)],
                                    desc.channel_order, desc.channel_type);
           break;
         }
@@ -2381,18 +2381,14 @@ inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
           a = frac(u - 0.5f);
           b = frac(v - 0.5f);
 
-          t_i0j0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j0],
-              desc.channel_order, desc.channel_type);
-          t_i1j0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j0],
-              desc.channel_order, desc.channel_type);
-          t_i0j1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j1],
-              desc.channel_order, desc.channel_type);
-          t_i1j1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j1],
-              desc.channel_order, desc.channel_type);
+          t_i0j0 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j0)],
+                             desc.channel_order, desc.channel_type);
+          t_i1j0 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j0)],
+                             desc.channel_order, desc.channel_type);
+          t_i0j1 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j1)],
+                             desc.channel_order, desc.channel_type);
+          t_i1j1 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j1)],
+                             desc.channel_order, desc.channel_type);
           break;
         }
         case CLK_ADDRESS_MIRRORED_REPEAT: {
@@ -2428,18 +2424,14 @@ inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
           a = frac(u - 0.5f);
           b = frac(v - 0.5f);
 
-          t_i0j0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j0],
-              desc.channel_order, desc.channel_type);
-          t_i1j0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j0],
-              desc.channel_order, desc.channel_type);
-          t_i0j1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j1],
-              desc.channel_order, desc.channel_type);
-          t_i1j1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j1],
-              desc.channel_order, desc.channel_type);
+          t_i0j0 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j0)],
+                             desc.channel_order, desc.channel_type);
+          t_i1j0 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j0)],
+                             desc.channel_order, desc.channel_type);
+          t_i0j1 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j1)],
+                             desc.channel_order, desc.channel_type);
+          t_i1j1 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j1)],
+                             desc.channel_order, desc.channel_type);
           break;
         }
       }
@@ -2458,13 +2450,13 @@ inline VecTy image_2d_sampler_read_helper(const libimg::Float2 &coord,
   return border_res;
 }
 
-template <typename VecTy, typename VecElemTy, typename VecAccessTy>
-inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
-                                          const Sampler sampler,
-                                          const ImageMetaData &desc,
-                                          const libimg::UChar *raw_image_data,
-                                          const VecTy border_res,
-                                          VecAccessTy read_vec4) {
+template <Sampler SamplerValue, typename VecTy, typename VecElemTy,
+          typename VecAccessTy>
+inline VecTy image_3d_sampler_read_specialized(
+    const libimg::Float4 &coord, const ImageMetaData &desc,
+    const libimg::UChar *raw_image_data, const VecTy border_res,
+    VecAccessTy read_vec4) {
+  const Sampler sampler = SamplerValue;
   const libimg::UInt filter_mode = get_sampler_filter_mode(sampler);
   const libimg::UInt addressing_mode = get_sampler_addressing_mode(sampler);
   const libimg::UInt normalized_coords = get_sampler_normalized_coords(sampler);
@@ -2518,9 +2510,7 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
             return border_res;
           }
 
-          const void *data =
-              &raw_image_data[desc.pixel_size * i + desc.row_pitch * j +
-                              desc.slice_pitch * k];
+          const void *data = &raw_image_data[pixel_offset(desc, i, j, k)];
           return read_vec4(data, desc.channel_order, desc.channel_type);
         }
         case CLK_ADDRESS_CLAMP: {
@@ -2539,9 +2529,7 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
             return border_res;
           }
 
-          const void *data =
-              &raw_image_data[desc.pixel_size * i + desc.row_pitch * j +
-                              desc.slice_pitch * k];
+          const void *data = &raw_image_data[pixel_offset(desc, i, j, k)];
           return read_vec4(data, desc.channel_order, desc.channel_type);
         }
         case CLK_ADDRESS_NONE: {
@@ -2560,9 +2548,7 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
             return border_res;
           }
 
-          const void *data =
-              &raw_image_data[desc.pixel_size * i + desc.row_pitch * j +
-                              desc.slice_pitch * k];
+          const void *data = &raw_image_data[pixel_offset(desc, i, j, k)];
           return read_vec4(data, desc.channel_order, desc.channel_type);
         }
         case CLK_ADDRESS_REPEAT: {
@@ -2598,9 +2584,7 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
           if (k > depth - 1) {
             k = k - depth;
           }
-          const void *data =
-              &raw_image_data[desc.pixel_size * i + desc.row_pitch * j +
-                              desc.slice_pitch * k];
+          const void *data = &raw_image_data[pixel_offset(desc, i, j, k)];
           return read_vec4(data, desc.channel_order, desc.channel_type);
         }
         case CLK_ADDRESS_MIRRORED_REPEAT: {
@@ -2637,9 +2621,7 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
           libimg::Int k = libimg::floor(w);
           k = libimg::min(k, static_cast<libimg::Int>(depth - 1));
 
-          const void *data =
-              &raw_image_data[desc.pixel_size * i + desc.row_pitch * j +
-                              desc.slice_pitch * k];
+          const void *data = &raw_image_data[pixel_offset(desc, i, j, k)];
           return read_vec4(data, desc.channel_order, desc.channel_type);
         }
       }
@@ -2694,52 +2676,44 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
 
           t_i0j0k0 = (i0_outside || j0_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j0, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i1j0k0 = (i1_outside || j0_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j0, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i0j1k0 = (i0_outside || j1_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j1, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i1j1k0 = (i1_outside || j1_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j1, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i0j0k1 = (i0_outside || j0_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j0, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i1j0k1 = (i1_outside || j0_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j0, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i0j1k1 = (i0_outside || j1_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j1, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i1j1k1 = (i1_outside || j1_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j1, k1)],
+                               desc.channel_order, desc.channel_type);
 
           a = frac(u - 0.5f);
           b = frac(v - 0.5f);
@@ -2776,52 +2750,44 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
 
           t_i0j0k0 = (i0_outside || j0_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j0, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i1j0k0 = (i1_outside || j0_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j0, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i0j1k0 = (i0_outside || j1_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j1, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i1j1k0 = (i1_outside || j1_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j1, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i0j0k1 = (i0_outside || j0_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j0, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i1j0k1 = (i1_outside || j0_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j0, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i0j1k1 = (i0_outside || j1_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j1, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i1j1k1 = (i1_outside || j1_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j1, k1)],
+                               desc.channel_order, desc.channel_type);
 
           a = frac(u - 0.5f);
           b = frac(v - 0.5f);
@@ -2858,52 +2824,44 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
 
           t_i0j0k0 = (i0_outside || j0_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j0, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i1j0k0 = (i1_outside || j0_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j0, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i0j1k0 = (i0_outside || j1_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j1, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i1j1k0 = (i1_outside || j1_outside || k0_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k0],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j1, k0)],
+                               desc.channel_order, desc.channel_type);
           t_i0j0k1 = (i0_outside || j0_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j0, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i1j0k1 = (i1_outside || j0_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j0 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j0, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i0j1k1 = (i0_outside || j1_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i0 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i0, j1, k1)],
+                               desc.channel_order, desc.channel_type);
           t_i1j1k1 = (i1_outside || j1_outside || k1_outside)
                          ? border_res
-                         : read_vec4(&raw_image_data[desc.pixel_size * i1 +
-                                                     desc.row_pitch * j1 +
-                                                     desc.slice_pitch * k1],
-                                     desc.channel_order, desc.channel_type);
+                         : read_vec4(
+                               &raw_image_data[pixel_offset(desc, i1, j1, k1)],
+                               desc.channel_order, desc.channel_type);
 
           a = frac(u - 0.5f);
           b = frac(v - 0.5f);
@@ -2961,38 +2919,22 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
           b = frac(v - 0.5f);
           c = frac(w - 0.5f);
 
-          t_i0j0k0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j0 +
-                              desc.slice_pitch * k0],
-              desc.channel_order, desc.channel_type);
-          t_i1j0k0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j0 +
-                              desc.slice_pitch * k0],
-              desc.channel_order, desc.channel_type);
-          t_i0j1k0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j1 +
-                              desc.slice_pitch * k0],
-              desc.channel_order, desc.channel_type);
-          t_i1j1k0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j1 +
-                              desc.slice_pitch * k0],
-              desc.channel_order, desc.channel_type);
-          t_i0j0k1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j0 +
-                              desc.slice_pitch * k1],
-              desc.channel_order, desc.channel_type);
-          t_i1j0k1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j0 +
-                              desc.slice_pitch * k1],
-              desc.channel_order, desc.channel_type);
-          t_i0j1k1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j1 +
-                              desc.slice_pitch * k1],
-              desc.channel_order, desc.channel_type);
-          t_i1j1k1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j1 +
-                              desc.slice_pitch * k1],
-              desc.channel_order, desc.channel_type);
+          t_i0j0k0 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j0, k0)],
+                               desc.channel_order, desc.channel_type);
+          t_i1j0k0 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j0, k0)],
+                               desc.channel_order, desc.channel_type);
+          t_i0j1k0 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j1, k0)],
+                               desc.channel_order, desc.channel_type);
+          t_i1j1k0 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j1, k0)],
+                               desc.channel_order, desc.channel_type);
+          t_i0j0k1 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j0, k1)],
+                               desc.channel_order, desc.channel_type);
+          t_i1j0k1 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j0, k1)],
+                               desc.channel_order, desc.channel_type);
+          t_i0j1k1 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j1, k1)],
+                               desc.channel_order, desc.channel_type);
+          t_i1j1k1 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j1, k1)],
+                               desc.channel_order, desc.channel_type);
 
           break;
         }
@@ -3040,38 +2982,22 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
           b = frac(v - 0.5f);
           c = frac(w - 0.5f);
 
-          t_i0j0k0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j0 +
-                              desc.slice_pitch * k0],
-              desc.channel_order, desc.channel_type);
-          t_i1j0k0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j0 +
-                              desc.slice_pitch * k0],
-              desc.channel_order, desc.channel_type);
-          t_i0j1k0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j1 +
-                              desc.slice_pitch * k0],
-              desc.channel_order, desc.channel_type);
-          t_i1j1k0 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j1 +
-                              desc.slice_pitch * k0],
-              desc.channel_order, desc.channel_type);
-          t_i0j0k1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j0 +
-                              desc.slice_pitch * k1],
-              desc.channel_order, desc.channel_type);
-          t_i1j0k1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j0 +
-                              desc.slice_pitch * k1],
-              desc.channel_order, desc.channel_type);
-          t_i0j1k1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i0 + desc.row_pitch * j1 +
-                              desc.slice_pitch * k1],
-              desc.channel_order, desc.channel_type);
-          t_i1j1k1 = read_vec4(
-              &raw_image_data[desc.pixel_size * i1 + desc.row_pitch * j1 +
-                              desc.slice_pitch * k1],
-              desc.channel_order, desc.channel_type);
+          t_i0j0k0 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j0, k0)],
+                               desc.channel_order, desc.channel_type);
+          t_i1j0k0 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j0, k0)],
+                               desc.channel_order, desc.channel_type);
+          t_i0j1k0 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j1, k0)],
+                               desc.channel_order, desc.channel_type);
+          t_i1j1k0 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j1, k0)],
+                               desc.channel_order, desc.channel_type);
+          t_i0j0k1 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j0, k1)],
+                               desc.channel_order, desc.channel_type);
+          t_i1j0k1 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j0, k1)],
+                               desc.channel_order, desc.channel_type);
+          t_i0j1k1 = read_vec4(&raw_image_data[pixel_offset(desc, i0, j1, k1)],
+                               desc.channel_order, desc.channel_type);
+          t_i1j1k1 = read_vec4(&raw_image_data[pixel_offset(desc, i1, j1, k1)],
+                               desc.channel_order, desc.channel_type);
 
           break;
         }
@@ -3105,6 +3031,67 @@ inline VecTy image_3d_sampler_read_helper(const libimg::Float4 &coord,
   return border_res;
 }
 
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
+/* Sampler dispatch.                                                         */
+/* Each valid sampler value maps to a read helper specialized for it, the    */
+/* helpers are forced inline so that when the sampler is a compile-time      */
+/* constant in the kernel the switch folds away at finalization leaving only */
+/* the specialized filtering and addressing code, which vecz can vectorize.  */
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
+#define IMG_ALWAYS_INLINE inline __attribute__((always_inline))
+
+#define IMG_SAMPLER_CASE(DIM, VALUE)                                          \
+  case (VALUE):                                                               \
+    return image_##DIM##_sampler_read_specialized<(VALUE), VecTy, VecElemTy>( \
+        coord, desc, raw_image_data, border_res, read_vec4)
+
+#define IMG_SAMPLER_ADDRESSING_CASES(DIM, FILTER, NORMALIZED)                 \
+  IMG_SAMPLER_CASE(DIM, FILTER | CLK_ADDRESS_NONE | NORMALIZED);              \
+  IMG_SAMPLER_CASE(DIM, FILTER | CLK_ADDRESS_CLAMP_TO_EDGE | NORMALIZED);     \
+  IMG_SAMPLER_CASE(DIM, FILTER | CLK_ADDRESS_CLAMP | NORMALIZED);             \
+  IMG_SAMPLER_CASE(DIM, FILTER | CLK_ADDRESS_REPEAT | NORMALIZED);            \
+  IMG_SAMPLER_CASE(DIM, FILTER | CLK_ADDRESS_MIRRORED_REPEAT | NORMALIZED)
+
+#define IMG_SAMPLER_CASES(DIM)                                                \
+  IMG_SAMPLER_ADDRESSING_CASES(DIM, CLK_FILTER_NEAREST,                       \
+                               CLK_NORMALIZED_COORDS_FALSE);                  \
+  IMG_SAMPLER_ADDRESSING_CASES(DIM, CLK_FILTER_NEAREST,                       \
+                               CLK_NORMALIZED_COORDS_TRUE);                   \
+  IMG_SAMPLER_ADDRESSING_CASES(DIM, CLK_FILTER_LINEAR,                        \
+                               CLK_NORMALIZED_COORDS_FALSE);                  \
+  IMG_SAMPLER_ADDRESSING_CASES(DIM, CLK_FILTER_LINEAR,                        \
+                               CLK_NORMALIZED_COORDS_TRUE)
+
+template <typename VecTy, typename VecElemTy, typename VecAccessTy>
+IMG_ALWAYS_INLINE VecTy image_2d_sampler_read_helper(
+    const libimg::Float2 &coord, const Sampler sampler,
+    const ImageMetaData &desc, const libimg::UChar *raw_image_data,
+    const VecTy border_res, VecAccessTy read_vec4) {
+  switch (sampler &
+          (NORMALIZED_COORDS_MASK | ADDRESSING_MODE_MASK | FILTER_MODE_MASK)) {
+    IMG_SAMPLER_CASES(2d);
+    default:
+      return border_res;
+  }
+}
+
+template <typename VecTy, typename VecElemTy, typename VecAccessTy>
+IMG_ALWAYS_INLINE VecTy image_3d_sampler_read_helper(
+    const libimg::Float4 &coord, const Sampler sampler,
+    const ImageMetaData &desc, const libimg::UChar *raw_image_data,
+    const VecTy border_res, VecAccessTy read_vec4) {
+  switch (sampler &
+          (NORMALIZED_COORDS_MASK | ADDRESSING_MODE_MASK | FILTER_MODE_MASK)) {
+    IMG_SAMPLER_CASES(3d);
+    default:
+      return border_res;
+  }
+}
+
+#undef IMG_SAMPLER_CASES
+#undef IMG_SAMPLER_ADDRESSING_CASES
+#undef IMG_SAMPLER_CASE
+
 /* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
 /* Read image.                                                               */
 /* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
@@ -3485,13 +3472,10 @@ libimg::UInt4 __Codeplay_read_imageui_1d(Image *image, Sampler sampler,
 /* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
 libimg::Float4 __Codeplay_read_imagef_3d(Image *image, libimg::Int4 coord) {
   ImageMetaData &desc = image->meta_data;
-  const void *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v4<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v4<libimg::Int>(
-                                            coord, libimg::vec_elem::y) +
-                       desc.slice_pitch * libimg::get_v4<libimg::Int>(
-                                              coord, libimg::vec_elem::z)];
+  const void *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::y),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::z))];
   return float4_reader::read(data, desc.channel_order, desc.channel_type);
 }
 
@@ -3510,11 +3494,9 @@ libimg::Float4 __Codeplay_read_imagef_2d_array(Image *image,
 
 libimg::Float4 __Codeplay_read_imagef_2d(Image *image, libimg::Int2 coord) {
   ImageMetaData &desc = image->meta_data;
-  const void *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v2<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v2<libimg::Int>(
-                                            coord, libimg::vec_elem::y)];
+  const void *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::y))];
   return float4_reader::read(data, desc.channel_order, desc.channel_type);
 }
 
@@ -3537,13 +3519,10 @@ libimg::Float4 __Codeplay_read_imagef_1d(Image *image, libimg::Int coord) {
 
 libimg::Int4 __Codeplay_read_imagei_3d(Image *image, libimg::Int4 coord) {
   ImageMetaData &desc = image->meta_data;
-  const void *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v4<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v4<libimg::Int>(
-                                            coord, libimg::vec_elem::y) +
-                       desc.slice_pitch * libimg::get_v4<libimg::Int>(
-                                              coord, libimg::vec_elem::z)];
+  const void *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::y),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::z))];
   return int4_reader::read(data, desc.channel_order, desc.channel_type);
 }
 
@@ -3561,11 +3540,9 @@ libimg::Int4 __Codeplay_read_imagei_2d_array(Image *image, libimg::Int4 coord) {
 
 libimg::Int4 __Codeplay_read_imagei_2d(Image *image, libimg::Int2 coord) {
   ImageMetaData &desc = image->meta_data;
-  const void *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v2<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v2<libimg::Int>(
-                                            coord, libimg::vec_elem::y)];
+  const void *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::y))];
   return int4_reader::read(data, desc.channel_order, desc.channel_type);
 }
 
@@ -3587,13 +3564,10 @@ libimg::Int4 __Codeplay_read_imagei_1d(Image *image, libimg::Int coord) {
 
 libimg::UInt4 __Codeplay_read_imageui_3d(Image *image, libimg::Int4 coord) {
   ImageMetaData &desc = image->meta_data;
-  const void *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v4<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v4<libimg::Int>(
-                                            coord, libimg::vec_elem::y) +
-                       desc.slice_pitch * libimg::get_v4<libimg::Int>(
-                                              coord, libimg::vec_elem::z)];
+  const void *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::y),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::z))];
   return uint4_reader::read(data, desc.channel_order, desc.channel_type);
 }
 
@@ -3612,11 +3586,9 @@ libimg::UInt4 __Codeplay_read_imageui_2d_array(Image *image,
 
 libimg::UInt4 __Codeplay_read_imageui_2d(Image *image, libimg::Int2 coord) {
   ImageMetaData &desc = image->meta_data;
-  const void *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v2<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v2<libimg::Int>(
-                                            coord, libimg::vec_elem::y)];
+  const void *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::y))];
   return uint4_reader::read(data, desc.channel_order, desc.channel_type);
 }
 
@@ -3644,13 +3616,10 @@ libimg::UInt4 __Codeplay_read_imageui_1d(Image *image, libimg::Int coord) {
 void __Codeplay_write_imagef_3d(Image *image, libimg::Int4 coord,
                                 libimg::Float4 color) {
   ImageMetaData &desc = image->meta_data;
-  libimg::UChar *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v4<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v4<libimg::Int>(
-                                            coord, libimg::vec_elem::y) +
-                       desc.slice_pitch * libimg::get_v4<libimg::Int>(
-                                              coord, libimg::vec_elem::z)];
+  libimg::UChar *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::y),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::z))];
   float4_writer::write(data, color, desc.channel_order, desc.channel_type);
 }
 
@@ -3670,11 +3639,9 @@ void __Codeplay_write_imagef_2d_array(Image *image, libimg::Int4 coord,
 void __Codeplay_write_imagef_2d(Image *image, libimg::Int2 coord,
                                 libimg::Float4 color) {
   ImageMetaData &desc = image->meta_data;
-  libimg::UChar *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v2<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v2<libimg::Int>(
-                                            coord, libimg::vec_elem::y)];
+  libimg::UChar *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::y))];
   float4_writer::write(data, color, desc.channel_order, desc.channel_type);
 }
 
@@ -3700,13 +3667,10 @@ void __Codeplay_write_imagef_1d(Image *image, libimg::Int coord,
 void __Codeplay_write_imagei_3d(Image *image, libimg::Int4 coord,
                                 libimg::Int4 color) {
   ImageMetaData &desc = image->meta_data;
-  libimg::UChar *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v4<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v4<libimg::Int>(
-                                            coord, libimg::vec_elem::y) +
-                       desc.slice_pitch * libimg::get_v4<libimg::Int>(
-                                              coord, libimg::vec_elem::z)];
+  libimg::UChar *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::y),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::z))];
   int4_writer::write(data, color, desc.channel_order, desc.channel_type);
 }
 
@@ -3726,11 +3690,9 @@ void __Codeplay_write_imagei_2d_array(Image *image, libimg::Int4 coord,
 void __Codeplay_write_imagei_2d(Image *image, libimg::Int2 coord,
                                 libimg::Int4 color) {
   ImageMetaData &desc = image->meta_data;
-  libimg::UChar *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v2<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v2<libimg::Int>(
-                                            coord, libimg::vec_elem::y)];
+  libimg::UChar *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::y))];
   int4_writer::write(data, color, desc.channel_order, desc.channel_type);
 }
 
@@ -3756,13 +3718,10 @@ void __Codeplay_write_imagei_1d(Image *image, libimg::Int coord,
 void __Codeplay_write_imageui_3d(Image *image, libimg::Int4 coord,
                                  libimg::UInt4 color) {
   ImageMetaData &desc = image->meta_data;
-  libimg::UChar *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v4<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v4<libimg::Int>(
-                                            coord, libimg::vec_elem::y) +
-                       desc.slice_pitch * libimg::get_v4<libimg::Int>(
-                                              coord, libimg::vec_elem::z)];
+  libimg::UChar *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::y),
+      libimg::get_v4<libimg::Int>(coord, libimg::vec_elem::z))];
   uint4_writer::write(data, color, desc.channel_order, desc.channel_type);
 }
 
@@ -3782,11 +3741,9 @@ void __Codeplay_write_imageui_2d_array(Image *image, libimg::Int4 coord,
 void __Codeplay_write_imageui_2d(Image *image, libimg::Int2 coord,
                                  libimg::UInt4 color) {
   ImageMetaData &desc = image->meta_data;
-  libimg::UChar *data =
-      &image->raw_data[desc.pixel_size * libimg::get_v2<libimg::Int>(
-                                             coord, libimg::vec_elem::x) +
-                       desc.row_pitch * libimg::get_v2<libimg::Int>(
-                                            coord, libimg::vec_elem::y)];
+  libimg::UChar *data = &image->raw_data[pixel_offset(
+      desc, libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::x),
+      libimg::get_v2<libimg::Int>(coord, libimg::vec_elem::y))];
   uint4_writer::write(data, color, desc.channel_order, desc.channel_type);
 }
 
@@ -567,6 +567,16 @@ function all_work_group()
   done
 }
 
+function all_pipe()
+{
+  # The pipe builtins themselves are provided by clang, only the helpers from
+  # the OpenCL C headers need declaring.
+  echo "#ifdef __opencl_c_pipes"
+  echo "bool __CL_BUILTIN_ATTRIBUTES is_valid_reserve_id(reserve_id_t reserve_id);"
+  echo "#endif"
+  echo ""
+}
+
 function all_get_fence()
 {
   local body=";"
@@ -690,6 +700,9 @@ function output_for_type()
   all_sub_group >> "$outputFile"
   [[ "header" == "$generated_output_type" ]] && all_work_group >> "$outputFile"
 
+  # Pipe Builtins
+  [[ "header" == "$generated_output_type" ]] && all_pipe >> "$outputFile"
+
   [[ "header" == "$generated_output_type" ]] && sand_line >> "$outputFile"
 
   # Generic Address Space Builtins
@@ -276,7 +276,10 @@ void builtins::printf::print(std::FILE *fp, uint8_t *pack, size_t max_length,
     // read the amount of overflow bytes in size
     uint32_t overflow;
     std::memcpy(&overflow, data + read, 4);
-    read += 4;
+
+    // skip the count of committed bytes, the data is complete by the time we
+    // get here
+    read = builtins::printf::buffer_header_size;
 
     if (size < overflow) {
       ASSERT(size >= overflow,
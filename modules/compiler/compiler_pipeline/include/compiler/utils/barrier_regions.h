@@ -102,12 +102,26 @@ class Barrier {
   /// @brief return whether the barrier struct needs to contain anything
   bool hasLiveVars() const { return !whole_live_variables_set_.empty(); }
 
+  /// @brief return whether any work-group uniform values cross a barrier
+  bool hasUniformLiveVars() const {
+    return !uniform_live_variables_set_.empty();
+  }
+
   /// @brief returns the StructType of the barrier struct
   llvm::StructType *getLiveVarsType() const { return live_var_mem_ty_; }
 
   /// @brief returns the maximum alignment of the barrier struct
   unsigned getLiveVarMaxAlignment() const { return max_live_var_alignment; }
 
+  /// @brief returns the StructType of the uniform values struct, of which
+  /// only a single instance is needed per work-group.
+  llvm::StructType *getUniformVarsType() const { return uniform_var_mem_ty_; }
+
+  /// @brief returns the maximum alignment of the uniform values struct
+  unsigned getUniformVarMaxAlignment() const {
+    return max_uniform_var_alignment;
+  }
+
   /// @brief gets the split subkernels
   const kernel_id_map_t &getSubkernels() const { return kernel_id_map_; }
 
@@ -171,13 +185,17 @@ class Barrier {
     llvm::DenseMap<const llvm::Value *, llvm::Value *> reloads;
     llvm::IRBuilder<> gepBuilder;
     llvm::Value *barrier_struct = nullptr;
+    /// @brief The work-group's uniform values struct, if any.
+    llvm::Value *uniform_struct = nullptr;
     llvm::Value *vscale = nullptr;
 
-    LiveValuesHelper(const Barrier &b, llvm::Instruction *i, llvm::Value *s)
-        : barrier(b), gepBuilder(i), barrier_struct(s) {}
+    LiveValuesHelper(const Barrier &b, llvm::Instruction *i, llvm::Value *s,
+                     llvm::Value *u = nullptr)
+        : barrier(b), gepBuilder(i), barrier_struct(s), uniform_struct(u) {}
 
-    LiveValuesHelper(const Barrier &b, llvm::BasicBlock *bb, llvm::Value *s)
-        : barrier(b), gepBuilder(bb), barrier_struct(s) {}
+    LiveValuesHelper(const Barrier &b, llvm::BasicBlock *bb, llvm::Value *s,
+                     llvm::Value *u = nullptr)
+        : barrier(b), gepBuilder(bb), barrier_struct(s), uniform_struct(u) {}
 
     /// @brief Return a GEP instruction pointing to the given value/idx pair in
     /// the barrier struct.
@@ -235,6 +253,11 @@ class Barrier {
 
   /// @brief Keep whole live variables at all of barriers.
   live_variable_mem_t whole_live_variables_set_;
+  /// @brief Live variables that are uniform across the work-group, which are
+  /// stored once rather than per work-item.
+  live_variable_mem_t uniform_live_variables_set_;
+  /// @brief Keep index of uniform live variables in the uniform struct.
+  live_variable_index_map_t uniform_variable_index_map_;
   /// @brief Keep index of live variables on live variable information.
   live_variable_index_map_t live_variable_index_map_;
   /// @brief Keep offsets of scalable live variables.
@@ -247,6 +270,8 @@ class Barrier {
   kernel_id_map_t kernel_id_map_;
   /// @brief Keep struct types for live variables' memory layout.
   llvm::StructType *live_var_mem_ty_;
+  /// @brief Keep struct type for uniform live variables' memory layout.
+  llvm::StructType *uniform_var_mem_ty_ = nullptr;
   /// @brief The total size of the non-scalable barrier struct
   size_t live_var_mem_size_fixed = 0;
   /// @brief The total unscaled size of the scalable barrier struct
@@ -277,6 +302,9 @@ class Barrier {
   // @brief max alignment required for the live variables.
   unsigned max_live_var_alignment;
 
+  // @brief max alignment required for the uniform live variables.
+  unsigned max_uniform_var_alignment = 0;
+
   /// @brief Find Barriers.
   void FindBarriers();
 
@@ -323,6 +351,23 @@ class Barrier {
   ///        barrier, for instance casts and vector splats.
   void TidyLiveVariables();
 
+  /// @brief Remove pure expressions that are cheaper to recompute after a
+  /// barrier from their operands than to store in the barrier.
+  ///
+  /// @param[in] mam Analysis manager used to get the target's costs.
+  void RematerializeLiveVariables(llvm::ModuleAnalysisManager &mam);
+
+  /// @brief Move live variables that are uniform across the work-group into
+  /// the uniform values struct.
+  void FindUniformLiveVariables();
+
+  /// @brief Gather the values read from the barrier struct by the work-item
+  /// loops themselves, which must stay in the per work-item barrier struct.
+  ///
+  /// @param[out] values the operands of the barrier calls and everything they
+  /// are computed from.
+  void GatherBarrierOperands(llvm::DenseSet<llvm::Value *> &values);
+
   /// @brief Pad the field types to an alignment by adding an int array if
   /// needed
   /// @param field_tys The vector of types representing the final structure
@@ -335,6 +380,9 @@ class Barrier {
   /// @brief Make type for whole live variables.
   void MakeLiveVariableMemType();
 
+  /// @brief Make type for uniform live variables.
+  void MakeUniformVariableMemType();
+
   /// @brief Generate new kernel from an inter-barrier region such that no call
   /// to barriers occur within it.
   ///
@@ -707,6 +707,8 @@ class BIMuxInfoConcept {
   ///   * spirv.Event -> i32
   ///   * spirv.Sampler -> i32
   ///   * spirv.Image -> MuxImage* (regardless of image parameters)
+  ///   * spirv.Pipe -> ptr addrspace(1) (the pipe's storage)
+  ///   * spirv.ReserveId -> ptr (an encoded pipe reservation)
   virtual llvm::Type *getRemappedTargetExtTy(llvm::Type *Ty, llvm::Module &M);
 
   /// @see BuiltinInfo::getBuiltinRange
@@ -121,6 +121,9 @@ class CLBuiltinInfo : public BILangInfoConcept {
   llvm::Instruction *lowerAsyncBuiltinToMuxBuiltin(llvm::CallInst &CI,
                                                    BuiltinID ID,
                                                    BIMuxInfoConcept &BIMuxImpl);
+  llvm::Instruction *lowerPipeBuiltinToMuxBuiltin(llvm::CallInst &CI,
+                                                  BuiltinID ID,
+                                                  BIMuxInfoConcept &BIMuxImpl);
 
   llvm::Value *emitBuiltinInline(BuiltinID ID, llvm::IRBuilder<> &B,
                                  llvm::ArrayRef<llvm::Value *> Args);
@@ -24,6 +24,7 @@
 #include <optional>
 
 namespace llvm {
+class AllocaInst;
 class Function;
 class Module;
 }  // namespace llvm
@@ -290,6 +291,19 @@ void encodeReqdSubgroupSizeMetadata(llvm::Function &f, uint32_t size);
 /// @returns The required sub-group size if present, else `std::nullopt`
 std::optional<uint32_t> getReqdSubgroupSize(const llvm::Function &f);
 
+/// @brief Marks an alloca as allocating a kernel's local memory.
+///
+/// Local memory is allocated on the stack by default, this lets targets find
+/// the allocations to place them elsewhere.
+///
+/// @param[in] alloca Alloca to mark.
+void setIsLocalMemoryAlloca(llvm::AllocaInst &alloca);
+
+/// @brief Returns whether an alloca was marked with `setIsLocalMemoryAlloca`.
+///
+/// @param[in] alloca Alloca to check.
+bool isLocalMemoryAlloca(const llvm::AllocaInst &alloca);
+
 }  // namespace utils
 }  // namespace compiler
 
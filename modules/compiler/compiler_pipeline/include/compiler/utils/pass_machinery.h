@@ -105,6 +105,8 @@ class PassMachinery {
   llvm::TargetMachine *getTM() { return TM; }
   const llvm::TargetMachine *getTM() const { return TM; }
 
+  llvm::PassInstrumentationCallbacks &getPIC() { return PIC; }
+
  protected:
   /// @brief TargetMachine to be used for passes. May be nullptr.
   llvm::TargetMachine *TM;
@@ -237,6 +237,7 @@ PreservedAnalyses compiler::utils::AddKernelWrapperPass::run(
         auto *load = ir.CreateAlignedLoad(intermediateTy, gep, llvmAlignment);
         auto *allocaInst = ir.CreateAlloca(ir.getInt8Ty(), load);
         allocaInst->setAlignment(llvm::Align(sizeof(uint64_t) * 16));
+        compiler::utils::setIsLocalMemoryAlloca(*allocaInst);
 
         params.push_back(ir.CreateAddrSpaceCast(allocaInst, type));
       } else if (arg.hasByValAttr()) {
@@ -24,8 +24,11 @@
 #include <llvm/ADT/SetVector.h>
 #include <llvm/ADT/SmallSet.h>
 #include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/Statistic.h>
 #include <llvm/ADT/StringSet.h>
 #include <llvm/ADT/TinyPtrVector.h>
+#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Analysis/ValueTracking.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/DebugInfo.h>
@@ -47,8 +50,27 @@ using namespace llvm;
 #define NDEBUG_BARRIER
 #define DEBUG_TYPE "barrier-regions"
 
+STATISTIC(LiveVarBytesBefore,
+          "Bytes per work-item of barrier live variables before tidying");
+STATISTIC(LiveVarBytesAfter,
+          "Bytes per work-item of barrier live variables after tidying");
+STATISTIC(UniformVarBytes,
+          "Bytes per work-group of uniform barrier live variables");
+STATISTIC(NumRematerializedVars,
+          "Number of barrier live variables rematerialized");
+STATISTIC(NumUniformVars, "Number of uniform barrier live variables");
+
 using AlignIntTy = uint64_t;
 
+/// @brief The most a live variable may cost to recompute after a barrier, in
+/// units of TargetTransformInfo::TCC_Basic, for it not to be stored. Storing
+/// it costs a store per work-item, a load per use and the memory itself.
+static constexpr unsigned RematerializationBudget = 4;
+
+/// @brief The deepest expression tree we will look through when deciding
+/// whether a value can be rematerialized or is uniform.
+static constexpr unsigned MaxExpressionDepth = 8;
+
 /// @brief it returns true if and only if the instruction is a work group
 /// collective call, and returns false otherwise.
 static std::optional<compiler::utils::GroupCollective>
@@ -238,6 +260,130 @@ static bool IsTrivialValue(Value *v, unsigned depth,
   return false;
 }
 
+/// @brief Check whether an instruction computes its result purely from its
+/// operands, so that it gives the same result wherever it is executed.
+static bool IsPureOperation(const Instruction *I) {
+  if (isa<PHINode>(I) || isa<AllocaInst>(I) || I->isTerminator() ||
+      I->mayReadOrWriteMemory() || I->mayHaveSideEffects()) {
+    return false;
+  }
+  if (auto *const call = dyn_cast<CallBase>(I)) {
+    // Only intrinsics are understood well enough to be recomputed.
+    return isa<IntrinsicInst>(call) && !call->isConvergent();
+  }
+  return true;
+}
+
+/// @brief Get the cost of recomputing a value after a barrier rather than
+/// reloading it from the barrier struct.
+///
+/// @param[in] I Instruction to recompute.
+/// @param[in] is_stored Returns whether a value is in the barrier struct, in
+/// which case it is reloaded instead of being recomputed.
+/// @param[in] TTI Target costs.
+/// @param[in] bi Builtin information.
+/// @param[in] depth Depth of `I` in the expression being recomputed.
+///
+/// @return The cost of recomputing `I` and any operands not in the barrier,
+/// or std::nullopt if it can't be recomputed within the budget.
+static std::optional<InstructionCost> GetRematerializationCost(
+    Instruction *I, function_ref<bool(Value *)> is_stored,
+    const TargetTransformInfo &TTI, compiler::utils::BuiltinInfo &bi,
+    unsigned depth = 0) {
+  // The value is recomputed at the start of the region using it, which may be
+  // on a path where its operands were never computed, so it must not trap.
+  if (depth > MaxExpressionDepth || !IsPureOperation(I) ||
+      !isSafeToSpeculativelyExecute(I)) {
+    return std::nullopt;
+  }
+
+  InstructionCost cost =
+      TTI.getInstructionCost(I, TargetTransformInfo::TCK_SizeAndLatency);
+  for (auto *op : I->operand_values()) {
+    auto *const op_inst = dyn_cast<Instruction>(op);
+    if (!op_inst) {
+      continue;
+    }
+    if (is_stored(op_inst) || IsRematerializableBuiltinCall(op_inst, bi)) {
+      cost += TargetTransformInfo::TCC_Basic;
+    } else if (auto op_cost = GetRematerializationCost(op_inst, is_stored, TTI,
+                                                       bi, depth + 1)) {
+      cost += *op_cost;
+    } else {
+      return std::nullopt;
+    }
+    if (!cost.isValid() || cost > RematerializationBudget) {
+      return std::nullopt;
+    }
+  }
+  if (!cost.isValid() || cost > RematerializationBudget) {
+    return std::nullopt;
+  }
+  return cost;
+}
+
+/// @brief Check whether a builtin call returns the same value for every
+/// work-item in the work-group.
+static bool IsWorkGroupUniformBuiltinCall(CallInst *call,
+                                          compiler::utils::BuiltinInfo &bi) {
+  auto *const F = call->getCalledFunction();
+  if (!F) {
+    return false;
+  }
+  const auto B = bi.analyzeBuiltin(*F);
+  if (!B) {
+    return false;
+  }
+  switch (B->ID) {
+    case compiler::utils::eMuxBuiltinGetGroupId:
+    case compiler::utils::eMuxBuiltinGetNumGroups:
+    case compiler::utils::eMuxBuiltinGetLocalSize:
+    case compiler::utils::eMuxBuiltinGetEnqueuedLocalSize:
+    case compiler::utils::eMuxBuiltinGetGlobalSize:
+    case compiler::utils::eMuxBuiltinGetGlobalOffset:
+    case compiler::utils::eMuxBuiltinGetWorkDim:
+    case compiler::utils::eMuxBuiltinGetMaxSubGroupSize:
+    case compiler::utils::eMuxBuiltinGetNumSubGroups:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// @brief Check whether a value is the same for every work-item in the
+/// work-group, because it is computed purely from constants, kernel arguments
+/// and work-group builtins.
+///
+/// Loads are never uniform, since another work-item may write to the memory
+/// between two work-items reading it.
+static bool IsWorkGroupUniform(Value *v, DenseMap<Value *, bool> &cache,
+                               compiler::utils::BuiltinInfo &bi,
+                               unsigned depth = 0) {
+  if (isa<Constant>(v) || isa<Argument>(v)) {
+    return true;
+  }
+  auto *const I = dyn_cast<Instruction>(v);
+  if (!I || depth > MaxExpressionDepth) {
+    return false;
+  }
+  if (auto it = cache.find(I); it != cache.end()) {
+    return it->second;
+  }
+
+  bool uniform = false;
+  auto *const call = dyn_cast<CallInst>(I);
+  if (call && !isa<IntrinsicInst>(call)) {
+    uniform = IsWorkGroupUniformBuiltinCall(call, bi);
+  } else {
+    uniform = IsPureOperation(I);
+  }
+  uniform = uniform && all_of(I->operand_values(), [&](Value *op) {
+              return IsWorkGroupUniform(op, cache, bi, depth + 1);
+            });
+  cache[I] = uniform;
+  return uniform;
+}
+
 // GEPs typically have a low cost, allow up to 1 non-trivial operand
 // (including the pointer operand as well as the indices).
 static bool IsTrivialGEP(Value *v, SmallVectorImpl<Value *> &operands) {
@@ -297,6 +443,42 @@ static bool isStructWithScalables(Type *ty) {
   return false;
 }
 
+/// @brief Get the size of a struct holding the given values, laid out the
+/// way the barrier struct is, with scalable vectors at their minimum size.
+static uint64_t GetLiveVariablesSize(const DataLayout &dl,
+                                     ArrayRef<Value *> values) {
+  SmallVector<std::pair<uint64_t, uint64_t>, 32> members;
+  uint64_t max_alignment = 1;
+  for (auto *const v : values) {
+    Type *ty = v->getType();
+    uint64_t alignment = 0;
+    if (auto *const AI = dyn_cast<AllocaInst>(v)) {
+      ty = AI->getAllocatedType();
+      alignment = AI->getAlign().value();
+    }
+    if (isStructWithScalables(ty)) {
+      // Structs of scalables are stored decomposed.
+      for (auto *const elt_ty : cast<StructType>(ty)->elements()) {
+        members.push_back({dl.getPrefTypeAlign(elt_ty).value(),
+                           dl.getTypeAllocSize(elt_ty).getKnownMinValue()});
+      }
+      continue;
+    }
+    alignment = std::max(dl.getPrefTypeAlign(ty).value(), alignment);
+    members.push_back({alignment, dl.getTypeAllocSize(ty).getKnownMinValue()});
+  }
+  std::stable_sort(members.begin(), members.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     return lhs.first > rhs.first;
+                   });
+  uint64_t size = 0;
+  for (const auto &[alignment, member_size] : members) {
+    max_alignment = std::max(max_alignment, alignment);
+    size = alignTo(size, alignment) + member_size;
+  }
+  return alignTo(size, max_alignment);
+}
+
 Value *compiler::utils::Barrier::LiveValuesHelper::getExtractValueGEP(
     const Value *live) {
   if (auto *const extract = dyn_cast<ExtractValueInst>(live)) {
@@ -328,6 +510,18 @@ Value *compiler::utils::Barrier::LiveValuesHelper::getGEP(const Value *live,
     gep = gepBuilder.CreateInBoundsGEP(barrier.live_var_mem_ty_, barrier_struct,
                                        live_variable_info_idxs,
                                        Twine("live_gep_") + live->getName());
+  } else if (auto field_it = barrier.uniform_variable_index_map_.find(key);
+             field_it != barrier.uniform_variable_index_map_.end()) {
+    assert(uniform_struct && "Uniform live variable without a uniform struct");
+    LLVMContext &context = barrier.module_.getContext();
+    const unsigned field_index = field_it->second;
+    Value *uniform_variable_info_idxs[2] = {
+        ConstantInt::get(Type::getInt32Ty(context), 0),
+        ConstantInt::get(Type::getInt32Ty(context), field_index)};
+
+    gep = gepBuilder.CreateInBoundsGEP(
+        barrier.uniform_var_mem_ty_, uniform_struct, uniform_variable_info_idxs,
+        Twine("uniform_gep_") + live->getName());
   } else if (auto field_it = barrier.live_variable_scalables_map_.find(key);
              field_it != barrier.live_variable_scalables_map_.end()) {
     const unsigned field_offset = field_it->second;
@@ -471,6 +665,10 @@ void compiler::utils::Barrier::Run(llvm::ModuleAnalysisManager &mam) {
   SplitBlockwithBarrier();
   FindLiveVariables();
 
+  const auto &dl = module_.getDataLayout();
+  LiveVarBytesBefore +=
+      GetLiveVariablesSize(dl, whole_live_variables_set_.getArrayRef());
+
   // Tidy up the barrier struct, removing values that we can
   // reload/rematerialize on the other side of the barrier.
   // NB: We don't do this if any of the barriers is a work-group broadcast. In
@@ -493,7 +691,19 @@ void compiler::utils::Barrier::Run(llvm::ModuleAnalysisManager &mam) {
     TidyLiveVariables();
   }
 
+  // Values read by the work-item loops themselves are left alone by these,
+  // so they are safe even in the presence of broadcasts.
+  RematerializeLiveVariables(mam);
+  FindUniformLiveVariables();
+
   MakeLiveVariableMemType();
+  MakeUniformVariableMemType();
+
+  LiveVarBytesAfter +=
+      GetLiveVariablesSize(dl, whole_live_variables_set_.getArrayRef());
+  UniformVarBytes +=
+      GetLiveVariablesSize(dl, uniform_live_variables_set_.getArrayRef());
+
   SeperateKernelWithBarrier();
 }
 
@@ -843,6 +1053,87 @@ void compiler::utils::Barrier::TidyLiveVariables() {
   whole_live_variables_set_.set_subtract(removals);
 }
 
+void compiler::utils::Barrier::GatherBarrierOperands(
+    DenseSet<Value *> &values) {
+  SmallVector<Value *, 16> worklist;
+  for (auto *const call : barriers_) {
+    for (auto &op : call->args()) {
+      worklist.push_back(op.get());
+    }
+  }
+  while (!worklist.empty()) {
+    auto *const I = dyn_cast<Instruction>(worklist.pop_back_val());
+    if (!I || !values.insert(I).second) {
+      continue;
+    }
+    for (auto *op : I->operand_values()) {
+      worklist.push_back(op);
+    }
+  }
+}
+
+/// @brief Remove pure expressions that are cheaper to recompute after a
+/// barrier from their operands than to store in the barrier.
+void compiler::utils::Barrier::RematerializeLiveVariables(
+    ModuleAnalysisManager &mam) {
+  auto &fam =
+      mam.getResult<FunctionAnalysisManagerModuleProxy>(module_).getManager();
+  const auto &TTI = fam.getResult<TargetIRAnalysis>(func_);
+
+  // The work-item loops reload the operands of barriers from the barrier
+  // struct without being able to recompute anything, so leave those alone.
+  DenseSet<Value *> barrier_operands;
+  GatherBarrierOperands(barrier_operands);
+
+  SmallVector<Instruction *, 16> candidates;
+  for (auto *v : whole_live_variables_set_) {
+    if (auto *const I = dyn_cast<Instruction>(v);
+        I && !barrier_operands.contains(I)) {
+      candidates.push_back(I);
+    }
+  }
+
+  // Candidates are removed one at a time, so that each cost accounts for the
+  // values already removed, which will have to be recomputed too. Every value
+  // removed can be recomputed, so removing more later never makes an earlier
+  // removal invalid.
+  for (auto *I : candidates) {
+    auto is_stored = [&](Value *v) {
+      return v != I && whole_live_variables_set_.contains(v);
+    };
+    if (GetRematerializationCost(I, is_stored, TTI, *bi_)) {
+      LLVM_DEBUG(dbgs() << "rematerializing: " << *I << "\n");
+      whole_live_variables_set_.remove(I);
+      ++NumRematerializedVars;
+    }
+  }
+}
+
+/// @brief Move live variables that are uniform across the work-group into
+/// the uniform values struct.
+void compiler::utils::Barrier::FindUniformLiveVariables() {
+  // The work-item loops only know about the per work-item barrier struct.
+  DenseSet<Value *> barrier_operands;
+  GatherBarrierOperands(barrier_operands);
+
+  DenseMap<Value *, bool> cache;
+  SmallVector<Value *, 8> uniforms;
+  for (auto *v : whole_live_variables_set_) {
+    Type *const ty = v->getType();
+    if (!isa<Instruction>(v) || barrier_operands.contains(v) ||
+        isa<ScalableVectorType>(ty) || isStructWithScalables(ty)) {
+      continue;
+    }
+    if (IsWorkGroupUniform(v, cache, *bi_)) {
+      LLVM_DEBUG(dbgs() << "uniform: " << *v << "\n");
+      uniforms.push_back(v);
+    }
+  }
+  whole_live_variables_set_.set_subtract(uniforms);
+  uniform_live_variables_set_.insert(uniforms.begin(), uniforms.end());
+  NumUniformVars += uniforms.size();
+}
+
 /// @brief Pad the field types to an alignment by adding an int array if
 /// needed
 /// @param field_tys The vector of types representing the final structure
@@ -1015,6 +1306,45 @@ void compiler::utils::Barrier::MakeLiveVariableMemType() {
              dbgs() << "whole live set type:" << *(live_var_mem_ty_) << '\n';);
 }
 
+/// @brief Make type for uniform live variables.
+void compiler::utils::Barrier::MakeUniformVariableMemType() {
+  if (uniform_live_variables_set_.empty()) {
+    return;
+  }
+
+  const auto &dl = module_.getDataLayout();
+  SmallVector<Value *, 8> members(uniform_live_variables_set_.begin(),
+                                  uniform_live_variables_set_.end());
+  // sort the members by decreasing alignment to minimise the amount of
+  // padding required (use a stable sort so it's deterministic)
+  std::stable_sort(members.begin(), members.end(),
+                   [&dl](Value *lhs, Value *rhs) {
+                     return dl.getPrefTypeAlign(lhs->getType()) >
+                            dl.getPrefTypeAlign(rhs->getType());
+                   });
+
+  SmallVector<Type *, 8> field_tys;
+  unsigned offset = 0;
+  for (auto *const member : members) {
+    Type *const ty = member->getType();
+    const unsigned alignment = dl.getPrefTypeAlign(ty).value();
+    max_uniform_var_alignment = std::max(alignment, max_uniform_var_alignment);
+    offset = PadTypeToAlignment(field_tys, offset, alignment);
+    uniform_variable_index_map_[std::make_pair(member, 0u)] = field_tys.size();
+    field_tys.push_back(ty);
+    offset += dl.getTypeAllocSize(ty);
+  }
+
+  SmallString<128> name;
+  uniform_var_mem_ty_ = StructType::create(
+      module_.getContext(), field_tys,
+      (Twine(func_.getName() + "_live_uniform_info")).toStringRef(name),
+      false);
+
+  LLVM_DEBUG(dbgs() << "Uniform size: " << offset << "\n";
+             dbgs() << "uniform set type:" << *(uniform_var_mem_ty_) << '\n';);
+}
+
 /// @brief Generate new kernel from an inter-barrier region such that no call
 /// to barriers occur within it.
 ///
@@ -1057,6 +1387,14 @@ Function *compiler::utils::Barrier::GenerateNewKernel(BarrierRegion &region) {
     new_func_params.push_back(pty);
   }
 
+  // Followed by the uniform values' parameter if there are any.
+  const bool hasUniformStruct = !uniform_live_variables_set_.empty() &&
+                                region.schedule != BarrierSchedule::Once;
+  if (hasUniformStruct) {
+    PointerType *pty = PointerType::get(context, /*AddressSpace=*/0);
+    new_func_params.push_back(pty);
+  }
+
   // Make new kernel function.
   FunctionType *new_fty = FunctionType::get(Type::getInt32Ty(context),
                                             new_func_params, func_.isVarArg());
@@ -1186,10 +1524,14 @@ Function *compiler::utils::Barrier::GenerateNewKernel(BarrierRegion &region) {
   }
 
   // It puts all the GEPs at the start of the kernel, but only once
-  LiveValuesHelper live_values(
-      *this, insert_point,
-      hasBarrierStruct ? compiler::utils::getLastArgument(new_kernel)
-                       : nullptr);
+  Argument *const uniform_struct =
+      hasUniformStruct ? compiler::utils::getLastArgument(new_kernel) : nullptr;
+  Argument *const barrier_struct =
+      hasBarrierStruct
+          ? new_kernel->getArg(new_kernel->arg_size() - 1 - hasUniformStruct)
+          : nullptr;
+  LiveValuesHelper live_values(*this, insert_point, barrier_struct,
+                               uniform_struct);
 
   // Load live variables and map them.
   // These variables are defined in a different kernel, so we insert the
@@ -1424,7 +1766,8 @@ BasicBlock *compiler::utils::Barrier::CloneBasicBlock(
     new_inst->insertInto(new_bb, new_bb->end());
 
     // Record live variables' defs which are in current kernel.
-    if (whole_live_variables_set_.contains(&i)) {
+    if (whole_live_variables_set_.contains(&i) ||
+        uniform_live_variables_set_.contains(&i)) {
       live_defs_info.insert(&i);
     }
 
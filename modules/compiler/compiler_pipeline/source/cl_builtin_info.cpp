@@ -268,6 +268,50 @@ enum CLBuiltinID : compiler::utils::BuiltinID {
   /// @brief OpenCL builtin 'printf'.
   eCLBuiltinPrintf,
 
+  // 6.13.16 Pipe Functions
+  /// @brief OpenCL builtin 'read_pipe' with two arguments.
+  eCLBuiltinReadPipe2,
+  /// @brief OpenCL builtin 'read_pipe' with four arguments.
+  eCLBuiltinReadPipe4,
+  /// @brief OpenCL builtin 'write_pipe' with two arguments.
+  eCLBuiltinWritePipe2,
+  /// @brief OpenCL builtin 'write_pipe' with four arguments.
+  eCLBuiltinWritePipe4,
+  /// @brief OpenCL builtin 'reserve_read_pipe'.
+  eCLBuiltinReserveReadPipe,
+  /// @brief OpenCL builtin 'reserve_write_pipe'.
+  eCLBuiltinReserveWritePipe,
+  /// @brief OpenCL builtin 'commit_read_pipe'.
+  eCLBuiltinCommitReadPipe,
+  /// @brief OpenCL builtin 'commit_write_pipe'.
+  eCLBuiltinCommitWritePipe,
+  /// @brief OpenCL builtin 'is_valid_reserve_id'.
+  eCLBuiltinIsValidReserveId,
+  /// @brief OpenCL builtin 'get_pipe_num_packets' on a read-only pipe.
+  eCLBuiltinGetPipeNumPacketsRO,
+  /// @brief OpenCL builtin 'get_pipe_num_packets' on a write-only pipe.
+  eCLBuiltinGetPipeNumPacketsWO,
+  /// @brief OpenCL builtin 'get_pipe_max_packets' on a read-only pipe.
+  eCLBuiltinGetPipeMaxPacketsRO,
+  /// @brief OpenCL builtin 'get_pipe_max_packets' on a write-only pipe.
+  eCLBuiltinGetPipeMaxPacketsWO,
+  /// @brief OpenCL builtin 'work_group_reserve_read_pipe'.
+  eCLBuiltinWorkgroupReserveReadPipe,
+  /// @brief OpenCL builtin 'work_group_reserve_write_pipe'.
+  eCLBuiltinWorkgroupReserveWritePipe,
+  /// @brief OpenCL builtin 'work_group_commit_read_pipe'.
+  eCLBuiltinWorkgroupCommitReadPipe,
+  /// @brief OpenCL builtin 'work_group_commit_write_pipe'.
+  eCLBuiltinWorkgroupCommitWritePipe,
+  /// @brief OpenCL builtin 'sub_group_reserve_read_pipe'.
+  eCLBuiltinSubgroupReserveReadPipe,
+  /// @brief OpenCL builtin 'sub_group_reserve_write_pipe'.
+  eCLBuiltinSubgroupReserveWritePipe,
+  /// @brief OpenCL builtin 'sub_group_commit_read_pipe'.
+  eCLBuiltinSubgroupCommitReadPipe,
+  /// @brief OpenCL builtin 'sub_group_commit_write_pipe'.
+  eCLBuiltinSubgroupCommitWritePipe,
+
   // 6.15.16 Work-group Collective Functions
   /// @brief OpenCL builtin 'work_group_all'.
   eCLBuiltinWorkgroupAll,
@@ -651,6 +695,37 @@ static constexpr CLBuiltinEntry Builtins[] = {
     // 6.12.13 printf
     {eCLBuiltinPrintf, "printf"},
 
+    // 6.13.16 Pipe Functions, which clang calls by their unmangled names
+    {eCLBuiltinReadPipe2, "__read_pipe_2", OpenCLC20},
+    {eCLBuiltinReadPipe4, "__read_pipe_4", OpenCLC20},
+    {eCLBuiltinWritePipe2, "__write_pipe_2", OpenCLC20},
+    {eCLBuiltinWritePipe4, "__write_pipe_4", OpenCLC20},
+    {eCLBuiltinReserveReadPipe, "__reserve_read_pipe", OpenCLC20},
+    {eCLBuiltinReserveWritePipe, "__reserve_write_pipe", OpenCLC20},
+    {eCLBuiltinCommitReadPipe, "__commit_read_pipe", OpenCLC20},
+    {eCLBuiltinCommitWritePipe, "__commit_write_pipe", OpenCLC20},
+    {eCLBuiltinIsValidReserveId, "is_valid_reserve_id", OpenCLC20},
+    {eCLBuiltinGetPipeNumPacketsRO, "__get_pipe_num_packets_ro", OpenCLC20},
+    {eCLBuiltinGetPipeNumPacketsWO, "__get_pipe_num_packets_wo", OpenCLC20},
+    {eCLBuiltinGetPipeMaxPacketsRO, "__get_pipe_max_packets_ro", OpenCLC20},
+    {eCLBuiltinGetPipeMaxPacketsWO, "__get_pipe_max_packets_wo", OpenCLC20},
+    {eCLBuiltinWorkgroupReserveReadPipe, "__work_group_reserve_read_pipe",
+     OpenCLC20},
+    {eCLBuiltinWorkgroupReserveWritePipe, "__work_group_reserve_write_pipe",
+     OpenCLC20},
+    {eCLBuiltinWorkgroupCommitReadPipe, "__work_group_commit_read_pipe",
+     OpenCLC20},
+    {eCLBuiltinWorkgroupCommitWritePipe, "__work_group_commit_write_pipe",
+     OpenCLC20},
+    {eCLBuiltinSubgroupReserveReadPipe, "__sub_group_reserve_read_pipe",
+     OpenCLC20},
+    {eCLBuiltinSubgroupReserveWritePipe, "__sub_group_reserve_write_pipe",
+     OpenCLC20},
+    {eCLBuiltinSubgroupCommitReadPipe, "__sub_group_commit_read_pipe",
+     OpenCLC20},
+    {eCLBuiltinSubgroupCommitWritePipe, "__sub_group_commit_write_pipe",
+     OpenCLC20},
+
     // 6.15.16 Work-group Collective Functions
     {eCLBuiltinWorkgroupAll, "work_group_all", OpenCLC20},
     {eCLBuiltinWorkgroupAny, "work_group_any", OpenCLC20},
@@ -992,6 +1067,37 @@ std::optional<Builtin> CLBuiltinInfo::analyzeBuiltin(
       Properties |= eBuiltinPropertySideEffects;
       Properties |= eBuiltinPropertySupportsInstantiation;
       break;
+    case eCLBuiltinWorkgroupReserveReadPipe:
+    case eCLBuiltinWorkgroupReserveWritePipe:
+    case eCLBuiltinWorkgroupCommitReadPipe:
+    case eCLBuiltinWorkgroupCommitWritePipe:
+    case eCLBuiltinSubgroupReserveReadPipe:
+    case eCLBuiltinSubgroupReserveWritePipe:
+    case eCLBuiltinSubgroupCommitReadPipe:
+    case eCLBuiltinSubgroupCommitWritePipe:
+      // Only one work-item of the group touches the pipe, so these must be
+      // reached by the whole group.
+      IsConvergent = true;
+      LLVM_FALLTHROUGH;
+    case eCLBuiltinReadPipe2:
+    case eCLBuiltinReadPipe4:
+    case eCLBuiltinWritePipe2:
+    case eCLBuiltinWritePipe4:
+    case eCLBuiltinReserveReadPipe:
+    case eCLBuiltinReserveWritePipe:
+    case eCLBuiltinCommitReadPipe:
+    case eCLBuiltinCommitWritePipe:
+    case eCLBuiltinGetPipeNumPacketsRO:
+    case eCLBuiltinGetPipeNumPacketsWO:
+    case eCLBuiltinGetPipeMaxPacketsRO:
+    case eCLBuiltinGetPipeMaxPacketsWO:
+      Properties |= eBuiltinPropertySideEffects;
+      Properties |= eBuiltinPropertyLowerToMuxBuiltin;
+      break;
+    case eCLBuiltinIsValidReserveId:
+      Properties |= eBuiltinPropertyNoSideEffects;
+      Properties |= eBuiltinPropertyLowerToMuxBuiltin;
+      break;
     case eCLBuiltinAsyncWorkGroupCopy:
     case eCLBuiltinAsyncWorkGroupStridedCopy:
     case eCLBuiltinWaitGroupEvents:
@@ -2870,6 +2976,28 @@ Instruction *CLBuiltinInfo::lowerBuiltinToMuxBuiltin(
     case eCLBuiltinAsyncWorkGroupCopy2D2D:
     case eCLBuiltinAsyncWorkGroupCopy3D3D:
       return lowerAsyncBuiltinToMuxBuiltin(CI, *ID, BIMuxImpl);
+    case eCLBuiltinReadPipe2:
+    case eCLBuiltinReadPipe4:
+    case eCLBuiltinWritePipe2:
+    case eCLBuiltinWritePipe4:
+    case eCLBuiltinReserveReadPipe:
+    case eCLBuiltinReserveWritePipe:
+    case eCLBuiltinCommitReadPipe:
+    case eCLBuiltinCommitWritePipe:
+    case eCLBuiltinIsValidReserveId:
+    case eCLBuiltinGetPipeNumPacketsRO:
+    case eCLBuiltinGetPipeNumPacketsWO:
+    case eCLBuiltinGetPipeMaxPacketsRO:
+    case eCLBuiltinGetPipeMaxPacketsWO:
+    case eCLBuiltinWorkgroupReserveReadPipe:
+    case eCLBuiltinWorkgroupReserveWritePipe:
+    case eCLBuiltinWorkgroupCommitReadPipe:
+    case eCLBuiltinWorkgroupCommitWritePipe:
+    case eCLBuiltinSubgroupReserveReadPipe:
+    case eCLBuiltinSubgroupReserveWritePipe:
+    case eCLBuiltinSubgroupCommitReadPipe:
+    case eCLBuiltinSubgroupCommitWritePipe:
+      return lowerPipeBuiltinToMuxBuiltin(CI, *ID, BIMuxImpl);
     case eCLBuiltinWaitGroupEvents: {
       auto *const MuxWait =
           BIMuxImpl.getOrDeclareMuxBuiltin(eMuxBuiltinDMAWait, M);
@@ -3527,6 +3655,435 @@ Instruction *CLBuiltinInfo::lowerAsyncBuiltinToMuxBuiltin(
   return nullptr;
 }
 
+namespace {
+/// @brief Byte offsets into the header at the start of a pipe's storage.
+///
+/// This must match the header `_cl_mem_buffer::createPipe` writes. Each counter
+/// has a cache line to itself so that readers and writers don't contend.
+enum PipeHeaderOffset : uint64_t {
+  /// @brief Number of packets in the ring, always a power of two.
+  PipeCapacityOffset = 4,
+  /// @brief Maximum number of packets the pipe holds.
+  PipeMaxPacketsOffset = 8,
+  /// @brief Counter of packets reserved by writers.
+  PipeWriteReserveOffset = 64,
+  /// @brief Counter of packets committed by writers.
+  PipeWriteCommitOffset = 128,
+  /// @brief Counter of packets reserved by readers.
+  PipeReadReserveOffset = 192,
+  /// @brief Counter of packets committed by readers.
+  PipeReadCommitOffset = 256,
+  /// @brief Start of the ring of packets.
+  PipeDataOffset = 384,
+};
+}  // namespace
+
+/// @brief Gets a pointer to a field of a pipe's header.
+static Value *getPipeHeaderField(IRBuilder<> &B, Value *Pipe,
+                                 PipeHeaderOffset Offset) {
+  return B.CreateConstInBoundsGEP1_64(B.getInt8Ty(), Pipe, Offset);
+}
+
+/// @brief Gets or creates an internal helper implementing part of the pipe
+/// builtins, which is always inlined into its callers.
+///
+/// @param M Module to create the helper in.
+/// @param Name Name of the helper.
+/// @param FTy Type of the helper.
+/// @param Body Callback defining the body of a newly created helper.
+static Function *getOrCreatePipeHelper(Module &M, StringRef Name,
+                                       FunctionType *FTy,
+                                       function_ref<void(Function &)> Body) {
+  if (auto *const F = M.getFunction(Name)) {
+    return F;
+  }
+  auto *const F =
+      Function::Create(FTy, GlobalValue::InternalLinkage, Name, &M);
+  F->addFnAttr(Attribute::AlwaysInline);
+  F->addFnAttr(Attribute::NoUnwind);
+  Body(*F);
+  return F;
+}
+
+/// @brief Gets the helper reserving packets in a pipe.
+///
+/// The helper takes the pipe and the number of packets, and returns the
+/// reservation ID or null if the pipe can't fit the reservation. Reserving
+/// zero packets always fails without touching the pipe, which lets every
+/// work-item of a group call the helper while only the leader reserves.
+static Function *getPipeReserveHelper(Module &M, bool IsWrite) {
+  auto &Ctx = M.getContext();
+  auto *const PipeTy = PointerType::get(Ctx, AddressSpace::Global);
+  auto *const RIDTy = PointerType::getUnqual(Ctx);
+  auto *const I32Ty = Type::getInt32Ty(Ctx);
+  auto *const FTy = FunctionType::get(RIDTy, {PipeTy, I32Ty}, false);
+  return getOrCreatePipeHelper(
+      M, IsWrite ? "__ca_pipe_reserve_write" : "__ca_pipe_reserve_read", FTy,
+      [&](Function &F) {
+        auto *const Pipe = F.getArg(0);
+        auto *const NumPackets = F.getArg(1);
+        auto *const Entry = BasicBlock::Create(Ctx, "entry", &F);
+        auto *const Loop = BasicBlock::Create(Ctx, "loop", &F);
+        auto *const Try = BasicBlock::Create(Ctx, "try", &F);
+        auto *const Done = BasicBlock::Create(Ctx, "done", &F);
+        auto *const Fail = BasicBlock::Create(Ctx, "fail", &F);
+
+        IRBuilder<> B(Entry);
+        auto *const Counter = getPipeHeaderField(
+            B, Pipe, IsWrite ? PipeWriteReserveOffset : PipeReadReserveOffset);
+        // Writers are limited by the packets readers have finished with,
+        // readers by the packets writers have finished with.
+        auto *const Limit = getPipeHeaderField(
+            B, Pipe, IsWrite ? PipeReadCommitOffset : PipeWriteCommitOffset);
+        Value *MaxPackets = nullptr;
+        if (IsWrite) {
+          MaxPackets = B.CreateAlignedLoad(
+              I32Ty, getPipeHeaderField(B, Pipe, PipeMaxPacketsOffset),
+              Align(4), "max");
+        }
+        B.CreateCondBr(B.CreateICmpEQ(NumPackets, B.getInt32(0)), Fail, Loop);
+
+        B.SetInsertPoint(Loop);
+        auto *const Start =
+            B.CreateAlignedLoad(I32Ty, Counter, Align(4), "start");
+        Start->setAtomic(AtomicOrdering::Monotonic);
+        auto *const LimitVal =
+            B.CreateAlignedLoad(I32Ty, Limit, Align(4), "limit");
+        LimitVal->setAtomic(AtomicOrdering::Acquire);
+        // The counters wrap around but their differences don't. A stale start
+        // may compute nonsense here, but then the exchange below fails.
+        auto *const Available =
+            IsWrite ? B.CreateSub(MaxPackets, B.CreateSub(Start, LimitVal))
+                    : B.CreateSub(LimitVal, Start);
+        B.CreateCondBr(B.CreateICmpULE(NumPackets, Available), Try, Fail);
+
+        B.SetInsertPoint(Try);
+        auto *const CmpXchg = B.CreateAtomicCmpXchg(
+            Counter, Start, B.CreateAdd(Start, NumPackets), MaybeAlign(4),
+            AtomicOrdering::Monotonic, AtomicOrdering::Monotonic);
+        B.CreateCondBr(B.CreateExtractValue(CmpXchg, 1), Done, Loop);
+
+        // The ID packs the reservation as (NumPackets << 32) | Start, which is
+        // never null.
+        B.SetInsertPoint(Done);
+        auto *const I64Ty = B.getInt64Ty();
+        auto *const ID =
+            B.CreateOr(B.CreateShl(B.CreateZExt(NumPackets, I64Ty), 32),
+                       B.CreateZExt(Start, I64Ty));
+        B.CreateRet(B.CreateIntToPtr(ID, RIDTy));
+
+        B.SetInsertPoint(Fail);
+        B.CreateRet(ConstantPointerNull::get(RIDTy));
+      });
+}
+
+/// @brief Gets the helper committing a reservation of a pipe.
+///
+/// The helper takes the pipe and the reservation ID, and does nothing if the
+/// ID is null. Reservations are committed in the order they were made, so
+/// that the commit counters only ever cover packets which are finished with.
+/// A commit waits for the reservations before it to be committed.
+static Function *getPipeCommitHelper(Module &M, bool IsWrite) {
+  auto &Ctx = M.getContext();
+  auto *const PipeTy = PointerType::get(Ctx, AddressSpace::Global);
+  auto *const RIDTy = PointerType::getUnqual(Ctx);
+  auto *const FTy =
+      FunctionType::get(Type::getVoidTy(Ctx), {PipeTy, RIDTy}, false);
+  return getOrCreatePipeHelper(
+      M, IsWrite ? "__ca_pipe_commit_write" : "__ca_pipe_commit_read", FTy,
+      [&](Function &F) {
+        auto *const Pipe = F.getArg(0);
+        auto *const RID = F.getArg(1);
+        auto *const Entry = BasicBlock::Create(Ctx, "entry", &F);
+        auto *const Loop = BasicBlock::Create(Ctx, "loop", &F);
+        auto *const Done = BasicBlock::Create(Ctx, "done", &F);
+
+        IRBuilder<> B(Entry);
+        auto *const Counter = getPipeHeaderField(
+            B, Pipe, IsWrite ? PipeWriteCommitOffset : PipeReadCommitOffset);
+        auto *const Bits = B.CreatePtrToInt(RID, B.getInt64Ty());
+        auto *const Start = B.CreateTrunc(Bits, B.getInt32Ty());
+        auto *const NumPackets =
+            B.CreateTrunc(B.CreateLShr(Bits, 32), B.getInt32Ty());
+        auto *const End = B.CreateAdd(Start, NumPackets);
+        B.CreateCondBr(B.CreateIsNull(RID), Done, Loop);
+
+        B.SetInsertPoint(Loop);
+        auto *const CmpXchg = B.CreateAtomicCmpXchg(
+            Counter, Start, End, MaybeAlign(4), AtomicOrdering::Release,
+            AtomicOrdering::Monotonic);
+        B.CreateCondBr(B.CreateExtractValue(CmpXchg, 1), Done, Loop);
+
+        B.SetInsertPoint(Done);
+        B.CreateRetVoid();
+      });
+}
+
+/// @brief Gets the helper copying one packet of a reservation to or from a
+/// pipe.
+///
+/// The helper takes the pipe, the reservation ID, the index of the packet in
+/// the reservation, the packet and the packet size, and returns zero.
+static Function *getPipePacketHelper(Module &M, bool IsWrite) {
+  auto &Ctx = M.getContext();
+  auto *const PipeTy = PointerType::get(Ctx, AddressSpace::Global);
+  auto *const PacketTy = PointerType::get(Ctx, AddressSpace::Generic);
+  auto *const RIDTy = PointerType::getUnqual(Ctx);
+  auto *const I32Ty = Type::getInt32Ty(Ctx);
+  auto *const FTy = FunctionType::get(
+      I32Ty, {PipeTy, RIDTy, I32Ty, PacketTy, I32Ty}, false);
+  return getOrCreatePipeHelper(
+      M, IsWrite ? "__ca_pipe_write_packet" : "__ca_pipe_read_packet", FTy,
+      [&](Function &F) {
+        auto *const Pipe = F.getArg(0);
+        auto *const RID = F.getArg(1);
+        auto *const Index = F.getArg(2);
+        auto *const Packet = F.getArg(3);
+        auto *const Size = F.getArg(4);
+
+        IRBuilder<> B(BasicBlock::Create(Ctx, "entry", &F));
+        auto *const I64Ty = B.getInt64Ty();
+        auto *const Capacity = B.CreateAlignedLoad(
+            I32Ty, getPipeHeaderField(B, Pipe, PipeCapacityOffset), Align(4),
+            "capacity");
+        auto *const Start =
+            B.CreateTrunc(B.CreatePtrToInt(RID, I64Ty), I32Ty, "start");
+        auto *const Slot =
+            B.CreateAnd(B.CreateAdd(Start, Index),
+                        B.CreateSub(Capacity, B.getInt32(1)), "slot");
+        auto *const Offset =
+            B.CreateAdd(B.CreateMul(B.CreateZExt(Slot, I64Ty),
+                                    B.CreateZExt(Size, I64Ty)),
+                        B.getInt64(PipeDataOffset));
+        auto *const Data = B.CreateInBoundsGEP(B.getInt8Ty(), Pipe, Offset);
+        if (IsWrite) {
+          B.CreateMemCpy(Data, MaybeAlign(), Packet, MaybeAlign(), Size);
+        } else {
+          B.CreateMemCpy(Packet, MaybeAlign(), Data, MaybeAlign(), Size);
+        }
+        B.CreateRet(B.getInt32(0));
+      });
+}
+
+/// @brief Gets the helper reading or writing a single packet of a pipe.
+///
+/// The helper takes the pipe, the packet and the packet size, and returns zero
+/// on success or -1 if the pipe is empty or full.
+static Function *getPipeTransferHelper(Module &M, bool IsWrite) {
+  auto &Ctx = M.getContext();
+  auto *const PipeTy = PointerType::get(Ctx, AddressSpace::Global);
+  auto *const PacketTy = PointerType::get(Ctx, AddressSpace::Generic);
+  auto *const I32Ty = Type::getInt32Ty(Ctx);
+  auto *const FTy =
+      FunctionType::get(I32Ty, {PipeTy, PacketTy, I32Ty}, false);
+  auto *const Reserve = getPipeReserveHelper(M, IsWrite);
+  auto *const Copy = getPipePacketHelper(M, IsWrite);
+  auto *const Commit = getPipeCommitHelper(M, IsWrite);
+  return getOrCreatePipeHelper(
+      M, IsWrite ? "__ca_pipe_write" : "__ca_pipe_read", FTy,
+      [&](Function &F) {
+        auto *const Pipe = F.getArg(0);
+        auto *const Packet = F.getArg(1);
+        auto *const Size = F.getArg(2);
+        auto *const Entry = BasicBlock::Create(Ctx, "entry", &F);
+        auto *const Transfer = BasicBlock::Create(Ctx, "transfer", &F);
+        auto *const Fail = BasicBlock::Create(Ctx, "fail", &F);
+
+        IRBuilder<> B(Entry);
+        auto *const RID = B.CreateCall(Reserve, {Pipe, B.getInt32(1)}, "rid");
+        B.CreateCondBr(B.CreateIsNull(RID), Fail, Transfer);
+
+        B.SetInsertPoint(Transfer);
+        B.CreateCall(Copy, {Pipe, RID, B.getInt32(0), Packet, Size});
+        B.CreateCall(Commit, {Pipe, RID});
+        B.CreateRet(B.getInt32(0));
+
+        B.SetInsertPoint(Fail);
+        B.CreateRet(B.getInt32(-1));
+      });
+}
+
+Instruction *CLBuiltinInfo::lowerPipeBuiltinToMuxBuiltin(
+    CallInst &CI, BuiltinID ID, BIMuxInfoConcept &BIMuxImpl) {
+  IRBuilder<> B(&CI);
+  auto &M = *CI.getModule();
+  LLVMContext &Ctx = M.getContext();
+
+  if (ID == eCLBuiltinIsValidReserveId) {
+    auto *const RID = CI.getArgOperand(0);
+    auto *const IsValid =
+        ICmpInst::Create(Instruction::ICmp, ICmpInst::ICMP_NE, RID,
+                         Constant::getNullValue(RID->getType()), "valid");
+    IsValid->insertBefore(CI.getIterator());
+    if (CI.getType() == IsValid->getType()) {
+      return IsValid;
+    }
+    auto *const ZExt =
+        ZExtInst::Create(Instruction::ZExt, IsValid, CI.getType(), "zext");
+    ZExt->insertBefore(CI.getIterator());
+    return ZExt;
+  }
+
+  // Pipes are always the first argument, and are global pointers by the time
+  // we get here, see BIMuxInfoConcept::getRemappedTargetExtTy.
+  auto *const Pipe = B.CreatePointerBitCastOrAddrSpaceCast(
+      CI.getArgOperand(0), PointerType::get(Ctx, AddressSpace::Global));
+  auto *const RIDTy = PointerType::getUnqual(Ctx);
+  auto *const PacketTy = PointerType::get(Ctx, AddressSpace::Generic);
+
+  bool IsWrite = false;
+  switch (ID) {
+    default:
+      break;
+    case eCLBuiltinWritePipe2:
+    case eCLBuiltinWritePipe4:
+    case eCLBuiltinReserveWritePipe:
+    case eCLBuiltinCommitWritePipe:
+    case eCLBuiltinGetPipeNumPacketsWO:
+    case eCLBuiltinGetPipeMaxPacketsWO:
+    case eCLBuiltinWorkgroupReserveWritePipe:
+    case eCLBuiltinWorkgroupCommitWritePipe:
+    case eCLBuiltinSubgroupReserveWritePipe:
+    case eCLBuiltinSubgroupCommitWritePipe:
+      IsWrite = true;
+      break;
+  }
+
+  // Group reservations are made by the first work-item of the group on
+  // behalf of the whole group, so that a vectorized sub-group reserves all of
+  // its packets with a single atomic operation.
+  const bool IsWorkGroup = ID == eCLBuiltinWorkgroupReserveReadPipe ||
+                           ID == eCLBuiltinWorkgroupReserveWritePipe ||
+                           ID == eCLBuiltinWorkgroupCommitReadPipe ||
+                           ID == eCLBuiltinWorkgroupCommitWritePipe;
+  auto CreateIsLeader = [&]() -> Value * {
+    auto *const GetID = BIMuxImpl.getOrDeclareMuxBuiltin(
+        IsWorkGroup ? eMuxBuiltinGetLocalLinearId
+                    : eMuxBuiltinGetSubGroupLocalId,
+        M);
+    assert(GetID && "Could not get/declare mux work-item ID builtin");
+    auto *const LocalID = B.CreateCall(GetID, {}, "local.id");
+    LocalID->setAttributes(GetID->getAttributes());
+    return B.CreateICmpEQ(LocalID,
+                          Constant::getNullValue(LocalID->getType()),
+                          "is.leader");
+  };
+
+  CallInst *NewCI = nullptr;
+  switch (ID) {
+    default:
+      llvm_unreachable("Unhandled builtin");
+    case eCLBuiltinReadPipe2:
+    case eCLBuiltinWritePipe2: {
+      auto *const Packet = B.CreatePointerBitCastOrAddrSpaceCast(
+          CI.getArgOperand(1), PacketTy);
+      NewCI = B.CreateCall(getPipeTransferHelper(M, IsWrite),
+                           {Pipe, Packet, CI.getArgOperand(2)});
+      break;
+    }
+    case eCLBuiltinReadPipe4:
+    case eCLBuiltinWritePipe4: {
+      auto *const Packet = B.CreatePointerBitCastOrAddrSpaceCast(
+          CI.getArgOperand(3), PacketTy);
+      NewCI = B.CreateCall(getPipePacketHelper(M, IsWrite),
+                           {Pipe, CI.getArgOperand(1), CI.getArgOperand(2),
+                            Packet, CI.getArgOperand(4)});
+      break;
+    }
+    case eCLBuiltinReserveReadPipe:
+    case eCLBuiltinReserveWritePipe:
+      NewCI = B.CreateCall(getPipeReserveHelper(M, IsWrite),
+                           {Pipe, CI.getArgOperand(1)});
+      break;
+    case eCLBuiltinCommitReadPipe:
+    case eCLBuiltinCommitWritePipe:
+      NewCI = B.CreateCall(getPipeCommitHelper(M, IsWrite),
+                           {Pipe, CI.getArgOperand(1)});
+      break;
+    case eCLBuiltinGetPipeNumPacketsRO:
+    case eCLBuiltinGetPipeNumPacketsWO: {
+      auto *const I32Ty = B.getInt32Ty();
+      auto *const Written = B.CreateAlignedLoad(
+          I32Ty, getPipeHeaderField(B, Pipe, PipeWriteCommitOffset), Align(4));
+      Written->setAtomic(AtomicOrdering::Monotonic);
+      auto *const Read = B.CreateAlignedLoad(
+          I32Ty, getPipeHeaderField(B, Pipe, PipeReadReserveOffset), Align(4));
+      Read->setAtomic(AtomicOrdering::Monotonic);
+      auto *const NumPackets = BinaryOperator::Create(
+          Instruction::Sub, Written, Read, "num.packets");
+      NumPackets->insertBefore(CI.getIterator());
+      return NumPackets;
+    }
+    case eCLBuiltinGetPipeMaxPacketsRO:
+    case eCLBuiltinGetPipeMaxPacketsWO:
+      return B.CreateAlignedLoad(
+          B.getInt32Ty(), getPipeHeaderField(B, Pipe, PipeMaxPacketsOffset),
+          Align(4), "max.packets");
+    case eCLBuiltinWorkgroupReserveReadPipe:
+    case eCLBuiltinWorkgroupReserveWritePipe:
+    case eCLBuiltinSubgroupReserveReadPipe:
+    case eCLBuiltinSubgroupReserveWritePipe: {
+      auto *const NumPackets = B.CreateSelect(
+          CreateIsLeader(), CI.getArgOperand(1), B.getInt32(0));
+      auto *const RID = B.CreateCall(getPipeReserveHelper(M, IsWrite),
+                                     {Pipe, NumPackets}, "leader.rid");
+      auto *const I64Ty = B.getInt64Ty();
+      auto *const Broadcast = BIMuxImpl.getOrDeclareMuxBuiltin(
+          IsWorkGroup ? eMuxBuiltinWorkgroupBroadcast
+                      : eMuxBuiltinSubgroupBroadcast,
+          M, {I64Ty});
+      assert(Broadcast && "Could not get/declare mux broadcast builtin");
+      SmallVector<Value *, 5> Args;
+      if (IsWorkGroup) {
+        // Work-group operations have a barrier ID first.
+        Args.push_back(B.getInt32(0));
+      }
+      Args.push_back(B.CreatePtrToInt(RID, I64Ty));
+      if (IsWorkGroup) {
+        auto *const SizeTy = getSizeType(M);
+        Args.append(3, ConstantInt::getNullValue(SizeTy));
+      } else {
+        Args.push_back(B.getInt32(0));
+      }
+      auto *const Bits = B.CreateCall(Broadcast, Args);
+      Bits->setAttributes(Broadcast->getAttributes());
+      auto *const NewRID = CastInst::Create(Instruction::IntToPtr, Bits, RIDTy,
+                                            CI.getName());
+      NewRID->insertBefore(CI.getIterator());
+      return NewRID;
+    }
+    case eCLBuiltinWorkgroupCommitReadPipe:
+    case eCLBuiltinWorkgroupCommitWritePipe:
+    case eCLBuiltinSubgroupCommitReadPipe:
+    case eCLBuiltinSubgroupCommitWritePipe: {
+      // Every work-item of the group must be done with its packets before the
+      // leader commits them.
+      auto *const I32Ty = B.getInt32Ty();
+      auto *const Barrier = BIMuxImpl.getOrDeclareMuxBuiltin(
+          IsWorkGroup ? eMuxBuiltinWorkGroupBarrier
+                      : eMuxBuiltinSubGroupBarrier,
+          M);
+      assert(Barrier && "Could not get/declare mux barrier builtin");
+      auto *const Scope =
+          ConstantInt::get(I32Ty, IsWorkGroup
+                                      ? BIMuxInfoConcept::MemScopeWorkGroup
+                                      : BIMuxInfoConcept::MemScopeSubGroup);
+      auto *const Semantics = ConstantInt::get(
+          I32Ty, BIMuxInfoConcept::MemSemanticsSequentiallyConsistent |
+                     BIMuxInfoConcept::MemSemanticsCrossWorkGroupMemory);
+      auto *const BarrierCI =
+          B.CreateCall(Barrier, {ConstantInt::get(I32Ty, 0), Scope, Semantics});
+      BarrierCI->setAttributes(Barrier->getAttributes());
+      auto *const RID = B.CreateSelect(CreateIsLeader(), CI.getArgOperand(1),
+                                       ConstantPointerNull::get(RIDTy));
+      NewCI = B.CreateCall(getPipeCommitHelper(M, IsWrite), {Pipe, RID});
+      break;
+    }
+  }
+  NewCI->takeName(&CI);
+  return NewCI;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Function *CLBuiltinLoader::materializeBuiltin(StringRef BuiltinName,
@@ -17,6 +17,7 @@
 #include <compiler/utils/metadata.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
 #include <llvm/IR/Module.h>
 
 using namespace llvm;
@@ -391,5 +392,15 @@ std::optional<uint32_t> getReqdSubgroupSize(const Function &f) {
   return std::nullopt;
 }
 
+static constexpr const char *LocalMemoryMD = "mux_local_memory";
+
+void setIsLocalMemoryAlloca(AllocaInst &alloca) {
+  alloca.setMetadata(LocalMemoryMD, MDNode::get(alloca.getContext(), {}));
+}
+
+bool isLocalMemoryAlloca(const AllocaInst &alloca) {
+  return alloca.hasMetadata(LocalMemoryMD);
+}
+
 }  // namespace utils
 }  // namespace compiler
@@ -899,6 +899,18 @@ Type *BIMuxInfoConcept::getRemappedTargetExtTy(Type *Ty, Module &M) {
     return PointerType::getUnqual(Ctx);
   }
 
+  // Pipes are replaced by default with a pointer to their storage, which is
+  // allocated in global memory.
+  if (TgtExtTy->getName() == "spirv.Pipe") {
+    return PointerType::get(Ctx, compiler::utils::AddressSpace::Global);
+  }
+
+  // Reservation IDs are replaced by default with a pointer-sized value, which
+  // the pipe builtins encode the reserved packets in.
+  if (TgtExtTy->getName() == "spirv.ReserveId") {
+    return PointerType::getUnqual(Ctx);
+  }
+
   return nullptr;
 }
 
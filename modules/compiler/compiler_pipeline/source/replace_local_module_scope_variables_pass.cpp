@@ -668,6 +668,7 @@ PreservedAnalyses compiler::utils::ReplaceLocalModuleScopeVariablesPass::run(
     // stack allocate the local module-scope variables struct
     auto alloca = ir.CreateAlloca(structTy);
     alloca->setAlignment(MaybeAlign(maxAlignment).valueOrOne());
+    setIsLocalMemoryAlloca(*alloca);
 
     // Generate debug info metadata for the globals we have replaced
     // which previously had debug info attached
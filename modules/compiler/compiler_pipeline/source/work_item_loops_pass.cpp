@@ -67,6 +67,9 @@ class BarrierWithLiveVars : public Barrier {
   AllocaInst *getDebugAddr() const { return debug_addr; }
   void setDebugAddr(AllocaInst *ai) { debug_addr = ai; }
 
+  AllocaInst *getUniformMemSpace() const { return uniform_mem_space; }
+  void setUniformMemSpace(AllocaInst *ai) { uniform_mem_space = ai; }
+
  private:
   VectorizationInfo vf_info;
 
@@ -78,6 +81,10 @@ class BarrierWithLiveVars : public Barrier {
   // the live-variables structure.
   AllocaInst *mem_space = nullptr;
 
+  // Alloca representing the memory for the values which are uniform across
+  // the work-group, of which there is only a single instance.
+  AllocaInst *uniform_mem_space = nullptr;
+
   // Alloca holding the address of the live vars struct for the
   // currently executing work item.
   AllocaInst *debug_addr = nullptr;
@@ -282,6 +289,10 @@ struct ScheduleGenerator {
           }
         }
       }
+
+      if (auto *const uniform_vars = barrier.getUniformMemSpace()) {
+        new_kernel_args.push_back(uniform_vars);
+      }
     }
 
     auto &subkernel = *barrier.getSubkernel(i);
@@ -1314,6 +1325,18 @@ static void setUpLiveVarsAlloca(compiler::utils::BarrierWithLiveVars &barrier,
   }
 }
 
+// Emits code to set up the storage allocated to a uniform values structure,
+// of which there is one per work-group.
+static void setUpUniformVarsAlloca(
+    compiler::utils::BarrierWithLiveVars &barrier, IRBuilder<> &B,
+    StringRef name) {
+  AllocaInst *const uniform_mem_space =
+      B.CreateAlloca(barrier.getUniformVarsType(), nullptr, name);
+  uniform_mem_space->setAlignment(
+      MaybeAlign(barrier.getUniformVarMaxAlignment()).valueOrOne());
+  barrier.setUniformMemSpace(uniform_mem_space);
+}
+
 Function *compiler::utils::WorkItemLoopsPass::makeWrapperFunction(
     BarrierWithLiveVars &barrierMain, BarrierWithLiveVars *barrierTail,
     StringRef baseName, Module &M, compiler::utils::BuiltinInfo &BI) {
@@ -1540,6 +1563,13 @@ Function *compiler::utils::WorkItemLoopsPass::makeWrapperFunction(
                         "live_variables_peel", IsDebug);
   }
 
+  if (barrierMain.hasUniformLiveVars()) {
+    setUpUniformVarsAlloca(barrierMain, entryIR, "live_uniforms");
+  }
+  if (emitTail && barrierTail->hasUniformLiveVars()) {
+    setUpUniformVarsAlloca(*barrierTail, entryIR, "live_uniforms_peel");
+  }
+
   // next means next barrier id. This variable is uninitialized to begin with,
   // and is set by the first pass below
   IntegerType *index_type = i32Ty;
@@ -21,11 +21,13 @@
 #ifndef COMPILER_KERNEL_H_INCLUDED
 #define COMPILER_KERNEL_H_INCLUDED
 
+#include <cargo/array_view.h>
 #include <cargo/dynamic_array.h>
 #include <cargo/expected.h>
 #include <compiler/result.h>
 #include <mux/mux.hpp>
 
+#include <memory>
 #include <string>
 
 namespace compiler {
@@ -154,6 +156,38 @@ class Kernel {
   /// this kernel.
   virtual cargo::expected<size_t, Result> queryMaxSubGroupCount() = 0;
 
+  /// @brief Creates a kernel which executes this kernel followed by each of
+  /// `kernels` back to back in every work-item.
+  ///
+  /// The fused kernel takes the arguments of this kernel followed by the
+  /// arguments of each of `kernels` in order. Fusion is only valid if no
+  /// work-item of one kernel depends on memory another work-item of an earlier
+  /// kernel writes, so targets must check how each kernel accesses its buffers
+  /// and refuse to fuse kernels which synchronize work-items. The fused kernel
+  /// must only be enqueued on one-dimensional ND-ranges.
+  ///
+  /// @param kernels Kernels to execute after this one, which must have been
+  /// created by the same target.
+  /// @param buffers Identifies the buffer bound to each argument of the fused
+  /// kernel, arguments bound to the same buffer have the same non-zero value.
+  /// Arguments which aren't bound to a buffer are zero.
+  ///
+  /// @return Returns the fused kernel, or a status code if it was
+  /// unsuccessful.
+  /// @retval `Result::FEATURE_UNSUPPORTED` if the target doesn't support
+  /// fusion, or the kernels can't be safely fused.
+  /// @retval `Result::INVALID_VALUE` if `buffers` doesn't have an entry for
+  /// each argument.
+  /// @retval `Result::FINALIZE_PROGRAM_FAILURE` if there was a failure to
+  /// create the fused kernel.
+  virtual cargo::expected<std::unique_ptr<Kernel>, Result> createFusedKernel(
+      cargo::array_view<Kernel *const> kernels,
+      cargo::array_view<const uint64_t> buffers) {
+    (void)kernels;
+    (void)buffers;
+    return cargo::make_unexpected(Result::FEATURE_UNSUPPORTED);
+  }
+
   /// @brief The name of the kernel.
   const std::string name;
 
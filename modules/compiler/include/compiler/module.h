@@ -33,6 +33,7 @@
 #include <spirv/unified1/spirv.hpp>
 
 #include <array>
+#include <string>
 #include <unordered_map>
 
 namespace compiler {
@@ -272,7 +273,8 @@ struct KernelArgType {
     NONE = 0,
     CONST = (1 << 0),
     RESTRICT = (1 << 1),
-    VOLATILE = (1 << 2)
+    VOLATILE = (1 << 2),
+    PIPE = (1 << 3)
   };
 };
 
@@ -645,6 +647,23 @@ class Module {
 
   /// @brief Returns the current state of the compiler module.
   virtual ModuleState getState() const = 0;
+
+  /// @brief Returns the compile-time telemetry of the module as a JSON object.
+  ///
+  /// The object lists the time spent in each phase of compilation and in each
+  /// compiler pass since the module was last cleared, including any kernels
+  /// specialized since, along with the peak memory use of the process.
+  virtual std::string getBuildTelemetry() const = 0;
+
+  /// @brief Redirects diagnostics reported from now on to another build log.
+  ///
+  /// Diagnostics go to the error count and log the module was created with
+  /// until this is called, so a module which must outlive them, e.g. because
+  /// it's shared between programs, must first be given a log of its own.
+  ///
+  /// @param[in,out] num_errors Count incremented for each error reported.
+  /// @param[in,out] log Log diagnostics are appended to.
+  virtual void setBuildLog(uint32_t &num_errors, std::string &log) = 0;
 };  // class Module
 
 /// @}
@@ -59,13 +59,15 @@ auto isLegalMaskedStoreImpl(const TargetTransformInfo &TTI, llvm::Type *Ty,
 
 }  // namespace detail
 
-bool isLegalMaskedLoad(const llvm::TargetTransformInfo &TTI, llvm::Type *Ty,
-                       llvm::Align Alignment, unsigned AddrSpace) {
+inline bool isLegalMaskedLoad(const llvm::TargetTransformInfo &TTI,
+                              llvm::Type *Ty, llvm::Align Alignment,
+                              unsigned AddrSpace) {
   return detail::isLegalMaskedLoadImpl(TTI, Ty, Alignment, AddrSpace);
 }
 
-bool isLegalMaskedStore(const llvm::TargetTransformInfo &TTI, llvm::Type *Ty,
-                        llvm::Align Alignment, unsigned AddrSpace) {
+inline bool isLegalMaskedStore(const llvm::TargetTransformInfo &TTI,
+                               llvm::Type *Ty, llvm::Align Alignment,
+                               unsigned AddrSpace) {
   return detail::isLegalMaskedStoreImpl(TTI, Ty, Alignment, AddrSpace);
 }
 
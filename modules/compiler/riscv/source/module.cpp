@@ -78,6 +78,7 @@ compiler::Result RiscvModule::createBinary(
       llvm::CrashRecoveryContext CRC;
       llvm::CrashRecoveryContext::Enable();
       const bool crashed = !CRC.RunSafely([&] {
+        const compiler::BuildTelemetry::Phase phase(telemetry, "codegen");
         err = compiler::emitCodeGenFile(*finalized_llvm_module, TM, ostream);
       });
       llvm::CrashRecoveryContext::Disable();
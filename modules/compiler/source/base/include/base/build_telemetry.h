@@ -0,0 +1,129 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Compile-time telemetry of compiler modules.
+
+#ifndef COMPILER_BASE_BUILD_TELEMETRY_H_INCLUDED
+#define COMPILER_BASE_BUILD_TELEMETRY_H_INCLUDED
+
+#include <llvm/ADT/StringRef.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class PassInstrumentationCallbacks;
+}
+
+namespace compiler {
+/// @addtogroup compiler
+/// @{
+
+/// @brief Records how long a module spends in each phase of compilation and
+/// in each LLVM pass, see `Module::getBuildTelemetry`.
+///
+/// Times are accumulated by name until the telemetry is reset, so a phase or
+/// pass which runs more than once, e.g. once per kernel specialization, reports
+/// its total time and the number of times it ran.
+class BuildTelemetry {
+ public:
+  /// @brief Times a phase of compilation for as long as it is in scope.
+  class Phase {
+   public:
+    /// @brief Start timing a phase.
+    ///
+    /// @param[in] telemetry Telemetry to record the phase to.
+    /// @param[in] name Name of the phase, must outlive the scope.
+    Phase(BuildTelemetry &telemetry, llvm::StringRef name);
+
+    /// @brief Record the time spent in the phase.
+    ~Phase();
+
+    Phase(const Phase &) = delete;
+    Phase &operator=(const Phase &) = delete;
+
+   private:
+    BuildTelemetry &telemetry;
+    llvm::StringRef name;
+    uint64_t start;
+  };
+
+  /// @brief Discard everything recorded so far.
+  void reset();
+
+  /// @brief Time every pass run by a pass machinery.
+  ///
+  /// Pass managers and adaptors aren't recorded as their time is already
+  /// accounted to the passes they run. Passes which make up a phase of their
+  /// own, such as the vectorizer, are also recorded as that phase.
+  ///
+  /// @param[in] PIC Instrumentation callbacks of the pass machinery, which
+  /// must not outlive this object.
+  void registerCallbacks(llvm::PassInstrumentationCallbacks &PIC);
+
+  /// @brief Record time spent in a phase.
+  ///
+  /// @param[in] name Name of the phase.
+  /// @param[in] time Nanoseconds spent in the phase.
+  void addPhase(llvm::StringRef name, uint64_t time);
+
+  /// @brief Record time spent in a pass.
+  ///
+  /// @param[in] name Name of the pass.
+  /// @param[in] time Nanoseconds spent in the pass.
+  void addPass(llvm::StringRef name, uint64_t time);
+
+  /// @brief Serialize everything recorded so far as a JSON object.
+  std::string toJSON() const;
+
+  /// @brief Get the current time in nanoseconds, for timing phases.
+  static uint64_t now();
+
+  /// @brief Get the peak resident memory of the process in bytes, or zero if
+  /// it can't be measured on this system.
+  static uint64_t peakMemory();
+
+ private:
+  /// @brief Time accumulated by a phase or a pass.
+  struct Entry {
+    /// @brief Name of the phase or pass.
+    std::string name;
+    /// @brief Nanoseconds spent in every run.
+    uint64_t time = 0;
+    /// @brief Number of runs.
+    uint64_t count = 0;
+    /// @brief Peak resident memory of the process when the last run finished.
+    uint64_t peak_memory = 0;
+  };
+
+  static void accumulate(std::vector<Entry> &entries, llvm::StringRef name,
+                         uint64_t time, uint64_t peak_memory);
+
+  mutable std::mutex mutex;
+  /// @brief Phases in the order they first ran.
+  std::vector<Entry> phases;
+  /// @brief Passes in the order they first ran.
+  std::vector<Entry> passes;
+};
+
+/// @}
+}  // namespace compiler
+
+#endif  // COMPILER_BASE_BUILD_TELEMETRY_H_INCLUDED
@@ -21,6 +21,7 @@
 #ifndef BASE_MODULE_H_INCLUDED
 #define BASE_MODULE_H_INCLUDED
 
+#include <base/build_telemetry.h>
 #include <base/context.h>
 #include <base/target.h>
 #include <builtins/printf.h>
@@ -39,8 +40,10 @@
 #include <llvm/IR/PassManager.h>
 #include <mux/mux.hpp>
 
+#include <array>
 #include <mutex>
 #include <optional>
+#include <vector>
 
 namespace compiler {
 
@@ -213,6 +216,14 @@ class BaseModule : public Module {
   /// @brief Returns the current state of the compiler module.
   ModuleState getState() const override final { return state; }
 
+  /// @brief Returns the compile-time telemetry of the module as a JSON object.
+  std::string getBuildTelemetry() const override final {
+    return telemetry.toJSON();
+  }
+
+  /// @brief Redirects diagnostics reported from now on to another build log.
+  void setBuildLog(uint32_t &num_errors, std::string &log) override final;
+
   /// @brief Return a new pass machinery to be used for the compilation pipeline
   virtual std::unique_ptr<compiler::utils::PassMachinery> createPassMachinery(
       llvm::LLVMContext &);
@@ -502,6 +513,9 @@ class BaseModule : public Module {
   /// @brief Reference on the context this module belongs to.
   compiler::BaseContext &context;
 
+  /// @brief Compile-time telemetry, reset when the module is cleared.
+  compiler::BuildTelemetry telemetry;
+
  private:
   /// @brief Check if the opencl.kernels metadata exists in the binary's module,
   /// and create them if they don't.
@@ -518,9 +532,18 @@ class BaseModule : public Module {
 
   std::unique_ptr<llvm::Module> llvm_module;
 
-  // Diagnostics state.
-  uint32_t &num_errors;
-  std::string &log;
+  /// @brief SPIR-V binary most recently translated with deferred
+  /// specialization, see `compileSPIRV`.
+  std::vector<std::uint32_t> spirv_cache_code;
+  /// @brief Unspecialized translation of `spirv_cache_code`, cloned and
+  /// specialized by each call to `compileSPIRV` with the same binary.
+  std::unique_ptr<llvm::Module> spirv_cache_module;
+  /// @brief Work-group size declared by `spirv_cache_code`.
+  std::array<uint32_t, 3> spirv_cache_workgroup_size = {{1, 1, 1}};
+
+  // Diagnostics state, see `setBuildLog`.
+  uint32_t *num_errors;
+  std::string *log;
 
   // We only need to guard against creating kernels in parallel, in case they
   // are called on the same name. If there are compiler resource conflicts
@@ -45,8 +45,11 @@ struct PrintfReplacementPass final
   /// @param[out] descriptors An optional vector to be filled with descriptors
   /// of the printf calls that have been replaced by this pass.
   /// @param[in] buffer_size The required size of the printf buffer.
+  /// @param[in] streaming Whether each printf call marks its data as committed
+  /// once stored, so that the host can drain it while the kernel runs.
   PrintfReplacementPass(PrintfDescriptorVecTy *descriptors = nullptr,
-                        size_t buffer_size = PRINTF_BUFFER_SIZE);
+                        size_t buffer_size = PRINTF_BUFFER_SIZE,
+                        bool streaming = false);
 
   /// @brief The entry point to the PrintfReplacementPass.
   ///
@@ -81,6 +84,7 @@ struct PrintfReplacementPass final
 
   PrintfDescriptorVecTy *printf_calls_out_ptr;
   size_t printf_buffer_size;
+  bool streaming;
 
   bool double_support = true;
 };
@@ -262,6 +262,11 @@ parseEncodeKernelMetadataPassOptions(StringRef Params) {
   return Opts;
 }
 
+static Expected<bool> parseReplacePrintfPassOptions(StringRef Params) {
+  return compiler::utils::parseSinglePassOption(Params, "streaming",
+                                                "PrintfReplacementPass");
+}
+
 static Expected<bool> parseReplaceMuxMathDeclsPassOptions(StringRef Params) {
   return compiler::utils::parseSinglePassOption(Params, "fast",
                                                 "ReplaceMuxMathDeclsPass");
@@ -0,0 +1,186 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <base/build_telemetry.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/Passes/StandardInstrumentations.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// psapi.h must be included after windows.h.
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+/// @brief Passes which are also reported as a phase of compilation.
+const std::pair<llvm::StringRef, llvm::StringRef> phase_passes[] = {
+    {"vecz::RunVeczPass", "vecz"},
+    {"compiler::utils::WorkItemLoopsPass", "work-item-loops"},
+};
+}  // namespace
+
+namespace compiler {
+BuildTelemetry::Phase::Phase(BuildTelemetry &telemetry, llvm::StringRef name)
+    : telemetry(telemetry), name(name), start(BuildTelemetry::now()) {}
+
+BuildTelemetry::Phase::~Phase() {
+  telemetry.addPhase(name, BuildTelemetry::now() - start);
+}
+
+void BuildTelemetry::reset() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  phases.clear();
+  passes.clear();
+}
+
+void BuildTelemetry::registerCallbacks(
+    llvm::PassInstrumentationCallbacks &PIC) {
+  // Pass managers run their passes in a single thread, so each machinery
+  // keeps its own stack of start times for the passes it's running.
+  auto starts = std::make_shared<std::vector<uint64_t>>();
+  auto isRecorded = [](llvm::StringRef PassID) {
+    return !llvm::isSpecialPass(PassID, {"PassManager", "PassAdaptor"});
+  };
+  auto finish = [this, starts, isRecorded](llvm::StringRef PassID) {
+    if (!isRecorded(PassID) || starts->empty()) {
+      return;
+    }
+    const uint64_t time = now() - starts->back();
+    starts->pop_back();
+    addPass(PassID, time);
+    for (const auto &[pass, phase] : phase_passes) {
+      if (PassID == pass) {
+        addPhase(phase, time);
+      }
+    }
+  };
+
+  PIC.registerBeforeNonSkippedPassCallback(
+      [starts, isRecorded](llvm::StringRef PassID, llvm::Any) {
+        if (isRecorded(PassID)) {
+          starts->push_back(now());
+        }
+      });
+  PIC.registerAfterPassCallback(
+      [finish](llvm::StringRef PassID, llvm::Any,
+               const llvm::PreservedAnalyses &) { finish(PassID); });
+  PIC.registerAfterPassInvalidatedCallback(
+      [finish](llvm::StringRef PassID, const llvm::PreservedAnalyses &) {
+        finish(PassID);
+      });
+}
+
+void BuildTelemetry::addPhase(llvm::StringRef name, uint64_t time) {
+  const uint64_t peak_memory = peakMemory();
+  const std::lock_guard<std::mutex> lock(mutex);
+  accumulate(phases, name, time, peak_memory);
+}
+
+void BuildTelemetry::addPass(llvm::StringRef name, uint64_t time) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  accumulate(passes, name, time, 0);
+}
+
+void BuildTelemetry::accumulate(std::vector<Entry> &entries,
+                                llvm::StringRef name, uint64_t time,
+                                uint64_t peak_memory) {
+  auto found =
+      std::find_if(entries.begin(), entries.end(),
+                   [&](const Entry &entry) { return entry.name == name; });
+  if (found == entries.end()) {
+    found = entries.insert(entries.end(), Entry{});
+    found->name = name.str();
+  }
+  found->time += time;
+  found->count++;
+  found->peak_memory = peak_memory;
+}
+
+std::string BuildTelemetry::toJSON() const {
+  const std::lock_guard<std::mutex> lock(mutex);
+  std::string json;
+  llvm::raw_string_ostream stream(json);
+  llvm::json::OStream out(stream);
+  out.object([&] {
+    uint64_t peak_memory = 0;
+    out.attributeArray("phases", [&] {
+      for (const auto &phase : phases) {
+        out.object([&] {
+          out.attribute("name", phase.name);
+          out.attribute("time_ns", static_cast<int64_t>(phase.time));
+          out.attribute("count", static_cast<int64_t>(phase.count));
+          out.attribute("peak_memory_bytes",
+                        static_cast<int64_t>(phase.peak_memory));
+        });
+        peak_memory = std::max(peak_memory, phase.peak_memory);
+      }
+    });
+    out.attributeArray("passes", [&] {
+      for (const auto &pass : passes) {
+        out.object([&] {
+          out.attribute("name", pass.name);
+          out.attribute("time_ns", static_cast<int64_t>(pass.time));
+          out.attribute("count", static_cast<int64_t>(pass.count));
+        });
+      }
+    });
+    out.attribute("peak_memory_bytes", static_cast<int64_t>(peak_memory));
+  });
+  stream.flush();
+  return json;
+}
+
+uint64_t BuildTelemetry::now() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+uint64_t BuildTelemetry::peakMemory() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                            sizeof(counters))) {
+    return 0;
+  }
+  return counters.PeakWorkingSetSize;
+#else
+  rusage usage;
+  if (0 != getrusage(RUSAGE_SELF, &usage)) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  // Apple reports the maximum resident set size in bytes, everything else in
+  // kilobytes.
+  return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+}  // namespace compiler
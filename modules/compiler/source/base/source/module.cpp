@@ -95,6 +95,7 @@
 #include <mux/mux.hpp>
 #include <spirv-ll/module.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <fstream>
@@ -163,8 +164,8 @@ static inline llvm::ModulePassManager buildPipeline(
 // map to the `EmitAssembly` and `EmitAssemblyWithNewPassManager` functions in
 // `clang/lib/CodeGen/BackendUtil.cpp` respectively.
 static void runFrontendPipeline(
-    compiler::BaseModule &base_module, llvm::Module &module,
-    const clang::CodeGenOptions &CGO,
+    compiler::BaseModule &base_module, compiler::BuildTelemetry &telemetry,
+    llvm::Module &module, const clang::CodeGenOptions &CGO,
     std::optional<llvm::ModulePassManager> EP = std::nullopt,
     std::optional<llvm::ModulePassManager> LP = std::nullopt) {
   auto &C = module.getContext();
@@ -173,6 +174,7 @@ static void runFrontendPipeline(
   auto PassMach = base_module.createPassMachinery(C);
 
   base_module.initializePassMachineryForFrontend(*PassMach, CGO);
+  telemetry.registerCallbacks(PassMach->getPIC());
 
   llvm::ModulePassManager MPM =
       buildPipeline(PassMach->getPB(), CGO, std::move(EP));
@@ -216,6 +218,18 @@ static bool isDeviceProfileFull(cargo::string_view profile_string) {
   return profile_string.compare("FULL_PROFILE");
 }
 
+/// @brief Check if the runtime may drain printf output while kernels run.
+///
+/// Committing printf data for streaming costs an extra atomic operation per
+/// printf call, so it is only done when `CA_PRINTF_STREAMING` is set.
+static bool isPrintfStreamingRequested() {
+  static const bool requested = [] {
+    const char *env = std::getenv("CA_PRINTF_STREAMING");
+    return env && std::atoi(env) != 0;
+  }();
+  return requested;
+}
+
 /// @brief Load the kernel builtins header as a virtual Clang file.
 ///
 /// PCH files are not independent from the header source they were created
@@ -341,14 +355,15 @@ BaseModule::BaseModule(compiler::BaseTarget &target,
     : target(target),
       context(context),
       state(ModuleState::NONE),
-      num_errors(num_errors),
-      log(log) {}
+      num_errors(&num_errors),
+      log(&log) {}
 
 BaseModule::~BaseModule() {
-  if (llvm_module || finalized_llvm_module) {
+  if (llvm_module || finalized_llvm_module || spirv_cache_module) {
     target.withLLVMContextDo([&](llvm::LLVMContext &) {
       llvm_module.reset();
       finalized_llvm_module.reset();
+      spirv_cache_module.reset();
     });
   }
 }
@@ -361,6 +376,7 @@ void BaseModule::clear() {
     });
   }
   kernel_map.clear();
+  telemetry.reset();
 
   state = ModuleState::NONE;
 }
@@ -853,22 +869,56 @@ cargo::expected<spirv::ModuleInfo, Result> BaseModule::compileSPIRV(
             spirv_ll_spec_info_optional = spirv_ll_spec_info;
           }
 
-          // Translate the SPIR-V binary into an llvm::Module.
-          auto spvModule = spvContext.translate({buffer.data(), buffer.size()},
-                                                spirv_ll_device_info,
-                                                spirv_ll_spec_info_optional);
-          if (!spvModule) {
-            // Add error message to the build log.
-            log.append(spvModule.error().message + "\n");
-            num_errors = 1;
-            return cargo::make_unexpected(Result::COMPILE_PROGRAM_FAILURE);
-          }
+          // Rebuilding the same binary, e.g. with a different set of
+          // specialization constants, reuses the unspecialized translation.
+          const bool cached =
+              spirv_cache_module &&
+              std::equal(buffer.begin(), buffer.end(),
+                         spirv_cache_code.begin(), spirv_cache_code.end());
+          const BuildTelemetry::Phase phase(telemetry, "spirv-translation");
+          if (!cached) {
+            spirv_cache_module.reset();
+            spirv_cache_code.clear();
+
+            // Translate the SPIR-V binary into an llvm::Module, skipping
+            // functions no kernel can reach.
+            spirv_ll::TranslationOptions translation_options;
+            translation_options.pruneUnreachableFunctions = true;
+            translation_options.deferSpecialization = true;
+            auto spvModule = spvContext.translate(
+                {buffer.data(), buffer.size()}, spirv_ll_device_info,
+                spirv_ll_spec_info_optional, translation_options);
+            if (!spvModule) {
+              // Add error message to the build log.
+              log->append(spvModule.error().message + "\n");
+              *num_errors = 1;
+              return cargo::make_unexpected(Result::COMPILE_PROGRAM_FAILURE);
+            }
+
+            // Fill the SPIR-V module info data structure.
+            module_info.workgroup_size = spvModule->getWGS();
 
-          // Fill the SPIR-V module info data structure.
-          module_info.workgroup_size = spvModule->getWGS();
+            if (!spvModule->isSpecializationDeferred()) {
+              // Transfer ownership of the llvm::Module.
+              llvm_module = std::move(spvModule.value().llvmModule);
+            } else {
+              spirv_cache_code.assign(buffer.begin(), buffer.end());
+              spirv_cache_module = std::move(spvModule.value().llvmModule);
+              spirv_cache_workgroup_size = module_info.workgroup_size;
+            }
+          }
 
-          // Transfer ownership of the llvm::Module.
-          llvm_module = std::move(spvModule.value().llvmModule);
+          if (spirv_cache_module) {
+            module_info.workgroup_size = spirv_cache_workgroup_size;
+            llvm_module = llvm::CloneModule(*spirv_cache_module);
+            if (auto result = spirv_ll::Context::specialize(
+                    *llvm_module, spirv_ll_spec_info_optional);
+                !result) {
+              log->append(result.error().message + "\n");
+              *num_errors = 1;
+              return cargo::make_unexpected(Result::COMPILE_PROGRAM_FAILURE);
+            }
+          }
         }
 
         createOpenCLKernelsMetadata(*llvm_module);
@@ -1007,6 +1057,11 @@ void BaseModule::addDefaultOpenCLPreprocessorOpts(
     if (device_info->max_sub_group_count) {
       addMacroDef("__opencl_c_subgroups", macro_defs);
     }
+    // pipes are an optional feature in OpenCL 3.0.
+    if (device_info->supports_pipes) {
+      addOpenCLOpt("__opencl_c_pipes", opencl_opts);
+      addMacroDef("__opencl_c_pipes", macro_defs);
+    }
   }
 
   // Clang appears to unconditionally define the following macros, even though
@@ -1022,7 +1077,9 @@ void BaseModule::addDefaultOpenCLPreprocessorOpts(
   addMacroUndef("__opencl_c_atomic_order_acq_rel", macro_defs);
   addMacroUndef("__opencl_c_atomic_order_seq_cst", macro_defs);
   addMacroUndef("__opencl_c_device_enqueue", macro_defs);
-  addMacroUndef("__opencl_c_pipes", macro_defs);
+  if (options.standard != Standard::OpenCLC30 || !device_info->supports_pipes) {
+    addMacroUndef("__opencl_c_pipes", macro_defs);
+  }
   addMacroUndef("__opencl_c_read_write_images", macro_defs);
 }
 
@@ -1092,6 +1149,9 @@ void BaseModule::setDefaultOpenCLLangOpts(clang::LangOptions &lang_opts) const {
   lang_opts.OpenCLGenericAddressSpace =
       (options.standard == Standard::OpenCLC30) &&
       device_info->supports_generic_address_space;
+
+  lang_opts.OpenCLPipes =
+      (options.standard == Standard::OpenCLC30) && device_info->supports_pipes;
 }
 
 std::string BaseModule::debugDumpKernelSource(
@@ -1325,6 +1385,7 @@ clang::FrontendInputFile BaseModule::prepareOpenCLInputFile(
 void BaseModule::loadBuiltinsPCH(clang::CompilerInstance &instance,
                                  llvm::LLVMContext &C,
                                  const clang::CodeGenOptions &codeGenOpts) {
+  const BuildTelemetry::Phase phase(telemetry, "pch-load");
   clang::ASTContext *astContext = &(instance.getASTContext());
   auto reader = std::make_unique<clang::ASTReader>(
       instance.getPreprocessor(), instance.getModuleCache(), astContext,
@@ -1389,8 +1450,9 @@ void BaseModule::runOpenCLFrontendPipeline(
     }
   }
 
-  runFrontendPipeline(*this, *llvm_module, codeGenOpts, std::move(early_passes),
-                      std::move(late_passes));
+  const BuildTelemetry::Phase phase(telemetry, "frontend-passes");
+  runFrontendPipeline(*this, telemetry, *llvm_module, codeGenOpts,
+                      std::move(early_passes), std::move(late_passes));
 }
 
 BaseModule::FrontendDiagnosticPrinter::FrontendDiagnosticPrinter(
@@ -1431,7 +1493,7 @@ Result BaseModule::compileOpenCLC(
 
         llvm_module =
             compileOpenCLCToIR(instance, llvm_context, device_profile,
-                               source_sv, input_headers, &num_errors, &state);
+                               source_sv, input_headers, num_errors, &state);
 
         if (!llvm_module) {
           return compiler::Result::COMPILE_PROGRAM_FAILURE;
@@ -1453,6 +1515,12 @@ std::unique_ptr<llvm::Module> BaseModule::compileOpenCLCToIR(
     uint32_t *num_errors, ModuleState *new_state) {
   const llvm::StringRef source{source_sv.data(), source_sv.size()};
 
+  // Clang only preprocesses the source as it parses it, so this phase covers
+  // setting up the preprocessor, and the rest of preprocessing is accounted
+  // to codegen.
+  std::optional<BuildTelemetry::Phase> setup_phase;
+  setup_phase.emplace(telemetry, "clang-setup");
+
   MacroDefVec macro_defs;
   OpenCLOptVec opencl_opts;
 
@@ -1508,6 +1576,7 @@ std::unique_ptr<llvm::Module> BaseModule::compileOpenCLCToIR(
       return nullptr;
     }
   }
+  setup_phase.reset();
 
   loadBuiltinsPCH(instance, llvm_context, codeGenOpts);
 
@@ -1524,6 +1593,7 @@ std::unique_ptr<llvm::Module> BaseModule::compileOpenCLCToIR(
     // std::string's destructor.  So, we lock globally before asking Clang
     // to process this source file.
     const std::scoped_lock guard(compiler::utils::getLLVMGlobalMutex());
+    const BuildTelemetry::Phase phase(telemetry, "clang-codegen");
     if (action.Execute()) {
       return nullptr;
     }
@@ -1563,6 +1633,7 @@ std::unique_ptr<llvm::Module> BaseModule::compileOpenCLCToIR(
 
 Result BaseModule::link(cargo::array_view<Module *> input_modules) {
   return target.withLLVMContextDo([&](llvm::LLVMContext &C) -> Result {
+    const BuildTelemetry::Phase phase(telemetry, "link");
     std::unique_ptr<llvm::Module> module;
 
     auto filter_func = [](const llvm::DiagnosticInfo &DI) {
@@ -1703,6 +1774,7 @@ Result BaseModule::finalize(
 
     auto pass_mach = createPassMachinery(C);
     initializePassMachineryForFinalize(*pass_mach);
+    telemetry.registerCallbacks(pass_mach->getPIC());
 
     // Forward on any compiler options required.
     static_cast<compiler::BaseModulePassMachinery &>(*pass_mach)
@@ -1817,8 +1889,8 @@ Result BaseModule::finalize(
           llvm::OptimizationLevel::O3, llvm::ThinOrFullLTOPhase::None));
     }
 
-    pm.addPass(
-        compiler::PrintfReplacementPass(&printf_calls, PRINTF_BUFFER_SIZE));
+    pm.addPass(compiler::PrintfReplacementPass(
+        &printf_calls, PRINTF_BUFFER_SIZE, isPrintfStreamingRequested()));
 
     {
       llvm::FunctionPassManager fpm;
@@ -1854,12 +1926,14 @@ Result BaseModule::finalize(
 
     llvm::CrashRecoveryContext CRC;
     llvm::CrashRecoveryContext::Enable();
-    const bool crashed =
-        !CRC.RunSafely([&] { pm.run(*clone, pass_mach->getMAM()); });
+    const bool crashed = !CRC.RunSafely([&] {
+      const BuildTelemetry::Phase phase(telemetry, "finalize-passes");
+      pm.run(*clone, pass_mach->getMAM());
+    });
     llvm::CrashRecoveryContext::Disable();
 
     // Check if we've accumulated any errors
-    if (crashed || num_errors) {
+    if (crashed || *num_errors) {
       return Result::FINALIZE_PROGRAM_FAILURE;
     }
 
@@ -2001,15 +2075,20 @@ bool BaseModule::deserialize(cargo::array_view<const std::uint8_t> buffer) {
 }
 
 void BaseModule::addDiagnostic(cargo::string_view message) {
-  log.append(message.data(), message.size());
-  log.append("\n");
+  log->append(message.data(), message.size());
+  log->append("\n");
 }
 
 void BaseModule::addBuildError(cargo::string_view message) {
-  num_errors++;
+  (*num_errors)++;
   addDiagnostic(message);
 }
 
+void BaseModule::setBuildLog(uint32_t &new_num_errors, std::string &new_log) {
+  num_errors = &new_num_errors;
+  log = &new_log;
+}
+
 void BaseModule::llvmFatalErrorHandler(void *user_data, const char *reason,
                                        bool gen_crash_diag) {
   // Deliberately ignore gen_crash_diag - if this handler returns, LLVM's
@@ -760,6 +760,17 @@ void compiler::PrintfReplacementPass::rewritePrintfCall(
         arg, ir.CreatePointerCast(gep, ir.getPtrTy(/*AddrSpace=*/1)), Align(1));
   }
 
+  // mark the data as committed so the host may read it while the kernel is
+  // still running, the third word of the header counts committed bytes
+  if (streaming) {
+    ir.CreateAtomicRMW(
+        AtomicRMWInst::Add,
+        ir.CreateGEP(ir.getInt32Ty(),
+                     ir.CreatePointerCast(buffer, ir.getPtrTy(/*AddrSpace=*/1)),
+                     ir.getInt32(2)),
+        ir.getInt32(offset), MaybeAlign(), ordering, SyncScope::System);
+  }
+
   // and return 0;
   ir.CreateRet(ir.getInt32(0));
 
@@ -815,8 +826,8 @@ void compiler::PrintfReplacementPass::rewritePrintfCall(
 }
 
 compiler::PrintfReplacementPass::PrintfReplacementPass(PrintfDescriptorVecTy *p,
-                                                       size_t s)
-    : printf_calls_out_ptr(p), printf_buffer_size(s) {}
+                                                       size_t s, bool streaming)
+    : printf_calls_out_ptr(p), printf_buffer_size(s), streaming(streaming) {}
 
 PreservedAnalyses compiler::PrintfReplacementPass::run(
     Module &module, ModuleAnalysisManager &AM) {
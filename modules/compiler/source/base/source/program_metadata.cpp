@@ -17,6 +17,7 @@
 #include <base/macros.h>
 #include <base/program_metadata.h>
 #include <compiler/utils/metadata.h>
+#include <compiler/utils/address_spaces.h>
 #include <compiler/utils/pass_functions.h>
 #include <compiler/utils/target_extension_types.h>
 #include <llvm/IR/Argument.h>
@@ -298,6 +299,11 @@ static ArgumentType llvmArgToArgumentType(const llvm::Argument *arg,
       return {ArgumentKind::SAMPLER};
     }
 
+    // Pipes are passed as their storage, a buffer in global memory.
+    if (TyName == "spirv.Pipe") {
+      return {static_cast<uint32_t>(utils::AddressSpace::Global)};
+    }
+
     if (TyName == "spirv.Image") {
       [[maybe_unused]] const auto type_name = metadata->getString();
       auto Dim =
@@ -618,6 +624,9 @@ static cargo::expected<KernelInfo, Result> populateKernelInfoFromFunction(
           if (typeAsString.find("volatile") != llvm::StringRef::npos) {
             info.type_qual |= KernelArgType::VOLATILE;
           }
+          if (typeAsString.find("pipe") != llvm::StringRef::npos) {
+            info.type_qual |= KernelArgType::PIPE;
+          }
         } else if ("kernel_arg_name" == mdName) {
           llvm::MDString *const name =
               llvm::cast<llvm::MDString>(mdNode->getOperand(k));
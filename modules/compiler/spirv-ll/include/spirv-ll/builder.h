@@ -768,6 +768,19 @@ class Builder {
   /// very top of the function.
   void generateSpecConstantOps();
 
+  /// @brief Create a placeholder for a specialization constant whose value is
+  /// applied after translation, see `spirv_ll::Context::specialize`.
+  ///
+  /// @param type Scalar type of the specialization constant.
+  /// @param specId Specialization ID of the constant.
+  /// @param defaultValue Bit pattern of the constant's default value.
+  ///
+  /// @return Returns a constant expression of `type` referencing the
+  /// placeholder.
+  llvm::Constant *createSpecConstantPlaceholder(llvm::Type *type,
+                                                uint32_t specId,
+                                                uint64_t defaultValue);
+
   /// @brief Registers an extended instruction set handler with an instruction
   /// set ID.
   ///
@@ -32,6 +32,7 @@
 
 namespace llvm {
 class LLVMContext;
+class Module;
 }  // namespace llvm
 
 namespace spirv_ll {
@@ -138,6 +139,40 @@ struct SpecializationInfo {
   const void *data;
 };
 
+/// @brief Options controlling what a translation produces.
+struct TranslationOptions {
+  /// @brief Names of the entry points to translate.
+  ///
+  /// When not empty only these entry points, and the functions reachable from
+  /// them, are translated. Naming a function which is not an entry point of
+  /// the module is an error.
+  llvm::SmallVector<std::string, 4> entryPoints;
+
+  /// @brief Skip functions which are not reachable from an entry point or a
+  /// function with non-import linkage.
+  ///
+  /// This is implied when `entryPoints` is not empty.
+  bool pruneUnreachableFunctions = false;
+
+  /// @brief Translate specialization constants to placeholders.
+  ///
+  /// When the module's specialization constants are only used as operands of
+  /// instructions within functions, they are translated to placeholders so
+  /// that the resulting `llvm::Module` can be cloned and specialized with
+  /// `Context::specialize` as many times as needed, without translating the
+  /// SPIR-V again. Otherwise the `SpecializationInfo` passed to `translate` is
+  /// applied as usual, see `Module::isSpecializationDeferred`.
+  bool deferSpecialization = false;
+};
+
+/// @brief Name of the named metadata listing specialization constant
+/// placeholders, see `TranslationOptions::deferSpecialization`.
+///
+/// Each operand is a tuple of the placeholder global, the specialization ID,
+/// and the default value of the constant.
+inline constexpr const char *SpecConstantsMetadataName =
+    "spirv_ll.spec_constants";
+
 /// @brief Class holding the SPIR-V context information, such as the types
 ///
 /// This class is similar to the LLVM context class. It holds the types and
@@ -184,11 +219,29 @@ class Context {
   /// @param code Array view of the SPIR-V binary stream.
   /// @param deviceInfo Information about the target device.
   /// @param specInfo Information about specialization constants.
+  /// @param options Options controlling what is translated.
   ///
   /// @return Returns a `spirv_ll::Module` on success, otherwise a
   /// `spirv_ll::Error`.
   cargo::expected<spirv_ll::Module, spirv_ll::Error> translate(
       llvm::ArrayRef<uint32_t> code, const spirv_ll::DeviceInfo &deviceInfo,
+      cargo::optional<const spirv_ll::SpecializationInfo &> specInfo,
+      const spirv_ll::TranslationOptions &options = {});
+
+  /// @brief Apply specialization constants to a module translated with
+  /// `TranslationOptions::deferSpecialization`.
+  ///
+  /// Every placeholder is replaced by its specialized value when `specInfo`
+  /// has an entry for it, or by its default value otherwise. Modules without
+  /// placeholders are left untouched.
+  ///
+  /// @param module LLVM module to specialize, typically a clone of the
+  /// translated module.
+  /// @param specInfo Information about specialization constants.
+  ///
+  /// @return Returns nothing on success, otherwise a `spirv_ll::Error`.
+  static cargo::expected<void, spirv_ll::Error> specialize(
+      llvm::Module &module,
       cargo::optional<const spirv_ll::SpecializationInfo &> specInfo);
 
   /// @brief LLVM context used for translation to LLVM IR.
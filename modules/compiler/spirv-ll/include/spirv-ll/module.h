@@ -881,6 +881,14 @@ class Module : public ModuleHeader {
   /// debug information.
   bool useImplicitDebugScopes() const;
 
+  /// @brief Set whether specialization constants are translated to
+  /// placeholders, see `spirv_ll::TranslationOptions::deferSpecialization`.
+  void setSpecializationDeferred(bool deferred);
+
+  /// @brief Returns true if specialization constants are translated to
+  /// placeholders rather than being specialized during translation.
+  bool isSpecializationDeferred() const;
+
  private:
   /// @brief The set of enabled capabilities.
   llvm::SmallSet<spv::Capability, 16> capabilities;
@@ -995,6 +1003,9 @@ class Module : public ModuleHeader {
   /// False if a DebugInfo-like extension is enabled, and only explicit scope
   /// instructions are to be obeyed.
   bool ImplicitDebugScopes = true;
+  /// @brief True if specialization constants are translated to placeholders
+  /// to be resolved by `spirv_ll::Context::specialize`.
+  bool SpecializationDeferred = false;
 };
 
 }  // namespace spirv_ll
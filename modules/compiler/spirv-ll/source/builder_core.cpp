@@ -42,6 +42,7 @@
 #include <spirv-ll/opcodes.h>
 #include <spirv/unified1/spirv.hpp>
 
+#include <algorithm>
 #include <optional>
 #include <unordered_map>
 
@@ -973,11 +974,50 @@ llvm::Error Builder::create<OpConstantNull>(const OpConstantNull *op) {
   return llvm::Error::success();
 }
 
+llvm::Constant *Builder::createSpecConstantPlaceholder(llvm::Type *type,
+                                                       uint32_t specId,
+                                                       uint64_t defaultValue) {
+  auto &llvmModule = *module.llvmModule;
+  auto &llvmContext = llvmModule.getContext();
+  // The placeholder is an extern_weak declaration so that its address can not
+  // be assumed to be non-null or aligned, which would allow uses to be folded
+  // before the real value is known.
+  auto *placeholder = new llvm::GlobalVariable(
+      llvmModule, llvm::Type::getInt8Ty(llvmContext), /*isConstant*/ true,
+      llvm::GlobalValue::ExternalWeakLinkage, /*Initializer*/ nullptr,
+      "spirv_ll.spec_constant." + std::to_string(specId));
+
+  const unsigned bits = type->getScalarSizeInBits();
+  auto *intTy = llvm::IntegerType::get(llvmContext, bits);
+  auto *storageTy = llvm::IntegerType::get(llvmContext, std::max(bits, 8u));
+  llvm::Metadata *ops[] = {
+      llvm::ConstantAsMetadata::get(placeholder),
+      llvm::ConstantAsMetadata::get(IRBuilder.getInt32(specId)),
+      llvm::ConstantAsMetadata::get(
+          llvm::ConstantInt::get(storageTy, defaultValue))};
+  llvmModule.getOrInsertNamedMetadata(SpecConstantsMetadataName)
+      ->addOperand(llvm::MDNode::get(llvmContext, ops));
+
+  llvm::Constant *value = llvm::ConstantExpr::getPtrToInt(placeholder, intTy);
+  if (type->isFloatingPointTy()) {
+    value = llvm::ConstantExpr::getBitCast(value, type);
+  }
+  return value;
+}
+
 template <>
 llvm::Error Builder::create<OpSpecConstantTrue>(const OpSpecConstantTrue *op) {
   llvm::Type *type = module.getLLVMType(op->IdResultType());
   SPIRV_LL_ASSERT_PTR(type);
 
+  if (module.isSpecializationDeferred()) {
+    if (auto specId = module.getSpecId(op->IdResult())) {
+      module.addID(op->IdResult(), op,
+                   createSpecConstantPlaceholder(type, *specId, 1));
+      return llvm::Error::success();
+    }
+  }
+
   llvm::Constant *spec_constant = nullptr;
   if (auto specId = module.getSpecId(op->IdResult())) {
     if (auto specInfo = module.getSpecInfo()) {
@@ -1011,6 +1051,14 @@ llvm::Error Builder::create<OpSpecConstantFalse>(
   llvm::Type *type = module.getLLVMType(op->IdResultType());
   SPIRV_LL_ASSERT_PTR(type);
 
+  if (module.isSpecializationDeferred()) {
+    if (auto specId = module.getSpecId(op->IdResult())) {
+      module.addID(op->IdResult(), op,
+                   createSpecConstantPlaceholder(type, *specId, 0));
+      return llvm::Error::success();
+    }
+  }
+
   llvm::Constant *spec_constant = nullptr;
   if (auto specId = module.getSpecId(op->IdResult())) {
     if (auto specInfo = module.getSpecInfo()) {
@@ -1050,6 +1098,14 @@ llvm::Error Builder::create<OpSpecConstant>(const OpSpecConstant *op) {
     value = op->Value32();
   }
 
+  if (module.isSpecializationDeferred()) {
+    if (auto specId = module.getSpecId(op->IdResult())) {
+      module.addID(op->IdResult(), op,
+                   createSpecConstantPlaceholder(type, *specId, value));
+      return llvm::Error::success();
+    }
+  }
+
   llvm::Constant *spec_constant = nullptr;
 
   if (auto specId = module.getSpecId(op->IdResult())) {
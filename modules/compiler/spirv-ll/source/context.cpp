@@ -14,11 +14,267 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IR/Module.h>
 #include <spirv-ll/builder.h>
 #include <spirv-ll/context.h>
 #include <spirv-ll/module.h>
 #include <spirv/unified1/spirv.hpp>
 
+#include <deque>
+
+namespace {
+/// @brief Returns true if the opcode only attaches names or decorations to
+/// its operands.
+bool isNameOrDecoration(spv::Op code) {
+  switch (code) {
+    case spv::OpName:
+    case spv::OpMemberName:
+    case spv::OpDecorate:
+    case spv::OpMemberDecorate:
+    case spv::OpDecorateId:
+    case spv::OpDecorateString:
+    case spv::OpMemberDecorateString:
+    case spv::OpGroupDecorate:
+    case spv::OpGroupMemberDecorate:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// @brief Find the functions which must be translated to satisfy `options`.
+///
+/// Functions are live when they are one of the requested entry points, have
+/// non-import linkage (when no entry points were requested), are referenced
+/// by an instruction outside of a function, or are referenced by a live
+/// function. References are found by scanning the operand words of each
+/// instruction, which may over-approximate but never misses a call.
+cargo::expected<llvm::DenseSet<spv::Id>, spirv_ll::Error> findLiveFunctions(
+    const spirv_ll::Module &module,
+    const spirv_ll::TranslationOptions &options) {
+  llvm::DenseSet<spv::Id> functions;
+  for (auto op : module) {
+    if (op.code == spv::OpFunction) {
+      functions.insert(op.getValueAtOffset(2));
+    }
+  }
+
+  llvm::DenseMap<spv::Id, llvm::SmallVector<spv::Id, 4>> callees;
+  llvm::SmallVector<spv::Id, 8> roots;
+  llvm::SmallVector<llvm::StringRef, 4> found;
+  std::optional<spv::Id> current;
+  for (auto op : module) {
+    switch (op.code) {
+      case spv::OpFunction:
+        current = op.getValueAtOffset(2);
+        continue;
+      case spv::OpFunctionEnd:
+        current.reset();
+        continue;
+      case spv::OpEntryPoint: {
+        const spirv_ll::OpEntryPoint entryPoint(op);
+        if (options.entryPoints.empty()) {
+          roots.push_back(entryPoint.EntryPoint());
+        } else if (llvm::is_contained(options.entryPoints,
+                                      entryPoint.Name().str())) {
+          roots.push_back(entryPoint.EntryPoint());
+          found.push_back(entryPoint.Name());
+        }
+        continue;
+      }
+      case spv::OpDecorate:
+        // Functions with export linkage are reachable from other modules.
+        if (options.entryPoints.empty() &&
+            op.getValueAtOffset(2) == spv::DecorationLinkageAttributes &&
+            op.getValueAtOffset(op.wordCount() - 1) !=
+                spv::LinkageTypeImport) {
+          roots.push_back(op.getValueAtOffset(1));
+        }
+        continue;
+      default:
+        if (isNameOrDecoration(op.code)) {
+          continue;
+        }
+        break;
+    }
+    for (uint16_t i = 1; i < op.wordCount(); i++) {
+      const spv::Id id = op.getValueAtOffset(i);
+      if (!functions.contains(id)) {
+        continue;
+      }
+      if (current) {
+        callees[*current].push_back(id);
+      } else {
+        roots.push_back(id);
+      }
+    }
+  }
+
+  for (const auto &name : options.entryPoints) {
+    if (!llvm::is_contained(found, name)) {
+      return cargo::make_unexpected(
+          spirv_ll::Error{"entry point not found: " + name});
+    }
+  }
+
+  llvm::DenseSet<spv::Id> live;
+  std::deque<spv::Id> worklist(roots.begin(), roots.end());
+  while (!worklist.empty()) {
+    const spv::Id id = worklist.front();
+    worklist.pop_front();
+    if (!functions.contains(id) || !live.insert(id).second) {
+      continue;
+    }
+    if (auto it = callees.find(id); it != callees.end()) {
+      worklist.insert(worklist.end(), it->second.begin(), it->second.end());
+    }
+  }
+  return live;
+}
+
+/// @brief Returns true if the opcode may take a specialization constant
+/// placeholder as an operand without requiring its value during translation.
+bool acceptsSpecConstantPlaceholder(spv::Op code) {
+  switch (code) {
+    case spv::OpIAdd:
+    case spv::OpISub:
+    case spv::OpIMul:
+    case spv::OpUDiv:
+    case spv::OpSDiv:
+    case spv::OpUMod:
+    case spv::OpSRem:
+    case spv::OpSMod:
+    case spv::OpFAdd:
+    case spv::OpFSub:
+    case spv::OpFMul:
+    case spv::OpFDiv:
+    case spv::OpFRem:
+    case spv::OpFMod:
+    case spv::OpSNegate:
+    case spv::OpFNegate:
+    case spv::OpShiftLeftLogical:
+    case spv::OpShiftRightLogical:
+    case spv::OpShiftRightArithmetic:
+    case spv::OpBitwiseAnd:
+    case spv::OpBitwiseOr:
+    case spv::OpBitwiseXor:
+    case spv::OpNot:
+    case spv::OpLogicalAnd:
+    case spv::OpLogicalOr:
+    case spv::OpLogicalNot:
+    case spv::OpLogicalEqual:
+    case spv::OpLogicalNotEqual:
+    case spv::OpIEqual:
+    case spv::OpINotEqual:
+    case spv::OpUGreaterThan:
+    case spv::OpSGreaterThan:
+    case spv::OpUGreaterThanEqual:
+    case spv::OpSGreaterThanEqual:
+    case spv::OpULessThan:
+    case spv::OpSLessThan:
+    case spv::OpULessThanEqual:
+    case spv::OpSLessThanEqual:
+    case spv::OpFOrdEqual:
+    case spv::OpFUnordEqual:
+    case spv::OpFOrdNotEqual:
+    case spv::OpFUnordNotEqual:
+    case spv::OpFOrdLessThan:
+    case spv::OpFUnordLessThan:
+    case spv::OpFOrdGreaterThan:
+    case spv::OpFUnordGreaterThan:
+    case spv::OpFOrdLessThanEqual:
+    case spv::OpFUnordLessThanEqual:
+    case spv::OpFOrdGreaterThanEqual:
+    case spv::OpFUnordGreaterThanEqual:
+    case spv::OpConvertFToU:
+    case spv::OpConvertFToS:
+    case spv::OpConvertSToF:
+    case spv::OpConvertUToF:
+    case spv::OpUConvert:
+    case spv::OpSConvert:
+    case spv::OpFConvert:
+    case spv::OpBitcast:
+    case spv::OpSelect:
+    case spv::OpPhi:
+    case spv::OpStore:
+    case spv::OpFunctionCall:
+    case spv::OpReturnValue:
+    case spv::OpBranchConditional:
+    case spv::OpSwitch:
+    case spv::OpCompositeConstruct:
+    case spv::OpCompositeInsert:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// @brief Returns true if the module's specialization constants can be
+/// translated to placeholders.
+///
+/// This is only the case for OpenCL modules where every use of a decorated
+/// scalar specialization constant is a value operand inside a function. Uses
+/// at module scope, such as array lengths or `OpSpecConstantOp`, and uses
+/// which must be known while translating, such as memory scopes, require the
+/// value up front.
+bool canDeferSpecialization(const spirv_ll::Module &module) {
+  bool isKernel = false;
+  llvm::DenseSet<spv::Id> specIds;
+  for (auto op : module) {
+    if (op.code == spv::OpCapability &&
+        op.getValueAtOffset(1) == spv::CapabilityKernel) {
+      isKernel = true;
+    } else if (op.code == spv::OpDecorate &&
+               op.getValueAtOffset(2) == spv::DecorationSpecId) {
+      specIds.insert(op.getValueAtOffset(1));
+    } else if (op.code == spv::OpFunction) {
+      break;
+    }
+  }
+  if (!isKernel) {
+    return false;
+  }
+
+  llvm::DenseSet<spv::Id> specConstants;
+  bool inFunction = false;
+  for (auto op : module) {
+    switch (op.code) {
+      case spv::OpSpecConstantTrue:
+      case spv::OpSpecConstantFalse:
+      case spv::OpSpecConstant:
+        if (specIds.contains(op.getValueAtOffset(2))) {
+          specConstants.insert(op.getValueAtOffset(2));
+        }
+        continue;
+      case spv::OpFunction:
+        inFunction = true;
+        continue;
+      case spv::OpFunctionEnd:
+        inFunction = false;
+        continue;
+      default:
+        if (isNameOrDecoration(op.code)) {
+          continue;
+        }
+        break;
+    }
+    if (inFunction && acceptsSpecConstantPlaceholder(op.code)) {
+      continue;
+    }
+    for (uint16_t i = 1; i < op.wordCount(); i++) {
+      if (specConstants.contains(op.getValueAtOffset(i))) {
+        return false;
+      }
+    }
+  }
+  return !specConstants.empty();
+}
+}  // namespace
+
 spirv_ll::Context::Context()
     : llvmContext(new llvm::LLVMContext), llvmContextIsOwned(true) {}
 
@@ -127,13 +383,27 @@ spirv_ll::Context::getSpecializableConstants(llvm::ArrayRef<uint32_t> code) {
 
 cargo::expected<spirv_ll::Module, spirv_ll::Error> spirv_ll::Context::translate(
     llvm::ArrayRef<uint32_t> code, const spirv_ll::DeviceInfo &deviceInfo,
-    cargo::optional<const spirv_ll::SpecializationInfo &> specInfo) {
+    cargo::optional<const spirv_ll::SpecializationInfo &> specInfo,
+    const spirv_ll::TranslationOptions &options) {
   SPIRV_LL_ASSERT(llvmContext, "llvmContext must not be null");
   spirv_ll::Module module(*this, code, specInfo);
   if (!module.isValid()) {
     return cargo::make_unexpected(Error{"invalid SPIR-V module binary"});
   }
 
+  std::optional<llvm::DenseSet<spv::Id>> liveFunctions;
+  if (options.pruneUnreachableFunctions || !options.entryPoints.empty()) {
+    auto live = findLiveFunctions(module, options);
+    if (!live) {
+      return cargo::make_unexpected(std::move(live.error()));
+    }
+    liveFunctions = std::move(*live);
+  }
+
+  if (options.deferSpecialization && canDeferSpecialization(module)) {
+    module.setSpecializationDeferred(true);
+  }
+
   spirv_ll::Builder builder(*this, module, deviceInfo);
 
   using IRInsertPoint = llvm::IRBuilder<>::InsertPoint;
@@ -145,8 +415,30 @@ cargo::expected<spirv_ll::Module, spirv_ll::Error> spirv_ll::Context::translate(
   // Store the Phi nodes in order to add the values after all the basic blocks
   // have been generated
   llvm::SmallVector<OpIRLocTy, 8> Phis;
+  // Set while skipping the body of a function which is not live.
+  bool skippingFunction = false;
 
   for (auto op : module) {
+    if (liveFunctions) {
+      if (op.code == spv::OpFunction &&
+          !liveFunctions->contains(op.getValueAtOffset(2))) {
+        skippingFunction = true;
+      }
+      if (skippingFunction) {
+        skippingFunction = op.code != spv::OpFunctionEnd;
+        continue;
+      }
+      // Drop entry points, and their execution modes, which were not
+      // requested so that they don't affect the translated module.
+      if ((op.code == spv::OpEntryPoint &&
+           !liveFunctions->contains(op.getValueAtOffset(2))) ||
+          ((op.code == spv::OpExecutionMode ||
+            op.code == spv::OpExecutionModeId) &&
+           !liveFunctions->contains(op.getValueAtOffset(1)))) {
+        continue;
+      }
+    }
+
     std::optional<llvm::Error> error;
     switch (op.code) {
         // Unsupported opcodes are ignored.
@@ -1121,3 +1413,73 @@ cargo::expected<spirv_ll::Module, spirv_ll::Error> spirv_ll::Context::translate(
 
   return module;
 }
+
+cargo::expected<void, spirv_ll::Error> spirv_ll::Context::specialize(
+    llvm::Module &module,
+    cargo::optional<const spirv_ll::SpecializationInfo &> specInfo) {
+  auto *placeholders = module.getNamedMetadata(SpecConstantsMetadataName);
+  if (!placeholders) {
+    return {};
+  }
+
+  for (auto *placeholder : placeholders->operands()) {
+    auto *global = llvm::mdconst::extract<llvm::GlobalVariable>(
+        placeholder->getOperand(0));
+    const uint32_t specId =
+        llvm::mdconst::extract<llvm::ConstantInt>(placeholder->getOperand(1))
+            ->getZExtValue();
+    auto *defaultValue =
+        llvm::mdconst::extract<llvm::ConstantInt>(placeholder->getOperand(2));
+
+    uint64_t value = defaultValue->getZExtValue();
+    if (specInfo && specInfo->isSpecialized(specId)) {
+      switch (defaultValue->getBitWidth()) {
+        case 8: {
+          auto specValue = specInfo->getValue<uint8_t>(specId);
+          if (!specValue) {
+            return cargo::make_unexpected(specValue.error());
+          }
+          value = *specValue;
+        } break;
+        case 16: {
+          auto specValue = specInfo->getValue<uint16_t>(specId);
+          if (!specValue) {
+            return cargo::make_unexpected(specValue.error());
+          }
+          value = *specValue;
+        } break;
+        case 32: {
+          auto specValue = specInfo->getValue<uint32_t>(specId);
+          if (!specValue) {
+            return cargo::make_unexpected(specValue.error());
+          }
+          value = *specValue;
+        } break;
+        case 64: {
+          auto specValue = specInfo->getValue<uint64_t>(specId);
+          if (!specValue) {
+            return cargo::make_unexpected(specValue.error());
+          }
+          value = *specValue;
+        } break;
+        default:
+          return cargo::make_unexpected(
+              Error{"invalid specialization constant size"});
+      }
+    }
+
+    // Users of the placeholder are the `ptrtoint` expressions created by
+    // `Builder::createSpecConstantPlaceholder`, replacing them also folds any
+    // `bitcast` to a floating point type.
+    llvm::SmallVector<llvm::User *, 4> users(global->users());
+    for (auto *user : users) {
+      auto *intTy = llvm::cast<llvm::IntegerType>(user->getType());
+      user->replaceAllUsesWith(llvm::ConstantInt::get(
+          intTy, intTy->getBitWidth() == 1 ? value != 0 : value));
+    }
+    global->removeDeadConstantUsers();
+    global->eraseFromParent();
+  }
+  module.eraseNamedMetadata(placeholders);
+  return {};
+}
@@ -70,7 +70,8 @@ spirv_ll::Module::Module(
       specInfo(specInfo),
       WorkgroupSize({{1, 1, 1}}),
       deferredSpecConstantOps(),
-      ImplicitDebugScopes(true) {}
+      ImplicitDebugScopes(true),
+      SpecializationDeferred(false) {}
 
 spirv_ll::Module::Module(spirv_ll::Context &context,
                          llvm::ArrayRef<uint32_t> code)
@@ -92,7 +93,8 @@ spirv_ll::Module::Module(spirv_ll::Context &context,
       specInfo(),
       WorkgroupSize({{1, 1, 1}}),
       deferredSpecConstantOps(),
-      ImplicitDebugScopes(true) {}
+      ImplicitDebugScopes(true),
+      SpecializationDeferred(false) {}
 
 void spirv_ll::Module::associateExtendedInstrSet(spv::Id id,
                                                  ExtendedInstrSet iset) {
@@ -222,6 +224,14 @@ void spirv_ll::Module::disableImplicitDebugScopes() {
   ImplicitDebugScopes = false;
 }
 
+void spirv_ll::Module::setSpecializationDeferred(bool deferred) {
+  SpecializationDeferred = deferred;
+}
+
+bool spirv_ll::Module::isSpecializationDeferred() const {
+  return SpecializationDeferred;
+}
+
 void spirv_ll::Module::addDebugFunctionScope(
     spv::Id function_id, llvm::DISubprogram *function_scope) {
   FunctionScopes.insert({function_id, function_scope});
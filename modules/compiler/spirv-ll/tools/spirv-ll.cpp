@@ -116,6 +116,14 @@ int main(int argc, char **argv) {
   if (auto error = parser.add_argument({"--spec-constants", specConstants})) {
     return error;
   }
+  // -p NAME, --entry-point NAME
+  cargo::small_vector<cargo::string_view, 4> entryPoints;
+  if (auto error = parser.add_argument({"-p", entryPoints})) {
+    return error;
+  }
+  if (auto error = parser.add_argument({"--entry-point", entryPoints})) {
+    return error;
+  }
 
   const std::string usage =
       "usage: " + std::string{argv[0]} + " [options] input";
@@ -151,6 +159,10 @@ optional arguments:
                         size of device address in bits
         -s, --spec-constants
                         output all specialization constants and exit
+        -p NAME, --entry-point NAME
+                        name of entry point to translate, multiple supported,
+                        other functions are only translated when reachable
+                        from an entry point
 )";
     return 0;
   }
@@ -207,8 +219,15 @@ optional arguments:
   // passed here, since this is a debug/test tool we can just pass an empty map.
   spirv_ll::SpecializationInfo spvSpecializationInfo;
 
-  auto spvModule =
-      spvContext.translate(spvCode, *spvDeviceInfo, spvSpecializationInfo);
+  spirv_ll::TranslationOptions translationOptions;
+  for (auto entryPoint : entryPoints) {
+    translationOptions.entryPoints.emplace_back(entryPoint.data(),
+                                                entryPoint.size());
+  }
+
+  auto spvModule = spvContext.translate(spvCode, *spvDeviceInfo,
+                                        spvSpecializationInfo,
+                                        translationOptions);
   if (!spvModule) {
     std::cerr << spvModule.error().message << "\n";
     return 1;
@@ -0,0 +1,55 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// Add copies of kernels specialized for fixed local sizes.
+
+#ifndef HOST_ADD_LOCAL_SIZE_VARIANTS_PASS_H_INCLUDED
+#define HOST_ADD_LOCAL_SIZE_VARIANTS_PASS_H_INCLUDED
+
+#include <llvm/IR/PassManager.h>
+
+#include <array>
+#include <vector>
+
+namespace host {
+
+/// @brief This pass adds a copy of every kernel for each of a list of local
+/// sizes, with the local size encoded as its required work-group size.
+///
+/// The copies keep the original kernel's name as their source name, so once
+/// the module is finalized each is another variant of the same kernel, which
+/// the runtime picks when an ND-range has exactly that local size. Kernels
+/// which already have a required work-group size aren't copied.
+///
+/// Must run after `compiler::utils::TransferKernelMetadataPass` and before
+/// the kernels are finalized.
+class AddLocalSizeVariantsPass final
+    : public llvm::PassInfoMixin<AddLocalSizeVariantsPass> {
+ public:
+  explicit AddLocalSizeVariantsPass(
+      std::vector<std::array<uint64_t, 3>> LocalSizes)
+      : LocalSizes(std::move(LocalSizes)) {}
+
+  llvm::PreservedAnalyses run(llvm::Module &, llvm::ModuleAnalysisManager &);
+
+ private:
+  std::vector<std::array<uint64_t, 3>> LocalSizes;
+};
+}  // namespace host
+
+#endif  // HOST_ADD_LOCAL_SIZE_VARIANTS_PASS_H_INCLUDED
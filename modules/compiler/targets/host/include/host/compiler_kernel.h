@@ -53,7 +53,8 @@ struct OptimizedKernel {
 class HostKernel : public compiler::BaseKernel {
  public:
   HostKernel(HostTarget &target, compiler::Options &build_options,
-             llvm::Module *module, std::string name,
+             compiler::BuildTelemetry &telemetry, llvm::Module *module,
+             std::string name,
              std::array<size_t, 3> preferred_local_sizes,
              size_t local_memory_used);
 
@@ -83,6 +84,11 @@ class HostKernel : public compiler::BaseKernel {
   /// @brief No-op implementation indicating sub-groups are not supported.
   cargo::expected<size_t, compiler::Result> queryMaxSubGroupCount() override;
 
+  /// @see Kernel::createFusedKernel
+  cargo::expected<std::unique_ptr<compiler::Kernel>, compiler::Result>
+  createFusedKernel(cargo::array_view<compiler::Kernel *const> kernels,
+                    cargo::array_view<const uint64_t> buffers) override;
+
  private:
   /// @brief Gets an `OptimizedKernel` object for the given local size.
   ///
@@ -108,6 +114,10 @@ class HostKernel : public compiler::BaseKernel {
 
   /// @brief Build options passed to the module this kernel was created from.
   compiler::Options &build_options;
+
+  /// @brief Telemetry of the module this kernel was created from, which
+  /// specializations of the kernel are recorded to.
+  compiler::BuildTelemetry &telemetry;
 };
 }  // namespace host
 
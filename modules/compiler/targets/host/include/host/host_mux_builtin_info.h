@@ -33,6 +33,7 @@ enum Type {
   slice,
   total_slices,
   work_dim,
+  local_memory,
   total
 };
 }
@@ -0,0 +1,46 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// Allocate local memory from the executing thread's arena.
+
+#ifndef HOST_LOCAL_MEMORY_ARENA_PASS_H_INCLUDED
+#define HOST_LOCAL_MEMORY_ARENA_PASS_H_INCLUDED
+
+#include <llvm/IR/PassManager.h>
+
+namespace host {
+
+/// @brief This pass replaces the allocas of local memory made by the kernel
+/// wrappers with allocations from the arena in the schedule info.
+///
+/// Each thread of the host thread pool owns an arena which is reused by every
+/// work-group it executes, so local memory isn't limited by the size of the
+/// thread's stack. The arena pointer in the schedule info is bumped past each
+/// allocation, so that the wrappers of a kernel each allocate after the other.
+///
+/// Must run after `compiler::utils::ReplaceLocalModuleScopeVariablesPass`,
+/// which marks the allocas it makes with `setIsLocalMemoryAlloca`, as does
+/// `compiler::utils::AddKernelWrapperPass` for local buffer arguments.
+class LocalMemoryArenaPass final
+    : public llvm::PassInfoMixin<LocalMemoryArenaPass> {
+ public:
+  llvm::PreservedAnalyses run(llvm::Module &, llvm::ModuleAnalysisManager &);
+};
+}  // namespace host
+
+#endif  // HOST_LOCAL_MEMORY_ARENA_PASS_H_INCLUDED
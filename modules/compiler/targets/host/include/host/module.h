@@ -96,11 +96,14 @@ class HostModule : public compiler::BaseModule {
   /// performed.
   /// @param module Module to compile, needs to have been finalized (i.e.
   /// `BaseModule::finalize` has been called).
+  /// @param target_machine Target machine to emit code with, or null to use
+  /// the target's.
   ///
   /// @return Cargo dynamic array containing the ELF binary.
   cargo::expected<cargo::dynamic_array<uint8_t>, compiler::Result>
   hostCompileObject(HostTarget &target, const compiler::Options &build_options,
-                    llvm::Module *module);
+                    llvm::Module *module,
+                    llvm::TargetMachine *target_machine = nullptr);
 };  // class Module
 }  // namespace host
 
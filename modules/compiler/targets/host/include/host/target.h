@@ -71,6 +71,10 @@ class HostTarget : public compiler::BaseTarget {
   /// @brief The llvm TargetMachine.
   std::unique_ptr<llvm::TargetMachine> target_machine;
 
+  /// @brief TargetMachine generating position independent code for prelinked
+  /// images, null if the target's code can't be prelinked.
+  std::unique_ptr<llvm::TargetMachine> image_target_machine;
+
   /// @brief An atomic uint64_t to ensure unique identifiers are used.
   ///
   /// This field is used to ensure that each kernel that is JIT'ed by the
@@ -0,0 +1,57 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <compiler/utils/attributes.h>
+#include <compiler/utils/metadata.h>
+#include <host/add_local_size_variants_pass.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+using namespace llvm;
+
+PreservedAnalyses host::AddLocalSizeVariantsPass::run(
+    Module &M, ModuleAnalysisManager &) {
+  SmallVector<Function *, 4> Kernels;
+  for (auto &F : M) {
+    if (!F.isDeclaration() && compiler::utils::isKernelEntryPt(F) &&
+        !compiler::utils::getLocalSizeMetadata(F)) {
+      Kernels.push_back(&F);
+    }
+  }
+  if (Kernels.empty() || LocalSizes.empty()) {
+    return PreservedAnalyses::all();
+  }
+
+  for (auto *const F : Kernels) {
+    if (compiler::utils::getOrigFnName(*F).empty()) {
+      compiler::utils::setOrigFnName(*F);
+    }
+    for (const auto &LocalSize : LocalSizes) {
+      // The clone keeps the kernel's attributes, including the original name
+      // it's reported under once finalized.
+      ValueToValueMapTy VMap;
+      Function *const Variant = CloneFunction(F, VMap);
+      Variant->setName(F->getName() + ".mux-local-size." +
+                       Twine(LocalSize[0]) + "." + Twine(LocalSize[1]) + "." +
+                       Twine(LocalSize[2]));
+      compiler::utils::encodeLocalSizeMetadata(*Variant, LocalSize);
+    }
+  }
+
+  return PreservedAnalyses::none();
+}
@@ -72,6 +72,7 @@ StructType *HostBIMuxInfo::getScheduleInfoStruct(Module &M) {
   elements[ScheduleInfoStruct::slice] = size_type;
   elements[ScheduleInfoStruct::total_slices] = size_type;
   elements[ScheduleInfoStruct::work_dim] = uint_type;
+  elements[ScheduleInfoStruct::local_memory] = PointerType::getUnqual(Ctx);
 
   return StructType::create(elements, HostStructName);
 }
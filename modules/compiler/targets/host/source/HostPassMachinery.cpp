@@ -41,20 +41,69 @@
 #include <compiler/utils/work_item_loops_pass.h>
 #include <host/add_entry_hook_pass.h>
 #include <host/add_floating_point_control_pass.h>
+#include <host/add_local_size_variants_pass.h>
 #include <host/host_pass_machinery.h>
+#include <host/local_memory_arena_pass.h>
 #include <host/remove_byval_attributes_pass.h>
 #include <host/target.h>
 #include <llvm/ADT/APFloat.h>
 #include <llvm/ADT/bit.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FormatVariadic.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <multi_llvm/llvm_version.h>
+#include <multi_llvm/target_transform_info.h>
 #include <utils/system.h>
 #include <vecz/pass.h>
 
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
 namespace host {
 
+/// @brief Decide whether a kernel should also be vectorized with vector
+/// predication, so that work-item loops can run the remainder of a work-group
+/// as a single masked vector iteration rather than a scalar loop.
+///
+/// The `CA_HOST_VP_TAIL` environment variable overrides the heuristic, `0`
+/// never requests a predicated tail and any other value always does.
+static bool hostWantsVectorPredicatedTail(llvm::Function &F,
+                                          llvm::ModuleAnalysisManager &MAM,
+                                          uint32_t local_size,
+                                          uint32_t SIMDWidth) {
+  if (SIMDWidth < 2) {
+    return false;
+  }
+  if (const char *env = std::getenv("CA_HOST_VP_TAIL")) {
+    return 0 != std::strcmp(env, "0");
+  }
+  // With a known local size the remainder is known too. Without one, assume a
+  // tail is likely.
+  if (local_size != 0) {
+    const uint32_t remainder = local_size % SIMDWidth;
+    // A short tail is cheaper to run scalar than to pay for a second kernel.
+    if (remainder * 4 < SIMDWidth) {
+      return false;
+    }
+  }
+  // Predicated vectors are only worthwhile where the target can mask memory
+  // accesses natively, e.g. AVX-512, SVE or RVV. Otherwise the backend has to
+  // scalarize every masked access.
+  auto &FAM =
+      MAM.getResult<llvm::FunctionAnalysisManagerModuleProxy>(*F.getParent())
+          .getManager();
+  const auto &TTI = FAM.getResult<llvm::TargetIRAnalysis>(F);
+  auto *const VecTy = llvm::FixedVectorType::get(
+      llvm::Type::getInt32Ty(F.getContext()), SIMDWidth);
+  return multi_llvm::isLegalMaskedLoad(TTI, VecTy, llvm::Align(4), 0) &&
+         multi_llvm::isLegalMaskedStore(TTI, VecTy, llvm::Align(4), 0);
+}
+
 static bool hostVeczPassOpts(
     llvm::Function &F, llvm::ModuleAnalysisManager &MAM,
     llvm::SmallVectorImpl<vecz::VeczPassOptions> &Opts) {
@@ -117,6 +166,16 @@ static bool hostVeczPassOpts(
   vecz_options.factor = llvm::ElementCount::getFixed(SIMDWidth);
 
   Opts.push_back(vecz_options);
+
+  // Work-item loops prefer a vector-predicated variant of the same width for
+  // the remainder of each work-group over the scalar kernel.
+  if (!vecz_options.choices.isEnabled(
+          vecz::VectorizationChoices::eVectorPredication) &&
+      hostWantsVectorPredicatedTail(F, MAM, local_size, SIMDWidth)) {
+    vecz_options.choices.enable(
+        vecz::VectorizationChoices::eVectorPredication);
+    Opts.push_back(vecz_options);
+  }
   return true;
 }
 
@@ -142,6 +201,32 @@ static llvm::Expected<bool> parseFloatPointControlPassOptions(
                                                 "FloatPointControlPass");
 }
 
+static llvm::Expected<std::vector<std::array<uint64_t, 3>>>
+parseLocalSizeVariantsPassOptions(llvm::StringRef Params) {
+  std::vector<std::array<uint64_t, 3>> LocalSizes;
+  while (!Params.empty()) {
+    llvm::StringRef Param;
+    std::tie(Param, Params) = Params.split(';');
+    std::array<uint64_t, 3> LocalSize = {1, 1, 1};
+    llvm::StringRef Sizes = Param;
+    bool Valid = true;
+    for (auto &Size : LocalSize) {
+      llvm::StringRef Val;
+      std::tie(Val, Sizes) = Sizes.split(':');
+      Valid &= !Val.getAsInteger(10, Size) && 0 != Size;
+    }
+    if (!Valid || !Sizes.empty()) {
+      return llvm::make_error<llvm::StringError>(
+          llvm::formatv("invalid AddLocalSizeVariantsPass local size '{0}' ",
+                        Param)
+              .str(),
+          llvm::inconvertibleErrorCode());
+    }
+    LocalSizes.push_back(LocalSize);
+  }
+  return LocalSizes;
+}
+
 void HostPassMachinery::registerPasses() {
 #define MODULE_ANALYSIS(NAME, CREATE_PASS) \
   MAM.registerPass([&] { return CREATE_PASS; });
@@ -274,6 +359,9 @@ llvm::ModulePassManager HostPassMachinery::getKernelFinalizationPasses(
 
   PM.addPass(compiler::utils::ReplaceLocalModuleScopeVariablesPass());
 
+  // Allocate local memory from the thread's arena rather than its stack.
+  PM.addPass(host::LocalMemoryArenaPass());
+
   PM.addPass(AddFloatingPointControlPass(options.denorms_may_be_zero));
 
   if (unique_prefix) {
@@ -302,8 +390,8 @@ llvm::ModulePassManager HostPassMachinery::getKernelFinalizationPasses(
   }
 
   PM.addPass(compiler::utils::AddMetadataPass<
-             compiler::utils::VectorizeMetadataAnalysis,
-             handler::VectorizeInfoMetadataHandler>());
+             compiler::utils::LocalSizeMetadataAnalysis,
+             handler::LocalSizeInfoMetadataHandler>());
 
   PM.addPass(llvm::createModuleToFunctionPassAdaptor(
       compiler::utils::ManualTypeLegalizationPass()));
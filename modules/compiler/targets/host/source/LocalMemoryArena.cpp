@@ -0,0 +1,104 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <compiler/utils/builtin_info.h>
+#include <compiler/utils/metadata.h>
+#include <host/host_mux_builtin_info.h>
+#include <host/local_memory_arena_pass.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+using namespace llvm;
+
+PreservedAnalyses host::LocalMemoryArenaPass::run(Module &M,
+                                                  ModuleAnalysisManager &AM) {
+  auto &BI = AM.getResult<compiler::utils::BuiltinInfoAnalysis>(M);
+  auto *const ScheduleInfoTy = HostBIMuxInfo::getScheduleInfoStruct(M);
+  const auto &DL = M.getDataLayout();
+  auto *const IntPtrTy = DL.getIntPtrType(M.getContext());
+  auto *const PtrTy = PointerType::getUnqual(M.getContext());
+
+  bool Changed = false;
+  for (auto &F : M) {
+    SmallVector<AllocaInst *, 4> Allocas;
+    for (auto &I : instructions(F)) {
+      if (auto *const AI = dyn_cast<AllocaInst>(&I);
+          AI && compiler::utils::isLocalMemoryAlloca(*AI)) {
+        Allocas.push_back(AI);
+      }
+    }
+    if (Allocas.empty()) {
+      continue;
+    }
+
+    // The wrappers making local memory allocas are passed the schedule info.
+    Value *ScheduleInfo = nullptr;
+    for (const auto &Param : BI.getFunctionSchedulingParameters(F)) {
+      if (Param.ParamPointeeTy == ScheduleInfoTy) {
+        ScheduleInfo = Param.ArgVal;
+      }
+    }
+    if (!ScheduleInfo) {
+      continue;
+    }
+
+    // Each call bumps the arena pointer past its allocations, so that the
+    // functions it calls allocate after them, and puts it back on return so
+    // that the next work-group reuses the same memory.
+    IRBuilder<> EntryB(&*F.getEntryBlock().getFirstInsertionPt());
+    auto *const ArenaPtr = EntryB.CreateStructGEP(
+        ScheduleInfoTy, ScheduleInfo, ScheduleInfoStruct::local_memory);
+    auto *const ArenaStart =
+        EntryB.CreateLoad(PtrTy, ArenaPtr, "local_memory.start");
+    for (auto &BB : F) {
+      if (auto *const Ret = dyn_cast<ReturnInst>(BB.getTerminator())) {
+        IRBuilder<>(Ret).CreateStore(ArenaStart, ArenaPtr);
+      }
+    }
+
+    for (auto *const AI : Allocas) {
+      IRBuilder<> B(AI);
+      auto *const Arena = B.CreateLoad(PtrTy, ArenaPtr, "local_memory");
+
+      // Round the arena pointer up to the alloca's alignment.
+      const uint64_t Align = AI->getAlign().value();
+      auto *const Address = B.CreatePtrToInt(Arena, IntPtrTy);
+      auto *const Padding = B.CreateAnd(
+          B.CreateSub(ConstantInt::get(IntPtrTy, 0), Address),
+          ConstantInt::get(IntPtrTy, Align - 1));
+      auto *const Base = B.CreateGEP(B.getInt8Ty(), Arena, Padding);
+
+      const uint64_t AllocSize =
+          DL.getTypeAllocSize(AI->getAllocatedType()).getFixedValue();
+      Value *Size = ConstantInt::get(IntPtrTy, AllocSize);
+      if (AI->isArrayAllocation()) {
+        Size = B.CreateMul(
+            Size, B.CreateZExtOrTrunc(AI->getArraySize(), IntPtrTy));
+      }
+      B.CreateStore(B.CreateGEP(B.getInt8Ty(), Base, Size), ArenaPtr);
+
+      Base->takeName(AI);
+      AI->replaceAllUsesWith(
+          B.CreatePointerBitCastOrAddrSpaceCast(Base, AI->getType()));
+      AI->eraseFromParent();
+      Changed = true;
+    }
+  }
+
+  return Changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
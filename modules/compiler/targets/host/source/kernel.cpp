@@ -15,7 +15,9 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <base/base_module_pass_machinery.h>
+#include <compiler/utils/address_spaces.h>
 #include <compiler/utils/attributes.h>
+#include <compiler/utils/builtin_info.h>
 #include <compiler/utils/cl_builtin_info.h>
 #include <compiler/utils/encode_kernel_metadata_pass.h>
 #include <compiler/utils/llvm_global_mutex.h>
@@ -33,18 +35,25 @@
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Linker/Linker.h>
 #include <llvm/Support/CrashRecoveryContext.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/Utils/Cloning.h>
 #include <multi_llvm/llvm_version.h>
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "cargo/expected.h"
 #include "tracer/tracer.h"
 
 namespace host {
 
 HostKernel::HostKernel(HostTarget &target, compiler::Options &build_options,
+                       compiler::BuildTelemetry &telemetry,
                        llvm::Module *module, std::string name,
                        std::array<size_t, 3> preferred_local_sizes,
                        size_t local_memory_used)
@@ -52,7 +61,8 @@ HostKernel::HostKernel(HostTarget &target, compiler::Options &build_options,
                  preferred_local_sizes[2], local_memory_used),
       module(module),
       target(target),
-      build_options(build_options) {}
+      build_options(build_options),
+      telemetry(telemetry) {}
 
 HostKernel::~HostKernel() {
   if (target.orc_engine) {
@@ -208,6 +218,354 @@ cargo::expected<size_t, compiler::Result> HostKernel::queryMaxSubGroupCount() {
   return static_cast<size_t>(info.max_sub_group_count);
 }
 
+namespace {
+/// @brief How a kernel accesses the memory one of its arguments points to.
+struct FusionArgAccess {
+  /// @brief Whether the kernel may read the memory.
+  bool reads = false;
+  /// @brief Whether the kernel may write the memory.
+  bool writes = false;
+  /// @brief Whether every access is to the element indexed by the work-item's
+  /// global ID in the first dimension.
+  bool elementwise = true;
+  /// @brief Size in bytes of the elements accessed, if any were.
+  uint64_t stride = 0;
+};
+
+/// @brief Returns whether a value is the work-item's global ID in the first
+/// dimension, possibly truncated or extended.
+bool isGlobalIdX(const llvm::Value *value) {
+  while (auto *cast = llvm::dyn_cast<llvm::CastInst>(value)) {
+    if (!llvm::isa<llvm::TruncInst, llvm::SExtInst, llvm::ZExtInst>(cast)) {
+      return false;
+    }
+    value = cast->getOperand(0);
+  }
+  auto *call = llvm::dyn_cast<llvm::CallInst>(value);
+  if (!call || !call->getCalledFunction()) {
+    return false;
+  }
+  static const std::string global_id_name =
+      compiler::utils::BuiltinInfo::getMuxBuiltinName(
+          compiler::utils::eMuxBuiltinGetGlobalId);
+  auto *dim = llvm::dyn_cast<llvm::ConstantInt>(call->getArgOperand(0));
+  return call->getCalledFunction()->getName() == global_id_name && dim &&
+         dim->isZero();
+}
+
+/// @brief Finds out how a kernel argument's memory is accessed.
+FusionArgAccess analyzeFusionArg(llvm::Argument &arg) {
+  FusionArgAccess access;
+  const auto &DL = arg.getParent()->getParent()->getDataLayout();
+  auto unknown = [&]() {
+    access.reads = true;
+    access.writes = true;
+    access.elementwise = false;
+  };
+  auto checkElement = [&](bool at_element, uint64_t stride, llvm::Type *type) {
+    if (!at_element || DL.getTypeStoreSize(type) > stride ||
+        (access.stride && access.stride != stride)) {
+      access.elementwise = false;
+    }
+    access.stride = stride;
+  };
+
+  // Pointers derived from the argument, the element size if the pointer is to
+  // the work-item's element, or zero.
+  llvm::SmallVector<std::pair<llvm::Value *, uint64_t>, 8> worklist;
+  worklist.push_back({&arg, 0});
+  while (!worklist.empty()) {
+    auto [pointer, stride] = worklist.pop_back_val();
+    for (auto *user : pointer->users()) {
+      if (auto *gep = llvm::dyn_cast<llvm::GetElementPtrInst>(user)) {
+        const bool at_element = pointer == &arg && gep->getNumIndices() == 1 &&
+                                isGlobalIdX(gep->getOperand(1));
+        worklist.push_back(
+            {gep, at_element
+                      ? DL.getTypeAllocSize(gep->getSourceElementType())
+                            .getFixedValue()
+                      : 0});
+      } else if (llvm::isa<llvm::BitCastInst, llvm::AddrSpaceCastInst>(
+                     user)) {
+        worklist.push_back({user, stride});
+      } else if (auto *load = llvm::dyn_cast<llvm::LoadInst>(user)) {
+        access.reads = true;
+        checkElement(0 != stride && load->isSimple(), stride, load->getType());
+      } else if (auto *store = llvm::dyn_cast<llvm::StoreInst>(user);
+                 store && store->getPointerOperand() == pointer &&
+                 store->getValueOperand() != pointer) {
+        access.writes = true;
+        checkElement(0 != stride && store->isSimple(), stride,
+                     store->getValueOperand()->getType());
+      } else {
+        // The pointer escapes, e.g. into a call or an atomic operation.
+        unknown();
+      }
+    }
+  }
+  return access;
+}
+
+/// @brief Checks a kernel can be fused and finds out how it accesses each of
+/// its arguments.
+///
+/// @param function Kernel function.
+/// @param accesses Populated with how each argument is accessed.
+///
+/// @return Returns false if work-items of the kernel synchronize or share
+/// memory other than through its arguments, so the kernel can't be fused.
+bool analyzeFusionKernel(llvm::Function &function,
+                         llvm::SmallVectorImpl<FusionArgAccess> &accesses) {
+  static const auto allowed_builtins = [] {
+    std::unordered_set<std::string> names;
+    for (auto id :
+         {compiler::utils::eMuxBuiltinIsFTZ,
+          compiler::utils::eMuxBuiltinUseFast,
+          compiler::utils::eMuxBuiltinIsEmbeddedProfile,
+          compiler::utils::eMuxBuiltinGetGlobalSize,
+          compiler::utils::eMuxBuiltinGetGlobalId,
+          compiler::utils::eMuxBuiltinGetGlobalOffset,
+          compiler::utils::eMuxBuiltinGetLocalSize,
+          compiler::utils::eMuxBuiltinGetLocalId,
+          compiler::utils::eMuxBuiltinGetNumGroups,
+          compiler::utils::eMuxBuiltinGetGroupId,
+          compiler::utils::eMuxBuiltinGetWorkDim,
+          compiler::utils::eMuxBuiltinGetGlobalLinearId,
+          compiler::utils::eMuxBuiltinGetLocalLinearId,
+          compiler::utils::eMuxBuiltinGetEnqueuedLocalSize,
+          compiler::utils::eMuxBuiltinMemBarrier}) {
+      names.insert(compiler::utils::BuiltinInfo::getMuxBuiltinName(id));
+    }
+    return names;
+  }();
+
+  // The kernel's module only contains the kernel and the functions it calls,
+  // none of which may synchronize work-items or use local memory.
+  for (auto &F : *function.getParent()) {
+    for (auto &BB : F) {
+      for (auto &I : BB) {
+        auto *call = llvm::dyn_cast<llvm::CallBase>(&I);
+        if (!call) {
+          continue;
+        }
+        auto *callee = call->getCalledFunction();
+        if (!callee) {
+          return false;
+        }
+        if (callee->getName().starts_with("__mux_") &&
+            !allowed_builtins.count(callee->getName().str())) {
+          return false;
+        }
+      }
+    }
+  }
+  for (auto &GV : function.getParent()->globals()) {
+    if (GV.getAddressSpace() == compiler::utils::AddressSpace::Local) {
+      return false;
+    }
+  }
+
+  for (auto &arg : function.args()) {
+    accesses.push_back(arg.getType()->isPointerTy() ? analyzeFusionArg(arg)
+                                                    : FusionArgAccess{});
+  }
+  return true;
+}
+
+/// @brief Prepares a clone of a kernel's module to be linked into a fused
+/// kernel's module, so that its symbols don't clash with other kernels.
+///
+/// @param module Clone of the kernel's module.
+/// @param kernel_name Name of the kernel.
+/// @param part_name New name of the kernel.
+///
+/// @return Returns the kernel function.
+llvm::Function *prepareFusionPart(llvm::Module &module,
+                                  const std::string &kernel_name,
+                                  const std::string &part_name) {
+  auto *kernel = module.getFunction(kernel_name);
+  if (!kernel) {
+    return nullptr;
+  }
+  for (auto &GO : module.global_objects()) {
+    if (!GO.isDeclaration()) {
+      GO.setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+  }
+  // The kernel keeps external linkage so we can find it after linking.
+  kernel->setLinkage(llvm::GlobalValue::ExternalLinkage);
+  kernel->setName(part_name);
+  return kernel;
+}
+}  // namespace
+
+cargo::expected<std::unique_ptr<compiler::Kernel>, compiler::Result>
+HostKernel::createFusedKernel(
+    cargo::array_view<compiler::Kernel *const> kernels,
+    cargo::array_view<const uint64_t> buffers) {
+  // Kernels from the same target are all host kernels.
+  llvm::SmallVector<HostKernel *, 4> chain{this};
+  for (auto *kernel : kernels) {
+    chain.push_back(static_cast<HostKernel *>(kernel));
+  }
+  if (chain.size() < 2) {
+    return cargo::make_unexpected(compiler::Result::INVALID_VALUE);
+  }
+  for (auto *kernel : chain) {
+    if (kernel->local_memory_size != 0) {
+      return cargo::make_unexpected(compiler::Result::FEATURE_UNSUPPORTED);
+    }
+  }
+
+  return target.withLLVMContextDo(
+      [&](llvm::LLVMContext &C)
+          -> cargo::expected<std::unique_ptr<compiler::Kernel>,
+                             compiler::Result> {
+        llvm::SmallVector<FusionArgAccess, 16> accesses;
+        llvm::SmallVector<size_t, 4> first_arg;
+        for (auto *kernel : chain) {
+          auto *function = kernel->module->getFunction(kernel->name);
+          first_arg.push_back(accesses.size());
+          if (!function || !analyzeFusionKernel(*function, accesses)) {
+            return cargo::make_unexpected(
+                compiler::Result::FEATURE_UNSUPPORTED);
+          }
+        }
+        if (buffers.size() != accesses.size()) {
+          return cargo::make_unexpected(compiler::Result::INVALID_VALUE);
+        }
+        first_arg.push_back(accesses.size());
+
+        // A buffer written by one kernel and accessed by another must only be
+        // accessed by each work-item at its own element, then every work-item
+        // only depends on memory earlier kernels wrote in the same work-item.
+        struct BufferUse {
+          size_t kernel;
+          bool shared;
+          bool writes;
+          bool elementwise;
+          uint64_t stride;
+        };
+        std::unordered_map<uint64_t, BufferUse> uses;
+        for (size_t k = 0; k < chain.size(); k++) {
+          for (size_t i = first_arg[k]; i < first_arg[k + 1]; i++) {
+            const auto &access = accesses[i];
+            if (0 == buffers[i] || (!access.reads && !access.writes)) {
+              continue;
+            }
+            auto [use, inserted] = uses.insert(
+                {buffers[i], {k, false, access.writes, access.elementwise,
+                              access.stride}});
+            if (inserted) {
+              continue;
+            }
+            auto &existing = use->second;
+            existing.shared |= existing.kernel != k;
+            existing.writes |= access.writes;
+            existing.elementwise &=
+                access.elementwise && access.stride == existing.stride;
+          }
+        }
+        for (const auto &use : uses) {
+          if (use.second.shared && use.second.writes &&
+              !use.second.elementwise) {
+            return cargo::make_unexpected(
+                compiler::Result::FEATURE_UNSUPPORTED);
+          }
+        }
+
+        // Link the kernels into one module, then call each of them in turn
+        // from the fused kernel and inline them.
+        std::unique_ptr<llvm::Module> fused_module;
+        llvm::SmallVector<std::string, 4> part_names;
+        for (size_t k = 0; k < chain.size(); k++) {
+          std::unique_ptr<llvm::Module> part(
+              llvm::CloneModule(*chain[k]->module));
+          part_names.push_back("__ca_fused_part." + std::to_string(k));
+          if (!part ||
+              !prepareFusionPart(*part, chain[k]->name, part_names.back())) {
+            return cargo::make_unexpected(
+                compiler::Result::FINALIZE_PROGRAM_FAILURE);
+          }
+          if (!fused_module) {
+            fused_module = std::move(part);
+          } else if (llvm::Linker::linkModules(*fused_module,
+                                               std::move(part))) {
+            // E.g. the kernels were built with conflicting module flags.
+            return cargo::make_unexpected(
+                compiler::Result::FEATURE_UNSUPPORTED);
+          }
+        }
+
+        llvm::SmallVector<llvm::Function *, 4> parts;
+        llvm::SmallVector<llvm::Type *, 16> params;
+        for (const auto &part_name : part_names) {
+          auto *part = fused_module->getFunction(part_name);
+          parts.push_back(part);
+          params.append(part->getFunctionType()->param_begin(),
+                        part->getFunctionType()->param_end());
+        }
+
+        const std::string fused_name = "__ca_fused_" + name;
+        auto *fused = llvm::Function::Create(
+            llvm::FunctionType::get(llvm::Type::getVoidTy(C), params, false),
+            llvm::GlobalValue::ExternalLinkage, fused_name, *fused_module);
+        // The first kernel's attributes also cover its own parameters.
+        fused->copyAttributesFrom(parts.front());
+        for (size_t k = 0; k < parts.size(); k++) {
+          for (auto &arg : parts[k]->args()) {
+            auto *fused_arg = fused->getArg(first_arg[k] + arg.getArgNo());
+            if (k != 0) {
+              llvm::AttrBuilder attrs(
+                  C, parts[k]->getAttributes().getParamAttrs(arg.getArgNo()));
+              fused_arg->addAttrs(attrs);
+            }
+            // Arguments of different kernels may be bound to the same buffer.
+            fused_arg->removeAttr(llvm::Attribute::NoAlias);
+          }
+        }
+        compiler::utils::setIsKernelEntryPt(*fused);
+        compiler::utils::setOrigFnName(*fused);
+
+        llvm::IRBuilder<> B(llvm::BasicBlock::Create(C, "entry", fused));
+        llvm::SmallVector<llvm::CallInst *, 4> calls;
+        for (size_t k = 0; k < parts.size(); k++) {
+          auto *part = parts[k];
+          compiler::utils::dropIsKernel(*part);
+          part->setCallingConv(llvm::CallingConv::SPIR_FUNC);
+          part->setLinkage(llvm::GlobalValue::InternalLinkage);
+          llvm::SmallVector<llvm::Value *, 8> args;
+          for (size_t i = first_arg[k]; i < first_arg[k + 1]; i++) {
+            args.push_back(fused->getArg(i));
+          }
+          auto *call = B.CreateCall(part, args);
+          call->setCallingConv(part->getCallingConv());
+          calls.push_back(call);
+        }
+        B.CreateRetVoid();
+
+        for (auto *call : calls) {
+          llvm::InlineFunctionInfo info;
+          if (!llvm::InlineFunction(*call, info).isSuccess()) {
+            return cargo::make_unexpected(
+                compiler::Result::FINALIZE_PROGRAM_FAILURE);
+          }
+        }
+        for (auto *part : parts) {
+          if (part->use_empty()) {
+            part->eraseFromParent();
+          }
+        }
+
+        return std::unique_ptr<compiler::Kernel>(new HostKernel(
+            target, build_options, telemetry, fused_module.release(),
+            fused_name,
+            {preferred_local_size_x, preferred_local_size_y,
+             preferred_local_size_z},
+            0));
+      });
+}
+
 cargo::expected<const OptimizedKernel &, compiler::Result>
 HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
   if (0 < optimized_kernel_map.count(local_size)) {
@@ -252,6 +610,7 @@ HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
             target.getContext().isLLVMTimePassesEnabled());
         pass_mach.setCompilerOptions(build_options);
         host::initializePassMachineryForFinalize(pass_mach, target);
+        telemetry.registerCallbacks(pass_mach.getPIC());
 
         llvm::ModulePassManager pm;
         // Set up the kernel metadata which informs later passes which kernel
@@ -274,8 +633,11 @@ HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
               compiler::utils::getLLVMGlobalMutex());
           llvm::CrashRecoveryContext CRC;
           llvm::CrashRecoveryContext::Enable();
-          const bool crashed = !CRC.RunSafely(
-              [&] { pm.run(*optimized_module, pass_mach.getMAM()); });
+          const bool crashed = !CRC.RunSafely([&] {
+            const compiler::BuildTelemetry::Phase phase(telemetry,
+                                                        "jit-kernel-passes");
+            pm.run(*optimized_module, pass_mach.getMAM());
+          });
           llvm::CrashRecoveryContext::Disable();
           if (crashed) {
             return cargo::make_unexpected(
@@ -413,6 +775,9 @@ HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
             llvm::CrashRecoveryContext crc;
             llvm::CrashRecoveryContext::Enable();
             crashed = !crc.RunSafely([&] {
+              // The JIT compiles and links the module when it's looked up.
+              const compiler::BuildTelemetry::Phase phase(telemetry,
+                                                          "jit-codegen-link");
               es.lookup(llvm::orc::LookupKind::Static, std::move(so),
                         std::move(names), llvm::orc::SymbolState::Ready,
                         std::move(notifyComplete),
@@ -34,8 +34,10 @@
 #include <compiler/utils/llvm_global_mutex.h>
 #include <compiler/utils/metadata.h>
 #include <compiler/utils/metadata_analysis.h>
+#include <compiler/utils/metadata_hooks.h>
 #include <compiler/utils/pass_machinery.h>
 #include <compiler/utils/reduce_to_function_pass.h>
+#include <host/add_local_size_variants_pass.h>
 #include <host/compiler_kernel.h>
 #include <host/device.h>
 #include <host/host_mux_builtin_info.h>
@@ -71,8 +73,10 @@
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/Utils/Cloning.h>
+#include <loader/image.h>
 #include <multi_llvm/multi_llvm.h>
 
+#include <array>
 #include <cassert>
 #include <cstdlib>
 #include <fstream>
@@ -81,6 +85,7 @@
 #include <mutex>
 #include <sstream>
 #include <unordered_set>
+#include <vector>
 
 #if defined(_MSC_VER) || defined(__MINGW32__) || defined(__MINGW64__)
 #define PATH_SEPARATOR "\\"
@@ -129,10 +134,50 @@ emitBinary(llvm::Module *module, llvm::TargetMachine *target_machine) {
   return {std::move(binary)};
 }
 
+/// @brief Returns whether binaries should be prelinked into images which load
+/// without being relocated, see `loader::createImage`.
+///
+/// Enabled by setting the `CA_HOST_PRELINK_BINARIES` environment variable to a
+/// non-zero value.
+static bool prelinkBinaries() {
+  static const bool enabled = [] {
+    const char *env = std::getenv("CA_HOST_PRELINK_BINARIES");
+    return nullptr != env && 0 != std::atoi(env);
+  }();
+  return enabled;
+}
+
+/// @brief Prelinks a position independent object into an image.
+///
+/// @return Returns the image, or an empty array if the object can't be
+/// prelinked.
+static cargo::dynamic_array<uint8_t> prelinkObject(
+    const cargo::dynamic_array<uint8_t> &object) {
+  // The ELF reader requires its data to be 8-byte aligned.
+  std::vector<uint64_t> aligned((object.size() / sizeof(uint64_t)) + 1);
+  std::copy(object.begin(), object.end(),
+            reinterpret_cast<uint8_t *>(aligned.data()));
+  const cargo::array_view<uint8_t> bytes{
+      reinterpret_cast<uint8_t *>(aligned.data()), object.size()};
+  cargo::dynamic_array<uint8_t> image;
+  if (!loader::ElfFile::isValidElf(bytes)) {
+    return image;
+  }
+  loader::ElfFile file{bytes};
+  auto imageOrError =
+      loader::createImage(file, compiler::utils::MD_NOTES_SECTION);
+  if (!imageOrError.has_value() || image.alloc(imageOrError->size())) {
+    return image;
+  }
+  std::copy(imageOrError->begin(), imageOrError->end(), image.begin());
+  return image;
+}
+
 cargo::expected<cargo::dynamic_array<uint8_t>, compiler::Result>
 HostModule::hostCompileObject(HostTarget &target,
                               const compiler::Options &build_options,
-                              llvm::Module *module) {
+                              llvm::Module *module,
+                              llvm::TargetMachine *target_machine) {
   llvm::LLVMContext &C = module->getContext();
   std::unique_ptr<llvm::Module> cloned_module(llvm::CloneModule(*module));
 
@@ -148,10 +193,23 @@ HostModule::hostCompileObject(HostTarget &target,
 
   host_pass_mach.setCompilerOptions(build_options);
   initializePassMachineryForFinalize(host_pass_mach);
+  telemetry.registerCallbacks(host_pass_mach.getPIC());
 
   llvm::ModulePassManager pm;
   pm.addPass(compiler::utils::TransferKernelMetadataPass());
 
+  // Binaries can't be specialized at runtime, so the local sizes the kernels
+  // would have been precached for are compiled into them instead.
+  if (!build_options.precache_local_sizes.empty()) {
+    std::vector<std::array<uint64_t, 3>> local_sizes;
+    for (const auto &size : build_options.precache_local_sizes) {
+      local_sizes.push_back({static_cast<uint64_t>(size[0]),
+                             static_cast<uint64_t>(size[1]),
+                             static_cast<uint64_t>(size[2])});
+    }
+    pm.addPass(AddLocalSizeVariantsPass(std::move(local_sizes)));
+  }
+
   pm.addPass(host_pass_mach.getKernelFinalizationPasses());
   {
     // Using the CrashRecoveryContext and statistics touches LLVM's global
@@ -160,8 +218,10 @@ HostModule::hostCompileObject(HostTarget &target,
 
     llvm::CrashRecoveryContext CRC;
     llvm::CrashRecoveryContext::Enable();
-    const bool crashed = !CRC.RunSafely(
-        [&] { pm.run(*cloned_module, host_pass_mach.getMAM()); });
+    const bool crashed = !CRC.RunSafely([&] {
+      const compiler::BuildTelemetry::Phase phase(telemetry, "kernel-passes");
+      pm.run(*cloned_module, host_pass_mach.getMAM());
+    });
     llvm::CrashRecoveryContext::Disable();
     if (crashed) {
       return cargo::make_unexpected(compiler::Result::FINALIZE_PROGRAM_FAILURE);
@@ -172,8 +232,10 @@ HostModule::hostCompileObject(HostTarget &target,
     }
   }
 
-  auto binaryOrError =
-      emitBinary(cloned_module.get(), target.target_machine.get());
+  const compiler::BuildTelemetry::Phase phase(telemetry, "codegen");
+  auto binaryOrError = emitBinary(
+      cloned_module.get(),
+      target_machine ? target_machine : target.target_machine.get());
 
   if (!binaryOrError.has_value()) {
     return cargo::make_unexpected(binaryOrError.error());
@@ -196,6 +258,32 @@ compiler::Result HostModule::createBinary(
     llvm::SmallVector<char, 1024> object_code_buffer;
     const llvm::raw_svector_ostream stream(object_code_buffer);
 
+    // Code which can't be prelinked, e.g. because it reads a global variable
+    // through the GOT, is compiled again as a relocatable object below.
+    if (prelinkBinaries() && host_target.image_target_machine) {
+      const std::unique_ptr<llvm::Module> imageModule =
+          llvm::CloneModule(*finalized_llvm_module.get());
+      // Nothing outside of the image can preempt its symbols, so they're
+      // addressed directly rather than through the GOT.
+      for (auto &global : imageModule->global_values()) {
+        if (!global.isDeclaration()) {
+          global.setDSOLocal(true);
+        }
+      }
+      auto imageObjectOrError =
+          hostCompileObject(host_target, options, imageModule.get(),
+                            host_target.image_target_machine.get());
+      if (imageObjectOrError.has_value()) {
+        const compiler::BuildTelemetry::Phase phase(telemetry, "prelink");
+        auto image = prelinkObject(imageObjectOrError.value());
+        if (!image.empty()) {
+          object_code = std::move(image);
+          buffer = cargo::array_view<std::uint8_t>(object_code);
+          return compiler::Result::SUCCESS;
+        }
+      }
+    }
+
     auto binaryOrError =
         hostCompileObject(host_target, options, clonedModule.get());
     if (!binaryOrError.has_value()) {
@@ -268,8 +356,8 @@ std::shared_ptr<compiler::Kernel> HostModule::createKernel(
 
   assert(kernel_md.local_memory_usage <= SIZE_MAX);
   auto kernel = std::make_shared<HostKernel>(
-      static_cast<HostTarget &>(target), getOptions(), kernel_module.release(),
-      kernel_md.kernel_name, local_sizes,
+      static_cast<HostTarget &>(target), getOptions(), telemetry,
+      kernel_module.release(), kernel_md.kernel_name, local_sizes,
       static_cast<size_t>(kernel_md.local_memory_usage));
   return kernel;
 }
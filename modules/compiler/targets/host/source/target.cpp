@@ -48,10 +48,11 @@
 
 namespace host {
 
-// Create a target machine, `abi` is optional and may be empty
-static llvm::TargetMachine *createTargetMachine(llvm::Triple TT,
-                                                llvm::StringRef CPU,
-                                                llvm::StringRef Features) {
+// Create a target machine, `abi` is optional and may be empty. Position
+// independent target machines compile code for prelinked images.
+static llvm::TargetMachine *createTargetMachine(
+    llvm::Triple TT, llvm::StringRef CPU, llvm::StringRef Features,
+    bool position_independent = false) {
   // Init the llvm target machine.
   std::string Error;
 #if LLVM_VERSION_GREATER_EQUAL(21, 0)
@@ -88,10 +89,19 @@ static llvm::TargetMachine *createTargetMachine(llvm::Triple TT,
   // models for the architecture.
   // TODO: Investigate whether we can use a loader that does not have this
   // issue.
+  std::optional<llvm::Reloc::Model> RM;
+  bool JIT = true;
+  if (position_independent) {
+    // Prelinked images keep their sections together, so the small code model
+    // reaches everything and the code needn't be relocated when it's loaded.
+    RM = llvm::Reloc::PIC_;
+    CM = llvm::CodeModel::Small;
+    JIT = false;
+  }
   const llvm::TargetOptions Options;
-  return LLVMTarget->createTargetMachine(
-      triple, CPU, Features, Options, /*RM=*/std::nullopt, CM,
-      llvm::CodeGenOptLevel::Aggressive, /*JIT=*/true);
+  return LLVMTarget->createTargetMachine(triple, CPU, Features, Options, RM, CM,
+                                         llvm::CodeGenOptLevel::Aggressive,
+                                         JIT);
 }
 
 HostTarget::HostTarget(const HostInfo *compiler_info,
@@ -429,6 +439,13 @@ compiler::Result HostTarget::initWithBuiltins(
         createTargetMachine(triple, CPU, Features.getString()));
   }
 
+  // The loader can only prelink x86_64 and AArch64 code.
+  if (triple.getArch() == llvm::Triple::x86_64 ||
+      triple.getArch() == llvm::Triple::aarch64) {
+    image_target_machine.reset(createTargetMachine(
+        triple, CPU, Features.getString(), /*position_independent=*/true));
+  }
+
   return compiler::Result::SUCCESS;
 }
 
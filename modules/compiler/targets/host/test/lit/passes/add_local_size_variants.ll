@@ -0,0 +1,53 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; RUN: muxc --device "%default_device" --passes "add-local-size-variants<64:1:1;8:8:1>,verify" -S %s \
+; RUN:   | FileCheck %s
+
+target triple = "spir64-unknown-unknown"
+target datalayout = "e-p:64:64:64-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; Check the original kernel is left alone, other than recording its name.
+; CHECK: define spir_kernel void @foo(ptr addrspace(1) %out) [[FOO_ATTRS:#[0-9]+]] {
+
+; Check a kernel with a required work-group size isn't copied.
+; CHECK: define spir_kernel void @bar(ptr addrspace(1) %out) [[BAR_ATTRS:#[0-9]+]] !reqd_work_group_size [[BAR_WGS:\![0-9]+]] {
+; CHECK-NOT: @bar.mux-local-size
+
+; Check a copy of the kernel is made for each local size.
+; CHECK: define spir_kernel void @foo.mux-local-size.64.1.1(ptr addrspace(1) %out) [[FOO_ATTRS]] !reqd_work_group_size [[WGS0:\![0-9]+]] {
+; CHECK: store i32 1, ptr addrspace(1) %out, align 4
+; CHECK: define spir_kernel void @foo.mux-local-size.8.8.1(ptr addrspace(1) %out) [[FOO_ATTRS]] !reqd_work_group_size [[WGS1:\![0-9]+]] {
+; CHECK: store i32 1, ptr addrspace(1) %out, align 4
+
+; CHECK-DAG: attributes [[FOO_ATTRS]] = { "mux-kernel"="entry-point" "mux-orig-fn"="foo" }
+; CHECK-DAG: [[WGS0]] = !{i32 64, i32 1, i32 1}
+; CHECK-DAG: [[WGS1]] = !{i32 8, i32 8, i32 1}
+
+define spir_kernel void @foo(ptr addrspace(1) %out) #0 {
+  store i32 1, ptr addrspace(1) %out, align 4
+  ret void
+}
+
+define spir_kernel void @bar(ptr addrspace(1) %out) #1 !reqd_work_group_size !0 {
+  store i32 2, ptr addrspace(1) %out, align 4
+  ret void
+}
+
+attributes #0 = { "mux-kernel"="entry-point" }
+attributes #1 = { "mux-kernel"="entry-point" "mux-orig-fn"="bar" }
+
+!0 = !{i32 16, i32 1, i32 1}
@@ -0,0 +1,69 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; RUN: muxc --device "%default_device" --passes local-memory-arena,verify -S %s  | FileCheck %s
+
+target triple = "spir64-unknown-unknown"
+target datalayout = "e-p:64:64:64-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; Check local memory allocas are carved out of the arena in the schedule info,
+; which is bumped past them for the call and restored before returning.
+; CHECK: define void @foo(ptr %wi-info, ptr %sched-info, ptr %wg-info)
+; CHECK: [[ARENA_PTR:%.*]] = getelementptr inbounds %Mux_schedule_info_s, ptr %sched-info, i32 0, i32 6
+; CHECK: [[START:%.*]] = load ptr, ptr [[ARENA_PTR]], align 8
+; CHECK-NOT: alloca
+; CHECK: [[ARENA0:%.*]] = load ptr, ptr [[ARENA_PTR]], align 8
+; CHECK: [[ADDR0:%.*]] = ptrtoint ptr [[ARENA0]] to i64
+; CHECK: [[NEG0:%.*]] = sub i64 0, [[ADDR0]]
+; CHECK: [[PAD0:%.*]] = and i64 [[NEG0]], 127
+; CHECK: %buffer = getelementptr i8, ptr [[ARENA0]], i64 [[PAD0]]
+; CHECK: [[END0:%.*]] = getelementptr i8, ptr %buffer, i64 256
+; CHECK: store ptr [[END0]], ptr [[ARENA_PTR]], align 8
+; CHECK: [[ARENA1:%.*]] = load ptr, ptr [[ARENA_PTR]], align 8
+; CHECK: [[ADDR1:%.*]] = ptrtoint ptr [[ARENA1]] to i64
+; CHECK: [[NEG1:%.*]] = sub i64 0, [[ADDR1]]
+; CHECK: [[PAD1:%.*]] = and i64 [[NEG1]], 15
+; CHECK: %vars = getelementptr i8, ptr [[ARENA1]], i64 [[PAD1]]
+; CHECK: [[END1:%.*]] = getelementptr i8, ptr %vars, i64 32
+; CHECK: store ptr [[END1]], ptr [[ARENA_PTR]], align 8
+; CHECK-NOT: alloca
+; CHECK: call void @bar(ptr %buffer, ptr %vars, ptr %wi-info, ptr %sched-info, ptr %wg-info)
+; CHECK: store ptr [[START]], ptr [[ARENA_PTR]], align 8
+; CHECK-NEXT: ret void
+define void @foo(ptr %wi-info, ptr %sched-info, ptr %wg-info) !mux_scheduled_fn !1 {
+  %buffer = alloca i8, i64 256, align 128, !mux_local_memory !2
+  %vars = alloca { [4 x i32], [4 x float] }, align 16, !mux_local_memory !2
+  call void @bar(ptr %buffer, ptr %vars, ptr %wi-info, ptr %sched-info, ptr %wg-info)
+  ret void
+}
+
+; Check allocas which aren't local memory are left alone.
+; CHECK: define void @bar(ptr %buffer, ptr %vars, ptr %wi-info, ptr %sched-info, ptr %wg-info)
+; CHECK: %private = alloca i32, align 4
+; CHECK-NOT: %Mux_schedule_info_s
+; CHECK: ret void
+define void @bar(ptr %buffer, ptr %vars, ptr %wi-info, ptr %sched-info, ptr %wg-info) !mux_scheduled_fn !3 {
+  %private = alloca i32, align 4
+  store i32 0, ptr %private, align 4
+  ret void
+}
+
+!mux-scheduling-params = !{!0}
+
+!0 = !{!"MuxWorkItemInfo", !"Mux_schedule_info_s", !"MiniWGInfo"}
+!1 = !{i32 0, i32 1, i32 2}
+!2 = !{}
+!3 = !{i32 2, i32 3, i32 4}
@@ -17,6 +17,8 @@
 ; RUN: muxc --device "%default_device" --passes "print<vecz-pass-opts>" -S %s 2>&1 | FileCheck %s
 ; RUN: env CODEPLAY_VECZ_CHOICES=LinearizeBOSCC,FullScalarization muxc --device "%default_device" \
 ; RUN:   --passes "print<vecz-pass-opts>" -S %s 2>&1 | FileCheck %s --check-prefix CHOICES
+; RUN: env CA_HOST_VP_TAIL=1 muxc --device "%default_device" \
+; RUN:   --passes "print<vecz-pass-opts>" -S %s 2>&1 | FileCheck %s --check-prefix VPTAIL
 
 target triple = "spir64-unknown-unknown"
 target datalayout = "e-p:64:64:64-m:e-i64:64-f80:128-n8:16:32:64-S128"
@@ -45,6 +47,16 @@ define spir_kernel void @bar(i32 addrspace(1)* %in) #0 !reqd_work_group_size !1
 ; CHECK:     DivisionExceptions
 ; CHECK:   ]
 ; CHECK: }
+
+; The remainder of 4 work-items is run as a vector-predicated iteration.
+; VPTAIL: Function 'baz' will be vectorized {
+; VPTAIL-NEXT:   VF = 8, (auto), vec-dim = 0, local-size = 12, choices = [
+; VPTAIL-NEXT:     DivisionExceptions
+; VPTAIL-NEXT:   ]
+; VPTAIL-NEXT:   VF = 8, (auto), vec-dim = 0, local-size = 12, choices = [
+; VPTAIL-NEXT:     DivisionExceptions,VectorPredication
+; VPTAIL-NEXT:   ]
+; VPTAIL-NEXT: }
 define spir_kernel void @baz(i32 addrspace(1)* %in) #0 !reqd_work_group_size !2 {
   %gid = call i64 @__mux_get_global_id(i32 0)
   ret void
@@ -16,6 +16,8 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <string>
+#include <vector>
 
 #include "common.h"
 
@@ -345,6 +347,160 @@ TEST_P(CreateSpecializedKernelTest,
 INSTANTIATE_DEFERRABLE_COMPILER_TARGET_TEST_SUITE_P(
     CreateSpecializedKernelTest);
 
+/// @brief Test fixture for testing behaviour of the
+/// compiler::Kernel::createFusedKernel API.
+struct CreateFusedKernelTest : CompilerKernelTest {
+  void SetUp() override {
+    RETURN_ON_SKIP_OR_FATAL_FAILURE(CompilerKernelTest::SetUp());
+    // Targets needn't support fusion at all.
+    if (compiler::Result::FEATURE_UNSUPPORTED ==
+        fuse("add_one", "twice", {1, 2, 2, 3})) {
+      GTEST_SKIP();
+    }
+  }
+
+  cargo::string_view KernelSource() override {
+    return R"(
+kernel void nop() {}
+
+kernel void add_one(global const int *in, global int *out) {
+  size_t id = get_global_id(0);
+  out[id] = in[id] + 1;
+}
+
+kernel void twice(global const int *in, global int *out) {
+  size_t id = get_global_id(0);
+  out[id] = in[id] * 2;
+}
+
+kernel void next(global const int *in, global int *out) {
+  size_t id = get_global_id(0);
+  out[id] = in[id + 1];
+}
+
+kernel void narrow(global const short *in, global int *out) {
+  size_t id = get_global_id(0);
+  out[id] = in[id];
+}
+
+kernel void increment(global int *inout, global int *out) {
+  size_t id = get_global_id(0);
+  out[id] = atomic_inc(&inout[id]);
+}
+
+kernel void with_barrier(global const int *in, global int *out) {
+  size_t id = get_global_id(0);
+  int value = in[id];
+  barrier(CLK_GLOBAL_MEM_FENCE);
+  out[id] = value;
+}
+
+kernel void with_local(global const int *in, global int *out) {
+  local int tmp[8];
+  size_t id = get_global_id(0);
+  tmp[get_local_id(0) % 8] = in[id];
+  out[id] = tmp[get_local_id(0) % 8];
+}
+)";
+  }
+
+  /// @brief Fuses two kernels, with the buffers bound to their arguments.
+  compiler::Result fuse(const std::string &first, const std::string &second,
+                        std::vector<uint64_t> buffers) {
+    auto first_kernel = module->getKernel(first);
+    auto second_kernel = module->getKernel(second);
+    if (!first_kernel || !second_kernel) {
+      return compiler::Result::INVALID_VALUE;
+    }
+    compiler::Kernel *const kernels[] = {second_kernel.get()};
+    auto fused = first_kernel->createFusedKernel(kernels, buffers);
+    if (!fused) {
+      return fused.error();
+    }
+    return *fused ? compiler::Result::SUCCESS
+                  : compiler::Result::FINALIZE_PROGRAM_FAILURE;
+  }
+};
+
+TEST_P(CreateFusedKernelTest, Elementwise) {
+  // The second kernel only reads the element of the first kernel's output
+  // which the same work-item wrote.
+  auto add_one = module->getKernel("add_one");
+  auto twice = module->getKernel("twice");
+  ASSERT_NE(nullptr, add_one);
+  ASSERT_NE(nullptr, twice);
+  compiler::Kernel *const kernels[] = {twice.get()};
+  const uint64_t buffers[] = {1, 2, 2, 3};
+  auto fused = add_one->createFusedKernel(kernels, buffers);
+  ASSERT_TRUE(fused);
+  ASSERT_NE(nullptr, *fused);
+  auto work_width = (*fused)->getDynamicWorkWidth(1, 1, 1);
+  EXPECT_TRUE(work_width);
+
+  // Kernels which share a buffer they only read are always fusable.
+  EXPECT_EQ(compiler::Result::SUCCESS, fuse("next", "twice", {1, 2, 1, 3}));
+  // As are kernels which don't share any buffers, and kernels with arguments
+  // which aren't bound to buffers.
+  EXPECT_EQ(compiler::Result::SUCCESS, fuse("add_one", "next", {1, 2, 3, 4}));
+  EXPECT_EQ(compiler::Result::SUCCESS, fuse("add_one", "next", {0, 0, 0, 0}));
+}
+
+TEST_P(CreateFusedKernelTest, NotElementwise) {
+  // Work-items read an element another work-item wrote.
+  EXPECT_EQ(compiler::Result::FEATURE_UNSUPPORTED,
+            fuse("add_one", "next", {1, 2, 2, 3}));
+  // Work-items write an element another work-item read.
+  EXPECT_EQ(compiler::Result::FEATURE_UNSUPPORTED,
+            fuse("next", "add_one", {1, 2, 3, 1}));
+}
+
+TEST_P(CreateFusedKernelTest, DifferentElementSizes) {
+  // Work-items read part of another work-item's element.
+  EXPECT_EQ(compiler::Result::FEATURE_UNSUPPORTED,
+            fuse("add_one", "narrow", {1, 2, 2, 3}));
+}
+
+TEST_P(CreateFusedKernelTest, EscapingPointer) {
+  // The atomic's accesses can't be analyzed, so the buffer is treated as
+  // accessed anywhere.
+  EXPECT_EQ(compiler::Result::FEATURE_UNSUPPORTED,
+            fuse("add_one", "increment", {1, 2, 2, 3}));
+  EXPECT_EQ(compiler::Result::SUCCESS,
+            fuse("add_one", "increment", {1, 2, 3, 4}));
+}
+
+TEST_P(CreateFusedKernelTest, Barrier) {
+  // Kernels which synchronize work-items are never fused, even if they share
+  // no buffers.
+  EXPECT_EQ(compiler::Result::FEATURE_UNSUPPORTED,
+            fuse("add_one", "with_barrier", {1, 2, 3, 4}));
+  EXPECT_EQ(compiler::Result::FEATURE_UNSUPPORTED,
+            fuse("with_barrier", "add_one", {1, 2, 3, 4}));
+}
+
+TEST_P(CreateFusedKernelTest, LocalMemory) {
+  EXPECT_EQ(compiler::Result::FEATURE_UNSUPPORTED,
+            fuse("add_one", "with_local", {1, 2, 3, 4}));
+}
+
+TEST_P(CreateFusedKernelTest, InvalidBuffers) {
+  EXPECT_EQ(compiler::Result::INVALID_VALUE,
+            fuse("add_one", "twice", {1, 2, 2}));
+  EXPECT_EQ(compiler::Result::INVALID_VALUE,
+            fuse("add_one", "twice", {1, 2, 2, 3, 4}));
+}
+
+TEST_P(CreateFusedKernelTest, InvalidKernels) {
+  auto add_one = module->getKernel("add_one");
+  ASSERT_NE(nullptr, add_one);
+  const uint64_t buffers[] = {1, 2};
+  auto fused = add_one->createFusedKernel({}, buffers);
+  ASSERT_FALSE(fused);
+  EXPECT_EQ(compiler::Result::INVALID_VALUE, fused.error());
+}
+
+INSTANTIATE_DEFERRABLE_COMPILER_TARGET_TEST_SUITE_P(CreateFusedKernelTest);
+
 struct SubGroupUnsupportedTest : CompilerKernelTest {
   void SetUp() override {
     RETURN_ON_SKIP_OR_FATAL_FAILURE(CompilerKernelTest::SetUp());
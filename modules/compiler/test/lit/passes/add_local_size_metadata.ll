@@ -0,0 +1,35 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; RUN: muxc %s --passes add-local-size-metadata,verify -S | FileCheck %s
+
+target datalayout = "e-m:e-p:64:64-i64:64-i128:128-n64-S128"
+target triple = "riscv64-unknown-unknown-elf"
+
+; CHECK: @notes_global = constant [{{[0-9]+}} x i8] c"{{.*}}LocalSizeMetadata{{.*}}", section "notes", align 1
+
+define void @add() #0 {
+  ret void
+}
+
+define void @add.variant() #1 !reqd_work_group_size !0 {
+  ret void
+}
+
+attributes #0 = { "mux-kernel"="entry-point" }
+attributes #1 = { "mux-kernel"="entry-point" "mux-orig-fn"="add" }
+
+!0 = !{i32 16, i32 1, i32 1}
@@ -19,7 +19,8 @@
 target triple = "spir64-unknown-unknown"
 target datalayout = "e-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024"
 
-; CHECK: %minimal_barrier_live_mem_info = type { {{[^,]+}}, {{[^,]+}}, {{[^,]+}}{{(, \[[0-9]+ x i8\])?}} }
+; %cmp12 is recomputed after the second barrier rather than stored.
+; CHECK: %minimal_barrier_live_mem_info = type { {{[^,]+}}, {{[^,]+}}{{(, \[[0-9]+ x i8\])?}} }
 
 define void @minimal_barrier(i32 %min_0, i32 %min_1, i32 %stride, i32 %n0, i32 %n1, i32 %n2, i32 addrspace(1)* %g, i32 addrspace(3)* align 64 %shared) #0 {
 entry:
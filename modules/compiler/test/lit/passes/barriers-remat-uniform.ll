@@ -0,0 +1,77 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; RUN: muxc --passes work-item-loops,verify -S %s | FileCheck %s
+
+target triple = "spir64-unknown-unknown"
+target datalayout = "e-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024"
+
+; %sum is cheap to recompute from the work-item builtins, so only the loaded
+; value is stored per work-item. %base is the same for every work-item but
+; can't be recomputed, since the udiv might trap, so it is stored once.
+; CHECK-DAG: %remat_live_mem_info = type { i32 }
+; CHECK-DAG: %remat_live_uniform_info = type { i64 }
+
+; CHECK-LABEL: define internal i32 @remat.mux-barrier-region(
+; CHECK-SAME: ptr [[MEM:%.*]], ptr [[UNIFORM:%.*]])
+; CHECK: %uniform_gep_base = getelementptr inbounds %remat_live_uniform_info, ptr [[UNIFORM]], i32 0, i32 0
+; CHECK: %base = mul i64
+; CHECK-NEXT: store i64 %base, ptr %uniform_gep_base
+
+; CHECK-LABEL: define internal i32 @remat.mux-barrier-region.1(
+; CHECK-SAME: ptr [[MEM:%.*]], ptr [[UNIFORM:%.*]])
+; CHECK-DAG: %uniform_gep_base = getelementptr inbounds %remat_live_uniform_info, ptr [[UNIFORM]], i32 0, i32 0
+; CHECK-DAG: %live_gep_val = getelementptr inbounds %remat_live_mem_info, ptr [[MEM]], i32 0, i32 0
+; CHECK-DAG: %gid = {{(tail )?}}call i64 @__mux_get_global_id(i32 0)
+; CHECK-DAG: %lid = {{(tail )?}}call i64 @__mux_get_local_id(i32 0)
+; CHECK-DAG: %sum = add i64 %gid, %lid
+; CHECK-DAG: %base_load = load i64, ptr %uniform_gep_base
+; CHECK-DAG: %val_load = load i32, ptr %live_gep_val
+
+; A single instance of the uniform struct is passed to every work-item.
+; CHECK-LABEL: define void @remat.mux-barrier-wrapper(
+; CHECK: %live_uniforms = alloca %remat_live_uniform_info
+; CHECK: call i32 @remat.mux-barrier-region({{.*}}, ptr %live_uniforms)
+; CHECK: call i32 @remat.mux-barrier-region.1({{.*}}, ptr %live_uniforms)
+
+define void @remat(ptr addrspace(1) %in, ptr addrspace(1) %out, i64 %n, i64 %m) #0 {
+entry:
+  %gid = tail call i64 @__mux_get_global_id(i32 0)
+  %lid = tail call i64 @__mux_get_local_id(i32 0)
+  %grp = tail call i64 @__mux_get_group_id(i32 0)
+  %sum = add i64 %gid, %lid
+  %blocks = udiv i64 %n, %m
+  %base = mul i64 %grp, %blocks
+  %arrayidx = getelementptr inbounds i32, ptr addrspace(1) %in, i64 %gid
+  %val = load i32, ptr addrspace(1) %arrayidx, align 4
+  tail call void @__mux_work_group_barrier(i32 0, i32 1, i32 272)
+  %idx = add i64 %sum, %base
+  %arrayidx2 = getelementptr inbounds i32, ptr addrspace(1) %out, i64 %idx
+  store i32 %val, ptr addrspace(1) %arrayidx2, align 4
+  ret void
+}
+
+declare void @__mux_work_group_barrier(i32, i32, i32)
+
+declare i64 @__mux_get_global_id(i32)
+
+declare i64 @__mux_get_local_id(i32)
+
+declare i64 @__mux_get_group_id(i32)
+
+declare void @__mux_set_local_id(i32, i64)
+
+attributes #0 = { "mux-kernel"="entry-point" }
@@ -0,0 +1,48 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; RUN: muxc %s --passes='print<local-size-metadata>' -S 2>&1 | FileCheck %s
+
+; CHECK: Cached local size metadata analysis:
+; CHECK:      Kernel Name: kernel1
+; CHECK-NEXT: Source Name: kernel1
+; CHECK-NEXT: Local Memory: 0
+; CHECK-NEXT: Sub-group Size: 1
+; CHECK-NEXT: Min Work Width: 1
+; CHECK-NEXT: Preferred Work Width: 1
+; CHECK-NEXT: Local Size: 0,0,0
+
+; CHECK:      Kernel Name: kernel1.variant
+; CHECK-NEXT: Source Name: kernel1
+; CHECK-NEXT: Local Memory: 0
+; CHECK-NEXT: Sub-group Size: 1
+; CHECK-NEXT: Min Work Width: 1
+; CHECK-NEXT: Preferred Work Width: 1
+; CHECK-NEXT: Local Size: 64,2,1
+
+; A kernel which may be executed with any local size
+define void @kernel1() {
+  ret void
+}
+
+; A kernel compiled for a single local size
+define void @kernel1.variant() #0 !reqd_work_group_size !0 {
+  ret void
+}
+
+attributes #0 = { "mux-orig-fn"="kernel1" }
+
+!0 = !{i32 64, i32 2, i32 1}
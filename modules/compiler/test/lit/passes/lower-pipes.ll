@@ -0,0 +1,217 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; Pipe builtins are lowered to calls to internal helpers, which are checked
+; separately as the order they're created in doesn't matter.
+; RUN: muxc --passes lower-to-mux-builtins,verify -S %s | FileCheck %s
+; RUN: muxc --passes lower-to-mux-builtins,verify -S %s \
+; RUN:   | FileCheck %s --check-prefix RESERVE
+; RUN: muxc --passes lower-to-mux-builtins,verify -S %s \
+; RUN:   | FileCheck %s --check-prefix COMMIT
+; RUN: muxc --passes lower-to-mux-builtins,verify -S %s \
+; RUN:   | FileCheck %s --check-prefix PACKET
+; RUN: muxc --passes lower-to-mux-builtins,verify -S %s \
+; RUN:   | FileCheck %s --check-prefix TRANSFER
+
+target triple = "spir64-unknown-unknown"
+target datalayout = "e-p:64:64:64-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; CHECK-LABEL: define spir_kernel void @read_write(
+; CHECK: %r = call i32 @__ca_pipe_read(ptr addrspace(1) %in, ptr addrspace(4) %packet, i32 4)
+; CHECK: %w = call i32 @__ca_pipe_write(ptr addrspace(1) %out, ptr addrspace(4) %packet, i32 4)
+define spir_kernel void @read_write(ptr addrspace(1) %in, ptr addrspace(1) %out,
+                                    ptr addrspace(4) %packet) {
+  %r = call spir_func i32 @__read_pipe_2(ptr addrspace(1) %in, ptr addrspace(4) %packet, i32 4, i32 4)
+  %w = call spir_func i32 @__write_pipe_2(ptr addrspace(1) %out, ptr addrspace(4) %packet, i32 4, i32 4)
+  ret void
+}
+
+; CHECK-LABEL: define spir_kernel void @reserve_commit(
+; CHECK: %rid = call ptr @__ca_pipe_reserve_write(ptr addrspace(1) %out, i32 %n)
+; CHECK: [[VALID:%.*]] = icmp ne ptr %rid, null
+; CHECK: [[EXT:%.*]] = zext i1 [[VALID]] to i32
+; CHECK: store i32 [[EXT]], ptr addrspace(1) %flag
+; CHECK: %w = call i32 @__ca_pipe_write_packet(ptr addrspace(1) %out, ptr %rid, i32 %i, ptr addrspace(4) %packet, i32 8)
+; CHECK: call void @__ca_pipe_commit_write(ptr addrspace(1) %out, ptr %rid)
+; CHECK: %rrid = call ptr @__ca_pipe_reserve_read(ptr addrspace(1) %in, i32 %n)
+; CHECK: %r = call i32 @__ca_pipe_read_packet(ptr addrspace(1) %in, ptr %rrid, i32 %i, ptr addrspace(4) %packet, i32 8)
+; CHECK: call void @__ca_pipe_commit_read(ptr addrspace(1) %in, ptr %rrid)
+define spir_kernel void @reserve_commit(ptr addrspace(1) %in, ptr addrspace(1) %out,
+                                        ptr addrspace(4) %packet, i32 %n, i32 %i,
+                                        ptr addrspace(1) %flag) {
+  %rid = call spir_func ptr @__reserve_write_pipe(ptr addrspace(1) %out, i32 %n, i32 8, i32 8)
+  %valid = call spir_func i32 @_Z19is_valid_reserve_id13ocl_reserveid(ptr %rid)
+  store i32 %valid, ptr addrspace(1) %flag
+  %w = call spir_func i32 @__write_pipe_4(ptr addrspace(1) %out, ptr %rid, i32 %i, ptr addrspace(4) %packet, i32 8, i32 8)
+  call spir_func void @__commit_write_pipe(ptr addrspace(1) %out, ptr %rid, i32 8, i32 8)
+  %rrid = call spir_func ptr @__reserve_read_pipe(ptr addrspace(1) %in, i32 %n, i32 8, i32 8)
+  %r = call spir_func i32 @__read_pipe_4(ptr addrspace(1) %in, ptr %rrid, i32 %i, ptr addrspace(4) %packet, i32 8, i32 8)
+  call spir_func void @__commit_read_pipe(ptr addrspace(1) %in, ptr %rrid, i32 8, i32 8)
+  ret void
+}
+
+; The number of packets is the packets writers committed which readers haven't
+; reserved yet.
+; CHECK-LABEL: define spir_kernel void @query(
+; CHECK: [[WC:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %p, i64 128
+; CHECK: [[WRITTEN:%.*]] = load atomic i32, ptr addrspace(1) [[WC]] monotonic, align 4
+; CHECK: [[RR:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %p, i64 192
+; CHECK: [[READ:%.*]] = load atomic i32, ptr addrspace(1) [[RR]] monotonic, align 4
+; CHECK: %num.packets = sub i32 [[WRITTEN]], [[READ]]
+; CHECK: [[MAX:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %p, i64 8
+; CHECK: %max.packets = load i32, ptr addrspace(1) [[MAX]], align 4
+; CHECK: %sum = add i32 %num.packets, %max.packets
+define spir_kernel void @query(ptr addrspace(1) %p, ptr addrspace(1) %result) {
+  %num = call spir_func i32 @__get_pipe_num_packets_ro(ptr addrspace(1) %p, i32 4, i32 4)
+  %max = call spir_func i32 @__get_pipe_max_packets_wo(ptr addrspace(1) %p, i32 4, i32 4)
+  %sum = add i32 %num, %max
+  store i32 %sum, ptr addrspace(1) %result
+  ret void
+}
+
+; Only the first work-item of the work-group reserves and commits, on behalf of
+; the whole group.
+; CHECK-LABEL: define spir_kernel void @work_group(
+; CHECK: %local.id = call i64 @__mux_get_local_linear_id()
+; CHECK: %is.leader = icmp eq i64 %local.id, 0
+; CHECK: [[N:%.*]] = select i1 %is.leader, i32 %n, i32 0
+; CHECK: %leader.rid = call ptr @__ca_pipe_reserve_write(ptr addrspace(1) %p, i32 [[N]])
+; CHECK: [[BITS:%.*]] = ptrtoint ptr %leader.rid to i64
+; CHECK: [[BCAST:%.*]] = call i64 @__mux_work_group_broadcast_i64(i32 0, i64 [[BITS]], i64 0, i64 0, i64 0)
+; CHECK: [[RID:%.*]] = inttoptr i64 [[BCAST]] to ptr
+; CHECK: call void @__mux_work_group_barrier(i32 0, i32 2, i32 528)
+; CHECK: [[LEADER:%.*]] = icmp eq i64 {{%.*}}, 0
+; CHECK: [[COMMIT:%.*]] = select i1 [[LEADER]], ptr [[RID]], ptr null
+; CHECK: call void @__ca_pipe_commit_write(ptr addrspace(1) %p, ptr [[COMMIT]])
+define spir_kernel void @work_group(ptr addrspace(1) %p, i32 %n) {
+  %rid = call spir_func ptr @__work_group_reserve_write_pipe(ptr addrspace(1) %p, i32 %n, i32 4, i32 4)
+  call spir_func void @__work_group_commit_write_pipe(ptr addrspace(1) %p, ptr %rid, i32 4, i32 4)
+  ret void
+}
+
+; CHECK-LABEL: define spir_kernel void @sub_group(
+; CHECK: %local.id = call i32 @__mux_get_sub_group_local_id()
+; CHECK: %is.leader = icmp eq i32 %local.id, 0
+; CHECK: [[N:%.*]] = select i1 %is.leader, i32 %n, i32 0
+; CHECK: %leader.rid = call ptr @__ca_pipe_reserve_read(ptr addrspace(1) %p, i32 [[N]])
+; CHECK: [[BITS:%.*]] = ptrtoint ptr %leader.rid to i64
+; CHECK: [[BCAST:%.*]] = call i64 @__mux_sub_group_broadcast_i64(i64 [[BITS]], i32 0)
+; CHECK: [[RID:%.*]] = inttoptr i64 [[BCAST]] to ptr
+; CHECK: call void @__mux_sub_group_barrier(i32 0, i32 3, i32 528)
+; CHECK: [[LEADER:%.*]] = icmp eq i32 {{%.*}}, 0
+; CHECK: [[COMMIT:%.*]] = select i1 [[LEADER]], ptr [[RID]], ptr null
+; CHECK: call void @__ca_pipe_commit_read(ptr addrspace(1) %p, ptr [[COMMIT]])
+define spir_kernel void @sub_group(ptr addrspace(1) %p, i32 %n) {
+  %rid = call spir_func ptr @__sub_group_reserve_read_pipe(ptr addrspace(1) %p, i32 %n, i32 4, i32 4)
+  call spir_func void @__sub_group_commit_read_pipe(ptr addrspace(1) %p, ptr %rid, i32 4, i32 4)
+  ret void
+}
+
+; Readers reserve against the read reserve counter, limited by the packets
+; writers have committed.
+; RESERVE-LABEL: define internal ptr @__ca_pipe_reserve_read(ptr addrspace(1) %0, i32 %1)
+; RESERVE: [[COUNTER:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %0, i64 192
+; RESERVE: [[LIMIT:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %0, i64 128
+; RESERVE: loop:
+; RESERVE: %start = load atomic i32, ptr addrspace(1) [[COUNTER]] monotonic, align 4
+; RESERVE: %limit = load atomic i32, ptr addrspace(1) [[LIMIT]] acquire, align 4
+; RESERVE: [[AVAILABLE:%.*]] = sub i32 %limit, %start
+; RESERVE: icmp ule i32 %1, [[AVAILABLE]]
+; RESERVE: cmpxchg ptr addrspace(1) [[COUNTER]]
+
+; Writers are also limited by the pipe's maximum number of packets. Reserving
+; zero packets fails without touching the pipe.
+; RESERVE-LABEL: define internal ptr @__ca_pipe_reserve_write(ptr addrspace(1) %0, i32 %1)
+; RESERVE: [[COUNTER:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %0, i64 64
+; RESERVE: [[LIMIT:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %0, i64 256
+; RESERVE: [[MAXP:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %0, i64 8
+; RESERVE: %max = load i32, ptr addrspace(1) [[MAXP]], align 4
+; RESERVE: [[ZERO:%.*]] = icmp eq i32 %1, 0
+; RESERVE: br i1 [[ZERO]], label %fail, label %loop
+; RESERVE: loop:
+; RESERVE: %start = load atomic i32, ptr addrspace(1) [[COUNTER]] monotonic, align 4
+; RESERVE: %limit = load atomic i32, ptr addrspace(1) [[LIMIT]] acquire, align 4
+; RESERVE: [[USED:%.*]] = sub i32 %start, %limit
+; RESERVE: [[FREE:%.*]] = sub i32 %max, [[USED]]
+; RESERVE: [[FITS:%.*]] = icmp ule i32 %1, [[FREE]]
+; RESERVE: br i1 [[FITS]], label %try, label %fail
+; RESERVE: try:
+; RESERVE: [[END:%.*]] = add i32 %start, %1
+; RESERVE: [[XCHG:%.*]] = cmpxchg ptr addrspace(1) [[COUNTER]], i32 %start, i32 [[END]] monotonic monotonic, align 4
+; RESERVE: [[OK:%.*]] = extractvalue { i32, i1 } [[XCHG]], 1
+; RESERVE: br i1 [[OK]], label %done, label %loop
+; RESERVE: done:
+; RESERVE: inttoptr i64 {{%.*}} to ptr
+; RESERVE: fail:
+; RESERVE: ret ptr null
+
+; Commits wait for earlier reservations to be committed, and release the
+; packets to the other side of the pipe.
+; COMMIT-LABEL: define internal void @__ca_pipe_commit_read(ptr addrspace(1) %0, ptr %1)
+; COMMIT: [[COUNTER:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %0, i64 256
+; COMMIT: br i1 {{%.*}}, label %done, label %loop
+; COMMIT: loop:
+; COMMIT: [[XCHG:%.*]] = cmpxchg ptr addrspace(1) [[COUNTER]], i32 {{%.*}}, i32 {{%.*}} release monotonic, align 4
+; COMMIT: [[OK:%.*]] = extractvalue { i32, i1 } [[XCHG]], 1
+; COMMIT: br i1 [[OK]], label %done, label %loop
+; COMMIT-LABEL: define internal void @__ca_pipe_commit_write(ptr addrspace(1) %0, ptr %1)
+; COMMIT: getelementptr inbounds{{.*}} i8, ptr addrspace(1) %0, i64 128
+; COMMIT: cmpxchg {{.*}} release monotonic, align 4
+
+; Packets wrap around the ring, which starts after the header.
+; PACKET-LABEL: define internal i32 @__ca_pipe_read_packet(ptr addrspace(1) %0, ptr %1, i32 %2, ptr addrspace(4) %3, i32 %4)
+; PACKET: [[CAPP:%.*]] = getelementptr inbounds{{.*}} i8, ptr addrspace(1) %0, i64 4
+; PACKET: %capacity = load i32, ptr addrspace(1) [[CAPP]], align 4
+; PACKET: [[MASK:%.*]] = sub i32 %capacity, 1
+; PACKET: %slot = and i32 {{%.*}}, [[MASK]]
+; PACKET: add i64 {{%.*}}, 384
+; PACKET: call void @llvm.memcpy.p4.p1.i32(ptr addrspace(4) %3, ptr addrspace(1) {{%.*}}, i32 %4, i1 false)
+; PACKET: ret i32 0
+; PACKET-LABEL: define internal i32 @__ca_pipe_write_packet(ptr addrspace(1) %0, ptr %1, i32 %2, ptr addrspace(4) %3, i32 %4)
+; PACKET: call void @llvm.memcpy.p1.p4.i32(ptr addrspace(1) {{%.*}}, ptr addrspace(4) %3, i32 %4, i1 false)
+
+; Reading or writing a single packet is a reservation of one packet, which
+; returns -1 when the pipe is empty or full.
+; TRANSFER-LABEL: define internal i32 @__ca_pipe_read(ptr addrspace(1) %0, ptr addrspace(4) %1, i32 %2)
+; TRANSFER: %rid = call ptr @__ca_pipe_reserve_read(ptr addrspace(1) %0, i32 1)
+; TRANSFER: transfer:
+; TRANSFER: call i32 @__ca_pipe_read_packet(ptr addrspace(1) %0, ptr %rid, i32 0, ptr addrspace(4) %1, i32 %2)
+; TRANSFER: call void @__ca_pipe_commit_read(ptr addrspace(1) %0, ptr %rid)
+; TRANSFER: ret i32 0
+; TRANSFER: fail:
+; TRANSFER: ret i32 -1
+; TRANSFER-LABEL: define internal i32 @__ca_pipe_write(ptr addrspace(1) %0, ptr addrspace(4) %1, i32 %2)
+; TRANSFER: %rid = call ptr @__ca_pipe_reserve_write(ptr addrspace(1) %0, i32 1)
+
+declare spir_func i32 @__read_pipe_2(ptr addrspace(1), ptr addrspace(4), i32, i32)
+declare spir_func i32 @__write_pipe_2(ptr addrspace(1), ptr addrspace(4), i32, i32)
+declare spir_func i32 @__read_pipe_4(ptr addrspace(1), ptr, i32, ptr addrspace(4), i32, i32)
+declare spir_func i32 @__write_pipe_4(ptr addrspace(1), ptr, i32, ptr addrspace(4), i32, i32)
+declare spir_func ptr @__reserve_read_pipe(ptr addrspace(1), i32, i32, i32)
+declare spir_func ptr @__reserve_write_pipe(ptr addrspace(1), i32, i32, i32)
+declare spir_func void @__commit_read_pipe(ptr addrspace(1), ptr, i32, i32)
+declare spir_func void @__commit_write_pipe(ptr addrspace(1), ptr, i32, i32)
+declare spir_func i32 @_Z19is_valid_reserve_id13ocl_reserveid(ptr)
+declare spir_func i32 @__get_pipe_num_packets_ro(ptr addrspace(1), i32, i32)
+declare spir_func i32 @__get_pipe_max_packets_wo(ptr addrspace(1), i32, i32)
+declare spir_func ptr @__work_group_reserve_write_pipe(ptr addrspace(1), i32, i32, i32)
+declare spir_func void @__work_group_commit_write_pipe(ptr addrspace(1), ptr, i32, i32)
+declare spir_func ptr @__sub_group_reserve_read_pipe(ptr addrspace(1), i32, i32, i32)
+declare spir_func void @__sub_group_commit_read_pipe(ptr addrspace(1), ptr, i32, i32)
+
+!opencl.ocl.version = !{!0}
+
+!0 = !{i32 3, i32 0}
@@ -14,7 +14,10 @@
 ;
 ; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-; RUN: muxc --passes replace-printf,verify -S %s | FileCheck %s
+; RUN: muxc --passes replace-printf,verify -S %s \
+; RUN:   | FileCheck %s --check-prefixes CHECK,NOSTREAM
+; RUN: muxc --passes "replace-printf<streaming>,verify" -S %s \
+; RUN:   | FileCheck %s --check-prefixes CHECK,STREAM
 
 target triple = "spir64-unknown-unknown"
 target datalayout = "e-p:64:64:64-m:e-i64:64-f80:128-n8:16:32:64-S128"
@@ -43,6 +46,13 @@ entry:
 ; CHECK: [[VAL_PTR:%.*]] = getelementptr i8, ptr addrspace(1) [[PTR]], i32 [[NEXT_IDX]]
 ; CHECK: store i64 %1, ptr addrspace(1) [[VAL_PTR]]
 
+; When streaming, commit the 12 bytes written so the host may drain them while
+; the kernel runs
+; STREAM: [[COMMIT_PTR:%.*]] = getelementptr i32, ptr addrspace(1) [[PTR]], i32 2
+; STREAM: atomicrmw add ptr addrspace(1) [[COMMIT_PTR]], i32 12 seq_cst
+; NOSTREAM-NOT: atomicrmw
+; CHECK: ret i32 0
+
 declare i64 @__mux_get_global_id(i32)
 
 declare spir_func i32 @printf(i8 addrspace(2)*, ...)
@@ -46,7 +46,8 @@ target datalayout = "e-p:64:64:64-m:e-i64:64-f80:128-n8:16:32:64-S128"
 
 ; CHECK: define spir_kernel void @foo.mux-local-var-wrapper(ptr addrspace(1) [[ARG0:%.*]], ptr addrspace(1) [[ARG1:%.*]]) #[[WRAPPER_ATTRS:[0-9]+]]
 ; The alignment of this alloca must be the maximum alignment of the new struct
-; CHECK: [[ALLOCA:%.*]] = alloca %localVarTypes, align 8
+; The alloca is marked as local memory, for targets to allocate elsewhere
+; CHECK: [[ALLOCA:%.*]] = alloca %localVarTypes, align 8, !mux_local_memory [[LOCAL_MD:\![0-9]+]]
 ; CHECK: call spir_func void @add(ptr addrspace(1) [[ARG0]], ptr addrspace(1) [[ARG1]], ptr [[ALLOCA]])
 define spir_kernel void @add(i32 addrspace(1)* %in, i32 addrspace(1)* %out) #0 {
   %ld = load i16, i16 addrspace(3)* @a, align 2
@@ -60,5 +61,6 @@ define spir_kernel void @add(i32 addrspace(1)* %in, i32 addrspace(1)* %out) #0 {
 ; Check also that we've preserved the original function name attribute
 ; CHECK: attributes #[[ATTRS]] = { noinline "mux-base-fn-name"="foo" }
 ; CHECK: attributes #[[WRAPPER_ATTRS]] = { noinline nounwind "mux-base-fn-name"="foo" "mux-kernel"="entry-point" }
+; CHECK: [[LOCAL_MD]] = !{}
 
 attributes #0 = { noinline "mux-base-fn-name"="foo" "mux-kernel"="entry-point" }
@@ -27,6 +27,7 @@
 #include <llvm/IR/PassManager.h>
 #include <llvm/Support/Printable.h>
 #include <metadata/handler/generic_metadata.h>
+#include <metadata/handler/local_size_info_metadata.h>
 #include <metadata/handler/vectorize_info_metadata.h>
 
 namespace compiler {
@@ -100,6 +101,35 @@ class VectorizeMetadataPrinterPass
                               llvm::FunctionAnalysisManager &AM);
 };
 
+class LocalSizeMetadataAnalysis
+    : public llvm::AnalysisInfoMixin<LocalSizeMetadataAnalysis> {
+  friend AnalysisInfoMixin<LocalSizeMetadataAnalysis>;
+
+ public:
+  using Result = handler::LocalSizeInfoMetadata;
+  LocalSizeMetadataAnalysis() = default;
+
+  Result run(llvm::Function &Fn, llvm::FunctionAnalysisManager &AM);
+
+  /// @brief Return the name of the pass.
+  static llvm::StringRef name() { return "Local Size Metadata analysis"; }
+
+ private:
+  /// @brief Unique identifier for the pass.
+  static llvm::AnalysisKey Key;
+};
+
+class LocalSizeMetadataPrinterPass
+    : public llvm::PassInfoMixin<LocalSizeMetadataPrinterPass> {
+  llvm::raw_ostream &OS;
+
+ public:
+  explicit LocalSizeMetadataPrinterPass(llvm::raw_ostream &OS) : OS(OS) {}
+
+  llvm::PreservedAnalyses run(llvm::Function &F,
+                              llvm::FunctionAnalysisManager &AM);
+};
+
 }  // namespace utils
 }  // namespace compiler
 
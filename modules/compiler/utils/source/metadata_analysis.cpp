@@ -120,5 +120,32 @@ PreservedAnalyses VectorizeMetadataPrinterPass::run(
   return PreservedAnalyses::all();
 }
 
+static Printable printLocalSizeMD(const handler::LocalSizeInfoMetadata &MD) {
+  return Printable([MD](raw_ostream &Out) {
+    Out << printVectorizeMD(MD);
+    Out << "Local Size: " << MD.local_size[0] << "," << MD.local_size[1] << ","
+        << MD.local_size[2] << "\n";
+  });
+}
+
+AnalysisKey LocalSizeMetadataAnalysis::Key;
+
+LocalSizeMetadataAnalysis::Result LocalSizeMetadataAnalysis::run(
+    Function &Fn, FunctionAnalysisManager &AM) {
+  handler::VectorizeInfoMetadata &VectorizeMD =
+      AM.getResult<VectorizeMetadataAnalysis>(Fn);
+  return Result(std::move(VectorizeMD),
+                getLocalSizeMetadata(Fn).value_or(std::array<uint64_t, 3>{}));
+}
+
+PreservedAnalyses LocalSizeMetadataPrinterPass::run(
+    Function &F, FunctionAnalysisManager &AM) {
+  const handler::LocalSizeInfoMetadata md =
+      AM.getResult<LocalSizeMetadataAnalysis>(F);
+  OS << "Cached local size metadata analysis:\n";
+  OS << printLocalSizeMD(md);
+  return PreservedAnalyses::all();
+}
+
 }  // namespace utils
 }  // namespace compiler
@@ -0,0 +1,217 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Prelinked images which can be loaded without relocating their code.
+///
+/// An image is produced ahead of time from a position independent relocatable
+/// ELF file by resolving every relocation which doesn't depend on where the
+/// image is loaded. What remains is a short list of absolute pointers in its
+/// writable data, called fixups, which are applied at load time. Calls to
+/// functions outside of the image go through stubs which load their target
+/// from a table in the writable data, so the executable segment is never
+/// written to and can be mapped straight from a file and shared between
+/// processes.
+
+#ifndef LOADER_IMAGE_H_INCLUDED
+#define LOADER_IMAGE_H_INCLUDED
+
+#include <cargo/array_view.h>
+#include <cargo/error.h>
+#include <cargo/expected.h>
+#include <cargo/optional.h>
+#include <cargo/string_view.h>
+#include <loader/elf.h>
+#include <loader/mapper.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace loader {
+
+/// @brief Header at the start of every image, all offsets are in bytes from
+/// the start of the image.
+struct ImageHeader {
+  /// @brief Identifies the file as an image, see `isImage`.
+  uint8_t magic[8];
+  /// @brief Version of the image format.
+  uint32_t version;
+  /// @brief ELF machine the code in the image was compiled for.
+  uint32_t machine;
+  /// @brief Hash of the whole image, computed with this field set to zero.
+  uint64_t hash;
+  /// @brief Alignment of the segments both in the file and in memory.
+  uint64_t alignment;
+  /// @brief Size of the memory the image occupies once loaded.
+  uint64_t memory_size;
+  /// @brief Number of entries in the segment table.
+  uint32_t segment_count;
+  /// @brief Number of entries in the fixup table.
+  uint32_t fixup_count;
+  /// @brief Number of entries in the import table.
+  uint32_t import_count;
+  /// @brief Number of entries in the symbol table.
+  uint32_t symbol_count;
+  /// @brief Offset of the segment table.
+  uint64_t segments_offset;
+  /// @brief Offset of the fixup table.
+  uint64_t fixups_offset;
+  /// @brief Offset of the import table.
+  uint64_t imports_offset;
+  /// @brief Offset of the symbol table.
+  uint64_t symbols_offset;
+  /// @brief Offset of the names of imports and symbols.
+  uint64_t strings_offset;
+  /// @brief Size of the names of imports and symbols.
+  uint64_t strings_size;
+  /// @brief Offset of the metadata copied from the ELF file.
+  uint64_t metadata_offset;
+  /// @brief Size of the metadata copied from the ELF file.
+  uint64_t metadata_size;
+};
+
+/// @brief A range of the image loaded with a single memory protection.
+struct ImageSegment {
+  /// @brief Offset of the segment's contents in the image.
+  uint64_t file_offset;
+  /// @brief Number of bytes of the segment stored in the image, the rest of
+  /// the segment is zero-filled.
+  uint64_t file_size;
+  /// @brief Offset of the segment from where the image is loaded.
+  uint64_t address;
+  /// @brief Size of the segment once loaded.
+  uint64_t memory_size;
+  /// @brief `MemoryProtection` of the segment once loaded.
+  uint32_t protection;
+  uint32_t reserved;
+};
+
+/// @brief A 64-bit pointer which must be written when the image is loaded.
+struct ImageFixup {
+  /// @brief Sentinel import index of fixups relative to the load address.
+  static constexpr uint32_t BASE = UINT32_MAX;
+  /// @brief Offset of the pointer from where the image is loaded.
+  uint64_t address;
+  /// @brief Value added to the load address, or to the import's address.
+  int64_t addend;
+  /// @brief Index of the import the pointer refers to, or `BASE`.
+  uint32_t import;
+  uint32_t reserved;
+};
+
+/// @brief A function outside of the image, which is resolved by name.
+struct ImageImport {
+  /// @brief Offset of the name in the string table.
+  uint32_t name_offset;
+  /// @brief Length of the name.
+  uint32_t name_size;
+  /// @brief Offset of the pointer to the import from where the image is
+  /// loaded, which the import's stub jumps through.
+  uint64_t slot;
+};
+
+/// @brief A global symbol defined in the image, the symbol table is sorted by
+/// name.
+struct ImageSymbol {
+  /// @brief Offset of the name in the string table.
+  uint32_t name_offset;
+  /// @brief Length of the name.
+  uint32_t name_size;
+  /// @brief Offset of the symbol from where the image is loaded.
+  uint64_t address;
+};
+
+/// @brief Checks if a binary starts with an image header.
+///
+/// @param bytes Binary to check.
+///
+/// @return Returns true if the binary looks like an image, the contents are
+/// validated when it's loaded.
+bool isImage(cargo::array_view<const uint8_t> bytes);
+
+/// @brief Prelinks a relocatable ELF file into an image.
+///
+/// Only position independent x86_64 and AArch64 objects can be prelinked, any
+/// other file returns `cargo::unsupported` so that the caller can fall back to
+/// loading the ELF file.
+///
+/// @param file Relocatable ELF file to prelink.
+/// @param metadata_section Name of an allocated section to copy into the
+/// image's metadata rather than loading, may be empty.
+///
+/// @return Returns the image, or the reason it couldn't be created.
+cargo::expected<std::vector<uint8_t>, cargo::result> createImage(
+    ElfFile &file, cargo::string_view metadata_section);
+
+/// @brief An image loaded into executable memory.
+class Image {
+ public:
+  /// @brief Functions which imports can resolve to, as names and addresses.
+  using ImportList = std::vector<std::pair<std::string, uint64_t>>;
+
+  Image() = default;
+  Image(const Image &) = delete;
+  Image(Image &&) = default;
+  Image &operator=(Image &&) = default;
+
+  /// @brief Loads an image by copying its segments into newly allocated
+  /// memory.
+  ///
+  /// @param bytes Image to load, must stay alive for as long as `metadata` is
+  /// used.
+  /// @param imports Functions the image's imports are resolved to.
+  cargo::result load(cargo::array_view<const uint8_t> bytes,
+                     const ImportList &imports);
+
+  /// @brief Loads an image by mapping its segments from a file, so that the
+  /// pages of its code are shared by every process which maps the same file.
+  ///
+  /// Only supported on POSIX systems, otherwise returns `cargo::unsupported`.
+  ///
+  /// @param fd File descriptor of the image file, which may be closed once this
+  /// returns.
+  /// @param bytes Contents of the image file, must stay alive for as long as
+  /// `metadata` is used.
+  /// @param imports Functions the image's imports are resolved to.
+  cargo::result map(int fd, cargo::array_view<const uint8_t> bytes,
+                    const ImportList &imports);
+
+  /// @brief Returns whether an image has been loaded.
+  bool loaded() const { return !pages.data().empty(); }
+
+  /// @brief Looks up the address of a global symbol in the loaded image.
+  cargo::optional<uint64_t> getSymbolAddress(cargo::string_view name) const;
+
+  /// @brief Gets the metadata the image was created with.
+  cargo::array_view<const uint8_t> metadata() const;
+
+ private:
+  /// @brief Checks the header and tables of an image fit within it and the
+  /// image was made for this machine.
+  cargo::result validate(cargo::array_view<const uint8_t> bytes);
+  /// @brief Resolves imports, applies fixups and protects the segments.
+  cargo::result link(const ImportList &imports);
+
+  cargo::array_view<const uint8_t> image;
+  PageRange pages;
+};
+
+}  // namespace loader
+
+#endif
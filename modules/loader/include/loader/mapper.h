@@ -62,6 +62,15 @@ struct PageRange {
   /// @brief Changes the protection of the allocated memory pages.
   cargo::result protect(MemoryProtection protection);
 
+  /// @brief Changes the protection of some of the allocated memory pages.
+  ///
+  /// @param protection Protection to apply.
+  /// @param offset Offset of the first page to protect, must be a multiple of
+  /// the page size.
+  /// @param size Number of bytes to protect, rounded up to whole pages.
+  cargo::result protect(MemoryProtection protection, size_t offset,
+                        size_t size);
+
   /// @brief Gets the allocated memory range.
   cargo::array_view<uint8_t> data() const { return {pages_begin, pages_end}; }
 
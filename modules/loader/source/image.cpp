@@ -0,0 +1,745 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cargo/endian.h>
+#include <loader/image.h>
+#include <loader/relocation_types.h>
+#include <loader/relocations.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+// Layout of an image in memory, each segment starts on a new page:
+//
+// * code: executable sections, followed by one stub per import
+// * rodata: read-only sections
+// * data: writable sections, followed by one pointer per import, followed by
+//   zero-initialized sections
+//
+// In the file the segments follow the header and tables, at offsets with the
+// same page alignment they have in memory so that they can be mapped directly.
+// The code is prelinked by resolving the ELF file's relocations as if the
+// image was loaded at a nominal base address, which only leaves absolute
+// pointers in data to be fixed up at load time. Relocations which would need
+// the code itself to be rewritten are rejected, so the file's code pages are
+// never written to.
+
+namespace {
+constexpr uint8_t image_magic[8] = {0x7F, 'C', 'A', 'I', 'M', 'A', 'G', 'E'};
+constexpr uint32_t image_version = 1;
+// Address the image is prelinked at, relocations fail to resolve if a section
+// is at address zero.
+constexpr uint64_t image_base = 0x10000;
+// Bytes reserved for each import's stub in the code segment.
+constexpr uint64_t stub_size = 16;
+
+enum segment_kind { segment_code, segment_rodata, segment_data, segment_count };
+
+enum class RelocationKind { unsupported, none, relative, absolute };
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+  return alignment > 1 ? (value + alignment - 1) / alignment * alignment
+                       : value;
+}
+
+loader::ElfFields::Machine nativeMachine() {
+#if defined(__x86_64__) || defined(_M_X64)
+  return loader::ElfFields::Machine::X86_64;
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  return loader::ElfFields::Machine::AARCH64;
+#else
+  return loader::ElfFields::Machine::UNKNOWN;
+#endif
+}
+
+// Segments must start on a page boundary on every system the code can run on,
+// AArch64 supports pages of up to 64KiB.
+uint64_t segmentAlignment(loader::ElfFields::Machine machine) {
+  return machine == loader::ElfFields::Machine::AARCH64 ? 0x10000 : 0x1000;
+}
+
+// Relocations which are either independent of where the image is loaded, or
+// absolute pointers which can be fixed up at load time.
+RelocationKind classifyRelocation(loader::ElfFields::Machine machine,
+                                  uint32_t type) {
+  if (machine == loader::ElfFields::Machine::X86_64) {
+    using namespace loader::RelocationTypes::X86_64;
+    switch (type) {
+      case R_X86_64_NONE:
+        return RelocationKind::none;
+      case R_X86_64_64:
+        return RelocationKind::absolute;
+      case R_X86_64_PC32:
+      case R_X86_64_PLT32:
+      case R_X86_64_PC64:
+        return RelocationKind::relative;
+      default:
+        return RelocationKind::unsupported;
+    }
+  }
+  using namespace loader::RelocationTypes::AArch64;
+  switch (type) {
+    case R_AARCH64_NONE:
+      return RelocationKind::none;
+    case R_AARCH64_ABS64:
+      return RelocationKind::absolute;
+    // The low 12 bits of an address don't depend on where the image is loaded
+    // as long as it's loaded on a page boundary.
+    case R_AARCH64_PREL64:
+    case R_AARCH64_PREL32:
+    case R_AARCH64_CALL26:
+    case R_AARCH64_JUMP26:
+    case R_AARCH64_ADR_PREL_PG_HI21:
+    case R_AARCH64_ADD_ABS_LO12_NC:
+    case R_AARCH64_LDST8_ABS_LO12_NC:
+    case R_AARCH64_LDST16_ABS_LO12_NC:
+    case R_AARCH64_LDST32_ABS_LO12_NC:
+    case R_AARCH64_LDST64_ABS_LO12_NC:
+    case R_AARCH64_LDST128_ABS_LO12_NC:
+      return RelocationKind::relative;
+    default:
+      return RelocationKind::unsupported;
+  }
+}
+
+// Writes a stub which jumps to the address stored in an import's slot.
+void writeStub(loader::ElfFields::Machine machine, uint8_t *stub,
+               uint64_t stub_address, uint64_t slot_address) {
+  if (machine == loader::ElfFields::Machine::X86_64) {
+    // jmp *slot(%rip), padded with int3
+    std::fill_n(stub, stub_size, uint8_t{0xCC});
+    stub[0] = 0xFF;
+    stub[1] = 0x25;
+    const uint32_t displacement =
+        static_cast<uint32_t>(slot_address - (stub_address + 6));
+    cargo::write_little_endian(displacement, stub + 2);
+    return;
+  }
+  // adrp ip0, slot
+  const uint64_t pages = (slot_address >> 12) - (stub_address >> 12);
+  const uint32_t adrp = 0x90000010 | static_cast<uint32_t>(pages & 0x3) << 29 |
+                        static_cast<uint32_t>((pages >> 2) & 0x7FFFF) << 5;
+  cargo::write_little_endian(adrp, stub);
+  // ldr ip0, [ip0, #:lo12:slot]
+  const uint32_t ldr =
+      0xF9400210 | static_cast<uint32_t>((slot_address & 0xFFF) / 8) << 10;
+  cargo::write_little_endian(ldr, stub + 4);
+  // br ip0
+  cargo::write_little_endian(uint32_t{0xD61F0200}, stub + 8);
+  // brk #0
+  cargo::write_little_endian(uint32_t{0xD4200000}, stub + 12);
+}
+
+// 64-bit FNV-1a hash.
+uint64_t hashBytes(const uint8_t *bytes, size_t size) {
+  uint64_t hash = 0xCBF29CE484222325;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001B3;
+  }
+  return hash;
+}
+
+// Checks that count entries of size bytes starting at offset fit in limit.
+bool fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t limit) {
+  return offset <= limit && count <= (limit - offset) / size;
+}
+
+template <typename T>
+T readEntry(cargo::array_view<const uint8_t> image, uint64_t offset,
+            uint64_t index) {
+  T entry;
+  std::memcpy(&entry, image.data() + offset + index * sizeof(T), sizeof(T));
+  return entry;
+}
+
+template <typename T>
+void writeTable(std::vector<uint8_t> &image, uint64_t offset,
+                const std::vector<T> &table) {
+  if (!table.empty()) {
+    std::memcpy(image.data() + offset, table.data(), table.size() * sizeof(T));
+  }
+}
+}  // namespace
+
+bool loader::isImage(cargo::array_view<const uint8_t> bytes) {
+  return bytes.size() >= sizeof(ImageHeader) &&
+         std::equal(std::begin(image_magic), std::end(image_magic),
+                    bytes.begin());
+}
+
+cargo::expected<std::vector<uint8_t>, cargo::result> loader::createImage(
+    ElfFile &file, cargo::string_view metadata_section) {
+  const ElfFields::Machine machine = file.machine();
+  if (file.is32Bit() ||
+      file.headerIdent()->endianness != ElfFields::Endianness::LITTLE ||
+      file.type() != ElfFields::Type::RELOCATABLE ||
+      (machine != ElfFields::Machine::X86_64 &&
+       machine != ElfFields::Machine::AARCH64)) {
+    return cargo::make_unexpected(cargo::unsupported);
+  }
+  const uint64_t alignment = segmentAlignment(machine);
+
+  // Sort the allocated sections into segments, writable sections which are
+  // zero-initialized go last so that they needn't be stored in the file.
+  std::vector<ElfFile::Section> sections[segment_count];
+  std::vector<ElfFile::Section> zero_sections;
+  cargo::array_view<uint8_t> metadata;
+  for (auto &section : file.sections()) {
+    const auto flags = section.flags();
+    if (!(flags & ElfFields::SectionFlags::ALLOC)) {
+      continue;
+    }
+    const bool nobits = section.type() == ElfFields::SectionType::NOBITS;
+    if (!metadata_section.empty() && section.name() == metadata_section) {
+      if (!nobits) {
+        metadata = section.data();
+      }
+      continue;
+    }
+    if (flags & ElfFields::SectionFlags::TLS) {
+      return cargo::make_unexpected(cargo::unsupported);
+    }
+    if (flags & ElfFields::SectionFlags::EXECINSTR) {
+      sections[segment_code].push_back(section);
+    } else if (!(flags & ElfFields::SectionFlags::WRITE)) {
+      sections[segment_rodata].push_back(section);
+    } else if (nobits) {
+      zero_sections.push_back(section);
+    } else {
+      sections[segment_data].push_back(section);
+    }
+  }
+
+  // Every undefined symbol is an import, the host resolves them by name.
+  std::vector<cargo::string_view> import_names;
+  for (auto &symbol : file.symbols()) {
+    if (symbol.sectionIndex() != ElfFields::SymbolSpecialSection::UNDEFINED) {
+      continue;
+    }
+    auto name = symbol.name();
+    if (!name || name->empty() ||
+        std::find(import_names.begin(), import_names.end(), *name) !=
+            import_names.end()) {
+      continue;
+    }
+    import_names.push_back(*name);
+  }
+
+  // Lay out the segments.
+  std::vector<std::pair<ElfFile::Section, uint64_t>> placed;
+  uint64_t cursor = 0;
+  auto place = [&](const ElfFile::Section &section) {
+    cursor = alignUp(cursor, section.alignment());
+    placed.emplace_back(section, cursor);
+    cursor += section.size();
+  };
+  ImageSegment segments[segment_count] = {};
+  uint64_t stubs_address = 0;
+  uint64_t slots_address = 0;
+  for (int kind = segment_code; kind < segment_count; kind++) {
+    cursor = alignUp(cursor, alignment);
+    segments[kind].address = cursor;
+    for (const auto &section : sections[kind]) {
+      place(section);
+    }
+    if (segment_code == kind) {
+      stubs_address = alignUp(cursor, stub_size);
+      cursor = stubs_address + import_names.size() * stub_size;
+      segments[kind].protection = MEM_CODE;
+    } else if (segment_rodata == kind) {
+      segments[kind].protection = MEM_RODATA;
+    } else {
+      slots_address = alignUp(cursor, sizeof(uint64_t));
+      cursor = slots_address + import_names.size() * sizeof(uint64_t);
+      segments[kind].file_size = cursor - segments[kind].address;
+      for (const auto &section : zero_sections) {
+        place(section);
+      }
+      segments[kind].protection = MEM_DATA;
+    }
+    segments[kind].memory_size = cursor - segments[kind].address;
+    if (segment_data != kind) {
+      segments[kind].file_size = segments[kind].memory_size;
+    }
+  }
+  const uint64_t memory_size = alignUp(cursor, alignment);
+  if (0 == memory_size) {
+    return cargo::make_unexpected(cargo::unsupported);
+  }
+
+  // Load the sections into a buffer and map them at the nominal base.
+  std::vector<uint8_t> memory(memory_size);
+  ElfMap map{&file};
+  for (auto &[section, address] : placed) {
+    uint8_t *writable = memory.data() + address;
+    if (section.type() != ElfFields::SectionType::NOBITS) {
+      std::copy(section.data().begin(), section.data().end(), writable);
+    }
+    if (map.addSectionMapping(section, writable, writable + section.size(),
+                              image_base + address)) {
+      return cargo::make_unexpected(cargo::bad_alloc);
+    }
+  }
+  for (size_t index = 0; index < import_names.size(); index++) {
+    const uint64_t stub_address = stubs_address + index * stub_size;
+    writeStub(machine, memory.data() + stub_address, image_base + stub_address,
+              image_base + slots_address + index * sizeof(uint64_t));
+    // Calls to an import go through its stub.
+    if (map.addCallback(import_names[index], image_base + stub_address)) {
+      return cargo::make_unexpected(cargo::bad_alloc);
+    }
+  }
+
+  // Collect the relocations of the loaded sections, relocations of sections
+  // which aren't loaded such as debug info are ignored.
+  std::vector<Relocation> relocations;
+  for (auto &section : file.sections()) {
+    const bool rela = section.type() == ElfFields::SectionType::RELA;
+    if ((!rela && section.type() != ElfFields::SectionType::REL) ||
+        !section.entrySize()) {
+      continue;
+    }
+    const cargo::string_view prefix = rela ? ".rela" : ".rel";
+    if (!section.name().starts_with(prefix)) {
+      continue;
+    }
+    auto target_name = section.name().substr(prefix.size());
+    if (!target_name) {
+      continue;
+    }
+    auto target = file.section(*target_name).map(&ElfFile::Section::index);
+    if (!target || !map.getSectionTargetAddress(*target)) {
+      continue;
+    }
+    // Neither x86_64 nor AArch64 use implicit addends.
+    if (!rela) {
+      return cargo::make_unexpected(cargo::unsupported);
+    }
+    for (auto *it = section.data().begin(); it != section.data().end();
+         it += section.entrySize()) {
+      relocations.push_back(
+          Relocation::fromElfEntry<Relocation::EntryType::Elf64RelA>(
+              file, *target, it));
+    }
+  }
+
+  // Check every relocation can be prelinked before resolving any of them, and
+  // record the absolute pointers which must be fixed up at load time.
+  std::vector<ImageFixup> fixups;
+  for (const auto &relocation : relocations) {
+    const RelocationKind kind = classifyRelocation(machine, relocation.type);
+    if (RelocationKind::unsupported == kind) {
+      return cargo::make_unexpected(cargo::unsupported);
+    }
+    if (RelocationKind::absolute != kind) {
+      continue;
+    }
+    if (file.section(relocation.section_index).flags() &
+        ElfFields::SectionFlags::EXECINSTR) {
+      return cargo::make_unexpected(cargo::unsupported);
+    }
+    auto symbol = file.symbol(relocation.symbol_index);
+    if (symbol.sectionIndex() == ElfFields::SymbolSpecialSection::ABSOLUTE) {
+      continue;
+    }
+    ImageFixup fixup = {};
+    fixup.address = *map.getSectionTargetAddress(relocation.section_index) -
+                    image_base + relocation.offset;
+    fixup.import = ImageFixup::BASE;
+    if (symbol.sectionIndex() == ElfFields::SymbolSpecialSection::UNDEFINED) {
+      auto import = std::find(import_names.begin(), import_names.end(),
+                              symbol.name().value_or(""));
+      if (import == import_names.end()) {
+        return cargo::make_unexpected(cargo::unsupported);
+      }
+      fixup.import = static_cast<uint32_t>(import - import_names.begin());
+      fixup.addend = relocation.addend;
+    } else if (ElfFields::SymbolSpecialSection::isSpecial(
+                   symbol.sectionIndex())) {
+      return cargo::make_unexpected(cargo::unsupported);
+    }
+    fixups.push_back(fixup);
+  }
+
+  Relocation::StubMap stubs;
+  for (auto &relocation : relocations) {
+    if (!relocation.resolve(file, map, stubs, relocations)) {
+      return cargo::make_unexpected(cargo::unsupported);
+    }
+  }
+
+  // The resolved pointers hold their offset from the nominal base, clear them
+  // so that the image doesn't depend on it.
+  for (auto &fixup : fixups) {
+    uint8_t *pointer = memory.data() + fixup.address;
+    if (ImageFixup::BASE == fixup.import) {
+      uint64_t value;
+      cargo::read_little_endian(&value, pointer);
+      fixup.addend = static_cast<int64_t>(value - image_base);
+    }
+    std::fill_n(pointer, sizeof(uint64_t), uint8_t{0});
+  }
+
+  // Export the global symbols, sorted by name so they can be binary searched.
+  std::vector<std::pair<cargo::string_view, uint64_t>> exports;
+  for (auto &symbol : file.symbols()) {
+    const auto binding = symbol.binding();
+    const auto type = symbol.type();
+    if ((binding != ElfFields::SymbolBinding::GLOBAL &&
+         binding != ElfFields::SymbolBinding::WEAK) ||
+        (type != ElfFields::SymbolType::FUNCTION &&
+         type != ElfFields::SymbolType::OBJECT &&
+         type != ElfFields::SymbolType::NONE) ||
+        ElfFields::SymbolSpecialSection::isSpecial(symbol.sectionIndex())) {
+      continue;
+    }
+    auto name = symbol.name();
+    auto section_address = map.getSectionTargetAddress(symbol.sectionIndex());
+    if (!name || name->empty() || !section_address) {
+      continue;
+    }
+    exports.emplace_back(*name,
+                         *section_address - image_base + symbol.value());
+  }
+  std::sort(exports.begin(), exports.end(),
+            [](const auto &lhs, const auto &rhs) {
+              return lhs.first.compare(rhs.first) < 0;
+            });
+
+  std::string strings;
+  std::vector<ImageImport> imports;
+  for (size_t index = 0; index < import_names.size(); index++) {
+    ImageImport import = {};
+    import.name_offset = static_cast<uint32_t>(strings.size());
+    import.name_size = static_cast<uint32_t>(import_names[index].size());
+    import.slot = slots_address + index * sizeof(uint64_t);
+    strings.append(import_names[index].data(), import_names[index].size());
+    imports.push_back(import);
+  }
+  std::vector<ImageSymbol> symbols;
+  for (const auto &[name, address] : exports) {
+    ImageSymbol symbol = {};
+    symbol.name_offset = static_cast<uint32_t>(strings.size());
+    symbol.name_size = static_cast<uint32_t>(name.size());
+    symbol.address = address;
+    strings.append(name.data(), name.size());
+    symbols.push_back(symbol);
+  }
+
+  std::vector<ImageSegment> segment_table;
+  for (const auto &segment : segments) {
+    if (segment.memory_size) {
+      segment_table.push_back(segment);
+    }
+  }
+
+  ImageHeader header = {};
+  std::copy(std::begin(image_magic), std::end(image_magic), header.magic);
+  header.version = image_version;
+  header.machine = static_cast<uint32_t>(machine);
+  header.alignment = alignment;
+  header.memory_size = memory_size;
+  header.segment_count = static_cast<uint32_t>(segment_table.size());
+  header.fixup_count = static_cast<uint32_t>(fixups.size());
+  header.import_count = static_cast<uint32_t>(imports.size());
+  header.symbol_count = static_cast<uint32_t>(symbols.size());
+  uint64_t offset = sizeof(ImageHeader);
+  header.segments_offset = offset;
+  offset += segment_table.size() * sizeof(ImageSegment);
+  header.fixups_offset = offset;
+  offset += fixups.size() * sizeof(ImageFixup);
+  header.imports_offset = offset;
+  offset += imports.size() * sizeof(ImageImport);
+  header.symbols_offset = offset;
+  offset += symbols.size() * sizeof(ImageSymbol);
+  header.strings_offset = offset;
+  header.strings_size = strings.size();
+  offset += strings.size();
+  header.metadata_offset = offset;
+  header.metadata_size = metadata.size();
+  offset += metadata.size();
+  for (auto &segment : segment_table) {
+    offset = alignUp(offset, alignment);
+    segment.file_offset = offset;
+    offset += segment.file_size;
+  }
+
+  std::vector<uint8_t> image(offset);
+  writeTable(image, header.segments_offset, segment_table);
+  writeTable(image, header.fixups_offset, fixups);
+  writeTable(image, header.imports_offset, imports);
+  writeTable(image, header.symbols_offset, symbols);
+  std::copy(strings.begin(), strings.end(),
+            image.begin() + header.strings_offset);
+  std::copy(metadata.begin(), metadata.end(),
+            image.begin() + header.metadata_offset);
+  for (const auto &segment : segment_table) {
+    std::copy_n(memory.begin() + segment.address, segment.file_size,
+                image.begin() + segment.file_offset);
+  }
+  std::memcpy(image.data(), &header, sizeof(header));
+  header.hash = hashBytes(image.data(), image.size());
+  std::memcpy(image.data(), &header, sizeof(header));
+  return image;
+}
+
+cargo::result loader::Image::validate(cargo::array_view<const uint8_t> bytes) {
+  if (!isImage(bytes)) {
+    return cargo::bad_argument;
+  }
+  ImageHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  const uint64_t size = bytes.size();
+  if (header.version != image_version ||
+      header.machine != static_cast<uint32_t>(nativeMachine())) {
+    return cargo::unsupported;
+  }
+  if (0 == header.alignment ||
+      (header.alignment & (header.alignment - 1)) != 0 ||
+      header.alignment % getPageSize() != 0) {
+    return cargo::unsupported;
+  }
+  if (0 == header.memory_size ||
+      !fits(header.segments_offset, header.segment_count, sizeof(ImageSegment),
+            size) ||
+      !fits(header.fixups_offset, header.fixup_count, sizeof(ImageFixup),
+            size) ||
+      !fits(header.imports_offset, header.import_count, sizeof(ImageImport),
+            size) ||
+      !fits(header.symbols_offset, header.symbol_count, sizeof(ImageSymbol),
+            size) ||
+      !fits(header.strings_offset, header.strings_size, 1, size) ||
+      !fits(header.metadata_offset, header.metadata_size, 1, size)) {
+    return cargo::bad_argument;
+  }
+
+  // Fixups and import slots are only written to in writable segments.
+  auto writable = [&](uint64_t address) {
+    for (uint32_t index = 0; index < header.segment_count; index++) {
+      const auto segment =
+          readEntry<ImageSegment>(bytes, header.segments_offset, index);
+      if ((segment.protection & MEM_WRITABLE) && address >= segment.address &&
+          fits(address - segment.address, 1, sizeof(uint64_t),
+               segment.memory_size)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  for (uint32_t index = 0; index < header.segment_count; index++) {
+    const auto segment =
+        readEntry<ImageSegment>(bytes, header.segments_offset, index);
+    if (!fits(segment.file_offset, segment.file_size, 1, size) ||
+        segment.file_size > segment.memory_size ||
+        !fits(segment.address, segment.memory_size, 1, header.memory_size) ||
+        segment.address % header.alignment != 0 ||
+        segment.file_offset % header.alignment != 0 ||
+        (segment.protection & ~uint32_t{MEM_DATA | MEM_CODE}) != 0 ||
+        ((segment.protection & MEM_WRITABLE) &&
+         (segment.protection & MEM_EXECUTABLE))) {
+      return cargo::bad_argument;
+    }
+  }
+  for (uint32_t index = 0; index < header.fixup_count; index++) {
+    const auto fixup =
+        readEntry<ImageFixup>(bytes, header.fixups_offset, index);
+    if ((ImageFixup::BASE != fixup.import &&
+         fixup.import >= header.import_count) ||
+        !writable(fixup.address)) {
+      return cargo::bad_argument;
+    }
+  }
+  for (uint32_t index = 0; index < header.import_count; index++) {
+    const auto import =
+        readEntry<ImageImport>(bytes, header.imports_offset, index);
+    if (!fits(import.name_offset, import.name_size, 1, header.strings_size) ||
+        !writable(import.slot)) {
+      return cargo::bad_argument;
+    }
+  }
+  for (uint32_t index = 0; index < header.symbol_count; index++) {
+    const auto symbol =
+        readEntry<ImageSymbol>(bytes, header.symbols_offset, index);
+    if (!fits(symbol.name_offset, symbol.name_size, 1, header.strings_size) ||
+        symbol.address >= header.memory_size) {
+      return cargo::bad_argument;
+    }
+  }
+  image = bytes;
+  return cargo::success;
+}
+
+cargo::result loader::Image::load(cargo::array_view<const uint8_t> bytes,
+                                  const ImportList &imports) {
+  if (loaded()) {
+    return cargo::bad_argument;
+  }
+  if (auto error = validate(bytes)) {
+    return error;
+  }
+  ImageHeader header;
+  std::memcpy(&header, image.data(), sizeof(header));
+  if (auto error = pages.allocate(header.memory_size)) {
+    return error;
+  }
+  for (uint32_t index = 0; index < header.segment_count; index++) {
+    const auto segment =
+        readEntry<ImageSegment>(image, header.segments_offset, index);
+    std::copy_n(image.begin() + segment.file_offset, segment.file_size,
+                pages.data().begin() + segment.address);
+  }
+  return link(imports);
+}
+
+cargo::result loader::Image::map(int fd, cargo::array_view<const uint8_t> bytes,
+                                 const ImportList &imports) {
+#ifdef _WIN32
+  (void)fd;
+  (void)bytes;
+  (void)imports;
+  return cargo::unsupported;
+#else
+  if (loaded()) {
+    return cargo::bad_argument;
+  }
+  if (auto error = validate(bytes)) {
+    return error;
+  }
+  ImageHeader header;
+  std::memcpy(&header, image.data(), sizeof(header));
+  if (auto error = pages.allocate(header.memory_size)) {
+    return error;
+  }
+  // Writable segments are copied as they're fixed up anyway, the rest are
+  // mapped over the allocated pages. The pages are released as one range by
+  // PageRange, whichever way they were mapped.
+  for (uint32_t index = 0; index < header.segment_count; index++) {
+    const auto segment =
+        readEntry<ImageSegment>(image, header.segments_offset, index);
+    if (segment.protection & MEM_WRITABLE) {
+      std::copy_n(image.begin() + segment.file_offset, segment.file_size,
+                  pages.data().begin() + segment.address);
+    } else if (segment.file_size) {
+      void *address = mmap(pages.data().begin() + segment.address,
+                           segment.file_size, PROT_READ, MAP_PRIVATE | MAP_FIXED,
+                           fd, static_cast<off_t>(segment.file_offset));
+      if (MAP_FAILED == address) {
+        pages = PageRange();
+        return cargo::bad_alloc;
+      }
+    }
+  }
+  return link(imports);
+#endif
+}
+
+cargo::result loader::Image::link(const ImportList &imports) {
+  ImageHeader header;
+  std::memcpy(&header, image.data(), sizeof(header));
+  uint8_t *base = pages.data().begin();
+  const char *strings =
+      reinterpret_cast<const char *>(image.data() + header.strings_offset);
+
+  std::vector<uint64_t> addresses(header.import_count);
+  for (uint32_t index = 0; index < header.import_count; index++) {
+    const auto import =
+        readEntry<ImageImport>(image, header.imports_offset, index);
+    const cargo::string_view name{strings + import.name_offset,
+                                  import.name_size};
+    auto found = std::find_if(
+        imports.begin(), imports.end(),
+        [&name](const ImportList::value_type &i) { return i.first == name; });
+    if (found == imports.end()) {
+      pages = PageRange();
+      return cargo::unknown_error;
+    }
+    addresses[index] = found->second;
+    std::memcpy(base + import.slot, &found->second, sizeof(uint64_t));
+  }
+
+  for (uint32_t index = 0; index < header.fixup_count; index++) {
+    const auto fixup = readEntry<ImageFixup>(image, header.fixups_offset, index);
+    const uint64_t value =
+        (ImageFixup::BASE == fixup.import ? reinterpret_cast<uint64_t>(base)
+                                          : addresses[fixup.import]) +
+        static_cast<uint64_t>(fixup.addend);
+    std::memcpy(base + fixup.address, &value, sizeof(value));
+  }
+
+  for (uint32_t index = 0; index < header.segment_count; index++) {
+    const auto segment =
+        readEntry<ImageSegment>(image, header.segments_offset, index);
+#if defined(__GNUC__) || defined(__clang__)
+    if (segment.protection & MEM_EXECUTABLE) {
+      __builtin___clear_cache(
+          reinterpret_cast<char *>(base + segment.address),
+          reinterpret_cast<char *>(base + segment.address +
+                                   segment.memory_size));
+    }
+#endif
+    if (auto error = pages.protect(
+            static_cast<MemoryProtection>(segment.protection), segment.address,
+            segment.memory_size)) {
+      pages = PageRange();
+      return error;
+    }
+  }
+  return cargo::success;
+}
+
+cargo::optional<uint64_t> loader::Image::getSymbolAddress(
+    cargo::string_view name) const {
+  if (!loaded()) {
+    return cargo::nullopt;
+  }
+  ImageHeader header;
+  std::memcpy(&header, image.data(), sizeof(header));
+  const char *strings =
+      reinterpret_cast<const char *>(image.data() + header.strings_offset);
+  uint32_t first = 0;
+  uint32_t last = header.symbol_count;
+  while (first < last) {
+    const uint32_t middle = first + (last - first) / 2;
+    const auto symbol =
+        readEntry<ImageSymbol>(image, header.symbols_offset, middle);
+    const int order = cargo::string_view{strings + symbol.name_offset,
+                                         symbol.name_size}
+                          .compare(name);
+    if (0 == order) {
+      return reinterpret_cast<uint64_t>(pages.data().begin()) + symbol.address;
+    }
+    if (order < 0) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  return cargo::nullopt;
+}
+
+cargo::array_view<const uint8_t> loader::Image::metadata() const {
+  if (image.empty()) {
+    return {};
+  }
+  ImageHeader header;
+  std::memcpy(&header, image.data(), sizeof(header));
+  return {image.data() + header.metadata_offset,
+          static_cast<size_t>(header.metadata_size)};
+}
@@ -133,6 +133,19 @@ cargo::result loader::PageRange::protect(MemoryProtection protection) {
   if (pages_end == nullptr) {
     return cargo::bad_argument;
   }
+  return protect(protection, 0, pages_end - pages_begin);
+}
+
+cargo::result loader::PageRange::protect(MemoryProtection protection,
+                                         size_t offset, size_t size) {
+  if (pages_end == nullptr) {
+    return cargo::bad_argument;
+  }
+  if (offset % getPageSize() != 0 ||
+      size > static_cast<size_t>(pages_end - pages_begin) ||
+      offset > static_cast<size_t>(pages_end - pages_begin) - size) {
+    return cargo::bad_argument;
+  }
   if ((protection & (MEM_WRITABLE | MEM_EXECUTABLE)) ==
       (MEM_WRITABLE | MEM_EXECUTABLE)) {
     return cargo::bad_argument;
@@ -146,8 +159,8 @@ cargo::result loader::PageRange::protect(MemoryProtection protection) {
   vals[MEM_READABLE | MEM_WRITABLE] = PAGE_READWRITE;
   vals[MEM_READABLE | MEM_EXECUTABLE] = PAGE_EXECUTE_READ;
   DWORD oldProt;
-  if (VirtualProtect(pages_begin, pages_end - pages_begin, vals[protection],
-                     &oldProt) == 0) {
+  if (VirtualProtect(pages_begin + offset, size, vals[protection], &oldProt) ==
+      0) {
     return cargo::bad_alloc;
   }
 #else
@@ -160,7 +173,7 @@ cargo::result loader::PageRange::protect(MemoryProtection protection) {
   } else if (protection & MEM_EXECUTABLE) {
     prot |= PROT_EXEC;
   }
-  if (mprotect(pages_begin, pages_end - pages_begin, prot) < 0) {
+  if (mprotect(pages_begin + offset, size, prot) < 0) {
     return cargo::bad_alloc;
   }
 #endif
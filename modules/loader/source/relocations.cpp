@@ -251,8 +251,10 @@ static bool resolveX86_64(const loader::Relocation &r, loader::ElfMap &map) {
       break;
     }
     // 32-, 16- and 8-bit PC-relative relocations asserting their
-    // sign-extensions are valid
-    case R_X86_64_PC32: {
+    // sign-extensions are valid, calls through the PLT are resolved directly
+    // to the function as there is no PLT
+    case R_X86_64_PC32:
+    case R_X86_64_PLT32: {
       const uint64_t real_value =
           symbol_target_address - relocated_target_address;
       const uint32_t trunc_value = real_value & 0xFFFFFFFF;
@@ -0,0 +1,345 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <gtest/gtest.h>
+#include <loader/image.h>
+
+#include <cstring>
+#include <vector>
+
+#ifndef _WIN32
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Position independent x86_64 relocatable object compiled from:
+//
+//   extern long import_add(long, long);
+//   static long value = 40;
+//   long *value_ptr = &value;
+//   long call_import(long x) { return import_add(x, *value_ptr); }
+//   long get_value(void) { return value; }
+//   __attribute__((section("notes"), used))
+//   static const char metadata[] = "notes";
+//
+// with `gcc -c -O2 -fPIE -fno-asynchronous-unwind-tables -fno-ident
+// -fno-stack-protector` followed by `strip --strip-unneeded -R .comment
+// -R .note.GNU-stack`. It has PC-relative, PLT and absolute relocations, so
+// prelinking it exercises code, import stubs and fixups.
+const uint8_t x86_64_object[] = {
+    0x7f, 0x45, 0x4c, 0x46, 0x02, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x3e, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xe0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00,
+    0x0b, 0x00, 0x0a, 0x00, 0x48, 0x8b, 0x05, 0x00, 0x00, 0x00, 0x00, 0x48,
+    0x8b, 0x30, 0xe9, 0x00, 0x00, 0x00, 0x00, 0x90, 0x48, 0x8b, 0x05, 0x00,
+    0x00, 0x00, 0x00, 0xc3, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x6e, 0x6f, 0x74, 0x65, 0x73, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x12, 0x00, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x11, 0x00, 0x06, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x12, 0x00, 0x01, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x61, 0x6c, 0x6c, 0x5f, 0x69, 0x6d,
+    0x70, 0x6f, 0x72, 0x74, 0x00, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x5f, 0x70,
+    0x74, 0x72, 0x00, 0x69, 0x6d, 0x70, 0x6f, 0x72, 0x74, 0x5f, 0x61, 0x64,
+    0x64, 0x00, 0x67, 0x65, 0x74, 0x5f, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0xfc, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xfc, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0xfc, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x2e, 0x73, 0x79, 0x6d, 0x74, 0x61, 0x62,
+    0x00, 0x2e, 0x73, 0x74, 0x72, 0x74, 0x61, 0x62, 0x00, 0x2e, 0x73, 0x68,
+    0x73, 0x74, 0x72, 0x74, 0x61, 0x62, 0x00, 0x2e, 0x72, 0x65, 0x6c, 0x61,
+    0x2e, 0x74, 0x65, 0x78, 0x74, 0x00, 0x2e, 0x64, 0x61, 0x74, 0x61, 0x00,
+    0x2e, 0x62, 0x73, 0x73, 0x00, 0x6e, 0x6f, 0x74, 0x65, 0x73, 0x00, 0x2e,
+    0x72, 0x65, 0x6c, 0x61, 0x2e, 0x64, 0x61, 0x74, 0x61, 0x2e, 0x72, 0x65,
+    0x6c, 0x2e, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1b, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x26, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x58, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x2c, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x31, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3c, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x68, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x37, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x78, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x09, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x09, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2c, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x90, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x4c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+constexpr size_t e_type_offset = 16;
+constexpr size_t e_machine_offset = 18;
+
+long importAdd(long a, long b) { return a + b; }
+
+std::vector<uint8_t> objectBytes() {
+  return {std::begin(x86_64_object), std::end(x86_64_object)};
+}
+
+cargo::expected<std::vector<uint8_t>, cargo::result> prelink(
+    std::vector<uint8_t> object) {
+  loader::ElfFile file{{object.data(), object.size()}};
+  return loader::createImage(file, "notes");
+}
+
+const loader::Image::ImportList &imports() {
+  static const loader::Image::ImportList list = {
+      {"import_add", reinterpret_cast<uint64_t>(&importAdd)}};
+  return list;
+}
+}  // namespace
+
+TEST(LoaderImage, IsImage) {
+  EXPECT_FALSE(loader::isImage({}));
+  EXPECT_FALSE(loader::isImage({x86_64_object, sizeof(x86_64_object)}));
+
+  auto image = prelink(objectBytes());
+  ASSERT_TRUE(image.has_value());
+  EXPECT_TRUE(loader::isImage({image->data(), image->size()}));
+  EXPECT_FALSE(
+      loader::isImage({image->data(), sizeof(loader::ImageHeader) - 1}));
+}
+
+TEST(LoaderImage, CreateUnsupported) {
+  // Only relocatable files can be prelinked.
+  auto executable = objectBytes();
+  executable[e_type_offset] = 2;  // ET_EXEC
+  auto image = prelink(executable);
+  ASSERT_FALSE(image.has_value());
+  EXPECT_EQ(cargo::unsupported, image.error());
+
+  // Only x86_64 and AArch64 code can be prelinked.
+  auto riscv = objectBytes();
+  riscv[e_machine_offset] = 243;  // EM_RISCV
+  image = prelink(riscv);
+  ASSERT_FALSE(image.has_value());
+  EXPECT_EQ(cargo::unsupported, image.error());
+}
+
+TEST(LoaderImage, Metadata) {
+  auto image = prelink(objectBytes());
+  ASSERT_TRUE(image.has_value());
+  loader::ImageHeader header;
+  std::memcpy(&header, image->data(), sizeof(header));
+  ASSERT_EQ(6u, header.metadata_size);
+  ASSERT_LE(header.metadata_offset + header.metadata_size, image->size());
+  EXPECT_EQ(0, std::memcmp("notes", image->data() + header.metadata_offset,
+                           header.metadata_size));
+  EXPECT_EQ(1u, header.import_count);
+  EXPECT_EQ(0u, header.alignment % loader::getPageSize());
+}
+
+TEST(LoaderImage, Deterministic) {
+  auto first = prelink(objectBytes());
+  auto second = prelink(objectBytes());
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(*first, *second);
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+namespace {
+void checkLoaded(const loader::Image &image) {
+  ASSERT_TRUE(image.loaded());
+  auto get_value = image.getSymbolAddress("get_value");
+  auto call_import = image.getSymbolAddress("call_import");
+  auto value_ptr = image.getSymbolAddress("value_ptr");
+  ASSERT_TRUE(get_value.has_value());
+  ASSERT_TRUE(call_import.has_value());
+  ASSERT_TRUE(value_ptr.has_value());
+  EXPECT_FALSE(image.getSymbolAddress("value").has_value());
+  EXPECT_FALSE(image.getSymbolAddress("import_add").has_value());
+
+  // The fixup points `value_ptr` at `value` wherever the image was loaded.
+  long *value = *reinterpret_cast<long **>(*value_ptr);
+  EXPECT_EQ(40, *value);
+  EXPECT_EQ(40, reinterpret_cast<long (*)()>(*get_value)());
+  // The call goes through the import's stub.
+  EXPECT_EQ(42, reinterpret_cast<long (*)(long)>(*call_import)(2));
+  *value = 1;
+  EXPECT_EQ(1, reinterpret_cast<long (*)()>(*get_value)());
+  EXPECT_EQ(3, reinterpret_cast<long (*)(long)>(*call_import)(2));
+
+  auto metadata = image.metadata();
+  ASSERT_EQ(6u, metadata.size());
+  EXPECT_EQ(0, std::memcmp("notes", metadata.data(), metadata.size()));
+}
+}  // namespace
+
+TEST(LoaderImage, Load) {
+  auto bytes = prelink(objectBytes());
+  ASSERT_TRUE(bytes.has_value());
+  loader::Image image;
+  ASSERT_EQ(cargo::success,
+            image.load({bytes->data(), bytes->size()}, imports()));
+  checkLoaded(image);
+
+  // An image can only be loaded once.
+  EXPECT_EQ(cargo::bad_argument,
+            image.load({bytes->data(), bytes->size()}, imports()));
+
+  // Each load gets its own copy of the writable data.
+  loader::Image other;
+  ASSERT_EQ(cargo::success,
+            other.load({bytes->data(), bytes->size()}, imports()));
+  auto get_value = other.getSymbolAddress("get_value");
+  ASSERT_TRUE(get_value.has_value());
+  EXPECT_EQ(40, reinterpret_cast<long (*)()>(*get_value)());
+}
+
+TEST(LoaderImage, LoadMissingImport) {
+  auto bytes = prelink(objectBytes());
+  ASSERT_TRUE(bytes.has_value());
+  loader::Image image;
+  EXPECT_NE(cargo::success, image.load({bytes->data(), bytes->size()}, {}));
+  EXPECT_FALSE(image.loaded());
+  EXPECT_FALSE(image.getSymbolAddress("get_value").has_value());
+}
+
+TEST(LoaderImage, LoadInvalid) {
+  auto bytes = prelink(objectBytes());
+  ASSERT_TRUE(bytes.has_value());
+  loader::ImageHeader header;
+  std::memcpy(&header, bytes->data(), sizeof(header));
+
+  // Truncated images have tables or segments outside of the file.
+  {
+    loader::Image image;
+    EXPECT_EQ(cargo::bad_argument,
+              image.load({bytes->data(), sizeof(header)}, imports()));
+    EXPECT_FALSE(image.loaded());
+  }
+
+  // Images made for another machine are rejected.
+  {
+    auto foreign = *bytes;
+    loader::ImageHeader changed = header;
+    changed.machine = 243;  // EM_RISCV
+    std::memcpy(foreign.data(), &changed, sizeof(changed));
+    loader::Image image;
+    EXPECT_EQ(cargo::unsupported,
+              image.load({foreign.data(), foreign.size()}, imports()));
+  }
+
+  // Segments must be aligned in the file.
+  {
+    auto misaligned = *bytes;
+    loader::ImageSegment segment;
+    std::memcpy(&segment, misaligned.data() + header.segments_offset,
+                sizeof(segment));
+    segment.file_offset += 1;
+    std::memcpy(misaligned.data() + header.segments_offset, &segment,
+                sizeof(segment));
+    loader::Image image;
+    EXPECT_EQ(cargo::bad_argument,
+              image.load({misaligned.data(), misaligned.size()}, imports()));
+  }
+
+  // Fixups must point into writable data.
+  if (header.fixup_count) {
+    auto fixups = *bytes;
+    loader::ImageFixup fixup;
+    std::memcpy(&fixup, fixups.data() + header.fixups_offset, sizeof(fixup));
+    fixup.address = header.memory_size;
+    std::memcpy(fixups.data() + header.fixups_offset, &fixup, sizeof(fixup));
+    loader::Image image;
+    EXPECT_EQ(cargo::bad_argument,
+              image.load({fixups.data(), fixups.size()}, imports()));
+  }
+}
+
+#ifndef _WIN32
+TEST(LoaderImage, Map) {
+  auto bytes = prelink(objectBytes());
+  ASSERT_TRUE(bytes.has_value());
+
+  char path[] = "/tmp/UnitLoader.XXXXXX";
+  const int fd = mkstemp(path);
+  ASSERT_NE(-1, fd);
+  unlink(path);
+  ASSERT_EQ(static_cast<ssize_t>(bytes->size()),
+            write(fd, bytes->data(), bytes->size()));
+
+  loader::Image image;
+  const auto result = image.map(fd, {bytes->data(), bytes->size()}, imports());
+  close(fd);
+  ASSERT_EQ(cargo::success, result);
+  checkLoaded(image);
+}
+#endif
+#endif
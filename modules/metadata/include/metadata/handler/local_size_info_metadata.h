@@ -0,0 +1,90 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Handle Local Size Metadata.
+
+#ifndef MD_HANDLER_LOCAL_SIZE_INFO_METADATA_H_INCLUDED
+#define MD_HANDLER_LOCAL_SIZE_INFO_METADATA_H_INCLUDED
+#include <metadata/handler/vectorize_info_metadata.h>
+
+#include <array>
+
+namespace handler {
+/// @addtogroup md_handler
+/// @{
+
+/// @brief The block name used in the metadata API in which to store local size
+/// metadata.
+constexpr const char LOCAL_SIZE_MD_BLOCK_NAME[] = "LocalSizeMetadata";
+
+/// @brief Struct which holds the local size a kernel was compiled for, in
+/// addition to its vectorization metadata.
+struct LocalSizeInfoMetadata : VectorizeInfoMetadata {
+  LocalSizeInfoMetadata() = default;
+  LocalSizeInfoMetadata(VectorizeInfoMetadata md,
+                        std::array<uint64_t, 3> local_size)
+      : VectorizeInfoMetadata(std::move(md)), local_size(local_size) {}
+  /// @brief The only local size the kernel may be executed with, or all zeros
+  /// if the kernel may be executed with any local size.
+  std::array<uint64_t, 3> local_size = {0, 0, 0};
+};
+
+/// @brief LocalSizeInfoMetadataHandler handles interacting with the metadata
+/// API such that kernel metadata can be correctly read from and written to the
+/// binary representation.
+///
+/// Binaries written without local size metadata can still be read, every
+/// kernel in them may be executed with any local size.
+class LocalSizeInfoMetadataHandler : public VectorizeInfoMetadataHandler {
+ public:
+  virtual ~LocalSizeInfoMetadataHandler() override;
+
+  /// @brief Initialize the metadata context.
+  ///
+  /// @param hooks Hooks forwarded to the context.
+  /// @param userdata Userdata passed to the context.
+  /// @return true if the context is initialized successfully, false otherwise.
+  virtual bool init(md_hooks *hooks, void *userdata) override;
+
+  /// @brief Finalize the metadata context.
+  ///
+  /// @return true if finalized successfully, false otherwise.
+  virtual bool finalize() override;
+
+  /// @brief Read kernel metadata.
+  ///
+  /// @param[in, out] md Metadata struct to be filled in.
+  /// @return true if the data was read successfully, false otherwise.
+  bool read(LocalSizeInfoMetadata &md);
+
+  /// @brief Write kernel metadata.
+  ///
+  /// @param md The metadata to be written.
+  /// @return true if the write completed successfully, false otherwise.
+  bool write(const LocalSizeInfoMetadata &md);
+
+ private:
+  char *local_size_data = nullptr;
+  size_t local_size_data_len = 0;
+  size_t local_size_offset = 0;
+};
+
+/// @}
+}  // namespace handler
+
+#endif  // MD_HANDLER_LOCAL_SIZE_INFO_METADATA_H_INCLUDED
@@ -49,7 +49,7 @@ struct VectorizeInfoMetadata : GenericMetadata {
 /// @brief VectorizeInfoMetadataHandler handles interacting with the metadata
 /// API such that kernel metadata can be correctly read from and written to the
 /// binary representation.
-class VectorizeInfoMetadataHandler : GenericMetadataHandler {
+class VectorizeInfoMetadataHandler : protected GenericMetadataHandler {
  public:
   virtual ~VectorizeInfoMetadataHandler() override;
 
@@ -0,0 +1,112 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <metadata/detail/utils.h>
+#include <metadata/handler/local_size_info_metadata.h>
+
+namespace handler {
+
+LocalSizeInfoMetadataHandler::~LocalSizeInfoMetadataHandler() {
+  if (local_size_data) {
+    if (hooks && hooks->deallocate) {
+      hooks->deallocate(local_size_data, userdata);
+    } else {
+      std::free(local_size_data);
+    }
+  }
+}
+
+bool LocalSizeInfoMetadataHandler::init(md_hooks *hooks, void *userdata) {
+  if (!VectorizeInfoMetadataHandler::init(hooks, userdata)) {
+    return false;
+  }
+  md_stack local_size_stack = md_get_block(ctx, LOCAL_SIZE_MD_BLOCK_NAME);
+  if (hooks->map) {
+    // Older binaries have no local size block.
+    if (!local_size_stack) {
+      return true;
+    }
+    const int err = md_loadf(local_size_stack, "s", &local_size_data_len,
+                             &local_size_data);
+    if (MD_CHECK_ERR(err)) {
+      return false;
+    }
+  } else if (!local_size_stack) {
+    local_size_stack = md_create_block(ctx, LOCAL_SIZE_MD_BLOCK_NAME);
+    if (!local_size_stack) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LocalSizeInfoMetadataHandler::finalize() {
+  md_stack local_size_stack = md_get_block(ctx, LOCAL_SIZE_MD_BLOCK_NAME);
+  if (!local_size_stack) {
+    return false;
+  }
+  const int err = md_finalize_block(local_size_stack);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  return VectorizeInfoMetadataHandler::finalize();
+}
+
+bool LocalSizeInfoMetadataHandler::read(LocalSizeInfoMetadata &md) {
+  if (!VectorizeInfoMetadataHandler::read(md)) {
+    return false;
+  }
+  md.local_size = {0, 0, 0};
+  if (local_size_offset >= local_size_data_len) {
+    return true;
+  }
+  // A truncated block would be read past its end.
+  if (local_size_offset + md.local_size.size() * sizeof(uint64_t) >
+      local_size_data_len) {
+    return false;
+  }
+
+  uint8_t *ptr = reinterpret_cast<uint8_t *>(local_size_data) +
+                 local_size_offset;
+  for (auto &size : md.local_size) {
+    size = md::utils::read_value<uint64_t>(ptr, md_get_endianness(ctx));
+    ptr += sizeof(uint64_t);
+  }
+  local_size_offset += md.local_size.size() * sizeof(uint64_t);
+
+  return true;
+}
+
+bool LocalSizeInfoMetadataHandler::write(const LocalSizeInfoMetadata &md) {
+  if (!VectorizeInfoMetadataHandler::write(md)) {
+    return false;
+  }
+  md_stack local_size_stack = md_get_block(ctx, LOCAL_SIZE_MD_BLOCK_NAME);
+  if (!local_size_stack) {
+    return false;
+  }
+
+  for (const auto size : md.local_size) {
+    const int err = md_push_uint(local_size_stack, size);
+    if (MD_CHECK_ERR(err)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace handler
@@ -37,7 +37,7 @@ extern "C" {
 /// @brief Mux major version number.
 #define MUX_MAJOR_VERSION 0
 /// @brief Mux minor version number.
-#define MUX_MINOR_VERSION 81
+#define MUX_MINOR_VERSION 84
 /// @brief Mux patch version number.
 #define MUX_PATCH_VERSION 0
 /// @brief Mux combined version number.
@@ -617,6 +617,20 @@ enum mux_atomic_capabilities_e {
   mux_atomic_capabilities_64bit = 0x8
 };
 
+/// @brief Bitfield of all possible partitioning capabilities.
+///
+/// Each Mux device info struct has a member which denotes the ways in which the
+/// device can be partitioned into sub-devices with muxCreateSubDevices, as a
+/// bitfield of the following enum.
+enum mux_partition_capabilities_e {
+  /// @brief The device can be partitioned into sub-devices containing chosen
+  /// numbers of its compute units.
+  mux_partition_capabilities_compute_units = 0x1,
+  /// @brief The device can be partitioned into one sub-device per NUMA node
+  /// its compute units belong to.
+  mux_partition_capabilities_numa = 0x2
+};
+
 /// @brief Bitfield of all possible caching capabilities.
 ///
 /// Each Mux device struct has a member which denotes the caching capabilities
@@ -862,6 +876,36 @@ mux_result_t muxCreateDevices(uint64_t devices_length,
 /// @param[in] allocator_info Allocator information.
 void muxDestroyDevice(mux_device_t device, mux_allocator_info_t allocator_info);
 
+/// @brief Partition a device into sub-devices.
+///
+/// Each sub-device executes commands on a disjoint subset of the compute units
+/// of device, and is destroyed with muxDestroyDevice. Entry point is optional
+/// and must return mux_error_feature_unsupported if partition is not in
+/// `::mux_device_info_s::partition_capabilities`.
+///
+/// @param[in] device A Mux device to partition.
+/// @param[in] partition How to partition the device, a single bit of
+/// `::mux_device_info_s::partition_capabilities`.
+/// @param[in] counts_length The length of counts, must be 0 unless partition
+/// is `::mux_partition_capabilities_compute_units`.
+/// @param[in] counts Array of the number of compute units in each sub-device.
+/// @param[in] allocator_info Allocator information.
+/// @param[in] sub_devices_length The length of out_sub_devices. Must be 0, if
+/// out_sub_devices is null.
+/// @param[out] out_sub_devices Array of created sub-devices, or null if an
+/// error occurred. Can be null, if out_sub_devices_length is non-null.
+/// @param[out] out_sub_devices_length The number of sub-devices the partition
+/// results in. Can be null, if out_sub_devices is non-null.
+///
+/// @return mux_success, or a mux_error_* if an error occurred.
+mux_result_t muxCreateSubDevices(mux_device_t device,
+                                 mux_partition_capabilities_e partition,
+                                 uint32_t counts_length, const uint32_t *counts,
+                                 mux_allocator_info_t allocator_info,
+                                 uint32_t sub_devices_length,
+                                 mux_device_t *out_sub_devices,
+                                 uint32_t *out_sub_devices_length);
+
 /// @brief Allocate Mux device memory to be bound to a buffer or image.
 ///
 /// This function uses a Mux device to allocate device memory which can later be
@@ -2381,6 +2425,17 @@ struct mux_device_info_s {
   /// @brief List of sub-group sizes supported by the device, sized by
   /// num_sub_group_sizes.
   size_t *sub_group_sizes;
+  /// @brief The partitioning capabilities of this Mux device, a bitfield. A
+  /// target not supporting sub-devices must set this to `0`.
+  ///
+  /// @see mux_partition_capabilities_e
+  uint32_t partition_capabilities;
+  /// @brief The maximum number of sub-devices a device can be partitioned
+  /// into. A target not supporting sub-devices must set this to `0`.
+  uint32_t max_sub_devices;
+  /// @brief Boolean value indicating if OpenCL C pipes are supported by the
+  /// device, with the pipe storage allocated in device memory.
+  bool supports_pipes;
 };
 
 /// @brief Mux's device container.
@@ -2394,6 +2449,10 @@ struct mux_device_s {
   mux_id_t id;
   /// @brief The information associated with this device.
   mux_device_info_t info;
+  /// @brief The number of compute units this device executes on, equal to
+  /// `::mux_device_info_s::compute_units` unless the device is a sub-device
+  /// created by muxCreateSubDevices.
+  uint32_t compute_units;
 };
 
 /// @brief Description of the device memory requirements of a buffer or an
@@ -2590,6 +2649,9 @@ struct mux_ndrange_options_s {
   /// @brief The length of `global_offset` and `global_size` (if they are
   /// non-null).
   size_t dimensions;
+  /// @brief Is @p true if the kernel may access memory other than through the
+  /// buffers in `descriptors`, for example through pointers stored in memory.
+  bool indirect_memory_access;
 };
 
 /// @brief Mux's command buffer container.
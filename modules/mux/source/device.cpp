@@ -34,6 +34,32 @@ static uint64_t getTargetIndex(mux_id_t id) {
   return (mux_target_id_device_mask & id) - 1;
 }
 
+// Iterate over every type of queue, and every queue of that type for the
+// device.  We then 'get' that queue so as we can set the ID on it.  We can do
+// this here because although most objects are 'created' queues are not, we
+// are merely 'getting' them from the device.  The reason that we need to do
+// this here is that muxGetQueue must be thread-safe, but device creation is
+// not.  Therefore if we do setId in muxGetQueue we have a data-race because
+// two threads might be setting the value at once, but here we do not because
+// muxCreateDevices should never be called from two threads at once, and
+// sub-devices aren't visible to other threads until they have been created.
+static mux_result_t setQueueIds(mux_device_t device) {
+  for (unsigned queueTypeIndex = 0; queueTypeIndex < mux_queue_type_total;
+       queueTypeIndex++) {
+    const uint32_t numQueues = device->info->queue_types[queueTypeIndex];
+    for (uint32_t queueIndex = 0; queueIndex < numQueues; queueIndex++) {
+      mux_queue_t queue;
+      if (auto error =
+              muxGetQueue(device, static_cast<mux_queue_type_e>(queueTypeIndex),
+                          queueIndex, &queue)) {
+        return error;
+      }
+      mux::setId<mux_object_id_queue>(device->id, queue);
+    }
+  }
+  return mux_success;
+}
+
 mux_result_t muxGetDeviceInfos(uint32_t device_types,
                                uint64_t device_infos_length,
                                mux_device_info_t *out_device_infos,
@@ -217,35 +243,16 @@ mux_result_t muxCreateDevices(uint64_t devices_length,
     // select.h to select entry points which take mux_device_t as the
     // first argument.
     out_devices[deviceIndex]->id = device_infos[deviceIndex]->id;
-
-    // Iterate over every type of queue, and every queue of that type for
-    // this device.  We then 'get' that queue so as we can set the ID on it.
-    // We can do this here because although most objects are 'created' queues
-    // are not, we are merely 'getting' them from the device.  The reason
-    // that we need to do this here is that muxGetQueue must be thread-safe,
-    // but this function (muxCreateDevices) is not.  Therefore if we do
-    // setId in muxGetQueue we have a data-race because two threads might be
-    // setting the value at once, but here we do not because
-    // muxCreateDevices should never be called from two threads at once.
-    for (unsigned queueTypeIndex = 0; queueTypeIndex < mux_queue_type_total;
-         queueTypeIndex++) {
-      const uint32_t numQueues =
-          out_devices[deviceIndex]->info->queue_types[queueTypeIndex];
-      for (uint32_t queueIndex = 0; queueIndex < numQueues; queueIndex++) {
-        mux_queue_t queue;
-        if (auto error =
-                muxGetQueue(out_devices[deviceIndex],
-                            static_cast<mux_queue_type_e>(queueTypeIndex),
-                            queueIndex, &queue)) {
-          // If we failed to create any of the queues for any device then
-          // something went wrong.  We can't continue because we potentially
-          // have a device queue without an ID, so destroy the devices and
-          // return an error code.
-          cleanup_devices();
-          return error;
-        }
-        mux::setId<mux_object_id_queue>(out_devices[deviceIndex]->id, queue);
-      }
+    out_devices[deviceIndex]->compute_units =
+        device_infos[deviceIndex]->compute_units;
+
+    if (auto error = setQueueIds(out_devices[deviceIndex])) {
+      // If we failed to create any of the queues for any device then
+      // something went wrong.  We can't continue because we potentially
+      // have a device queue without an ID, so destroy the devices and
+      // return an error code.
+      cleanup_devices();
+      return error;
     }
   }
 
@@ -266,3 +273,80 @@ void muxDestroyDevice(mux_device_t device,
 
   muxSelectDestroyDevice(device, allocator_info);
 }
+
+mux_result_t muxCreateSubDevices(mux_device_t device,
+                                 mux_partition_capabilities_e partition,
+                                 uint32_t counts_length, const uint32_t *counts,
+                                 mux_allocator_info_t allocator_info,
+                                 uint32_t sub_devices_length,
+                                 mux_device_t *out_sub_devices,
+                                 uint32_t *out_sub_devices_length) {
+  const tracer::TraceGuard<tracer::Mux> guard(__func__);
+
+  if (mux::objectIsInvalid(device)) {
+    return mux_error_invalid_value;
+  }
+
+  if (0 == (device->info->partition_capabilities & partition)) {
+    return mux_error_feature_unsupported;
+  }
+
+  switch (partition) {
+    case mux_partition_capabilities_compute_units:
+      if (0 == counts_length || nullptr == counts ||
+          std::find(counts, counts + counts_length, 0u) !=
+              counts + counts_length) {
+        return mux_error_invalid_value;
+      }
+      break;
+    case mux_partition_capabilities_numa:
+      if (0 != counts_length) {
+        return mux_error_invalid_value;
+      }
+      break;
+    default:
+      return mux_error_invalid_value;
+  }
+
+  if (mux::allocatorInfoIsInvalid(allocator_info)) {
+    return mux_error_null_allocator_callback;
+  }
+
+  if ((nullptr == out_sub_devices) && (nullptr == out_sub_devices_length)) {
+    return mux_error_null_out_parameter;
+  }
+
+  if ((0 < sub_devices_length) && (nullptr == out_sub_devices)) {
+    return mux_error_null_out_parameter;
+  }
+
+  if (nullptr != out_sub_devices) {
+    std::fill_n(out_sub_devices, sub_devices_length, nullptr);
+  }
+
+  auto error = muxSelectCreateSubDevices(
+      device, partition, counts_length, counts, allocator_info,
+      sub_devices_length, out_sub_devices, out_sub_devices_length);
+  if (error || nullptr == out_sub_devices) {
+    return error;
+  }
+
+  // Sub-devices belong to the same target as their parent, so share its ID.
+  for (uint32_t index = 0; index < sub_devices_length; index++) {
+    if (out_sub_devices[index]) {
+      out_sub_devices[index]->id = device->id;
+      if (!error) {
+        error = setQueueIds(out_sub_devices[index]);
+      }
+    }
+  }
+  if (error) {
+    for (uint32_t index = 0; index < sub_devices_length; index++) {
+      if (out_sub_devices[index]) {
+        muxDestroyDevice(out_sub_devices[index], allocator_info);
+        out_sub_devices[index] = nullptr;
+      }
+    }
+  }
+  return error;
+}
@@ -60,8 +60,20 @@ struct buffer : mux_buffer_s {
   mux_result_t bind(mux_device_t device, mux::hal::memory *memory,
                     uint64_t offset);
 
+  /// @brief Record that a device command wrote to a range of the buffer.
+  ///
+  /// @param offset Offset in bytes of the range written.
+  /// @param size Size in bytes of the range written.
+  void invalidate(uint64_t offset, uint64_t size) {
+    if (memory) {
+      memory->invalidate(targetPtr - memory->targetPtr + offset, size);
+    }
+  }
+
   /// @brief Address of buffer on the target.
   ::hal::hal_addr_t targetPtr;
+  /// @brief Memory the buffer is bound to.
+  mux::hal::memory *memory;
 };
 }  // namespace hal
 }  // namespace mux
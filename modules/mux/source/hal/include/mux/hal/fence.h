@@ -21,9 +21,11 @@
 #ifndef MUX_HAL_FENCE_H_INCLUDED
 #define MUX_HAL_FENCE_H_INCLUDED
 
-#include <condition_variable>
+#include <atomic>
+#include <mutex>
 #include <type_traits>
 
+#include "cargo/eventcount.h"
 #include "cargo/expected.h"
 #include "mux/mux.h"
 #include "mux/utils/allocator.h"
@@ -65,9 +67,9 @@ struct fence : mux_fence_s {
 
  private:
   std::mutex mutex;
-  std::condition_variable condition_variable;
+  cargo::eventcount eventcount;
   mux_result_t result = mux_fence_not_ready;
-  bool completed = false;
+  std::atomic<bool> completed{false};
 };
 }  // namespace hal
 }  // namespace mux
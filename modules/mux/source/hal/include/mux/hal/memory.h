@@ -24,6 +24,7 @@
 #include "cargo/dynamic_array.h"
 #include "cargo/expected.h"
 #include "hal.h"
+#include "mux/hal/shadow_memory.h"
 #include "mux/mux.h"
 #include "mux/utils/allocator.h"
 
@@ -116,12 +117,21 @@ struct memory : mux_memory_s {
   /// @see muxUnmapMemory
   mux_result_t unmap(::hal::hal_device_t *device);
 
+  /// @brief Record that a device command wrote to a range of the memory, so
+  /// that the next mapping fetches it from the device again.
+  ///
+  /// @param offset Offset in bytes of the range written.
+  /// @param size Size in bytes of the range written.
+  void invalidate(uint64_t offset, uint64_t size);
+
   /// @brief Pointer to device memory
   ::hal::hal_addr_t targetPtr;
   /// @brief Pointer to memory of the CA host
   void *hostPtr;
   uint64_t mapOffset;
   cargo::dynamic_array<uint8_t> mappedMemory;
+  /// @brief Host copy used for mappings of the whole memory.
+  mux::hal::shadow_memory shadow;
 };
 }  // namespace hal
 }  // namespace mux
@@ -0,0 +1,169 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Host copy of HAL device memory with page granular tracking of the
+/// pages which need to be transferred.
+
+#ifndef MUX_HAL_SHADOW_MEMORY_H_INCLUDED
+#define MUX_HAL_SHADOW_MEMORY_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "hal.h"
+
+namespace mux {
+namespace hal {
+/// @brief Page aligned host copy of a device allocation used to service
+/// mappings.
+///
+/// Two bits are kept per page:
+/// * valid - the page holds the device contents as of the last transfer and
+///   no device command has written to it since, so `download` skips it.
+/// * dirty - the host may have written to the page since it was last
+///   uploaded, only dirty pages are written by `upload`, and `download` skips
+///   them so that host writes aren't lost.
+///
+/// Host writes are only tracked when `CA_HAL_TRACK_MAPPED_WRITES` is set, by
+/// write protecting clean pages and catching the resulting fault. Otherwise
+/// every page is considered dirty. Write protection is only available on
+/// Linux and macOS.
+///
+/// The shadows alive in the process are limited to `max_total_size` bytes in
+/// total, mappings beyond that use a temporary allocation instead.
+class shadow_memory {
+ public:
+  /// @brief Maximum total size in bytes of the shadows alive at once.
+  static constexpr uint64_t max_total_size = uint64_t(512) * 1024 * 1024;
+
+  shadow_memory() = default;
+  ~shadow_memory();
+
+  shadow_memory(const shadow_memory &) = delete;
+  shadow_memory &operator=(const shadow_memory &) = delete;
+
+  /// @brief Determine whether a mapping of `size` bytes should use a shadow.
+  ///
+  /// Small mappings are cheap to transfer in full, so are not worth the cost
+  /// of keeping a shadow alive between mappings.
+  static bool isWorthwhile(uint64_t size);
+
+  /// @brief Allocate the shadow, initially every page is clean and invalid.
+  ///
+  /// @param size Size in bytes of the device allocation being shadowed.
+  ///
+  /// @return Returns `true` on success, `false` on failure or if the shadow
+  /// would exceed `max_total_size`.
+  [[nodiscard]] bool create(uint64_t size);
+
+  /// @brief Returns `true` if the shadow has not been allocated.
+  bool empty() const { return nullptr == base; }
+
+  /// @brief Returns a pointer to the start of the shadow.
+  uint8_t *data() const { return base; }
+
+  /// @brief Update the shadow from the device, skipping valid pages.
+  ///
+  /// @param device HAL device owning the memory.
+  /// @param target Device address the shadow mirrors.
+  /// @param offset Offset in bytes of the range to update.
+  /// @param size Size in bytes of the range to update.
+  ///
+  /// @return Returns `true` on success, `false` otherwise.
+  [[nodiscard]] bool download(::hal::hal_device_t *device,
+                              ::hal::hal_addr_t target, uint64_t offset,
+                              uint64_t size);
+
+  /// @brief Update the device from the shadow, skipping clean pages.
+  ///
+  /// @param device HAL device owning the memory.
+  /// @param target Device address the shadow mirrors.
+  /// @param offset Offset in bytes of the range to update.
+  /// @param size Size in bytes of the range to update.
+  ///
+  /// @return Returns `true` on success, `false` otherwise.
+  [[nodiscard]] bool upload(::hal::hal_device_t *device,
+                            ::hal::hal_addr_t target, uint64_t offset,
+                            uint64_t size);
+
+  /// @brief Mark a range as written by the device.
+  ///
+  /// @param offset Offset in bytes of the range written.
+  /// @param size Size in bytes of the range written.
+  void invalidate(uint64_t offset, uint64_t size);
+
+  /// @brief Mark every page of every shadow in the process as written by the
+  /// device, for commands whose writes can't be attributed to a memory.
+  static void invalidateAll();
+
+  /// @brief Record a host write to a write protected page, called from the
+  /// fault handler.
+  ///
+  /// @param offset Offset in bytes of the faulting address.
+  ///
+  /// @return Returns `true` if the page was made writable.
+  bool recordWrite(uint64_t offset);
+
+ private:
+  using bitmap = std::unique_ptr<std::atomic<uint64_t>[]>;
+
+  static bool test(const bitmap &bits, uint64_t page) {
+    return bits[page / 64].load(std::memory_order_acquire) &
+           (uint64_t(1) << (page % 64));
+  }
+  static void set(bitmap &bits, uint64_t page) {
+    bits[page / 64].fetch_or(uint64_t(1) << (page % 64),
+                             std::memory_order_acq_rel);
+  }
+  static void clear(bitmap &bits, uint64_t page) {
+    bits[page / 64].fetch_and(~(uint64_t(1) << (page % 64)),
+                              std::memory_order_acq_rel);
+  }
+
+  /// @brief Returns one past the last page wholly before `end_byte`, the
+  /// trailing partial page counts when `end_byte` is the end of the shadow.
+  uint64_t lastFullPage(uint64_t end_byte) const {
+    return end_byte == shadow_size ? num_pages : end_byte / page_size;
+  }
+
+  /// @brief Change the protection of a run of pages, does nothing unless host
+  /// writes are being tracked.
+  void protect(uint64_t first, uint64_t count, bool writable);
+
+  /// @brief Link the shadow into the list of live shadows.
+  void link();
+  /// @brief Remove the shadow from the list of live shadows and release its
+  /// share of `max_total_size`.
+  void unlink();
+
+  uint8_t *base = nullptr;
+  shadow_memory *previous = nullptr;
+  shadow_memory *next = nullptr;
+  uint64_t shadow_size = 0;
+  uint64_t allocation_size = 0;
+  uint64_t page_size = 0;
+  uint64_t num_pages = 0;
+  bool track_writes = false;
+  bitmap valid;
+  bitmap dirty;
+};
+}  // namespace hal
+}  // namespace mux
+
+#endif  // MUX_HAL_SHADOW_MEMORY_H_INCLUDED
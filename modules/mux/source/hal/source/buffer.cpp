@@ -19,7 +19,7 @@
 namespace mux {
 namespace hal {
 buffer::buffer(mux_memory_requirements_s memory_requirements)
-    : targetPtr(::hal::hal_nullptr) {
+    : targetPtr(::hal::hal_nullptr), memory(nullptr) {
   this->memory_requirements = memory_requirements;
 }
 
@@ -27,6 +27,7 @@ mux_result_t buffer::bind(mux_device_t device, mux::hal::memory *memory,
                           uint64_t offset) {
   (void)device;
   targetPtr = memory->targetPtr + offset;
+  this->memory = memory;
   return mux_success;
 }
 }  // namespace hal
@@ -16,7 +16,10 @@
 
 #include <mux/hal/fence.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <limits>
 #include <mutex>
 
 #include "mux/mux.h"
@@ -26,36 +29,39 @@ namespace hal {
 fence::fence(mux_device_t device) { this->device = device; }
 
 void fence::signal(mux_result_t result) {
+  // The mutex is held until notification is done so that a waiter can't
+  // destroy the fence while it is still being signalled, see tryWait.
   const std::unique_lock<std::mutex> lock(mutex);
-  completed = true;
   this->result = result;
-  condition_variable.notify_all();
+  completed.store(true, std::memory_order_release);
+  eventcount.notify_all();
 }
 
 void fence::reset() {
   const std::scoped_lock lock(mutex);
-  completed = false;
+  completed.store(false, std::memory_order_relaxed);
   result = mux_fence_not_ready;
 }
 
 mux_result_t fence::tryWait(uint64_t timeout) {
-  std::unique_lock<std::mutex> lock(mutex);
+  auto signalled = [this] {
+    return completed.load(std::memory_order_acquire);
+  };
 
   // If timeout is UINT64_MAX, we need to wait on fence instead of timeout
   // value.
   if (timeout == UINT64_MAX) {
-    condition_variable.wait(lock, [this] { return completed; });
+    eventcount.wait(signalled);
+    const std::scoped_lock lock(mutex);
     return mux_success;
-  } else if ((mux_fence_not_ready == result) && timeout) {
+  } else if (timeout && !signalled()) {
     // If the fence isn't already signaled and there is a timeout then we need
-    // to try and wait.
-    // Clamp timeout to roughly one year (3e+16) in nanoseconds so we don't
-    // overflow chrono::steady_clock in the wait_for call.
-    timeout = std::min(timeout, static_cast<uint64_t>(0x6A94D74F430000));
-    auto duration = std::chrono::duration<uint64_t, std::nano>(timeout);
-    condition_variable.wait_for(lock, duration);
+    // to try and wait, spinning briefly before blocking.
+    timeout = std::min<uint64_t>(timeout, std::numeric_limits<int64_t>::max());
+    (void)eventcount.wait_for(signalled, std::chrono::nanoseconds(timeout));
   }
 
+  const std::scoped_lock lock(mutex);
   // Otherwise we just query the result directly.
   switch (result) {
     case mux_success:
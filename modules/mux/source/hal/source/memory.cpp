@@ -36,6 +36,14 @@ cargo::expected<void *, mux_result_t> memory::map(::hal::hal_device_t *device,
   if (hostPtr) {
     return static_cast<unsigned char *>(hostPtr) + offset;
   }
+  // Large mappings of the whole allocation go through the shadow, which is
+  // kept between mappings so that unchanged pages aren't transferred again.
+  if (0 == offset && this->size == size &&
+      mux::hal::shadow_memory::isWorthwhile(size)) {
+    if (!shadow.empty() || shadow.create(size)) {
+      return shadow.data();
+    }
+  }
   if (cargo::success != mappedMemory.alloc(size)) {
     return cargo::make_unexpected(mux_error_out_of_memory);
   }
@@ -49,15 +57,18 @@ mux_result_t memory::flushToDevice(::hal::hal_device_t *device, uint64_t offset,
   const uint8_t *src = nullptr;
   if (hostPtr) {
     src = static_cast<uint8_t *>(hostPtr) + offset;
-  } else {
-    if (mappedMemory.empty()) {
-      return mux_error_failure;
-    }
+  } else if (!mappedMemory.empty()) {
     src = mappedMemory.data() + offset - mapOffset;
+  } else if (!shadow.empty()) {
+    return shadow.upload(device, targetPtr, offset, size) ? mux_success
+                                                          : mux_error_failure;
+  } else {
+    return mux_error_failure;
   }
   if (!device->mem_write(targetPtr + offset, src, size)) {
     return mux_error_failure;
   }
+  shadow.invalidate(offset, size);
   return mux_success;
 }
 
@@ -67,11 +78,14 @@ mux_result_t memory::flushFromDevice(::hal::hal_device_t *device,
   uint8_t *dst = nullptr;
   if (hostPtr) {
     dst = static_cast<uint8_t *>(hostPtr) + offset;
-  } else {
-    if (mappedMemory.empty()) {
-      return mux_error_failure;
-    }
+  } else if (!mappedMemory.empty()) {
     dst = static_cast<uint8_t *>(mappedMemory.data()) + offset - mapOffset;
+  } else if (!shadow.empty()) {
+    return shadow.download(device, targetPtr, offset, size)
+               ? mux_success
+               : mux_error_failure;
+  } else {
+    return mux_error_failure;
   }
   if (!device->mem_read(dst, targetPtr + offset, size)) {
     return mux_error_failure;
@@ -82,9 +96,13 @@ mux_result_t memory::flushFromDevice(::hal::hal_device_t *device,
 // muxUnmapMemory
 mux_result_t memory::unmap(::hal::hal_device_t *device) {
   (void)device;
+  // The shadow, if any, outlives the mapping and is released with the memory.
   mappedMemory.clear();
   hostPtr = nullptr;
   return mux_success;
 }
+void memory::invalidate(uint64_t offset, uint64_t size) {
+  shadow.invalidate(offset, size);
+}
 }  // namespace hal
 }  // namespace mux
@@ -0,0 +1,378 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "mux/hal/shadow_memory.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define MUX_HAL_SHADOW_MEMORY_SUPPORTED
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace mux {
+namespace hal {
+namespace {
+// Mappings smaller than this are transferred in full.
+constexpr uint64_t shadow_threshold = 1024 * 1024;
+
+// Every live shadow, so that commands writing to unknown memory can invalidate
+// all of them, along with their total size.
+std::mutex live_mutex;
+shadow_memory *live_shadows = nullptr;
+uint64_t live_size = 0;
+
+#ifdef MUX_HAL_SHADOW_MEMORY_SUPPORTED
+bool isWriteTrackingEnabled() {
+  static const bool enabled = [] {
+    const char *env = std::getenv("CA_HAL_TRACK_MAPPED_WRITES");
+    return env && std::strcmp(env, "0") != 0;
+  }();
+  return enabled;
+}
+
+// Shadows with write tracking enabled, searched by the fault handler. The
+// handler may run on any thread at any time so the slots are lock free.
+struct region_s {
+  std::atomic<uintptr_t> begin{0};
+  std::atomic<uintptr_t> end{0};
+  std::atomic<shadow_memory *> shadow{nullptr};
+};
+constexpr size_t max_regions = 256;
+region_s regions[max_regions];
+std::mutex regions_mutex;
+
+struct sigaction previous_segv_action;
+struct sigaction previous_bus_action;
+
+void handleFault(int signal_number, siginfo_t *info, void *context) {
+  const auto address = reinterpret_cast<uintptr_t>(info->si_addr);
+  for (auto &region : regions) {
+    const uintptr_t begin = region.begin.load(std::memory_order_acquire);
+    if (begin && begin <= address &&
+        address < region.end.load(std::memory_order_acquire)) {
+      auto *shadow = region.shadow.load(std::memory_order_acquire);
+      if (shadow && shadow->recordWrite(address - begin)) {
+        return;
+      }
+    }
+  }
+  // Not a fault on a shadow, defer to whoever was handling it before us.
+  const struct sigaction &previous = signal_number == SIGSEGV
+                                         ? previous_segv_action
+                                         : previous_bus_action;
+  if (previous.sa_flags & SA_SIGINFO) {
+    previous.sa_sigaction(signal_number, info, context);
+  } else if (previous.sa_handler != SIG_DFL &&
+             previous.sa_handler != SIG_IGN) {
+    previous.sa_handler(signal_number);
+  } else {
+    // Returning re-executes the faulting instruction, which now gets the
+    // default behaviour.
+    signal(signal_number, SIG_DFL);
+  }
+}
+
+bool installFaultHandler() {
+  static const bool installed = [] {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = handleFault;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return 0 == sigaction(SIGSEGV, &action, &previous_segv_action) &&
+           0 == sigaction(SIGBUS, &action, &previous_bus_action);
+  }();
+  return installed;
+}
+
+bool registerRegion(shadow_memory *shadow, uint8_t *base, uint64_t size) {
+  const std::lock_guard<std::mutex> lock(regions_mutex);
+  for (auto &region : regions) {
+    if (nullptr == region.shadow.load(std::memory_order_acquire)) {
+      region.shadow.store(shadow, std::memory_order_release);
+      region.end.store(reinterpret_cast<uintptr_t>(base + size),
+                       std::memory_order_release);
+      region.begin.store(reinterpret_cast<uintptr_t>(base),
+                         std::memory_order_release);
+      return true;
+    }
+  }
+  return false;
+}
+
+void unregisterRegion(shadow_memory *shadow) {
+  const std::lock_guard<std::mutex> lock(regions_mutex);
+  for (auto &region : regions) {
+    if (shadow == region.shadow.load(std::memory_order_acquire)) {
+      region.begin.store(0, std::memory_order_release);
+      region.end.store(0, std::memory_order_release);
+      region.shadow.store(nullptr, std::memory_order_release);
+    }
+  }
+}
+#endif
+}  // namespace
+
+shadow_memory::~shadow_memory() {
+#ifdef MUX_HAL_SHADOW_MEMORY_SUPPORTED
+  if (base) {
+    if (track_writes) {
+      unregisterRegion(this);
+    }
+    unlink();
+    munmap(base, allocation_size);
+  }
+#endif
+}
+
+bool shadow_memory::isWorthwhile(uint64_t size) {
+#ifdef MUX_HAL_SHADOW_MEMORY_SUPPORTED
+  return size >= shadow_threshold;
+#else
+  (void)size;
+  return false;
+#endif
+}
+
+bool shadow_memory::create(uint64_t size) {
+#ifdef MUX_HAL_SHADOW_MEMORY_SUPPORTED
+  page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  num_pages = (size + page_size - 1) / page_size;
+  shadow_size = size;
+  allocation_size = num_pages * page_size;
+  {
+    // Each shadow keeps a host copy of its memory alive between mappings, so
+    // cap their total size rather than doubling the memory used.
+    const std::lock_guard<std::mutex> lock(live_mutex);
+    if (allocation_size > max_total_size - live_size) {
+      return false;
+    }
+    live_size += allocation_size;
+  }
+  const uint64_t num_words = (num_pages + 63) / 64;
+  valid.reset(new (std::nothrow) std::atomic<uint64_t>[num_words]);
+  dirty.reset(new (std::nothrow) std::atomic<uint64_t>[num_words]);
+  // Anonymous mappings are only backed by physical memory once touched, so
+  // pages which are never mapped by the user cost nothing.
+  void *allocation =
+      valid && dirty ? mmap(nullptr, allocation_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+                     : MAP_FAILED;
+  if (MAP_FAILED == allocation) {
+    const std::lock_guard<std::mutex> lock(live_mutex);
+    live_size -= allocation_size;
+    return false;
+  }
+  base = static_cast<uint8_t *>(allocation);
+  // Falling back to treating every page as dirty is always correct, so
+  // running out of regions isn't an error.
+  track_writes = isWriteTrackingEnabled() && installFaultHandler() &&
+                 registerRegion(this, base, allocation_size);
+  for (uint64_t word = 0; word < num_words; word++) {
+    valid[word].store(0, std::memory_order_relaxed);
+    dirty[word].store(track_writes ? 0 : ~uint64_t(0),
+                      std::memory_order_relaxed);
+  }
+  // Pages start clean and protected, so that host writes made before the
+  // first download, such as through a write-invalidate mapping, are caught.
+  protect(0, num_pages, /* writable */ false);
+  link();
+  return true;
+#else
+  (void)size;
+  return false;
+#endif
+}
+
+bool shadow_memory::download(::hal::hal_device_t *device,
+                             ::hal::hal_addr_t target, uint64_t offset,
+                             uint64_t size) {
+  const uint64_t end = offset + size;
+  const uint64_t last = (end + page_size - 1) / page_size;
+  // Dirty pages hold host writes which haven't been uploaded yet, so they are
+  // kept. Pages only partly covered by the range are dirty whether or not the
+  // host wrote to them, and the part in the range is still read.
+  const uint64_t range_first_full = (offset + page_size - 1) / page_size;
+  const uint64_t range_last_full = lastFullPage(end);
+  auto stale = [&](uint64_t page) {
+    const bool partial = page < range_first_full || page >= range_last_full;
+    return !test(valid, page) &&
+           (!track_writes || partial || !test(dirty, page));
+  };
+  for (uint64_t page = offset / page_size; page < last;) {
+    if (!stale(page)) {
+      page++;
+      continue;
+    }
+    uint64_t run_end = page + 1;
+    while (run_end < last && stale(run_end)) {
+      run_end++;
+    }
+    const uint64_t run_begin_byte = std::max(offset, page * page_size);
+    const uint64_t run_end_byte = std::min(end, run_end * page_size);
+    protect(page, run_end - page, /* writable */ true);
+    if (!device->mem_read(base + run_begin_byte, target + run_begin_byte,
+                          run_end_byte - run_begin_byte)) {
+      return false;
+    }
+    // Pages only partly covered by the range stay writable and dirty, another
+    // thread may be writing to the rest of the page through its own mapping.
+    const uint64_t first_full = (run_begin_byte + page_size - 1) / page_size;
+    const uint64_t last_full = lastFullPage(run_end_byte);
+    for (uint64_t partial = page; partial < run_end; partial++) {
+      if (partial < first_full || partial >= last_full) {
+        set(dirty, partial);
+      }
+    }
+    for (uint64_t full = first_full; full < last_full; full++) {
+      clear(dirty, full);
+      set(valid, full);
+    }
+    if (first_full < last_full) {
+      protect(first_full, last_full - first_full, /* writable */ false);
+    }
+    page = run_end;
+  }
+  return true;
+}
+
+bool shadow_memory::upload(::hal::hal_device_t *device,
+                           ::hal::hal_addr_t target, uint64_t offset,
+                           uint64_t size) {
+  const uint64_t end = offset + size;
+  const uint64_t last = (end + page_size - 1) / page_size;
+  // Without write tracking any page may have been written by the host.
+  auto modified = [&](uint64_t page) {
+    return !track_writes || test(dirty, page);
+  };
+  for (uint64_t page = offset / page_size; page < last;) {
+    if (!modified(page)) {
+      page++;
+      continue;
+    }
+    uint64_t run_end = page + 1;
+    while (run_end < last && modified(run_end)) {
+      run_end++;
+    }
+    const uint64_t run_begin_byte = std::max(offset, page * page_size);
+    const uint64_t run_end_byte = std::min(end, run_end * page_size);
+    // Clean pages are protected before their contents are written so that a
+    // host write racing with the upload faults and dirties the page again.
+    const uint64_t first_full = (run_begin_byte + page_size - 1) / page_size;
+    const uint64_t last_full = lastFullPage(run_end_byte);
+    if (track_writes) {
+      for (uint64_t full = first_full; full < last_full; full++) {
+        clear(dirty, full);
+      }
+      if (first_full < last_full) {
+        protect(first_full, last_full - first_full, /* writable */ false);
+      }
+    }
+    if (!device->mem_write(target + run_begin_byte, base + run_begin_byte,
+                           run_end_byte - run_begin_byte)) {
+      for (uint64_t full = first_full; full < last_full; full++) {
+        set(dirty, full);
+      }
+      return false;
+    }
+    for (uint64_t full = first_full; full < last_full; full++) {
+      set(valid, full);
+    }
+    page = run_end;
+  }
+  return true;
+}
+
+void shadow_memory::invalidate(uint64_t offset, uint64_t size) {
+  if (empty() || 0 == size) {
+    return;
+  }
+  const uint64_t first = offset / page_size;
+  const uint64_t last =
+      std::min(num_pages, (offset + size + page_size - 1) / page_size);
+  for (uint64_t page = first; page < last; page++) {
+    clear(valid, page);
+  }
+}
+
+void shadow_memory::invalidateAll() {
+  const std::lock_guard<std::mutex> lock(live_mutex);
+  for (shadow_memory *shadow = live_shadows; shadow; shadow = shadow->next) {
+    const uint64_t num_words = (shadow->num_pages + 63) / 64;
+    for (uint64_t word = 0; word < num_words; word++) {
+      shadow->valid[word].store(0, std::memory_order_release);
+    }
+  }
+}
+
+void shadow_memory::link() {
+  const std::lock_guard<std::mutex> lock(live_mutex);
+  next = live_shadows;
+  if (next) {
+    next->previous = this;
+  }
+  live_shadows = this;
+}
+
+void shadow_memory::unlink() {
+  const std::lock_guard<std::mutex> lock(live_mutex);
+  if (previous) {
+    previous->next = next;
+  } else {
+    live_shadows = next;
+  }
+  if (next) {
+    next->previous = previous;
+  }
+  live_size -= allocation_size;
+}
+
+bool shadow_memory::recordWrite(uint64_t offset) {
+#ifdef MUX_HAL_SHADOW_MEMORY_SUPPORTED
+  const uint64_t page = offset / page_size;
+  if (page >= num_pages) {
+    return false;
+  }
+  set(dirty, page);
+  return 0 == mprotect(base + page * page_size, page_size,
+                       PROT_READ | PROT_WRITE);
+#else
+  (void)offset;
+  return false;
+#endif
+}
+
+void shadow_memory::protect(uint64_t first, uint64_t count, bool writable) {
+#ifdef MUX_HAL_SHADOW_MEMORY_SUPPORTED
+  if (track_writes) {
+    mprotect(base + first * page_size, count * page_size,
+             writable ? PROT_READ | PROT_WRITE : PROT_READ);
+  }
+#else
+  (void)first;
+  (void)count;
+  (void)writable;
+#endif
+}
+}  // namespace hal
+}  // namespace mux
@@ -0,0 +1,256 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "mux/hal/shadow_memory.h"
+
+namespace {
+// State of the handler installed ahead of the shadow memory's fault handler,
+// to check faults outside of any shadow are passed on to it.
+volatile sig_atomic_t chained_faults = 0;
+void *chained_page = nullptr;
+long chained_page_size = 0;
+
+void chainedHandler(int, siginfo_t *info, void *) {
+  if (info->si_addr == chained_page) {
+    chained_faults = chained_faults + 1;
+    mprotect(chained_page, chained_page_size, PROT_READ | PROT_WRITE);
+    return;
+  }
+  std::abort();
+}
+
+// Write tracking is decided, and the fault handler installed, once per
+// process, so both must be set up before the first shadow is created.
+struct ShadowMemoryEnvironment : testing::Environment {
+  void SetUp() override {
+    setenv("CA_HAL_TRACK_MAPPED_WRITES", "1", 1);
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = chainedHandler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    ASSERT_EQ(0, sigaction(SIGSEGV, &action, nullptr));
+    ASSERT_EQ(0, sigaction(SIGBUS, &action, nullptr));
+  }
+};
+[[maybe_unused]] const auto *environment =
+    testing::AddGlobalTestEnvironment(new ShadowMemoryEnvironment);
+
+// A HAL device whose memory is a host vector starting at address zero, which
+// records the ranges written to it.
+class fake_hal_device_t final : public hal::hal_device_t {
+ public:
+  explicit fake_hal_device_t(size_t size)
+      : hal::hal_device_t(nullptr), memory(size) {}
+
+  hal::hal_kernel_t program_find_kernel(hal::hal_program_t,
+                                        const char *) override {
+    return hal::hal_invalid_kernel;
+  }
+  hal::hal_program_t program_load(const void *, hal::hal_size_t) override {
+    return hal::hal_invalid_program;
+  }
+  bool kernel_exec(hal::hal_program_t, hal::hal_kernel_t,
+                   const hal::hal_ndrange_t *, const hal::hal_arg_t *,
+                   uint32_t, uint32_t) override {
+    return false;
+  }
+  bool program_free(hal::hal_program_t) override { return false; }
+  hal::hal_addr_t mem_alloc(hal::hal_size_t, hal::hal_size_t) override {
+    return hal::hal_nullptr;
+  }
+  bool mem_free(hal::hal_addr_t) override { return false; }
+  bool mem_read(void *dst, hal::hal_addr_t src,
+                hal::hal_size_t size) override {
+    reads.emplace_back(src, size);
+    std::memcpy(dst, memory.data() + src, size);
+    return true;
+  }
+  bool mem_write(hal::hal_addr_t dst, const void *src,
+                 hal::hal_size_t size) override {
+    writes.emplace_back(dst, size);
+    std::memcpy(memory.data() + dst, src, size);
+    return true;
+  }
+
+  using range = std::pair<uint64_t, uint64_t>;
+  std::vector<uint8_t> memory;
+  std::vector<range> reads;
+  std::vector<range> writes;
+};
+
+struct ShadowMemoryTest : testing::Test {
+  using range = fake_hal_device_t::range;
+
+  void SetUp() override {
+    if (!mux::hal::shadow_memory::isWorthwhile(UINT64_MAX)) {
+      GTEST_SKIP();
+    }
+    for (size_t i = 0; i < device.memory.size(); i++) {
+      device.memory[i] = static_cast<uint8_t>(i);
+    }
+    ASSERT_TRUE(shadow.create(size));
+  }
+
+  static constexpr uint64_t num_pages = 4;
+  const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  const uint64_t size = num_pages * page_size;
+  fake_hal_device_t device{size};
+  mux::hal::shadow_memory shadow;
+};
+}  // namespace
+
+TEST_F(ShadowMemoryTest, DownloadSkipsValidPages) {
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  EXPECT_EQ(std::vector<range>{range(0, size)}, device.reads);
+  EXPECT_EQ(0, std::memcmp(device.memory.data(), shadow.data(), size));
+
+  device.reads.clear();
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  EXPECT_TRUE(device.reads.empty());
+
+  // Only pages the device wrote to are read again.
+  shadow.invalidate(page_size + 1, 1);
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  EXPECT_EQ(std::vector<range>{range(page_size, page_size)}, device.reads);
+}
+
+TEST_F(ShadowMemoryTest, TracksWrites) {
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  ASSERT_TRUE(shadow.upload(&device, 0, 0, size));
+  EXPECT_TRUE(device.writes.empty());
+
+  // Writing to a clean page faults and marks only that page dirty.
+  shadow.data()[(2 * page_size) + 3] = 0xAB;
+  ASSERT_TRUE(shadow.upload(&device, 0, 0, size));
+  EXPECT_EQ(std::vector<range>{range(2 * page_size, page_size)},
+            device.writes);
+  EXPECT_EQ(0xAB, device.memory[(2 * page_size) + 3]);
+  EXPECT_EQ(0, chained_faults);
+}
+
+TEST_F(ShadowMemoryTest, UploadRestoresProtection) {
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  shadow.data()[page_size] = 1;
+  ASSERT_TRUE(shadow.upload(&device, 0, 0, size));
+  device.writes.clear();
+
+  // Once uploaded the page is protected again, so the next write to it is
+  // also caught.
+  shadow.data()[page_size] = 2;
+  shadow.data()[page_size + 1] = 3;
+  ASSERT_TRUE(shadow.upload(&device, 0, 0, size));
+  EXPECT_EQ(std::vector<range>{range(page_size, page_size)}, device.writes);
+  EXPECT_EQ(2, device.memory[page_size]);
+  EXPECT_EQ(3, device.memory[page_size + 1]);
+}
+
+TEST_F(ShadowMemoryTest, PartialPagesStayDirty) {
+  // A range which doesn't cover a whole page leaves it writable and dirty,
+  // the rest of the page may be written through another mapping.
+  ASSERT_TRUE(shadow.download(&device, 0, page_size / 2, page_size));
+  EXPECT_EQ(std::vector<range>{range(page_size / 2, page_size)},
+            device.reads);
+  ASSERT_TRUE(shadow.upload(&device, 0, 0, 2 * page_size));
+  EXPECT_EQ(std::vector<range>{range(0, 2 * page_size)}, device.writes);
+}
+
+TEST_F(ShadowMemoryTest, DownloadKeepsDirtyPages) {
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  shadow.data()[page_size] = 0xAB;
+  shadow.invalidate(0, size);
+  device.memory[page_size] = 0xCD;
+  device.reads.clear();
+
+  // The host's write hasn't been uploaded, so the page isn't read over it.
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  EXPECT_EQ((std::vector<range>{range(0, page_size),
+                                range(2 * page_size, 2 * page_size)}),
+            device.reads);
+  EXPECT_EQ(0xAB, shadow.data()[page_size]);
+  ASSERT_TRUE(shadow.upload(&device, 0, 0, size));
+  EXPECT_EQ(0xAB, device.memory[page_size]);
+}
+
+TEST_F(ShadowMemoryTest, TracksWritesBeforeDownload) {
+  // A write-invalidate mapping writes to the shadow without downloading it,
+  // only the written page is uploaded.
+  shadow.data()[2 * page_size] = 0xAB;
+  ASSERT_TRUE(shadow.upload(&device, 0, 0, size));
+  EXPECT_EQ(std::vector<range>{range(2 * page_size, page_size)},
+            device.writes);
+  EXPECT_EQ(0xAB, device.memory[2 * page_size]);
+}
+
+TEST_F(ShadowMemoryTest, InvalidateAll) {
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  device.reads.clear();
+  mux::hal::shadow_memory::invalidateAll();
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  EXPECT_EQ(std::vector<range>{range(0, size)}, device.reads);
+}
+
+TEST_F(ShadowMemoryTest, LimitsTotalSize) {
+  mux::hal::shadow_memory other;
+  EXPECT_FALSE(other.create(mux::hal::shadow_memory::max_total_size));
+  EXPECT_TRUE(other.empty());
+  // The size of a shadow which failed to be created isn't counted.
+  EXPECT_TRUE(other.create(mux::hal::shadow_memory::max_total_size - size));
+}
+
+TEST_F(ShadowMemoryTest, DestroyUnregistersRegion) {
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+  {
+    mux::hal::shadow_memory other;
+    ASSERT_TRUE(other.create(size));
+    ASSERT_TRUE(other.download(&device, 0, 0, size));
+    other.data()[0] = 0xCD;
+    ASSERT_TRUE(other.upload(&device, 0, 0, page_size));
+    EXPECT_EQ(0xCD, device.memory[0]);
+  }
+  // The remaining shadow is still tracked once the other is unmapped.
+  device.writes.clear();
+  shadow.data()[3 * page_size] = 0xEF;
+  ASSERT_TRUE(shadow.upload(&device, 0, 0, size));
+  EXPECT_EQ(std::vector<range>{range(3 * page_size, page_size)},
+            device.writes);
+}
+
+TEST_F(ShadowMemoryTest, ChainsToPreviousHandler) {
+  // Creating a shadow with write tracking installs the fault handler.
+  ASSERT_TRUE(shadow.download(&device, 0, 0, size));
+
+  chained_page_size = static_cast<long>(page_size);
+  chained_page = mmap(nullptr, page_size, PROT_READ,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(MAP_FAILED, chained_page);
+  chained_faults = 0;
+  *static_cast<volatile uint8_t *>(chained_page) = 1;
+  EXPECT_EQ(1, chained_faults);
+  EXPECT_EQ(0, munmap(chained_page, page_size));
+  chained_page = nullptr;
+}
@@ -23,10 +23,13 @@
 #include "host/builtin_kernel.h"
 #include "host/queue.h"
 #include "host/thread_pool.h"
+#include "host/topology.h"
 #include "mux/mux.h"
 
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
 #include "host/papi_counter.h"
+#else
+#include "host/perf_counter.h"
 #endif
 
 namespace host {
@@ -108,7 +111,17 @@ struct device_s final : public mux_device_s {
   ///
   /// @param info The device info associated with this device.
   /// @param allocator The mux allocator to use for allocations.
-  explicit device_s(device_info_s *info, mux_allocator_info_t allocator);
+  /// @param affinity CPUs the device runs on, a sub-device runs on a subset
+  /// of its parent's CPUs.
+  explicit device_s(device_info_s *info, mux_allocator_info_t allocator,
+                    cpu_affinity_s affinity);
+
+  /// @brief CPUs the thread pool runs on.
+  cpu_affinity_s affinity;
+
+  /// @brief NUMA node memory allocated for the device is placed on, if all of
+  /// its CPUs belong to one node.
+  cargo::optional<uint32_t> numa_node;
 
   /// @brief The thread-pool providing multi-threaded execution.
   thread_pool_s thread_pool;
@@ -20,12 +20,14 @@
 #ifndef HOST_EXECUTABLE_H_INCLUDED
 #define HOST_EXECUTABLE_H_INCLUDED
 
+#include <array>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "host/utils/jit_kernel.h"
 #include "loader/elf.h"
+#include "loader/image.h"
 #include "loader/mapper.h"
 #include "mux/mux.h"
 #include "mux/utils/dynamic_array.h"
@@ -53,6 +55,9 @@ struct binary_kernel_s {
   /// Note that the last sub-group in a work-group may be smaller than this
   /// value. If one, denotes a trivial sub-group.
   uint32_t sub_group_size;
+  /// @brief The only local size the kernel may be executed with, or all zeros
+  /// if it may be executed with any local size.
+  std::array<uint64_t, 3> local_size = {0, 0, 0};
 };
 
 using kernel_variant_map =
@@ -78,6 +83,19 @@ struct executable_s final : public mux_executable_s {
                mux::small_vector<loader::PageRange, 4> allocated_pages,
                host::kernel_variant_map binary_kernels);
 
+  /// @brief Create an executable from a prelinked image.
+  ///
+  /// @param[in] device Mux device.
+  /// @param[in] image_contents Contents of the image, which @p image refers
+  /// to.
+  /// @param[in] image Image loaded from @p image_contents.
+  /// @param[in] binary_kernels Binary kernel map, with hooks which are looked
+  /// up in @p image when a kernel is created.
+  /// @param[in] allocator Allocator for the executable's members.
+  executable_s(mux_device_t device, mux::dynamic_array<uint64_t> image_contents,
+               loader::Image image, host::kernel_variant_map binary_kernels,
+               mux::allocator allocator);
+
   /// @brief Deleted copy constructor.
   ///
   /// This is because 'kernels' may contain a pointer to the data contained
@@ -107,7 +125,7 @@ struct executable_s final : public mux_executable_s {
   /// that kernel.
   std::string jit_kernel_name;
 
-  /// @brief ELF binary this executable was created from.
+  /// @brief ELF binary or image this executable was created from.
   mux::dynamic_array<uint64_t> elf_contents;
 
   /// @brief Pages allocated by our ELF loader for the binary.
@@ -116,6 +134,12 @@ struct executable_s final : public mux_executable_s {
   /// these.
   mux::small_vector<loader::PageRange, 4> allocated_pages;
 
+  /// @brief Prelinked image this executable was loaded from, if any.
+  ///
+  /// Only the symbols of kernels which are created are looked up in the image,
+  /// so the hooks of its binary kernels are zero.
+  loader::Image image;
+
   /// @brief Map of kernel names to binary kernels contained in this executable.
   kernel_variant_map kernels;
 };
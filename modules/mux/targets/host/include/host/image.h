@@ -40,6 +40,9 @@ struct image_s final : public mux_image_s {
 
 #ifdef HOST_IMAGE_SUPPORT
   libimg::HostImage image;
+  /// @brief Layout to store the image in when bound to device allocated memory,
+  /// images bound to host memory are always linear.
+  libimg::UInt boundLayout;
 #endif
 };
 
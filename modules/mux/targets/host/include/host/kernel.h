@@ -27,6 +27,8 @@
 #include <mux/mux.h>
 #include <mux/utils/allocator.h>
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -41,6 +43,9 @@ struct schedule_info_s final {
   size_t slice;
   size_t total_slices;
   uint32_t work_dim;
+  /// @brief Next free byte of the executing thread's local memory arena,
+  /// which the kernel allocates its local memory from.
+  void *local_memory;
 };
 
 struct kernel_variant_s {
@@ -67,6 +72,9 @@ struct kernel_variant_s {
   uint32_t min_work_width = 0;
   uint32_t pref_work_width = 0;
   uint32_t sub_group_size = 0;
+  /// @brief The only local size this variant may be executed with, as it was
+  /// compiled for it, or all zeros if it may be executed with any local size.
+  std::array<size_t, 3> local_size = {0, 0, 0};
 };
 
 struct kernel_s final : public mux_kernel_s {
@@ -98,6 +106,13 @@ struct kernel_s final : public mux_kernel_s {
   mux_allocator_info_t allocator_info;
 
   cargo::small_vector<kernel_variant_s, 4> variant_data;
+
+  /// @brief Estimate of the nanoseconds a thread takes to execute one
+  /// work-group of the kernel, learned from previous ND-ranges, or zero if
+  /// the kernel hasn't been executed yet.
+  ///
+  /// Used to choose how many threads to split an ND-range between.
+  std::atomic<uint64_t> group_time{0};
 };
 
 /// @}
@@ -23,10 +23,15 @@
 
 #include <mux/mux.h>
 
+#include <cstdint>
+#include <memory>
+
 namespace host {
 /// @addtogroup host
 /// @{
 
+struct image_s;
+
 struct memory_s : public mux_memory_s {
   enum heap_e : uint32_t {
     HEAP_ALL = 0x1 << 0,
@@ -38,6 +43,13 @@ struct memory_s : public mux_memory_s {
 
   void *data;
   bool useHost;
+  /// @brief Image bound to this memory which is not stored in linear layout.
+  ///
+  /// While mapped the host sees a linear copy of the image in `linearData`,
+  /// which is converted to and from the image's layout when flushed.
+  image_s *tiledImage = nullptr;
+  /// @brief Linear copy of `tiledImage`, only allocated while mapped.
+  std::unique_ptr<uint8_t[]> linearData;
 };
 
 /// @}
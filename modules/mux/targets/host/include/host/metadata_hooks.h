@@ -20,6 +20,7 @@
 
 #ifndef MUX_HOST_METADATA_HOOKS_H_INCLUDED
 #define MUX_HOST_METADATA_HOOKS_H_INCLUDED
+#include <cargo/array_view.h>
 #include <cargo/optional.h>
 #include <cargo/string_view.h>
 #include <host/executable.h>
@@ -31,6 +32,11 @@ constexpr const char MD_NOTES_SECTION[] = "notes";
 cargo::optional<kernel_variant_map> readBinaryMetadata(loader::ElfFile *elf,
                                                        mux::allocator *alloc);
 
+/// @brief Reads the kernels' metadata from the contents of a notes section,
+/// such as the metadata of a prelinked image.
+cargo::optional<kernel_variant_map> readBinaryMetadata(
+    cargo::array_view<const uint8_t> notes, mux::allocator *alloc);
+
 }  // namespace host
 
 #endif  // MUX_HOST_METADATA_HOOKS_H_INCLUDED
@@ -0,0 +1,199 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+/// Host's built-in performance counters, used when PAPI isn't enabled, and
+/// profiling of the slices of ND-ranges.
+
+#ifndef HOST_PERF_COUNTER_H_INCLUDED
+#define HOST_PERF_COUNTER_H_INCLUDED
+
+#include <mux/mux.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace host {
+/// @addtogroup host
+/// @{
+
+/// @brief Counters host can report without PAPI, used as their UUIDs.
+///
+/// The hardware counters are read with `perf_event_open` on Linux and are only
+/// reported when the kernel allows this process to open them, see
+/// `/proc/sys/kernel/perf_event_paranoid`. The scheduling counters are
+/// measured by host itself so are always available.
+enum perf_counter_e : uint32_t {
+  /// @brief CPU cycles spent executing kernels.
+  perf_counter_cycles,
+  /// @brief Instructions retired executing kernels.
+  perf_counter_instructions,
+  /// @brief Last level cache misses executing kernels.
+  perf_counter_cache_misses,
+  /// @brief Mispredicted branches executing kernels.
+  perf_counter_branch_misses,
+  /// @brief Wall time spent executing slices, summed over all threads.
+  perf_counter_slice_time,
+  /// @brief Wall time of the longest slice.
+  perf_counter_max_slice_time,
+  /// @brief Percentage of the thread pool's time spent idle during kernels.
+  perf_counter_load_imbalance,
+  /// @brief Mean wall time of a slice.
+  perf_counter_mean_slice_time,
+  /// @brief Ratio of the longest slice of each kernel to its mean slice.
+  perf_counter_slice_imbalance,
+  /// @brief Wall time of kernels not covered by any slice, spent handing the
+  /// slices to the thread pool and waiting for them to finish.
+  perf_counter_handshake_time,
+  /// @brief Number of counters, not a counter.
+  perf_counter_total
+};
+
+/// @brief Number of counters in `perf_counter_e` read from the hardware.
+constexpr uint32_t perf_hardware_counter_count = 4;
+
+/// @brief Description of a built-in counter.
+struct perf_counter_s {
+  /// @brief UUID of the counter.
+  perf_counter_e uuid;
+  /// @brief Short name of the counter.
+  const char *name;
+  /// @brief Category of the counter.
+  const char *category;
+  /// @brief Description of the counter.
+  const char *description;
+  /// @brief Unit of measurement of the counter.
+  mux_query_counter_unit_e unit;
+  /// @brief Data storage type of the counter.
+  mux_query_counter_storage_e storage;
+  /// @brief Number of hardware counters taken up by this counter.
+  uint32_t hardware_counters;
+
+  /// @brief Populate a `mux_query_counter_s` with this counter's info.
+  ///
+  /// @param out_query_counter Counter struct to populate.
+  void populateMuxQueryCounter(mux_query_counter_s *out_query_counter) const {
+    out_query_counter->unit = unit;
+    out_query_counter->storage = storage;
+    out_query_counter->uuid = uuid;
+    out_query_counter->hardware_counters = hardware_counters;
+  }
+
+  /// @brief Populate a `mux_query_counter_description_s` with this counter's
+  /// info.
+  ///
+  /// @param out_description Counter description struct to populate.
+  void populateMuxQueryCounterDescription(
+      mux_query_counter_description_s *out_description) const {
+    std::strncpy(out_description->name, name, 256);
+    std::strncpy(out_description->category, category, 256);
+    std::strncpy(out_description->description, description, 256);
+  }
+};
+
+/// @brief Returns the built-in counters supported on this system.
+///
+/// Probes which hardware counters can be opened the first time it's called.
+const std::vector<perf_counter_s> &supportedPerfCounters();
+
+/// @brief Snapshot of the calling thread's counters.
+struct perf_sample_s {
+  /// @brief Values of the hardware counters, indexed by `perf_counter_e`.
+  ///
+  /// Counters which aren't supported read as zero.
+  uint64_t hardware[perf_hardware_counter_count];
+  /// @brief Time of the sample in nanoseconds.
+  uint64_t timestamp;
+
+  /// @brief Sample the calling thread's counters.
+  ///
+  /// The first sample taken on a thread opens its hardware counters, which
+  /// then count that thread until it exits.
+  ///
+  /// @param hardware Whether to read the hardware counters, or only take a
+  /// timestamp.
+  static perf_sample_s read(bool hardware = true);
+};
+
+/// @brief Timing of one slice of an ND-range.
+struct slice_record_s {
+  /// @brief Time the slice started in nanoseconds.
+  uint64_t start;
+  /// @brief Time the slice ended in nanoseconds.
+  uint64_t end;
+  /// @brief Index of the thread which executed the slice, see
+  /// `currentThreadIndex`.
+  uint32_t thread;
+};
+
+/// @brief Load balance statistics of one ND-range.
+struct range_profile_s {
+  /// @brief Time from handing the slices to the thread pool until they had
+  /// all finished.
+  uint64_t wall_time;
+  /// @brief Time spent executing slices, summed over slices.
+  uint64_t slice_time;
+  /// @brief Time spent executing the longest slice.
+  uint64_t max_slice_time;
+  /// @brief Mean time spent executing a slice.
+  uint64_t mean_slice_time;
+  /// @brief Time before the first slice started and after the last slice
+  /// ended.
+  uint64_t handshake_time;
+  /// @brief Fraction of the thread pool's time during the ND-range spent
+  /// outside of its slices.
+  double idle_fraction;
+  /// @brief Number of distinct threads which executed slices.
+  uint32_t threads;
+
+  /// @brief Compute the statistics of an ND-range from its slices.
+  ///
+  /// @param records Timing of each slice of the ND-range.
+  /// @param count Number of slices.
+  /// @param begin Time the slices were handed to the thread pool.
+  /// @param end Time all the slices had finished.
+  /// @param thread_count Number of threads in the thread pool.
+  static range_profile_s compute(const slice_record_s *records, size_t count,
+                                 uint64_t begin, uint64_t end,
+                                 size_t thread_count);
+};
+
+/// @brief Returns whether every ND-range should record the timing of its
+/// slices to the tracer output.
+///
+/// Enabled by setting the `CA_HOST_PROFILE_SLICES` environment variable to a
+/// non-zero value. The tracer must also be enabled, see `CA_TRACE_FILE`.
+bool sliceProfilingEnabled();
+
+/// @brief Returns an index which identifies the calling thread within the
+/// process.
+uint32_t currentThreadIndex();
+
+/// @brief Record a slice to the tracer output, from the thread which executed
+/// it.
+void traceSlice(const slice_record_s &record);
+
+/// @brief Record the statistics of an ND-range to the tracer output.
+///
+/// @param profile Statistics of the ND-range.
+/// @param begin Time the slices were handed to the thread pool.
+void traceRange(const range_profile_s &profile, uint64_t begin);
+
+/// @}
+}  // namespace host
+
+#endif  // HOST_PERF_COUNTER_H_INCLUDED
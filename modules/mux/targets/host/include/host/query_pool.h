@@ -26,11 +26,14 @@
 #include <host/host.h>
 #include <mux/utils/allocator.h>
 
+#include <atomic>
 #include <cassert>
 #include <mutex>
 
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
 #include <pthread.h>
+#else
+#include <host/perf_counter.h>
 #endif
 
 namespace host {
@@ -58,6 +61,30 @@ struct host_papi_event_info_s {
   /// @brief Buffer to store the results read from the event set.
   host_query_counter_result_s *result_buffer;
 };
+#else
+/// @brief Totals of the built-in counters accumulated by a query pool.
+struct host_perf_totals_s {
+  /// @brief Hardware counter totals, indexed by `perf_counter_e`.
+  std::atomic<uint64_t> hardware[perf_hardware_counter_count];
+  /// @brief Time spent executing slices, summed over all threads.
+  std::atomic<uint64_t> slice_time;
+  /// @brief Time spent executing the longest slice.
+  std::atomic<uint64_t> max_slice_time;
+  /// @brief Wall time of each kernel multiplied by the number of threads
+  /// which could have executed it, summed over kernels.
+  std::atomic<uint64_t> available_time;
+  /// @brief Number of slices executed.
+  std::atomic<uint64_t> slice_count;
+  /// @brief Time spent executing the longest slice of each kernel, summed
+  /// over kernels.
+  std::atomic<uint64_t> range_max_slice_time;
+  /// @brief Mean time spent executing a slice of each kernel, summed over
+  /// kernels.
+  std::atomic<uint64_t> range_mean_slice_time;
+  /// @brief Time of each kernel not covered by any of its slices, summed over
+  /// kernels.
+  std::atomic<uint64_t> handshake_time;
+};
 #endif
 
 /// @brief Pool of storage for query results.
@@ -115,6 +142,32 @@ struct query_pool_s final : mux_query_pool_s {
   /// from.
   mux_result_t readPapiResults(mux_query_counter_result_s *results,
                                size_t result_count, size_t query_index);
+#else
+  /// @brief Accumulate the counters of a slice of a kernel which ran while a
+  /// query on this pool was active.
+  ///
+  /// Called concurrently by every thread executing the kernel.
+  ///
+  /// @param start Sample taken by the thread before the slice.
+  /// @param end Sample taken by the thread after the slice.
+  void accumulateSlice(const perf_sample_s &start, const perf_sample_s &end);
+
+  /// @brief Accumulate the statistics of a kernel which ran while a query on
+  /// this pool was active, once all its slices have finished.
+  ///
+  /// @param profile Statistics of the kernel's slices.
+  /// @param thread_count Number of threads the kernel was split across.
+  void accumulateRange(const range_profile_s &profile, size_t thread_count);
+
+  /// @brief Read the built-in counter results.
+  ///
+  /// @param results Pointer to array of `result_count`
+  /// `mux_query_counter_result_s` structs to return the results in.
+  /// @param result_count Number results to read out.
+  /// @param query_index Offset into the pool's query slots to start reading
+  /// from.
+  mux_result_t readPerfResults(mux_query_counter_result_s *results,
+                               size_t result_count, size_t query_index);
 #endif
 
   /// @brief Reset the query pool result storage to zeros.
@@ -141,6 +194,14 @@ struct query_pool_s final : mux_query_pool_s {
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   /// @brief The event sets created for this query pool, one per worker thread.
   cargo::array_view<host_papi_event_info_s> papi_event_infos;
+#else
+  /// @brief Zero the counter totals.
+  void resetPerfTotals();
+
+  /// @brief Counter totals, shared by every query in the pool.
+  host_perf_totals_s *perf_totals = nullptr;
+  /// @brief The UUID of the counter of each query slot.
+  uint32_t *perf_uuids = nullptr;
 #endif
 
   /// @brief Pointer to memory used to store query result data.
@@ -23,8 +23,11 @@
 #include <mux/mux.h>
 #include <mux/utils/small_vector.h>
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
 
 namespace host {
@@ -92,6 +95,45 @@ struct queue_s final : public mux_queue_s {
       signalInfos;
 };
 
+/// @brief ND-ranges expected to take fewer nanoseconds than this run on the
+/// thread dispatching them, as handing them to the thread pool would take
+/// longer.
+constexpr uint64_t inline_ndrange_time = 20000;
+
+/// @brief Minimum nanoseconds of work in each slice of an ND-range, so that
+/// the cost of waking a thread for a slice is amortized.
+constexpr uint64_t min_slice_time = 10000;
+
+/// @brief Choose how many slices to split an ND-range into.
+///
+/// Slices divide the work-groups in the first dimension between them, so
+/// there is never any use for more slices than those. Beyond that the number
+/// of slices is chosen so that each slice has enough work to be worth waking a
+/// thread for, based on how long the kernel's work-groups took previously.
+///
+/// @param group_time Estimated nanoseconds a work-group of the kernel takes,
+/// or zero if the kernel hasn't been executed yet.
+/// @param groups Number of work-groups in each dimension.
+/// @param max_slices Number of slices which would occupy every thread.
+///
+/// @return Returns the number of slices, where one slice is executed on the
+/// calling thread.
+size_t chooseSlices(uint64_t group_time, const std::array<size_t, 3> &groups,
+                    size_t max_slices);
+
+/// @brief Update the estimate of the time a kernel's work-group takes.
+///
+/// @param group_time Previous estimate in nanoseconds, or zero if there was
+/// none.
+/// @param groups Number of work-groups in each dimension.
+/// @param slices Number of slices the ND-range was split into.
+/// @param time Nanoseconds the ND-range took.
+///
+/// @return Returns the new estimate in nanoseconds.
+uint64_t updateGroupTime(uint64_t group_time,
+                         const std::array<size_t, 3> &groups, size_t slices,
+                         uint64_t time);
+
 /// @}
 }  // namespace host
 
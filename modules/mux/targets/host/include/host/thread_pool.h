@@ -34,7 +34,9 @@
 #include <unistd.h>
 #endif
 
+#include "cargo/eventcount.h"
 #include "cargo/thread.h"
+#include "host/topology.h"
 #include "tracer/tracer.h"
 
 namespace host {
@@ -55,7 +57,11 @@ struct thread_pool_work_item_s final {
 };
 
 struct thread_pool_s final {
-  explicit thread_pool_s();
+  /// @brief Constructor.
+  ///
+  /// @param affinity CPUs to run the pool's threads on, when pinned there is
+  /// one thread per CPU.
+  explicit thread_pool_s(const cpu_affinity_s &affinity);
 
   ~thread_pool_s();
 
@@ -119,16 +125,8 @@ struct thread_pool_s final {
 
         while (queue_read_index == next_write_index) {
           // We've entirely filled our work buffer! Need to wait until a space
-          // opens so unlock the queue mutex, acquire the wait mutex, notify the
-          // pool that some work needs doing and wait for an item to complete.
-          {
-            std::unique_lock<std::mutex> wait_guard(wait_mutex);
-            lock.unlock();
-            new_work.notify_one();
-            done_work.wait(wait_guard);
-            lock.lock();
-          }
-
+          // opens.
+          waitForSpace(lock);
           next_write_index = (queue_write_index + 1) % queue_max;
         }
 
@@ -160,6 +158,10 @@ struct thread_pool_s final {
   std::map<cargo::thread::id, pid_t> thread_ids;
 #endif
 
+  /// @brief Wait for a slot in the work queue to become free.
+  /// @param[in,out] lock Lock holding `mutex`, released while waiting.
+  void waitForSpace(std::unique_lock<std::mutex> &lock);
+
   /// @brief Wait for a signal to complete.
   /// @param[in,out] signal A signal that previously was passed to a call to
   /// enqueue, wait() will wait on the thread that is executing the work to
@@ -193,17 +195,12 @@ struct thread_pool_s final {
   /// A mutex to use when accessing the thread pool.
   std::mutex mutex;
 
-  /// A mutex to use when decrementing the work counter.
-  std::mutex wait_mutex;
-
   /// A condition to signal when new work has been added.
   std::condition_variable new_work;
 
-  /// A condition to signal when work has been done.
-  std::condition_variable done_work;
-
-  /// A condition to signal when the count reaches zero.
-  std::condition_variable finished;
+  /// Notified whenever a work item completes, used to wait for signals and
+  /// counters passed to enqueue.
+  cargo::eventcount completed;
 
   /// A variable to query whether the thread pool is still alive or not.
   std::atomic<bool> stayAlive;
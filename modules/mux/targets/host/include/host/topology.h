@@ -0,0 +1,84 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+/// Host's CPU and NUMA topology, used to partition the host device.
+
+#ifndef HOST_TOPOLOGY_H_INCLUDED
+#define HOST_TOPOLOGY_H_INCLUDED
+
+#include <cargo/optional.h>
+#include <cargo/thread.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace host {
+/// @addtogroup host
+/// @{
+
+/// @brief A logical CPU the host device can run on.
+struct cpu_s {
+  /// @brief Operating system index of the CPU.
+  uint32_t id;
+  /// @brief NUMA node the CPU belongs to.
+  uint32_t node;
+};
+
+/// @brief The CPUs a host device runs its thread pool on.
+struct cpu_affinity_s {
+  /// @brief CPUs ordered by NUMA node, then by index.
+  std::vector<cpu_s> cpus;
+  /// @brief Whether each thread of the pool is pinned to one of `cpus`.
+  bool pinned = false;
+
+  /// @brief Returns the NUMA node all of `cpus` belong to, if they're pinned
+  /// and share one.
+  cargo::optional<uint32_t> node() const;
+};
+
+/// @brief Returns the CPUs this process may run on, ordered by NUMA node and
+/// then by index so that consecutive CPUs share memory where possible.
+const std::vector<cpu_s> &availableCpus();
+
+/// @brief Returns the CPUs of the root host device.
+///
+/// By default this is every available CPU, unpinned. The `CA_HOST_AFFINITY`
+/// environment variable restricts the root device to `numa:<node>`, or to a
+/// list of CPUs such as `0-7,16`, pinning its threads.
+const cpu_affinity_s &rootAffinity();
+
+/// @brief Returns the number of NUMA nodes `cpus` span.
+uint32_t countNodes(const std::vector<cpu_s> &cpus);
+
+/// @brief Pin a thread to a single CPU.
+///
+/// @return Returns `true` on success, `false` if pinning is unsupported or
+/// failed.
+bool pinThread(cargo::thread &thread, uint32_t cpu);
+
+/// @brief Ask the operating system to place the untouched pages of a range of
+/// memory on a NUMA node.
+///
+/// Only pages wholly inside the range are affected, this is a hint so does
+/// nothing where NUMA placement is unsupported.
+void preferNode(void *pointer, size_t size, uint32_t node);
+
+/// @}
+}  // namespace host
+
+#endif  // HOST_TOPOLOGY_H_INCLUDED
@@ -29,11 +29,14 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <limits>
 #include <memory>
 #include <new>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #ifdef __linux__
 #include <sys/sysinfo.h>
@@ -172,8 +175,38 @@ static uint64_t os_memory_total_size() {
 #endif
 }
 
-static uint64_t os_cache_size() {
-// we query the L1 cache on all platforms, arbitrarily chosen
+#ifdef __linux__
+/// @brief Read a file describing one of the caches of the first CPU.
+///
+/// @param index Index of the cache.
+/// @param name Name of the file.
+/// @param data Buffer to read the null-terminated contents of the file into.
+/// @param size Size of `data` in bytes.
+///
+/// @return Returns true if the file was read, false otherwise.
+static bool read_cache_file(uint32_t index, const char *name, char *data,
+                            size_t size) {
+  char path[128];
+  (void)snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu0/cache/index%u/%s",
+                 static_cast<unsigned>(index), name);
+  FILE *const file = fopen(path, "r");
+  if (nullptr == file) {
+    return false;
+  }
+  const size_t bytes_read = fread(data, 1, size - 1, file);
+  (void)fclose(file);
+  data[bytes_read] = '\0';
+  return 0 != bytes_read;
+}
+#endif
+
+/// @brief Query the size of a data cache of the first CPU.
+///
+/// @param level Level of the cache, 1 or 2.
+///
+/// @return Returns the size in bytes, or 0 if it couldn't be queried.
+static uint64_t os_cache_size(uint32_t level) {
 #if defined(_MSC_VER) || defined(__MINGW32__) || defined(__MINGW64__)
   DWORD length = 0;
   PSYSTEM_LOGICAL_PROCESSOR_INFORMATION buffer = nullptr;
@@ -195,7 +228,8 @@ static uint64_t os_cache_size() {
       default:
         break;
       case RelationCache:
-        if (1 == buffer[i].Cache.Level) {
+        if (level == buffer[i].Cache.Level &&
+            CacheInstruction != buffer[i].Cache.Type) {
           return buffer[i].Cache.Size;
         }
     }
@@ -203,39 +237,40 @@ static uint64_t os_cache_size() {
 
   return 0;
 #elif defined(__APPLE__)
-  // query the L1 cache size by name, name documented in
+  // query the cache size by name, names documented in
   // https://opensource.apple.com/source/xnu/xnu-792.12.6/libkern/libkern/sysctl.h
-  uint64_t l1dcachesize = 0;
+  uint64_t cachesize = 0;
   size_t size = sizeof(uint64_t);
-  if (sysctlbyname("hw.l1dcachesize", &l1dcachesize, &size, nullptr, 0)) {
+  if (sysctlbyname(1 == level ? "hw.l1dcachesize" : "hw.l2cachesize",
+                   &cachesize, &size, nullptr, 0)) {
     return 0;
   }
-  return l1dcachesize;
+  return cachesize;
 #elif defined(__linux__)
-  // open the cache size file for reading
-  FILE *const file =
-      fopen("/sys/devices/system/cpu/cpu0/cache/index0/size", "r");
-
-  // did we open the file successfully
-  if (nullptr == file) {
-    return 0;
-  }
-
-  // data from the file
-  char data[256];
-
-  // read the contents of the cache file
-  const size_t bytes_read = fread(data, sizeof(data), 1, file);
-
-  if (sizeof(data) < bytes_read) {
-    assert(0 && "Reading from the cache file failed!");
+  // each cache is described by an indexN directory, in no particular order, so
+  // find the data or unified cache of the requested level
+  for (uint32_t index = 0;; index++) {
+    char data[256];
+    if (!read_cache_file(index, "level", data, sizeof(data))) {
+      return 0;
+    }
+    if (level != static_cast<uint32_t>(atoi(data))) {
+      continue;
+    }
+    if (!read_cache_file(index, "type", data, sizeof(data))) {
+      return 0;
+    }
+    if (0 == strncmp(data, "Instruction", strlen("Instruction"))) {
+      continue;
+    }
+    if (!read_cache_file(index, "size", data, sizeof(data))) {
+      return 0;
+    }
+    // caches are described in kilobytes, so multiply the cache size
+    return static_cast<uint64_t>(atoi(data)) * 1024;
   }
-
-  (void)fclose(file);
-
-  // caches are described in kilobytes, so multiply the cache size
-  return static_cast<uint64_t>(atoi(data)) * 1024;
 #elif defined(__MCOS_POSIX__)
+  (void)level;
   return 0;
 #else
 #error Unknown platform!
@@ -265,7 +300,8 @@ static uint64_t os_cacheline_size() {
       default:
         break;
       case RelationCache:
-        if (1 == buffer[i].Cache.Level) {
+        if (1 == buffer[i].Cache.Level &&
+            CacheInstruction != buffer[i].Cache.Type) {
           return buffer[i].Cache.LineSize;
         }
     }
@@ -312,6 +348,25 @@ static uint64_t os_cacheline_size() {
 #endif
 }
 
+/// @brief Get the size of local memory to report.
+///
+/// Local memory is allocated from an arena owned by each thread, so is
+/// limited only by how much of it stays in cache. Defaults to 64 KiB, which
+/// can be changed with the `CA_HOST_LOCAL_MEMORY_SIZE` environment variable,
+/// in KiB, up to the size of the L2 cache. OpenCL requires at least 32 KiB.
+static uint64_t local_memory_size(bool native) {
+  constexpr uint64_t min_size = 32L * 1024L;
+  constexpr uint64_t default_size = 64L * 1024L;
+  const uint64_t max_size =
+      std::max(default_size, native ? os_cache_size(2) : 0);
+  const char *env = std::getenv("CA_HOST_LOCAL_MEMORY_SIZE");
+  if (nullptr == env || 0 >= std::atoi(env)) {
+    return default_size;
+  }
+  return std::clamp<uint64_t>(static_cast<uint64_t>(std::atoi(env)) * 1024,
+                              min_size, max_size);
+}
+
 /// @brief The size of this systems memory in bytes, bounded by pointer size.
 ///
 /// The function is like @p os_memory_total_size, but it will bound the
@@ -325,20 +380,6 @@ static uint64_t os_memory_bounded_size() {
              : std::numeric_limits<size_t>::max();
 }
 
-static uint32_t os_num_cpus() {
-#if defined(__linux__) || defined(__APPLE__)
-  return static_cast<uint32_t>(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN)));
-#elif defined(_MSC_VER) || defined(__MINGW32__) || defined(__MINGW64__)
-  SYSTEM_INFO sysinfo;
-  GetSystemInfo(&sysinfo);
-  return static_cast<uint32_t>(sysinfo.dwNumberOfProcessors);
-#elif defined(__MCOS_POSIX__)
-  return emcos::get_num_cpus();
-#else
-#error Unknown platform!
-#endif
-}
-
 namespace host {
 device_info_s::device_info_s()
     : device_info_s(detectHostArch(), detectHostOS(), /* native */ true,
@@ -433,7 +474,21 @@ device_info_s::device_info_s(host::arch arch, host::os os, bool native,
   // of a better alternative, if we cannot figure it out, choose 1.
   this->clock_frequency =
       std::max<uint32_t>(native ? os_cpu_frequency() : 0, 1);
-  this->compute_units = native ? os_num_cpus() : 0;
+  // Each CPU the root device may run on is a compute unit, CA_HOST_AFFINITY
+  // can restrict these.
+  this->compute_units =
+      native ? static_cast<uint32_t>(rootAffinity().cpus.size()) : 0;
+  this->partition_capabilities = 0;
+  this->max_sub_devices = 0;
+  if (native) {
+    // Sub-devices are carved out of the CPUs of the root device.
+    if (this->compute_units > 1) {
+      this->partition_capabilities =
+          mux_partition_capabilities_compute_units |
+          mux_partition_capabilities_numa;
+      this->max_sub_devices = this->compute_units;
+    }
+  }
   this->buffer_alignment = sizeof(uint64_t) * 16;
   // TODO Reported memory size is quartered (rounded up) in order to pass the
   // OpenCL CTS however this probably should be an OCL specific fix and not in
@@ -441,11 +496,11 @@ device_info_s::device_info_s(host::arch arch, host::os os, bool native,
   this->memory_size = native ? ((os_memory_bounded_size() - 1) / 4) + 1 : 0;
   // All memory could be allocated at once.
   this->allocation_size = this->memory_size;
-  this->cache_size = native ? os_cache_size() : 0;
+  // we report the L1 cache on all platforms, arbitrarily chosen
+  this->cache_size = native ? os_cache_size(1) : 0;
   this->cacheline_size = native ? os_cacheline_size() : 0;
 
-  // See redmine #4947
-  this->shared_local_memory_size = 32L * 1024L;
+  this->shared_local_memory_size = local_memory_size(native);
 
   // default to 128 bit (16 bytes)
   this->native_vector_width = 128 / (8 * sizeof(uint8_t));
@@ -524,7 +579,13 @@ device_info_s::device_info_s(host::arch arch, host::os os, bool native,
     this->max_hardware_counters = 0;
   }
 #else
-  this->query_counter_support = false;
+  // Scheduling counters are always available, hardware counters depend on
+  // what the kernel lets this process open.
+  this->query_counter_support = true;
+  this->max_hardware_counters = 0;
+  for (const auto &counter : supportedPerfCounters()) {
+    this->max_hardware_counters += counter.hardware_counters;
+  }
 #endif
   this->descriptors_updatable = true;
   this->can_clone_command_buffers = true;
@@ -532,6 +593,10 @@ device_info_s::device_info_s(host::arch arch, host::os os, bool native,
   this->sub_groups_support_ifp = false;
   this->supports_work_group_collectives = true;
   this->supports_generic_address_space = true;
+  // Pipe reservation IDs pack the first packet and the packet count of a
+  // reservation into a pointer, which needs 64 bits.
+  this->supports_pipes =
+      0 != (this->address_capabilities & mux_address_capabilities_bits64);
 
   // A list of sub-group sizes we report. Roughly ordered according to
   // desirability.
@@ -589,9 +654,14 @@ host::device_info_s &device_info_s::getHostInstance() {
   return device_info;
 }
 
-device_s::device_s(device_info_s *info, mux_allocator_info_t allocator_info)
-    : queue(allocator_info, this) {
+device_s::device_s(device_info_s *info, mux_allocator_info_t allocator_info,
+                   cpu_affinity_s affinity)
+    : affinity(std::move(affinity)),
+      numa_node(this->affinity.node()),
+      thread_pool(this->affinity),
+      queue(allocator_info, this) {
   this->info = info;
+  this->compute_units = static_cast<uint32_t>(this->affinity.cpus.size());
 }
 
 }  // namespace host
@@ -637,7 +707,8 @@ mux_result_t hostCreateDevices(uint64_t devices_length,
   }
 
   out_devices[0] = new (allocation)
-      host::device_s(&host::device_info_s::getHostInstance(), allocator);
+      host::device_s(&host::device_info_s::getHostInstance(), allocator,
+                     host::rootAffinity());
 
   return mux_success;
 }
@@ -647,3 +718,65 @@ void hostDestroyDevice(mux_device_t device,
   mux::allocator allocator(allocator_info);
   allocator.destroy(static_cast<host::device_s *>(device));
 }
+
+mux_result_t hostCreateSubDevices(mux_device_t device,
+                                  mux_partition_capabilities_e partition,
+                                  uint32_t counts_length,
+                                  const uint32_t *counts,
+                                  mux_allocator_info_t allocator_info,
+                                  uint32_t sub_devices_length,
+                                  mux_device_t *out_sub_devices,
+                                  uint32_t *out_sub_devices_length) {
+  auto *host_device = static_cast<host::device_s *>(device);
+  const auto &cpus = host_device->affinity.cpus;
+
+  // Divide the device's CPUs into runs, as CPUs are ordered by NUMA node each
+  // run shares as few nodes as possible.
+  std::vector<host::cpu_affinity_s> partitions;
+  if (mux_partition_capabilities_numa == partition) {
+    for (size_t index = 0; index < cpus.size(); index++) {
+      if (0 == index || cpus[index].node != cpus[index - 1].node) {
+        partitions.emplace_back();
+        partitions.back().pinned = true;
+      }
+      partitions.back().cpus.push_back(cpus[index]);
+    }
+  } else {
+    size_t first = 0;
+    for (uint32_t index = 0; index < counts_length; index++) {
+      if (counts[index] > cpus.size() - first) {
+        return mux_error_invalid_value;
+      }
+      partitions.emplace_back();
+      partitions.back().pinned = true;
+      partitions.back().cpus.assign(cpus.begin() + first,
+                                    cpus.begin() + first + counts[index]);
+      first += counts[index];
+    }
+  }
+
+  if (nullptr != out_sub_devices_length) {
+    *out_sub_devices_length = static_cast<uint32_t>(partitions.size());
+  }
+  if (nullptr == out_sub_devices) {
+    return mux_success;
+  }
+  if (sub_devices_length < partitions.size()) {
+    return mux_error_invalid_value;
+  }
+
+  mux::allocator allocator(allocator_info);
+  for (size_t index = 0; index < partitions.size(); index++) {
+    out_sub_devices[index] = allocator.create<host::device_s>(
+        static_cast<host::device_info_s *>(device->info), allocator_info,
+        std::move(partitions[index]));
+    if (nullptr == out_sub_devices[index]) {
+      for (size_t created = 0; created < index; created++) {
+        hostDestroyDevice(out_sub_devices[created], allocator_info);
+        out_sub_devices[created] = nullptr;
+      }
+      return mux_error_out_of_memory;
+    }
+  }
+  return mux_success;
+}
@@ -21,12 +21,25 @@
 #include <host/metadata_hooks.h>
 #include <host/utils/jit_kernel.h>
 #include <host/utils/relocations.h>
+#include <loader/image.h>
 #include <loader/relocations.h>
 #include <mux/utils/allocator.h>
 #include <utils/system.h>
 
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <new>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 host::executable_s::executable_s(mux_device_t device,
                                  utils::jit_kernel_s kernel,
@@ -52,6 +65,159 @@ host::executable_s::executable_s(
   this->device = device;
 }
 
+host::executable_s::executable_s(mux_device_t device,
+                                 mux::dynamic_array<uint64_t> image_contents,
+                                 loader::Image image,
+                                 kernel_variant_map binary_kernels,
+                                 mux::allocator allocator)
+    : elf_contents(std::move(image_contents)),
+      allocated_pages(allocator),
+      image(std::move(image)),
+      kernels(std::move(binary_kernels)) {
+  this->device = device;
+}
+
+namespace {
+#ifdef __linux__
+/// @brief Checks whether a file holds exactly the bytes of an image.
+///
+/// The file's size and image header, which holds a hash of the whole image,
+/// are checked first so that a stale or different file is rejected without
+/// reading it all.
+bool fileContains(int fd, cargo::array_view<const uint8_t> bytes) {
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<uint64_t>(info.st_size) != bytes.size()) {
+    return false;
+  }
+  loader::ImageHeader header;
+  if (pread(fd, &header, sizeof(header), 0) !=
+          static_cast<ssize_t>(sizeof(header)) ||
+      0 != std::memcmp(&header, bytes.data(), sizeof(header))) {
+    return false;
+  }
+  // The code is about to be executed, so the whole file must match, not just
+  // its hash.
+  void *contents = mmap(nullptr, bytes.size(), PROT_READ, MAP_SHARED, fd, 0);
+  if (MAP_FAILED == contents) {
+    return false;
+  }
+  const bool equal = 0 == std::memcmp(contents, bytes.data(), bytes.size());
+  (void)munmap(contents, bytes.size());
+  return equal;
+}
+
+/// @brief Writes bytes to a new file, which is moved to @p path once it's
+/// complete so that other processes never map a partially written file.
+bool writeFile(const std::string &path,
+               cargo::array_view<const uint8_t> bytes) {
+  const std::string temporary = path + "." + std::to_string(getpid()) + ".tmp";
+  const int fd = open(temporary.c_str(),
+                      O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  size_t written = 0;
+  while (written < bytes.size()) {
+    const ssize_t result =
+        write(fd, bytes.data() + written, bytes.size() - written);
+    if (result <= 0) {
+      break;
+    }
+    written += static_cast<size_t>(result);
+  }
+  const bool complete = 0 == close(fd) && written == bytes.size();
+  if (!complete || 0 != rename(temporary.c_str(), path.c_str())) {
+    (void)unlink(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+#endif
+
+/// @brief Maps an image from a file in the `CA_HOST_IMAGE_DIR` directory,
+/// writing the file first if no process has done so yet.
+///
+/// Every process mapping the same file shares the pages of its code rather
+/// than each keeping its own copy.
+cargo::result mapImageFile(cargo::array_view<const uint8_t> bytes,
+                           const loader::Image::ImportList &imports,
+                           loader::Image &image) {
+#ifdef __linux__
+  const char *dir = std::getenv("CA_HOST_IMAGE_DIR");
+  if (nullptr == dir || '\0' == *dir) {
+    return cargo::unsupported;
+  }
+  loader::ImageHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  char name[64];
+  (void)std::snprintf(name, sizeof(name), "/%016" PRIx64 "-%zu.img",
+                      header.hash, bytes.size());
+  const std::string path = dir + std::string(name);
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    // Another process may win the race to write the file, which is fine as
+    // long as one of them does.
+    (void)writeFile(path, bytes);
+    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return cargo::unsupported;
+    }
+  }
+  // The file is only trusted if it matches the image exactly, as its code is
+  // about to be executed.
+  cargo::result error = cargo::unsupported;
+  if (fileContains(fd, bytes)) {
+    error = image.map(fd, bytes, imports);
+  }
+  (void)close(fd);
+  return error;
+#else
+  (void)bytes;
+  (void)imports;
+  (void)image;
+  return cargo::unsupported;
+#endif
+}
+
+/// @brief Creates an executable from a prelinked image, see `loader::Image`.
+mux_result_t createImageExecutable(mux_device_t device,
+                                   mux::dynamic_array<uint64_t> contents,
+                                   uint64_t length, mux::allocator allocator,
+                                   mux_executable_t *out_executable) {
+  const cargo::array_view<const uint8_t> bytes{
+      reinterpret_cast<const uint8_t *>(contents.data()),
+      static_cast<size_t>(length)};
+  const auto imports = host::utils::getRelocations();
+  loader::Image image;
+  if (mapImageFile(bytes, imports, image)) {
+    switch (image.load(bytes, imports)) {
+      case cargo::success:
+        break;
+      case cargo::bad_alloc:
+        return mux_error_out_of_memory;
+      default:
+        return mux_error_invalid_binary;
+    }
+  }
+
+  auto kernels = host::readBinaryMetadata(image.metadata(), &allocator);
+  if (!kernels) {
+    return mux_error_invalid_binary;
+  }
+
+  auto executable = allocator.create<host::executable_s>(
+      device, std::move(contents), std::move(image), std::move(*kernels),
+      allocator);
+  if (nullptr == executable) {
+    return mux_error_out_of_memory;
+  }
+
+  *out_executable = executable;
+  return mux_success;
+}
+}  // namespace
+
 mux_result_t hostCreateExecutable(mux_device_t device, const void *binary,
                                   uint64_t binary_length,
                                   mux_allocator_info_t allocator_info,
@@ -87,6 +253,12 @@ mux_result_t hostCreateExecutable(mux_device_t device, const void *binary,
               static_cast<size_t>(binary_length), elf_bytes.begin());
   host::kernel_variant_map kernels;
 
+  // Prelinked images skip the relocation of the ELF file below entirely.
+  if (loader::isImage({elf_bytes.data(), elf_bytes.size()})) {
+    return createImageExecutable(device, std::move(elf_contents),
+                                 binary_length, allocator, out_executable);
+  }
+
   if (!loader::ElfFile::isValidElf(elf_bytes)) {
     return mux_error_invalid_binary;
   }
@@ -16,6 +16,10 @@
 #include <host/device.h>
 #include <host/fence.h>
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
 #include "host/host.h"
 #include "mux/mux.h"
 
@@ -42,33 +46,18 @@ mux_result_t fence_s::tryWait(uint64_t timeout) {
     return result;
   }
 
-  // See if the fence is already signaled.
-  auto result = thread_pool_signal ? this->result : mux_fence_not_ready;
-  assert((result != mux_error_internal) &&
-         "Thread pool was signalled yet no fence result was set");
-
-  // If the fence hasn't been signaled go to sleep for the requested timeout
-  // period (if it is exists) periodically waking up every nanosecond to check
-  // the result.
-  uint64_t time_waited = 0;
-  constexpr uint64_t increment = 1;
-  while (time_waited < timeout) {
-    std::this_thread::sleep_for(
-        std::chrono::duration<uint64_t, std::nano>(increment));
-
-    // Check the result again and if it is done we can exit.
-    result = thread_pool_signal ? this->result : mux_fence_not_ready;
-    assert((result != mux_error_internal) &&
-           "Thread pool was signalled yet no fence result was set");
-    if (mux_success == result) {
-      return mux_success;
-    }
-
-    time_waited += increment;
+  // Spin, then block, until the fence is signalled or the timeout expires.
+  if (!thread_pool_signal && timeout > 0) {
+    auto *hostDevice = static_cast<host::device_s *>(device);
+    const auto duration = std::chrono::nanoseconds(static_cast<int64_t>(
+        std::min<uint64_t>(timeout, std::numeric_limits<int64_t>::max())));
+    (void)hostDevice->thread_pool.completed.wait_for(
+        [this] { return thread_pool_signal.load(); }, duration);
   }
 
-  // Check one last time.
-  result = thread_pool_signal ? this->result : mux_fence_not_ready;
+  if (!thread_pool_signal) {
+    return mux_fence_not_ready;
+  }
   assert((result != mux_error_internal) &&
          "Thread pool was signalled yet no fence result was set");
   return result;
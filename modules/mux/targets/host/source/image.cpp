@@ -22,6 +22,7 @@
 #include <host/memory.h>
 #include <mux/utils/allocator.h>
 
+#include <algorithm>
 #include <cstdlib>
 
 namespace host {
@@ -79,6 +80,16 @@ static inline cl_image_desc getImageDesc(mux_image_type_e type, uint32_t width,
   return {imageType, width,      height, depth, array_layers,
           rowPitch,  slicePitch, 0,      0,     {/*nullptr*/}};
 }
+
+// Returns true if the CA_HOST_IMAGE_TILING environment variable requests
+// that images are stored in a tiled layout where possible.
+static bool isImageTilingEnabled() {
+  static const bool enabled = [] {
+    const char *env = std::getenv("CA_HOST_IMAGE_TILING");
+    return nullptr != env && 0 != std::atoi(env);
+  }();
+  return enabled;
+}
 #endif
 
 mux_result_t hostCreateImage(mux_device_t device, mux_image_type_e type,
@@ -96,9 +107,20 @@ mux_result_t hostCreateImage(mux_device_t device, mux_image_type_e type,
   const cl_image_desc imageDesc = getImageDesc(
       type, width, height, depth, array_layers, row_size, slice_size);
 
-  const uint64_t storageSize =
+  uint64_t storageSize =
       libimg::HostGetImageStorageSize(imageFormat, imageDesc);
 
+  // NOTE: Images with user provided pitches describe memory laid out by the
+  // user so must be linear, otherwise the layout is only known at bind time
+  // so reserve enough storage for the tiled layout as well.
+  libimg::UInt boundLayout = IMG_LAYOUT_LINEAR;
+  if (isImageTilingEnabled() && 0 == row_size && 0 == slice_size) {
+    boundLayout = libimg::HostGetImageTiledLayout(imageDesc);
+    storageSize = std::max<uint64_t>(
+        storageSize, libimg::HostGetImageLayoutStorageSize(
+                         imageFormat, imageDesc, boundLayout));
+  }
+
   // NOTE: Set the required alignment per image format, this may be too
   // granular however it is not possible to simply use a course value such at 16
   // because of CL_MEM_USE_HOST_PTR and the alignment requirements of the OpenCL
@@ -256,6 +278,7 @@ mux_result_t hostCreateImage(mux_device_t device, mux_image_type_e type,
   // until ::hostBinaryImageMemory time, libimg::HostInitializeImage will
   // instead set the storage type to external so we can bind later.
   libimg::HostInitializeImage(imageFormat, imageDesc, &image->image);
+  image->boundLayout = boundLayout;
 
   *out_image = image;
 
@@ -303,6 +326,14 @@ mux_result_t hostBindImageMemory(mux_device_t device, mux_memory_t memory,
   // an error message for this case, so no extra checking is required
   char *pointer = static_cast<char *>(hostMemory->data) + offset;
 
+  // NOTE: Memory created from a host pointer is accessed directly by the user
+  // in linear layout so the image can only be tiled in memory we allocated.
+  if (IMG_LAYOUT_LINEAR != hostImage->boundLayout && !hostMemory->useHost) {
+    libimg::HostSetImageLayout(&hostImage->image, hostImage->boundLayout);
+    hostImage->tiling = mux_image_tiling_optimal;
+    hostMemory->tiledImage = hostImage;
+  }
+
   // NOTE: Bind the device memory
   libimg::HostAttachImageStorage(&hostImage->image, pointer);
 
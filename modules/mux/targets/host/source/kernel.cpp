@@ -22,6 +22,7 @@
 #include <mux/mux.h>
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <new>
 
@@ -135,11 +136,25 @@ mux_result_t hostCreateKernel(mux_device_t device, mux_executable_t executable,
   cargo::small_vector<host::kernel_variant_s, 4> variants;
 
   for (const auto &v : entry->second) {
-    auto err = variants.emplace_back(host::kernel_variant_s{
+    uint64_t hook = v.hook;
+    // Kernels loaded from a prelinked image are looked up when they're first
+    // used, rather than when the executable is created.
+    if (0 == hook && hostExecutable->image.loaded()) {
+      auto address = hostExecutable->image.getSymbolAddress(
+          {v.kernel_name.data(), v.kernel_name.size()});
+      if (!address) {
+        return mux_error_missing_kernel;
+      }
+      hook = *address;
+    }
+    host::kernel_variant_s variant{
         std::string(name, name_length),
-        reinterpret_cast<host::kernel_variant_s::entry_hook_t>(v.hook),
+        reinterpret_cast<host::kernel_variant_s::entry_hook_t>(hook),
         v.local_memory_used, v.min_work_width, v.pref_work_width,
-        v.sub_group_size});
+        v.sub_group_size};
+    std::copy(v.local_size.begin(), v.local_size.end(),
+              variant.local_size.begin());
+    auto err = variants.emplace_back(std::move(variant));
     if (err != cargo::success) {
       return mux_error_out_of_memory;
     }
@@ -177,13 +192,31 @@ static bool isLegalKernelVariant(const host::kernel_variant_s &variant,
   return true;
 }
 
-mux_result_t host::kernel_s::getKernelVariantForWGSize(
+/// @brief Returns whether a variant was compiled for a single local size.
+static bool isSpecializedKernelVariant(const host::kernel_variant_s &variant) {
+  return 0 != variant.local_size[0];
+}
+
+/// @brief Choose the best legal variant for a local size.
+///
+/// @param variants Variants to choose between.
+/// @param local_size_x Local size in the first dimension.
+/// @param local_size_y Local size in the second dimension.
+/// @param local_size_z Local size in the third dimension.
+/// @param include_specialized Whether to consider variants compiled for a
+/// single local size, which may be a different local size.
+///
+/// @return Returns the best variant, or null if none of them are legal.
+static const host::kernel_variant_s *chooseKernelVariant(
+    const cargo::small_vector<host::kernel_variant_s, 4> &variants,
     size_t local_size_x, size_t local_size_y, size_t local_size_z,
-    host::kernel_variant_s *out_variant_data) {
-  (void)local_size_y;
-  (void)local_size_z;
+    bool include_specialized) {
   const host::kernel_variant_s *best_variant = nullptr;
-  for (auto &v : variant_data) {
+  for (auto &v : variants) {
+    if (!include_specialized && isSpecializedKernelVariant(v)) {
+      continue;
+    }
+
     // If the local size isn't a multiple of the minimum work width, we must
     // disregard this kernel.
     if (!isLegalKernelVariant(v, local_size_x, local_size_y, local_size_z)) {
@@ -213,6 +246,34 @@ mux_result_t host::kernel_s::getKernelVariantForWGSize(
       best_variant = &v;
     }
   }
+  return best_variant;
+}
+
+mux_result_t host::kernel_s::getKernelVariantForWGSize(
+    size_t local_size_x, size_t local_size_y, size_t local_size_z,
+    host::kernel_variant_s *out_variant_data) {
+  // Variants compiled for exactly this local size, e.g. from
+  // -cl-precache-local-sizes, were optimized knowing it so are preferred.
+  const std::array<size_t, 3> local_size = {local_size_x, local_size_y,
+                                            local_size_z};
+  for (auto &v : variant_data) {
+    if (v.local_size == local_size &&
+        isLegalKernelVariant(v, local_size_x, local_size_y, local_size_z)) {
+      *out_variant_data = v;
+      return mux_success;
+    }
+  }
+
+  const host::kernel_variant_s *best_variant = chooseKernelVariant(
+      variant_data, local_size_x, local_size_y, local_size_z,
+      /* include_specialized */ false);
+  if (!best_variant) {
+    // Kernels with a required work-group size only have specialized variants,
+    // which are queried at other local sizes, e.g. for their sub-group sizes.
+    best_variant = chooseKernelVariant(variant_data, local_size_x,
+                                       local_size_y, local_size_z,
+                                       /* include_specialized */ true);
+  }
   if (!best_variant) {
     return mux_error_failure;
   }
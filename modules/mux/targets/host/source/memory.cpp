@@ -16,10 +16,14 @@
 
 #include <host/device.h>
 #include <host/host.h>
+#include <host/image.h>
 #include <host/memory.h>
+#include <host/topology.h>
 #include <mux/utils/allocator.h>
 
+#include <algorithm>
 #include <cstring>
+#include <new>
 
 namespace host {
 memory_s::memory_s(uint64_t size, uint32_t properties, void *data, bool useHost)
@@ -31,13 +35,90 @@ memory_s::memory_s(uint64_t size, uint32_t properties, void *data, bool useHost)
 }
 }  // namespace host
 
+#ifdef HOST_IMAGE_SUPPORT
+// Converts the pixels of the memory's tiled image which overlap the byte range
+// [offset, offset + size) of its linear copy, into the image if `toImage` is
+// true and into the linear copy otherwise. Only the overlapping pixels are
+// touched so that flushing one mapping does not clobber another.
+static void convertTiledImageRange(host::memory_s *memory, uint64_t offset,
+                                   uint64_t size, bool toImage) {
+  libimg::HostImage &image = memory->tiledImage->image;
+  const ImageMetaData &desc = image.image.meta_data;
+
+  // The linear copy of the image is at the same offset into the copy as the
+  // image is into the memory, clip the range to it.
+  const uint64_t imageOffset =
+      image.image.raw_data - static_cast<const uint8_t *>(memory->data);
+  const uint64_t imageSize = uint64_t(desc.slice_pitch) * desc.depth;
+  if (offset + size <= imageOffset || imageOffset + imageSize <= offset) {
+    return;
+  }
+  const uint64_t begin = std::max(offset, imageOffset) - imageOffset;
+  const uint64_t end =
+      std::min(offset + size, imageOffset + imageSize) - imageOffset;
+  uint8_t *linear = memory->linearData.get() + imageOffset;
+
+  auto convert = [&](size_t x, size_t y, size_t z, size_t width,
+                     size_t height) {
+    const size_t origin[3] = {x, y, z};
+    const size_t region[3] = {width, height, 1};
+    uint8_t *data = linear + (z * desc.slice_pitch) + (y * desc.row_pitch) +
+                    (x * desc.pixel_size);
+    if (toImage) {
+      libimg::HostWriteImage(&image, origin, region, desc.row_pitch,
+                             desc.slice_pitch, data);
+    } else {
+      libimg::HostReadImage(&image, origin, region, desc.row_pitch,
+                            desc.slice_pitch, data);
+    }
+  };
+
+  const uint64_t rowSize = uint64_t(desc.width) * desc.pixel_size;
+  for (size_t z = begin / desc.slice_pitch; z <= (end - 1) / desc.slice_pitch;
+       z++) {
+    const uint64_t sliceBegin = uint64_t(z) * desc.slice_pitch;
+    const uint64_t rowsBegin = std::max(begin, sliceBegin) - sliceBegin;
+    const uint64_t rowsEnd =
+        std::min<uint64_t>(end - sliceBegin, desc.slice_pitch);
+
+    // Runs of rows which are entirely within the range are converted with a
+    // single call, partially covered rows are converted on their own.
+    size_t fullRows = 0;
+    const size_t lastRow =
+        std::min<size_t>((rowsEnd - 1) / desc.row_pitch, desc.height - 1);
+    for (size_t y = rowsBegin / desc.row_pitch; y <= lastRow; y++) {
+      const uint64_t rowBegin = uint64_t(y) * desc.row_pitch;
+      const uint64_t spanBegin = std::max(rowsBegin, rowBegin) - rowBegin;
+      const uint64_t spanEnd = std::min(rowsEnd - rowBegin, rowSize);
+      if (spanEnd <= spanBegin) {
+        // The range only covers the padding at the end of the row.
+        continue;
+      }
+      const size_t xBegin = spanBegin / desc.pixel_size;
+      const size_t xEnd = (spanEnd + desc.pixel_size - 1) / desc.pixel_size;
+      if (0 == xBegin && desc.width == xEnd) {
+        fullRows++;
+        continue;
+      }
+      if (fullRows) {
+        convert(0, y - fullRows, z, desc.width, fullRows);
+        fullRows = 0;
+      }
+      convert(xBegin, y, z, xEnd - xBegin, 1);
+    }
+    if (fullRows) {
+      convert(0, lastRow + 1 - fullRows, z, desc.width, fullRows);
+    }
+  }
+}
+#endif
+
 mux_result_t hostAllocateMemory(mux_device_t device, size_t size, uint32_t heap,
                                 uint32_t memory_properties,
                                 mux_allocation_type_e allocation_type,
                                 uint32_t alignment,
                                 mux_allocator_info_t allocator_info,
                                 mux_memory_t *out_memory) {
-  (void)device;
   (void)allocation_type;
 
   mux::allocator allocator(allocator_info);
@@ -65,6 +146,12 @@ mux_result_t hostAllocateMemory(mux_device_t device, size_t size, uint32_t heap,
     return mux_error_out_of_memory;
   }
 
+  // Sub-devices confined to a NUMA node want their memory on that node.
+  auto host_device = static_cast<host::device_s *>(device);
+  if (host_device->numa_node) {
+    host::preferNode(host_pointer, size, *host_device->numa_node);
+  }
+
   auto memory = allocator.create<host::memory_s>(size, memory_properties,
                                                  host_pointer, false);
   if (nullptr == memory) {
@@ -121,8 +208,25 @@ mux_result_t hostMapMemory(mux_device_t device, mux_memory_t memory,
 
   // NOTE: On host we can't map a range of virtual memory because the entire
   // memory block is already addressable due to using unified memory.
-  (void)size;
   void *addressMap = hostMemory->data;
+
+#ifdef HOST_IMAGE_SUPPORT
+  // NOTE: Tiled images are mapped through a linear copy so the host sees the
+  // layout it expects, the copy is kept in sync when the mapping is flushed.
+  if (hostMemory->tiledImage) {
+    if (!hostMemory->linearData) {
+      hostMemory->linearData.reset(new (std::nothrow)
+                                       uint8_t[hostMemory->size]);
+      if (!hostMemory->linearData) {
+        return mux_error_out_of_memory;
+      }
+    }
+    convertTiledImageRange(hostMemory, offset, size, false);
+    addressMap = hostMemory->linearData.get();
+  }
+#else
+  (void)size;
+#endif
   *out_data = static_cast<unsigned char *>(addressMap) + offset;
 
   return mux_success;
@@ -132,12 +236,19 @@ mux_result_t hostFlushMappedMemoryToDevice(mux_device_t device,
                                            mux_memory_t memory, uint64_t offset,
                                            uint64_t size) {
   (void)device;
+
+  // NOTE: On host flushing is a noop because we take advantage of unified
+  // memory, except for tiled images which are mapped through a linear copy.
+#ifdef HOST_IMAGE_SUPPORT
+  auto hostMemory = static_cast<host::memory_s *>(memory);
+  if (hostMemory->linearData) {
+    convertTiledImageRange(hostMemory, offset, size, true);
+  }
+#else
   (void)memory;
   (void)offset;
   (void)size;
-
-  // NOTE: On host flushing is a noop because we take advantage of unified
-  // memory.
+#endif
 
   return mux_success;
 }
@@ -146,21 +257,30 @@ mux_result_t hostFlushMappedMemoryFromDevice(mux_device_t device,
                                              mux_memory_t memory,
                                              uint64_t offset, uint64_t size) {
   (void)device;
+
+  // NOTE: On host flushing is a noop because we take advantage of unified
+  // memory, except for tiled images which are mapped through a linear copy.
+#ifdef HOST_IMAGE_SUPPORT
+  auto hostMemory = static_cast<host::memory_s *>(memory);
+  if (hostMemory->linearData) {
+    convertTiledImageRange(hostMemory, offset, size, false);
+  }
+#else
   (void)memory;
   (void)offset;
   (void)size;
-
-  // NOTE: On host flushing is a noop because we take advantage of unified
-  // memory.
+#endif
 
   return mux_success;
 }
 
 mux_result_t hostUnmapMemory(mux_device_t device, mux_memory_t memory) {
   (void)device;
-  (void)memory;
 
-  // NOTE: On host unmap is a noop because we take advantage of unified memory.
+  // NOTE: On host unmap is a noop because we take advantage of unified memory,
+  // the linear copy of a tiled image is released as it is no longer visible.
+  auto hostMemory = static_cast<host::memory_s *>(memory);
+  hostMemory->linearData.reset();
 
   return mux_success;
 }
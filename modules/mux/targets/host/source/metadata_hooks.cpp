@@ -17,14 +17,14 @@
 #include <cargo/string_view.h>
 #include <host/metadata_hooks.h>
 #include <metadata/detail/utils.h>
-#include <metadata/handler/vectorize_info_metadata.h>
+#include <metadata/handler/local_size_info_metadata.h>
 #include <metadata/metadata.h>
 
 namespace {
 
 /// @brief Struct used to pass arguments to metadata API.
-struct ElfUserdata {
-  loader::ElfFile *elf;
+struct NotesUserdata {
+  cargo::array_view<const uint8_t> notes;
   mux::allocator *allocator;
 };
 
@@ -34,25 +34,18 @@ static md_hooks getHostMdReadHooks() {
   md_hooks md_hooks{};
 
   md_hooks.map = [](const void *userdata, size_t *n) -> const void * {
-    auto *elfUserdata = static_cast<const ElfUserdata *>(userdata);
-    auto *elf = elfUserdata->elf;
-    auto notes_section = elf->section(host::MD_NOTES_SECTION);
-    if (!notes_section.has_value()) {
-      *n = 0;
-      return nullptr;
-    }
-    auto sec_data = notes_section.value().data();
-    *n = sec_data.size();
-    return static_cast<void *>(sec_data.begin());
+    auto *notesUserdata = static_cast<const NotesUserdata *>(userdata);
+    *n = notesUserdata->notes.size();
+    return notesUserdata->notes.data();
   };
   md_hooks.allocate = [](size_t size, size_t align, void *userdata) {
-    auto *elfUserdata = static_cast<ElfUserdata *>(userdata);
-    return elfUserdata->allocator->alloc(size, align);
+    auto *notesUserdata = static_cast<NotesUserdata *>(userdata);
+    return notesUserdata->allocator->alloc(size, align);
   };
 
   md_hooks.deallocate = [](void *ptr, void *userdata) {
-    auto *elfUserdata = static_cast<ElfUserdata *>(userdata);
-    elfUserdata->allocator->free(ptr);
+    auto *notesUserdata = static_cast<NotesUserdata *>(userdata);
+    notesUserdata->allocator->free(ptr);
   };
   return md_hooks;
 }
@@ -61,22 +54,29 @@ namespace host {
 
 cargo::optional<kernel_variant_map> readBinaryMetadata(loader::ElfFile *elf,
                                                        mux::allocator *alloc) {
-  if (!elf->section(MD_NOTES_SECTION)) {
+  auto notes_section = elf->section(MD_NOTES_SECTION);
+  if (!notes_section) {
     return cargo::nullopt;
   }
+  auto notes = notes_section->data();
+  return readBinaryMetadata({notes.data(), notes.size()}, alloc);
+}
+
+cargo::optional<kernel_variant_map> readBinaryMetadata(
+    cargo::array_view<const uint8_t> notes, mux::allocator *alloc) {
   kernel_variant_map kernels;
 
   md_hooks hooks = getHostMdReadHooks();
   // The handler below uses this userdata in its destructor, so it must be
   // alive longer than the handler.
-  ElfUserdata userdata{elf, alloc};
-  handler::VectorizeInfoMetadataHandler handler;
+  NotesUserdata userdata{notes, alloc};
+  handler::LocalSizeInfoMetadataHandler handler;
 
   if (!handler.init(&hooks, &userdata)) {
     return cargo::nullopt;
   }
 
-  handler::VectorizeInfoMetadata md;
+  handler::LocalSizeInfoMetadata md;
   while (handler.read(md)) {
     // We don't expect scalable vectorization widths on host.
     if (md.min_work_item_factor.isScalable() ||
@@ -89,7 +89,8 @@ cargo::optional<kernel_variant_map> readBinaryMetadata(loader::ElfFile *elf,
         static_cast<uint32_t>(md.local_memory_usage),
         md.min_work_item_factor.getFixedValue(),
         md.pref_work_item_factor.getFixedValue(),
-        md.sub_group_size.getFixedValue()};
+        md.sub_group_size.getFixedValue(),
+        md.local_size};
     auto it = kernels.find(md.source_name);
     if (it != kernels.end()) {
       it->second.push_back(kernel);
@@ -0,0 +1,300 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <host/perf_counter.h>
+#include <tracer/tracer.h>
+#include <utils/system.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define HOST_PERF_EVENT_SUPPORT
+#endif
+
+namespace {
+const host::perf_counter_s perf_counters[host::perf_counter_total] = {
+    {host::perf_counter_cycles, "cycles", "perf_event",
+     "CPU cycles spent executing kernels", mux_query_counter_unit_cycles,
+     mux_query_counter_result_type_uint64, 1},
+    {host::perf_counter_instructions, "instructions", "perf_event",
+     "Instructions retired executing kernels", mux_query_counter_unit_generic,
+     mux_query_counter_result_type_uint64, 1},
+    {host::perf_counter_cache_misses, "cache misses", "perf_event",
+     "Last level cache misses executing kernels",
+     mux_query_counter_unit_generic, mux_query_counter_result_type_uint64, 1},
+    {host::perf_counter_branch_misses, "branch mispredictions", "perf_event",
+     "Mispredicted branches executing kernels", mux_query_counter_unit_generic,
+     mux_query_counter_result_type_uint64, 1},
+    {host::perf_counter_slice_time, "slice time", "Scheduling",
+     "Time spent executing slices of kernels, summed over all threads",
+     mux_query_counter_unit_nanoseconds, mux_query_counter_result_type_uint64,
+     0},
+    {host::perf_counter_max_slice_time, "max slice time", "Scheduling",
+     "Time spent executing the longest slice of a kernel",
+     mux_query_counter_unit_nanoseconds, mux_query_counter_result_type_uint64,
+     0},
+    {host::perf_counter_load_imbalance, "load imbalance", "Scheduling",
+     "Percentage of thread pool time spent idle while kernels ran",
+     mux_query_counter_unit_percentage, mux_query_counter_result_type_float64,
+     0},
+    {host::perf_counter_mean_slice_time, "mean slice time", "Scheduling",
+     "Mean time spent executing a slice of a kernel",
+     mux_query_counter_unit_nanoseconds, mux_query_counter_result_type_uint64,
+     0},
+    {host::perf_counter_slice_imbalance, "slice imbalance", "Scheduling",
+     "Ratio of the longest slice of each kernel to its mean slice",
+     mux_query_counter_unit_generic, mux_query_counter_result_type_float64, 0},
+    {host::perf_counter_handshake_time, "handshake time", "Scheduling",
+     "Time kernels spent handing slices to threads and waiting for them",
+     mux_query_counter_unit_nanoseconds, mux_query_counter_result_type_uint64,
+     0},
+};
+
+#ifdef HOST_PERF_EVENT_SUPPORT
+const uint64_t hardware_events[host::perf_hardware_counter_count] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+/// @brief Open a hardware counter counting the calling thread in user space.
+///
+/// @param config Hardware event to count.
+/// @param group_fd Leader of the group to join, or -1 to lead a new group.
+///
+/// @return Returns the file descriptor of the counter, or -1 on failure.
+int openEvent(uint64_t config, int group_fd) {
+  perf_event_attr attr = {};
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Excluding the kernel lets the counters open with perf_event_paranoid
+  // set to 2, the default on most distributions.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1,
+                                  group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+/// @brief Returns which hardware counters can be opened by this process.
+const std::array<bool, host::perf_hardware_counter_count> &
+supportedHardwareEvents() {
+  static const auto supported = [] {
+    std::array<bool, host::perf_hardware_counter_count> supported = {};
+    for (uint32_t index = 0; index < host::perf_hardware_counter_count;
+         index++) {
+      const int fd = openEvent(hardware_events[index], -1);
+      if (fd >= 0) {
+        supported[index] = true;
+        (void)close(fd);
+      }
+    }
+    return supported;
+  }();
+  return supported;
+}
+
+/// @brief The supported hardware counters of a thread, opened as one group so
+/// they can all be read with a single system call.
+class perf_event_group {
+ public:
+  perf_event_group() {
+    const auto &supported = supportedHardwareEvents();
+    for (uint32_t index = 0; index < host::perf_hardware_counter_count;
+         index++) {
+      if (!supported[index]) {
+        continue;
+      }
+      const int fd = openEvent(hardware_events[index], leader());
+      if (fd < 0) {
+        // The PMU may not have room for the whole group, e.g. when another
+        // process is using it. Report nothing rather than a partial group.
+        closeAll();
+        return;
+      }
+      fds[count] = fd;
+      indices[count] = index;
+      count++;
+    }
+  }
+
+  perf_event_group(const perf_event_group &) = delete;
+  perf_event_group &operator=(const perf_event_group &) = delete;
+
+  ~perf_event_group() { closeAll(); }
+
+  void read(uint64_t *values) const {
+    if (0 == count) {
+      return;
+    }
+    struct {
+      uint64_t nr;
+      uint64_t values[host::perf_hardware_counter_count];
+    } data;
+    if (::read(fds[0], &data, sizeof(data)) <= 0) {
+      return;
+    }
+    for (uint32_t i = 0; i < count && i < data.nr; i++) {
+      values[indices[i]] = data.values[i];
+    }
+  }
+
+ private:
+  int leader() const { return 0 == count ? -1 : fds[0]; }
+
+  void closeAll() {
+    for (uint32_t i = 0; i < count; i++) {
+      (void)close(fds[i]);
+    }
+    count = 0;
+  }
+
+  int fds[host::perf_hardware_counter_count] = {};
+  uint32_t indices[host::perf_hardware_counter_count] = {};
+  uint32_t count = 0;
+};
+#endif
+}  // namespace
+
+namespace host {
+const std::vector<perf_counter_s> &supportedPerfCounters() {
+  static const std::vector<perf_counter_s> counters = [] {
+    std::vector<perf_counter_s> counters;
+    for (const auto &counter : perf_counters) {
+      if (counter.uuid < perf_hardware_counter_count) {
+#ifdef HOST_PERF_EVENT_SUPPORT
+        if (!supportedHardwareEvents()[counter.uuid]) {
+          continue;
+        }
+#else
+        continue;
+#endif
+      }
+      counters.push_back(counter);
+    }
+    return counters;
+  }();
+  return counters;
+}
+
+perf_sample_s perf_sample_s::read(bool hardware) {
+  perf_sample_s sample = {};
+#ifdef HOST_PERF_EVENT_SUPPORT
+  if (hardware) {
+    static thread_local const perf_event_group group;
+    group.read(sample.hardware);
+  }
+#else
+  (void)hardware;
+#endif
+  sample.timestamp = utils::timestampNanoSeconds();
+  return sample;
+}
+
+range_profile_s range_profile_s::compute(const slice_record_s *records,
+                                         size_t count, uint64_t begin,
+                                         uint64_t end, size_t thread_count) {
+  range_profile_s profile = {};
+  profile.wall_time = end > begin ? end - begin : 0;
+
+  uint64_t first_start = end;
+  uint64_t last_end = begin;
+  size_t executed = 0;
+  std::vector<uint32_t> threads;
+  threads.reserve(thread_count);
+  for (size_t index = 0; index < count; index++) {
+    const slice_record_s &record = records[index];
+    // Slices of empty ND-ranges return before they're timed.
+    if (0 == record.end) {
+      continue;
+    }
+    executed++;
+    const uint64_t time =
+        record.end > record.start ? record.end - record.start : 0;
+    profile.slice_time += time;
+    profile.max_slice_time = std::max(profile.max_slice_time, time);
+    first_start = std::min(first_start, record.start);
+    last_end = std::max(last_end, record.end);
+    if (std::find(threads.begin(), threads.end(), record.thread) ==
+        threads.end()) {
+      threads.push_back(record.thread);
+    }
+  }
+  if (0 == executed) {
+    return profile;
+  }
+  profile.mean_slice_time = profile.slice_time / executed;
+  profile.threads = static_cast<uint32_t>(threads.size());
+  profile.handshake_time = (first_start > begin ? first_start - begin : 0) +
+                           (end > last_end ? end - last_end : 0);
+  const double available =
+      static_cast<double>(profile.wall_time) * static_cast<double>(thread_count);
+  if (available > 0.0) {
+    profile.idle_fraction = std::clamp(
+        1.0 - static_cast<double>(profile.slice_time) / available, 0.0, 1.0);
+  }
+  return profile;
+}
+
+bool sliceProfilingEnabled() {
+  static const bool enabled = [] {
+    const char *env = std::getenv("CA_HOST_PROFILE_SLICES");
+    return nullptr != env && 0 != std::atoi(env);
+  }();
+  return enabled;
+}
+
+uint32_t currentThreadIndex() {
+  static std::atomic<uint32_t> next_index{0};
+  static thread_local const uint32_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+void traceSlice(const slice_record_s &record) {
+  tracer::recordTrace("host:slice", "Impl", record.start / 1000,
+                      record.end / 1000);
+}
+
+void traceRange(const range_profile_s &profile, uint64_t begin) {
+  // The statistics go in the event's name as the trace format has nowhere
+  // else to put them.
+  char name[128];
+  const double ratio =
+      profile.mean_slice_time
+          ? static_cast<double>(profile.max_slice_time) /
+                static_cast<double>(profile.mean_slice_time)
+          : 0.0;
+  (void)std::snprintf(name, sizeof(name),
+                      "host:ndrange max/mean %.2f idle %.1f%% threads %" PRIu32
+                      " handshake %" PRIu64 "us",
+                      ratio, 100.0 * profile.idle_fraction, profile.threads,
+                      profile.handshake_time / 1000);
+  tracer::recordTrace(name, "Impl", begin / 1000,
+                      (begin + profile.wall_time) / 1000);
+}
+}  // namespace host
@@ -22,6 +22,8 @@
 #include <papi.h>
 #endif
 
+#include <algorithm>
+
 cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
     mux_query_type_e query_type, uint32_t query_count, mux::allocator allocator,
     const mux_query_counter_config_t *query_configs, mux_queue_t queue) {
@@ -29,8 +31,19 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
   auto host_device = static_cast<host::device_s *>(queue->device);
   auto thread_count = host_device->thread_pool.initialized_threads;
 #else
-  (void)query_configs;
   (void)queue;
+  if (query_type == mux_query_type_counter) {
+    const auto &counters = host::supportedPerfCounters();
+    for (uint32_t query_index = 0; query_index < query_count; query_index++) {
+      if (std::none_of(counters.begin(), counters.end(),
+                       [&](const host::perf_counter_s &counter) {
+                         return counter.uuid ==
+                                query_configs[query_index].uuid;
+                       })) {
+        return cargo::make_unexpected(mux_error_invalid_value);
+      }
+    }
+  }
 #endif
   // Calculate the result storage offset past the end of the query_pool_s.
   // FIXME: This wastes sizeof(mux_query_duration_result_s) bytes when
@@ -44,6 +57,10 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
   } else if (query_type == mux_query_type_counter) {
     query_data_offset = sizeof(query_pool_s) + sizeof(host_papi_event_info_s) -
                         sizeof(query_pool_s) % sizeof(host_papi_event_info_s);
+#else
+  } else if (query_type == mux_query_type_counter) {
+    query_data_offset = sizeof(query_pool_s) + sizeof(host_perf_totals_s) -
+                        sizeof(query_pool_s) % sizeof(host_perf_totals_s);
 #endif
   }
   // Calculate the total size of the allocation.
@@ -56,6 +73,11 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
   } else if (query_type == mux_query_type_counter) {
     query_size = sizeof(host_papi_event_info_s) * thread_count;
     query_align = alignof(host_papi_event_info_s);
+#else
+  } else if (query_type == mux_query_type_counter) {
+    query_size =
+        sizeof(host_perf_totals_s) + sizeof(uint32_t) * size_t(query_count);
+    query_align = alignof(host_perf_totals_s);
 #endif
   }
   const size_t alloc_size = query_data_offset + query_size;
@@ -138,6 +160,16 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
       query_pool->papi_event_infos[thread_index] = std::move(event_info);
     }
   }
+#else
+  if (query_type == mux_query_type_counter) {
+    // The totals are followed by the UUID of each query slot.
+    query_pool->perf_totals = new (query_pool->data) host_perf_totals_s();
+    query_pool->perf_uuids =
+        reinterpret_cast<uint32_t *>(query_pool->perf_totals + 1);
+    for (uint32_t query_index = 0; query_index < query_count; query_index++) {
+      query_pool->perf_uuids[query_index] = query_configs[query_index].uuid;
+    }
+  }
 #endif
   // Finally reset the result storage to zeros ready for use.
   query_pool->reset();
@@ -162,6 +194,10 @@ void host::query_pool_s::reset() {
       PAPI_reset(event.papi_event_set);
     }
   }
+#else
+  if (type == mux_query_type_counter) {
+    resetPerfTotals();
+  }
 #endif
 }
 
@@ -181,6 +217,13 @@ void host::query_pool_s::reset(size_t offset, size_t count) {
       PAPI_reset(event.papi_event_set);
     }
   }
+#else
+  if (type == mux_query_type_counter) {
+    // Like the PAPI event sets, the totals are shared by every query slot.
+    (void)offset;
+    (void)count;
+    resetPerfTotals();
+  }
 #endif
 }
 
@@ -294,6 +337,99 @@ mux_result_t host::query_pool_s::readPapiResults(
   return mux_success;
 }
 
+#else
+void host::query_pool_s::resetPerfTotals() {
+  for (auto &value : perf_totals->hardware) {
+    value.store(0, std::memory_order_relaxed);
+  }
+  perf_totals->slice_time.store(0, std::memory_order_relaxed);
+  perf_totals->max_slice_time.store(0, std::memory_order_relaxed);
+  perf_totals->available_time.store(0, std::memory_order_relaxed);
+  perf_totals->slice_count.store(0, std::memory_order_relaxed);
+  perf_totals->range_max_slice_time.store(0, std::memory_order_relaxed);
+  perf_totals->range_mean_slice_time.store(0, std::memory_order_relaxed);
+  perf_totals->handshake_time.store(0, std::memory_order_relaxed);
+}
+
+void host::query_pool_s::accumulateSlice(const perf_sample_s &start,
+                                         const perf_sample_s &end) {
+  for (uint32_t index = 0; index < perf_hardware_counter_count; index++) {
+    perf_totals->hardware[index].fetch_add(
+        end.hardware[index] - start.hardware[index], std::memory_order_relaxed);
+  }
+  const uint64_t slice_time = end.timestamp - start.timestamp;
+  perf_totals->slice_time.fetch_add(slice_time, std::memory_order_relaxed);
+  perf_totals->slice_count.fetch_add(1, std::memory_order_relaxed);
+  uint64_t max_slice_time =
+      perf_totals->max_slice_time.load(std::memory_order_relaxed);
+  while (slice_time > max_slice_time &&
+         !perf_totals->max_slice_time.compare_exchange_weak(
+             max_slice_time, slice_time, std::memory_order_relaxed)) {
+  }
+}
+
+void host::query_pool_s::accumulateRange(const range_profile_s &profile,
+                                         size_t thread_count) {
+  perf_totals->available_time.fetch_add(profile.wall_time * thread_count,
+                                        std::memory_order_relaxed);
+  perf_totals->range_max_slice_time.fetch_add(profile.max_slice_time,
+                                              std::memory_order_relaxed);
+  perf_totals->range_mean_slice_time.fetch_add(profile.mean_slice_time,
+                                               std::memory_order_relaxed);
+  perf_totals->handshake_time.fetch_add(profile.handshake_time,
+                                        std::memory_order_relaxed);
+}
+
+mux_result_t host::query_pool_s::readPerfResults(
+    mux_query_counter_result_s *results, size_t result_count,
+    size_t query_index) {
+  for (size_t result_index = 0; result_index < result_count; result_index++) {
+    auto &result = results[result_index];
+    const uint32_t uuid = perf_uuids[query_index + result_index];
+    if (uuid < perf_hardware_counter_count) {
+      result.uint64 = perf_totals->hardware[uuid].load();
+      continue;
+    }
+    switch (uuid) {
+      case perf_counter_slice_time:
+        result.uint64 = perf_totals->slice_time.load();
+        break;
+      case perf_counter_max_slice_time:
+        result.uint64 = perf_totals->max_slice_time.load();
+        break;
+      case perf_counter_load_imbalance: {
+        // Threads which weren't executing a slice while a kernel ran were
+        // idle, either waiting for others to finish or for work.
+        const double busy = static_cast<double>(perf_totals->slice_time);
+        const double available =
+            static_cast<double>(perf_totals->available_time);
+        result.float64 =
+            available > 0.0
+                ? std::clamp(100.0 * (1.0 - busy / available), 0.0, 100.0)
+                : 0.0;
+      } break;
+      case perf_counter_mean_slice_time: {
+        const uint64_t count = perf_totals->slice_count.load();
+        result.uint64 = count ? perf_totals->slice_time.load() / count : 0;
+      } break;
+      case perf_counter_slice_imbalance: {
+        // Summing before dividing weights each kernel by the length of its
+        // slices, so short kernels don't dominate the ratio.
+        const double max =
+            static_cast<double>(perf_totals->range_max_slice_time);
+        const double mean =
+            static_cast<double>(perf_totals->range_mean_slice_time);
+        result.float64 = mean > 0.0 ? max / mean : 0.0;
+      } break;
+      case perf_counter_handshake_time:
+        result.uint64 = perf_totals->handshake_time.load();
+        break;
+      default:
+        return mux_error_invalid_value;
+    }
+  }
+  return mux_success;
+}
 #endif
 
 mux_result_t hostGetSupportedQueryCounters(
@@ -324,11 +460,19 @@ mux_result_t hostGetSupportedQueryCounters(
 #else
   (void)device;
   (void)queue_type;
-  (void)count;
-  (void)out_counters;
-  (void)out_descriptions;
-  (void)out_count;
-  return mux_error_feature_unsupported;
+  const auto &counters = host::supportedPerfCounters();
+  if (out_count) {
+    *out_count = static_cast<uint32_t>(counters.size());
+  }
+  for (uint32_t i = 0; i < count && i < counters.size(); i++) {
+    if (out_counters) {
+      counters[i].populateMuxQueryCounter(&out_counters[i]);
+    }
+    if (out_descriptions) {
+      counters[i].populateMuxQueryCounterDescription(&out_descriptions[i]);
+    }
+  }
+  return mux_success;
 #endif
 }
 
@@ -364,16 +508,10 @@ mux_result_t hostGetQueryCounterRequiredPasses(
     uint32_t *out_pass_count) {
   (void)queue;
   (void)query_counter_configs;
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   for (uint32_t i = 0; i < query_count; i++) {
     out_pass_count[i] = 1;
   }
   return mux_success;
-#else
-  (void)query_count;
-  (void)out_pass_count;
-  return mux_error_feature_unsupported;
-#endif
 }
 
 mux_result_t hostGetQueryPoolResults(mux_queue_t queue,
@@ -400,7 +538,9 @@ mux_result_t hostGetQueryPoolResults(mux_queue_t queue,
         static_cast<mux_query_counter_result_s *>(data), query_count,
         query_index);
 #else
-    return mux_error_feature_unsupported;
+    return host_query_pool->readPerfResults(
+        static_cast<mux_query_counter_result_s *>(data), query_count,
+        query_index);
 #endif
   }
   // We somehow got passed a query pool with an invalid type.
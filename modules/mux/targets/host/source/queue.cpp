@@ -20,6 +20,7 @@
 #include <host/host.h>
 #include <host/image.h>
 #include <host/kernel.h>
+#include <host/perf_counter.h>
 #include <host/query_pool.h>
 #include <host/queue.h>
 #include <host/semaphore.h>
@@ -32,6 +33,8 @@
 #include <libimg/host.h>
 #endif
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstring>
 #include <memory>
@@ -42,6 +45,10 @@
 /// kernel exists early, which allows other threads to pickup the extra work.
 constexpr size_t slice_multiplier = 1;
 
+/// Largest alignment of local memory, that of the largest OpenCL C vector type,
+/// which the compiler pads each local memory allocation up to at most.
+constexpr size_t local_memory_alignment = 128;
+
 static void threadPoolCleanup(void *const v_queue, void *const v_command_buffer,
                               void *const v_fence, size_t terminate) {
   auto queue = static_cast<host::queue_s *>(v_queue);
@@ -121,188 +128,454 @@ static void commandCopyBuffer(host::command_info_s *info) {
               copy->size);
 }
 
-static void commandReadImage(host::command_info_s *info) {
+#ifdef HOST_IMAGE_SUPPORT
+/// Image operations touching fewer bytes than this are run on the calling
+/// thread, splitting them across the thread pool costs more than it saves.
+constexpr size_t image_split_threshold = 256 * 1024;
+
+/// @brief Run an image operation across the thread pool.
+///
+/// The region is split into contiguous ranges of slices, or of rows for
+/// regions one slice deep, with one range per thread in the pool. Each call
+/// to @p func receives the origin and region of its range and the index of the
+/// range's first slice or row relative to @p region, which callers use to
+/// offset their host or buffer pointers.
+///
+/// @param device Host device whose thread pool to run on.
+/// @param origin Origin of the region in the image.
+/// @param region Region of the image to operate on.
+/// @param pixel_size Size in bytes of a pixel of the image.
+/// @param func Operation to run for each range.
+template <typename Func>
+static void splitImageRegion(host::device_s *device, const size_t origin[3],
+                             const size_t region[3], size_t pixel_size,
+                             Func func) {
+  struct split_info_s {
+    const size_t *origin;
+    const size_t *region;
+    size_t dimension;
+    size_t slices;
+    Func *func;
+  } split = {origin, region, region[2] > 1 ? 2u : 1u, 0, &func};
+
+  const size_t bytes = region[0] * region[1] * region[2] * pixel_size;
+  split.slices =
+      std::min(device->thread_pool.num_threads(), region[split.dimension]);
+  if (bytes < image_split_threshold || split.slices < 2) {
+    func(origin, region, size_t(0));
+    return;
+  }
+
+  std::vector<std::atomic<bool>> signals(split.slices);
+  std::atomic<uint32_t> queued(0);
+  device->thread_pool.enqueue_range(
+      [](void *const in, void *, void *, size_t index) {
+        auto *const split = static_cast<split_info_s *>(in);
+        const size_t d = split->dimension;
+        const size_t total = split->region[d];
+        const size_t begin = (total * index) / split->slices;
+        const size_t end = (total * (index + 1)) / split->slices;
+
+        size_t slice_origin[3] = {split->origin[0], split->origin[1],
+                                  split->origin[2]};
+        size_t slice_region[3] = {split->region[0], split->region[1],
+                                  split->region[2]};
+        slice_origin[d] += begin;
+        slice_region[d] = end - begin;
+        (*split->func)(slice_origin, slice_region, begin);
+      },
+      &split, nullptr, signals, &queued, split.slices);
+
+  // Wait for every range to complete, see commandNDRange.
+  device->thread_pool.wait(&queued);
+  assert(0 == queued);
+}
+
+/// @brief Get the pitch of the dimension a region was split along.
+static size_t splitPitch(const size_t region[3], size_t row_pitch,
+                         size_t slice_pitch) {
+  return region[2] > 1 ? slice_pitch : row_pitch;
+}
+#endif
+
+static void commandReadImage(host::queue_s *queue,
+                             host::command_info_s *info) {
 #ifdef HOST_IMAGE_SUPPORT
   const host::command_info_read_image_s &read = info->read_image_command;
 
+  auto device = static_cast<host::device_s *>(queue->device);
   auto image = static_cast<host::image_s *>(read.image);
   const size_t origin[3] = {read.offset.x, read.offset.y, read.offset.z};
   const size_t region[3] = {read.extent.x, read.extent.y, read.extent.z};
   const size_t row_pitch = static_cast<size_t>(read.row_size);
   const size_t slice_pitch = static_cast<size_t>(read.slice_size);
   uint8_t *pointer = static_cast<uint8_t *>(read.pointer);
-
-  libimg::HostReadImage(&image->image, origin, region, row_pitch, slice_pitch,
-                        pointer);
+  const size_t pitch = splitPitch(region, row_pitch, slice_pitch);
+
+  splitImageRegion(device, origin, region, image->pixel_size,
+                   [&](const size_t *slice_origin, const size_t *slice_region,
+                       size_t begin) {
+                     libimg::HostReadImage(&image->image, slice_origin,
+                                           slice_region, row_pitch,
+                                           slice_pitch,
+                                           pointer + (begin * pitch));
+                   });
 #else
+  (void)queue;
   (void)info;
 #endif
 }
 
-static void commandWriteImage(host::command_info_s *info) {
+static void commandWriteImage(host::queue_s *queue,
+                              host::command_info_s *info) {
 #ifdef HOST_IMAGE_SUPPORT
   const host::command_info_write_image_s &write = info->write_image_command;
 
+  auto device = static_cast<host::device_s *>(queue->device);
   auto image = static_cast<host::image_s *>(write.image);
-  size_t origin[3] = {write.offset.x, write.offset.y, write.offset.z};
-  size_t region[3] = {write.extent.x, write.extent.y, write.extent.z};
+  const size_t origin[3] = {write.offset.x, write.offset.y, write.offset.z};
+  const size_t region[3] = {write.extent.x, write.extent.y, write.extent.z};
   const size_t row_pitch = static_cast<size_t>(write.row_size);
   const size_t slice_pitch = static_cast<size_t>(write.slice_size);
   const uint8_t *pointer = static_cast<const uint8_t *>(write.pointer);
-
-  libimg::HostWriteImage(&image->image, origin, region, row_pitch, slice_pitch,
-                         pointer);
+  const size_t pitch = splitPitch(region, row_pitch, slice_pitch);
+
+  splitImageRegion(device, origin, region, image->pixel_size,
+                   [&](const size_t *slice_origin, const size_t *slice_region,
+                       size_t begin) {
+                     libimg::HostWriteImage(&image->image, slice_origin,
+                                            slice_region, row_pitch,
+                                            slice_pitch,
+                                            pointer + (begin * pitch));
+                   });
 #else
+  (void)queue;
   (void)info;
 #endif
 }
 
-static void commandFillImage(host::command_info_s *info) {
+static void commandFillImage(host::queue_s *queue,
+                             host::command_info_s *info) {
 #ifdef HOST_IMAGE_SUPPORT
   const host::command_info_fill_image_s &fill = info->fill_image_command;
 
+  auto device = static_cast<host::device_s *>(queue->device);
   auto image = static_cast<host::image_s *>(fill.image);
 
-  size_t origin[3] = {fill.offset.x, fill.offset.y, fill.offset.z};
-  size_t region[3] = {fill.extent.x, fill.extent.y, fill.extent.z};
-  libimg::HostFillImage(&image->image, fill.color, origin, region);
+  const size_t origin[3] = {fill.offset.x, fill.offset.y, fill.offset.z};
+  const size_t region[3] = {fill.extent.x, fill.extent.y, fill.extent.z};
+  splitImageRegion(device, origin, region, image->pixel_size,
+                   [&](const size_t *slice_origin, const size_t *slice_region,
+                       size_t) {
+                     libimg::HostFillImage(&image->image, fill.color,
+                                           slice_origin, slice_region);
+                   });
 #else
+  (void)queue;
   (void)info;
 #endif
 }
 
-static void commandCopyImage(host::command_info_s *info) {
+static void commandCopyImage(host::queue_s *queue,
+                             host::command_info_s *info) {
 #ifdef HOST_IMAGE_SUPPORT
   host::command_info_copy_image_s *const copy = &(info->copy_image_command);
 
+  auto device = static_cast<host::device_s *>(queue->device);
   auto srcImage = static_cast<host::image_s *>(copy->src_image);
   auto dstImage = static_cast<host::image_s *>(copy->dst_image);
 
-  size_t srcOrigin[3] = {copy->src_offset.x, copy->src_offset.y,
-                         copy->src_offset.z};
-  size_t dstOrigin[3] = {copy->dst_offset.x, copy->dst_offset.y,
-                         copy->dst_offset.z};
-  size_t region[3] = {copy->extent.x, copy->extent.y, copy->extent.z};
-  libimg::HostCopyImage(&srcImage->image, &dstImage->image, srcOrigin,
-                        dstOrigin, region);
+  const size_t srcOrigin[3] = {copy->src_offset.x, copy->src_offset.y,
+                               copy->src_offset.z};
+  const size_t dstOrigin[3] = {copy->dst_offset.x, copy->dst_offset.y,
+                               copy->dst_offset.z};
+  const size_t region[3] = {copy->extent.x, copy->extent.y, copy->extent.z};
+  splitImageRegion(
+      device, srcOrigin, region, srcImage->pixel_size,
+      [&](const size_t *slice_origin, const size_t *slice_region, size_t) {
+        size_t sliceDstOrigin[3];
+        for (size_t i = 0; i < 3; i++) {
+          sliceDstOrigin[i] = dstOrigin[i] + (slice_origin[i] - srcOrigin[i]);
+        }
+        libimg::HostCopyImage(&srcImage->image, &dstImage->image, slice_origin,
+                              sliceDstOrigin, slice_region);
+      });
 #else
+  (void)queue;
   (void)info;
 #endif
 }
 
-static void commandCopyImageToBuffer(host::command_info_s *info) {
+static void commandCopyImageToBuffer(host::queue_s *queue,
+                                     host::command_info_s *info) {
 #ifdef HOST_IMAGE_SUPPORT
   const host::command_info_copy_image_to_buffer_s &copy =
       info->copy_image_to_buffer_command;
 
+  auto device = static_cast<host::device_s *>(queue->device);
   auto srcImage = static_cast<host::image_s *>(copy.src_image);
   auto dstBuffer = static_cast<host::buffer_s *>(copy.dst_buffer);
 
-  size_t srcOrigin[3] = {copy.src_offset.x, copy.src_offset.y,
-                         copy.src_offset.z};
-  size_t region[3] = {copy.extent.x, copy.extent.y, copy.extent.z};
+  const size_t srcOrigin[3] = {copy.src_offset.x, copy.src_offset.y,
+                               copy.src_offset.z};
+  const size_t region[3] = {copy.extent.x, copy.extent.y, copy.extent.z};
   const size_t dstOffset = static_cast<size_t>(copy.dst_offset);
-  libimg::HostCopyImageToBuffer(&srcImage->image, dstBuffer->data, srcOrigin,
-                                region, dstOffset);
+
+  // NOTE: The buffer is tightly packed so a range of slices or rows starts
+  // at a whole number of slices or rows into it.
+  const size_t rowSize = region[0] * srcImage->pixel_size;
+  const size_t pitch = splitPitch(region, rowSize, rowSize * region[1]);
+  splitImageRegion(device, srcOrigin, region, srcImage->pixel_size,
+                   [&](const size_t *slice_origin, const size_t *slice_region,
+                       size_t begin) {
+                     libimg::HostCopyImageToBuffer(
+                         &srcImage->image, dstBuffer->data, slice_origin,
+                         slice_region, dstOffset + (begin * pitch));
+                   });
 #else
+  (void)queue;
   (void)info;
 #endif
 }
 
-static void commandCopyBufferToImage(host::command_info_s *info) {
+static void commandCopyBufferToImage(host::queue_s *queue,
+                                     host::command_info_s *info) {
 #ifdef HOST_IMAGE_SUPPORT
   host::command_info_copy_buffer_to_image_s *copy =
       &(info->copy_buffer_to_image_command);
 
+  auto device = static_cast<host::device_s *>(queue->device);
   auto srcBuffer = static_cast<host::buffer_s *>(copy->src_buffer);
   auto dstImage = static_cast<host::image_s *>(copy->dst_image);
 
-  size_t dstOrigin[3] = {copy->dst_offset.x, copy->dst_offset.y,
-                         copy->dst_offset.z};
-  size_t region[3] = {copy->extent.x, copy->extent.y, copy->extent.z};
-
-  libimg::HostCopyBufferToImage(srcBuffer->data, &dstImage->image,
-                                copy->src_offset, dstOrigin, region);
+  const size_t dstOrigin[3] = {copy->dst_offset.x, copy->dst_offset.y,
+                               copy->dst_offset.z};
+  const size_t region[3] = {copy->extent.x, copy->extent.y, copy->extent.z};
+  const size_t srcOffset = static_cast<size_t>(copy->src_offset);
+
+  const size_t rowSize = region[0] * dstImage->pixel_size;
+  const size_t pitch = splitPitch(region, rowSize, rowSize * region[1]);
+  splitImageRegion(device, dstOrigin, region, dstImage->pixel_size,
+                   [&](const size_t *slice_origin, const size_t *slice_region,
+                       size_t begin) {
+                     libimg::HostCopyBufferToImage(
+                         srcBuffer->data, &dstImage->image,
+                         srcOffset + (begin * pitch), slice_origin,
+                         slice_region);
+                   });
 #else
+  (void)queue;
   (void)info;
 #endif
 }
 
-static void commandNDRange(host::queue_s *queue, host::command_info_s *info) {
+/// @brief What each slice of an ND-range needs besides the command itself.
+struct ndrange_slice_s {
+  /// @brief Kernel variant the slices execute.
+  host::kernel_variant_s *variant;
+  /// @brief Counter query pool the slices accumulate into, or null when no
+  /// counter query is active.
+  host::query_pool_s *counters;
+  /// @brief Timing of each slice, indexed by slice, or null when the slices
+  /// aren't being profiled.
+  host::slice_record_s *records;
+  /// @brief Number of slices the ND-range is split into.
+  size_t total_slices;
+  /// @brief Bytes of local memory arena each slice needs.
+  size_t local_memory_size;
+  /// @brief Set by any slice which couldn't be executed.
+  std::atomic<bool> failed{false};
+};
+
+/// @brief A cache line of a local memory arena, so that arenas never share
+/// cache lines with each other or with anything else.
+struct alignas(64) arena_line_s {
+  uint8_t bytes[64];
+};
+
+/// @brief Get the calling thread's local memory arena.
+///
+/// Each thread keeps its arena for as long as it lives, reusing it for every
+/// work-group it executes, and only reallocates it to grow it.
+///
+/// @param size Bytes the arena must be able to hold.
+///
+/// @return Returns the arena, or null if it couldn't be allocated.
+static void *localMemoryArena(size_t size) {
+  static thread_local std::unique_ptr<arena_line_s[]> arena;
+  static thread_local size_t capacity = 0;
+  const size_t lines =
+      std::max<size_t>((size + sizeof(arena_line_s) - 1) / sizeof(arena_line_s),
+                       1);
+  if (lines > capacity) {
+    arena.reset(new (std::nothrow) arena_line_s[lines]);
+    capacity = arena ? lines : 0;
+  }
+  return arena.get();
+}
+
+/// @brief Get the bytes of local memory arena an ND-range needs.
+///
+/// Each allocation the kernel makes from the arena may be padded up to its
+/// alignment, which is at most `local_memory_alignment`.
+static size_t localMemorySize(const host::kernel_variant_s &variant,
+                              const host::ndrange_info_s &info) {
+  size_t size = variant.local_memory_used + local_memory_alignment;
+  for (const auto &descriptor : info.descriptors) {
+    if (mux_descriptor_info_type_shared_local_buffer == descriptor.type) {
+      size += descriptor.shared_local_buffer_descriptor.size +
+              local_memory_alignment;
+    }
+  }
+  return size;
+}
+
+/// @brief Execute one slice of an ND-range, called by the thread pool.
+///
+/// @param in The `ndrange_slice_s` of the ND-range.
+/// @param info The `host::command_info_ndrange_s` of the ND-range.
+/// @param index Index of the slice to execute.
+static void executeSlice(void *const in, void *const info, void *,
+                         size_t index) {
+  auto *const slice = static_cast<ndrange_slice_s *>(in);
+  auto *const ndrange = static_cast<host::command_info_ndrange_s *>(info);
+  auto *const ndrange_info = ndrange->ndrange_info;
+
+  for (uint8_t k = 0; k < ndrange_info->dimensions; ++k) {
+    if (ndrange_info->global_size[k] == 0) {
+      return;
+    }
+  }
+
+  host::schedule_info_s schedule_info;
+
+  for (uint8_t k = 0; k < 3; k++) {
+    schedule_info.global_size[k] = ndrange_info->global_size[k];
+    schedule_info.global_offset[k] = ndrange_info->global_offset[k];
+    schedule_info.local_size[k] = ndrange_info->local_size[k];
+  }
+  schedule_info.slice = index;
+  schedule_info.total_slices = slice->total_slices;
+  schedule_info.work_dim = static_cast<uint32_t>(ndrange_info->dimensions);
+  schedule_info.local_memory = localMemoryArena(slice->local_memory_size);
+  if (nullptr == schedule_info.local_memory) {
+    slice->failed.store(true, std::memory_order_relaxed);
+    return;
+  }
+
+  if (nullptr == slice->records) {
+    slice->variant->hook(ndrange_info->packed_args.data(), &schedule_info);
+    return;
+  }
+
+  const bool hardware = nullptr != slice->counters;
+  const auto before = host::perf_sample_s::read(hardware);
+  slice->variant->hook(ndrange_info->packed_args.data(), &schedule_info);
+  const auto after = host::perf_sample_s::read(hardware);
+#ifndef CA_HOST_ENABLE_PAPI_COUNTERS
+  if (slice->counters) {
+    slice->counters->accumulateSlice(before, after);
+  }
+#endif
+  auto &record = slice->records[index];
+  record = {before.timestamp, after.timestamp, host::currentThreadIndex()};
+  if (host::sliceProfilingEnabled()) {
+    host::traceSlice(record);
+  }
+}
+
+/// @brief Get the number of work-groups of an ND-range in each dimension.
+static std::array<size_t, 3> numGroups(const host::ndrange_info_s &info) {
+  std::array<size_t, 3> groups;
+  for (size_t k = 0; k < 3; k++) {
+    const size_t local_size = std::max<size_t>(info.local_size[k], 1);
+    groups[k] = (info.global_size[k] + local_size - 1) / local_size;
+  }
+  return groups;
+}
+
+/// @brief Execute an ND-range command.
+///
+/// @return Returns `mux_success`, or `mux_error_out_of_memory` if local memory
+/// couldn't be allocated, or `mux_error_failure` if there is no kernel variant
+/// for the local size.
+static mux_result_t commandNDRange(host::queue_s *queue,
+                                   host::command_info_s *info,
+                                   host::query_pool_s *counters) {
   host::command_info_ndrange_s *const ndrange = &(info->ndrange_command);
 
   auto host_kernel = static_cast<host::kernel_s *>(ndrange->kernel);
 
   auto host_device = static_cast<host::device_s *>(queue->device);
 
-  const size_t slices =
-      host_device->thread_pool.num_threads() * slice_multiplier;
-
   host::kernel_variant_s variant;
   if (mux_success != host_kernel->getKernelVariantForWGSize(
                          info->ndrange_command.ndrange_info->local_size[0],
                          info->ndrange_command.ndrange_info->local_size[1],
                          info->ndrange_command.ndrange_info->local_size[2],
                          &variant)) {
-    return;
+    return mux_error_failure;
   }
 
-  const size_t signal_count =
-      host_device->thread_pool.num_threads() * slice_multiplier;
-
-  std::vector<std::atomic<bool>> signals(signal_count);
-  std::atomic<uint32_t> queued(0);
-  host_device->thread_pool.enqueue_range(
-      [](void *const in, void *const info, void *, size_t index) {
-        auto *const kernel_variant = static_cast<host::kernel_variant_s *>(in);
-        auto *const ndrange = static_cast<host::command_info_ndrange_s *>(info);
-        auto *const ndrange_info = ndrange->ndrange_info;
-        auto host_device =
-            static_cast<host::device_s *>(ndrange->kernel->device);
-
-        for (uint8_t k = 0; k < ndrange_info->dimensions; ++k) {
-          if (ndrange_info->global_size[k] == 0) {
-            return;
-          }
-        }
+  const auto groups = numGroups(*ndrange->ndrange_info);
+  const uint64_t group_time =
+      host_kernel->group_time.load(std::memory_order_relaxed);
+  const size_t slices = host::chooseSlices(
+      group_time, groups,
+      host_device->thread_pool.num_threads() * slice_multiplier);
+
+  // Each slice writes only its own record, so no synchronization is needed
+  // beyond waiting for the slices to finish.
+  const bool profile = counters || host::sliceProfilingEnabled();
+  std::vector<host::slice_record_s> records(profile ? slices : 0);
+  ndrange_slice_s slice = {&variant, counters,
+                           profile ? records.data() : nullptr, slices,
+                           localMemorySize(variant, *ndrange->ndrange_info)};
+  const uint64_t start = utils::timestampNanoSeconds();
+
+  if (1 == slices) {
+    // Small ND-ranges run on this thread, avoiding waking the thread pool.
+    executeSlice(&slice, ndrange, nullptr, 0);
+  } else {
+    std::vector<std::atomic<bool>> signals(slices);
+    std::atomic<uint32_t> queued(0);
+    host_device->thread_pool.enqueue_range(executeSlice, &slice, ndrange,
+                                           signals, &queued, slices);
+
+    // Ensure all threads to be done with 'queued' by the time it gets
+    // destroyed. Worker threads don't touch 'queued' after decrementing it,
+    // so once it reaches zero it is safe to destroy.
+    host_device->thread_pool.wait(&queued);
+    assert(0 == queued);
+  }
 
-        host::schedule_info_s schedule_info;
+  if (slice.failed.load(std::memory_order_relaxed)) {
+    return mux_error_out_of_memory;
+  }
 
-        for (uint8_t k = 0; k < 3; k++) {
-          schedule_info.global_size[k] = ndrange_info->global_size[k];
-          schedule_info.global_offset[k] = ndrange_info->global_offset[k];
-          schedule_info.local_size[k] = ndrange_info->local_size[k];
-        }
-        schedule_info.slice = index;
-        schedule_info.total_slices =
-            (host_device->thread_pool.num_threads() * slice_multiplier);
-        schedule_info.work_dim =
-            static_cast<uint32_t>(ndrange_info->dimensions);
+  const uint64_t end = utils::timestampNanoSeconds();
+  // Other ND-ranges of the kernel may have updated the estimate meanwhile.
+  host_kernel->group_time.store(
+      host::updateGroupTime(
+          host_kernel->group_time.load(std::memory_order_relaxed), groups,
+          slices, end - start),
+      std::memory_order_relaxed);
 
-        kernel_variant->hook(ndrange_info->packed_args.data(), &schedule_info);
-      },
-      &variant, ndrange, signals, &queued, slices);
-
-  // Ensure all threads to be done with 'queued' by the time it gets destroyed.
-  host_device->thread_pool.wait(&queued);
-  {
-    std::unique_lock<std::mutex> lock(host_device->thread_pool.wait_mutex);
-    host_device->thread_pool.finished.wait(lock,
-                                           [&queued] { return queued == 0; });
-  }
-
-  // We do need to wait on for 'queued' to be 0 explicitly here, despite the
-  // thread_pool.wait and the fact that each signals[i] was set under the same
-  // lock that is used when changing 'queued'. This was discovered as seeing
-  // that another thread managed to somehow trigger the counter ('queued')
-  // after it being freed (exiting the scope of the `commandNDRange` function).
-  //
-  // It was previously assumed that when the final signal that was signalled
-  // 'queued' was set to 0 under the same lock and thus 'queued' must always be
-  // zero by the time the above thread_pool.wait() returned, therefore further
-  // investigation is required on this to get rid of the inneficiency of the
-  // extra atomic synchronisation used to guarantee the thread-safety here.
-  assert(0 == queued);
+  if (!profile) {
+    return mux_success;
+  }
+  const auto range = host::range_profile_s::compute(
+      records.data(), records.size(), start, end,
+      host_device->thread_pool.num_threads());
+#ifndef CA_HOST_ENABLE_PAPI_COUNTERS
+  if (counters) {
+    counters->accumulateRange(range, host_device->thread_pool.num_threads());
+  }
+#endif
+  if (host::sliceProfilingEnabled()) {
+    host::traceRange(range, start);
+  }
+  return mux_success;
 }
 
 static void commandUserCallback(host::queue_s *queue,
@@ -369,6 +642,7 @@ static void threadPoolProcessCommands(void *const v_queue,
   auto command_buffer = static_cast<host::command_buffer_s *>(v_command_buffer);
 
   mux_query_duration_result_t duration_query = nullptr;
+  host::query_pool_s *counter_query = nullptr;
 
   for (uint64_t i = 0, e = command_buffer->commands.size(); i < e; i++) {
     host::command_info_s *const info = &(command_buffer->commands[i]);
@@ -394,25 +668,30 @@ static void threadPoolProcessCommands(void *const v_queue,
         commandCopyBuffer(info);
         break;
       case host::command_type_read_image:
-        commandReadImage(info);
+        commandReadImage(queue, info);
         break;
       case host::command_type_write_image:
-        commandWriteImage(info);
+        commandWriteImage(queue, info);
         break;
       case host::command_type_fill_image:
-        commandFillImage(info);
+        commandFillImage(queue, info);
         break;
       case host::command_type_copy_image:
-        commandCopyImage(info);
+        commandCopyImage(queue, info);
         break;
       case host::command_type_copy_image_to_buffer:
-        commandCopyImageToBuffer(info);
+        commandCopyImageToBuffer(queue, info);
         break;
       case host::command_type_copy_buffer_to_image:
-        commandCopyBufferToImage(info);
+        commandCopyBufferToImage(queue, info);
         break;
       case host::command_type_ndrange:
-        commandNDRange(queue, info);
+        if (mux_success != commandNDRange(queue, info, counter_query)) {
+          // The commands after a failed ND-range may depend on it, so fail
+          // the whole command group.
+          threadPoolCleanup(v_queue, v_command_buffer, v_fence, true);
+          return;
+        }
         break;
       case host::command_type_user_callback:
         commandUserCallback(queue, info, command_buffer);
@@ -421,21 +700,26 @@ static void threadPoolProcessCommands(void *const v_queue,
         if (info->end_query_command.pool->type == mux_query_type_duration) {
           duration_query = commandBeginQuery(info, duration_query);
         }
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
         if (info->end_query_command.pool->type == mux_query_type_counter) {
+#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
           commandBeginQuery(info);
-        }
+#else
+          counter_query =
+              static_cast<host::query_pool_s *>(info->begin_query_command.pool);
 #endif
+        }
         break;
       case host::command_type_end_query:
         if (info->end_query_command.pool->type == mux_query_type_duration) {
           duration_query = commandEndQuery(info, duration_query);
         }
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
         if (info->end_query_command.pool->type == mux_query_type_counter) {
+#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
           commandEndQuery(info);
-        }
+#else
+          counter_query = nullptr;
 #endif
+        }
         break;
       case host::command_type_reset_query_pool:
         commandResetQueryPool(info);
@@ -517,6 +801,36 @@ mux_result_t queue_s::addGroup(mux_command_buffer_t group, mux_fence_t fence,
 
   return mux_success;
 }
+
+size_t chooseSlices(uint64_t group_time, const std::array<size_t, 3> &groups,
+                    size_t max_slices) {
+  const size_t useful_slices = std::min(max_slices, groups[0]);
+  if (useful_slices <= 1) {
+    return 1;
+  }
+  if (0 == group_time) {
+    // Nothing is known about the kernel yet, assume it's expensive.
+    return useful_slices;
+  }
+  const uint64_t total_time = group_time * groups[0] * groups[1] * groups[2];
+  if (total_time < inline_ndrange_time) {
+    return 1;
+  }
+  return std::clamp<size_t>(total_time / min_slice_time, 1, useful_slices);
+}
+
+uint64_t updateGroupTime(uint64_t group_time,
+                         const std::array<size_t, 3> &groups, size_t slices,
+                         uint64_t time) {
+  const uint64_t total_groups = groups[0] * groups[1] * groups[2];
+  if (0 == total_groups) {
+    return group_time;
+  }
+  // Each thread executed about a slice's share of the work-groups, this
+  // overestimates the time as it includes handing the slices to the threads.
+  const uint64_t sample = std::max<uint64_t>(time * slices / total_groups, 1);
+  return group_time ? (group_time * 3 + sample) / 4 : sample;
+}
 }  // namespace host
 
 mux_result_t hostGetQueue(mux_device_t device, mux_queue_type_e, uint32_t,
@@ -583,8 +897,7 @@ mux_result_t hostWaitAll(mux_queue_t queue) {
 
   // Wait for all work to have left the thread pool, this occurs when the
   // runningGroups atomic reaches zero.
-  std::unique_lock<std::mutex> lock(hostPool.wait_mutex);
-  hostPool.finished.wait(lock, [host] { return 0 == host->runningGroups; });
+  hostPool.completed.wait([host] { return 0 == host->runningGroups; });
 
   return mux_success;
 }
@@ -30,33 +30,22 @@ static void threadFuncBody(host::thread_pool_s *const me,
   const tracer::TraceGuard<tracer::Impl> traceGuard(__func__);
 
   item.function(item.user_data, item.user_data2, item.user_data3, item.index);
-  // technically our condition variable doesn't need this to be locked, but
-  // in practice we could erroneously wait for work in wait() if we don't
-  // hold this mutex before signalling the work item is complete.
-  bool reached_zero{false};
-  {
-    const std::scoped_lock guard(me->wait_mutex);
-
-    // Signal that we've completed this bit of work.  Count gets decremented
-    // after signal gets set because if a program is waiting on a single
-    // command-group to finish the global count does not matter, but if a user
-    // is waiting on the entire queue to finish we need to ensure that we are
-    // completely done with all command-groups (i.e. set item.signal) before
-    // item.count reaches zero.
-    // Signal is optional, it could be null.
-    if (item.signal) {
-      *(item.signal) = true;
-    }
-    *(item.count) -= 1u;
-    reached_zero = (*item.count == 0);
-  }
 
-  if (reached_zero) {
-    me->finished.notify_all();
+  // Signal that we've completed this bit of work.  Count gets decremented
+  // after signal gets set because if a program is waiting on a single
+  // command-group to finish the global count does not matter, but if a user
+  // is waiting on the entire queue to finish we need to ensure that we are
+  // completely done with all command-groups (i.e. set item.signal) before
+  // item.count reaches zero.
+  // Signal is optional, it could be null.
+  if (item.signal) {
+    *(item.signal) = true;
   }
+  *(item.count) -= 1u;
 
-  // signal anything waiting that the work is complete
-  me->done_work.notify_all();
+  // Waiters may destroy the signal and count as soon as they observe them, so
+  // only the thread pool itself can be touched from here on.
+  me->completed.notify_all();
 }
 
 /// The function for each cargo::thread to call.
@@ -71,7 +60,8 @@ static void threadFunc(host::thread_pool_s *const me) {
 }
 
 namespace host {
-thread_pool_s::thread_pool_s() : stayAlive(true) {
+thread_pool_s::thread_pool_s(const cpu_affinity_s &affinity)
+    : stayAlive(true) {
   const tracer::TraceGuard<tracer::Impl> traceGuard(__func__);
 
   auto clamp = [](size_t v, size_t a, size_t b) {
@@ -81,9 +71,14 @@ thread_pool_s::thread_pool_s() : stayAlive(true) {
     return std::max(start, std::min(v, end));
   };
 
-  const size_t hw_threads = cargo::thread::hardware_concurrency();
+  // A pinned pool runs exactly one thread on each of its CPUs, which were
+  // chosen explicitly.
+  const size_t hw_threads = affinity.pinned
+                                ? affinity.cpus.size()
+                                : cargo::thread::hardware_concurrency();
   const size_t desired_threads =
-      clamp(hw_threads - ca_free_hw_threads, 2, hw_threads);
+      affinity.pinned ? hw_threads
+                      : clamp(hw_threads - ca_free_hw_threads, 2, hw_threads);
   size_t debug_threads = hw_threads;
 
   // Register the value of the CA_HOST_NUM_THREADS environment variable.
@@ -103,6 +98,10 @@ thread_pool_s::thread_pool_s() : stayAlive(true) {
   for (size_t i = 0, e = num_threads(); i < e; i++) {
     pool[i] = cargo::thread(threadFunc, this);
     pool[i].set_name("host:pool:" + std::to_string(i));
+    if (affinity.pinned) {
+      // Pinning is a performance hint, an unpinned thread still works.
+      (void)pinThread(pool[i], affinity.cpus[i].id);
+    }
   }
 }
 
@@ -191,16 +190,8 @@ void thread_pool_s::enqueue(function_t function, void *user_data,
 
     while (queue_read_index == next_write_index) {
       // We've entirely filled our work buffer! Need to wait until a space
-      // opens so unlock the queue mutex, acquire the wait mutex, notify the
-      // pool that some work needs doing and wait for an item to complete.
-      {
-        std::unique_lock<std::mutex> wait_lock(wait_mutex);
-        lock.unlock();
-        new_work.notify_one();
-        done_work.wait(wait_lock);
-        lock.lock();
-      }
-
+      // opens.
+      waitForSpace(lock);
       next_write_index = (queue_write_index + 1) % queue_max;
     }
 
@@ -213,6 +204,20 @@ void thread_pool_s::enqueue(function_t function, void *user_data,
   new_work.notify_one();
 }
 
+void thread_pool_s::waitForSpace(std::unique_lock<std::mutex> &lock) {
+  // Unlock the queue mutex, notify the pool that some work needs doing and
+  // wait for an item to be taken off the queue. Items are only taken off by
+  // threads which will go on to complete them, so the notification after the
+  // item completes is sufficient to wake us.
+  lock.unlock();
+  new_work.notify_one();
+  completed.wait([this] {
+    const std::scoped_lock guard(mutex);
+    return queue_read_index != (queue_write_index + 1) % queue_max;
+  });
+  lock.lock();
+}
+
 void thread_pool_s::wait(std::atomic<bool> *signal) {
   const tracer::TraceGuard<tracer::Impl> traceGuard(__func__);
 
@@ -229,10 +234,7 @@ void thread_pool_s::wait(std::atomic<bool> *signal) {
     }
 
     // Now we check if the signal is done.
-    if (false == *signal) {
-      std::unique_lock<std::mutex> guard(wait_mutex);
-      done_work.wait(guard, [signal] { return signal->load(); });
-    }
+    completed.wait([signal] { return signal->load(); });
   }
 }
 
@@ -252,10 +254,7 @@ void thread_pool_s::wait(std::atomic<uint32_t> *count) {
     }
 
     // Now we check if the count has reached zero.
-    if (*count != 0) {
-      std::unique_lock<std::mutex> guard(wait_mutex);
-      finished.wait(guard, [count] { return *count == 0; });
-    }
+    completed.wait([count] { return *count == 0; });
   }
 }
 }  // namespace host
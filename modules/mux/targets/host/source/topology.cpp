@@ -0,0 +1,220 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <host/topology.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+/// @brief Parse a list of ranges such as `0-3,8,10-11`, as used by sysfs.
+bool parseList(const char *list, std::vector<uint32_t> &values) {
+  values.clear();
+  const char *cursor = list;
+  while (*cursor && *cursor != '\n') {
+    char *end;
+    const unsigned long first = std::strtoul(cursor, &end, 10);
+    if (end == cursor) {
+      return false;
+    }
+    unsigned long last = first;
+    cursor = end;
+    if ('-' == *cursor) {
+      last = std::strtoul(cursor + 1, &end, 10);
+      // Reject nonsensical ranges rather than allocating for them.
+      if (end == cursor + 1 || last < first || last - first > 65536) {
+        return false;
+      }
+      cursor = end;
+    }
+    for (unsigned long value = first; value <= last; value++) {
+      values.push_back(static_cast<uint32_t>(value));
+    }
+    if (',' == *cursor) {
+      cursor++;
+    } else if (*cursor && '\n' != *cursor) {
+      return false;
+    }
+  }
+  return !values.empty();
+}
+
+#ifdef __linux__
+/// @brief Read a list of ranges from a sysfs file.
+bool readList(const std::string &path, std::vector<uint32_t> &values) {
+  FILE *const file = fopen(path.c_str(), "r");
+  if (nullptr == file) {
+    return false;
+  }
+  char buffer[4096];
+  const bool read = nullptr != fgets(buffer, sizeof(buffer), file);
+  (void)fclose(file);
+  return read && parseList(buffer, values);
+}
+#endif
+}  // namespace
+
+namespace host {
+cargo::optional<uint32_t> cpu_affinity_s::node() const {
+  if (!pinned || cpus.empty() || countNodes(cpus) != 1) {
+    return cargo::nullopt;
+  }
+  return cpus.front().node;
+}
+
+const std::vector<cpu_s> &availableCpus() {
+  static const std::vector<cpu_s> cpus = [] {
+    std::vector<cpu_s> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (0 == sched_getaffinity(0, sizeof(set), &set)) {
+      for (uint32_t id = 0; id < CPU_SETSIZE; id++) {
+        if (CPU_ISSET(id, &set)) {
+          cpus.push_back({id, 0});
+        }
+      }
+    }
+    std::vector<uint32_t> nodes;
+    std::vector<uint32_t> node_cpus;
+    if (readList("/sys/devices/system/node/online", nodes)) {
+      for (const uint32_t node : nodes) {
+        if (!readList("/sys/devices/system/node/node" + std::to_string(node) +
+                          "/cpulist",
+                      node_cpus)) {
+          continue;
+        }
+        for (auto &cpu : cpus) {
+          if (std::find(node_cpus.begin(), node_cpus.end(), cpu.id) !=
+              node_cpus.end()) {
+            cpu.node = node;
+          }
+        }
+      }
+    }
+    std::stable_sort(
+        cpus.begin(), cpus.end(),
+        [](const cpu_s &lhs, const cpu_s &rhs) { return lhs.node < rhs.node; });
+#endif
+    if (cpus.empty()) {
+      const uint32_t count =
+          std::max(1u, cargo::thread::hardware_concurrency());
+      for (uint32_t id = 0; id < count; id++) {
+        cpus.push_back({id, 0});
+      }
+    }
+    return cpus;
+  }();
+  return cpus;
+}
+
+const cpu_affinity_s &rootAffinity() {
+  static const cpu_affinity_s affinity = [] {
+    cpu_affinity_s affinity;
+    affinity.cpus = availableCpus();
+    const char *env = std::getenv("CA_HOST_AFFINITY");
+    if (nullptr == env) {
+      return affinity;
+    }
+    std::vector<cpu_s> selected;
+    std::vector<uint32_t> ids;
+    if (0 == std::strncmp(env, "numa:", 5)) {
+      char *end;
+      const unsigned long node = std::strtoul(env + 5, &end, 10);
+      if (end != env + 5 && '\0' == *end) {
+        std::copy_if(affinity.cpus.begin(), affinity.cpus.end(),
+                     std::back_inserter(selected),
+                     [node](const cpu_s &cpu) { return cpu.node == node; });
+      }
+    } else if (parseList(env, ids)) {
+      std::copy_if(affinity.cpus.begin(), affinity.cpus.end(),
+                   std::back_inserter(selected), [&ids](const cpu_s &cpu) {
+                     return std::find(ids.begin(), ids.end(), cpu.id) !=
+                            ids.end();
+                   });
+    }
+    // An affinity which selects no usable CPUs is ignored.
+    if (!selected.empty()) {
+      affinity.cpus = std::move(selected);
+      affinity.pinned = true;
+    }
+    return affinity;
+  }();
+  return affinity;
+}
+
+uint32_t countNodes(const std::vector<cpu_s> &cpus) {
+  // CPUs are ordered by node, so each new node starts a new run.
+  uint32_t count = 0;
+  for (size_t index = 0; index < cpus.size(); index++) {
+    if (0 == index || cpus[index].node != cpus[index - 1].node) {
+      count++;
+    }
+  }
+  return count;
+}
+
+bool pinThread(cargo::thread &thread, uint32_t cpu) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  if (cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return 0 == pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+  (void)thread;
+  (void)cpu;
+  return false;
+#endif
+}
+
+void preferNode(void *pointer, size_t size, uint32_t node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+  const uintptr_t begin = (address + page_size - 1) & ~(page_size - 1);
+  const uintptr_t end = (address + size) & ~(page_size - 1);
+  if (begin >= end) {
+    return;
+  }
+  constexpr size_t bits = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> mask(node / bits + 1, 0);
+  mask[node / bits] |= 1ul << (node % bits);
+  // Pages which have already been touched keep their placement, moving them
+  // would cost more than it saves.
+  (void)syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, mask.data(),
+                mask.size() * bits + 1, 0);
+#else
+  (void)pointer;
+  (void)size;
+  (void)node;
+#endif
+}
+}  // namespace host
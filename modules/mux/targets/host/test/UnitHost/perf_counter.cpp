@@ -0,0 +1,90 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <gtest/gtest.h>
+#include <host/perf_counter.h>
+
+#include <vector>
+
+TEST(RangeProfileTest, EmptyRecords) {
+  const auto profile = host::range_profile_s::compute(nullptr, 0, 100, 250, 4);
+  EXPECT_EQ(150u, profile.wall_time);
+  EXPECT_EQ(0u, profile.slice_time);
+  EXPECT_EQ(0u, profile.max_slice_time);
+  EXPECT_EQ(0u, profile.mean_slice_time);
+  EXPECT_EQ(0u, profile.handshake_time);
+  EXPECT_EQ(0u, profile.threads);
+  EXPECT_EQ(0.0, profile.idle_fraction);
+}
+
+TEST(RangeProfileTest, UntimedSlicesIgnored) {
+  // Slices of empty ND-ranges return before they are timed.
+  const std::vector<host::slice_record_s> records = {
+      {0, 0, 0}, {0, 0, 1}, {0, 0, 2}};
+  const auto profile = host::range_profile_s::compute(
+      records.data(), records.size(), 100, 200, 3);
+  EXPECT_EQ(100u, profile.wall_time);
+  EXPECT_EQ(0u, profile.slice_time);
+  EXPECT_EQ(0u, profile.threads);
+}
+
+TEST(RangeProfileTest, OverlappingSlices) {
+  // Two threads run overlapping slices, one of which is never timed.
+  const std::vector<host::slice_record_s> records = {
+      {110, 160, 0}, {120, 190, 1}, {160, 170, 0}, {0, 0, 1}};
+  const auto profile = host::range_profile_s::compute(
+      records.data(), records.size(), 100, 200, 2);
+  EXPECT_EQ(100u, profile.wall_time);
+  EXPECT_EQ(130u, profile.slice_time);
+  EXPECT_EQ(70u, profile.max_slice_time);
+  EXPECT_EQ(43u, profile.mean_slice_time);
+  // From the hand off to the first start, and from the last end to the end.
+  EXPECT_EQ(20u, profile.handshake_time);
+  EXPECT_EQ(2u, profile.threads);
+  EXPECT_DOUBLE_EQ(0.35, profile.idle_fraction);
+}
+
+TEST(RangeProfileTest, IdleThreads) {
+  // Only one of the four threads in the pool ran any slices.
+  const std::vector<host::slice_record_s> records = {{100, 150, 3},
+                                                     {150, 200, 3}};
+  const auto profile = host::range_profile_s::compute(
+      records.data(), records.size(), 100, 200, 4);
+  EXPECT_EQ(100u, profile.slice_time);
+  EXPECT_EQ(50u, profile.mean_slice_time);
+  EXPECT_EQ(0u, profile.handshake_time);
+  EXPECT_EQ(1u, profile.threads);
+  EXPECT_DOUBLE_EQ(0.75, profile.idle_fraction);
+}
+
+TEST(RangeProfileTest, InconsistentTimestamps) {
+  // Slices which appear to run outside of the ND-range, or backwards, must
+  // not underflow.
+  const std::vector<host::slice_record_s> records = {{90, 210, 0},
+                                                     {180, 170, 1}};
+  const auto profile = host::range_profile_s::compute(
+      records.data(), records.size(), 100, 200, 1);
+  EXPECT_EQ(120u, profile.slice_time);
+  EXPECT_EQ(120u, profile.max_slice_time);
+  EXPECT_EQ(0u, profile.handshake_time);
+  EXPECT_EQ(2u, profile.threads);
+  EXPECT_EQ(0.0, profile.idle_fraction);
+
+  const auto backwards = host::range_profile_s::compute(
+      records.data(), records.size(), 200, 100, 1);
+  EXPECT_EQ(0u, backwards.wall_time);
+  EXPECT_EQ(0.0, backwards.idle_fraction);
+}
@@ -0,0 +1,93 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <gtest/gtest.h>
+#include <host/queue.h>
+
+TEST(ChooseSlicesTest, UnknownKernel) {
+  // Kernels which haven't run yet are assumed to be expensive.
+  EXPECT_EQ(8u, host::chooseSlices(0, {64, 1, 1}, 8));
+  EXPECT_EQ(8u, host::chooseSlices(0, {8, 1, 1}, 8));
+}
+
+TEST(ChooseSlicesTest, FewGroups) {
+  // Slices only divide work-groups in the first dimension.
+  EXPECT_EQ(4u, host::chooseSlices(0, {4, 100, 100}, 8));
+  EXPECT_EQ(1u, host::chooseSlices(0, {1, 100, 100}, 8));
+  EXPECT_EQ(1u, host::chooseSlices(1000000, {1, 100, 100}, 8));
+  EXPECT_EQ(1u, host::chooseSlices(0, {0, 0, 0}, 8));
+}
+
+TEST(ChooseSlicesTest, SingleThread) {
+  EXPECT_EQ(1u, host::chooseSlices(0, {64, 1, 1}, 1));
+  EXPECT_EQ(1u, host::chooseSlices(1000000, {64, 1, 1}, 1));
+  EXPECT_EQ(1u, host::chooseSlices(0, {64, 1, 1}, 0));
+}
+
+TEST(ChooseSlicesTest, Inline) {
+  // ND-ranges cheaper than handing them to the thread pool run inline.
+  EXPECT_EQ(1u, host::chooseSlices(1, {64, 1, 1}, 8));
+  const uint64_t group_time = host::inline_ndrange_time / 64;
+  EXPECT_EQ(1u, host::chooseSlices(group_time - 1, {64, 1, 1}, 8));
+  EXPECT_EQ(1u, host::chooseSlices(group_time - 1, {32, 2, 1}, 8));
+}
+
+TEST(ChooseSlicesTest, MinSliceTime) {
+  // Each slice has at least the minimum amount of work.
+  const uint64_t group_time = host::inline_ndrange_time / 64 + 1;
+  EXPECT_EQ(group_time * 64 / host::min_slice_time,
+            host::chooseSlices(group_time, {64, 1, 1}, 8));
+  EXPECT_EQ(4u,
+            host::chooseSlices(host::min_slice_time * 4 / 64, {64, 1, 1}, 8));
+  // All dimensions count towards the work.
+  EXPECT_EQ(4u,
+            host::chooseSlices(host::min_slice_time * 4 / 64, {16, 2, 2}, 8));
+}
+
+TEST(ChooseSlicesTest, MaxSlices) {
+  // Expensive ND-ranges occupy every thread, but no more.
+  EXPECT_EQ(8u, host::chooseSlices(1000000, {64, 1, 1}, 8));
+  EXPECT_EQ(6u, host::chooseSlices(1000000, {6, 1, 1}, 8));
+}
+
+TEST(UpdateGroupTimeTest, FirstSample) {
+  // 8 slices took 1000ns to execute 64 work-groups.
+  EXPECT_EQ(125u, host::updateGroupTime(0, {64, 1, 1}, 8, 1000));
+  EXPECT_EQ(125u, host::updateGroupTime(0, {16, 2, 2}, 8, 1000));
+  EXPECT_EQ(1000u, host::updateGroupTime(0, {1, 1, 1}, 1, 1000));
+}
+
+TEST(UpdateGroupTimeTest, MovingAverage) {
+  // New samples are weighted by a quarter.
+  EXPECT_EQ(175u, host::updateGroupTime(100, {64, 1, 1}, 8, 3200));
+  EXPECT_EQ(100u, host::updateGroupTime(100, {64, 1, 1}, 8, 800));
+  uint64_t group_time = 1000;
+  for (int i = 0; i < 100; i++) {
+    group_time = host::updateGroupTime(group_time, {10, 1, 1}, 1, 100);
+  }
+  EXPECT_EQ(10u, group_time);
+}
+
+TEST(UpdateGroupTimeTest, MinimumSample) {
+  // Samples are never zero, which would mean the kernel is unknown.
+  EXPECT_EQ(1u, host::updateGroupTime(0, {64, 1, 1}, 1, 0));
+  EXPECT_EQ(1u, host::updateGroupTime(1, {64, 1, 1}, 1, 10));
+}
+
+TEST(UpdateGroupTimeTest, NoGroups) {
+  EXPECT_EQ(0u, host::updateGroupTime(0, {0, 1, 1}, 1, 1000));
+  EXPECT_EQ(50u, host::updateGroupTime(50, {64, 0, 1}, 1, 1000));
+}
@@ -62,6 +62,8 @@ struct command_read_buffer_s {
   uint64_t size;
 
   void operator()(riscv::device_s *device, bool &error);
+
+  [[nodiscard]] bool submit(riscv::queue_s *queue, uint64_t ticket);
 };
 
 struct command_write_buffer_s {
@@ -71,6 +73,8 @@ struct command_write_buffer_s {
   uint64_t size;
 
   void operator()(riscv::device_s *device, bool &error);
+
+  [[nodiscard]] bool submit(riscv::queue_s *queue, uint64_t ticket);
 };
 
 struct command_copy_buffer_s {
@@ -81,6 +85,8 @@ struct command_copy_buffer_s {
   uint64_t size;
 
   void operator()(riscv::device_s *device, bool &error);
+
+  [[nodiscard]] bool submit(riscv::queue_s *queue, uint64_t ticket);
 };
 
 struct command_fill_buffer_s {
@@ -91,6 +97,8 @@ struct command_fill_buffer_s {
   uint64_t pattern_size;
 
   void operator()(riscv::device_s *device, bool &error);
+
+  [[nodiscard]] bool submit(riscv::queue_s *queue, uint64_t ticket);
 };
 
 struct command_ndrange_s {
@@ -103,8 +111,33 @@ struct command_ndrange_s {
   std::array<size_t, 3> global_offset;
   std::array<size_t, 3> local_size;
   size_t dimensions;
+  bool indirect_memory_access;
 
   void operator()(riscv::queue_s *queue, bool &error);
+
+  [[nodiscard]] bool submit(riscv::queue_s *queue, uint64_t ticket);
+
+ private:
+  /// @brief Load the kernel's program and find the variant to execute.
+  ///
+  /// @return Returns the loaded program, which the caller must free, or
+  /// `hal_invalid_program` on failure.
+  hal::hal_program_t load(hal::hal_device_t *hal_device,
+                          hal::hal_kernel_t &hal_kernel,
+                          hal::hal_ndrange_t &hal_ndrange);
+
+  /// @brief Determine whether the kernel may access memory other than the
+  /// buffers it is passed, through pointers passed by value or loaded from
+  /// memory.
+  ///
+  /// @param pointer_size Size in bytes of a pointer on the device.
+  bool mayAccessAnyMemory(size_t pointer_size) const;
+
+  /// @brief Mark every buffer passed to the kernel as written by the device,
+  /// or every shadowed memory if the kernel may access any memory.
+  ///
+  /// @param pointer_size Size in bytes of a pointer on the device.
+  void invalidateBuffers(size_t pointer_size);
 };
 
 struct command_user_callback_s {
@@ -193,6 +226,17 @@ struct command_buffer_s final : public mux_command_buffer_s {
 
   mux_result_t execute(riscv::queue_s *queue) CARGO_TS_REQUIRES(mutex);
 
+  /// @brief Submit the commands to the HAL's asynchronous API, returning
+  /// before they have necessarily completed.
+  ///
+  /// @param queue Queue the command buffer was dispatched to.
+  /// @param ticket Identifies this dispatch's operations in the queue's
+  /// pipeline, they are completed by `riscv::pipeline_s::retire`.
+  ///
+  /// @return Returns `mux_success` if every command was submitted.
+  mux_result_t submit(riscv::queue_s *queue, uint64_t ticket)
+      CARGO_TS_REQUIRES(mutex);
+
   mux::small_vector<riscv::command_s, 16> commands CARGO_TS_GUARDED_BY(mutex);
   mux::small_vector<mux::dynamic_array<uint8_t>, 16> pod_data_allocs
       CARGO_TS_GUARDED_BY(mutex);
@@ -0,0 +1,141 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Tracking of asynchronous HAL operations for the RISC-V target.
+
+#ifndef RISCV_PIPELINE_H_INCLUDED
+#define RISCV_PIPELINE_H_INCLUDED
+
+#include "cargo/array_view.h"
+#include "hal.h"
+#include "mux/mux.h"
+#include "mux/utils/small_vector.h"
+
+namespace riscv {
+/// @addtogroup riscv
+/// @{
+
+/// @brief Tracks operations submitted through the asynchronous HAL API which
+/// may still be running, along with the memory they access, so that each new
+/// operation only waits for the in-flight operations it conflicts with.
+///
+/// Operations are grouped by a ticket identifying the dispatch which submitted
+/// them, so that a dispatch can be completed independently of any later
+/// dispatches which have already been submitted.
+struct pipeline_s {
+  /// @brief The address space a memory access refers to.
+  enum space_e : uint32_t { space_host, space_device };
+
+  /// @brief A range of memory accessed by an operation.
+  struct access_s {
+    space_e space;
+    uint64_t address;
+    uint64_t size;
+    bool write;
+  };
+
+  /// @brief Constructor.
+  ///
+  /// @param allocator Allocator used for the tracking storage.
+  explicit pipeline_s(mux::allocator allocator)
+      : operations{allocator}, accesses{allocator} {}
+
+  /// @brief Submit an operation which waits for any conflicting operations.
+  ///
+  /// @tparam SubmitFn Callable taking `(const hal_event_t *, uint32_t)` which
+  /// submits the operation and returns its event.
+  /// @param hal_device HAL device the operation is submitted to.
+  /// @param ticket Identifies the dispatch submitting the operation.
+  /// @param operation_accesses Memory accessed by the operation.
+  /// @param program Program to free once the operation completes, or
+  /// `hal_invalid_program`, the pipeline takes ownership even on failure.
+  /// @param submit_fn Function submitting the operation.
+  ///
+  /// @return Returns `true` on success, `false` if submission failed.
+  template <class SubmitFn>
+  [[nodiscard]] bool submit(
+      ::hal::hal_device_t *hal_device, uint64_t ticket,
+      cargo::array_view<const access_s> operation_accesses,
+      ::hal::hal_program_t program, SubmitFn &&submit_fn) {
+    mux::small_vector<::hal::hal_event_t, 8> wait_events{
+        accesses.get_allocator()};
+    ::hal::hal_event_t event = ::hal::hal_invalid_event;
+    if (!dependencies(operation_accesses, wait_events)) {
+      event = submit_fn(wait_events.empty() ? nullptr : wait_events.data(),
+                        static_cast<uint32_t>(wait_events.size()));
+    }
+    if (event == ::hal::hal_invalid_event) {
+      if (program != ::hal::hal_invalid_program) {
+        hal_device->program_free(program);
+      }
+      return false;
+    }
+    return track(hal_device, event, ticket, program, operation_accesses);
+  }
+
+  /// @brief Wait for every in-flight operation to complete, without retiring
+  /// them.
+  ///
+  /// @param hal_device HAL device the operations were submitted to.
+  /// @param ticket Ticket whose operations must have succeeded.
+  ///
+  /// @return Returns `false` if any operation submitted with `ticket` failed.
+  bool wait_all(::hal::hal_device_t *hal_device, uint64_t ticket);
+
+  /// @brief Wait for every operation submitted with a ticket, then release
+  /// their events and free their programs.
+  ///
+  /// @param hal_device HAL device the operations were submitted to.
+  /// @param ticket Ticket whose operations to retire.
+  ///
+  /// @return Returns `false` if any of the operations failed.
+  bool retire(::hal::hal_device_t *hal_device, uint64_t ticket);
+
+ private:
+  struct operation_s {
+    ::hal::hal_event_t event;
+    uint64_t ticket;
+    ::hal::hal_program_t program;
+  };
+
+  struct tracked_access_s {
+    ::hal::hal_event_t event;
+    access_s access;
+  };
+
+  /// @brief Gather the events of in-flight operations which conflict with a
+  /// set of memory accesses.
+  [[nodiscard]] mux_result_t dependencies(
+      cargo::array_view<const access_s> operation_accesses,
+      mux::small_vector<::hal::hal_event_t, 8> &wait_events);
+
+  /// @brief Record a submitted operation, on failure the operation is waited
+  /// for and released and its program is freed.
+  [[nodiscard]] bool track(
+      ::hal::hal_device_t *hal_device, ::hal::hal_event_t event,
+      uint64_t ticket, ::hal::hal_program_t program,
+      cargo::array_view<const access_s> operation_accesses);
+
+  mux::small_vector<operation_s, 32> operations;
+  mux::small_vector<tracked_access_s, 64> accesses;
+};
+
+/// @}
+}  // namespace riscv
+
+#endif  // RISCV_PIPELINE_H_INCLUDED
@@ -29,6 +29,7 @@
 #include "mux/mux.h"
 #include "mux/utils/small_vector.h"
 #include "riscv/fence.h"
+#include "riscv/pipeline.h"
 #include "riscv/semaphore.h"
 
 namespace riscv {
@@ -45,6 +46,8 @@ struct dispatch_s {
   void (*user_function)(mux_command_buffer_t command_buffer, mux_result_t error,
                         void *const user_data) = nullptr;
   void *user_data = nullptr;
+  /// @brief Identifies the dispatch's operations in the queue's pipeline.
+  uint64_t ticket = 0;
 
   void signal(mux_result_t result);
 
@@ -59,7 +62,11 @@ struct dispatch_s {
 
 struct queue_s final : public mux_queue_s {
   queue_s(mux::allocator allocator, mux_device_t device)
-      : pending{allocator}, running{false}, terminate{false} {
+      : pending{allocator},
+        in_flight{allocator},
+        pipeline{allocator},
+        running{false},
+        terminate{false} {
     this->device = device;
     const cargo::lock_guard<cargo::mutex> lock(mutex);
     thread = cargo::thread{[this]() { run(); }};
@@ -87,8 +94,26 @@ struct queue_s final : public mux_queue_s {
 
   void run();
 
+  /// @brief Report a dispatch's result and signal its semaphores and fence.
+  void complete(riscv::dispatch_s &dispatch, mux_result_t result);
+
+  /// @brief Wait for the oldest in-flight dispatch to finish and complete it.
+  void retire();
+
   mux::small_vector<riscv::dispatch_s, 32> pending CARGO_TS_GUARDED_BY(mutex);
 
+  /// @brief Dispatches whose commands have been submitted to the HAL but may
+  /// not have finished, in submission order. Only accessed by the queue
+  /// thread.
+  mux::small_vector<riscv::dispatch_s, 4> in_flight;
+
+  /// @brief Operations submitted to the HAL by the in-flight dispatches.
+  /// Only accessed by the queue thread.
+  riscv::pipeline_s pipeline;
+
+  /// @brief Ticket for the next dispatch submitted to the pipeline.
+  uint64_t next_ticket = 1;
+
   cargo::thread thread;
   cargo::mutex mutex;
   std::condition_variable_any condition_variable;
@@ -80,6 +80,37 @@ mux_result_t riscvCreateDevices(uint64_t devices_length,
 void riscvDestroyDevice(mux_device_t device,
                         mux_allocator_info_t allocator_info);
 
+/// @brief Partition a device into sub-devices.
+///
+/// Each sub-device executes commands on a disjoint subset of the compute units
+/// of device, and is destroyed with muxDestroyDevice. Entry point is optional
+/// and must return mux_error_feature_unsupported if partition is not in
+/// `::mux_device_info_s::partition_capabilities`.
+///
+/// @param[in] device A Mux device to partition.
+/// @param[in] partition How to partition the device, a single bit of
+/// `::mux_device_info_s::partition_capabilities`.
+/// @param[in] counts_length The length of counts, must be 0 unless partition
+/// is `::mux_partition_capabilities_compute_units`.
+/// @param[in] counts Array of the number of compute units in each sub-device.
+/// @param[in] allocator_info Allocator information.
+/// @param[in] sub_devices_length The length of out_sub_devices. Must be 0, if
+/// out_sub_devices is null.
+/// @param[out] out_sub_devices Array of created sub-devices, or null if an
+/// error occurred. Can be null, if out_sub_devices_length is non-null.
+/// @param[out] out_sub_devices_length The number of sub-devices the partition
+/// results in. Can be null, if out_sub_devices is non-null.
+///
+/// @return mux_success, or a mux_error_* if an error occurred.
+mux_result_t riscvCreateSubDevices(mux_device_t device,
+                                   mux_partition_capabilities_e partition,
+                                   uint32_t counts_length,
+                                   const uint32_t *counts,
+                                   mux_allocator_info_t allocator_info,
+                                   uint32_t sub_devices_length,
+                                   mux_device_t *out_sub_devices,
+                                   uint32_t *out_sub_devices_length);
+
 /// @brief Allocate Mux device memory to be bound to a buffer or image.
 ///
 /// This function uses a Mux device to allocate device memory which can later be
@@ -16,6 +16,9 @@
 
 #include "riscv/command_buffer.h"
 
+#include <iterator>
+
+#include "mux/hal/shadow_memory.h"
 #include "mux/mux.h"
 #include "riscv/fence.h"
 #include "utils/system.h"
@@ -30,6 +33,7 @@ void command_read_buffer_s::operator()(riscv::device_s *device, bool &error) {
 }
 
 void command_write_buffer_s::operator()(riscv::device_s *device, bool &error) {
+  buffer->invalidate(offset, size);
   if (!device->hal_device->mem_write(buffer->targetPtr + offset, host_pointer,
                                      size)) {
     error = true;
@@ -38,6 +42,7 @@ void command_write_buffer_s::operator()(riscv::device_s *device, bool &error) {
 }
 
 void command_copy_buffer_s::operator()(riscv::device_s *device, bool &error) {
+  dst_buffer->invalidate(dst_offset, size);
   if (!device->hal_device->mem_copy(dst_buffer->targetPtr + dst_offset,
                                     src_buffer->targetPtr + src_offset, size)) {
     error = true;
@@ -46,6 +51,7 @@ void command_copy_buffer_s::operator()(riscv::device_s *device, bool &error) {
 }
 
 void command_fill_buffer_s::operator()(riscv::device_s *device, bool &error) {
+  buffer->invalidate(offset, size);
   if (!device->hal_device->mem_fill(buffer->targetPtr + offset, pattern,
                                     pattern_size, size)) {
     error = true;
@@ -53,41 +59,82 @@ void command_fill_buffer_s::operator()(riscv::device_s *device, bool &error) {
   device->profiler.update_counters(*device->hal_device);
 }
 
-void command_ndrange_s::operator()(riscv::queue_s *queue, bool &error) {
-  auto device = static_cast<riscv::device_s *>(queue->device);
-  hal::hal_device_t *hal_device = device->hal_device;
+hal::hal_program_t command_ndrange_s::load(hal::hal_device_t *hal_device,
+                                           hal::hal_kernel_t &hal_kernel,
+                                           hal::hal_ndrange_t &hal_ndrange) {
   assert(kernel && hal_device);
   // ensure the elf file is loaded
   if (kernel->object_code.empty()) {
-    error = true;
-    return;
+    return hal::hal_invalid_program;
   }
   const hal::hal_program_t program = hal_device->program_load(
       kernel->object_code.data(), kernel->object_code.size());
   if (program == hal::hal_invalid_program) {
-    error = true;
-    return;
+    return hal::hal_invalid_program;
   }
   // decide on which kernel to execute
   mux::hal::kernel_variant_s variant;
   if (mux_success !=
       kernel->getKernelVariantForWGSize(local_size[0], local_size[1],
                                         local_size[2], &variant)) {
-    error = true;
-    return;
+    hal_device->program_free(program);
+    return hal::hal_invalid_program;
   }
   // find the kernel entry point
-  auto hal_kernel =
+  hal_kernel =
       hal_device->program_find_kernel(program, variant.variant_name.data());
   if (hal_kernel == hal::hal_invalid_kernel) {
+    hal_device->program_free(program);
+    return hal::hal_invalid_program;
+  }
+  // copy across the ndrange to run
+  hal_ndrange = {{global_offset[0], global_offset[1], global_offset[2]},
+                 {global_size[0], global_size[1], global_size[2]},
+                 {local_size[0], local_size[1], local_size[2]}};
+  return program;
+}
+
+bool command_ndrange_s::mayAccessAnyMemory(size_t pointer_size) const {
+  if (indirect_memory_access) {
+    return true;
+  }
+  for (uint32_t i = 0; i < num_kernel_args; i++) {
+    if (descriptors[i].type == mux_descriptor_info_type_plain_old_data &&
+        descriptors[i].plain_old_data_descriptor.length == pointer_size) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void command_ndrange_s::invalidateBuffers(size_t pointer_size) {
+  // A kernel reaching memory through pointers may write to any allocation,
+  // otherwise it can only write to the buffers it is passed.
+  if (mayAccessAnyMemory(pointer_size)) {
+    mux::hal::shadow_memory::invalidateAll();
+    return;
+  }
+  for (uint32_t i = 0; i < num_kernel_args; i++) {
+    if (descriptors[i].type != mux_descriptor_info_type_buffer) {
+      continue;
+    }
+    auto *buffer =
+        static_cast<riscv::buffer_s *>(descriptors[i].buffer_descriptor.buffer);
+    buffer->invalidate(0, buffer->memory_requirements.size);
+  }
+}
+
+void command_ndrange_s::operator()(riscv::queue_s *queue, bool &error) {
+  auto device = static_cast<riscv::device_s *>(queue->device);
+  hal::hal_device_t *hal_device = device->hal_device;
+  invalidateBuffers(hal_device->get_info()->word_size / 8);
+  hal::hal_kernel_t hal_kernel;
+  hal::hal_ndrange_t hal_ndrange;
+  const hal::hal_program_t program = load(hal_device, hal_kernel, hal_ndrange);
+  if (program == hal::hal_invalid_program) {
     error = true;
     return;
   }
-  // copy across the ndrange to run
-  const hal::hal_ndrange_t hal_ndrange = {
-      {global_offset[0], global_offset[1], global_offset[2]},
-      {global_size[0], global_size[1], global_size[2]},
-      {local_size[0], local_size[1], local_size[2]}};
   // execute the kernel
   const bool success =
       hal_device->kernel_exec(program, hal_kernel, &hal_ndrange, kernel_args,
@@ -99,6 +146,117 @@ void command_ndrange_s::operator()(riscv::queue_s *queue, bool &error) {
   device->profiler.update_counters(*device->hal_device, kernel->name.data());
 }
 
+bool command_read_buffer_s::submit(riscv::queue_s *queue, uint64_t ticket) {
+  auto device = static_cast<riscv::device_s *>(queue->device);
+  const hal::hal_addr_t src = buffer->targetPtr + offset;
+  const riscv::pipeline_s::access_s accesses[] = {
+      {riscv::pipeline_s::space_device, src, size, false},
+      {riscv::pipeline_s::space_host,
+       reinterpret_cast<uint64_t>(host_pointer), size, true}};
+  return queue->pipeline.submit(
+      device->hal_device, ticket, {accesses, std::size(accesses)},
+      hal::hal_invalid_program,
+      [&](const hal::hal_event_t *wait_events, uint32_t num_wait_events) {
+        return device->hal_device->mem_read_async(host_pointer, src, size,
+                                                  wait_events, num_wait_events);
+      });
+}
+
+bool command_write_buffer_s::submit(riscv::queue_s *queue, uint64_t ticket) {
+  auto device = static_cast<riscv::device_s *>(queue->device);
+  buffer->invalidate(offset, size);
+  const hal::hal_addr_t dst = buffer->targetPtr + offset;
+  const riscv::pipeline_s::access_s accesses[] = {
+      {riscv::pipeline_s::space_device, dst, size, true},
+      {riscv::pipeline_s::space_host,
+       reinterpret_cast<uint64_t>(host_pointer), size, false}};
+  return queue->pipeline.submit(
+      device->hal_device, ticket, {accesses, std::size(accesses)},
+      hal::hal_invalid_program,
+      [&](const hal::hal_event_t *wait_events, uint32_t num_wait_events) {
+        return device->hal_device->mem_write_async(
+            dst, host_pointer, size, wait_events, num_wait_events);
+      });
+}
+
+bool command_copy_buffer_s::submit(riscv::queue_s *queue, uint64_t ticket) {
+  auto device = static_cast<riscv::device_s *>(queue->device);
+  dst_buffer->invalidate(dst_offset, size);
+  const hal::hal_addr_t dst = dst_buffer->targetPtr + dst_offset;
+  const hal::hal_addr_t src = src_buffer->targetPtr + src_offset;
+  const riscv::pipeline_s::access_s accesses[] = {
+      {riscv::pipeline_s::space_device, dst, size, true},
+      {riscv::pipeline_s::space_device, src, size, false}};
+  return queue->pipeline.submit(
+      device->hal_device, ticket, {accesses, std::size(accesses)},
+      hal::hal_invalid_program,
+      [&](const hal::hal_event_t *wait_events, uint32_t num_wait_events) {
+        return device->hal_device->mem_copy_async(dst, src, size, wait_events,
+                                                  num_wait_events);
+      });
+}
+
+bool command_fill_buffer_s::submit(riscv::queue_s *queue, uint64_t ticket) {
+  auto device = static_cast<riscv::device_s *>(queue->device);
+  buffer->invalidate(offset, size);
+  const hal::hal_addr_t dst = buffer->targetPtr + offset;
+  const riscv::pipeline_s::access_s accesses[] = {
+      {riscv::pipeline_s::space_device, dst, size, true}};
+  return queue->pipeline.submit(
+      device->hal_device, ticket, {accesses, std::size(accesses)},
+      hal::hal_invalid_program,
+      [&](const hal::hal_event_t *wait_events, uint32_t num_wait_events) {
+        return device->hal_device->mem_fill_async(
+            dst, pattern, pattern_size, size, wait_events, num_wait_events);
+      });
+}
+
+bool command_ndrange_s::submit(riscv::queue_s *queue, uint64_t ticket) {
+  auto device = static_cast<riscv::device_s *>(queue->device);
+  hal::hal_device_t *hal_device = device->hal_device;
+  // Kernels are assumed to read and write the whole of every buffer they are
+  // passed.
+  mux::small_vector<riscv::pipeline_s::access_s, 8> accesses{
+      queue->pending.get_allocator()};
+  const size_t pointer_size = hal_device->get_info()->word_size / 8;
+  if (mayAccessAnyMemory(pointer_size)) {
+    // USM and SVM allocations are reached through pointers rather than
+    // buffers, so order the kernel against every other operation.
+    if (accesses.push_back(
+            {riscv::pipeline_s::space_device, 0, UINT64_MAX, true}) ||
+        accesses.push_back(
+            {riscv::pipeline_s::space_host, 0, UINT64_MAX, true})) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < num_kernel_args; i++) {
+    if (descriptors[i].type != mux_descriptor_info_type_buffer) {
+      continue;
+    }
+    auto *buffer =
+        static_cast<riscv::buffer_s *>(descriptors[i].buffer_descriptor.buffer);
+    if (accesses.push_back({riscv::pipeline_s::space_device, buffer->targetPtr,
+                            buffer->memory_requirements.size, true})) {
+      return false;
+    }
+  }
+  invalidateBuffers(pointer_size);
+  hal::hal_kernel_t hal_kernel;
+  hal::hal_ndrange_t hal_ndrange;
+  const hal::hal_program_t program = load(hal_device, hal_kernel, hal_ndrange);
+  if (program == hal::hal_invalid_program) {
+    return false;
+  }
+  // The program is freed by the pipeline once the kernel has completed.
+  return queue->pipeline.submit(
+      hal_device, ticket, {accesses.begin(), accesses.end()}, program,
+      [&](const hal::hal_event_t *wait_events, uint32_t num_wait_events) {
+        return hal_device->kernel_exec_async(
+            program, hal_kernel, &hal_ndrange, kernel_args, num_kernel_args,
+            dimensions, wait_events, num_wait_events);
+      });
+}
+
 void command_user_callback_s::operator()(
     riscv::queue_s *queue, riscv::command_buffer_s *command_buffer) {
   user_function(queue, command_buffer, user_data);
@@ -220,6 +378,75 @@ mux_result_t command_buffer_s::execute(riscv::queue_s *queue) {
 
   return mux_success;
 }
+
+mux_result_t command_buffer_s::submit(riscv::queue_s *queue, uint64_t ticket) {
+  riscv::device_s *riscv_device = static_cast<riscv::device_s *>(device);
+  hal::hal_device_t *hal_device = riscv_device->hal_device;
+  mux_query_duration_result_t duration_query = nullptr;
+
+  for (riscv::command_s &command : commands) {
+    uint64_t start = 0;
+    if (duration_query) {
+      start = utils::timestampNanoSeconds();
+    }
+
+    bool success = true;
+
+    switch (command.type) {
+      case riscv::command_type_read_buffer:
+        success = command.read_buffer.submit(queue, ticket);
+        break;
+      case riscv::command_type_write_buffer:
+        success = command.write_buffer.submit(queue, ticket);
+        break;
+      case riscv::command_type_fill_buffer:
+        success = command.fill_buffer.submit(queue, ticket);
+        break;
+      case riscv::command_type_copy_buffer:
+        success = command.copy_buffer.submit(queue, ticket);
+        break;
+      case riscv::command_type_ndrange:
+        success = command.ndrange.submit(queue, ticket);
+        break;
+      case riscv::command_type_user_callback:
+        // The callback may inspect the results of any earlier command.
+        success = queue->pipeline.wait_all(hal_device, ticket);
+        if (success) {
+          command.user_callback(queue, this);
+        }
+        break;
+      case riscv::command_type_begin_query:
+      case riscv::command_type_end_query:
+        // Queries observe the device state, so everything before them must
+        // have finished.
+        success = queue->pipeline.wait_all(hal_device, ticket);
+        duration_query =
+            command.type == riscv::command_type_begin_query
+                ? command.begin_query(riscv_device, duration_query)
+                : command.end_query(riscv_device, duration_query);
+        break;
+      case riscv::command_type_reset_query_pool:
+        command.reset_query_pool();
+        break;
+      default:
+        return mux_error_fence_failure;
+    }
+
+    if (duration_query) {
+      // Timing a command requires waiting for it to complete.
+      success &= queue->pipeline.wait_all(hal_device, ticket);
+      auto end = utils::timestampNanoSeconds();
+      duration_query->start = start;
+      duration_query->end = end;
+    }
+
+    if (!success) {
+      return mux_error_fence_failure;
+    }
+  }
+
+  return mux_success;
+}
 }  // namespace riscv
 
 mux_result_t riscvCreateCommandBuffer(
@@ -845,7 +1072,7 @@ mux_result_t riscvCommandNDRange(mux_command_buffer_t command_buffer,
           static_cast<riscv::kernel_s *>(kernel), kernel_args.data(),
           descriptors.data(), static_cast<uint32_t>(options.descriptors_length),
           pod_data.data(), global_size, global_offset, local_size,
-          options.dimensions})) {
+          options.dimensions, options.indirect_memory_access})) {
     return mux_error_out_of_memory;
   }
 
@@ -905,6 +1132,9 @@ mux_result_t riscvUpdateDescriptors(mux_command_buffer_t command_buffer,
         auto *const riscv_buffer = static_cast<riscv::buffer_s *>(info.buffer);
 
         arg.address = riscv_buffer->targetPtr + info.offset;
+        // Keep the descriptor up to date, it is used to track which buffers
+        // the kernel accesses when pipelining.
+        nd_range_command.descriptors[index] = arg_descriptor;
       } break;
       case mux_descriptor_info_type_plain_old_data: {
         const mux_descriptor_info_plain_old_data_s info =
@@ -919,6 +1149,7 @@ mux_result_t riscvUpdateDescriptors(mux_command_buffer_t command_buffer,
       case mux_descriptor_info_type_null_buffer: {
         arg.size = 0;
         arg.address = hal::hal_nullptr;
+        nd_range_command.descriptors[index] = arg_descriptor;
       } break;
     }
   }
@@ -1109,7 +1340,8 @@ static mux_result_t cloneNDRangeCommand(
   if (cloned_command_buffer->commands.push_back(riscv::command_ndrange_s{
           original.kernel, kernel_args.data(), descriptors.data(),
           original.num_kernel_args, pod_data.data(), original.global_size,
-          original.global_offset, original.local_size, original.dimensions})) {
+          original.global_offset, original.local_size, original.dimensions,
+          original.indirect_memory_access})) {
     return mux_error_out_of_memory;
   }
 
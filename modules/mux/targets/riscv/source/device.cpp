@@ -81,3 +81,22 @@ void riscvDestroyDevice(mux_device_t device,
   mux::allocator allocator(allocator_info);
   allocator.destroy(riscvDevice);
 }
+
+mux_result_t riscvCreateSubDevices(mux_device_t device,
+                                   mux_partition_capabilities_e partition,
+                                   uint32_t counts_length,
+                                   const uint32_t *counts,
+                                   mux_allocator_info_t allocator_info,
+                                   uint32_t sub_devices_length,
+                                   mux_device_t *out_sub_devices,
+                                   uint32_t *out_sub_devices_length) {
+  (void)device;
+  (void)partition;
+  (void)counts_length;
+  (void)counts;
+  (void)allocator_info;
+  (void)sub_devices_length;
+  (void)out_sub_devices;
+  (void)out_sub_devices_length;
+  return mux_error_feature_unsupported;
+}
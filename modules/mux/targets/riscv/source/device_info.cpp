@@ -162,6 +162,13 @@ device_info_s::device_info_s()
   };
   this->sub_group_sizes = sg_sizes.data();
   this->num_sub_group_sizes = sg_sizes.size();
+
+  // HAL devices can't be partitioned.
+  this->partition_capabilities = 0;
+  this->max_sub_devices = 0;
+
+  // Pipe builtins aren't lowered for HAL devices.
+  this->supports_pipes = false;
 }
 
 static mux_result_t GetDeviceInfos(uint32_t device_types,
@@ -0,0 +1,119 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "riscv/pipeline.h"
+
+#include <algorithm>
+
+namespace riscv {
+namespace {
+// Two accesses conflict when they overlap and at least one of them writes.
+bool conflicts(const pipeline_s::access_s &lhs,
+               const pipeline_s::access_s &rhs) {
+  return lhs.space == rhs.space && (lhs.write || rhs.write) &&
+         lhs.address < rhs.address + rhs.size &&
+         rhs.address < lhs.address + lhs.size;
+}
+}  // namespace
+
+mux_result_t pipeline_s::dependencies(
+    cargo::array_view<const access_s> operation_accesses,
+    mux::small_vector<::hal::hal_event_t, 8> &wait_events) {
+  for (const auto &tracked : accesses) {
+    if (std::find(wait_events.begin(), wait_events.end(), tracked.event) !=
+        wait_events.end()) {
+      continue;
+    }
+    const bool conflict = std::any_of(
+        operation_accesses.begin(), operation_accesses.end(),
+        [&](const access_s &access) {
+          return conflicts(access, tracked.access);
+        });
+    if (conflict && wait_events.push_back(tracked.event)) {
+      return mux_error_out_of_memory;
+    }
+  }
+  return mux_success;
+}
+
+bool pipeline_s::track(::hal::hal_device_t *hal_device,
+                       ::hal::hal_event_t event, uint64_t ticket,
+                       ::hal::hal_program_t program,
+                       cargo::array_view<const access_s> operation_accesses) {
+  const size_t num_accesses = accesses.size();
+  bool success = !operations.push_back({event, ticket, program});
+  for (const auto &access : operation_accesses) {
+    if (!success) {
+      break;
+    }
+    success = !accesses.push_back({event, access});
+  }
+  if (!success) {
+    // Without tracking later operations can't wait for this one, so it must
+    // complete now.
+    if (operations.size() && operations.back().event == event) {
+      operations.pop_back();
+    }
+    accesses.erase(accesses.begin() + num_accesses, accesses.end());
+    hal_device->event_wait(event);
+    hal_device->event_release(event);
+    if (program != ::hal::hal_invalid_program) {
+      hal_device->program_free(program);
+    }
+  }
+  return success;
+}
+
+bool pipeline_s::wait_all(::hal::hal_device_t *hal_device, uint64_t ticket) {
+  bool success = true;
+  for (const auto &operation : operations) {
+    if (!hal_device->event_wait(operation.event) &&
+        operation.ticket == ticket) {
+      success = false;
+    }
+  }
+  return success;
+}
+
+bool pipeline_s::retire(::hal::hal_device_t *hal_device, uint64_t ticket) {
+  bool success = true;
+  for (const auto &operation : operations) {
+    if (operation.ticket != ticket) {
+      continue;
+    }
+    success &= hal_device->event_wait(operation.event);
+    // Later operations which waited on this one hold their own reference to
+    // its completion in the HAL, so the event can go as soon as it's done.
+    hal_device->event_release(operation.event);
+    if (operation.program != ::hal::hal_invalid_program) {
+      hal_device->program_free(operation.program);
+    }
+    accesses.erase(
+        std::remove_if(accesses.begin(), accesses.end(),
+                       [&](const tracked_access_s &tracked) {
+                         return tracked.event == operation.event;
+                       }),
+        accesses.end());
+  }
+  operations.erase(
+      std::remove_if(operations.begin(), operations.end(),
+                     [&](const operation_s &operation) {
+                       return operation.ticket == ticket;
+                     }),
+      operations.end());
+  return success;
+}
+}  // namespace riscv
@@ -28,6 +28,7 @@
 #include <utils/system.h>
 
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <new>
@@ -108,15 +109,31 @@ bool dispatch_s::is_terminated() const {
   return mux_success;
 }
 
+namespace {
+// The number of dispatches which can have work submitted to the HAL at once.
+constexpr size_t max_in_flight = 4;
+
+// Pipelining is used when the HAL implements the asynchronous API, unless it
+// has been disabled with CA_RISCV_PIPELINE=0.
+bool isPipeliningEnabled(hal::hal_device_t *hal_device) {
+  static const bool enabled = [] {
+    const char *env = std::getenv("CA_RISCV_PIPELINE");
+    return !env || std::strcmp(env, "0") != 0;
+  }();
+  return enabled && hal_device->async_supported();
+}
+}  // namespace
+
 void queue_s::run() {
   for (;;) {
     cargo::optional<riscv::dispatch_s> dispatch = cargo::nullopt;
 
     {
       cargo::unique_lock<cargo::mutex> lock{mutex};
-      // Wait work to be dispatched, or for termination signal.
+      // Wait work to be dispatched, or for termination signal. Dispatches
+      // which are in flight are retired while there is nothing to submit.
       condition_variable.wait(lock, [this]() CARGO_TS_REQUIRES(mutex) {
-        return pending.size() != 0 || terminate;
+        return pending.size() != 0 || terminate || !in_flight.empty();
       });
       if (terminate) {
         break;
@@ -126,7 +143,7 @@ void queue_s::run() {
                                 [&](const riscv::dispatch_s &dispatch) {
                                   return !dispatch.is_waiting();
                                 });
-      if (found != pending.end()) {
+      if (found != pending.end() && in_flight.size() < max_in_flight) {
         // A dispatch that's not waiting was found, removing if from pending.
         dispatch = std::move(*found);
         pending.erase(found);
@@ -135,12 +152,37 @@ void queue_s::run() {
     }
 
     if (!dispatch) {
+      if (!in_flight.empty()) {
+        retire();
+      }
       continue;
     }
 
     mux_result_t result = mux_error_failure;
 
-    {
+    auto hal_device = static_cast<riscv::device_s *>(device)->hal_device;
+    if (isPipeliningEnabled(hal_device)) {
+      // Submit the commands without waiting for them, so that they can overlap
+      // with the work of other dispatches. The pipeline orders operations
+      // which access the same memory.
+      dispatch->ticket = next_ticket++;
+      {
+        const cargo::lock_guard<cargo::mutex> lock{
+            dispatch->command_buffer->mutex};
+        if (!dispatch->is_terminated()) {
+          result = dispatch->command_buffer->submit(this, dispatch->ticket);
+        }
+      }
+      if (mux_success == result) {
+        // Can't fail, in_flight is never grown beyond its embedded storage.
+        if (!in_flight.push_back(std::move(*dispatch))) {
+          continue;
+        }
+        result = mux_error_out_of_memory;
+      }
+      // Wait for any commands which were submitted before the failure.
+      pipeline.retire(hal_device, dispatch->ticket);
+    } else {
       const cargo::lock_guard<cargo::mutex> lock{
           dispatch->command_buffer->mutex};
       // Execute the commands in the command buffer.
@@ -149,39 +191,60 @@ void queue_s::run() {
       }
     }
 
-    // Notify the user via the dispatch callback. The queue and command-buffer
-    // locks must not be held here because we allow muxDispatch() to be called
-    // in this callback which also locks both.
-    dispatch->notify_user(result);
+    complete(*dispatch, result);
+  }
 
-    {
-      const cargo::lock_guard<cargo::mutex> command_buffer_lock{
-          dispatch->command_buffer->mutex};
-      const cargo::lock_guard<cargo::mutex> queue_lock{mutex};
-      if (result) {
-        // There was an error, propogate termination flags.
-        dispatch->terminate();
-      }
-      // Signal the semaphores that the command buffer is finished.
-      dispatch->signal(result);
-    }
+  // Nothing else can be dispatched, but work which has already been submitted
+  // to the HAL must finish before the queue goes away.
+  while (!in_flight.empty()) {
+    retire();
+  }
+}
 
-    // Notify the waiters on the queue mutex. This is done without holding the
-    // command buffer mutex, to avoid the following sequence of events:
-    // 1) The queue is empty after dequeuing `dispatch`.
-    // 2) `running` is set to false and other threads are notified that the
-    // queue is empty.
-    // 3) The queue thread releases the queue mutex. It is pre-empted by the OS,
-    // still holding the command buffer lock.
-    // 4) `muxWaitAll` returns on another thread. The caller deletes command
-    // buffers, including the one still referenced by `dispatch`.
-    // 5) The queue thread is resumed by the OS and tries to unlock the command
-    // buffer mutex. The mutex has already been deleted, resulting in a crash.
-    {
-      const cargo::lock_guard<cargo::mutex> queue_lock{mutex};
-      running = false;
-      condition_variable.notify_all();
+void queue_s::retire() {
+  riscv::dispatch_s dispatch = std::move(in_flight.front());
+  in_flight.erase(in_flight.begin());
+  auto riscv_device = static_cast<riscv::device_s *>(device);
+  const bool success =
+      pipeline.retire(riscv_device->hal_device, dispatch.ticket);
+  riscv_device->profiler.update_counters(*riscv_device->hal_device);
+  complete(dispatch, success ? mux_success : mux_error_fence_failure);
+}
+
+void queue_s::complete(riscv::dispatch_s &dispatch, mux_result_t result) {
+  // Notify the user via the dispatch callback. The queue and command-buffer
+  // locks must not be held here because we allow muxDispatch() to be called
+  // in this callback which also locks both.
+  dispatch.notify_user(result);
+
+  {
+    const cargo::lock_guard<cargo::mutex> command_buffer_lock{
+        dispatch.command_buffer->mutex};
+    const cargo::lock_guard<cargo::mutex> queue_lock{mutex};
+    if (result) {
+      // There was an error, propogate termination flags.
+      dispatch.terminate();
     }
+    // Signal the semaphores that the command buffer is finished.
+    dispatch.signal(result);
+  }
+
+  // Notify the waiters on the queue mutex. This is done without holding the
+  // command buffer mutex, to avoid the following sequence of events:
+  // 1) The queue is empty after dequeuing `dispatch`.
+  // 2) `running` is set to false and other threads are notified that the
+  // queue is empty.
+  // 3) The queue thread releases the queue mutex. It is pre-empted by the OS,
+  // still holding the command buffer lock.
+  // 4) `muxWaitAll` returns on another thread. The caller deletes command
+  // buffers, including the one still referenced by `dispatch`.
+  // 5) The queue thread is resumed by the OS and tries to unlock the command
+  // buffer mutex. The mutex has already been deleted, resulting in a crash.
+  {
+    const cargo::lock_guard<cargo::mutex> queue_lock{mutex};
+    // The queue is still running while other dispatches are in flight.
+    running = !in_flight.empty();
+    condition_variable.notify_all();
   }
 }
 }  // namespace riscv
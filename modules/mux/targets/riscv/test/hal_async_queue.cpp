@@ -0,0 +1,211 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "hal_async_queue.h"
+
+using hal::util::hal_async_queue_t;
+
+TEST(HalAsyncQueueTest, InOrderWithinQueue) {
+  hal_async_queue_t queue(2);
+  std::mutex mutex;
+  std::vector<int> order;
+  hal::hal_event_t last = hal::hal_invalid_event;
+  for (int i = 0; i < 64; i++) {
+    if (last != hal::hal_invalid_event) {
+      queue.release(last);
+    }
+    last = queue.submit(
+        0,
+        [&, i]() {
+          const std::lock_guard<std::mutex> lock(mutex);
+          order.push_back(i);
+          return true;
+        },
+        nullptr, 0);
+    ASSERT_NE(hal::hal_invalid_event, last);
+  }
+  EXPECT_TRUE(queue.wait(last));
+  queue.release(last);
+
+  ASSERT_EQ(64u, order.size());
+  for (int i = 0; i < 64; i++) {
+    EXPECT_EQ(i, order[i]);
+  }
+}
+
+TEST(HalAsyncQueueTest, WaitEventsAcrossQueues) {
+  hal_async_queue_t queue(2);
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  std::vector<char> order;
+
+  // The second operation is on another queue, so only its wait list keeps it
+  // from running before the first.
+  const hal::hal_event_t first = queue.submit(
+      0,
+      [&]() {
+        opened.wait();
+        order.push_back('a');
+        return true;
+      },
+      nullptr, 0);
+  ASSERT_NE(hal::hal_invalid_event, first);
+  const hal::hal_event_t second = queue.submit(
+      1,
+      [&]() {
+        order.push_back('b');
+        return true;
+      },
+      &first, 1);
+  ASSERT_NE(hal::hal_invalid_event, second);
+
+  gate.set_value();
+  EXPECT_TRUE(queue.wait(second));
+  EXPECT_TRUE(queue.wait(first));
+  EXPECT_EQ((std::vector<char>{'a', 'b'}), order);
+  queue.release(first);
+  queue.release(second);
+}
+
+TEST(HalAsyncQueueTest, FailurePropagates) {
+  hal_async_queue_t queue(2);
+  std::atomic<bool> ran{false};
+  const hal::hal_event_t failed =
+      queue.submit(0, []() { return false; }, nullptr, 0);
+  ASSERT_NE(hal::hal_invalid_event, failed);
+  const hal::hal_event_t dependent = queue.submit(
+      1,
+      [&]() {
+        ran = true;
+        return true;
+      },
+      &failed, 1);
+  ASSERT_NE(hal::hal_invalid_event, dependent);
+
+  EXPECT_FALSE(queue.wait(failed));
+  EXPECT_FALSE(queue.wait(dependent));
+  EXPECT_FALSE(ran);
+
+  // A dependency which has already failed is still honoured.
+  const hal::hal_event_t late =
+      queue.submit(0, []() { return true; }, &failed, 1);
+  ASSERT_NE(hal::hal_invalid_event, late);
+  EXPECT_FALSE(queue.wait(late));
+  queue.release(failed);
+  queue.release(dependent);
+  queue.release(late);
+}
+
+TEST(HalAsyncQueueTest, InvalidWaitEvent) {
+  hal_async_queue_t queue(1);
+  const hal::hal_event_t unknown = 0x1234;
+  EXPECT_EQ(hal::hal_invalid_event,
+            queue.submit(0, []() { return true; }, &unknown, 1));
+  EXPECT_FALSE(queue.wait(unknown));
+}
+
+TEST(HalAsyncQueueTest, CompletedEvent) {
+  hal_async_queue_t queue(1);
+  EXPECT_TRUE(queue.wait(hal::hal_completed_event));
+  const hal::hal_event_t completed = hal::hal_completed_event;
+  const hal::hal_event_t event =
+      queue.submit(0, []() { return true; }, &completed, 1);
+  ASSERT_NE(hal::hal_invalid_event, event);
+  EXPECT_TRUE(queue.wait(event));
+  queue.release(event);
+}
+
+TEST(HalAsyncQueueTest, ReleaseBeforeCompletion) {
+  hal_async_queue_t queue(2);
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  const hal::hal_event_t first = queue.submit(
+      0,
+      [opened]() {
+        opened.wait();
+        return true;
+      },
+      nullptr, 0);
+  ASSERT_NE(hal::hal_invalid_event, first);
+  const hal::hal_event_t second =
+      queue.submit(1, []() { return true; }, &first, 1);
+  ASSERT_NE(hal::hal_invalid_event, second);
+
+  // Releasing the event doesn't affect operations which wait on it, but it
+  // can no longer be waited on itself.
+  queue.release(first);
+  EXPECT_FALSE(queue.wait(first));
+  gate.set_value();
+  EXPECT_TRUE(queue.wait(second));
+  queue.release(second);
+}
+
+TEST(HalAsyncQueueTest, DestructorCompletesOperations) {
+  std::atomic<int> count{0};
+  {
+    hal_async_queue_t queue(2);
+    for (uint32_t i = 0; i < 16; i++) {
+      const hal::hal_event_t event = queue.submit(
+          i % 2,
+          [&]() {
+            count++;
+            return true;
+          },
+          nullptr, 0);
+      ASSERT_NE(hal::hal_invalid_event, event);
+      queue.release(event);
+    }
+  }
+  EXPECT_EQ(16, count);
+}
+
+TEST(HalArgCopyTest, CopiesValueArguments) {
+  uint32_t value = 42;
+  uint64_t pair[2] = {1, 2};
+  hal::hal_arg_t args[3] = {};
+  args[0].kind = hal::hal_arg_value;
+  args[0].size = sizeof(value);
+  args[0].pod_data = &value;
+  args[1].kind = hal::hal_arg_address;
+  args[1].space = hal::hal_space_global;
+  args[1].size = 128;
+  args[1].address = 0x1000;
+  args[2].kind = hal::hal_arg_value;
+  args[2].size = sizeof(pair);
+  args[2].pod_data = pair;
+
+  const hal::util::hal_arg_copy_t copy(args, 3);
+  value = 0;
+  pair[0] = pair[1] = 0;
+
+  ASSERT_EQ(3u, copy.size());
+  EXPECT_NE(&value, copy.data()[0].pod_data);
+  EXPECT_EQ(42u, *static_cast<const uint32_t *>(copy.data()[0].pod_data));
+  EXPECT_EQ(0x1000u, copy.data()[1].address);
+  EXPECT_EQ(128u, copy.data()[1].size);
+  const auto *copied_pair =
+      static_cast<const uint64_t *>(copy.data()[2].pod_data);
+  EXPECT_EQ(1u, copied_pair[0]);
+  EXPECT_EQ(2u, copied_pair[1]);
+}
@@ -0,0 +1,180 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <gtest/gtest.h>
+#include <mux/utils/helpers.h>
+
+#include <vector>
+
+#include "hal_async_queue.h"
+#include "riscv/pipeline.h"
+
+namespace {
+// A HAL device which only implements the asynchronous event API, operations
+// are submitted directly to its queue by the tests.
+class fake_hal_device_t final : public hal::hal_device_t {
+ public:
+  fake_hal_device_t() : hal::hal_device_t(nullptr), queue(1) {}
+
+  hal::hal_kernel_t program_find_kernel(hal::hal_program_t,
+                                        const char *) override {
+    return hal::hal_invalid_kernel;
+  }
+  hal::hal_program_t program_load(const void *, hal::hal_size_t) override {
+    return hal::hal_invalid_program;
+  }
+  bool kernel_exec(hal::hal_program_t, hal::hal_kernel_t,
+                   const hal::hal_ndrange_t *, const hal::hal_arg_t *,
+                   uint32_t, uint32_t) override {
+    return false;
+  }
+  bool program_free(hal::hal_program_t program) override {
+    freed_programs.push_back(program);
+    return true;
+  }
+  hal::hal_addr_t mem_alloc(hal::hal_size_t, hal::hal_size_t) override {
+    return hal::hal_nullptr;
+  }
+  bool mem_free(hal::hal_addr_t) override { return false; }
+  bool mem_read(void *, hal::hal_addr_t, hal::hal_size_t) override {
+    return false;
+  }
+  bool mem_write(hal::hal_addr_t, const void *, hal::hal_size_t) override {
+    return false;
+  }
+  bool async_supported() const override { return true; }
+  bool event_wait(hal::hal_event_t event) override {
+    return queue.wait(event);
+  }
+  void event_release(hal::hal_event_t event) override {
+    released_events.push_back(event);
+    queue.release(event);
+  }
+
+  hal::util::hal_async_queue_t queue;
+  std::vector<hal::hal_program_t> freed_programs;
+  std::vector<hal::hal_event_t> released_events;
+};
+
+struct PipelineTest : testing::Test {
+  using access_s = riscv::pipeline_s::access_s;
+
+  static access_s device(uint64_t address, uint64_t size, bool write) {
+    return {riscv::pipeline_s::space_device, address, size, write};
+  }
+
+  // Submits an operation with the given result, recording the events it was
+  // told to wait for in `waited`.
+  bool submit(uint64_t ticket, std::vector<access_s> accesses,
+              bool result = true,
+              hal::hal_program_t program = hal::hal_invalid_program) {
+    waited.clear();
+    return pipeline.submit(
+        &hal_device, ticket, accesses, program,
+        [&](const hal::hal_event_t *events, uint32_t num_events) {
+          waited.assign(events, events + num_events);
+          last_event = hal_device.queue.submit(
+              0, [result]() { return result; }, events, num_events);
+          return last_event;
+        });
+  }
+
+  mux_allocator_info_t allocator_info = {mux::alloc, mux::free, nullptr};
+  fake_hal_device_t hal_device;
+  riscv::pipeline_s pipeline{mux::allocator{allocator_info}};
+  std::vector<hal::hal_event_t> waited;
+  hal::hal_event_t last_event = hal::hal_invalid_event;
+};
+}  // namespace
+
+TEST_F(PipelineTest, DisjointWritesDontWait) {
+  ASSERT_TRUE(submit(1, {device(0, 16, true)}));
+  ASSERT_TRUE(submit(1, {device(16, 16, true)}));
+  EXPECT_TRUE(waited.empty());
+  EXPECT_TRUE(pipeline.retire(&hal_device, 1));
+}
+
+TEST_F(PipelineTest, ReadAfterWriteWaits) {
+  ASSERT_TRUE(submit(1, {device(0, 16, true)}));
+  const hal::hal_event_t write = last_event;
+  ASSERT_TRUE(submit(1, {device(8, 4, false)}));
+  EXPECT_EQ(std::vector<hal::hal_event_t>{write}, waited);
+
+  // Writing over something which is being read must wait too.
+  const hal::hal_event_t read = last_event;
+  ASSERT_TRUE(submit(1, {device(10, 1, true)}));
+  EXPECT_EQ((std::vector<hal::hal_event_t>{write, read}), waited);
+  EXPECT_TRUE(pipeline.retire(&hal_device, 1));
+}
+
+TEST_F(PipelineTest, ReadsDontWaitForReads) {
+  ASSERT_TRUE(submit(1, {device(0, 16, false)}));
+  ASSERT_TRUE(submit(1, {device(0, 16, false)}));
+  EXPECT_TRUE(waited.empty());
+  EXPECT_TRUE(pipeline.retire(&hal_device, 1));
+}
+
+TEST_F(PipelineTest, AddressSpacesDontConflict) {
+  ASSERT_TRUE(submit(1, {device(0, 16, true)}));
+  ASSERT_TRUE(submit(1, {{riscv::pipeline_s::space_host, 0, 16, true}}));
+  EXPECT_TRUE(waited.empty());
+  EXPECT_TRUE(pipeline.retire(&hal_device, 1));
+}
+
+TEST_F(PipelineTest, EachEventWaitedOnOnce) {
+  ASSERT_TRUE(submit(1, {device(0, 16, true), device(64, 16, true)}));
+  const hal::hal_event_t write = last_event;
+  ASSERT_TRUE(submit(1, {device(0, 4, false), device(64, 4, false)}));
+  EXPECT_EQ(std::vector<hal::hal_event_t>{write}, waited);
+  EXPECT_TRUE(pipeline.retire(&hal_device, 1));
+}
+
+TEST_F(PipelineTest, RetireOnlyTicket) {
+  ASSERT_TRUE(submit(1, {device(0, 16, true)}, true, 42));
+  const hal::hal_event_t first = last_event;
+  ASSERT_TRUE(submit(2, {device(32, 16, true)}, true, 43));
+  const hal::hal_event_t second = last_event;
+
+  EXPECT_TRUE(pipeline.retire(&hal_device, 1));
+  EXPECT_EQ(std::vector<hal::hal_event_t>{first}, hal_device.released_events);
+  EXPECT_EQ(std::vector<hal::hal_program_t>{42}, hal_device.freed_programs);
+
+  // Retired operations are no longer waited on, the others still are.
+  ASSERT_TRUE(submit(2, {device(0, 64, false)}));
+  EXPECT_EQ(std::vector<hal::hal_event_t>{second}, waited);
+  EXPECT_TRUE(pipeline.retire(&hal_device, 2));
+  EXPECT_EQ((std::vector<hal::hal_program_t>{42, 43}),
+            hal_device.freed_programs);
+}
+
+TEST_F(PipelineTest, FailedSubmissionFreesProgram) {
+  EXPECT_FALSE(pipeline.submit(&hal_device, 1, {}, 7,
+                               [](const hal::hal_event_t *, uint32_t) {
+                                 return hal::hal_invalid_event;
+                               }));
+  EXPECT_EQ(std::vector<hal::hal_program_t>{7}, hal_device.freed_programs);
+  EXPECT_TRUE(pipeline.retire(&hal_device, 1));
+}
+
+TEST_F(PipelineTest, FailuresReportedPerTicket) {
+  ASSERT_TRUE(submit(1, {device(0, 16, true)}, false));
+  ASSERT_TRUE(submit(2, {device(32, 16, true)}));
+
+  EXPECT_TRUE(pipeline.wait_all(&hal_device, 2));
+  EXPECT_FALSE(pipeline.wait_all(&hal_device, 1));
+  EXPECT_FALSE(pipeline.retire(&hal_device, 1));
+  EXPECT_TRUE(pipeline.retire(&hal_device, 2));
+}
@@ -0,0 +1,134 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <mux/mux.h>
+
+#include <vector>
+
+#include "common.h"
+
+struct muxCreateSubDevicesTest : DeviceTest {
+  void SetUp() override {
+    RETURN_ON_FATAL_FAILURE(DeviceTest::SetUp());
+    if (0 == (device->info->partition_capabilities &
+              mux_partition_capabilities_compute_units)) {
+      GTEST_SKIP();
+    }
+  }
+};
+
+INSTANTIATE_DEVICE_TEST_SUITE_P(muxCreateSubDevicesTest);
+
+TEST_P(muxCreateSubDevicesTest, Default) {
+  const std::vector<uint32_t> counts = {1, device->compute_units - 1};
+  const uint32_t counts_length = static_cast<uint32_t>(counts.size());
+  uint32_t sub_devices_length = 0;
+  ASSERT_SUCCESS(muxCreateSubDevices(
+      device, mux_partition_capabilities_compute_units, counts_length,
+      counts.data(), allocator, 0, nullptr, &sub_devices_length));
+  ASSERT_EQ(counts_length, sub_devices_length);
+
+  std::vector<mux_device_t> sub_devices(sub_devices_length);
+  ASSERT_SUCCESS(muxCreateSubDevices(
+      device, mux_partition_capabilities_compute_units, counts_length,
+      counts.data(), allocator, sub_devices_length, sub_devices.data(),
+      nullptr));
+  for (uint32_t index = 0; index < sub_devices_length; index++) {
+    ASSERT_NE(nullptr, sub_devices[index]);
+    EXPECT_EQ(device->info, sub_devices[index]->info);
+    EXPECT_EQ(counts[index], sub_devices[index]->compute_units);
+  }
+  for (auto sub_device : sub_devices) {
+    muxDestroyDevice(sub_device, allocator);
+  }
+}
+
+TEST_P(muxCreateSubDevicesTest, Numa) {
+  if (0 == (device->info->partition_capabilities &
+            mux_partition_capabilities_numa)) {
+    GTEST_SKIP();
+  }
+  uint32_t sub_devices_length = 0;
+  ASSERT_SUCCESS(muxCreateSubDevices(device, mux_partition_capabilities_numa,
+                                     0, nullptr, allocator, 0, nullptr,
+                                     &sub_devices_length));
+  ASSERT_LT(0u, sub_devices_length);
+
+  std::vector<mux_device_t> sub_devices(sub_devices_length);
+  ASSERT_SUCCESS(muxCreateSubDevices(device, mux_partition_capabilities_numa,
+                                     0, nullptr, allocator, sub_devices_length,
+                                     sub_devices.data(), nullptr));
+  uint32_t compute_units = 0;
+  for (auto sub_device : sub_devices) {
+    ASSERT_NE(nullptr, sub_device);
+    compute_units += sub_device->compute_units;
+  }
+  EXPECT_EQ(device->compute_units, compute_units);
+  for (auto sub_device : sub_devices) {
+    muxDestroyDevice(sub_device, allocator);
+  }
+}
+
+TEST_P(muxCreateSubDevicesTest, InvalidDevice) {
+  const uint32_t count = 1;
+  uint32_t sub_devices_length = 0;
+  ASSERT_ERROR_EQ(mux_error_invalid_value,
+                  muxCreateSubDevices(
+                      nullptr, mux_partition_capabilities_compute_units, 1,
+                      &count, allocator, 0, nullptr, &sub_devices_length));
+}
+
+TEST_P(muxCreateSubDevicesTest, InvalidCounts) {
+  uint32_t sub_devices_length = 0;
+  ASSERT_ERROR_EQ(mux_error_invalid_value,
+                  muxCreateSubDevices(
+                      device, mux_partition_capabilities_compute_units, 0,
+                      nullptr, allocator, 0, nullptr, &sub_devices_length));
+
+  const uint32_t zero = 0;
+  ASSERT_ERROR_EQ(mux_error_invalid_value,
+                  muxCreateSubDevices(
+                      device, mux_partition_capabilities_compute_units, 1,
+                      &zero, allocator, 0, nullptr, &sub_devices_length));
+
+  const uint32_t too_many = device->compute_units + 1;
+  ASSERT_ERROR_EQ(mux_error_invalid_value,
+                  muxCreateSubDevices(
+                      device, mux_partition_capabilities_compute_units, 1,
+                      &too_many, allocator, 0, nullptr, &sub_devices_length));
+}
+
+TEST_P(muxCreateSubDevicesTest, InvalidSubDevicesLength) {
+  const uint32_t counts[] = {1, 1};
+  mux_device_t sub_device = nullptr;
+  ASSERT_ERROR_EQ(mux_error_invalid_value,
+                  muxCreateSubDevices(
+                      device, mux_partition_capabilities_compute_units, 2,
+                      counts, allocator, 1, &sub_device, nullptr));
+  ASSERT_EQ(nullptr, sub_device);
+}
+
+TEST_P(muxCreateSubDevicesTest, NullOutParameters) {
+  const uint32_t count = 1;
+  ASSERT_ERROR_EQ(mux_error_null_out_parameter,
+                  muxCreateSubDevices(
+                      device, mux_partition_capabilities_compute_units, 1,
+                      &count, allocator, 0, nullptr, nullptr));
+  ASSERT_ERROR_EQ(mux_error_null_out_parameter,
+                  muxCreateSubDevices(
+                      device, mux_partition_capabilities_compute_units, 1,
+                      &count, allocator, 1, nullptr, nullptr));
+}
@@ -75,3 +75,22 @@ TEST(muxGetDeviceInfos, NotCompiler) {
                                      device_infos.data(), nullptr));
   }
 }
+
+TEST(muxGetDeviceInfos, SupportsPipes) {
+  for (auto device_info : getDeviceInfos()) {
+    if (!device_info->supports_pipes) {
+      continue;
+    }
+    // Pipe reservation IDs pack a range of packets into a pointer, and the
+    // pipe's counters are updated with 32-bit atomics on device memory.
+    EXPECT_TRUE(device_info->address_capabilities &
+                mux_address_capabilities_bits64)
+        << device_info->device_name;
+    EXPECT_TRUE(device_info->atomic_capabilities &
+                mux_atomic_capabilities_32bit)
+        << device_info->device_name;
+    EXPECT_TRUE(device_info->allocation_capabilities &
+                mux_allocation_capabilities_alloc_device)
+        << device_info->device_name;
+  }
+}
@@ -88,7 +88,7 @@ struct muxUpdateDescriptorsTest : public DeviceCompilerTest {
   /// @brief Descriptors for arguments to kernel.
   std::vector<mux_descriptor_info_t> descriptors;
   /// @brief The nd range options for enqueing a kernel.
-  mux_ndrange_options_t nd_range_options;
+  mux_ndrange_options_t nd_range_options{};
 
   /// @brief Virtual method used to setup any resources for the test fixture
   /// that can't be done in the constructor.
@@ -48,10 +48,12 @@ typedef struct _cl_mem_buffer final : public _cl_mem {
   /// @param[in] flags Memory allocation flags.
   /// @param[in] size Size in bytes of the buffer.
   /// @param[in] host_ptr Pointer to optionally provided host memory.
+  /// @param[in] type Type of the memory object, a buffer or a pipe.
   /// @param[in] mux_memories List of mux memory objects.
   /// @param[in] mux_buffers List of mux buffer objects.
   _cl_mem_buffer(cl_context context, const cl_mem_flags flags,
                  const size_t size, void *host_ptr,
+                 const cl_mem_object_type type,
                  cargo::dynamic_array<mux_memory_t> &&mux_memories,
                  cargo::dynamic_array<mux_buffer_t> &&mux_buffers);
 
@@ -82,6 +84,7 @@ typedef struct _cl_mem_buffer final : public _cl_mem {
   /// @param[in] flags Memory allocation flags.
   /// @param[in] size Size in bytes of the requested device allocation.
   /// @param[in] host_ptr Pointer to optionally provide user memory.
+  /// @param[in] type Type of the memory object, a buffer or a pipe.
   ///
   /// @return Returns the buffer object on success.
   /// @retval `CL_OUT_OF_HOST_MEMORY` if an allocation failure occurred.
@@ -90,7 +93,43 @@ typedef struct _cl_mem_buffer final : public _cl_mem {
   /// @retval `CL_MEM_OBJECT_ALLOCATION_FAILURE` if there is an issue when
   /// binding, mapping or flushing mapped memory.
   static cargo::expected<std::unique_ptr<_cl_mem_buffer>, cl_int> create(
-      cl_context context, cl_mem_flags flags, size_t size, void *host_ptr);
+      cl_context context, cl_mem_flags flags, size_t size, void *host_ptr,
+      cl_mem_object_type type = CL_MEM_OBJECT_BUFFER);
+
+  /// @brief Create an OpenCL pipe memory object.
+  ///
+  /// A pipe is a buffer holding a header of `pipe_header_size` bytes followed
+  /// by a ring of packets, the kernels which use the pipe reserve and commit
+  /// packets with atomic operations on the counters in the header. The layout
+  /// must match the compiler's lowering of the pipe builtins, see
+  /// `compiler::utils::CLBuiltinInfo`:
+  ///
+  /// * `uint32_t` packet size in bytes at offset 0.
+  /// * `uint32_t` number of packets in the ring, a power of two so that the
+  ///   counters may wrap, at offset 4.
+  /// * `uint32_t` maximum number of packets the pipe holds at offset 8.
+  /// * `uint32_t` counters for reserved writes, committed writes, reserved
+  ///   reads and committed reads at offsets 64, 128, 192 and 256, each in its
+  ///   own cache line.
+  ///
+  /// @param[in] context Context the pipe belongs to.
+  /// @param[in] flags Memory allocation flags.
+  /// @param[in] packet_size Size in bytes of a packet.
+  /// @param[in] max_packets Maximum number of packets the pipe holds.
+  ///
+  /// @return Returns the pipe object on success.
+  /// @retval `CL_OUT_OF_HOST_MEMORY` if an allocation failure occurred.
+  /// @retval `CL_INVALID_PIPE_SIZE` if the pipe's storage exceeds the maximum
+  /// memory allocation size of any device.
+  /// @retval `CL_MEM_OBJECT_ALLOCATION_FAILURE` if there is an issue when
+  /// binding, mapping or flushing mapped memory.
+  static cargo::expected<std::unique_ptr<_cl_mem_buffer>, cl_int> createPipe(
+      cl_context context, cl_mem_flags flags, cl_uint packet_size,
+      cl_uint max_packets);
+
+  /// @brief Size in bytes of the header at the start of a pipe's storage,
+  /// a multiple of the largest alignment a packet may need.
+  static constexpr size_t pipe_header_size = 384;
 
   /// @brief Synchronize data when a buffer has multiple device in its context.
   ///
@@ -123,6 +162,12 @@ typedef struct _cl_mem_buffer final : public _cl_mem {
   /// @brief Mux buffer objects, one per device in the parent `cl_context`.
   cargo::dynamic_array<mux_buffer_t> mux_buffers;
 
+  /// @brief Size in bytes of a packet if this is a pipe, otherwise 0.
+  cl_uint pipe_packet_size;
+
+  /// @brief Maximum number of packets if this is a pipe, otherwise 0.
+  cl_uint pipe_max_packets;
+
 } *cl_mem_buffer;
 
 /// @}
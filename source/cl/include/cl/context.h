@@ -136,6 +136,14 @@ struct _cl_context final : public cl::base<_cl_context> {
   /// @return Return true if the context targets the device, false otherwise.
   bool hasDevice(const cl_device_id device) const;
 
+#ifdef CL_VERSION_3_0
+  /// @brief Query if any device the context targets supports shared virtual
+  /// memory.
+  ///
+  /// @return Return true if a device reports SVM capabilities, false otherwise.
+  bool supportsSVM() const;
+#endif
+
   /// @brief Get the index of the given device.
   ///
   /// @param device The device whose index to find.
@@ -221,6 +229,14 @@ struct _cl_context final : public cl::base<_cl_context> {
   /// @brief List of allocations made through the USM extension entry points.
   cargo::small_vector<std::unique_ptr<extension::usm::allocation_info>, 1>
       usm_allocations;
+  /// @brief Pools serving small USM allocations, keyed by device. The pool of
+  /// host memory used for host and shared allocations is keyed by `nullptr`.
+  std::unordered_map<cl_device_id,
+                     std::unique_ptr<extension::usm::memory_pool>>
+      usm_pools;
+  /// @brief Mutex to protect lazy creation of `usm_pools`, each pool has its
+  /// own mutex protecting its state.
+  std::mutex usm_pool_mutex;
 #endif
   std::mutex &getCommandQueueMutex() { return command_queue_mutex; }
 
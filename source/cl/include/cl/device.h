@@ -32,11 +32,14 @@
 #include <compiler/info.h>
 #include <mux/mux.h>
 
+#include <memory>
 #include <string>
 
 /// @addtogroup cl
 /// @{
 
+struct printf_buffer_pool_t;
+
 /// @brief Definition of the OpenCL device object.
 struct _cl_device_id final : public cl::base<_cl_device_id> {
   /// @brief Device constructor.
@@ -44,8 +47,11 @@ struct _cl_device_id final : public cl::base<_cl_device_id> {
   /// @param platform Platform the device belongs to.
   /// @param mux_allocator Allocators be used for mux.
   /// @param mux_device Associated mux device.
+  /// @param parent_device Device partitioned to create this sub-device, or
+  /// null for a root-level device.
   _cl_device_id(cl_platform_id platform, mux_allocator_info_t mux_allocator,
-                mux_device_t mux_device);
+                mux_device_t mux_device,
+                cl_device_id parent_device = nullptr);
 
   /// @brief Deleted move constructor.
   ///
@@ -211,7 +217,7 @@ struct _cl_device_id final : public cl::base<_cl_device_id> {
   /// @brief List of partition types supported, possible values:
   /// CL_DEVICE_PARTITION_{EQUALLY, BY_COUNTS, BY_AFFINITY_DOMAIN}, or 0 if
   /// none of these are supported.
-  cl_device_partition_property partition_properties;
+  cargo::small_vector<cl_device_partition_property, 4> partition_properties;
   /// @brief List of supported affinity domains for partitioning the device. Bit
   /// field with possible values: CL_DEVICE_AFFINITY_DOMAIN_{NUMA, L4_CACHE,
   /// L3_CACHE, L2_CACHE, L1_CACHE, NEXT_PATITIONABLE}, or 0 if the device
@@ -222,7 +228,10 @@ struct _cl_device_id final : public cl::base<_cl_device_id> {
   /// param_value_size_ret of 0 i.e. there is no partition type associated with
   /// device or can return a property value of 0 (where 0 is used to terminate
   /// the partition property list) in the memory that param_value points to.
-  cl_device_partition_property partition_type;
+  cargo::small_vector<cl_device_partition_property, 4> partition_type;
+  /// @brief Live sub-devices partitioned from this device, guarded by the
+  /// platform's `sub_devices_mutex`. Used to validate sub-device handles.
+  cargo::small_vector<cl_device_id, 4> sub_devices;
 
   // Preferred vector sizes:
   /// @brief Preferred vector width size for char.
@@ -245,6 +254,8 @@ struct _cl_device_id final : public cl::base<_cl_device_id> {
   /// @brief Maximum size of the internal buffer that holds the output of
   /// printf calls from a kernel, minimum 1MB for the FULL profile.
   size_t printf_buffer_size;
+  /// @brief Cache of printf buffers reused across ND-Ranges.
+  std::unique_ptr<printf_buffer_pool_t> printf_buffer_pool;
   /// @brief CL_TRUE if the device's preference is for the user to be
   /// responsible for synchronisation.
   cl_bool preferred_interop_user_sync;
@@ -256,8 +267,6 @@ struct _cl_device_id final : public cl::base<_cl_device_id> {
   /// possible values: CL_QUEUE_{OUT_OF_ORDER_EXEC_MODE_ENABLE,
   /// PROFILING_ENABLE}, minimum capability: CL_QUEUE_PROFILING_ENABLE.
   cl_command_queue_properties queue_properties;
-  /// @brief Device reference count, 1 if the device is a root-level device.
-  cl_uint reference_count;
   /// @brief Describes the single precision floating-point capabilities of the
   /// device in a bit-field with the possible values: CL_FP_{DENORM, INF_NAN,
   /// ROUND_TO_NEAREST, ROUND_TO_ZERO, ROUND_TO_INF, FMA,
@@ -22,6 +22,7 @@
 #define CL_EVENT_H_INCLUDED
 
 #include <CL/cl.h>
+#include <cargo/eventcount.h>
 #include <cargo/expected.h>
 #include <cargo/small_vector.h>
 #include <cl/base.h>
@@ -29,7 +30,6 @@
 #include <cl/limits.h>
 #include <mux/mux.h>
 
-#include <condition_variable>
 #include <mutex>
 
 namespace cl {
@@ -158,9 +158,10 @@ struct _cl_event final : public cl::base<_cl_event> {
   /// @brief Mutex used for signalling between _cl_event::wait() and
   /// _cl_event::complete() member functions.
   std::mutex wait_complete_mutex;
-  /// @brief Condition variable used for signalling between _cl_event::wait()
-  /// and _cl_event::complete() member functions.
-  std::condition_variable wait_complete_condition;
+  /// @brief Eventcount used for signalling between _cl_event::wait() and
+  /// _cl_event::complete() member functions, waiters spin briefly before
+  /// blocking.
+  cargo::eventcount wait_complete;
   /// @brief Mutex to protect concurrent access to _cl_event::callbacks.
   ///
   /// The mutex needs to be recursive, as nothing prohibits a callback from
@@ -99,6 +99,11 @@ struct _cl_mem : public cl::base<_cl_mem> {
   /// @param[in] mux_allocator Allocator used for memory management.
   /// @param[out] out_memory The allocated device memory.
   ///
+  /// When `CL_MEM_USE_HOST_PTR` is set and the device is coherent with the
+  /// host the memory aliases `host_ptr`. If `host_ptr` isn't aligned enough
+  /// for the device the memory starts at the aligned address below it, and
+  /// `host_ptr_offset` is set to where the data starts in the memory.
+  ///
   /// @return Returns `CL_SUCCESS` on success, or
   /// `CL_MEM_OBJECT_ALLOCATION_FAILURE` on failure.
   cl_int allocateMemory(mux_device_t mux_device, uint32_t supported_heaps,
@@ -165,6 +170,12 @@ struct _cl_mem : public cl::base<_cl_mem> {
   /// parent should be used.
   void *map_base_pointer;
 
+  /// @brief Offset in bytes of this object's data from the start of its mux
+  /// memory, non-zero when an unaligned `host_ptr` is aliased. For
+  /// sub-buffers this will always be zero, the host_ptr_offset of the parent
+  /// should be used.
+  size_t host_ptr_offset;
+
   /// @brief Struct representing a mapping
   struct mapping final {
     /// @brief Absolute offset of the mapping in the buffer.
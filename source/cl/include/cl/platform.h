@@ -76,6 +76,8 @@ struct _cl_platform_id final : cl::base<_cl_platform_id> {
 
   /// @brief List of devices owned by the platform.
   cargo::dynamic_array<cl_device_id> devices;
+  /// @brief Mutex guarding the `sub_devices` list of every device.
+  std::mutex sub_devices_mutex;
 
  private:
   /// @brief Compiler library.
@@ -23,14 +23,56 @@
 
 #include <CL/cl.h>
 #include <builtins/printf.h>
+#include <cl/limits.h>
 #include <mux/mux.hpp>
 
 #include <array>
+#include <memory>
+#include <mutex>
 #include <vector>
 
-/// @brief Allocate Mux memory and bind buffer for printf output based on local
+/// @brief Mux memory and the buffer bound to it used for printf output.
+struct printf_buffer_t final {
+  /// @brief Mux memory where print data is written.
+  mux_memory_t memory;
+  /// @brief Mux buffer bound to memory.
+  mux_buffer_t buffer;
+};
+
+/// @brief Per-device cache of printf buffers.
+///
+/// Every printf buffer of a device has the same size, so buffers released
+/// after an ND-Range has been printed are kept here and handed out to the
+/// next ND-Range instead of allocating new Mux memory.
+struct printf_buffer_pool_t final {
+  /// @brief Constructor.
+  ///
+  /// @param[in] mux_device Mux device the buffers are allocated on.
+  /// @param[in] mux_allocator Allocator used for the buffers.
+  printf_buffer_pool_t(mux_device_t mux_device,
+                       mux_allocator_info_t mux_allocator)
+      : mux_device(mux_device), mux_allocator(mux_allocator) {}
+
+  /// @brief Destructor, frees all cached buffers.
+  ~printf_buffer_pool_t();
+
+  /// @brief Mux device the buffers are allocated on.
+  mux_device_t mux_device;
+  /// @brief Allocator used for the buffers.
+  mux_allocator_info_t mux_allocator;
+  /// @brief Mutex protecting `buffers`.
+  std::mutex mutex;
+  /// @brief Buffers which are not in use by any ND-Range.
+  std::vector<printf_buffer_t> buffers;
+};
+
+/// @brief Get Mux memory and a bound buffer for printf output based on local
 /// and global execution size of a kernel.
 ///
+/// The buffer is taken from the device's printf buffer pool when available,
+/// otherwise it is allocated. In both cases the header of each work-group's
+/// chunk of the buffer is initialized.
+///
 /// @param[in] device Device to allocate memory for
 /// @param[in] local_work_size Local size of the ND-Range
 /// @param[in] global_work_size Global size of the ND-Range
@@ -47,28 +89,82 @@ cl_int createPrintfBuffer(
     size_t &num_groups, size_t &buffer_group_size, mux_memory_t &printf_memory,
     mux_buffer_t &printf_buffer);
 
+/// @brief Return a printf buffer created by `createPrintfBuffer` to the
+/// device's printf buffer pool.
+///
+/// @param[in] device Device the buffer was created for.
+/// @param[in] printf_memory Mux memory of the printf buffer, may be null.
+/// @param[in] printf_buffer Mux buffer bound to `printf_memory`, may be null.
+void releasePrintfBuffer(cl_device_id device, mux_memory_t printf_memory,
+                         mux_buffer_t printf_buffer);
+
+/// @brief Wait until the printf output produced by commands a queue has
+/// completed has been written to stdout.
+///
+/// Printf output is formatted on a dedicated writer thread, this is called
+/// at the synchronization points where OpenCL requires the output of
+/// completed kernels to be flushed.
+///
+/// @param[in] queue Mux queue the completed commands ran on.
+void flushPrintfOutput(mux_queue_t queue);
+
 /// @brief Structure passed to callback performing printf on host.
 struct printf_info_t final {
+  /// @brief Constructor.
+  ///
+  /// When printf streaming is enabled the buffer is registered with the
+  /// printf writer, which drains completed output while the kernel runs.
+  ///
+  /// @param[in] device OpenCL device which performs the print.
+  /// @param[in] program Program owning `printf_calls`.
+  /// @param[in] memory Mux memory created by `createPrintfBuffer`.
+  /// @param[in] buffer Mux buffer created by `createPrintfBuffer`.
+  /// @param[in] buffer_group_size Size in bytes of each work-group chunk.
+  /// @param[in] num_groups Number of work-groups in the ND-Range.
+  /// @param[in] printf_calls Details of printf calls in the kernel program.
+  printf_info_t(cl_device_id device, cl_program program, mux_memory_t memory,
+                mux_buffer_t buffer, size_t buffer_group_size,
+                size_t num_groups,
+                std::vector<builtins::printf::descriptor> &printf_calls);
+
+  /// @brief Deleted move constructor.
+  ///
+  /// Also deletes the copy constructor and the assignment operators.
+  printf_info_t(printf_info_t &&) = delete;
+
+  /// @brief Destructor, returns the printf buffer to the device's pool.
+  ~printf_info_t();
+
   /// @brief OpenCL device which performed print
   cl_device_id device;
+  /// @brief Program owning `printf_calls`, retained by the writer while it
+  /// formats output.
+  cl_program program;
   /// @brief Mux memory where print data has been written
   mux_memory_t memory;
   /// @brief Mux buffer bound to memory
   mux_buffer_t buffer;
   /// @brief Size in bytes of the printf buffer per work-group chunk
   size_t buffer_group_size;
-  /// @brief Offset into the buffer chunk for each work-group to start printing
-  /// from
-  std::vector<uint32_t> group_offsets;
+  /// @brief Number of work-group chunks in the buffer
+  size_t num_groups;
   /// @brief Details of printf calls in the kernel program
   std::vector<builtins::printf::descriptor> &printf_calls;
-  /// @brief Destructor for freeing mux allocated resources
-  ~printf_info_t();
+  /// @brief True if the writer drains the buffer while the kernel runs.
+  bool streaming;
+  /// @brief Serializes mapping the buffer between the callback draining it
+  /// and the writer streaming it, so callbacks needn't hold the writer's lock
+  /// while the buffer is mapped.
+  std::mutex mapping_mutex;
 };
 
 /// @brief Record a user callback command to the Mux command-buffer to perform
 /// host printing from Mux buffer used for device-side printf.
 ///
+/// The callback copies the completed output out of the printf buffer, resets
+/// the buffer so the command can be run again, and hands the output to the
+/// printf writer thread to be formatted.
+///
 /// This overload with a raw pointer printf_info_t frees the heap allocated
 /// data in the callback.
 ///
@@ -22,6 +22,7 @@
 #define CL_PROGRAM_H_INCLUDED
 
 #include <CL/cl.h>
+#include <cargo/array_view.h>
 #include <cargo/expected.h>
 #include <cargo/optional.h>
 #include <cargo/string_view.h>
@@ -32,7 +33,11 @@
 #include <cl/kernel.h>
 #include <extension/config.h>
 
+#include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace cl {
 using pfn_notify_program_t = void(CL_CALLBACK *)(cl_program program,
@@ -105,6 +110,76 @@ class mux_kernel_cache {
   std::unordered_map<std::string, mux::unique_ptr<mux_kernel_t>> kernel_map;
 };
 
+/// @brief A compiler module built for a device, shared by every program built
+/// from the same source or IL with the same options for that device.
+///
+/// Builds are only shared when the `CA_CL_PROGRAM_CACHE` environment variable
+/// is set to a non-zero value. Programs hold shared ownership of a build and
+/// the process wide cache only refers to it, so the build is destroyed along
+/// with the last program using it.
+struct shared_build {
+  /// @brief Constructor.
+  ///
+  /// @param[in] context Context the module was created in.
+  /// @param[in] key Content of the build, see `_cl_program::getBuildKey`.
+  shared_build(cl_context context, std::string key);
+
+  /// @brief Destructor, removes the build from the cache.
+  ~shared_build();
+
+  shared_build(const shared_build &) = delete;
+  shared_build &operator=(const shared_build &) = delete;
+
+  /// @brief Returns true if builds are shared between programs.
+  static bool enabled();
+
+  /// @brief Lookup a build in the cache.
+  ///
+  /// @param[in] key Content of the build to find.
+  ///
+  /// @return Returns the build, or null if no program holds one with `key`.
+  static std::shared_ptr<shared_build> find(const std::string &key);
+
+  /// @brief Add a build to the cache, unless one with the same key is there.
+  ///
+  /// @param[in] build Build to add.
+  static void publish(const std::shared_ptr<shared_build> &build);
+
+  /// @brief Returns the Mux binary of the module, creating it on first use.
+  ///
+  /// @return An array_view to the Mux binary, or a compiler failure if there
+  /// was an error generating the binary.
+  cargo::expected<cargo::array_view<const uint8_t>, compiler::Result>
+  getOrCreateMuxBinary();
+
+  /// @brief Content of the build, the key the cache finds it with.
+  const std::string key;
+  /// @brief Context the module was created in, retained as its compiler target
+  /// must outlive the module.
+  cl_context context;
+  /// @brief Number of errors the module reported since it was shared.
+  uint32_t num_errors;
+  /// @brief Diagnostics the module reported since it was shared.
+  std::string log;
+  /// @brief Build log of the program which built the module.
+  std::string compiler_log;
+  /// @brief Finalized compiler module.
+  std::shared_ptr<compiler::Module> module;
+  /// @brief Mux kernels of the module, when deferred compilation is not
+  /// supported.
+  std::shared_ptr<mux_kernel_cache> kernels;
+  /// @brief Program information of the module.
+  std::shared_ptr<compiler::ProgramInfo> program_info;
+  /// @brief Printf descriptor information of the module.
+  std::vector<builtins::printf::descriptor> printf_calls;
+
+ private:
+  /// @brief Guards creating the Mux binary, as any program may ask for it.
+  std::mutex mux_binary_mutex;
+  /// @brief Mux binary created by Module::createBinary.
+  cargo::optional<cargo::dynamic_array<uint8_t>> mux_binary;
+};
+
 /// @brief A class which encapsulates device specific program information, such
 /// as a compiler module, or a device specific binary executable loaded from
 /// disk.
@@ -148,9 +223,14 @@ struct device_program {
     /// compilation process.
     void clear();
 
+    /// @brief Build the module belongs to if it's shared with other programs,
+    /// in which case the module must not be changed. Declared first so that
+    /// it's destroyed after the members which refer to its context.
+    std::shared_ptr<shared_build> build;
+
     /// @brief Compiler module. This is guaranteed to be a valid pointer if
     /// `type == device_program_type::COMPILER_MODULE`.
-    std::unique_ptr<compiler::Module> module;
+    std::shared_ptr<compiler::Module> module;
 
     /// @brief An object that manages Mux kernels created from the Mux
     /// executable created when the module is finalized and deferred compilation
@@ -197,6 +277,19 @@ struct device_program {
   /// @param target Compiler target to create the compiler module from.
   void initializeAsCompilerModule(compiler::Target *target);
 
+  /// @brief Initialize this device program as a compiler module shared with
+  /// other programs.
+  ///
+  /// @param build Build of the shared compiler module.
+  void initializeAsSharedBuild(std::shared_ptr<shared_build> build);
+
+  /// @brief Share this device program's finalized compiler module with other
+  /// programs built with the same content.
+  ///
+  /// @param context Context the compiler module was created in.
+  /// @param key Content of the build, see `_cl_program::getBuildKey`.
+  void shareBuild(cl_context context, std::string key);
+
   /// @brief Report a compiler error.
   ///
   /// @param error Error string to report.
@@ -263,6 +356,10 @@ struct device_program {
   /// represents.
   cl_program_binary_type getCLProgramBinaryType() const;
 
+  /// @brief Returns the compile-time telemetry of this device program as a
+  /// JSON object, which is empty unless it is a compiler module.
+  std::string getBuildTelemetry() const;
+
  private:
   /// @brief Clears the device_program state depending on the value of `type`.
   void clear();
@@ -277,8 +374,9 @@ struct device_program {
   /// @brief Compilation log.
   std::string compiler_log;
 
-  /// @brief Program information.
-  cargo::optional<compiler::ProgramInfo> program_info;
+  /// @brief Program information, shared with other programs along with the
+  /// compiler module.
+  std::shared_ptr<compiler::ProgramInfo> program_info;
 
   /// @brief Printf descriptor information.
   std::vector<builtins::printf::descriptor> printf_calls;
@@ -320,6 +418,26 @@ struct _cl_program final : public cl::base<_cl_program> {
     void *user_data;
   };
 
+  /// @brief RAII type for writing the compile-time telemetry of a program to
+  /// the file named by the `CA_CL_BUILD_TELEMETRY_FILE` environment variable.
+  struct telemetry_sink {
+    /// @brief Constructor, store the operation to be recorded later.
+    ///
+    /// @param[in] program _cl_program object pointer, may be set later.
+    /// @param[in] operation Name of the API entry point building the program.
+    telemetry_sink(cl_program program, const char *operation)
+        : program(program), operation(operation) {}
+
+    /// @brief Destructor, appends a line of JSON per device in `devices`.
+    ~telemetry_sink();
+
+    cl_program program;
+    /// @brief Devices the program was built for, only set once the arguments
+    /// have been validated so that nothing is recorded for invalid calls.
+    cargo::array_view<const cl_device_id> devices;
+    const char *operation;
+  };
+
   /// @brief OpenCL C program state.
   struct OpenCLC {
     /// @brief OpenCL C source code string.
@@ -496,6 +614,29 @@ struct _cl_program final : public cl::base<_cl_program> {
   /// @return Return true on success, false on failure.
   bool finalize(cargo::array_view<const cl_device_id> devices);
 
+  /// @brief Get the content a build of the program for a device depends on.
+  ///
+  /// @param[in] device Device the program is built for.
+  ///
+  /// @return Returns the device, options, and source or IL of the program, or
+  /// an empty string if builds of the program can't be shared.
+  std::string getBuildKey(cl_device_id device);
+
+  /// @brief Use the build of another program with the same content for a
+  /// device, see `cl::shared_build`.
+  ///
+  /// @param[in] device Device the program is being built for.
+  ///
+  /// @return Returns true if a build was found, in which case the program
+  /// must not be compiled or finalized for the device.
+  bool adoptSharedBuild(cl_device_id device);
+
+  /// @brief Share the finalized build of the program for a device with any
+  /// program later built with the same content.
+  ///
+  /// @param[in] device Device the program was built for.
+  void publishSharedBuild(cl_device_id device);
+
   /// @brief Query the program for a named kernel.
   ///
   /// @param[in] name Name of the kernel to query.
@@ -20,7 +20,8 @@
 
 static void destroyMemObject(cl_mem object) {
   switch (object->type) {
-    case CL_MEM_OBJECT_BUFFER: {
+    case CL_MEM_OBJECT_BUFFER:
+    case CL_MEM_OBJECT_PIPE: {
       delete static_cast<_cl_mem_buffer *>(object);
       break;
     }
@@ -32,12 +32,15 @@
 
 _cl_mem_buffer::_cl_mem_buffer(
     cl_context context, const cl_mem_flags flags, size_t size, void *host_ptr,
+    const cl_mem_object_type type,
     cargo::dynamic_array<mux_memory_t> &&mux_memories,
     cargo::dynamic_array<mux_buffer_t> &&mux_buffers)
-    : _cl_mem(context, flags, size, CL_MEM_OBJECT_BUFFER, nullptr, host_ptr,
+    : _cl_mem(context, flags, size, type, nullptr, host_ptr,
               cl::ref_count_type::EXTERNAL, std::move(mux_memories)),
       offset(0),
-      mux_buffers(std::move(mux_buffers)) {}
+      mux_buffers(std::move(mux_buffers)),
+      pipe_packet_size(0),
+      pipe_max_packets(0) {}
 
 _cl_mem_buffer::_cl_mem_buffer(
     const cl_mem_flags flags, const size_t offset, const size_t size,
@@ -46,7 +49,9 @@ _cl_mem_buffer::_cl_mem_buffer(
     : _cl_mem(parent->context, flags, size, CL_MEM_OBJECT_BUFFER, parent,
               nullptr, cl::ref_count_type::EXTERNAL, std::move(mux_memories)),
       offset(offset),
-      mux_buffers(std::move(mux_buffers)) {
+      mux_buffers(std::move(mux_buffers)),
+      pipe_packet_size(0),
+      pipe_max_packets(0) {
   if (parent->host_ptr) {
     host_ptr = static_cast<char *>(parent->host_ptr) + offset;
   }
@@ -60,7 +65,8 @@ _cl_mem_buffer::~_cl_mem_buffer() {
 }
 
 cargo::expected<std::unique_ptr<_cl_mem_buffer>, cl_int> _cl_mem_buffer::create(
-    cl_context context, cl_mem_flags flags, size_t size, void *host_ptr) {
+    cl_context context, cl_mem_flags flags, size_t size, void *host_ptr,
+    cl_mem_object_type type) {
   cargo::dynamic_array<mux_memory_t> mux_memories;
   cargo::dynamic_array<mux_buffer_t> mux_buffers;
   if (cargo::success != mux_memories.alloc(context->devices.size()) ||
@@ -80,7 +86,7 @@ cargo::expected<std::unique_ptr<_cl_mem_buffer>, cl_int> _cl_mem_buffer::create(
   }
 
   std::unique_ptr<_cl_mem_buffer> buffer(new (std::nothrow) _cl_mem_buffer(
-      context, flags, size, host_ptr, std::move(mux_memories),
+      context, flags, size, host_ptr, type, std::move(mux_memories),
       std::move(mux_buffers)));
   if (!buffer) {
     return cargo::make_unexpected(CL_OUT_OF_HOST_MEMORY);
@@ -98,7 +104,7 @@ cargo::expected<std::unique_ptr<_cl_mem_buffer>, cl_int> _cl_mem_buffer::create(
     OCL_CHECK(error, return cargo::make_unexpected(error));
     buffer->mux_memories[index] = mux_memory;
 
-    const uint64_t offset = 0;
+    const uint64_t offset = buffer->host_ptr_offset;
     auto mux_error =
         muxBindBufferMemory(mux_device, mux_memory, mux_buffer, offset);
     OCL_CHECK(mux_error,
@@ -124,6 +130,53 @@ cargo::expected<std::unique_ptr<_cl_mem_buffer>, cl_int> _cl_mem_buffer::create(
   return buffer;
 }
 
+cargo::expected<std::unique_ptr<_cl_mem_buffer>, cl_int>
+_cl_mem_buffer::createPipe(cl_context context, cl_mem_flags flags,
+                           cl_uint packet_size, cl_uint max_packets) {
+  // The counters in the header wrap around at 2^32, so the number of packets
+  // in the ring must divide that. Round it up to a power of two, the pipe
+  // still never holds more than max_packets.
+  OCL_CHECK(max_packets > (UINT32_C(1) << 31),
+            return cargo::make_unexpected(CL_INVALID_PIPE_SIZE));
+  uint32_t capacity = 1;
+  while (capacity < max_packets) {
+    capacity <<= 1;
+  }
+  const uint64_t size = pipe_header_size + uint64_t(capacity) * packet_size;
+  for (auto device : context->devices) {
+    OCL_CHECK(size > device->max_mem_alloc_size,
+              return cargo::make_unexpected(CL_INVALID_PIPE_SIZE));
+  }
+
+  auto pipe = create(context, flags, size, nullptr, CL_MEM_OBJECT_PIPE);
+  if (!pipe) {
+    return pipe;
+  }
+  (*pipe)->pipe_packet_size = packet_size;
+  (*pipe)->pipe_max_packets = max_packets;
+
+  uint8_t header[pipe_header_size] = {};
+  std::memcpy(header, &packet_size, sizeof(uint32_t));
+  std::memcpy(header + 4, &capacity, sizeof(uint32_t));
+  std::memcpy(header + 8, &max_packets, sizeof(uint32_t));
+
+  for (cl_uint index = 0; index < context->devices.size(); ++index) {
+    mux_device_t mux_device = context->devices[index]->mux_device;
+    mux_memory_t mux_memory = (*pipe)->mux_memories[index];
+    void *header_ptr = nullptr;
+    OCL_CHECK(muxMapMemory(mux_device, mux_memory, 0, pipe_header_size,
+                           &header_ptr),
+              return cargo::make_unexpected(CL_MEM_OBJECT_ALLOCATION_FAILURE));
+    std::memcpy(header_ptr, header, pipe_header_size);
+    const mux_result_t flush_error = muxFlushMappedMemoryToDevice(
+        mux_device, mux_memory, 0, pipe_header_size);
+    OCL_CHECK(muxUnmapMemory(mux_device, mux_memory) || flush_error,
+              return cargo::make_unexpected(CL_MEM_OBJECT_ALLOCATION_FAILURE));
+  }
+
+  return pipe;
+}
+
 cl_int _cl_mem_buffer::synchronize(cl_command_queue command_queue) {
   // Synchronization only required if multiple devices are present in a context.
   if (context->devices.size() > 1) {
@@ -198,6 +251,9 @@ CL_API_ENTRY cl_mem CL_API_CALL cl::CreateSubBuffer(
   const tracer::TraceGuard<tracer::OpenCL> guard("clCreateSubBuffer");
   OCL_CHECK(!buffer, OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_MEM_OBJECT);
             return nullptr);
+  OCL_CHECK(CL_MEM_OBJECT_BUFFER != buffer->type,
+            OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_MEM_OBJECT);
+            return nullptr);
   const cl_mem_flags rwMask =
       (CL_MEM_READ_WRITE | CL_MEM_READ_ONLY | CL_MEM_WRITE_ONLY);
 
@@ -307,9 +363,9 @@ CL_API_ENTRY cl_mem CL_API_CALL cl::CreateSubBuffer(
                                              CL_MEM_OBJECT_ALLOCATION_FAILURE);
               return nullptr);
 
-    mux_error =
-        muxBindBufferMemory(device->mux_device, sub_buffer->mux_memories[index],
-                            sub_buffer->mux_buffers[index], origin);
+    mux_error = muxBindBufferMemory(
+        device->mux_device, sub_buffer->mux_memories[index],
+        sub_buffer->mux_buffers[index], buffer->host_ptr_offset + origin);
     OCL_CHECK(mux_error, OCL_SET_IF_NOT_NULL(errcode_ret,
                                              CL_MEM_OBJECT_ALLOCATION_FAILURE);
               return nullptr);
@@ -22,6 +22,7 @@
 #include <cl/kernel.h>
 #include <cl/mux.h>
 #include <cl/platform.h>
+#include <cl/printf.h>
 #include <cl/program.h>
 #include <cl/semaphore.h>
 #include <cl/validate.h>
@@ -1322,6 +1323,9 @@ CL_API_ENTRY cl_int CL_API_CALL cl::Finish(cl_command_queue command_queue) {
 
   command_queue->waitForEvents(1, &event_release_guard.get());
 
+  // printf output of the completed kernels must be visible on return
+  flushPrintfOutput(command_queue->mux_queue);
+
   return CL_SUCCESS;
 }
 
@@ -78,6 +78,11 @@ _cl_context::~_cl_context() {
   // The compiler context must be destroyed before we release the internal
   // references to the devices within the context.
   compiler_context.reset();
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  // USM pools own Mux objects, so must be destroyed while the devices are
+  // still alive. All allocations retain the context, so none remain.
+  usm_pools.clear();
+#endif
   // In applications which release the context in a global variables destructor
   // releasing the devices here may cause them to be destroyed at this point if
   // their internal reference count is 1, therefore any objects in the context
@@ -97,6 +102,14 @@ bool _cl_context::hasDevice(const cl_device_id device) const {
   return std::find(devices.begin(), devices.end(), device) != devices.end();
 }
 
+#ifdef CL_VERSION_3_0
+bool _cl_context::supportsSVM() const {
+  return std::any_of(devices.begin(), devices.end(), [](cl_device_id device) {
+    return 0 != device->svm_capabilities;
+  });
+}
+#endif
+
 cl_uint _cl_context::getDeviceIndex(const cl_device_id device) const {
   auto it = std::find(devices.begin(), devices.end(), device);
   if (it == devices.end()) {
@@ -23,6 +23,7 @@
 #include <cl/limits.h>
 #include <cl/macros.h>
 #include <cl/platform.h>
+#include <cl/printf.h>
 #include <cl/validate.h>
 #include <compiler/context.h>
 #include <compiler/limits.h>
@@ -32,6 +33,7 @@
 #include <algorithm>
 #include <climits>
 #include <cstring>
+#include <new>
 #include <type_traits>
 
 // Clamp a value into a range specified by [lo..hi]
@@ -75,10 +77,54 @@ static cl_device_fp_config setOpenCLFromMux(uint32_t capabilities) {
   return config;
 }
 
+// Whether `device` is one of `devices` or a live sub-device partitioned from
+// one of them. The platform's sub_devices_mutex must be held.
+template <class Devices>
+static bool isLiveDevice(const Devices &devices, cl_device_id device) {
+  for (auto candidate : devices) {
+    if (candidate == device || isLiveDevice(candidate->sub_devices, device)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#ifdef CL_VERSION_3_0
+static cl_device_svm_capabilities getSVMCapabilities(
+    mux_device_info_t device_info) {
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  // SVM allocations are host USM allocations, so are supported exactly when
+  // host USM allocations are, see deviceSupportsHostAllocations().
+  if (!(device_info->allocation_capabilities &
+        mux_allocation_capabilities_cached_host)) {
+    return 0;
+  }
+#if INTPTR_MAX == INT64_MAX
+  if (!(device_info->address_capabilities & mux_address_capabilities_bits64)) {
+#else
+  if (!(device_info->address_capabilities & mux_address_capabilities_bits32)) {
+#endif
+    return 0;
+  }
+  // The device accesses host memory directly so needs no map or unmap to see
+  // host writes, which makes every buffer fine-grained. SVM atomics are not
+  // reported as atomic_memory_capabilities only has work-group scope.
+  return CL_DEVICE_SVM_COARSE_GRAIN_BUFFER | CL_DEVICE_SVM_FINE_GRAIN_BUFFER;
+#else
+  (void)device_info;
+  return 0;
+#endif
+}
+#endif
+
 _cl_device_id::_cl_device_id(cl_platform_id platform,
                              mux_allocator_info_t mux_allocator,
-                             mux_device_t mux_device)
-    : base<_cl_device_id>(cl::ref_count_type::INTERNAL),
+                             mux_device_t mux_device,
+                             cl_device_id parent_device)
+    // Root-level devices are owned by the platform, only sub-devices have an
+    // external reference count.
+    : base<_cl_device_id>(parent_device ? cl::ref_count_type::EXTERNAL
+                                        : cl::ref_count_type::INTERNAL),
       platform(platform),
       mux_allocator(mux_allocator),
       mux_device(mux_device),
@@ -114,7 +160,7 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
                          ? CL_LOCAL
                          : CL_GLOBAL),
       max_clock_frequency(mux_device->info->clock_frequency),
-      max_compute_units(mux_device->info->compute_units),
+      max_compute_units(mux_device->compute_units),
       max_constant_args(8),                   // 8 is spec mandated minimum
       max_constant_buffer_size(64L * 1024L),  // 64k is spec mandated minimum
       max_mem_alloc_size(mux_device->info->allocation_size),
@@ -153,11 +199,11 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
               ? clamp(mux_device->info->native_vector_width / sizeof(cl_half),
                       1, 16)
               : 0),
-      parent_device(0),
+      parent_device(parent_device),
       partition_max_sub_devices(0),
-      partition_properties(0),
+      partition_properties(),
       partition_affinity_domain(0),
-      partition_type(0),
+      partition_type(),
       preferred_vector_width_char(clamp(
           mux_device->info->preferred_vector_width / sizeof(cl_char), 1, 16)),
       preferred_vector_width_short(clamp(
@@ -181,6 +227,8 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
                     1, 16)
               : 0),
       printf_buffer_size(compiler::PRINTF_BUFFER_SIZE),
+      printf_buffer_pool(
+          std::make_unique<printf_buffer_pool_t>(mux_device, mux_allocator)),
       preferred_interop_user_sync(CL_TRUE),
       profile(),
       profiling_timer_resolution(5),  // Get from Mux?
@@ -189,14 +237,13 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
                        | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE
 #endif
                        ),  // Get from Mux?
-      reference_count(1),  // All devices are root devices.
       single_fp_config(setOpenCLFromMux(mux_device->info->float_capabilities) |
                        CL_FP_CORRECTLY_ROUNDED_DIVIDE_SQRT),
       type(),
       vendor_id(mux_device->info->khronos_vendor_id)
 #ifdef CL_VERSION_3_0
       ,
-      svm_capabilities(0),
+      svm_capabilities(getSVMCapabilities(mux_device->info)),
       atomic_memory_capabilities(CL_DEVICE_ATOMIC_ORDER_RELAXED |
                                  CL_DEVICE_ATOMIC_SCOPE_WORK_GROUP),
       atomic_fence_capabilities(CL_DEVICE_ATOMIC_ORDER_RELAXED |
@@ -208,10 +255,12 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
       queue_on_device_max_size(0),
       max_on_device_queues(0),
       max_on_device_events(0),
-      pipe_support(CL_FALSE),
-      max_pipe_args(0),
-      pipe_max_active_reservations(0),
-      pipe_max_packet_size(0),
+      pipe_support(mux_device->info->supports_pipes ? CL_TRUE : CL_FALSE),
+      max_pipe_args(mux_device->info->supports_pipes ? 16 : 0),
+      // Reservations are committed in the order they were made, so a
+      // work-item holding more than one could wait on itself.
+      pipe_max_active_reservations(mux_device->info->supports_pipes ? 1 : 0),
+      pipe_max_packet_size(mux_device->info->supports_pipes ? 1024 : 0),
       max_global_variable_size(0),
       global_variable_prefered_total_size(0),
       non_uniform_work_group_support(0),
@@ -233,6 +282,42 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
 #endif
 {
   cl::retainInternal(platform);
+  if (parent_device) {
+    cl::retainInternal(parent_device);
+  }
+
+  // Devices are partitioned along their compute units, so a device with a
+  // single compute unit can't be partitioned any further.
+  const uint32_t partition_capabilities =
+      max_compute_units > 1 ? mux_device->info->partition_capabilities : 0;
+  if (partition_capabilities & mux_partition_capabilities_compute_units) {
+    auto error = partition_properties.assign(
+        {CL_DEVICE_PARTITION_EQUALLY, CL_DEVICE_PARTITION_BY_COUNTS});
+    (void)error;
+    OCL_ASSERT(error == cargo::success, "Out of memory");
+  }
+  if (partition_capabilities & mux_partition_capabilities_numa) {
+    auto error =
+        partition_properties.push_back(CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN);
+    (void)error;
+    OCL_ASSERT(error == cargo::success, "Out of memory");
+    partition_affinity_domain = CL_DEVICE_AFFINITY_DOMAIN_NUMA |
+                                CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE;
+  }
+  if (partition_properties.empty()) {
+    auto error = partition_properties.push_back(0);
+    (void)error;
+    OCL_ASSERT(error == cargo::success, "Out of memory");
+  } else {
+    partition_max_sub_devices =
+        std::min(max_compute_units, mux_device->info->max_sub_devices);
+  }
+  // Sub-devices have their partition type set by clCreateSubDevices.
+  if (!parent_device) {
+    auto error = partition_type.push_back(0);
+    (void)error;
+    OCL_ASSERT(error == cargo::success, "Out of memory");
+  }
 
   version = CA_CL_DEVICE_VERSION;
   compiler_info = compiler::getCompilerForDevice(platform->getCompilerLibrary(),
@@ -335,7 +420,19 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
 }
 
 _cl_device_id::~_cl_device_id() {
+  printf_buffer_pool.reset();
   muxDestroyDevice(mux_device, mux_allocator);
+  if (parent_device) {
+    {
+      const std::lock_guard<std::mutex> lock(platform->sub_devices_mutex);
+      auto &siblings = parent_device->sub_devices;
+      auto found = std::find(siblings.begin(), siblings.end(), this);
+      if (found != siblings.end()) {
+        siblings.erase(found);
+      }
+    }
+    cl::releaseInternal(parent_device);
+  }
   cl::releaseInternal(platform);
 }
 
@@ -424,38 +521,47 @@ CL_API_ENTRY cl_int CL_API_CALL cl::RetainDevice(cl_device_id device) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clRetainDevice");
   // The OpenCL spec says that this function does nothing for root level
   // devices (because such devices are not created, they are retrieved via
-  // clGetDeviceIDs). We don't support sub devices yet, so there is no actual
-  // work to do here.  We do, however, need to check if it's a pointer to an
-  // actual device.
+  // clGetDeviceIDs), only sub devices are reference counted.
   //
   // From section 4.3 of the OpenCL 1.2 spec (page 53):
   // "The function clRetainDevice increments the device reference count if
   // 'device' is a valid sub-device created by a call to clCreateSubDevices. If
   // 'device' is a root level device i.e. a cl_device_id returned by
   // clGetDeviceIDs, the 'device' reference count remains unchanged."
+  OCL_CHECK(!device, return CL_INVALID_DEVICE);
   auto platform = _cl_platform_id::getInstance();
   if (!platform) {
     return CL_INVALID_DEVICE;
   }
   auto &devices = platform.value()->devices;
-  if (std::find(devices.begin(), devices.end(), device) == devices.end()) {
-    return CL_INVALID_DEVICE;
+  if (std::find(devices.begin(), devices.end(), device) != devices.end()) {
+    return CL_SUCCESS;
   }
-  return CL_SUCCESS;
+  // Anything else must be a sub-device that has not yet been destroyed.
+  {
+    const std::lock_guard<std::mutex> lock(platform.value()->sub_devices_mutex);
+    OCL_CHECK(!isLiveDevice(devices, device), return CL_INVALID_DEVICE);
+  }
+  return cl::retainExternal(device);
 }
 
 CL_API_ENTRY cl_int CL_API_CALL cl::ReleaseDevice(cl_device_id device) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clReleaseDevice");
-  // This function does not release anything, see cl::RetainDevice.
+  // Root level devices are not released, see cl::RetainDevice.
+  OCL_CHECK(!device, return CL_INVALID_DEVICE);
   auto platform = _cl_platform_id::getInstance();
   if (!platform) {
     return CL_INVALID_DEVICE;
   }
   auto &devices = platform.value()->devices;
-  if (std::find(devices.begin(), devices.end(), device) == devices.end()) {
-    return CL_INVALID_DEVICE;
+  if (std::find(devices.begin(), devices.end(), device) != devices.end()) {
+    return CL_SUCCESS;
   }
-  return CL_SUCCESS;
+  {
+    const std::lock_guard<std::mutex> lock(platform.value()->sub_devices_mutex);
+    OCL_CHECK(!isLiveDevice(devices, device), return CL_INVALID_DEVICE);
+  }
+  return cl::releaseExternal(device);
 }
 
 CL_API_ENTRY cl_int CL_API_CALL cl::GetDeviceInfo(
@@ -620,11 +726,12 @@ CL_API_ENTRY cl_int CL_API_CALL cl::GetDeviceInfo(
       DEVICE_INFO_CASE(CL_DEVICE_PARENT_DEVICE, device->parent_device);
       DEVICE_INFO_CASE(CL_DEVICE_PARTITION_MAX_SUB_DEVICES,
                        device->partition_max_sub_devices);
-      DEVICE_INFO_CASE(CL_DEVICE_PARTITION_PROPERTIES,
-                       device->partition_properties);
+      DEVICE_INFO_CASE_SPECIAL_VECTOR(CL_DEVICE_PARTITION_PROPERTIES,
+                                      device->partition_properties);
       DEVICE_INFO_CASE(CL_DEVICE_PARTITION_AFFINITY_DOMAIN,
                        device->partition_affinity_domain);
-      DEVICE_INFO_CASE(CL_DEVICE_PARTITION_TYPE, device->partition_type);
+      DEVICE_INFO_CASE_SPECIAL_VECTOR(CL_DEVICE_PARTITION_TYPE,
+                                      device->partition_type);
       DEVICE_INFO_CASE(CL_DEVICE_PLATFORM, device->platform);
       DEVICE_INFO_CASE(CL_DEVICE_PREFERRED_VECTOR_WIDTH_CHAR,
                        device->preferred_vector_width_char);
@@ -648,7 +755,9 @@ CL_API_ENTRY cl_int CL_API_CALL cl::GetDeviceInfo(
       DEVICE_INFO_CASE(CL_DEVICE_PROFILING_TIMER_RESOLUTION,
                        device->profiling_timer_resolution);
       DEVICE_INFO_CASE(CL_DEVICE_QUEUE_PROPERTIES, device->queue_properties);
-      DEVICE_INFO_CASE(CL_DEVICE_REFERENCE_COUNT, device->reference_count);
+      // Root-level devices always report a reference count of 1.
+      DEVICE_INFO_CASE(CL_DEVICE_REFERENCE_COUNT,
+                       device->parent_device ? device->refCountExternal() : 1u);
       DEVICE_INFO_CASE(CL_DEVICE_TYPE, device->type);
       DEVICE_INFO_CASE(CL_DEVICE_VENDOR_ID, device->vendor_id);
       DEVICE_INFO_CASE_SPECIAL_STRING(CL_DRIVER_VERSION, driver_version);
@@ -939,42 +1048,145 @@ CL_API_ENTRY cl_int CL_API_CALL cl::CreateSubDevices(
     cl_uint num_devices, cl_device_id *out_devices, cl_uint *num_devices_ret) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clCreateSubDevices");
   OCL_CHECK(!in_device, return CL_INVALID_DEVICE);
+  OCL_CHECK(!properties || 0 == properties[0], return CL_INVALID_VALUE);
+  OCL_CHECK(std::find(in_device->partition_properties.begin(),
+                      in_device->partition_properties.end(),
+                      properties[0]) == in_device->partition_properties.end(),
+            return CL_INVALID_VALUE);
 
-  OCL_UNUSED(out_devices);
-
-  if (properties) {
-    switch (properties[0]) {
-      case CL_DEVICE_PARTITION_EQUALLY: {
-        const cl_uint num_sub_devices = static_cast<cl_uint>(properties[1]);
-        OCL_CHECK(num_sub_devices > num_devices, return CL_INVALID_VALUE);
-        return CL_INVALID_VALUE;  // Sub devices not supported
+  mux_partition_capabilities_e partition =
+      mux_partition_capabilities_compute_units;
+  cargo::small_vector<uint32_t, 8> counts;
+  cargo::small_vector<cl_device_partition_property, 4> partition_type;
+  switch (properties[0]) {
+    case CL_DEVICE_PARTITION_EQUALLY: {
+      OCL_CHECK(properties[1] <= 0, return CL_INVALID_VALUE);
+      OCL_CHECK(static_cast<cl_ulong>(properties[1]) >
+                    in_device->max_compute_units,
+                return CL_DEVICE_PARTITION_FAILED);
+      const cl_uint compute_units = static_cast<cl_uint>(properties[1]);
+      const cl_uint count =
+          std::min(in_device->max_compute_units / compute_units,
+                   in_device->partition_max_sub_devices);
+      if (counts.assign(count, compute_units) ||
+          partition_type.assign({properties[0], properties[1], 0})) {
+        return CL_OUT_OF_HOST_MEMORY;
       }
-      case CL_DEVICE_PARTITION_BY_COUNTS: {
-        OCL_CHECK(static_cast<cl_uint>(properties[1]) >
-                      in_device->partition_max_sub_devices,
-                  return CL_INVALID_DEVICE_PARTITION_COUNT);
-        cl_uint idx = 0, device_count = 0, cu_count = 0;
-        while (properties[++idx] != CL_DEVICE_PARTITION_BY_COUNTS_LIST_END) {
-          if (properties[idx] != 0) {
-            device_count++;
-            cu_count += static_cast<cl_uint>(properties[idx]);
-          }
-        }
-        OCL_CHECK(device_count > in_device->max_compute_units,
+    } break;
+    case CL_DEVICE_PARTITION_BY_COUNTS: {
+      cl_uint total = 0;
+      size_t index = 1;
+      for (; properties[index] != CL_DEVICE_PARTITION_BY_COUNTS_LIST_END;
+           index++) {
+        OCL_CHECK(properties[index] < 0,
                   return CL_INVALID_DEVICE_PARTITION_COUNT);
-        OCL_CHECK(cu_count > in_device->partition_max_sub_devices,
+        OCL_CHECK(static_cast<cl_ulong>(properties[index]) >
+                      in_device->max_compute_units - total,
                   return CL_INVALID_DEVICE_PARTITION_COUNT);
+        const cl_uint compute_units = static_cast<cl_uint>(properties[index]);
+        total += compute_units;
+        if (0 == compute_units) {
+          continue;
+        }
+        if (counts.push_back(compute_units)) {
+          return CL_OUT_OF_HOST_MEMORY;
+        }
+      }
+      OCL_CHECK(counts.empty() ||
+                    counts.size() > in_device->partition_max_sub_devices,
+                return CL_INVALID_DEVICE_PARTITION_COUNT);
+      // Report the list as given, including its end marker.
+      if (partition_type.assign(properties, properties + index + 1) ||
+          partition_type.push_back(0)) {
+        return CL_OUT_OF_HOST_MEMORY;
+      }
+    } break;
+    case CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN: {
+      const auto domain = static_cast<cl_device_affinity_domain>(properties[1]);
+      OCL_CHECK((CL_DEVICE_AFFINITY_DOMAIN_NUMA != domain &&
+                 CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE != domain) ||
+                    !(in_device->partition_affinity_domain & domain),
+                return CL_INVALID_VALUE);
+      partition = mux_partition_capabilities_numa;
+      // NUMA nodes are the only affinity domain, so the next partitionable
+      // domain is always the NUMA node.
+      if (partition_type.assign({properties[0],
+                                 CL_DEVICE_AFFINITY_DOMAIN_NUMA, 0})) {
+        return CL_OUT_OF_HOST_MEMORY;
+      }
+    } break;
+    default:
+      return CL_INVALID_VALUE;
+  }
 
-        return CL_INVALID_VALUE;  // Sub devices not supported
+  auto getErrorFrom = [](mux_result_t error) {
+    return mux_error_out_of_memory == error ? CL_OUT_OF_HOST_MEMORY
+                                            : CL_DEVICE_PARTITION_FAILED;
+  };
+
+  uint32_t count = 0;
+  if (auto error = muxCreateSubDevices(
+          in_device->mux_device, partition,
+          static_cast<uint32_t>(counts.size()), counts.data(),
+          in_device->mux_allocator, 0, nullptr, &count)) {
+    return getErrorFrom(error);
+  }
+  OCL_CHECK(0 == count, return CL_DEVICE_PARTITION_FAILED);
+  OCL_CHECK(out_devices && num_devices < count, return CL_INVALID_VALUE);
+
+  if (out_devices) {
+    cargo::small_vector<mux_device_t, 8> mux_devices;
+    if (mux_devices.resize(count)) {
+      return CL_OUT_OF_HOST_MEMORY;
+    }
+    if (auto error = muxCreateSubDevices(
+            in_device->mux_device, partition,
+            static_cast<uint32_t>(counts.size()), counts.data(),
+            in_device->mux_allocator, count, mux_devices.data(), nullptr)) {
+      return getErrorFrom(error);
+    }
+    // Each cl_device_id owns its mux_device_t once it has been created.
+    auto releaseDevices = [&](cl_uint created) {
+      for (cl_uint index = 0; index < count; index++) {
+        if (index < created) {
+          cl::releaseExternal(out_devices[index]);
+        } else {
+          muxDestroyDevice(mux_devices[index], in_device->mux_allocator);
+        }
       }
-      case CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN:
-        return CL_INVALID_VALUE;  // Sub devices not supported
-      default:
-        return CL_INVALID_VALUE;
+    };
+    for (cl_uint index = 0; index < count; index++) {
+      out_devices[index] = new (std::nothrow)
+          _cl_device_id(in_device->platform, in_device->mux_allocator,
+                        mux_devices[index], in_device);
+      if (!out_devices[index] ||
+          out_devices[index]->partition_type.assign(partition_type.begin(),
+                                                    partition_type.end())) {
+        releaseDevices(out_devices[index] ? index + 1 : index);
+        return CL_OUT_OF_HOST_MEMORY;
+      }
+    }
+    // Record the sub-devices on their parent so clRetainDevice and
+    // clReleaseDevice can tell them from arbitrary handles.
+    bool recorded = false;
+    {
+      const std::lock_guard<std::mutex> lock(
+          in_device->platform->sub_devices_mutex);
+      auto &sub_devices = in_device->sub_devices;
+      if (!sub_devices.reserve(sub_devices.size() + count)) {
+        for (cl_uint index = 0; index < count; index++) {
+          (void)sub_devices.push_back(out_devices[index]);
+        }
+        recorded = true;
+      }
+    }
+    if (!recorded) {
+      releaseDevices(count);
+      return CL_OUT_OF_HOST_MEMORY;
     }
   }
 
-  OCL_SET_IF_NOT_NULL(num_devices_ret, in_device->partition_max_sub_devices);
+  OCL_SET_IF_NOT_NULL(num_devices_ret, count);
 
   return CL_SUCCESS;
 }
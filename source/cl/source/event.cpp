@@ -20,10 +20,13 @@
 #include <cl/event.h>
 #include <cl/macros.h>
 #include <cl/mux.h>
+#include <cl/printf.h>
 #include <cl/validate.h>
 #include <tracer/tracer.h>
 #include <utils/system.h>
 
+#include <algorithm>
+
 cargo::expected<cl_event, cl_int> _cl_event::create(
     cl_command_queue queue, const cl_command_type type) {
   OCL_ASSERT(queue != nullptr, "queue must not be null");
@@ -122,18 +125,18 @@ void _cl_event::complete(const cl_int status) {
 
   command_status = status;
 
-  // Trigger callbacks before notifying condition variable.
+  // Trigger callbacks before notifying waiters.
   // This is not mandated by the OpenCL 1.2 specs but seems the correct order.
   clear();
 
-  wait_complete_condition.notify_all();
+  wait_complete.notify_all();
 }
 
 void _cl_event::wait() {
-  std::unique_lock<std::mutex> signal_lock(wait_complete_mutex);
-  while (CL_COMPLETE < command_status) {
-    wait_complete_condition.wait(signal_lock);
-  }
+  wait_complete.wait([this] { return CL_COMPLETE >= command_status; });
+  // The status is set before callbacks are called, acquiring the mutex ensures
+  // complete() has finished calling them and touching the event.
+  const std::lock_guard<std::mutex> signal_lock(wait_complete_mutex);
 }
 
 void _cl_event::clear() {
@@ -279,6 +282,16 @@ CL_API_ENTRY cl_int CL_API_CALL cl::WaitForEvents(cl_uint num_events,
     }
   }
 
+  // printf output of the completed kernels must be visible on return
+  for (cl_uint i = 0; i < num_events; i++) {
+    cl_command_queue queue = event_list[i]->queue;
+    if (queue && std::none_of(event_list, event_list + i, [&](cl_event event) {
+          return event->queue == queue;
+        })) {
+      flushPrintfOutput(queue->mux_queue);
+    }
+  }
+
   for (cl_uint i = 0; i < num_events; i++) {
     OCL_CHECK(0 > (event_list[i]->command_status),
               return CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST);
@@ -37,6 +37,15 @@ typedef CL_API_ENTRY cl_int(CL_API_CALL *clSetKernelExecInfoCODEPLAY_fn)(
     size_t param_value_size,
     const void *param_value) CL_API_SUFFIX__VERSION_1_2;
 
+/***********************************
+ * cl_codeplay_extra_build_options *
+ ***********************************/
+
+/// @brief Accepted as `param_name` parameter to `clGetProgramBuildInfo`,
+/// returns a null terminated JSON object describing the time spent in each
+/// phase and pass of compiling the program for the device.
+#define CL_PROGRAM_BUILD_TELEMETRY_CODEPLAY 0x4264
+
 /************************************
  * cl_codeplay_performance_counter   *
  ************************************/
@@ -140,6 +149,32 @@ typedef struct cl_performance_counter_result_codeplay {
   };
 } cl_performance_counter_result_codeplay;
 
+/*****************************
+ * cl_codeplay_usm_pool_stats *
+ *****************************/
+
+/// @brief Accepted as `param_name` parameter to `clGetContextInfo`, returns a
+/// `cl_usm_pool_stats_codeplay` describing the context's USM pools.
+#define CL_CONTEXT_USM_POOL_STATS_CODEPLAY 0x4263
+
+/// @brief Statistics of the pools serving small USM allocations of a context.
+typedef struct cl_usm_pool_stats_codeplay {
+  /// @brief Bytes of memory held by the pools in slabs.
+  cl_ulong reserved_bytes;
+  /// @brief Bytes of slab memory handed out to live allocations, rounded up
+  /// to the size class of each allocation.
+  cl_ulong used_bytes;
+  /// @brief Bytes of freed allocations waiting for commands to complete
+  /// before they are recycled.
+  cl_ulong pending_bytes;
+  /// @brief Number of slabs held by the pools.
+  cl_ulong slab_count;
+  /// @brief Number of allocations served by an existing slab.
+  cl_ulong hit_count;
+  /// @brief Number of allocations which required a new slab.
+  cl_ulong miss_count;
+} cl_usm_pool_stats_codeplay;
+
 /******************
  * cl_codeplay_wfv *
  ******************/
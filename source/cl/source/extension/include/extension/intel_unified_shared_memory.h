@@ -22,13 +22,18 @@
 #define EXTENSION_INTEL_UNIFIED_SHARED_MEMORY_H_INCLUDED
 
 #include <CL/cl_ext.h>
+#include <CL/cl_ext_codeplay.h>
+#include <cargo/array_view.h>
 #include <cargo/dynamic_array.h>
 #include <cargo/expected.h>
+#include <cargo/optional.h>
 #include <cargo/small_vector.h>
 #include <extension/extension.h>
 #include <mux/mux.h>
 
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace extension {
 /// @addtogroup cl_extension
@@ -48,6 +53,11 @@ class intel_unified_shared_memory final : public extension {
                        size_t param_value_size, void *param_value,
                        size_t *param_value_size_ret) const override;
 
+  /// @copydoc extension::extension::GetContextInfo
+  cl_int GetContextInfo(cl_context context, cl_context_info param_name,
+                        size_t param_value_size, void *param_value,
+                        size_t *param_value_size_ret) const override;
+
 #if (defined(CL_VERSION_3_0) || \
      defined(OCL_EXTENSION_cl_codeplay_kernel_exec_info))
   /// @copydoc extension::extension::SetKernelExecInfo
@@ -60,6 +70,166 @@ class intel_unified_shared_memory final : public extension {
 
 #ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
 namespace usm {
+/// @brief Tunable parameters of the USM sub-allocation pools.
+///
+/// Values are read once from the environment, see `getPoolConfig()`.
+struct pool_config_t final {
+  /// @brief Largest allocation in bytes served from a pool, zero disables
+  /// pooling entirely (`CA_USM_POOL_MAX_ALLOC_SIZE`).
+  size_t max_alloc_size;
+  /// @brief Size in bytes of each slab of memory a pool allocates from Mux
+  /// (`CA_USM_POOL_SLAB_SIZE`).
+  size_t slab_size;
+  /// @brief Bytes of completely unused slabs a pool keeps cached rather than
+  /// returning them to Mux (`CA_USM_POOL_RETAIN_SIZE`).
+  size_t retain_size;
+};
+
+/// @brief Get the process wide USM pool configuration.
+///
+/// @return Returns a reference to the configuration, initialized on first
+/// call from the environment.
+const pool_config_t &getPoolConfig();
+
+/// @brief Per-context sub-allocator serving small USM allocations.
+///
+/// Memory is allocated from Mux in large slabs, each slab is divided into
+/// equally sized slots of a single power of two size class. Mux buffers are
+/// bound to each slot on first use and kept alive for as long as the slab
+/// exists, so a recycled slot requires no calls into Mux. Freed slots which
+/// may still be accessed by in-flight commands are not recycled until all of
+/// those commands have completed.
+///
+/// A pool is created either for a single device, backing device allocations,
+/// or for the whole context, backing host and shared allocations with host
+/// memory bound to every device supporting host allocations.
+class memory_pool final {
+  struct slab_t;
+
+ public:
+  /// @brief Handle to a slot within a pool slab.
+  struct allocation_t final {
+    /// @brief Slab the slot belongs to.
+    slab_t *slab = nullptr;
+    /// @brief Index of the slot within the slab.
+    uint32_t slot = 0;
+    /// @brief Address of the first byte of the slot.
+    void *ptr = nullptr;
+  };
+
+  /// @brief Create a pool.
+  ///
+  /// @param[in] context Context the pool belongs to, not retained.
+  /// @param[in] device Device to create a device pool for, or `nullptr` to
+  /// create a pool of host memory.
+  ///
+  /// @return Returns the new pool, or `nullptr` on allocation failure.
+  static std::unique_ptr<memory_pool> create(cl_context context,
+                                             cl_device_id device);
+
+  /// @brief Destructor, releases all slabs and pending events.
+  ~memory_pool();
+
+  /// @brief Sub-allocate from the pool.
+  ///
+  /// @param[in] size Size in bytes of the allocation.
+  /// @param[in] alignment Required alignment in bytes of the allocation.
+  ///
+  /// @return Returns the allocated slot, or `cargo::nullopt` if the request
+  /// can't be served from the pool and a dedicated allocation should be made.
+  cargo::optional<allocation_t> allocate(size_t size, uint32_t alignment);
+
+  /// @brief Get the Mux buffer bound to an allocation for a device.
+  ///
+  /// @param[in] allocation Allocation returned from `allocate()`.
+  /// @param[in] device_index Index of the device in the context.
+  ///
+  /// @return Returns the bound Mux buffer, or `nullptr` if the device has no
+  /// access to memory of this pool or a Mux error occurred.
+  mux_buffer_t getMuxBuffer(const allocation_t &allocation,
+                            cl_uint device_index);
+
+  /// @brief Return an allocation to the pool.
+  ///
+  /// @param[in] allocation Allocation returned from `allocate()`.
+  /// @param[in] events Events of commands which may still access the
+  /// allocation, the slot is only recycled once they have all completed.
+  void release(const allocation_t &allocation,
+               cargo::array_view<const cl_event> events);
+
+  /// @brief Release cached slabs which hold no live allocations.
+  ///
+  /// @param[in] retain_size Bytes of unused slabs to keep cached.
+  void trim(size_t retain_size);
+
+  /// @brief Add the statistics of this pool to @p stats.
+  ///
+  /// @param[in,out] stats Statistics to accumulate into.
+  void accumulateStats(cl_usm_pool_stats_codeplay &stats);
+
+ private:
+  memory_pool(cl_context context, cl_device_id device);
+
+  /// @brief Slots released while commands using them were in flight.
+  struct pending_t final {
+    allocation_t allocation;
+    cargo::small_vector<cl_event, 4> events;
+  };
+
+  /// @brief Allocate a new slab for a size class, `mutex` must be held.
+  ///
+  /// @param[in] class_index Index of the size class in `classes`.
+  ///
+  /// @return Returns the new slab, or `nullptr` on failure.
+  slab_t *allocateSlab(size_t class_index);
+
+  /// @brief Destroy all Mux objects and memory owned by a slab.
+  ///
+  /// @param[in] slab Slab to free, not removed from `classes`.
+  void freeSlab(slab_t *slab);
+
+  /// @brief Return a slot to its slab's free list, `mutex` must be held.
+  ///
+  /// @param[in] allocation Slot to recycle.
+  void recycle(const allocation_t &allocation);
+
+  /// @brief Recycle pending slots whose commands have all completed, `mutex`
+  /// must be held.
+  void reclaimPending();
+
+  /// @brief Implementation of `trim()`, `mutex` must be held.
+  ///
+  /// @param[in] retain_size Bytes of unused slabs to keep cached.
+  void trimLocked(size_t retain_size);
+
+  /// @brief Context the pool belongs to.
+  const cl_context context;
+  /// @brief Device of a device pool, `nullptr` for a host pool.
+  const cl_device_id device;
+  /// @brief Alignment in bytes of every slab, and the smallest size class.
+  uint32_t min_class_size;
+  /// @brief Slabs owned by the pool, indexed by size class.
+  std::vector<std::vector<std::unique_ptr<slab_t>>> classes;
+  /// @brief Slots released with pending commands.
+  std::vector<pending_t> pending;
+  /// @brief Count of allocations served by an existing slab.
+  uint64_t hits = 0;
+  /// @brief Count of allocations which required a new slab.
+  uint64_t misses = 0;
+  /// @brief Mutex protecting all pool state.
+  std::mutex mutex;
+};
+
+/// @brief Get the pool which should serve allocations for a device.
+///
+/// @param[in] context Context owning the pool.
+/// @param[in] device Device to get a device pool for, or `nullptr` for the host
+/// pool.
+///
+/// @return Returns the pool, creating it if required, or `nullptr` if pooling
+/// is disabled or the pool could not be created.
+memory_pool *getPool(cl_context context, cl_device_id device);
+
 /// @brief Bitfield of available USM cl_kernel_exec_info_codeplay flags
 enum kernel_exec_info_flags_e {
   /// @brief CL_KERNEL_EXEC_INFO_INDIRECT_HOST_ACCESS
@@ -208,6 +378,12 @@ class host_allocation_info final : public allocation_info {
 
   /// @brief Mux buffer object bound to every device in the OpenCL context.
   cargo::dynamic_array<mux_buffer_t> mux_buffers;
+
+  /// @brief Pool the allocation was served from, or `nullptr` if the Mux
+  /// objects are owned by this allocation.
+  memory_pool *pool;
+  /// @brief Slot within `pool`, valid only when `pool` is not `nullptr`.
+  memory_pool::allocation_t pool_allocation;
 };
 
 /// @brief Derived class for device USM allocations
@@ -265,10 +441,15 @@ class device_allocation_info final : public allocation_info {
 
   /// @brief OpenCL device associated with memory allocation
   const cl_device_id device;
-  /// @brief Mux memory allocated on device
+  /// @brief Mux memory allocated on device, `nullptr` if pooled
   mux_memory_t mux_memory;
   /// @brief Mux buffer tied to mux_memory
   mux_buffer_t mux_buffer;
+  /// @brief Pool the allocation was served from, or `nullptr` if the Mux
+  /// objects are owned by this allocation.
+  memory_pool *pool;
+  /// @brief Slot within `pool`, valid only when `pool` is not `nullptr`.
+  memory_pool::allocation_t pool_allocation;
 };
 
 /// @brief Derived class for shared USM allocations
@@ -333,10 +514,15 @@ class shared_allocation_info final : public allocation_info {
 
   /// @brief OpenCL device associated with memory allocation, may be nullptr
   const cl_device_id device;
-  /// @brief Mux memory allocated on device
+  /// @brief Mux memory allocated on device, `nullptr` if pooled
   mux_memory_t mux_memory;
   /// @brief Mux buffer tied to mux_memory
   mux_buffer_t mux_buffer;
+  /// @brief Pool the allocation was served from, or `nullptr` if the memory
+  /// is owned by this allocation.
+  memory_pool *pool;
+  /// @brief Slot within `pool`, valid only when `pool` is not `nullptr`.
+  memory_pool::allocation_t pool_allocation;
 };
 
 /// @brief Validates properties passed to the USM allocation entry points for
@@ -401,6 +587,94 @@ bool deviceSupportsSharedAllocations(cl_device_id device);
 cl_int createBlockingEventForKernel(cl_command_queue queue, cl_kernel kernel,
                                     const cl_command_type type,
                                     cl_event &event);
+
+/// @brief Enqueue a copy between USM allocations or host memory.
+///
+/// Implements `clEnqueueMemcpyINTEL`, and `clEnqueueSVMMemcpy` as SVM
+/// allocations are host USM allocations.
+///
+/// @param[in] command_queue Queue to enqueue the copy on.
+/// @param[in] blocking Whether to wait for the copy to complete.
+/// @param[in] dst_ptr Pointer to copy to.
+/// @param[in] src_ptr Pointer to copy from.
+/// @param[in] size Bytes to copy.
+/// @param[in] num_events_in_wait_list Number of events in @p event_wait_list.
+/// @param[in] event_wait_list Events the copy waits for.
+/// @param[out] event Event of the copy, may be null.
+/// @param[in] command_type Command type reported by @p event.
+///
+/// @return CL_SUCCESS, or an OpenCL error code on failure.
+cl_int enqueueMemcpy(cl_command_queue command_queue, cl_bool blocking,
+                     void *dst_ptr, const void *src_ptr, size_t size,
+                     cl_uint num_events_in_wait_list,
+                     const cl_event *event_wait_list, cl_event *event,
+                     cl_command_type command_type);
+
+/// @brief Enqueue a fill of a USM allocation or host memory with a pattern.
+///
+/// Implements `clEnqueueMemFillINTEL` and `clEnqueueSVMMemFill`.
+///
+/// @param[in] command_queue Queue to enqueue the fill on.
+/// @param[in] dst_ptr Pointer to fill.
+/// @param[in] pattern Pattern to fill with.
+/// @param[in] pattern_size Size in bytes of @p pattern.
+/// @param[in] size Bytes to fill.
+/// @param[in] num_events_in_wait_list Number of events in @p event_wait_list.
+/// @param[in] event_wait_list Events the fill waits for.
+/// @param[out] event Event of the fill, may be null.
+/// @param[in] command_type Command type reported by @p event.
+///
+/// @return CL_SUCCESS, or an OpenCL error code on failure.
+cl_int enqueueMemFill(cl_command_queue command_queue, void *dst_ptr,
+                      const void *pattern, size_t pattern_size, size_t size,
+                      cl_uint num_events_in_wait_list,
+                      const cl_event *event_wait_list, cl_event *event,
+                      cl_command_type command_type);
+
+/// @brief Enqueue a command which does no work but orders accesses to USM
+/// allocations.
+///
+/// Implements `clEnqueueSVMMap` and friends, which need no copies as host
+/// allocations are coherent with the host. The command is recorded by any
+/// allocations @p pointers belong to so blocking frees wait for it.
+///
+/// @param[in] command_queue Queue to enqueue the command on.
+/// @param[in] blocking Whether to wait for the command to complete.
+/// @param[in] pointers Pointers the command accesses.
+/// @param[in] num_events_in_wait_list Number of events in @p event_wait_list.
+/// @param[in] event_wait_list Events the command waits for.
+/// @param[out] event Event of the command, may be null.
+/// @param[in] command_type Command type reported by @p event.
+///
+/// @return CL_SUCCESS, or an OpenCL error code on failure.
+cl_int enqueueMarker(cl_command_queue command_queue, cl_bool blocking,
+                     cargo::array_view<const void *const> pointers,
+                     cl_uint num_events_in_wait_list,
+                     const cl_event *event_wait_list, cl_event *event,
+                     cl_command_type command_type);
+
+/// @brief Enqueue a command freeing USM allocations, implements
+/// `clEnqueueSVMFree`.
+///
+/// @param[in] command_queue Queue to enqueue the free on.
+/// @param[in] num_pointers Number of elements in @p pointers.
+/// @param[in] pointers Base pointers of the allocations to free.
+/// @param[in] pfn_free_func Callback which frees the allocations instead, may
+/// be null.
+/// @param[in] user_data Passed to @p pfn_free_func.
+/// @param[in] num_events_in_wait_list Number of events in @p event_wait_list.
+/// @param[in] event_wait_list Events the free waits for.
+/// @param[out] event Event of the free, may be null.
+///
+/// @return CL_SUCCESS, or an OpenCL error code on failure.
+cl_int enqueueFree(cl_command_queue command_queue, cl_uint num_pointers,
+                   void *pointers[],
+                   void(CL_CALLBACK *pfn_free_func)(cl_command_queue queue,
+                                                    cl_uint num_pointers,
+                                                    void *pointers[],
+                                                    void *user_data),
+                   void *user_data, cl_uint num_events_in_wait_list,
+                   const cl_event *event_wait_list, cl_event *event);
 }  // namespace usm
 #endif  // OCL_EXTENSION_cl_intel_unified_shared_memory
 /// @}
@@ -25,17 +25,21 @@
 #include <CL/cl_ext.h>
 #include <cargo/dynamic_array.h>
 #include <cargo/expected.h>
+#include <cargo/optional.h>
 #include <cargo/small_vector.h>
 #include <cl/base.h>
 #include <cl/limits.h>
 #include <cl/mux.h>
+#include <compiler/kernel.h>
 #include <extension/extension.h>
 
 #include <array>
 #include <atomic>
+#include <memory>
 #include <mutex>
 
 struct printf_info_t;
+class MuxKernelWrapper;
 
 namespace extension {
 /// @addtogroup cl_extension
@@ -163,6 +167,37 @@ struct _cl_command_buffer_khr final : public cl::base<_cl_command_buffer_khr> {
   /// @brief List of mux sync-points indexed by cl_sync_point_khr
   cargo::small_vector<mux_sync_point_t, 4> mux_sync_points;
 
+  /// @brief An ND-range command which has been recorded but not yet passed to
+  /// mux, so that it can be fused with the ND-range commands following it.
+  struct PendingNDRange final {
+    /// @brief Kernel the command executes.
+    cl_kernel kernel;
+    /// @brief Deferred compiler kernel of `kernel` on the queue's device.
+    std::shared_ptr<compiler::Kernel> deferred_kernel;
+    /// @brief Local size in the first dimension.
+    size_t local_size;
+    /// @brief Global offset in the first dimension.
+    size_t global_offset;
+    /// @brief Global size in the first dimension.
+    size_t global_size;
+    /// @brief Descriptors of the kernel's arguments when it was recorded.
+    cargo::dynamic_array<mux_descriptor_info_s> descriptors;
+    /// @brief Copy of the by-value arguments the descriptors point to.
+    cargo::dynamic_array<uint8_t> values;
+    /// @brief Memory object bound to each argument, or null.
+    cargo::dynamic_array<cl_mem> buffers;
+    /// @brief Sync-points the command waits on.
+    cargo::small_vector<cl_sync_point_khr, 4> wait_list;
+    /// @brief Sync-point returned for the command, if one was requested.
+    cargo::optional<cl_sync_point_khr> sync_point;
+  };
+  /// @brief ND-range commands waiting to be fused, all with the same global
+  /// and local sizes.
+  cargo::small_vector<PendingNDRange, 4> pending_ndranges;
+  /// @brief Kernels created by fusing pending ND-range commands, which must
+  /// outlive the mux kernels specialized from them.
+  cargo::small_vector<std::shared_ptr<compiler::Kernel>, 2> fused_kernels;
+
   /// @brief Private constructor, use the `create()` function instead.
   ///
   /// By making the constructor private we can restrict creation of
@@ -211,6 +246,58 @@ struct _cl_command_buffer_khr final : public cl::base<_cl_command_buffer_khr> {
   convertWaitList(
       const cargo::array_view<const cl_sync_point_khr> &cl_wait_list);
 
+  /// @brief Checks whether an ND-range command could be fused with others.
+  ///
+  /// Only one-dimensional ND-ranges of deferred compiled kernels which don't
+  /// call printf and only take buffers and values as arguments can be fused,
+  /// and only when `CA_COMMAND_BUFFER_FUSION` is set to a non-zero value.
+  ///
+  /// @param[in] kernel Kernel the command executes.
+  /// @param[in] work_dim Number of dimensions of the ND-range.
+  /// @param[in] mutable_handle Handle requested for the command, if any.
+  bool isFusionCandidate(cl_kernel kernel, cl_uint work_dim,
+                         cl_mutable_command_khr *mutable_handle) const;
+
+  /// @brief Records an ND-range command as pending, so that it can be fused
+  /// with the ND-range commands following it.
+  ///
+  /// Any pending commands the command can't be fused with are flushed first.
+  ///
+  /// @param[in] kernel Kernel the command executes.
+  /// @param[in] local_size Local size of the command.
+  /// @param[in] global_offset Global offset of the command.
+  /// @param[in] global_size Global size of the command.
+  /// @param[in] options Execution options of the command.
+  /// @param[in] cl_wait_list Sync-points the command waits on.
+  /// @param[out] cl_sync_point Sync-point returned for the command, may be
+  /// null.
+  ///
+  /// @return CL_SUCCESS or appropriate error if recording failed.
+  cl_int recordPendingNDRange(
+      cl_kernel kernel, size_t local_size, size_t global_offset,
+      size_t global_size, const mux_ndrange_options_t &options,
+      const cargo::array_view<const cl_sync_point_khr> &cl_wait_list,
+      cl_sync_point_khr *cl_sync_point);
+
+  /// @brief Passes the pending ND-range commands to mux, as a single fused
+  /// kernel if the compiler can fuse them or individually otherwise.
+  ///
+  /// @return CL_SUCCESS or appropriate error if recording failed.
+  cl_int flushPendingNDRanges();
+
+  /// @brief Passes an ND-range command to mux.
+  ///
+  /// @param[in] wrapper Kernel to specialize for the command.
+  /// @param[in] options Execution options of the command.
+  /// @param[in] wait_list Sync-points the command waits on.
+  /// @param[out] mux_sync_point Sync-point of the command, may be null.
+  ///
+  /// @return CL_SUCCESS or appropriate error if recording failed.
+  cl_int recordNDRange(MuxKernelWrapper &wrapper,
+                       const mux_ndrange_options_t &options,
+                       cargo::array_view<const cl_sync_point_khr> wait_list,
+                       mux_sync_point_t *mux_sync_point);
+
  public:
   /// @brief Boolean flag indicating whether the clFinalizeCommandBufferKHR API
   /// has been called on this command-buffer.
@@ -14,8 +14,13 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <CL/cl_ext_codeplay.h>
+#include <cl/macros.h>
+#include <cl/program.h>
 #include <extension/codeplay_extra_build_options.h>
 
+#include <cstring>
+
 extension::codeplay_extra_build_options::codeplay_extra_build_options()
     : extension("cl_codeplay_extra_build_options",
 #ifdef OCL_EXTENSION_cl_codeplay_extra_build_options
@@ -23,5 +28,33 @@ extension::codeplay_extra_build_options::codeplay_extra_build_options()
 #else
                 usage_category::DISABLED
 #endif
-                    CA_CL_EXT_VERSION(0, 6, 0)) {
+                    CA_CL_EXT_VERSION(0, 7, 0)) {
+}
+
+cl_int extension::codeplay_extra_build_options::GetProgramBuildInfo(
+    cl_program program, cl_device_id device, cl_program_build_info param_name,
+    size_t param_value_size, void *param_value,
+    size_t *param_value_size_ret) const {
+  // Only report extension if the extension wasn't disabled in cmake.
+  if (usage_category::DISABLED == usage) {
+    return CL_INVALID_VALUE;
+  }
+
+  if (CL_PROGRAM_BUILD_TELEMETRY_CODEPLAY == param_name) {
+    const std::string telemetry =
+        program->programs[device].getBuildTelemetry();
+    // need + 1 for the null terminator
+    const size_t size = telemetry.size() + 1;
+    OCL_SET_IF_NOT_NULL(param_value_size_ret, size);
+    OCL_CHECK(param_value && param_value_size < size, return CL_INVALID_VALUE);
+    if (param_value) {
+      std::strncpy(static_cast<char *>(param_value), telemetry.c_str(),
+                   param_value_size);
+    }
+    return CL_SUCCESS;
+  }
+
+  return extension::GetProgramBuildInfo(program, device, param_name,
+                                        param_value_size, param_value,
+                                        param_value_size_ret);
 }
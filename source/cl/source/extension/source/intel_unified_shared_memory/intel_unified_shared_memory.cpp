@@ -204,9 +204,17 @@ mux_result_t allocation_info::record_event(cl_event event) {
 
 host_allocation_info::host_allocation_info(const cl_context context,
                                            const size_t size)
-    : allocation_info(context, size) {}
+    : allocation_info(context, size), pool(nullptr) {}
 
 host_allocation_info::~host_allocation_info() {
+  if (pool) {
+    // The Mux objects and memory are owned by the pool, hand the slot back
+    // once any commands still using it have completed.
+    pool->release(pool_allocation,
+                  {queued_commands.data(), queued_commands.size()});
+    return;
+  }
+
   // Free the Mux objects we've created
   for (cl_uint index = 0; index < context->devices.size(); ++index) {
     auto device = context->devices[index];
@@ -273,11 +281,6 @@ host_allocation_info::create(cl_context context,
 }
 
 cl_int host_allocation_info::allocate(cl_uint alignment) {
-  base_ptr = cargo::alloc(size, alignment);
-  if (base_ptr == nullptr) {
-    return CL_OUT_OF_HOST_MEMORY;
-  }
-
   const size_t num_devices = context->devices.size();
   if (cargo::success != mux_memories.alloc(num_devices)) {
     return CL_OUT_OF_HOST_MEMORY;
@@ -287,6 +290,29 @@ cl_int host_allocation_info::allocate(cl_uint alignment) {
     return CL_OUT_OF_HOST_MEMORY;
   }
 
+  if (auto usm_pool = getPool(context, nullptr)) {
+    if (auto allocation = usm_pool->allocate(size, alignment)) {
+      pool = usm_pool;
+      pool_allocation = *allocation;
+      base_ptr = allocation->ptr;
+      for (cl_uint index = 0; index < num_devices; ++index) {
+        if (!deviceSupportsHostAllocations(context->devices[index])) {
+          continue;
+        }
+        mux_buffers[index] = pool->getMuxBuffer(pool_allocation, index);
+        if (nullptr == mux_buffers[index]) {
+          return CL_OUT_OF_RESOURCES;
+        }
+      }
+      return CL_SUCCESS;
+    }
+  }
+
+  base_ptr = cargo::alloc(size, alignment);
+  if (base_ptr == nullptr) {
+    return CL_OUT_OF_HOST_MEMORY;
+  }
+
   for (cl_uint index = 0; index < num_devices; ++index) {
     cl_device_id device = context->devices[index];
 
@@ -333,11 +359,20 @@ device_allocation_info::device_allocation_info(const cl_context context,
     : allocation_info(context, size),
       device(device),
       mux_memory(nullptr),
-      mux_buffer(nullptr) {
+      mux_buffer(nullptr),
+      pool(nullptr) {
   cl::retainInternal(device);
 }
 
 device_allocation_info::~device_allocation_info() {
+  if (pool) {
+    // The Mux objects are owned by the pool, hand the slot back once any
+    // commands still using it have completed.
+    pool->release(pool_allocation,
+                  {queued_commands.data(), queued_commands.size()});
+    mux_buffer = nullptr;
+  }
+
   if (mux_buffer) {
     muxDestroyBuffer(device->mux_device, mux_buffer, device->mux_allocator);
   }
@@ -385,6 +420,19 @@ device_allocation_info::create(cl_context context, cl_device_id device,
 }
 
 cl_int device_allocation_info::allocate(cl_uint alignment) {
+  // Small allocations are sub-allocated from slabs of device memory
+  if (auto usm_pool = getPool(context, device)) {
+    if (auto allocation = usm_pool->allocate(size, alignment)) {
+      pool = usm_pool;
+      pool_allocation = *allocation;
+      base_ptr = allocation->ptr;
+      mux_buffer =
+          pool->getMuxBuffer(pool_allocation, context->getDeviceIndex(device));
+      OCL_CHECK(nullptr == mux_buffer, return CL_OUT_OF_RESOURCES);
+      return CL_SUCCESS;
+    }
+  }
+
   // Allocation device local memory
   const uint32_t heap = 1;
   mux_result_t mux_error = muxAllocateMemory(
@@ -429,13 +477,23 @@ shared_allocation_info::shared_allocation_info(const cl_context context,
     : allocation_info(context, size),
       device(device),
       mux_memory(nullptr),
-      mux_buffer(nullptr) {
+      mux_buffer(nullptr),
+      pool(nullptr) {
   if (device) {
     cl::retainInternal(device);
   }
 }
 
 shared_allocation_info::~shared_allocation_info() {
+  if (pool) {
+    // The memory and Mux objects are owned by the pool, hand the slot back
+    // once any commands still using it have completed.
+    pool->release(pool_allocation,
+                  {queued_commands.data(), queued_commands.size()});
+    base_ptr = nullptr;
+    mux_buffer = nullptr;
+  }
+
   if (mux_buffer) {
     assert(device);
     muxDestroyBuffer(device->mux_device, mux_buffer, device->mux_allocator);
@@ -529,15 +587,33 @@ shared_allocation_info::create(cl_context context, cl_device_id device,
 }
 
 cl_int shared_allocation_info::allocate(cl_uint alignment) {
+  if (device && !deviceSupportsSharedAllocations(device)) {
+    return CL_INVALID_OPERATION;
+  }
+
+  // Shared allocations are implemented as host allocations, so small ones are
+  // sub-allocated from the host pool which is bound to every device
+  // supporting host, and therefore shared, allocations.
+  if (auto usm_pool = getPool(context, nullptr)) {
+    if (auto allocation = usm_pool->allocate(size, alignment)) {
+      pool = usm_pool;
+      pool_allocation = *allocation;
+      base_ptr = allocation->ptr;
+      if (device) {
+        mux_buffer = pool->getMuxBuffer(pool_allocation,
+                                        context->getDeviceIndex(device));
+        OCL_CHECK(nullptr == mux_buffer, return CL_OUT_OF_RESOURCES);
+      }
+      return CL_SUCCESS;
+    }
+  }
+
   base_ptr = cargo::alloc(size, alignment);
   if (base_ptr == nullptr) {
     return CL_OUT_OF_HOST_MEMORY;
   }
 
   if (device) {
-    if (!deviceSupportsSharedAllocations(device)) {
-      return CL_INVALID_OPERATION;
-    }
 
     // Initialize the Mux objects needed by each device
     if (muxCreateBuffer(device->mux_device, size, device->mux_allocator,
@@ -634,6 +710,33 @@ cl_int intel_unified_shared_memory::GetDeviceInfo(
 #endif  // OCL_EXTENSION_cl_intel_unified_shared_memory
 }
 
+cl_int intel_unified_shared_memory::GetContextInfo(
+    cl_context context, cl_context_info param_name, size_t param_value_size,
+    void *param_value, size_t *param_value_size_ret) const {
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  if (CL_CONTEXT_USM_POOL_STATS_CODEPLAY == param_name) {
+    const size_t type_size = sizeof(cl_usm_pool_stats_codeplay);
+    if (nullptr != param_value) {
+      OCL_CHECK(param_value_size < type_size, return CL_INVALID_VALUE);
+      cl_usm_pool_stats_codeplay stats = {};
+      {
+        const std::lock_guard<std::mutex> lock(context->usm_pool_mutex);
+        for (auto &pool : context->usm_pools) {
+          if (pool.second) {
+            pool.second->accumulateStats(stats);
+          }
+        }
+      }
+      *static_cast<cl_usm_pool_stats_codeplay *>(param_value) = stats;
+    }
+    OCL_SET_IF_NOT_NULL(param_value_size_ret, type_size);
+    return CL_SUCCESS;
+  }
+#endif  // OCL_EXTENSION_cl_intel_unified_shared_memory
+  return extension::GetContextInfo(context, param_name, param_value_size,
+                                   param_value, param_value_size_ret);
+}
+
 #if (defined(CL_VERSION_3_0) || \
      defined(OCL_EXTENSION_cl_codeplay_kernel_exec_info))
 cl_int intel_unified_shared_memory::SetKernelExecInfo(
@@ -641,6 +744,24 @@ cl_int intel_unified_shared_memory::SetKernelExecInfo(
     size_t param_value_size, const void *param_value) const {
 #ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
   switch (param_name) {
+#ifdef CL_VERSION_3_0
+    case CL_KERNEL_EXEC_INFO_SVM_FINE_GRAIN_SYSTEM: {
+      OCL_CHECK(!kernel->program->context->supportsSVM(),
+                return CL_INVALID_OPERATION);
+      OCL_CHECK(!param_value, return CL_INVALID_VALUE);
+      OCL_CHECK(param_value_size != sizeof(cl_bool), return CL_INVALID_VALUE);
+      // SVM is only supported for buffers allocated with clSVMAlloc.
+      const cl_bool fine_grain_system =
+          *(static_cast<const cl_bool *>(param_value));
+      return fine_grain_system ? CL_INVALID_OPERATION : CL_SUCCESS;
+    }
+    // SVM allocations are host USM allocations, so SVM pointers used
+    // indirectly are tracked the same way as USM pointers.
+    case CL_KERNEL_EXEC_INFO_SVM_PTRS:
+      OCL_CHECK(!kernel->program->context->supportsSVM(),
+                return CL_INVALID_OPERATION);
+      [[fallthrough]];
+#endif
     case CL_KERNEL_EXEC_INFO_USM_PTRS_INTEL: {
       OCL_CHECK(!param_value, return CL_INVALID_VALUE);
       OCL_CHECK(
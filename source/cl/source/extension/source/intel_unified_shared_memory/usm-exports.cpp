@@ -28,7 +28,9 @@
 #include <tracer/tracer.h>
 
 #include <cstring>
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
 namespace {
 
@@ -493,12 +495,13 @@ cl_int clSetKernelArgMemPointerINTEL(cl_kernel kernel, cl_uint arg_index,
 static cl_int MemFillImpl(cl_command_queue command_queue, void *dst_ptr,
                           const void *pattern, size_t pattern_size, size_t size,
                           cl_uint num_events_in_wait_list,
-                          const cl_event *event_wait_list, cl_event *event) {
+                          const cl_event *event_wait_list, cl_event *event,
+                          cl_command_type command_type) {
   const cl_int error = cl::validate::EventWaitList(
       num_events_in_wait_list, event_wait_list, command_queue->context, event);
   OCL_CHECK(error != CL_SUCCESS, return error);
 
-  auto new_event = _cl_event::create(command_queue, CL_COMMAND_MEMFILL_INTEL);
+  auto new_event = _cl_event::create(command_queue, command_type);
   if (!new_event) {
     return new_event.error();
   }
@@ -613,13 +616,13 @@ static cl_int MemFillImpl(cl_command_queue command_queue, void *dst_ptr,
   return CL_SUCCESS;
 }
 
-CL_API_ENTRY
-cl_int clEnqueueMemFillINTEL(cl_command_queue command_queue, void *dst_ptr,
-                             const void *pattern, size_t pattern_size,
-                             size_t size, cl_uint num_events_in_wait_list,
-                             const cl_event *event_wait_list, cl_event *event) {
-  const tracer::TraceGuard<tracer::OpenCL> trace(__func__);
-
+cl_int extension::usm::enqueueMemFill(cl_command_queue command_queue,
+                                      void *dst_ptr, const void *pattern,
+                                      size_t pattern_size, size_t size,
+                                      cl_uint num_events_in_wait_list,
+                                      const cl_event *event_wait_list,
+                                      cl_event *event,
+                                      cl_command_type command_type) {
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!dst_ptr, return CL_INVALID_VALUE);
   OCL_CHECK(!pattern, return CL_INVALID_VALUE);
@@ -635,7 +638,21 @@ cl_int clEnqueueMemFillINTEL(cl_command_queue command_queue, void *dst_ptr,
   OCL_CHECK(pattern_size > largest_data_type_size, return CL_INVALID_VALUE);
 
   return MemFillImpl(command_queue, dst_ptr, pattern, pattern_size, size,
-                     num_events_in_wait_list, event_wait_list, event);
+                     num_events_in_wait_list, event_wait_list, event,
+                     command_type);
+}
+
+CL_API_ENTRY
+cl_int clEnqueueMemFillINTEL(cl_command_queue command_queue, void *dst_ptr,
+                             const void *pattern, size_t pattern_size,
+                             size_t size, cl_uint num_events_in_wait_list,
+                             const cl_event *event_wait_list, cl_event *event) {
+  const tracer::TraceGuard<tracer::OpenCL> trace(__func__);
+
+  return extension::usm::enqueueMemFill(
+      command_queue, dst_ptr, pattern, pattern_size, size,
+      num_events_in_wait_list, event_wait_list, event,
+      CL_COMMAND_MEMFILL_INTEL);
 }
 
 // Deprecated entry-point not defined in the spec, but included in the
@@ -652,16 +669,18 @@ cl_int clEnqueueMemsetINTEL(cl_command_queue command_queue, void *dst_ptr,
   OCL_CHECK(size && (size % sizeof(cl_int)), return CL_INVALID_VALUE);
 
   return MemFillImpl(command_queue, dst_ptr, &value, sizeof(value), size,
-                     num_events_in_wait_list, event_wait_list, event);
+                     num_events_in_wait_list, event_wait_list, event,
+                     CL_COMMAND_MEMFILL_INTEL);
 }
 
 CL_API_ENTRY
-cl_int clEnqueueMemcpyINTEL(cl_command_queue command_queue, cl_bool blocking,
-                            void *dst_ptr, const void *src_ptr, size_t size,
-                            cl_uint num_events_in_wait_list,
-                            const cl_event *event_wait_list, cl_event *event) {
-  const tracer::TraceGuard<tracer::OpenCL> trace(__func__);
-
+cl_int extension::usm::enqueueMemcpy(cl_command_queue command_queue,
+                                     cl_bool blocking, void *dst_ptr,
+                                     const void *src_ptr, size_t size,
+                                     cl_uint num_events_in_wait_list,
+                                     const cl_event *event_wait_list,
+                                     cl_event *event,
+                                     cl_command_type command_type) {
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!dst_ptr || !src_ptr, return CL_INVALID_VALUE);
 
@@ -678,15 +697,18 @@ cl_int clEnqueueMemcpyINTEL(cl_command_queue command_queue, cl_bool blocking,
                                   command_queue->context, event, blocking);
   OCL_CHECK(error != CL_SUCCESS, return error);
 
-  auto new_event = _cl_event::create(command_queue, CL_COMMAND_MEMCPY_INTEL);
+  auto new_event = _cl_event::create(command_queue, command_type);
   if (!new_event) {
     return new_event.error();
   }
   cl_event return_event = *new_event;
-  const std::scoped_lock context_guard(command_queue->context->usm_mutex);
   cl::release_guard<cl_event> event_release_guard(return_event,
                                                   cl::ref_count_type::EXTERNAL);
   {
+    // The context is only locked while the command is pushed, not while a
+    // blocking copy waits, as completion callbacks may free allocations.
+    const std::scoped_lock context_guard(command_queue->context->usm_mutex);
+
     // Find destination USM allocation
     extension::usm::allocation_info *usm_dst_alloc =
         extension::usm::findAllocation(command_queue->context, dst_ptr);
@@ -818,6 +840,18 @@ cl_int clEnqueueMemcpyINTEL(cl_command_queue command_queue, cl_bool blocking,
   return CL_SUCCESS;
 }
 
+CL_API_ENTRY
+cl_int clEnqueueMemcpyINTEL(cl_command_queue command_queue, cl_bool blocking,
+                            void *dst_ptr, const void *src_ptr, size_t size,
+                            cl_uint num_events_in_wait_list,
+                            const cl_event *event_wait_list, cl_event *event) {
+  const tracer::TraceGuard<tracer::OpenCL> trace(__func__);
+
+  return extension::usm::enqueueMemcpy(
+      command_queue, blocking, dst_ptr, src_ptr, size, num_events_in_wait_list,
+      event_wait_list, event, CL_COMMAND_MEMCPY_INTEL);
+}
+
 CL_API_ENTRY
 cl_int clEnqueueMigrateMemINTEL(cl_command_queue command_queue, const void *ptr,
                                 size_t size, cl_mem_migration_flags flags,
@@ -924,6 +958,158 @@ cl_int clEnqueueMemAdviseINTEL(cl_command_queue command_queue, const void *ptr,
 
   return CL_SUCCESS;
 }
+cl_int extension::usm::enqueueMarker(
+    cl_command_queue command_queue, cl_bool blocking,
+    cargo::array_view<const void *const> pointers,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event, cl_command_type command_type) {
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+
+  const cl_int error =
+      cl::validate::EventWaitList(num_events_in_wait_list, event_wait_list,
+                                  command_queue->context, event, blocking);
+  OCL_CHECK(error != CL_SUCCESS, return error);
+
+  auto new_event = _cl_event::create(command_queue, command_type);
+  if (!new_event) {
+    return new_event.error();
+  }
+  cl_event return_event = *new_event;
+
+  cl::release_guard<cl_event> event_release_guard(return_event,
+                                                  cl::ref_count_type::EXTERNAL);
+  {
+    const cl_context context = command_queue->context;
+    const std::scoped_lock context_guard(context->usm_mutex);
+    const std::scoped_lock lock(context->getCommandQueueMutex());
+
+    auto mux_command_buffer = command_queue->getCommandBuffer(
+        {event_wait_list, num_events_in_wait_list}, return_event);
+    OCL_CHECK(!mux_command_buffer, return CL_OUT_OF_RESOURCES);
+
+    for (const void *ptr : pointers) {
+      if (auto usm_alloc = extension::usm::findAllocation(context, ptr)) {
+        auto mux_error = usm_alloc->record_event(return_event);
+        OCL_CHECK(mux_error, return CL_OUT_OF_RESOURCES);
+      }
+    }
+  }
+
+  if (blocking) {
+    const cl_int ret = cl::WaitForEvents(1, &event_release_guard.get());
+    if (CL_SUCCESS != ret) {
+      return ret;
+    }
+  }
+
+  if (nullptr != event) {
+    *event = event_release_guard.dismiss();
+  }
+
+  return CL_SUCCESS;
+}
+
+cl_int extension::usm::enqueueFree(
+    cl_command_queue command_queue, cl_uint num_pointers, void *pointers[],
+    void(CL_CALLBACK *pfn_free_func)(cl_command_queue queue,
+                                     cl_uint num_pointers, void *pointers[],
+                                     void *user_data),
+    void *user_data, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event) {
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+  OCL_CHECK((0 == num_pointers) != (nullptr == pointers),
+            return CL_INVALID_VALUE);
+
+  const cl_int error = cl::validate::EventWaitList(
+      num_events_in_wait_list, event_wait_list, command_queue->context, event);
+  OCL_CHECK(error != CL_SUCCESS, return error);
+
+  auto new_event = _cl_event::create(command_queue, CL_COMMAND_SVM_FREE);
+  if (!new_event) {
+    return new_event.error();
+  }
+  cl_event return_event = *new_event;
+
+  cl::release_guard<cl_event> event_release_guard(return_event,
+                                                  cl::ref_count_type::EXTERNAL);
+  {
+    const cl_context context = command_queue->context;
+    const std::scoped_lock context_guard(context->usm_mutex);
+    const std::scoped_lock lock(context->getCommandQueueMutex());
+
+    auto mux_command_buffer = command_queue->getCommandBuffer(
+        {event_wait_list, num_events_in_wait_list}, return_event);
+    OCL_CHECK(!mux_command_buffer, return CL_OUT_OF_RESOURCES);
+
+    if (pfn_free_func) {
+      // The callback is called from the device's queue rather than on
+      // completion of the dispatch, as completion callbacks may run while
+      // the context is locked and the callback will usually free the
+      // allocations with clSVMFree.
+      struct free_info_t final {
+        cl_command_queue queue;
+        decltype(pfn_free_func) pfn_free_func;
+        void *user_data;
+        std::vector<void *> pointers;
+      };
+      auto free_info = std::make_unique<free_info_t>(
+          free_info_t{command_queue, pfn_free_func, user_data,
+                      std::vector<void *>(pointers, pointers + num_pointers)});
+      auto mux_error = muxCommandUserCallback(
+          *mux_command_buffer,
+          [](mux_queue_t, mux_command_buffer_t, void *user_data) {
+            auto *free_info = static_cast<free_info_t *>(user_data);
+            free_info->pfn_free_func(
+                free_info->queue,
+                static_cast<cl_uint>(free_info->pointers.size()),
+                free_info->pointers.data(), free_info->user_data);
+          },
+          free_info.get(), 0, nullptr, nullptr);
+      if (mux_error) {
+        auto error = cl::getErrorFrom(mux_error);
+        return_event->complete(error);
+        return error;
+      }
+      // Only hand ownership to the callback once it has been registered,
+      // otherwise the unique_ptr still frees the info on the error path.
+      auto *const raw_free_info = free_info.get();
+      if (auto error = command_queue->registerDispatchCallback(
+              *mux_command_buffer, return_event,
+              [raw_free_info]() { delete raw_free_info; })) {
+        return error;
+      }
+      (void)free_info.release();
+    } else {
+      // Detach the allocations from the context now so no later command can
+      // use them, then destroy them once the commands before this one have
+      // completed.
+      auto detached = std::make_shared<
+          std::vector<std::unique_ptr<extension::usm::allocation_info>>>();
+      for (cl_uint index = 0; index < num_pointers; index++) {
+        const void *const ptr = pointers[index];
+        auto usm_alloc_iterator = std::find_if(
+            context->usm_allocations.begin(), context->usm_allocations.end(),
+            [ptr](const std::unique_ptr<extension::usm::allocation_info>
+                      &usm_alloc) { return usm_alloc->base_ptr == ptr; });
+        if (context->usm_allocations.end() != usm_alloc_iterator) {
+          detached->push_back(std::move(*usm_alloc_iterator));
+          context->usm_allocations.erase(usm_alloc_iterator);
+        }
+      }
+      if (auto error = command_queue->registerDispatchCallback(
+              *mux_command_buffer, return_event,
+              [detached]() { detached->clear(); })) {
+        return error;
+      }
+    }
+  }
+
+  if (nullptr != event) {
+    *event = event_release_guard.dismiss();
+  }
+
+  return CL_SUCCESS;
+}
 #endif  // OCL_EXTENSION_cl_intel_unified_shared_memory
 
 void *
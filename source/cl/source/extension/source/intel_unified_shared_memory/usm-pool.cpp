@@ -0,0 +1,422 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <CL/cl_ext.h>
+#include <extension/intel_unified_shared_memory.h>
+
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+#include <cargo/allocator.h>
+#include <cl/context.h>
+#include <cl/device.h>
+#include <cl/event.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace extension {
+namespace usm {
+namespace {
+// Read a size in bytes from an environment variable, returning `fallback` if
+// the variable is not set or can't be parsed.
+size_t getEnvSize(const char *name, size_t fallback) {
+  const char *env = std::getenv(name);
+  if (nullptr == env || '\0' == *env) {
+    return fallback;
+  }
+  char *end = nullptr;
+  const unsigned long long value = std::strtoull(env, &end, 0);
+  if (end == env) {
+    return fallback;
+  }
+  return static_cast<size_t>(value);
+}
+
+// Round up to the next power of two, zero is rounded to one.
+size_t nextPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+// Return true if every command in `events` has finished executing.
+template <class Events>
+bool allComplete(const Events &events) {
+  return std::all_of(events.begin(), events.end(), [](cl_event event) {
+    // Negative values are error codes, which also terminate the command.
+    return event->command_status <= CL_COMPLETE;
+  });
+}
+}  // namespace
+
+const pool_config_t &getPoolConfig() {
+  static const pool_config_t config = {
+      getEnvSize("CA_USM_POOL_MAX_ALLOC_SIZE", 256 * 1024),
+      getEnvSize("CA_USM_POOL_SLAB_SIZE", 2 * 1024 * 1024),
+      getEnvSize("CA_USM_POOL_RETAIN_SIZE", 16 * 1024 * 1024),
+  };
+  return config;
+}
+
+/// @brief Contiguous block of memory divided into slots of one size class.
+struct memory_pool::slab_t final {
+  /// @brief Address of the first byte of the slab.
+  void *base_ptr = nullptr;
+  /// @brief Size in bytes of the slab.
+  size_t size = 0;
+  /// @brief Size in bytes of each slot.
+  size_t class_size = 0;
+  /// @brief Number of slots in the slab.
+  uint32_t num_slots = 0;
+  /// @brief Mux memory of the slab, indexed by context device index. Entries
+  /// for devices without access to the slab are `nullptr`.
+  cargo::dynamic_array<mux_memory_t> mux_memories;
+  /// @brief Lazily created Mux buffers bound to each slot, indexed by
+  /// `slot * num_devices + device_index`.
+  cargo::dynamic_array<mux_buffer_t> mux_buffers;
+  /// @brief Indices of unused slots.
+  std::vector<uint32_t> free_slots;
+};
+
+memory_pool::memory_pool(cl_context context, cl_device_id device)
+    : context(context), device(device), min_class_size(0) {}
+
+memory_pool::~memory_pool() {
+  for (auto &entry : pending) {
+    for (auto event : entry.events) {
+      cl::releaseInternal(event);
+    }
+  }
+  for (auto &slabs : classes) {
+    for (auto &slab : slabs) {
+      freeSlab(slab.get());
+    }
+  }
+}
+
+std::unique_ptr<memory_pool> memory_pool::create(cl_context context,
+                                                 cl_device_id device) {
+  std::unique_ptr<memory_pool> pool(new (std::nothrow)
+                                        memory_pool(context, device));
+  if (!pool) {
+    return nullptr;
+  }
+
+  // Every slab is aligned to the strictest alignment of the devices with
+  // access to it, since size classes are powers of two no smaller than this
+  // every slot then meets the alignment requirements of those devices too.
+  size_t alignment = 64;
+  if (device) {
+    alignment = std::max<size_t>(alignment,
+                                 device->mux_device->info->buffer_alignment);
+  } else {
+    for (auto context_device : context->devices) {
+      if (deviceSupportsHostAllocations(context_device)) {
+        alignment = std::max<size_t>(
+            {alignment, context_device->mux_device->info->buffer_alignment,
+             context_device->min_data_type_align_size});
+      }
+    }
+  }
+  pool->min_class_size = static_cast<uint32_t>(nextPowerOfTwo(alignment));
+
+  const size_t max_alloc_size = getPoolConfig().max_alloc_size;
+  size_t num_classes = 0;
+  for (size_t class_size = pool->min_class_size; class_size <= max_alloc_size;
+       class_size <<= 1) {
+    num_classes++;
+  }
+  if (0 == num_classes) {
+    return nullptr;
+  }
+  pool->classes.resize(num_classes);
+  return pool;
+}
+
+cargo::optional<memory_pool::allocation_t> memory_pool::allocate(
+    size_t size, uint32_t alignment) {
+  if (size > getPoolConfig().max_alloc_size || alignment > min_class_size) {
+    return cargo::nullopt;
+  }
+
+  size_t class_index = 0;
+  while ((size_t(min_class_size) << class_index) < size) {
+    class_index++;
+  }
+  if (class_index >= classes.size()) {
+    return cargo::nullopt;
+  }
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  reclaimPending();
+
+  auto &slabs = classes[class_index];
+  // Search the most recently created slabs first, older slabs are then more
+  // likely to become empty and be trimmed.
+  auto found = std::find_if(slabs.rbegin(), slabs.rend(),
+                            [](const std::unique_ptr<slab_t> &slab) {
+                              return !slab->free_slots.empty();
+                            });
+  slab_t *slab = nullptr;
+  if (found != slabs.rend()) {
+    slab = found->get();
+    hits++;
+  } else {
+    slab = allocateSlab(class_index);
+    if (!slab) {
+      // Give cached slabs of other size classes back to the device and try
+      // once more before falling back to a dedicated allocation.
+      trimLocked(0);
+      slab = allocateSlab(class_index);
+      if (!slab) {
+        return cargo::nullopt;
+      }
+    }
+    misses++;
+  }
+
+  allocation_t allocation;
+  allocation.slab = slab;
+  allocation.slot = slab->free_slots.back();
+  allocation.ptr = static_cast<uint8_t *>(slab->base_ptr) +
+                   (size_t(allocation.slot) * slab->class_size);
+  slab->free_slots.pop_back();
+  return allocation;
+}
+
+mux_buffer_t memory_pool::getMuxBuffer(const allocation_t &allocation,
+                                       cl_uint device_index) {
+  slab_t *slab = allocation.slab;
+  mux_memory_t mux_memory = slab->mux_memories[device_index];
+  if (nullptr == mux_memory) {
+    return nullptr;
+  }
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  const size_t num_devices = context->devices.size();
+  mux_buffer_t &mux_buffer =
+      slab->mux_buffers[(size_t(allocation.slot) * num_devices) + device_index];
+  if (nullptr == mux_buffer) {
+    auto buffer_device = context->devices[device_index];
+    if (muxCreateBuffer(buffer_device->mux_device, slab->class_size,
+                        buffer_device->mux_allocator, &mux_buffer)) {
+      mux_buffer = nullptr;
+      return nullptr;
+    }
+    const uint64_t offset = uint64_t(allocation.slot) * slab->class_size;
+    if (muxBindBufferMemory(buffer_device->mux_device, mux_memory, mux_buffer,
+                            offset)) {
+      muxDestroyBuffer(buffer_device->mux_device, mux_buffer,
+                       buffer_device->mux_allocator);
+      mux_buffer = nullptr;
+    }
+  }
+  return mux_buffer;
+}
+
+void memory_pool::release(const allocation_t &allocation,
+                          cargo::array_view<const cl_event> events) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (allComplete(events)) {
+    recycle(allocation);
+  } else {
+    // Commands using the allocation are still in flight, defer recycling the
+    // slot so a new allocation can't alias memory they may still access.
+    pending_t entry;
+    entry.allocation = allocation;
+    for (auto event : events) {
+      if (entry.events.push_back(event)) {
+        // Can't track the commands, leak the slot rather than risk reusing
+        // memory which is in use.
+        for (auto retained : entry.events) {
+          cl::releaseInternal(retained);
+        }
+        return;
+      }
+      cl::retainInternal(event);
+    }
+    pending.push_back(std::move(entry));
+  }
+  trimLocked(getPoolConfig().retain_size);
+}
+
+void memory_pool::trim(size_t retain_size) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  reclaimPending();
+  trimLocked(retain_size);
+}
+
+void memory_pool::accumulateStats(cl_usm_pool_stats_codeplay &stats) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  reclaimPending();
+  for (auto &slabs : classes) {
+    for (auto &slab : slabs) {
+      stats.reserved_bytes += slab->size;
+      stats.used_bytes +=
+          (slab->num_slots - slab->free_slots.size()) * slab->class_size;
+      stats.slab_count++;
+    }
+  }
+  for (auto &entry : pending) {
+    stats.used_bytes -= entry.allocation.slab->class_size;
+    stats.pending_bytes += entry.allocation.slab->class_size;
+  }
+  stats.hit_count += hits;
+  stats.miss_count += misses;
+}
+
+memory_pool::slab_t *memory_pool::allocateSlab(size_t class_index) {
+  std::unique_ptr<slab_t> slab(new (std::nothrow) slab_t);
+  if (!slab) {
+    return nullptr;
+  }
+  slab->class_size = size_t(min_class_size) << class_index;
+  slab->num_slots = static_cast<uint32_t>(
+      std::max<size_t>(getPoolConfig().slab_size / slab->class_size, 1));
+  slab->size = slab->num_slots * slab->class_size;
+
+  const size_t num_devices = context->devices.size();
+  if (cargo::success != slab->mux_memories.alloc(num_devices) ||
+      cargo::success !=
+          slab->mux_buffers.alloc(slab->num_slots * num_devices)) {
+    return nullptr;
+  }
+
+  if (device) {
+    const cl_uint device_index = context->getDeviceIndex(device);
+    if (muxAllocateMemory(device->mux_device, slab->size, 1,
+                          mux_memory_property_device_local,
+                          mux_allocation_type_alloc_device, min_class_size,
+                          device->mux_allocator,
+                          &slab->mux_memories[device_index])) {
+      slab->mux_memories[device_index] = nullptr;
+      return nullptr;
+    }
+    slab->base_ptr = reinterpret_cast<void *>(
+        static_cast<uintptr_t>(slab->mux_memories[device_index]->handle));
+  } else {
+    slab->base_ptr = cargo::alloc(slab->size, min_class_size);
+    if (nullptr == slab->base_ptr) {
+      return nullptr;
+    }
+    for (cl_uint index = 0; index < num_devices; index++) {
+      auto context_device = context->devices[index];
+      if (!deviceSupportsHostAllocations(context_device)) {
+        continue;
+      }
+      if (muxCreateMemoryFromHost(context_device->mux_device, slab->size,
+                                  slab->base_ptr, context_device->mux_allocator,
+                                  &slab->mux_memories[index])) {
+        slab->mux_memories[index] = nullptr;
+        freeSlab(slab.get());
+        return nullptr;
+      }
+    }
+  }
+
+  slab->free_slots.resize(slab->num_slots);
+  // Hand out low addresses first, so partially used slabs stay compact.
+  for (uint32_t slot = 0; slot < slab->num_slots; slot++) {
+    slab->free_slots[slot] = slab->num_slots - slot - 1;
+  }
+
+  classes[class_index].push_back(std::move(slab));
+  return classes[class_index].back().get();
+}
+
+void memory_pool::freeSlab(slab_t *slab) {
+  const size_t num_devices = context->devices.size();
+  for (size_t index = 0; index < slab->mux_buffers.size(); index++) {
+    if (auto mux_buffer = slab->mux_buffers[index]) {
+      auto buffer_device = context->devices[index % num_devices];
+      muxDestroyBuffer(buffer_device->mux_device, mux_buffer,
+                       buffer_device->mux_allocator);
+    }
+  }
+  for (size_t index = 0; index < slab->mux_memories.size(); index++) {
+    if (auto mux_memory = slab->mux_memories[index]) {
+      auto memory_device = context->devices[index];
+      muxFreeMemory(memory_device->mux_device, mux_memory,
+                    memory_device->mux_allocator);
+    }
+  }
+  // Device slab memory is owned by its Mux memory object, host slab memory
+  // was allocated by the pool.
+  if (!device && slab->base_ptr) {
+    cargo::free(slab->base_ptr);
+  }
+  slab->base_ptr = nullptr;
+}
+
+void memory_pool::recycle(const allocation_t &allocation) {
+  allocation.slab->free_slots.push_back(allocation.slot);
+}
+
+void memory_pool::reclaimPending() {
+  auto last = std::partition(
+      pending.begin(), pending.end(),
+      [](const pending_t &entry) { return !allComplete(entry.events); });
+  for (auto it = last; it != pending.end(); ++it) {
+    for (auto event : it->events) {
+      cl::releaseInternal(event);
+    }
+    recycle(it->allocation);
+  }
+  pending.erase(last, pending.end());
+}
+
+void memory_pool::trimLocked(size_t retain_size) {
+  size_t unused_size = 0;
+  for (auto &slabs : classes) {
+    for (auto &slab : slabs) {
+      if (slab->free_slots.size() == slab->num_slots) {
+        unused_size += slab->size;
+      }
+    }
+  }
+
+  // Release the largest unused slabs first, they are the most expensive to
+  // keep cached and the cheapest to allocate again relative to their size.
+  for (auto slabs = classes.rbegin();
+       slabs != classes.rend() && unused_size > retain_size; ++slabs) {
+    for (auto slab = slabs->begin();
+         slab != slabs->end() && unused_size > retain_size;) {
+      if ((*slab)->free_slots.size() == (*slab)->num_slots) {
+        unused_size -= (*slab)->size;
+        freeSlab(slab->get());
+        slab = slabs->erase(slab);
+      } else {
+        ++slab;
+      }
+    }
+  }
+}
+
+memory_pool *getPool(cl_context context, cl_device_id device) {
+  if (0 == getPoolConfig().max_alloc_size) {
+    return nullptr;
+  }
+  const std::lock_guard<std::mutex> lock(context->usm_pool_mutex);
+  auto &pool = context->usm_pools[device];
+  if (!pool) {
+    pool = memory_pool::create(context, device);
+  }
+  return pool.get();
+}
+}  // namespace usm
+}  // namespace extension
+#endif  // OCL_EXTENSION_cl_intel_unified_shared_memory
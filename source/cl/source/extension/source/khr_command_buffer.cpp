@@ -30,6 +30,7 @@
 #include <tracer/tracer.h>
 
 #include <algorithm>
+#include <cstdlib>
 
 extension::khr_command_buffer::khr_command_buffer()
     : extension(
@@ -187,6 +188,10 @@ _cl_command_buffer_khr::~_cl_command_buffer_khr() {
     cl::releaseInternal(kernel);
   }
 
+  // Fused kernels are no longer needed now their specialized kernels have been
+  // destroyed.
+  fused_kernels.clear();
+
   // Destroy and release the underlying command buffer.
   muxDestroyCommandBuffer(mux_command_buffer->device, mux_command_buffer,
                           command_queue->device->mux_allocator);
@@ -281,6 +286,10 @@ cl_int _cl_command_buffer_khr::finalize() {
     return CL_INVALID_OPERATION;
   }
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   if (muxFinalizeCommandBuffer(mux_command_buffer)) {
     return CL_INVALID_COMMAND_BUFFER_KHR;
   }
@@ -325,6 +334,15 @@ _cl_command_buffer_khr::convertWaitList(
     if (mux_sync_point.error()) {
       return cargo::make_unexpected(CL_INVALID_SYNC_POINT_WAIT_LIST_KHR);
     }
+    // A sync-point is null while its ND-range is held back to be fused. The
+    // only commands recorded before it's patched are the ND-ranges fused with
+    // it, which become a single mux command, so the wait is dropped. This
+    // relies on commands executing in order within a mux command-buffer, as
+    // the fused command is recorded after every command it would have waited
+    // on.
+    if (nullptr == *mux_sync_point) {
+      continue;
+    }
     if (command_wait_list.push_back(*mux_sync_point)) {
       return cargo::make_unexpected(CL_OUT_OF_HOST_MEMORY);
     }
@@ -332,11 +350,288 @@ _cl_command_buffer_khr::convertWaitList(
   return command_wait_list;
 }
 
+namespace {
+/// @brief Returns whether consecutive ND-range commands should be fused.
+///
+/// Enabled by setting the `CA_COMMAND_BUFFER_FUSION` environment variable to a
+/// non-zero value.
+bool fusionEnabled() {
+  static const bool enabled = [] {
+    const char *env = std::getenv("CA_COMMAND_BUFFER_FUSION");
+    return nullptr != env && 0 != std::atoi(env);
+  }();
+  return enabled;
+}
+
+/// @brief Returns the buffer a buffer or sub-buffer is allocated from.
+cl_mem rootBuffer(cl_mem mem) {
+  while (mem && mem->optional_parent) {
+    mem = mem->optional_parent;
+  }
+  return mem;
+}
+}  // namespace
+
+bool _cl_command_buffer_khr::isFusionCandidate(
+    cl_kernel kernel, cl_uint work_dim,
+    cl_mutable_command_khr *mutable_handle) const {
+  if (!fusionEnabled() || isMutable() || mutable_handle || 1 != work_dim) {
+    return false;
+  }
+  const cl_device_id device = command_queue->device;
+  if (!kernel->device_kernel_map[device]->supportsDeferredCompilation() ||
+      !kernel->program->programs[device].printf_calls.empty()) {
+    return false;
+  }
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  // Pending ND-ranges are recorded without indirect memory access.
+  if (kernel->kernel_exec_info_usm_flags ||
+      !kernel->indirect_usm_allocs.empty()) {
+    return false;
+  }
+#endif
+  for (size_t i = 0, e = kernel->info->getNumArguments(); i < e; i++) {
+    const _cl_kernel::argument &arg = kernel->saved_args[i];
+    switch (arg.stype) {
+      case _cl_kernel::argument::storage_type::memory_buffer:
+        if (compiler::ArgumentKind::POINTER != arg.type.kind ||
+            (arg.memory_buffer &&
+             CL_MEM_OBJECT_BUFFER != arg.memory_buffer->type)) {
+          return false;
+        }
+        break;
+      case _cl_kernel::argument::storage_type::value:
+        // SVM pointers are set as values, but could point into any buffer.
+        if (compiler::ArgumentKind::POINTER == arg.type.kind) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+cl_int _cl_command_buffer_khr::recordPendingNDRange(
+    cl_kernel kernel, size_t local_size, size_t global_offset,
+    size_t global_size, const mux_ndrange_options_t &options,
+    const cargo::array_view<const cl_sync_point_khr> &cl_wait_list,
+    cl_sync_point_khr *cl_sync_point) {
+  // Report invalid sync-points now rather than when the command is flushed.
+  if (auto command_wait_list = convertWaitList(cl_wait_list);
+      !command_wait_list) {
+    return command_wait_list.error();
+  }
+
+  PendingNDRange pending;
+  pending.kernel = kernel;
+  pending.deferred_kernel =
+      kernel->device_kernel_map[command_queue->device]->getDeferredKernel();
+  pending.local_size = local_size;
+  pending.global_offset = global_offset;
+  pending.global_size = global_size;
+
+  // The kernel's arguments may be set again before the command is flushed, so
+  // copy the by-value arguments the descriptors point to.
+  const size_t num_arguments = options.descriptors_length;
+  size_t values_size = 0;
+  for (size_t i = 0; i < num_arguments; i++) {
+    if (mux_descriptor_info_type_plain_old_data ==
+        options.descriptors[i].type) {
+      values_size += options.descriptors[i].plain_old_data_descriptor.length;
+    }
+  }
+  if (pending.descriptors.alloc(num_arguments) ||
+      pending.buffers.alloc(num_arguments) ||
+      (values_size && pending.values.alloc(values_size)) ||
+      pending.wait_list.assign(cl_wait_list.begin(), cl_wait_list.end())) {
+    return CL_OUT_OF_HOST_MEMORY;
+  }
+  uint8_t *value = pending.values.data();
+  for (size_t i = 0; i < num_arguments; i++) {
+    pending.descriptors[i] = options.descriptors[i];
+    auto &pod = pending.descriptors[i].plain_old_data_descriptor;
+    if (mux_descriptor_info_type_plain_old_data ==
+        pending.descriptors[i].type) {
+      std::copy_n(static_cast<const uint8_t *>(pod.data), pod.length, value);
+      pod.data = value;
+      value += pod.length;
+    }
+    const _cl_kernel::argument &arg = kernel->saved_args[i];
+    pending.buffers[i] =
+        _cl_kernel::argument::storage_type::memory_buffer == arg.stype
+            ? arg.memory_buffer
+            : nullptr;
+  }
+
+  // Flush the pending commands if this one can't join them. Two different
+  // memory objects allocated from the same buffer might overlap, which the
+  // compiler couldn't detect, so they aren't fused either.
+  bool compatible = true;
+  for (const auto &other : pending_ndranges) {
+    compatible &= other.local_size == local_size &&
+                  other.global_offset == global_offset &&
+                  other.global_size == global_size;
+    for (cl_mem mem : pending.buffers) {
+      for (cl_mem other_mem : other.buffers) {
+        if (mem && other_mem && mem != other_mem &&
+            rootBuffer(mem) == rootBuffer(other_mem)) {
+          compatible = false;
+        }
+      }
+    }
+  }
+  if (!compatible) {
+    if (auto error = flushPendingNDRanges()) {
+      return error;
+    }
+  }
+
+  if (cl_sync_point) {
+    // Patched with the mux sync-point when the command is flushed.
+    if (mux_sync_points.push_back(nullptr)) {
+      return CL_OUT_OF_HOST_MEMORY;
+    }
+    *cl_sync_point = mux_sync_points.size() - 1;
+    pending.sync_point = *cl_sync_point;
+  }
+  if (pending_ndranges.push_back(std::move(pending))) {
+    return CL_OUT_OF_HOST_MEMORY;
+  }
+  return CL_SUCCESS;
+}
+
+cl_int _cl_command_buffer_khr::recordNDRange(
+    MuxKernelWrapper &wrapper, const mux_ndrange_options_t &options,
+    cargo::array_view<const cl_sync_point_khr> wait_list,
+    mux_sync_point_t *mux_sync_point) {
+  auto specialized_kernel = wrapper.createSpecializedKernel(options);
+  if (!specialized_kernel.has_value()) {
+    return cl::getErrorFrom(specialized_kernel.error());
+  }
+  mux_kernel_t mux_kernel = specialized_kernel->mux_kernel.get();
+  if (storeKernel(specialized_kernel->mux_executable.release(),
+                  specialized_kernel->mux_kernel.release())) {
+    return CL_OUT_OF_HOST_MEMORY;
+  }
+
+  auto command_wait_list = convertWaitList(wait_list);
+  if (!command_wait_list) {
+    return command_wait_list.error();
+  }
+  const auto wait_list_length = command_wait_list->size();
+  if (auto mux_error = muxCommandNDRange(
+          mux_command_buffer, mux_kernel, options, wait_list_length,
+          wait_list_length ? command_wait_list->data() : nullptr,
+          mux_sync_point)) {
+    return cl::getErrorFrom(mux_error);
+  }
+  return CL_SUCCESS;
+}
+
+cl_int _cl_command_buffer_khr::flushPendingNDRanges() {
+  if (pending_ndranges.empty()) {
+    return CL_SUCCESS;
+  }
+  const cl_device_id device = command_queue->device;
+  auto &first = pending_ndranges.front();
+  const std::array<size_t, cl::max::WORK_ITEM_DIM> global_offset{
+      first.global_offset, 0, 0};
+  const std::array<size_t, cl::max::WORK_ITEM_DIM> global_size{
+      first.global_size, 1, 1};
+  mux_ndrange_options_t options{};
+  options.local_size[0] = first.local_size;
+  options.local_size[1] = 1;
+  options.local_size[2] = 1;
+  options.global_offset = global_offset.data();
+  options.global_size = global_size.data();
+  options.dimensions = 1;
+
+  // Try to fuse the pending commands into a single kernel, identifying the
+  // buffer bound to each argument by the index of its first use plus one.
+  std::shared_ptr<compiler::Kernel> fused_kernel;
+  cargo::small_vector<mux_descriptor_info_s, 16> descriptors;
+  cargo::small_vector<cl_sync_point_khr, 4> wait_list;
+  if (pending_ndranges.size() > 1) {
+    cargo::small_vector<compiler::Kernel *, 4> fused_parts;
+    cargo::small_vector<cl_mem, 16> roots;
+    cargo::small_vector<uint64_t, 16> buffer_ids;
+    for (auto &pending : pending_ndranges) {
+      if (&pending != &first &&
+          fused_parts.push_back(pending.deferred_kernel.get())) {
+        return CL_OUT_OF_HOST_MEMORY;
+      }
+      for (size_t i = 0; i < pending.descriptors.size(); i++) {
+        cl_mem root = rootBuffer(pending.buffers[i]);
+        const uint64_t index =
+            std::find(roots.begin(), roots.end(), root) - roots.begin();
+        if (roots.push_back(root) ||
+            descriptors.push_back(pending.descriptors[i]) ||
+            buffer_ids.push_back(root ? index + 1 : 0)) {
+          return CL_OUT_OF_HOST_MEMORY;
+        }
+      }
+      for (auto sync_point : pending.wait_list) {
+        if (wait_list.push_back(sync_point)) {
+          return CL_OUT_OF_HOST_MEMORY;
+        }
+      }
+    }
+    auto fused = first.deferred_kernel->createFusedKernel(
+        {fused_parts.data(), fused_parts.size()},
+        {buffer_ids.data(), buffer_ids.size()});
+    if (fused.has_value()) {
+      fused_kernel = std::move(*fused);
+    }
+  }
+
+  mux_sync_point_t mux_sync_point = nullptr;
+  if (fused_kernel) {
+    MuxKernelWrapper wrapper(device, fused_kernel);
+    options.descriptors = descriptors.data();
+    options.descriptors_length = descriptors.size();
+    if (auto error =
+            recordNDRange(wrapper, options, wait_list, &mux_sync_point)) {
+      return error;
+    }
+    if (fused_kernels.push_back(std::move(fused_kernel))) {
+      return CL_OUT_OF_HOST_MEMORY;
+    }
+    for (const auto &pending : pending_ndranges) {
+      if (pending.sync_point) {
+        mux_sync_points[*pending.sync_point] = mux_sync_point;
+      }
+    }
+  } else {
+    // The commands couldn't be fused, so record them as they were enqueued.
+    for (auto &pending : pending_ndranges) {
+      options.descriptors = pending.descriptors.data();
+      options.descriptors_length = pending.descriptors.size();
+      if (auto error =
+              recordNDRange(*pending.kernel->device_kernel_map[device],
+                            options, pending.wait_list,
+                            pending.sync_point ? &mux_sync_point : nullptr)) {
+        return error;
+      }
+      if (pending.sync_point) {
+        mux_sync_points[*pending.sync_point] = mux_sync_point;
+      }
+    }
+  }
+  pending_ndranges.clear();
+  return CL_SUCCESS;
+}
+
 cl_int _cl_command_buffer_khr::commandBarrierWithWaitList(
     cargo::array_view<const cl_sync_point_khr> &cl_wait_list,
     cl_sync_point_khr *cl_sync_point) {
   const std::scoped_lock guard(mutex);
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   auto command_wait_list = convertWaitList(cl_wait_list);
   if (!command_wait_list) {
     return command_wait_list.error();
@@ -377,6 +672,10 @@ cl_int _cl_command_buffer_khr::commandCopyBuffer(
     cl_sync_point_khr *cl_sync_point) {
   const std::scoped_lock guard(mutex);
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   // Add references to the buffers.
   if (auto error = retain(src_buffer)) {
     return error;
@@ -429,6 +728,10 @@ cl_int _cl_command_buffer_khr::commandCopyImage(
     cl_sync_point_khr *cl_sync_point) {
   const std::scoped_lock guard(mutex);
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   // Add references to the images.
   if (auto error = retain(src_image)) {
     return error;
@@ -490,6 +793,10 @@ cl_int _cl_command_buffer_khr::commandCopyBufferRect(
     cl_sync_point_khr *cl_sync_point) {
   const std::scoped_lock guard(mutex);
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   // Add a references to the buffers.
   if (auto error = retain(src_buffer)) {
     return error;
@@ -556,6 +863,10 @@ cl_int _cl_command_buffer_khr::commandFillBuffer(
     cl_sync_point_khr *cl_sync_point) {
   const std::scoped_lock guard(mutex);
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   // Add a reference to the buffer.
   if (auto error = retain(buffer)) {
     return error;
@@ -608,6 +919,10 @@ cl_int _cl_command_buffer_khr::commandFillImage(
     cl_sync_point_khr *cl_sync_point) {
   const std::scoped_lock guard(mutex);
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   // Add a reference to the image.
   if (auto error = retain(image)) {
     return error;
@@ -657,6 +972,10 @@ cl_int _cl_command_buffer_khr::commandCopyBufferToImage(
     cl_sync_point_khr *cl_sync_point) {
   const std::scoped_lock guard(mutex);
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   // Add references to the memory objects.
   if (auto error = retain(src_buffer)) {
     return error;
@@ -714,6 +1033,10 @@ cl_int _cl_command_buffer_khr::commandCopyImageToBuffer(
     cl_sync_point_khr *cl_sync_point) {
   const std::scoped_lock guard(mutex);
 
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   // Add references to the memory objects.
   if (auto error = retain(src_image)) {
     return error;
@@ -825,6 +1148,35 @@ cl_int _cl_command_buffer_khr::commandNDRangeKernel(
   std::unique_ptr<mux_descriptor_info_t[]> descriptor_info_storage;
   cl_device_id device = command_queue->device;
 
+  // Hold back ND-ranges which could be fused with the ND-ranges after them,
+  // they're passed to mux once a command which can't be fused is recorded or
+  // the command-buffer is finalized.
+  if (isFusionCandidate(kernel, work_dim, mutable_handle)) {
+    const cl_uint device_index =
+        kernel->program->context->getDeviceIndex(device);
+    const mux_ndrange_options_t mux_execution_options =
+        kernel->createKernelExecutionOptions(
+            device, device_index, work_dim, final_local_work_size,
+            final_global_offset, final_global_size, nullptr,
+            descriptor_info_storage);
+    if (auto error = recordPendingNDRange(
+            kernel, final_local_work_size[0], final_global_offset[0],
+            final_global_size[0], mux_execution_options, cl_wait_list,
+            cl_sync_point)) {
+      return error;
+    }
+    auto retain = [this](cl_mem mem) { return this->retain(mem); };
+    if (auto error = kernel->retainMems(command_queue, retain)) {
+      return error;
+    }
+    ++next_command_index;
+    return CL_SUCCESS;
+  }
+
+  if (auto error = flushPendingNDRanges()) {
+    return error;
+  }
+
   // create the printf buffer argument if necessary
   mux_buffer_t printf_buffer = nullptr;
   mux_memory_t printf_memory = nullptr;
@@ -855,14 +1207,7 @@ cl_int _cl_command_buffer_khr::commandNDRangeKernel(
     auto result = kernel->device_kernel_map[device]->createSpecializedKernel(
         mux_execution_options);
     if (!result.has_value()) {
-      if (printf_buffer) {
-        muxDestroyBuffer(device->mux_device, printf_buffer,
-                         device->mux_allocator);
-      }
-      if (printf_memory) {
-        muxFreeMemory(device->mux_device, printf_memory, device->mux_allocator);
-      }
-
+      releasePrintfBuffer(device, printf_memory, printf_buffer);
       return cl::getErrorFrom(result.error());
     }
 
@@ -888,13 +1233,7 @@ cl_int _cl_command_buffer_khr::commandNDRangeKernel(
       mux_command_buffer, mux_kernel, mux_execution_options, wait_list_length,
       wait_list_length ? command_wait_list->data() : nullptr, out_sync_point);
   if (mux_success != mux_error) {
-    if (printf_buffer) {
-      muxDestroyBuffer(device->mux_device, printf_buffer,
-                       device->mux_allocator);
-    }
-    if (printf_memory) {
-      muxFreeMemory(device->mux_device, printf_memory, device->mux_allocator);
-    }
+    releasePrintfBuffer(device, printf_memory, printf_buffer);
 
     auto error = cl::getErrorFrom(mux_error);
     return error;
@@ -910,9 +1249,9 @@ cl_int _cl_command_buffer_khr::commandNDRangeKernel(
   // enqueue a user callback that reads the printf buffer and print the data
   // out.
   if (device_program.printf_calls.size() != 0) {
-    std::unique_ptr<printf_info_t> printf_info(new printf_info_t{
-        device, printf_memory, printf_buffer, buffer_group_size,
-        std::vector<uint32_t>(num_groups, 0), device_program.printf_calls});
+    std::unique_ptr<printf_info_t> printf_info(new printf_info_t(
+        device, kernel->program, printf_memory, printf_buffer,
+        buffer_group_size, num_groups, device_program.printf_calls));
 
     mux_error = createPrintfCallback(mux_command_buffer, printf_info);
     OCL_ASSERT(mux_success == mux_error, "muxCommand failed!");
@@ -985,7 +1324,8 @@ static cargo::expected<mux_descriptor_info_s, cl_int> createArgumentDescriptor(
               mux_descriptor_info_type_e::mux_descriptor_info_type_null_buffer;
         } else {
           cl_mem mem = *static_cast<const cl_mem *>(arg_value);
-          OCL_CHECK(CL_MEM_OBJECT_BUFFER != mem->type,
+          OCL_CHECK(CL_MEM_OBJECT_BUFFER != mem->type &&
+                        CL_MEM_OBJECT_PIPE != mem->type,
                     return cargo::make_unexpected(CL_INVALID_ARG_VALUE));
 
           auto *buffer = static_cast<const cl_mem_buffer *>(arg_value);
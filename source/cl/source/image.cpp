@@ -211,6 +211,11 @@ CL_API_ENTRY cl_mem CL_API_CALL cl::CreateImage(
     return nullptr;
   }
 
+  // NOTE: Devices may require more storage than the linear image data in
+  // host_ptr, e.g. to store the image in a tiled layout, but only the linear
+  // data is provided by the user and seen through a mapping.
+  const size_t host_data_size = image->size;
+
   for (cl_uint index = 0; index < context->devices.size(); ++index) {
     auto device = context->devices[index];
     auto mux_image = image->mux_images[index];
@@ -227,7 +232,9 @@ CL_API_ENTRY cl_mem CL_API_CALL cl::CreateImage(
       cl_mem_buffer buffer = static_cast<cl_mem_buffer>(image_desc->buffer);
       image->mux_memories[index] = buffer->mux_memories[index];
       // TODO: Can you actually create an image 1D buffer from a sub-buffer?
-      offset = buffer->offset;
+      const cl_mem root = buffer->optional_parent ? buffer->optional_parent
+                                                  : image_desc->buffer;
+      offset = root->host_ptr_offset + buffer->offset;
     } else {
       const cl_int error = image->allocateMemory(
           device->mux_device, mux_image->memory_requirements.supported_heaps,
@@ -246,16 +253,15 @@ CL_API_ENTRY cl_mem CL_API_CALL cl::CreateImage(
     if (CL_MEM_COPY_HOST_PTR & flags) {
       void *data;
       mux_error = muxMapMemory(device->mux_device, mux_memory, offset,
-                               mux_image->memory_requirements.size, &data);
+                               host_data_size, &data);
       OCL_CHECK(mux_error, OCL_SET_IF_NOT_NULL(
                                errcode_ret, CL_MEM_OBJECT_ALLOCATION_FAILURE);
                 return nullptr);
 
-      memcpy(data, host_ptr, mux_image->memory_requirements.size);
+      memcpy(data, host_ptr, host_data_size);
 
-      const mux_result_t error =
-          muxFlushMappedMemoryToDevice(device->mux_device, mux_memory, offset,
-                                       mux_image->memory_requirements.size);
+      const mux_result_t error = muxFlushMappedMemoryToDevice(
+          device->mux_device, mux_memory, offset, host_data_size);
       if (mux_success != error ||
           (mux_success != muxUnmapMemory(device->mux_device, mux_memory))) {
         OCL_SET_IF_NOT_NULL(errcode_ret, CL_MEM_OBJECT_ALLOCATION_FAILURE);
@@ -171,6 +171,14 @@ mux_ndrange_options_t _cl_kernel::createKernelExecutionOptions(
   execution_options.global_offset = global_offset.data();
   execution_options.global_size = global_size.data();
   execution_options.dimensions = work_dim;
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  // USM allocations set with clSetKernelExecInfo are reached through pointers
+  // the kernel loads from memory, rather than through its arguments.
+  execution_options.indirect_memory_access =
+      kernel_exec_info_usm_flags || !indirect_usm_allocs.empty();
+#else
+  execution_options.indirect_memory_access = false;
+#endif
   return execution_options;
 }
 
@@ -197,7 +205,8 @@ cl_int _cl_kernel::retainMems(cl_command_queue command_queue,
 
       // Synchronize cl_mem's created with multiple devices in their context.
       switch (mem->type) {
-        case CL_MEM_OBJECT_BUFFER: {
+        case CL_MEM_OBJECT_BUFFER:
+        case CL_MEM_OBJECT_PIPE: {
           if (auto error =
                   static_cast<cl_mem_buffer>(mem)->synchronize(command_queue)) {
             return error;
@@ -306,12 +315,7 @@ static cl_int PushExecuteKernel(
   if (device_kernel.supportsDeferredCompilation()) {
     auto result = device_kernel.createSpecializedKernel(mux_execution_options);
     if (!result.has_value()) {
-      if (printf_buffer) {
-        muxDestroyBuffer(mux_device, printf_buffer, mux_allocator);
-      }
-      if (printf_memory) {
-        muxFreeMemory(mux_device, printf_memory, mux_allocator);
-      }
+      releasePrintfBuffer(device, printf_memory, printf_buffer);
       return cl::getErrorFrom(result.error());
     }
 
@@ -337,25 +341,16 @@ static cl_int PushExecuteKernel(
     if (nullptr != return_event) {
       return_event->complete(error);
     }
-    if (nullptr != printf_buffer) {
-      muxDestroyBuffer(mux_device, printf_buffer, mux_allocator);
-    }
-    if (nullptr != printf_memory) {
-      muxFreeMemory(mux_device, printf_memory, mux_allocator);
-    }
+    releasePrintfBuffer(device, printf_memory, printf_buffer);
     return error;
   }
 
   // enqueue a user callback that reads the printf buffer and print the data
   // out.
   if (device_program.printf_calls.size() != 0) {
-    printf_info_t *printf_info =
-        new printf_info_t{device,
-                          printf_memory,
-                          printf_buffer,
-                          buffer_group_size,
-                          std::vector<uint32_t>(num_groups, 0),
-                          device_program.printf_calls};
+    printf_info_t *printf_info = new printf_info_t(
+        device, kernel->program, printf_memory, printf_buffer,
+        buffer_group_size, num_groups, device_program.printf_calls);
 
     mux_error = createPrintfCallback(*mux_command_buffer, printf_info);
     OCL_ASSERT(mux_success == mux_error, "muxCommand failed!");
@@ -656,8 +651,7 @@ bool _cl_kernel::GetArgInfo() {
   cl_context context = program->context;
   for (auto device : context->devices) {
     const auto &device_program = program->programs[device];
-    if (!device_program.isExecutable() ||
-        !device_program.program_info.has_value()) {
+    if (!device_program.isExecutable() || !device_program.program_info) {
       continue;
     }
 
@@ -926,7 +920,9 @@ CL_API_ENTRY cl_int CL_API_CALL cl::SetKernelArg(cl_kernel kernel,
         } else {
           cl_mem mem = *static_cast<const cl_mem *>(arg_value);
 
-          OCL_CHECK(CL_MEM_OBJECT_BUFFER != mem->type,
+          // Pipes are buffers holding the pipe's header and packets.
+          OCL_CHECK(CL_MEM_OBJECT_BUFFER != mem->type &&
+                        CL_MEM_OBJECT_PIPE != mem->type,
                     return CL_INVALID_ARG_VALUE);
 #ifdef CL_VERSION_3_0
           // Arguments can optionally be annoted with a 'dereferenceable'
@@ -1231,6 +1227,9 @@ static cl_kernel_arg_type_qualifier convertKernelArgTypeQualifier(
   if (type & compiler::KernelArgType::VOLATILE) {
     cl_arg_type |= CL_KERNEL_ARG_TYPE_VOLATILE;
   }
+  if (type & compiler::KernelArgType::PIPE) {
+    cl_arg_type |= CL_KERNEL_ARG_TYPE_PIPE;
+  }
   return cl_arg_type;
 }
 
@@ -16,6 +16,7 @@
 
 #include <cl/buffer.h>
 #include <cl/command_queue.h>
+#include <cl/context.h>
 #include <cl/mem.h>
 #include <cl/mux.h>
 #include <cl/platform.h>
@@ -24,6 +25,7 @@
 #include <tracer/tracer.h>
 
 #include <memory>
+#include <mutex>
 
 _cl_mem::_cl_mem(const cl_context context, const cl_mem_flags flags,
                  const size_t size, const cl_mem_object_type type,
@@ -42,6 +44,7 @@ _cl_mem::_cl_mem(const cl_context context, const cl_mem_flags flags,
       callback_datas(),
       mapCount(0),
       map_base_pointer(nullptr),
+      host_ptr_offset(0),
       device_owner(nullptr)
 #ifdef CL_VERSION_3_0
       ,
@@ -58,6 +61,17 @@ _cl_mem::_cl_mem(const cl_context context, const cl_mem_flags flags,
     OCL_ASSERT(context == optional_parent->context, "Context mismatch.");
     cl::retainInternal(optional_parent);
   }
+
+#if defined(CL_VERSION_3_0) && \
+    defined(OCL_EXTENSION_cl_intel_unified_shared_memory)
+  // SVM allocations are host USM allocations.
+  if (host_ptr && (flags & CL_MEM_USE_HOST_PTR)) {
+    const std::scoped_lock context_guard(context->usm_mutex);
+    if (extension::usm::findAllocation(context, host_ptr)) {
+      uses_svm_pointer = CL_TRUE;
+    }
+  }
+#endif
 }
 
 _cl_mem::~_cl_mem() {
@@ -101,11 +115,28 @@ cl_int _cl_mem::allocateMemory(mux_device_t mux_device,
   if ((CL_MEM_USE_HOST_PTR & flags) &&
       (device_alloc_caps & mux_allocation_capabilities_coherent_host)) {
     const uintptr_t host_ptr_uint = reinterpret_cast<uintptr_t>(host_ptr);
-    if (0 == (host_ptr_uint % mux_device->info->buffer_alignment)) {
+    const size_t misalignment =
+        host_ptr_uint % mux_device->info->buffer_alignment;
+    if (0 == misalignment) {
       const mux_result_t error = muxCreateMemoryFromHost(
           mux_device, size, host_ptr, mux_allocator, out_memory);
       return error ? CL_MEM_OBJECT_ALLOCATION_FAILURE : CL_SUCCESS;
     }
+    // Otherwise alias the aligned address below the pointer and bind buffers
+    // at an offset into it, the same way as sub-buffers, so the user's memory
+    // is used directly rather than copied on creation, map and unmap. The
+    // offset is shared by every device so this is limited to single device
+    // contexts, and to buffers as images are always bound at the start of
+    // their memory.
+    if (CL_MEM_OBJECT_BUFFER == type && 1 == context->devices.size()) {
+      const mux_result_t error = muxCreateMemoryFromHost(
+          mux_device, size + misalignment,
+          reinterpret_cast<void *>(host_ptr_uint - misalignment),
+          mux_allocator, out_memory);
+      OCL_CHECK(error, return CL_MEM_OBJECT_ALLOCATION_FAILURE);
+      host_ptr_offset = misalignment;
+      return CL_SUCCESS;
+    }
   }
 
   // Set the core allocation type based on if the user is requesting host
@@ -251,17 +282,21 @@ cl_int _cl_mem::pushMapMemory(cl_command_queue command_queue,
     void flushMemoryFromDevice() {
       mux_device_t device = mem->context->devices[device_index]->mux_device;
       mux_memory_t memory = mem->mux_memories[device_index];
-      const mux_result_t error =
-          muxFlushMappedMemoryFromDevice(device, memory, offset, size);
+      const mux_result_t error = muxFlushMappedMemoryFromDevice(
+          device, memory, mem->host_ptr_offset + offset, size);
       OCL_ASSERT(mux_success == error,
                  "muxFlushMappedMemoryFromDevice failed!");
       OCL_UNUSED(error);
 
       if (CL_MEM_USE_HOST_PTR & mem->flags) {
         // Copy data from `map_base_pointer` containing our cache of the data.
-        // to `host_ptr` user has access to.
-        std::memcpy(static_cast<char *>(mem->host_ptr) + offset,
-                    static_cast<char *>(mem->map_base_pointer) + offset, size);
+        // to `host_ptr` user has access to, unless the memory aliases it.
+        char *cache = static_cast<char *>(mem->map_base_pointer) +
+                      mem->host_ptr_offset + offset;
+        char *user = static_cast<char *>(mem->host_ptr) + offset;
+        if (cache != user) {
+          std::memcpy(user, cache, size);
+        }
       }
     }
 
@@ -552,15 +587,20 @@ cl::EnqueueUnmapMemObject(cl_command_queue command_queue, cl_mem memobj,
 
             if (CL_MEM_USE_HOST_PTR & mem->flags) {
               // Copy data from `host_ptr` user has accessed/modified to our
-              // cache of the data in `map_base_pointer`.
-              std::memcpy(
-                  static_cast<char *>(mem->map_base_pointer) + map.offset,
-                  static_cast<char *>(mem->host_ptr) + map.offset, map.size);
+              // cache of the data in `map_base_pointer`, unless the memory
+              // aliases it.
+              char *cache = static_cast<char *>(mem->map_base_pointer) +
+                            mem->host_ptr_offset + map.offset;
+              char *user = static_cast<char *>(mem->host_ptr) + map.offset;
+              if (cache != user) {
+                std::memcpy(cache, user, map.size);
+              }
             }
 
             // flush the memory region back to the device if required
             auto mux_error = muxFlushMappedMemoryToDevice(
-                mux_device, mux_memory, map.offset, map.size);
+                mux_device, mux_memory, mem->host_ptr_offset + map.offset,
+                map.size);
             OCL_ASSERT(!mux_error, "muxFlushMappedMemoryToDevice failed!");
             OCL_UNUSED(mux_error);
 
@@ -63,14 +63,46 @@ cl::CreatePipe(cl_context context, cl_mem_flags flags, cl_uint pipe_packet_size,
                cl_uint pipe_max_packets, const cl_pipe_properties *properties,
                cl_int *errcode_ret) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clCreatePipe");
-  // Optional in 3.0.
-  (void)context;
-  (void)flags;
-  (void)pipe_packet_size;
-  (void)pipe_max_packets;
-  (void)properties;
-  *errcode_ret = CL_INVALID_OPERATION;
-  return nullptr;
+  OCL_CHECK(!context, OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_CONTEXT);
+            return nullptr);
+  OCL_CHECK(std::none_of(context->devices.begin(), context->devices.end(),
+                         [](cl_device_id device) {
+                           return CL_TRUE == device->pipe_support;
+                         }),
+            OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_OPERATION);
+            return nullptr);
+
+  // Pipes are only accessed by kernels, which both read and write them.
+  OCL_CHECK(flags & ~(CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS),
+            OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_VALUE);
+            return nullptr);
+  flags = CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS;
+
+  // There are no pipe properties, so only an empty list is valid.
+  OCL_CHECK(properties && properties[0],
+            OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_VALUE);
+            return nullptr);
+
+  OCL_CHECK(0 == pipe_packet_size || 0 == pipe_max_packets,
+            OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_PIPE_SIZE);
+            return nullptr);
+  OCL_CHECK(std::any_of(context->devices.begin(), context->devices.end(),
+                        [pipe_packet_size](cl_device_id device) {
+                          return pipe_packet_size >
+                                 device->pipe_max_packet_size;
+                        }),
+            OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_PIPE_SIZE);
+            return nullptr);
+
+  auto pipe = _cl_mem_buffer::createPipe(context, flags, pipe_packet_size,
+                                         pipe_max_packets);
+  if (!pipe) {
+    OCL_SET_IF_NOT_NULL(errcode_ret, pipe.error());
+    return nullptr;
+  }
+
+  OCL_SET_IF_NOT_NULL(errcode_ret, CL_SUCCESS);
+  return pipe->release();
 }
 
 CL_API_ENTRY cl_int CL_API_CALL cl::GetPipeInfo(cl_mem pipe,
@@ -79,34 +111,97 @@ CL_API_ENTRY cl_int CL_API_CALL cl::GetPipeInfo(cl_mem pipe,
                                                 void *param_value,
                                                 size_t *param_value_size_ret) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clGetPipeInfo");
-  // Optional in 3.0.
-  (void)pipe;
-  (void)param_name;
-  (void)param_value_size;
-  (void)param_value;
-  (void)param_value_size_ret;
-  return CL_INVALID_MEM_OBJECT;
+  OCL_CHECK(!pipe || CL_MEM_OBJECT_PIPE != pipe->type,
+            return CL_INVALID_MEM_OBJECT);
+  auto *const pipe_buffer = static_cast<cl_mem_buffer>(pipe);
+
+  switch (param_name) {
+    case CL_PIPE_PACKET_SIZE:
+    case CL_PIPE_MAX_PACKETS: {
+      OCL_CHECK(param_value && param_value_size < sizeof(cl_uint),
+                return CL_INVALID_VALUE);
+      OCL_SET_IF_NOT_NULL(param_value_size_ret, sizeof(cl_uint));
+      OCL_SET_IF_NOT_NULL(static_cast<cl_uint *>(param_value),
+                          CL_PIPE_PACKET_SIZE == param_name
+                              ? pipe_buffer->pipe_packet_size
+                              : pipe_buffer->pipe_max_packets);
+    } break;
+    case CL_PIPE_PROPERTIES:
+      // Pipes are never created with properties.
+      OCL_SET_IF_NOT_NULL(param_value_size_ret, size_t(0));
+      break;
+    default:
+      return CL_INVALID_VALUE;
+  }
+
+  return CL_SUCCESS;
 }
 
 CL_API_ENTRY void *CL_API_CALL cl::SVMAlloc(cl_context context,
                                             cl_svm_mem_flags flags, size_t size,
                                             cl_uint alignment) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clSVMAlloc");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  OCL_CHECK(!context, return nullptr);
+  OCL_CHECK(!context->supportsSVM(), return nullptr);
+
+  const cl_svm_mem_flags access =
+      flags & (CL_MEM_READ_WRITE | CL_MEM_WRITE_ONLY | CL_MEM_READ_ONLY);
+  OCL_CHECK(access & (access - 1), return nullptr);
+  OCL_CHECK(flags & ~(access | CL_MEM_SVM_FINE_GRAIN_BUFFER |
+                      CL_MEM_SVM_ATOMICS),
+            return nullptr);
+  OCL_CHECK((flags & CL_MEM_SVM_ATOMICS) &&
+                !(flags & CL_MEM_SVM_FINE_GRAIN_BUFFER),
+            return nullptr);
+  OCL_CHECK(alignment & (alignment - 1), return nullptr);
+  OCL_CHECK(0 == size, return nullptr);
+
+  cl_device_svm_capabilities required = CL_DEVICE_SVM_COARSE_GRAIN_BUFFER;
+  if (flags & CL_MEM_SVM_FINE_GRAIN_BUFFER) {
+    required |= CL_DEVICE_SVM_FINE_GRAIN_BUFFER;
+  }
+  if (flags & CL_MEM_SVM_ATOMICS) {
+    required |= CL_DEVICE_SVM_ATOMICS;
+  }
+  const bool supported = std::any_of(
+      context->devices.begin(), context->devices.end(),
+      [required](cl_device_id device) {
+        return required == (device->svm_capabilities & required);
+      });
+  OCL_CHECK(!supported, return nullptr);
+  for (auto device : context->devices) {
+    OCL_CHECK(size > device->max_mem_alloc_size, return nullptr);
+    OCL_CHECK(alignment > device->min_data_type_align_size, return nullptr);
+  }
+
+  // SVM allocations are host USM allocations, which devices supporting SVM
+  // access directly at the same address as the host, so are fine-grained
+  // whether or not that was requested.
+  cl_int error = CL_SUCCESS;
+  return clHostMemAllocINTEL(context, nullptr, size, alignment, &error);
+#else
   // Optional in 3.0.
   (void)context;
   (void)flags;
   (void)size;
   (void)alignment;
   return nullptr;
+#endif
 }
 
 CL_API_ENTRY void CL_API_CALL cl::SVMFree(cl_context context,
                                           void *svm_pointer) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clSVMFree");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  if (context && context->supportsSVM()) {
+    (void)clMemFreeINTEL(context, svm_pointer);
+  }
+#else
   // Optional in 3.0.
   (void)context;
   (void)svm_pointer;
-  return;
+#endif
 }
 
 CL_API_ENTRY cl_sampler CL_API_CALL cl::CreateSamplerWithProperties(
@@ -124,11 +219,20 @@ CL_API_ENTRY cl_sampler CL_API_CALL cl::CreateSamplerWithProperties(
 CL_API_ENTRY cl_int CL_API_CALL cl::SetKernelArgSVMPointer(
     cl_kernel kernel, cl_uint arg_index, const void *arg_value) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clSetKernelArgSVMPointer");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  OCL_CHECK(!kernel, return CL_INVALID_KERNEL);
+  OCL_CHECK(!kernel->program->context->supportsSVM(),
+            return CL_INVALID_OPERATION);
+  // Pointers are passed to kernels unchanged, so may point anywhere within an
+  // SVM allocation.
+  return clSetKernelArgMemPointerINTEL(kernel, arg_index, arg_value);
+#else
   // Optional in 3.0.
   (void)kernel;
   (void)arg_index;
   (void)arg_value;
   return CL_INVALID_OPERATION;
+#endif
 }
 
 CL_API_ENTRY cl_int CL_API_CALL
@@ -147,7 +251,13 @@ cl::SetKernelExecInfo(cl_kernel kernel, cl_kernel_exec_info param_name,
     return err;
   }
 
-  return CL_INVALID_OPERATION;
+  switch (param_name) {
+    case CL_KERNEL_EXEC_INFO_SVM_PTRS:
+    case CL_KERNEL_EXEC_INFO_SVM_FINE_GRAIN_SYSTEM:
+      return CL_INVALID_OPERATION;
+    default:
+      return CL_INVALID_VALUE;
+  }
 }
 
 CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMFree(
@@ -159,6 +269,15 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMFree(
     void *user_data, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueSVMFree");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+  OCL_CHECK(0 == command_queue->device->svm_capabilities,
+            return CL_INVALID_OPERATION);
+  return extension::usm::enqueueFree(command_queue, num_svm_pointers,
+                                     svm_pointers, pfn_free_func, user_data,
+                                     num_events_in_wait_list, event_wait_list,
+                                     event);
+#else
   // Optional in 3.0.
   (void)command_queue;
   (void)num_svm_pointers;
@@ -169,6 +288,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMFree(
   (void)event_wait_list;
   (void)event;
   return CL_INVALID_OPERATION;
+#endif
 }
 
 CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMemcpy(
@@ -176,6 +296,14 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMemcpy(
     const void *src_ptr, size_t size, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueSVMMemcpy");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+  OCL_CHECK(0 == command_queue->device->svm_capabilities,
+            return CL_INVALID_OPERATION);
+  return extension::usm::enqueueMemcpy(
+      command_queue, blocking_copy, dst_ptr, src_ptr, size,
+      num_events_in_wait_list, event_wait_list, event, CL_COMMAND_SVM_MEMCPY);
+#else
   // Optional in 3.0.
   (void)command_queue;
   (void)blocking_copy;
@@ -186,6 +314,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMemcpy(
   (void)event_wait_list;
   (void)event;
   return CL_INVALID_OPERATION;
+#endif
 }
 
 CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMemFill(
@@ -193,6 +322,15 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMemFill(
     size_t pattern_size, size_t size, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueSVMMemFill");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+  OCL_CHECK(0 == command_queue->device->svm_capabilities,
+            return CL_INVALID_OPERATION);
+  OCL_CHECK(0 == pattern_size, return CL_INVALID_VALUE);
+  return extension::usm::enqueueMemFill(
+      command_queue, svm_ptr, pattern, pattern_size, size,
+      num_events_in_wait_list, event_wait_list, event, CL_COMMAND_SVM_MEMFILL);
+#else
   // Optional in 3.0.
   (void)command_queue;
   (void)svm_ptr;
@@ -203,6 +341,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMemFill(
   (void)event_wait_list;
   (void)event;
   return CL_INVALID_OPERATION;
+#endif
 }
 
 CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMap(
@@ -210,6 +349,23 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMap(
     void *svm_ptr, size_t size, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueSVMMap");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+  OCL_CHECK(0 == command_queue->device->svm_capabilities,
+            return CL_INVALID_OPERATION);
+  OCL_CHECK(!svm_ptr || 0 == size, return CL_INVALID_VALUE);
+  OCL_CHECK(flags & ~(CL_MAP_READ | CL_MAP_WRITE |
+                      CL_MAP_WRITE_INVALIDATE_REGION),
+            return CL_INVALID_VALUE);
+  OCL_CHECK((flags & CL_MAP_WRITE_INVALIDATE_REGION) &&
+                (flags & (CL_MAP_READ | CL_MAP_WRITE)),
+            return CL_INVALID_VALUE);
+  // The host and device already share the allocation, so mapping only has to
+  // wait for the commands before it.
+  return extension::usm::enqueueMarker(
+      command_queue, blocking_map, {&svm_ptr, 1}, num_events_in_wait_list,
+      event_wait_list, event, CL_COMMAND_SVM_MAP);
+#else
   // Optional in 3.0.
   (void)command_queue;
   (void)blocking_map;
@@ -220,6 +376,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMap(
   (void)event_wait_list;
   (void)event;
   return CL_INVALID_OPERATION;
+#endif
 }
 
 CL_API_ENTRY cl_int CL_API_CALL
@@ -227,6 +384,15 @@ cl::EnqueueSVMUnmap(cl_command_queue command_queue, void *svm_ptr,
                     cl_uint num_events_in_wait_list,
                     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueSVMUnmap");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+  OCL_CHECK(0 == command_queue->device->svm_capabilities,
+            return CL_INVALID_OPERATION);
+  OCL_CHECK(!svm_ptr, return CL_INVALID_VALUE);
+  return extension::usm::enqueueMarker(
+      command_queue, CL_FALSE, {&svm_ptr, 1}, num_events_in_wait_list,
+      event_wait_list, event, CL_COMMAND_SVM_UNMAP);
+#else
   // Optional in 3.0.
   (void)command_queue;
   (void)svm_ptr;
@@ -234,6 +400,7 @@ cl::EnqueueSVMUnmap(cl_command_queue command_queue, void *svm_ptr,
   (void)event_wait_list;
   (void)event;
   return CL_INVALID_OPERATION;
+#endif
 }
 
 // OpenCL-2.1 APIs
@@ -445,6 +612,24 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMigrateMem(
     cl_mem_migration_flags flags, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueSVMMigrateMem");
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+  OCL_CHECK(0 == command_queue->device->svm_capabilities,
+            return CL_INVALID_OPERATION);
+  OCL_CHECK(0 == num_svm_pointers || !svm_pointers, return CL_INVALID_VALUE);
+  OCL_CHECK(std::any_of(svm_pointers, svm_pointers + num_svm_pointers,
+                        [](const void *ptr) { return nullptr == ptr; }),
+            return CL_INVALID_VALUE);
+  OCL_CHECK(flags & ~(CL_MIGRATE_MEM_OBJECT_HOST |
+                      CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED),
+            return CL_INVALID_VALUE);
+  // There's nowhere to migrate to, the host and device share the allocations.
+  (void)sizes;
+  return extension::usm::enqueueMarker(
+      command_queue, CL_FALSE, {svm_pointers, num_svm_pointers},
+      num_events_in_wait_list, event_wait_list, event,
+      CL_COMMAND_SVM_MIGRATE_MEM);
+#else
   // Optional in 3.0.
   (void)command_queue;
   (void)num_svm_pointers;
@@ -455,6 +640,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueSVMMigrateMem(
   (void)event_wait_list;
   (void)event;
   return CL_INVALID_OPERATION;
+#endif
 }
 
 // OpenCL-2.0 APIs
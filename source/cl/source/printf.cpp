@@ -15,7 +15,18 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <cl/device.h>
+#include <cl/macros.h>
 #include <cl/printf.h>
+#include <cl/program.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <thread>
 
 #ifdef _MSC_VER
 #include <fcntl.h>
@@ -23,62 +34,382 @@
 #include <windows.h>
 #endif
 
-// Callback function for reading printf buffer data from device, unpacking
-// it, and printing it from host to stdout
-static void PerformPrintf(mux_queue_t, mux_command_buffer_t,
-                          void *const user_data) {
-  auto printf_info = static_cast<printf_info_t *>(user_data);
-  uint8_t *pack{};
-
-  mux_device_t mux_device = printf_info->device->mux_device;
-  const size_t printf_buffer_size = printf_info->device->printf_buffer_size;
-  mux_result_t error = muxMapMemory(mux_device, printf_info->memory, 0,
-                                    printf_buffer_size, (void **)&pack);
-  OCL_ASSERT(mux_success == error, "muxMapMemory failed!");
-  error = muxFlushMappedMemoryFromDevice(mux_device, printf_info->memory, 0,
-                                         printf_buffer_size);
-  OCL_ASSERT(mux_success == error, "muxFlushMappedMemoryFromDevice failed!");
-  OCL_UNUSED(error);
+namespace {
+/// @brief Maximum number of unused printf buffers kept by each device.
+constexpr size_t max_pooled_printf_buffers = 4;
+
+/// @brief Interval at which streamed printf buffers are drained.
+constexpr std::chrono::milliseconds printf_stream_interval{1};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Printf buffer header words are accessed as atomics");
+
+/// @brief Check if printf output should be drained while kernels run.
+///
+/// Streaming is enabled by setting the `CA_PRINTF_STREAMING` environment
+/// variable to a non-zero value, it requires the device to support host
+/// coherent allocations so the buffer can be read while the kernel writes to
+/// it.
+///
+/// @param[in] device Device the printf buffer is allocated on.
+///
+/// @return Returns true if streaming is enabled for the device.
+bool isPrintfStreamingEnabled(cl_device_id device) {
+  static const bool enabled = [] {
+    const char *env = std::getenv("CA_PRINTF_STREAMING");
+    return env && std::atoi(env) != 0;
+  }();
+  return enabled && (device->mux_device->info->allocation_capabilities &
+                     mux_allocation_capabilities_coherent_host);
+}
+
+/// @brief Reset the header of a work-group chunk so it contains no data.
+///
+/// @param[in] chunk Start of the work-group chunk.
+void resetChunk(uint8_t *chunk) {
+  const uint32_t header[3] = {builtins::printf::buffer_header_size, 0,
+                              builtins::printf::buffer_header_size};
+  static_assert(sizeof(header) == builtins::printf::buffer_header_size,
+                "Unexpected printf buffer header size");
+  std::memcpy(chunk, header, sizeof(header));
+}
+
+void destroyPrintfBuffer(mux_device_t mux_device,
+                         mux_allocator_info_t mux_allocator,
+                         printf_buffer_t entry) {
+  if (entry.buffer) {
+    muxDestroyBuffer(mux_device, entry.buffer, mux_allocator);
+  }
+  if (entry.memory) {
+    muxFreeMemory(mux_device, entry.memory, mux_allocator);
+  }
+}
 
+/// @brief Printf output copied out of a printf buffer, waiting to be
+/// formatted by the writer thread.
+struct printf_job_t {
+  /// @brief Queue which ran the command producing the output, null for output
+  /// streamed while the kernel runs.
+  mux_queue_t queue;
+  /// @brief Position of the job in the order jobs were queued.
+  uint64_t sequence;
+  /// @brief Program owning `printf_calls`, retained until the job is done.
+  cl_program program;
+  /// @brief Details of printf calls in the kernel program.
+  std::vector<builtins::printf::descriptor> *printf_calls;
+  /// @brief Copied work-group chunks, each with its own header.
+  std::vector<uint8_t> data;
+  /// @brief Size in bytes of each chunk in `data`.
+  std::vector<uint32_t> chunk_sizes;
+};
+
+/// @brief Copy the records of a work-group chunk into a job.
+///
+/// @param[in] chunk Start of the work-group chunk.
+/// @param[in] end Offset in the chunk one past the last complete record.
+/// @param[in,out] job Job to append the records to.
+void stageChunk(const uint8_t *chunk, uint32_t end, printf_job_t &job) {
+  const uint32_t header_size = builtins::printf::buffer_header_size;
+  if (end <= header_size) {
+    return;
+  }
+  const size_t start = job.data.size();
+  job.data.resize(start + end);
+  uint8_t *staged = job.data.data() + start;
+  const uint32_t header[3] = {end, 0, end};
+  std::memcpy(staged, header, header_size);
+  std::memcpy(staged + header_size, chunk + header_size, end - header_size);
+  job.chunk_sizes.push_back(end);
+}
+
+/// @brief Copy the output of a completed kernel and reset the buffer.
+///
+/// @param[in] info Printf buffer of the kernel.
+/// @param[in] pack Mapped printf buffer.
+/// @param[in,out] job Job to append the output to.
+void drainChunks(const printf_info_t &info, uint8_t *pack, printf_job_t &job) {
+  for (size_t i = 0; i < info.num_groups; i++) {
+    uint8_t *chunk = pack + (i * info.buffer_group_size);
+    uint32_t header[3];
+    std::memcpy(header, chunk, sizeof(header));
+    OCL_ASSERT(header[0] >= header[1] &&
+                   header[0] - header[1] <= info.buffer_group_size,
+               "The printf buffer is likely to be corrupt.");
+    if (header[0] >= header[1] &&
+        header[0] - header[1] <= info.buffer_group_size) {
+      stageChunk(chunk, header[0] - header[1], job);
+    }
+    resetChunk(chunk);
+  }
+}
+
+/// @brief Copy the output of a running kernel and reset the chunks copied.
+///
+/// A chunk is only copied when every byte reserved in it has either been
+/// committed or counted as overflow, i.e. no printf call is part way through
+/// storing its arguments. The chunk is then reset with a compare and swap of
+/// the length word, which fails if a work-item reserved more space since the
+/// header was read, in which case the chunk is left for the next attempt.
+///
+/// @param[in] info Printf buffer of the kernel.
+/// @param[in] pack Mapped printf buffer.
+/// @param[in,out] job Job to append the output to.
+void streamChunks(const printf_info_t &info, uint8_t *pack,
+                  printf_job_t &job) {
+  const uint32_t header_size = builtins::printf::buffer_header_size;
+  for (size_t i = 0; i < info.num_groups; i++) {
+    auto *words = reinterpret_cast<std::atomic<uint32_t> *>(
+        pack + (i * info.buffer_group_size));
+    const uint32_t length = words[0].load();
+    const uint32_t committed = words[2].load();
+    const uint32_t overflow = words[1].load();
+    if (length == header_size || committed + overflow != length) {
+      continue;
+    }
+
+    const size_t staged_size = job.data.size();
+    const size_t staged_count = job.chunk_sizes.size();
+    stageChunk(reinterpret_cast<uint8_t *>(words), length - overflow, job);
+
+    uint32_t expected = length;
+    if (!words[0].compare_exchange_strong(expected, header_size)) {
+      job.data.resize(staged_size);
+      job.chunk_sizes.resize(staged_count);
+      continue;
+    }
+    words[2].fetch_sub(committed - header_size);
+    words[1].fetch_sub(overflow);
+  }
+}
+
+/// @brief Get the stream printf output is written to.
+std::FILE *openPrintfStream() {
 #if defined(_MSC_VER) && !defined(_DLL)
   // If we are building with /MT rather than /MD, we have our own copy of stdio
   // which has not necessarily picked up any changes to stdout performed by the
   // host application.
-  std::FILE *const fp = [&]() -> std::FILE * {
-    const HANDLE processHandle = GetCurrentProcess();
-    HANDLE stdoutHandle = GetStdHandle(STD_OUTPUT_HANDLE);
-    if (stdoutHandle == INVALID_HANDLE_VALUE ||
-        DuplicateHandle(processHandle, stdoutHandle, processHandle,
-                        &stdoutHandle, 0, FALSE, DUPLICATE_SAME_ACCESS) == 0) {
-      return nullptr;
-    }
-    const int fd =
-        _open_osfhandle(reinterpret_cast<intptr_t>(stdoutHandle), _O_WRONLY);
-    if (fd == -1) {
-      return nullptr;
-    }
-    auto *const fp = _fdopen(fd, "w");
-    if (!fp) {
-      _close(fd);
-    }
-    return fp;
-  }();
+  const HANDLE processHandle = GetCurrentProcess();
+  HANDLE stdoutHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+  if (stdoutHandle == INVALID_HANDLE_VALUE ||
+      DuplicateHandle(processHandle, stdoutHandle, processHandle,
+                      &stdoutHandle, 0, FALSE, DUPLICATE_SAME_ACCESS) == 0) {
+    return nullptr;
+  }
+  const int fd =
+      _open_osfhandle(reinterpret_cast<intptr_t>(stdoutHandle), _O_WRONLY);
+  if (fd == -1) {
+    return nullptr;
+  }
+  auto *const fp = _fdopen(fd, "w");
+  if (!fp) {
+    _close(fd);
+  }
+  return fp;
 #else
-  std::FILE *const fp = stdout;
+  return stdout;
 #endif
+}
 
-  // Unpack and print the data
-  if (fp) {
-    builtins::printf::print(fp, pack, printf_info->buffer_group_size,
-                            printf_info->printf_calls,
-                            printf_info->group_offsets);
+/// @brief Close a stream returned by `openPrintfStream`.
+void closePrintfStream(std::FILE *fp) {
 #if defined(_MSC_VER) && !defined(_DLL)
-    std::fclose(fp);
+  std::fclose(fp);
+#else
+  (void)fp;
 #endif
+}
+
+/// @brief Thread formatting printf output off the queue's dispatch thread.
+///
+/// Printf callbacks copy the output out of the printf buffer and hand it to
+/// the writer as a job, so the buffer can be reused straight away. The writer
+/// also drains buffers registered for streaming while their kernels run.
+class printf_writer final {
+ public:
+  ~printf_writer() {
+    {
+      const std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    work.notify_one();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  /// @brief Copy the output of a completed kernel and queue it for writing.
+  ///
+  /// Only queueing the output is serialized with other queues, the buffer is
+  /// mapped and copied under its own lock in case the writer is streaming it.
+  void drain(mux_queue_t queue, printf_info_t &info) {
+    printf_job_t job{queue, 0, info.program, &info.printf_calls, {}, {}};
+    {
+      const std::lock_guard<std::mutex> lock(info.mapping_mutex);
+      mux_device_t mux_device = info.device->mux_device;
+      const size_t printf_buffer_size = info.device->printf_buffer_size;
+      uint8_t *pack{};
+      mux_result_t error = muxMapMemory(mux_device, info.memory, 0,
+                                        printf_buffer_size, (void **)&pack);
+      OCL_ASSERT(mux_success == error, "muxMapMemory failed!");
+      error = muxFlushMappedMemoryFromDevice(mux_device, info.memory, 0,
+                                             printf_buffer_size);
+      OCL_ASSERT(mux_success == error,
+                 "muxFlushMappedMemoryFromDevice failed!");
+
+      // Reset the buffer as we copy it, so the command can be run again.
+      drainChunks(info, pack, job);
+
+      error = muxFlushMappedMemoryToDevice(mux_device, info.memory, 0,
+                                           printf_buffer_size);
+      OCL_ASSERT(mux_success == error, "muxFlushMappedMemoryToDevice failed!");
+      error = muxUnmapMemory(mux_device, info.memory);
+      OCL_ASSERT(mux_success == error, "muxUnmapMemory failed!");
+      OCL_UNUSED(error);
+    }
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    queueLocked(std::move(job));
+  }
+
+  /// @brief Start draining a printf buffer while its kernels run.
+  void addStream(printf_info_t *info) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    streams.push_back(info);
+    startLocked();
+    work.notify_one();
   }
 
-  error = muxUnmapMemory(mux_device, printf_info->memory);
-  OCL_ASSERT(mux_success == error, "muxUnmapMemory failed!");
+  /// @brief Stop draining a printf buffer.
+  void removeStream(printf_info_t *info) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    streams.erase(std::remove(streams.begin(), streams.end(), info),
+                  streams.end());
+  }
+
+  /// @brief Wait for the output queued so far by a queue to be written.
+  ///
+  /// Output queued later, or by other queues, isn't waited for.
+  void flush(mux_queue_t queue) {
+    std::unique_lock<std::mutex> lock(mutex);
+    const uint64_t limit = next_sequence;
+    auto pending = [&](const printf_job_t &job) {
+      return job.queue == queue && job.sequence < limit;
+    };
+    idle.wait(lock, [&] {
+      return !(writing && pending(*writing)) &&
+             std::none_of(jobs.begin(), jobs.end(), pending);
+    });
+  }
+
+ private:
+  void startLocked() {
+    if (!thread.joinable()) {
+      thread = std::thread(&printf_writer::run, this);
+    }
+  }
+
+  void queueLocked(printf_job_t job) {
+    if (job.chunk_sizes.empty()) {
+      return;
+    }
+    cl::retainInternal(job.program);
+    job.sequence = next_sequence++;
+    jobs.push_back(std::move(job));
+    startLocked();
+    work.notify_one();
+  }
+
+  void pollLocked() {
+    for (printf_info_t *info : streams) {
+      printf_job_t job{nullptr, 0, info->program, &info->printf_calls, {}, {}};
+      {
+        // Streams are only polled while registered, so `info` can't be
+        // destroyed until the writer's lock is released.
+        const std::lock_guard<std::mutex> lock(info->mapping_mutex);
+        mux_device_t mux_device = info->device->mux_device;
+        uint8_t *pack{};
+        if (muxMapMemory(mux_device, info->memory, 0,
+                         info->device->printf_buffer_size,
+                         (void **)&pack) != mux_success) {
+          continue;
+        }
+        streamChunks(*info, pack, job);
+        muxUnmapMemory(mux_device, info->memory);
+      }
+      queueLocked(std::move(job));
+    }
+  }
+
+  void run() {
+    auto next_poll = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping || !jobs.empty()) {
+      if (!stopping && !streams.empty() &&
+          std::chrono::steady_clock::now() >= next_poll) {
+        pollLocked();
+        next_poll = std::chrono::steady_clock::now() + printf_stream_interval;
+        continue;
+      }
+
+      if (jobs.empty()) {
+        if (streams.empty()) {
+          work.wait(lock);
+        } else {
+          work.wait_until(lock, next_poll);
+        }
+        continue;
+      }
+
+      printf_job_t job = std::move(jobs.front());
+      jobs.pop_front();
+      writing = &job;
+      lock.unlock();
+      write(job);
+      lock.lock();
+      writing = nullptr;
+      idle.notify_all();
+    }
+  }
+
+  static void write(printf_job_t &job) {
+    if (std::FILE *const fp = openPrintfStream()) {
+      std::vector<uint32_t> group_offsets(1);
+      const uint8_t *chunk = job.data.data();
+      for (const uint32_t chunk_size : job.chunk_sizes) {
+        group_offsets[0] = 0;
+        builtins::printf::print(fp, const_cast<uint8_t *>(chunk), chunk_size,
+                                *job.printf_calls, group_offsets);
+        chunk += chunk_size;
+      }
+      closePrintfStream(fp);
+    }
+    cl::releaseInternal(job.program);
+  }
+
+  std::mutex mutex;
+  std::condition_variable work;
+  std::condition_variable idle;
+  std::thread thread;
+  std::deque<printf_job_t> jobs;
+  std::vector<printf_info_t *> streams;
+  /// @brief Job being written, only accessed under `mutex`.
+  const printf_job_t *writing = nullptr;
+  uint64_t next_sequence = 0;
+  bool stopping = false;
+};
+
+printf_writer &getPrintfWriter() {
+  static printf_writer writer;
+  return writer;
+}
+}  // namespace
+
+// Callback function for copying printf buffer data from device and handing it
+// to the writer thread, which unpacks it and prints it from host to stdout
+static void PerformPrintf(mux_queue_t queue, mux_command_buffer_t,
+                          void *const user_data) {
+  auto printf_info = static_cast<printf_info_t *>(user_data);
+  getPrintfWriter().drain(queue, *printf_info);
 }
 
 // Callback function for printing data using PerformPrintf, and then freeing
@@ -96,14 +427,34 @@ static void PrintfAndFree(mux_queue_t queue,
   delete printf_info;
 }
 
-printf_info_t::~printf_info_t() {
-  if (buffer) {
-    muxDestroyBuffer(device->mux_device, buffer, device->mux_allocator);
+printf_buffer_pool_t::~printf_buffer_pool_t() {
+  for (const auto &entry : buffers) {
+    destroyPrintfBuffer(mux_device, mux_allocator, entry);
+  }
+}
+
+printf_info_t::printf_info_t(
+    cl_device_id device, cl_program program, mux_memory_t memory,
+    mux_buffer_t buffer, size_t buffer_group_size, size_t num_groups,
+    std::vector<builtins::printf::descriptor> &printf_calls)
+    : device(device),
+      program(program),
+      memory(memory),
+      buffer(buffer),
+      buffer_group_size(buffer_group_size),
+      num_groups(num_groups),
+      printf_calls(printf_calls),
+      streaming(isPrintfStreamingEnabled(device)) {
+  if (streaming) {
+    getPrintfWriter().addStream(this);
   }
+}
 
-  if (memory) {
-    muxFreeMemory(device->mux_device, memory, device->mux_allocator);
+printf_info_t::~printf_info_t() {
+  if (streaming) {
+    getPrintfWriter().removeStream(this);
   }
+  releasePrintfBuffer(device, memory, buffer);
 }
 
 mux_result_t createPrintfCallback(mux_command_buffer_t command_buffer,
@@ -119,6 +470,27 @@ mux_result_t createPrintfCallback(
                                 printf_info.get(), 0, nullptr, nullptr);
 }
 
+void flushPrintfOutput(mux_queue_t queue) { getPrintfWriter().flush(queue); }
+
+void releasePrintfBuffer(cl_device_id device, mux_memory_t printf_memory,
+                         mux_buffer_t printf_buffer) {
+  const printf_buffer_t entry{printf_memory, printf_buffer};
+  if (!entry.memory || !entry.buffer) {
+    destroyPrintfBuffer(device->mux_device, device->mux_allocator, entry);
+    return;
+  }
+
+  auto &pool = *device->printf_buffer_pool;
+  {
+    const std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.buffers.size() < max_pooled_printf_buffers) {
+      pool.buffers.push_back(entry);
+      return;
+    }
+  }
+  destroyPrintfBuffer(device->mux_device, device->mux_allocator, entry);
+}
+
 cl_int createPrintfBuffer(
     cl_device_id device,
     const std::array<size_t, cl::max::WORK_ITEM_DIM> &local_work_size,
@@ -136,73 +508,91 @@ cl_int createPrintfBuffer(
   // Ensure the buffer start of each work item is aligned to 4 bytes.
   buffer_group_size = (device->printf_buffer_size / num_groups) & ~3u;
 
-  // if we have less than 8 bytes per work group, we can't print anything,
-  // and the kernel will crash, so just abort
-  if (buffer_group_size < 8) {
+  // if we don't have room for the header in each work group, we can't print
+  // anything, and the kernel will crash, so just abort
+  if (buffer_group_size < builtins::printf::buffer_header_size) {
     return CL_OUT_OF_RESOURCES;
   }
 
-  // allocate the memory for the printf buffer
-  // TODO: Add mechanism to support allocations best suited to printf.
-  const uint32_t alignment = 0;  // Default alignment
   auto mux_device = device->mux_device;
   auto mux_allocator = device->mux_allocator;
-  mux_result_t mux_error = muxAllocateMemory(
-      mux_device, device->printf_buffer_size, 1,
-      mux_memory_property_host_visible, mux_allocation_type_alloc_device,
-      alignment, device->mux_allocator, &printf_memory);
-  if (mux_error) {
-    return CL_OUT_OF_RESOURCES;
+
+  // reuse a buffer from a previous ND-Range if there is one
+  printf_buffer_t entry{nullptr, nullptr};
+  {
+    auto &pool = *device->printf_buffer_pool;
+    const std::lock_guard<std::mutex> lock(pool.mutex);
+    if (!pool.buffers.empty()) {
+      entry = pool.buffers.back();
+      pool.buffers.pop_back();
+    }
+  }
+
+  if (!entry.memory) {
+    // allocate the memory for the printf buffer, streaming requires the host
+    // to see the device's writes while the kernel is running
+    const uint32_t alignment = 0;  // Default alignment
+    const uint32_t memory_properties =
+        isPrintfStreamingEnabled(device)
+            ? mux_memory_property_host_visible |
+                  mux_memory_property_host_coherent
+            : mux_memory_property_host_visible;
+    mux_result_t mux_error = muxAllocateMemory(
+        mux_device, device->printf_buffer_size, 1, memory_properties,
+        mux_allocation_type_alloc_device, alignment, mux_allocator,
+        &entry.memory);
+    if (mux_error) {
+      return CL_OUT_OF_RESOURCES;
+    }
+
+    // create the printf buffer
+    mux_error = muxCreateBuffer(mux_device, device->printf_buffer_size,
+                                mux_allocator, &entry.buffer);
+    if (mux_error) {
+      destroyPrintfBuffer(mux_device, mux_allocator, entry);
+      return CL_OUT_OF_RESOURCES;
+    }
+
+    // and bind it to the printf memory without offset
+    mux_error =
+        muxBindBufferMemory(mux_device, entry.memory, entry.buffer, 0);
+    if (mux_error) {
+      destroyPrintfBuffer(mux_device, mux_allocator, entry);
+      return CL_OUT_OF_RESOURCES;
+    }
   }
 
-  // We need to initialize the first 8 bytes of the printf buffer so that
-  // the first printf call can get a valid offset
-  uint32_t *buffer;
-  mux_error = muxMapMemory(mux_device, printf_memory, 0,
-                           device->printf_buffer_size, (void **)&buffer);
+  // We need to initialize the header of each work group's chunk of the printf
+  // buffer so that the first printf call can get a valid offset. Chunk sizes
+  // depend on the ND-Range so this is needed for pooled buffers too.
+  uint8_t *buffer;
+  mux_result_t mux_error =
+      muxMapMemory(mux_device, entry.memory, 0, device->printf_buffer_size,
+                   (void **)&buffer);
   if (mux_error) {
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
+    destroyPrintfBuffer(mux_device, mux_allocator, entry);
     return CL_OUT_OF_RESOURCES;
   }
 
   // initialize the buffer chunk for each work group
   for (size_t group_id = 0; group_id < num_groups; ++group_id) {
-    // index into the 32 bits array
-    const size_t index = (group_id * buffer_group_size) / sizeof(uint32_t);
-
-    // 8 bytes for the size of the length value plus the size of the
-    // overflow count
-    buffer[index] = 8;
-    // 0 bytes of overflow
-    buffer[index + 1] = 0;
+    resetChunk(buffer + (group_id * buffer_group_size));
   }
 
-  mux_error = muxFlushMappedMemoryToDevice(mux_device, printf_memory, 0,
+  mux_error = muxFlushMappedMemoryToDevice(mux_device, entry.memory, 0,
                                            device->printf_buffer_size);
   if (mux_error) {
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
+    muxUnmapMemory(mux_device, entry.memory);
+    destroyPrintfBuffer(mux_device, mux_allocator, entry);
     return CL_OUT_OF_RESOURCES;
   }
-  mux_error = muxUnmapMemory(mux_device, printf_memory);
+  mux_error = muxUnmapMemory(mux_device, entry.memory);
   if (mux_error) {
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
+    destroyPrintfBuffer(mux_device, mux_allocator, entry);
     return CL_OUT_OF_RESOURCES;
   }
 
-  // create the printf buffer
-  mux_error = muxCreateBuffer(mux_device, device->printf_buffer_size,
-                              mux_allocator, &printf_buffer);
-  if (mux_error) {
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
-    return CL_OUT_OF_RESOURCES;
-  }
-
-  // and bind it to the printf memory without offset
-  mux_error = muxBindBufferMemory(mux_device, printf_memory, printf_buffer, 0);
-  if (mux_error) {
-    muxDestroyBuffer(mux_device, printf_buffer, mux_allocator);
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
-    return CL_OUT_OF_RESOURCES;
-  }
+  printf_memory = entry.memory;
+  printf_buffer = entry.buffer;
   return CL_SUCCESS;
 }
@@ -27,8 +27,12 @@
 #include <tracer/tracer.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 static cl_int convertModuleStateToCL(compiler::ModuleState state) {
@@ -48,6 +52,34 @@ static cl_int convertModuleStateToCL(compiler::ModuleState state) {
   return CL_PROGRAM_BINARY_TYPE_NONE;
 }
 
+static std::vector<builtins::printf::descriptor> copyPrintfCalls(
+    const std::vector<builtins::printf::descriptor> &printf_calls) {
+  std::vector<builtins::printf::descriptor> copy(printf_calls.size());
+  for (size_t index = 0; index < printf_calls.size(); index++) {
+    copy[index].format_string = printf_calls[index].format_string;
+    copy[index].types = printf_calls[index].types;
+    copy[index].strings = printf_calls[index].strings;
+  }
+  return copy;
+}
+
+namespace {
+/// @brief Builds which programs can share, found by their content.
+struct shared_build_cache {
+  std::mutex mutex;
+  /// @brief Keys refer to `cl::shared_build::key`, so each build removes its
+  /// entry before it's destroyed.
+  std::unordered_map<cargo::string_view, std::weak_ptr<cl::shared_build>>
+      builds;
+};
+
+shared_build_cache &getSharedBuildCache() {
+  // Deliberately leaked as programs may be released by static destructors.
+  static shared_build_cache *cache = new shared_build_cache;
+  return *cache;
+}
+}  // namespace
+
 cl::mux_kernel_cache::mux_kernel_cache()
     : use_builtin_kernels(true),
       mux_executable(nullptr, {nullptr, {nullptr, nullptr, nullptr}}) {}
@@ -91,6 +123,84 @@ cl::mux_kernel_cache::getOrCreateKernel(cl_device_id device,
   return kernel;
 }
 
+cl::shared_build::shared_build(cl_context context, std::string key)
+    : key(std::move(key)), context(context), num_errors(0) {
+  cl::retainInternal(context);
+}
+
+cl::shared_build::~shared_build() {
+  {
+    auto &cache = getSharedBuildCache();
+    const std::lock_guard<std::mutex> lock(cache.mutex);
+    auto found = cache.builds.find(key);
+    // Once this build expired another with the same key may have replaced it.
+    if (found != cache.builds.end() && found->second.expired()) {
+      cache.builds.erase(found);
+    }
+  }
+  // The module and kernels refer to the context's compiler target and devices
+  // so must be destroyed before it's released.
+  kernels.reset();
+  module.reset();
+  cl::releaseInternal(context);
+}
+
+bool cl::shared_build::enabled() {
+  static const bool enabled = [] {
+    const char *env = std::getenv("CA_CL_PROGRAM_CACHE");
+    return nullptr != env && 0 != std::atoi(env);
+  }();
+  return enabled;
+}
+
+std::shared_ptr<cl::shared_build> cl::shared_build::find(
+    const std::string &key) {
+  auto &cache = getSharedBuildCache();
+  const std::lock_guard<std::mutex> lock(cache.mutex);
+  auto found = cache.builds.find(key);
+  if (found == cache.builds.end()) {
+    return nullptr;
+  }
+  // Null if the last program holding the build is releasing it.
+  return found->second.lock();
+}
+
+void cl::shared_build::publish(const std::shared_ptr<shared_build> &build) {
+  auto &cache = getSharedBuildCache();
+  const std::lock_guard<std::mutex> lock(cache.mutex);
+  auto found = cache.builds.find(build->key);
+  if (found != cache.builds.end()) {
+    // Keep the first of two identical builds done at the same time.
+    if (!found->second.expired()) {
+      return;
+    }
+    // The entry's key refers to the expired build, so can't be reused.
+    cache.builds.erase(found);
+  }
+  cache.builds.emplace(build->key, build);
+}
+
+cargo::expected<cargo::array_view<const uint8_t>, compiler::Result>
+cl::shared_build::getOrCreateMuxBinary() {
+  const std::lock_guard<std::mutex> lock(mux_binary_mutex);
+  if (mux_binary.has_value()) {
+    return {*mux_binary};
+  }
+
+  cargo::array_view<uint8_t> executable;
+  const compiler::Result result = module->createBinary(executable);
+  if (compiler::Result::SUCCESS != result) {
+    return cargo::make_unexpected(result);
+  }
+  auto &executable_dst = mux_binary.emplace();
+  if (cargo::success != executable_dst.alloc(executable.size())) {
+    mux_binary = cargo::nullopt;
+    return cargo::make_unexpected(compiler::Result::OUT_OF_MEMORY);
+  }
+  std::memcpy(executable_dst.data(), executable.data(), executable.size());
+  return {*mux_binary};
+}
+
 cl::device_program::device_program()
     : num_errors(0), type(cl::device_program_type::NONE) {}
 
@@ -122,6 +232,35 @@ void cl::device_program::initializeAsCompilerModule(compiler::Target *target) {
   compiler_module.module = target->createModule(num_errors, compiler_log);
 }
 
+void cl::device_program::initializeAsSharedBuild(
+    std::shared_ptr<shared_build> build) {
+  clear();
+  type = cl::device_program_type::COMPILER_MODULE;
+  // As 'compiler_module' is defined in a union, it must be explicitly
+  // constructed.
+  new (&compiler_module) CompilerModule();
+  compiler_module.module = build->module;
+  compiler_module.kernels = build->kernels;
+  compiler_log = build->compiler_log;
+  program_info = build->program_info;
+  printf_calls = copyPrintfCalls(build->printf_calls);
+  compiler_module.build = std::move(build);
+}
+
+void cl::device_program::shareBuild(cl_context context, std::string key) {
+  auto build = std::make_shared<shared_build>(context, std::move(key));
+  build->module = compiler_module.module;
+  build->kernels = compiler_module.kernels;
+  build->compiler_log = compiler_log;
+  build->program_info = program_info;
+  build->printf_calls = copyPrintfCalls(printf_calls);
+  // The build can outlive this device program, so the module must stop
+  // reporting diagnostics to it.
+  build->module->setBuildLog(build->num_errors, build->log);
+  compiler_module.build = build;
+  shared_build::publish(build);
+}
+
 void cl::device_program::reportError(cargo::string_view error) {
   num_errors++;
   compiler_log.append(error.data(), error.size());
@@ -145,11 +284,13 @@ bool cl::device_program::isExecutable() const {
 bool cl::device_program::finalize(cl_device_id device) {
   if (type == cl::device_program_type::BUILTIN) {
     // Extract type metadata from declarations.
-    program_info =
+    auto builtin_info =
         cl::binary::kernelDeclsToProgramInfo(builtin.kernel_decls, true);
-    if (!program_info) {
+    if (!builtin_info) {
       return false;
     }
+    program_info =
+        std::make_shared<compiler::ProgramInfo>(std::move(*builtin_info));
   } else if (type == cl::device_program_type::COMPILER_MODULE) {
     // Finalise the module.
     compiler::ProgramInfo program_info_to_populate;
@@ -161,7 +302,8 @@ bool cl::device_program::finalize(cl_device_id device) {
     if (num_errors != 0) {
       return false;
     }
-    program_info = std::move(program_info_to_populate);
+    program_info = std::make_shared<compiler::ProgramInfo>(
+        std::move(program_info_to_populate));
 
     // If the compiler does not support deferred compilation, we get the final
     // binary from the module and initialize a mux_kernel_cache.
@@ -322,7 +464,7 @@ bool cl::device_program::binaryDeserialize(
     cargo::array_view<const uint8_t> buffer) {
   cargo::dynamic_array<uint8_t> executable;
   bool is_executable = false;
-  program_info.emplace();
+  program_info = std::make_shared<compiler::ProgramInfo>();
   if (!binary::deserializeBinary(buffer, printf_calls, *program_info,
                                  executable, is_executable)) {
     reportError("Failed to deserialize binary");
@@ -393,6 +535,7 @@ void cl::device_program::clear() {
 }
 
 void cl::device_program::CompilerModule::clear() {
+  OCL_ASSERT(!build, "Attempting to clear a shared compiler module.");
   module->clear();
   cached_binary = cargo::optional<cargo::dynamic_array<uint8_t>>();
   cached_mux_binary = cargo::optional<cargo::dynamic_array<uint8_t>>();
@@ -404,6 +547,10 @@ cl::device_program::CompilerModule::getOrCreateMuxBinary() {
   if (cached_mux_binary.has_value()) {
     return {*cached_mux_binary};
   }
+  if (build) {
+    // Any program sharing the module may create the binary concurrently.
+    return build->getOrCreateMuxBinary();
+  }
 
   cargo::array_view<uint8_t> executable;
   const compiler::Result result = module->createBinary(executable);
@@ -429,6 +576,13 @@ cl_program_binary_type cl::device_program::getCLProgramBinaryType() const {
   }
 }
 
+std::string cl::device_program::getBuildTelemetry() const {
+  if (cl::device_program_type::COMPILER_MODULE != type) {
+    return "{}";
+  }
+  return compiler_module.module->getBuildTelemetry();
+}
+
 #ifdef CL_VERSION_3_0
 cl_int _cl_program::SPIRV::setSpecConstant(cl_uint spec_id, size_t spec_size,
                                            const void *spec_value) {
@@ -746,6 +900,59 @@ cargo::expected<std::unique_ptr<_cl_program>, cl_int> _cl_program::create(
   return program;
 }
 
+/// @brief Quote a string as a JSON string literal.
+static std::string quoteJSON(cargo::string_view str) {
+  std::string quoted = "\"";
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        quoted += "\\\"";
+        break;
+      case '\\':
+        quoted += "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          (void)std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                              static_cast<unsigned>(c));
+          quoted += escaped;
+        } else {
+          quoted += c;
+        }
+        break;
+    }
+  }
+  quoted += '"';
+  return quoted;
+}
+
+_cl_program::telemetry_sink::~telemetry_sink() {
+  static const char *const path = std::getenv("CA_CL_BUILD_TELEMETRY_FILE");
+  if (nullptr == path || nullptr == program) {
+    return;
+  }
+  // Builds on different threads append to the same file, so hold a lock to
+  // keep their lines whole.
+  static std::mutex mutex;
+  const std::lock_guard<std::mutex> lock(mutex);
+  FILE *file = std::fopen(path, "a");
+  if (nullptr == file) {
+    return;
+  }
+  for (auto device : devices) {
+    const std::string telemetry = program->programs[device].getBuildTelemetry();
+    // Device names come from the target, so may need escaping.
+    const std::string device_name =
+        quoteJSON(device->mux_device->info->device_name);
+    (void)std::fprintf(file,
+                       "{\"operation\":\"%s\",\"device\":%s,"
+                       "\"telemetry\":%s}\n",
+                       operation, device_name.c_str(), telemetry.c_str());
+  }
+  (void)std::fclose(file);
+}
+
 cl_int _cl_program::compile(
     cargo::array_view<const cl_device_id> devices,
     cargo::array_view<compiler::InputHeader> input_headers) {
@@ -833,6 +1040,85 @@ bool _cl_program::finalize(cargo::array_view<const cl_device_id> devices) {
   return true;
 }
 
+std::string _cl_program::getBuildKey(cl_device_id device) {
+  std::string key;
+  auto append = [&key](const void *data, size_t size) {
+    // Prefix each part with its size so that parts can't run into each other.
+    const uint64_t prefix = size;
+    key.append(reinterpret_cast<const char *>(&prefix), sizeof(prefix));
+    key.append(static_cast<const char *>(data), size);
+  };
+  auto appendString = [&append](const char *string) {
+    append(string, string ? std::strlen(string) : 0);
+  };
+
+  append(&device, sizeof(device));
+  append(&type, sizeof(type));
+  const std::string &options = programs[device].options;
+  append(options.data(), options.size());
+  appendString(std::getenv("CA_EXTRA_COMPILE_OPTS"));
+  appendString(std::getenv("CA_EXTRA_LINK_OPTS"));
+  switch (type) {
+#if defined(OCL_EXTENSION_cl_khr_il_program) || defined(CL_VERSION_3_0)
+    case cl::program_type::SPIRV: {
+      append(spirv.code.data(), spirv.code.size() * sizeof(uint32_t));
+      if (auto spec_info = spirv.getSpecInfo()) {
+        // Entries are unordered, so sort them to find the same build whatever
+        // order the constants were set in.
+        using entry_t = compiler::spirv::SpecializationInfo::Entry;
+        std::vector<std::pair<spv::Id, entry_t>> entries(
+            spec_info->entries.begin(), spec_info->entries.end());
+        std::sort(entries.begin(), entries.end(),
+                  [](const auto &lhs, const auto &rhs) {
+                    return lhs.first < rhs.first;
+                  });
+        for (const auto &[id, entry] : entries) {
+          append(&id, sizeof(id));
+          append(static_cast<const uint8_t *>(spec_info->data) + entry.offset,
+                 entry.size);
+        }
+      }
+    } break;
+#endif
+    case cl::program_type::OPENCLC:
+      append(openclc.source.data(), openclc.source.size());
+      break;
+    default:
+      return {};
+  }
+  return key;
+}
+
+bool _cl_program::adoptSharedBuild(cl_device_id device) {
+  if (!cl::shared_build::enabled()) {
+    return false;
+  }
+  const std::string key = getBuildKey(device);
+  if (key.empty()) {
+    return false;
+  }
+  auto build = cl::shared_build::find(key);
+  if (!build) {
+    return false;
+  }
+  programs[device].initializeAsSharedBuild(std::move(build));
+  return true;
+}
+
+void _cl_program::publishSharedBuild(cl_device_id device) {
+  auto &device_program = programs[device];
+  if (!cl::shared_build::enabled() ||
+      device_program.type != cl::device_program_type::COMPILER_MODULE ||
+      !device_program.isExecutable() || device_program.compiler_module.build) {
+    return;
+  }
+  std::string key = getBuildKey(device);
+  if (key.empty()) {
+    return;
+  }
+  device_program.shareBuild(context, std::move(key));
+}
+
 cargo::optional<const compiler::KernelInfo *> _cl_program::getKernelInfo(
     cargo::string_view name) const {
   for (auto device : context->devices) {
@@ -904,7 +1190,7 @@ const char *_cl_program::getKernelNameByOffset(
                "into executables");
 
     const compiler::ProgramInfo &program_info =
-        device_program.program_info.value();
+        *device_program.program_info;
 
     OCL_ASSERT(kernel_index < program_info.getNumKernels(),
                "OpenCL _cl_program. Error kernel index greater than the total "
@@ -972,10 +1258,14 @@ cl_int _cl_program::setOptions(cargo::array_view<const cl_device_id> devices,
                                                         ext_name.size());
     }
 
-    // Ensure we are initialized to the compiler state.
-    if (programs[device].type != cl::device_program_type::COMPILER_MODULE) {
+    // Ensure we are initialized to the compiler state, with a compiler module
+    // of our own as a shared one must not be changed.
+    if (programs[device].type != cl::device_program_type::COMPILER_MODULE ||
+        programs[device].compiler_module.build) {
       programs[device].initializeAsCompilerModule(
           context->getCompilerTarget(device));
+      // The new module hasn't parsed any options yet.
+      programs[device].options.clear();
     }
     programs[device].compiler_module.module->getOptions() = compiler_options;
 
@@ -1005,7 +1295,7 @@ cl_int _cl_program::setOptions(cargo::array_view<const cl_device_id> devices,
     // Check if we have already parsed these options.
     if (programs[device].options == options_string &&
         options_to_parse.empty()) {
-      return CL_SUCCESS;
+      continue;
     }
 
     // Store the options for this device.
@@ -1133,6 +1423,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::CompileProgram(
   const tracer::TraceGuard<tracer::OpenCL> guard("clCompileProgram");
   OCL_CHECK(!pfn_notify && user_data, return CL_INVALID_VALUE);
   const _cl_program::callback callback(program, pfn_notify, user_data);
+  _cl_program::telemetry_sink sink(program, "clCompileProgram");
 
   OCL_CHECK(!program, return CL_INVALID_PROGRAM);
   OCL_CHECK(program->num_external_kernels > 0, return CL_INVALID_OPERATION);
@@ -1186,6 +1477,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::CompileProgram(
                                        compiler::Options::Mode::COMPILE)) {
     return error;
   }
+  sink.devices = devices;
   if (auto error = program->compile(devices, inputHeaders)) {
     return error;
   }
@@ -1204,6 +1496,7 @@ CL_API_ENTRY cl_program CL_API_CALL cl::LinkProgram(
             OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_VALUE);
             return nullptr);
   _cl_program::callback callback(nullptr, pfn_notify, user_data);
+  _cl_program::telemetry_sink sink(nullptr, "clLinkProgram");
   OCL_CHECK(!context, OCL_SET_IF_NOT_NULL(errcode_ret, CL_INVALID_CONTEXT);
             return nullptr);
   OCL_CHECK(!device_list && (0 < num_devices),
@@ -1268,6 +1561,8 @@ CL_API_ENTRY cl_program CL_API_CALL cl::LinkProgram(
   // The program must be set in the RAII callback only when we know that the
   // unique_ptr will be released.
   callback.program = program->get();
+  sink.program = program->get();
+  sink.devices = {device_list, num_devices};
   OCL_SET_IF_NOT_NULL(errcode_ret, CL_SUCCESS);
   return program->release();
 }
@@ -1281,6 +1576,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::BuildProgram(
   OCL_CHECK(!program, return CL_INVALID_PROGRAM);
   OCL_CHECK(!pfn_notify && user_data, return CL_INVALID_VALUE);
   const _cl_program::callback callback(program, pfn_notify, user_data);
+  _cl_program::telemetry_sink sink(program, "clBuildProgram");
 
   OCL_CHECK(program->num_external_kernels > 0, return CL_INVALID_OPERATION);
   OCL_CHECK(device_list && num_devices == 0, return CL_INVALID_VALUE);
@@ -1316,13 +1612,26 @@ CL_API_ENTRY cl_int CL_API_CALL cl::BuildProgram(
                                          compiler::Options::Mode::BUILD)) {
       return error;
     }
-    if (auto error = program->compile(devices, {})) {
+    sink.devices = devices;
+    // Devices the program was already built for with the same content by
+    // another program share that build, see cl::shared_build.
+    cargo::small_vector<cl_device_id, 4> unbuilt_devices;
+    for (auto device : devices) {
+      if (!program->adoptSharedBuild(device) &&
+          cargo::success != unbuilt_devices.push_back(device)) {
+        return CL_OUT_OF_HOST_MEMORY;
+      }
+    }
+    if (auto error = program->compile(unbuilt_devices, {})) {
       return error == CL_COMPILE_PROGRAM_FAILURE ? CL_BUILD_PROGRAM_FAILURE
                                                  : error;
     }
-    if (!program->finalize(devices)) {
+    if (!program->finalize(unbuilt_devices)) {
       return CL_BUILD_PROGRAM_FAILURE;
     }
+    for (auto device : unbuilt_devices) {
+      program->publishSharedBuild(device);
+    }
   }
 
   return CL_SUCCESS;
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+
+# Copyright (C) Codeplay Software Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+# Exceptions; you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations
+# under the License.
+#
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Compare two BenchCL JSON results and flag regressions.
+
+Results are written by BenchCL with
+``--benchmark_out=<file> --benchmark_out_format=json``. When a run used
+``--benchmark_repetitions`` the median of the repetitions is compared. The exit
+code is 1 if any benchmark in the baseline got slower by more than the
+threshold, or is missing from the new results.
+"""
+
+from argparse import ArgumentParser
+from json import load
+from re import search
+from statistics import median
+from sys import exit, stderr
+
+TIME_UNITS = {'ns': 1, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def load_times(path, pattern):
+    """Return the real time of each benchmark in a results file, in ns."""
+    with open(path) as results:
+        benchmarks = load(results)['benchmarks']
+
+    medians = {}
+    times = {}
+    for benchmark in benchmarks:
+        name = benchmark.get('run_name', benchmark['name'])
+        if pattern and not search(pattern, name):
+            continue
+        if benchmark.get('error_occurred'):
+            continue
+        time = benchmark['real_time'] * TIME_UNITS[benchmark['time_unit']]
+        if benchmark.get('run_type') == 'aggregate':
+            if benchmark.get('aggregate_name') == 'median':
+                medians[name] = time
+        else:
+            times.setdefault(name, []).append(time)
+
+    results = {name: median(values) for name, values in times.items()}
+    results.update(medians)
+    return results
+
+
+def format_time(time):
+    for unit in ('s', 'ms', 'us'):
+        if time >= TIME_UNITS[unit]:
+            return '{:.3f} {}'.format(time / TIME_UNITS[unit], unit)
+    return '{:.0f} ns'.format(time)
+
+
+def main():
+    parser = ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('baseline', help='stored baseline results')
+    parser.add_argument('results', help='results to check')
+    parser.add_argument(
+        '--threshold',
+        type=float,
+        default=5.0,
+        help='percentage slowdown reported as a regression (default: 5)')
+    parser.add_argument('--filter',
+                        help='only compare benchmarks matching this regex')
+    args = parser.parse_args()
+
+    baseline = load_times(args.baseline, args.filter)
+    results = load_times(args.results, args.filter)
+    limit = args.threshold / 100.0
+
+    regressions = []
+    width = max([len(name) for name in baseline] + [9])
+    print('{:<{}}  {:>12}  {:>12}  {:>8}'.format('Benchmark', width,
+                                                 'Baseline', 'Time',
+                                                 'Change'))
+    for name, before in baseline.items():
+        if name not in results:
+            print('{:<{}}  {:>12}  {:>12}  {:>8}  MISSING'.format(
+                name, width, format_time(before), '-', '-'))
+            regressions.append(name)
+            continue
+        after = results[name]
+        change = after / before - 1.0 if before else 0.0
+        status = ''
+        if change > limit:
+            status = 'REGRESSION'
+            regressions.append(name)
+        elif change < -limit:
+            status = 'improvement'
+        print('{:<{}}  {:>12}  {:>12}  {:>+7.1f}%  {}'.format(
+            name, width, format_time(before), format_time(after),
+            change * 100.0, status).rstrip())
+
+    for name in results:
+        if name not in baseline:
+            print('{:<{}}  {:>12}  {:>12}  {:>8}  NEW'.format(
+                name, width, '-', format_time(results[name]), '-'))
+
+    if regressions:
+        print('\n{} of {} benchmarks regressed by more than {}%'.format(
+            len(regressions), len(baseline), args.threshold),
+              file=stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    exit(main())
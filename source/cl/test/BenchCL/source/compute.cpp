@@ -0,0 +1,701 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Representative compute kernels, reporting throughput.
+///
+/// Unlike the other benchmarks, which mostly measure API overhead, these time
+/// complete kernels so that changes to code generation, the work-item loops or
+/// the thread pool show up as changes in FLOPS or bytes per second. The
+/// kernel is run once before timing starts so compilation isn't measured, and
+/// each timed iteration is a single enqueue followed by `clFinish`.
+
+#include <BenchCL/environment.h>
+#include <BenchCL/error.h>
+#include <CL/cl.h>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+// A context, queue and kernel built from source, and the memory objects
+// created for the kernel's arguments.
+struct ComputeData {
+  cl_context context = nullptr;
+  cl_command_queue queue = nullptr;
+  cl_program program = nullptr;
+  cl_kernel kernel = nullptr;
+  std::vector<cl_mem> mems;
+
+  ComputeData(benchmark::State &state, const char *source, const char *name) {
+    auto device = benchcl::env::get()->device;
+
+    cl_int status = CL_SUCCESS;
+    context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+    queue = clCreateCommandQueue(context, device, 0, &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+    program = clCreateProgramWithSource(context, 1, &source, nullptr, &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+    if (CL_SUCCESS !=
+        clBuildProgram(program, 0, nullptr, nullptr, nullptr, nullptr)) {
+      state.SkipWithError("Failed to build the kernel");
+      return;
+    }
+
+    kernel = clCreateKernel(program, name, &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+  }
+
+  ~ComputeData() {
+    if (kernel) {
+      ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseKernel(kernel));
+    }
+    for (auto mem : mems) {
+      ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseMemObject(mem));
+    }
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseProgram(program));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseCommandQueue(queue));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseContext(context));
+  }
+
+  // Set kernel argument `index` to a buffer initialized from `data`.
+  template <class T>
+  cl_mem buffer(cl_uint index, const std::vector<T> &data) {
+    cl_int status = CL_SUCCESS;
+    cl_mem mem = clCreateBuffer(
+        context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        sizeof(T) * data.size(), const_cast<T *>(data.data()), &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+    mems.push_back(mem);
+    arg(index, mem);
+    return mem;
+  }
+
+  // Set kernel argument `index` to a zero initialized buffer of `count`
+  // elements.
+  template <class T>
+  cl_mem buffer(cl_uint index, size_t count) {
+    return buffer(index, std::vector<T>(count));
+  }
+
+  // Set kernel argument `index` to a 2D RGBA float image initialized from
+  // `data`, or uninitialized if `data` is empty.
+  cl_mem image(cl_uint index, size_t width, size_t height,
+               const std::vector<cl_float> &data) {
+    const cl_image_format format = {CL_RGBA, CL_FLOAT};
+    cl_image_desc desc = {};
+    desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+    desc.image_width = width;
+    desc.image_height = height;
+
+    cl_int status = CL_SUCCESS;
+    cl_mem mem = clCreateImage(
+        context,
+        CL_MEM_READ_WRITE | (data.empty() ? 0 : CL_MEM_COPY_HOST_PTR),
+        &format, &desc,
+        data.empty() ? nullptr : const_cast<cl_float *>(data.data()), &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+    mems.push_back(mem);
+    arg(index, mem);
+    return mem;
+  }
+
+  template <class T>
+  void arg(cl_uint index, const T &value) {
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clSetKernelArg(kernel, index, sizeof(T), &value));
+  }
+
+  // Set kernel argument `index` to `size` bytes of local memory.
+  void local(cl_uint index, size_t size) {
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clSetKernelArg(kernel, index, size, nullptr));
+  }
+
+  template <class T>
+  std::vector<T> read(cl_mem mem, size_t count) {
+    std::vector<T> data(count);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clEnqueueReadBuffer(
+                                      queue, mem, CL_TRUE, 0, sizeof(T) * count,
+                                      data.data(), 0, nullptr, nullptr));
+    return data;
+  }
+
+  // Read back a 2D RGBA float image of `width` by `height` pixels.
+  std::vector<cl_float> readImage(cl_mem mem, size_t width, size_t height) {
+    std::vector<cl_float> data(width * height * 4);
+    const size_t origin[3] = {0, 0, 0};
+    const size_t region[3] = {width, height, 1};
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clEnqueueReadImage(queue, mem, CL_TRUE, origin, region,
+                                         0, 0, data.data(), 0, nullptr,
+                                         nullptr));
+    return data;
+  }
+
+  // Time the kernel over an ND-range, reporting `flops` floating point
+  // operations and `bytes` of global memory traffic per run.
+  void run(benchmark::State &state, cl_uint dims, const size_t *global,
+           const size_t *local, double flops, double bytes) {
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clEnqueueNDRangeKernel(queue, kernel, dims, nullptr,
+                                             global, local, 0, nullptr,
+                                             nullptr));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(queue));
+
+    for (auto _ : state) {
+      (void)_;
+      namespace chrono = std::chrono;
+      auto start = chrono::high_resolution_clock::now();
+
+      ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                        clEnqueueNDRangeKernel(queue, kernel, dims, nullptr,
+                                               global, local, 0, nullptr,
+                                               nullptr));
+      ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(queue));
+
+      auto end = chrono::high_resolution_clock::now();
+      auto elapsed =
+          chrono::duration_cast<chrono::duration<double>>(end - start);
+
+      state.SetIterationTime(elapsed.count());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(bytes));
+    if (flops > 0) {
+      state.counters["FLOPS"] = benchmark::Counter(
+          flops, benchmark::Counter::kIsIterationInvariantRate,
+          benchmark::Counter::kIs1000);
+    }
+  }
+
+  // Number of times `run` enqueued the kernel.
+  static size_t runs(const benchmark::State &state) {
+    return static_cast<size_t>(state.iterations()) + 1;
+  }
+};
+
+std::vector<cl_float> randomFloats(size_t count, unsigned seed = 42) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<cl_float> distribution(-1.0f, 1.0f);
+  std::vector<cl_float> data(count);
+  for (auto &value : data) {
+    value = distribution(generator);
+  }
+  return data;
+}
+
+std::vector<cl_uint> randomUints(size_t count, cl_uint max) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<cl_uint> distribution(0, max);
+  std::vector<cl_uint> data(count);
+  for (auto &value : data) {
+    value = distribution(generator);
+  }
+  return data;
+}
+
+bool nearlyEqual(cl_float actual, cl_float expected) {
+  return std::fabs(actual - expected) <=
+         1e-3f * std::max(1.0f, std::fabs(expected));
+}
+
+constexpr size_t GROUP_SIZE = 256;
+}  // namespace
+
+static void ComputeSgemm(benchmark::State &state) {
+  const char *source = R"CL(
+    #define TILE 16
+    kernel void sgemm(global const float *a, global const float *b,
+                      global float *c, uint n) {
+      local float ta[TILE][TILE];
+      local float tb[TILE][TILE];
+      const uint col = get_global_id(0);
+      const uint row = get_global_id(1);
+      const uint lx = get_local_id(0);
+      const uint ly = get_local_id(1);
+      float sum = 0.0f;
+      for (uint t = 0; t < n; t += TILE) {
+        ta[ly][lx] = a[row * n + t + lx];
+        tb[ly][lx] = b[(t + ly) * n + col];
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for (uint k = 0; k < TILE; k++) {
+          sum += ta[ly][k] * tb[k][lx];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+      }
+      c[row * n + col] = sum;
+    }
+  )CL";
+  ComputeData data(state, source, "sgemm");
+  if (!data.kernel) {
+    return;
+  }
+
+  const cl_uint n = static_cast<cl_uint>(state.range(0));
+  const auto a = randomFloats(n * n);
+  const auto b = randomFloats(n * n, 43);
+  data.buffer(0, a);
+  data.buffer(1, b);
+  cl_mem c = data.buffer<cl_float>(2, n * n);
+  data.arg(3, n);
+
+  const size_t global[2] = {n, n};
+  const size_t local[2] = {16, 16};
+  const double size = n;
+  data.run(state, 2, global, local, 2 * size * size * size,
+           3 * size * size * sizeof(cl_float));
+
+  const auto result = data.read<cl_float>(c, n * n);
+  // A full reference is too slow for the larger sizes, check a diagonal.
+  for (size_t i = 0; i < n; i++) {
+    cl_float expected = 0.0f;
+    for (size_t k = 0; k < n; k++) {
+      expected += a[i * n + k] * b[k * n + (n - 1 - i)];
+    }
+    if (!nearlyEqual(result[i * n + (n - 1 - i)], expected)) {
+      state.SkipWithError("Incorrect result");
+      return;
+    }
+  }
+}
+BENCHMARK(ComputeSgemm)
+    ->Arg(128)
+    ->Arg(256)
+    ->Arg(512)
+    ->Arg(1024)
+    ->UseManualTime();
+
+static void ComputeStencil2D(benchmark::State &state) {
+  const char *source = R"CL(
+    kernel void stencil(global const float *in, global float *out, uint n) {
+      const uint x = get_global_id(0);
+      const uint y = get_global_id(1);
+      const uint i = y * n + x;
+      if (x == 0 || y == 0 || x == n - 1 || y == n - 1) {
+        out[i] = in[i];
+      } else {
+        out[i] = 0.2f * (in[i] + in[i - 1] + in[i + 1] + in[i - n] +
+                         in[i + n]);
+      }
+    }
+  )CL";
+  ComputeData data(state, source, "stencil");
+  if (!data.kernel) {
+    return;
+  }
+
+  const cl_uint n = static_cast<cl_uint>(state.range(0));
+  const auto in = randomFloats(n * n);
+  data.buffer(0, in);
+  cl_mem out = data.buffer<cl_float>(1, n * n);
+  data.arg(2, n);
+
+  const size_t global[2] = {n, n};
+  const double interior = static_cast<double>(n - 2) * (n - 2);
+  data.run(state, 2, global, nullptr, 5 * interior,
+           2.0 * n * n * sizeof(cl_float));
+
+  const auto result = data.read<cl_float>(out, n * n);
+  for (size_t y = 1; y < n - 1; y++) {
+    for (size_t x = 1; x < n - 1; x++) {
+      const size_t i = y * n + x;
+      const cl_float expected =
+          0.2f * (in[i] + in[i - 1] + in[i + 1] + in[i - n] + in[i + n]);
+      if (!nearlyEqual(result[i], expected)) {
+        state.SkipWithError("Incorrect result");
+        return;
+      }
+    }
+  }
+}
+BENCHMARK(ComputeStencil2D)->Arg(512)->Arg(2048)->Arg(4096)->UseManualTime();
+
+static void ComputeStencil3D(benchmark::State &state) {
+  const char *source = R"CL(
+    kernel void stencil(global const float *in, global float *out, uint n) {
+      const uint x = get_global_id(0);
+      const uint y = get_global_id(1);
+      const uint z = get_global_id(2);
+      const uint i = (z * n + y) * n + x;
+      if (x == 0 || y == 0 || z == 0 ||
+          x == n - 1 || y == n - 1 || z == n - 1) {
+        out[i] = in[i];
+      } else {
+        const uint plane = n * n;
+        out[i] = (1.0f / 7.0f) * (in[i] + in[i - 1] + in[i + 1] + in[i - n] +
+                                  in[i + n] + in[i - plane] + in[i + plane]);
+      }
+    }
+  )CL";
+  ComputeData data(state, source, "stencil");
+  if (!data.kernel) {
+    return;
+  }
+
+  const cl_uint n = static_cast<cl_uint>(state.range(0));
+  const size_t count = static_cast<size_t>(n) * n * n;
+  const auto in = randomFloats(count);
+  data.buffer(0, in);
+  cl_mem out = data.buffer<cl_float>(1, count);
+  data.arg(2, n);
+
+  const size_t global[3] = {n, n, n};
+  const double interior = static_cast<double>(n - 2) * (n - 2) * (n - 2);
+  data.run(state, 3, global, nullptr, 7 * interior,
+           2.0 * count * sizeof(cl_float));
+
+  const auto result = data.read<cl_float>(out, count);
+  const size_t plane = static_cast<size_t>(n) * n;
+  for (size_t z = 1; z < n - 1; z++) {
+    for (size_t y = 1; y < n - 1; y++) {
+      for (size_t x = 1; x < n - 1; x++) {
+        const size_t i = (z * n + y) * n + x;
+        const cl_float expected =
+            (1.0f / 7.0f) * (in[i] + in[i - 1] + in[i + 1] + in[i - n] +
+                             in[i + n] + in[i - plane] + in[i + plane]);
+        if (!nearlyEqual(result[i], expected)) {
+          state.SkipWithError("Incorrect result");
+          return;
+        }
+      }
+    }
+  }
+}
+BENCHMARK(ComputeStencil3D)->Arg(64)->Arg(128)->Arg(256)->UseManualTime();
+
+static void ComputeReduce(benchmark::State &state) {
+  const char *source = R"CL(
+    kernel void reduce(global const uint *in, global uint *out,
+                       local uint *scratch) {
+      const uint lid = get_local_id(0);
+      scratch[lid] = in[get_global_id(0)];
+      barrier(CLK_LOCAL_MEM_FENCE);
+      for (uint stride = get_local_size(0) / 2; stride > 0; stride /= 2) {
+        if (lid < stride) {
+          scratch[lid] += scratch[lid + stride];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+      }
+      if (0 == lid) {
+        out[get_group_id(0)] = scratch[0];
+      }
+    }
+  )CL";
+  ComputeData data(state, source, "reduce");
+  if (!data.kernel) {
+    return;
+  }
+
+  const size_t count = static_cast<size_t>(state.range(0));
+  const size_t groups = count / GROUP_SIZE;
+  const auto in = randomUints(count, 1000);
+  data.buffer(0, in);
+  cl_mem out = data.buffer<cl_uint>(1, groups);
+  data.local(2, GROUP_SIZE * sizeof(cl_uint));
+
+  data.run(state, 1, &count, &GROUP_SIZE, 0,
+           static_cast<double>(count + groups) * sizeof(cl_uint));
+
+  const auto result = data.read<cl_uint>(out, groups);
+  for (size_t group = 0; group < groups; group++) {
+    cl_uint expected = 0;
+    for (size_t i = 0; i < GROUP_SIZE; i++) {
+      expected += in[group * GROUP_SIZE + i];
+    }
+    if (result[group] != expected) {
+      state.SkipWithError("Incorrect result");
+      return;
+    }
+  }
+}
+BENCHMARK(ComputeReduce)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24)
+    ->UseManualTime();
+
+static void ComputeScan(benchmark::State &state) {
+  // An inclusive scan of each work-group, also writing the group's total so
+  // that a second pass could scan across groups.
+  const char *source = R"CL(
+    kernel void scan(global const uint *in, global uint *out,
+                     global uint *sums, local uint *scratch) {
+      const uint lid = get_local_id(0);
+      const uint size = get_local_size(0);
+      scratch[lid] = in[get_global_id(0)];
+      barrier(CLK_LOCAL_MEM_FENCE);
+      for (uint offset = 1; offset < size; offset *= 2) {
+        const uint value = lid >= offset ? scratch[lid - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        scratch[lid] += value;
+        barrier(CLK_LOCAL_MEM_FENCE);
+      }
+      out[get_global_id(0)] = scratch[lid];
+      if (lid == size - 1) {
+        sums[get_group_id(0)] = scratch[lid];
+      }
+    }
+  )CL";
+  ComputeData data(state, source, "scan");
+  if (!data.kernel) {
+    return;
+  }
+
+  const size_t count = static_cast<size_t>(state.range(0));
+  const size_t groups = count / GROUP_SIZE;
+  const auto in = randomUints(count, 1000);
+  data.buffer(0, in);
+  cl_mem out = data.buffer<cl_uint>(1, count);
+  data.buffer<cl_uint>(2, groups);
+  data.local(3, GROUP_SIZE * sizeof(cl_uint));
+
+  data.run(state, 1, &count, &GROUP_SIZE, 0,
+           static_cast<double>(2 * count + groups) * sizeof(cl_uint));
+
+  const auto result = data.read<cl_uint>(out, count);
+  cl_uint expected = 0;
+  for (size_t i = 0; i < count; i++) {
+    expected = (0 == i % GROUP_SIZE ? 0 : expected) + in[i];
+    if (result[i] != expected) {
+      state.SkipWithError("Incorrect result");
+      return;
+    }
+  }
+}
+BENCHMARK(ComputeScan)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24)
+    ->UseManualTime();
+
+static void ComputeHistogram(benchmark::State &state) {
+  // Each work-group builds a histogram in local memory with atomics, then
+  // merges it into the global histogram.
+  const char *source = R"CL(
+    #define BINS 256
+    kernel void histogram(global const uint *in, global uint *bins) {
+      local uint local_bins[BINS];
+      const uint lid = get_local_id(0);
+      for (uint i = lid; i < BINS; i += get_local_size(0)) {
+        local_bins[i] = 0;
+      }
+      barrier(CLK_LOCAL_MEM_FENCE);
+      atomic_inc(&local_bins[in[get_global_id(0)] % BINS]);
+      barrier(CLK_LOCAL_MEM_FENCE);
+      for (uint i = lid; i < BINS; i += get_local_size(0)) {
+        if (local_bins[i]) {
+          atomic_add(&bins[i], local_bins[i]);
+        }
+      }
+    }
+  )CL";
+  ComputeData data(state, source, "histogram");
+  if (!data.kernel) {
+    return;
+  }
+
+  constexpr size_t bins_count = 256;
+  const size_t count = static_cast<size_t>(state.range(0));
+  // Values are clustered so that some bins are contended much more than
+  // others, as in a histogram of real data.
+  auto in = randomUints(count, 0xffff);
+  for (auto &value : in) {
+    value = (value * value) >> 24;
+  }
+  data.buffer(0, in);
+  cl_mem bins = data.buffer<cl_uint>(1, bins_count);
+
+  data.run(state, 1, &count, &GROUP_SIZE, 0,
+           static_cast<double>(count) * sizeof(cl_uint));
+
+  // Every run accumulates into the same global histogram.
+  const auto result = data.read<cl_uint>(bins, bins_count);
+  std::vector<cl_uint> expected(bins_count);
+  for (const auto value : in) {
+    expected[value % bins_count]++;
+  }
+  const size_t runs = ComputeData::runs(state);
+  for (size_t i = 0; i < bins_count; i++) {
+    if (result[i] != static_cast<cl_uint>(expected[i] * runs)) {
+      state.SkipWithError("Incorrect result");
+      return;
+    }
+  }
+}
+BENCHMARK(ComputeHistogram)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24)
+    ->UseManualTime();
+
+static void ComputeConvolution(benchmark::State &state) {
+  auto device = benchcl::env::get()->device;
+  cl_bool image_support = CL_FALSE;
+  ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                    clGetDeviceInfo(device, CL_DEVICE_IMAGE_SUPPORT,
+                                    sizeof(image_support), &image_support,
+                                    nullptr));
+  if (!image_support) {
+    state.SkipWithError("Device does not support images");
+    return;
+  }
+
+  const char *source = R"CL(
+    const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE |
+                              CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
+    kernel void convolve(read_only image2d_t in, write_only image2d_t out,
+                         constant float *filter, int radius) {
+      const int2 pos = (int2)(get_global_id(0), get_global_id(1));
+      const int width = 2 * radius + 1;
+      float4 sum = 0.0f;
+      for (int y = -radius; y <= radius; y++) {
+        for (int x = -radius; x <= radius; x++) {
+          sum += filter[(y + radius) * width + x + radius] *
+                 read_imagef(in, sampler, pos + (int2)(x, y));
+        }
+      }
+      write_imagef(out, pos, sum);
+    }
+  )CL";
+  ComputeData data(state, source, "convolve");
+  if (!data.kernel) {
+    return;
+  }
+
+  constexpr cl_int radius = 2;
+  constexpr size_t taps = (2 * radius + 1) * (2 * radius + 1);
+  const size_t n = static_cast<size_t>(state.range(0));
+  const auto in = randomFloats(n * n * 4);
+  const std::vector<cl_float> filter(taps, 1.0f / taps);
+  data.image(0, n, n, in);
+  cl_mem out = data.image(1, n, n, {});
+  data.buffer(2, filter);
+  data.arg(3, radius);
+
+  const size_t global[2] = {n, n};
+  const double pixels = static_cast<double>(n) * n;
+  data.run(state, 2, global, nullptr, pixels * taps * 4 * 2,
+           pixels * 2 * 4 * sizeof(cl_float));
+
+  const auto result = data.readImage(out, n, n);
+  // Check a diagonal, which also covers the clamped corners.
+  const auto clamp = [n](size_t p, cl_int offset) {
+    const cl_long last = static_cast<cl_long>(n) - 1;
+    const cl_long c = static_cast<cl_long>(p) + offset;
+    return static_cast<size_t>(std::min(std::max<cl_long>(c, 0), last));
+  };
+  for (size_t i = 0; i < n; i++) {
+    for (size_t channel = 0; channel < 4; channel++) {
+      cl_float expected = 0.0f;
+      for (cl_int y = -radius; y <= radius; y++) {
+        for (cl_int x = -radius; x <= radius; x++) {
+          expected += filter[(y + radius) * (2 * radius + 1) + x + radius] *
+                      in[(clamp(i, y) * n + clamp(i, x)) * 4 + channel];
+        }
+      }
+      if (!nearlyEqual(result[(i * n + i) * 4 + channel], expected)) {
+        state.SkipWithError("Incorrect result");
+        return;
+      }
+    }
+  }
+}
+BENCHMARK(ComputeConvolution)->Arg(256)->Arg(1024)->Arg(2048)->UseManualTime();
+
+static void ComputeSpmv(benchmark::State &state) {
+  // Multiply a matrix in compressed sparse row format by a dense vector.
+  const char *source = R"CL(
+    kernel void spmv(global const uint *row_offsets,
+                     global const uint *columns, global const float *values,
+                     global const float *x, global float *y) {
+      const uint row = get_global_id(0);
+      float sum = 0.0f;
+      for (uint i = row_offsets[row]; i < row_offsets[row + 1]; i++) {
+        sum += values[i] * x[columns[i]];
+      }
+      y[row] = sum;
+    }
+  )CL";
+  ComputeData data(state, source, "spmv");
+  if (!data.kernel) {
+    return;
+  }
+
+  // Rows have between 8 and 24 non-zeros, mostly near the diagonal with some
+  // scattered across the row, roughly the shape of a finite element matrix.
+  const size_t rows = static_cast<size_t>(state.range(0));
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<cl_uint> row_length(8, 24);
+  std::uniform_int_distribution<cl_uint> near(0, 63);
+  std::uniform_int_distribution<cl_uint> far(
+      0, static_cast<cl_uint>(rows - 1));
+  std::vector<cl_uint> row_offsets(1, 0);
+  std::vector<cl_uint> columns;
+  for (size_t row = 0; row < rows; row++) {
+    const cl_uint length = row_length(generator);
+    for (cl_uint i = 0; i < length; i++) {
+      const cl_uint column =
+          0 == i % 4 ? far(generator)
+                     : static_cast<cl_uint>((row + near(generator)) % rows);
+      columns.push_back(column);
+    }
+    row_offsets.push_back(static_cast<cl_uint>(columns.size()));
+  }
+  const size_t nonzeros = columns.size();
+  const auto values = randomFloats(nonzeros);
+  const auto x = randomFloats(rows);
+
+  data.buffer(0, row_offsets);
+  data.buffer(1, columns);
+  data.buffer(2, values);
+  data.buffer(3, x);
+  cl_mem y = data.buffer<cl_float>(4, rows);
+
+  data.run(state, 1, &rows, nullptr, 2.0 * nonzeros,
+           static_cast<double>(nonzeros) *
+                   (sizeof(cl_uint) + sizeof(cl_float)) +
+               static_cast<double>(rows + 1) * sizeof(cl_uint) +
+               2.0 * rows * sizeof(cl_float));
+
+  const auto result = data.read<cl_float>(y, rows);
+  for (size_t row = 0; row < rows; row++) {
+    cl_float expected = 0.0f;
+    for (cl_uint i = row_offsets[row]; i < row_offsets[row + 1]; i++) {
+      expected += values[i] * x[columns[i]];
+    }
+    if (!nearlyEqual(result[row], expected)) {
+      state.SkipWithError("Incorrect result");
+      return;
+    }
+  }
+}
+BENCHMARK(ComputeSpmv)
+    ->Arg(1 << 12)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->UseManualTime();
@@ -0,0 +1,241 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <BenchCL/environment.h>
+#include <BenchCL/error.h>
+#include <CL/cl.h>
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+// Two RGBA8 images of width and height state.range(0), and depth
+// state.range(1) for 3D images, plus a buffer and host allocation big enough to
+// hold a whole image.
+struct ImageData {
+  static constexpr size_t PIXEL_SIZE = 4;
+
+  cl_context context = nullptr;
+  cl_command_queue queue = nullptr;
+  cl_mem src = nullptr;
+  cl_mem dst = nullptr;
+  cl_mem buffer = nullptr;
+  size_t region[3] = {1, 1, 1};
+  size_t size = 0;
+  std::vector<cl_uchar> host;
+
+  ImageData(benchmark::State &state, cl_mem_object_type type) {
+    auto device = benchcl::env::get()->device;
+
+    cl_bool image_support = CL_FALSE;
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clGetDeviceInfo(device, CL_DEVICE_IMAGE_SUPPORT,
+                                      sizeof(image_support), &image_support,
+                                      nullptr));
+    if (!image_support) {
+      state.SkipWithError("Device does not support images");
+      return;
+    }
+
+    cl_int status = CL_SUCCESS;
+    context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+    queue = clCreateCommandQueue(context, device, 0, &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+    region[0] = static_cast<size_t>(state.range(0));
+    region[1] = region[0];
+    if (CL_MEM_OBJECT_IMAGE3D == type) {
+      region[2] = static_cast<size_t>(state.range(1));
+    }
+    size = region[0] * region[1] * region[2] * PIXEL_SIZE;
+    host.resize(size);
+
+    const cl_image_format format = {CL_RGBA, CL_UNORM_INT8};
+    cl_image_desc desc = {};
+    desc.image_type = type;
+    desc.image_width = region[0];
+    desc.image_height = region[1];
+    desc.image_depth = region[2];
+
+    src = clCreateImage(context, CL_MEM_READ_WRITE, &format, &desc, nullptr,
+                        &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+    dst = clCreateImage(context, CL_MEM_READ_WRITE, &format, &desc, nullptr,
+                        &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, size, nullptr, &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+  }
+
+  ~ImageData() {
+    if (buffer) {
+      ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseMemObject(buffer));
+    }
+    if (dst) {
+      ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseMemObject(dst));
+    }
+    if (src) {
+      ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseMemObject(src));
+    }
+    if (queue) {
+      ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseCommandQueue(queue));
+    }
+    if (context) {
+      ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseContext(context));
+    }
+  }
+};
+
+const size_t origin[3] = {0, 0, 0};
+}  // namespace
+
+static void ImageRead(benchmark::State &state, cl_mem_object_type type) {
+  ImageData data(state, type);
+  if (!data.context) {
+    return;
+  }
+
+  for (auto _ : state) {
+    (void)_;
+    ASSERT_EQ_ERRCODE(
+        CL_SUCCESS,
+        clEnqueueReadImage(data.queue, data.src, CL_TRUE, origin, data.region,
+                           0, 0, data.host.data(), 0, nullptr, nullptr));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size));
+}
+BENCHMARK_CAPTURE(ImageRead, 2D, CL_MEM_OBJECT_IMAGE2D)
+    ->Args({256, 1})
+    ->Args({1024, 1})
+    ->Args({3840, 1});
+BENCHMARK_CAPTURE(ImageRead, 3D, CL_MEM_OBJECT_IMAGE3D)->Args({128, 128});
+
+static void ImageWrite(benchmark::State &state, cl_mem_object_type type) {
+  ImageData data(state, type);
+  if (!data.context) {
+    return;
+  }
+
+  for (auto _ : state) {
+    (void)_;
+    ASSERT_EQ_ERRCODE(
+        CL_SUCCESS,
+        clEnqueueWriteImage(data.queue, data.src, CL_TRUE, origin, data.region,
+                            0, 0, data.host.data(), 0, nullptr, nullptr));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size));
+}
+BENCHMARK_CAPTURE(ImageWrite, 2D, CL_MEM_OBJECT_IMAGE2D)
+    ->Args({256, 1})
+    ->Args({1024, 1})
+    ->Args({3840, 1});
+BENCHMARK_CAPTURE(ImageWrite, 3D, CL_MEM_OBJECT_IMAGE3D)->Args({128, 128});
+
+static void ImageFill(benchmark::State &state, cl_mem_object_type type) {
+  ImageData data(state, type);
+  if (!data.context) {
+    return;
+  }
+
+  const cl_float color[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+  for (auto _ : state) {
+    (void)_;
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clEnqueueFillImage(data.queue, data.src, color, origin,
+                                         data.region, 0, nullptr, nullptr));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(data.queue));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size));
+}
+BENCHMARK_CAPTURE(ImageFill, 2D, CL_MEM_OBJECT_IMAGE2D)
+    ->Args({256, 1})
+    ->Args({1024, 1})
+    ->Args({3840, 1});
+BENCHMARK_CAPTURE(ImageFill, 3D, CL_MEM_OBJECT_IMAGE3D)->Args({128, 128});
+
+static void ImageCopy(benchmark::State &state, cl_mem_object_type type) {
+  ImageData data(state, type);
+  if (!data.context) {
+    return;
+  }
+
+  for (auto _ : state) {
+    (void)_;
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clEnqueueCopyImage(data.queue, data.src, data.dst, origin,
+                                         origin, data.region, 0, nullptr,
+                                         nullptr));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(data.queue));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size));
+}
+BENCHMARK_CAPTURE(ImageCopy, 2D, CL_MEM_OBJECT_IMAGE2D)
+    ->Args({256, 1})
+    ->Args({1024, 1})
+    ->Args({3840, 1});
+BENCHMARK_CAPTURE(ImageCopy, 3D, CL_MEM_OBJECT_IMAGE3D)->Args({128, 128});
+
+static void ImageCopyToBuffer(benchmark::State &state,
+                              cl_mem_object_type type) {
+  ImageData data(state, type);
+  if (!data.context) {
+    return;
+  }
+
+  for (auto _ : state) {
+    (void)_;
+    ASSERT_EQ_ERRCODE(
+        CL_SUCCESS,
+        clEnqueueCopyImageToBuffer(data.queue, data.src, data.buffer, origin,
+                                   data.region, 0, 0, nullptr, nullptr));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(data.queue));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size));
+}
+BENCHMARK_CAPTURE(ImageCopyToBuffer, 2D, CL_MEM_OBJECT_IMAGE2D)
+    ->Args({3840, 1});
+BENCHMARK_CAPTURE(ImageCopyToBuffer, 3D, CL_MEM_OBJECT_IMAGE3D)
+    ->Args({128, 128});
+
+static void ImageCopyFromBuffer(benchmark::State &state,
+                                cl_mem_object_type type) {
+  ImageData data(state, type);
+  if (!data.context) {
+    return;
+  }
+
+  for (auto _ : state) {
+    (void)_;
+    ASSERT_EQ_ERRCODE(
+        CL_SUCCESS,
+        clEnqueueCopyBufferToImage(data.queue, data.buffer, data.src, 0,
+                                   origin, data.region, 0, nullptr, nullptr));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(data.queue));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size));
+}
+BENCHMARK_CAPTURE(ImageCopyFromBuffer, 2D, CL_MEM_OBJECT_IMAGE2D)
+    ->Args({3840, 1});
+BENCHMARK_CAPTURE(ImageCopyFromBuffer, 3D, CL_MEM_OBJECT_IMAGE3D)
+    ->Args({128, 128});
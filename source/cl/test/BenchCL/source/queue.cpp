@@ -21,6 +21,7 @@
 
 #include <string>
 #include <thread>
+#include <vector>
 
 struct CreateData {
   enum { BUFFER_LENGTH = 16384, BUFFER_SIZE = BUFFER_LENGTH * sizeof(cl_int) };
@@ -251,3 +252,49 @@ BENCHMARK(MultiThreadMultiQueue)
     ->Arg(256)
     ->Arg(1024)
     ->Threads(std::thread::hardware_concurrency());
+
+// Compare the time taken by kernels, by transfers to a buffer the kernels
+// don't use, and by both interleaved on the same queue. When the device can
+// overlap transfers with kernel execution the interleaved case takes less than
+// the sum of the other two.
+static void OneQueueKernelTransferOverlap(benchmark::State &state,
+                                          bool kernels, bool transfers) {
+  const CreateData cd;
+
+  cl_int status = CL_SUCCESS;
+  cl_mem unrelated = clCreateBuffer(cd.context, CL_MEM_READ_WRITE,
+                                    CreateData::BUFFER_SIZE, nullptr, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+  std::vector<cl_int> host(CreateData::BUFFER_LENGTH, 42);
+
+  for (auto _ : state) {
+    (void)_;
+    for (unsigned i = 0; i < state.range(0); i++) {
+      if (kernels) {
+        const size_t size = CreateData::BUFFER_LENGTH;
+        clEnqueueNDRangeKernel(cd.queue, cd.kernel, 1, nullptr, &size, nullptr,
+                               0, nullptr, nullptr);
+      }
+      if (transfers) {
+        clEnqueueWriteBuffer(cd.queue, unrelated, CL_FALSE, 0,
+                             CreateData::BUFFER_SIZE, host.data(), 0, nullptr,
+                             nullptr);
+      }
+    }
+
+    clFinish(cd.queue);
+  }
+
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseMemObject(unrelated));
+
+  state.SetItemsProcessed(state.range(0));
+}
+BENCHMARK_CAPTURE(OneQueueKernelTransferOverlap, KernelOnly, true, false)
+    ->Arg(1)
+    ->Arg(256);
+BENCHMARK_CAPTURE(OneQueueKernelTransferOverlap, TransferOnly, false, true)
+    ->Arg(1)
+    ->Arg(256);
+BENCHMARK_CAPTURE(OneQueueKernelTransferOverlap, KernelAndTransfer, true, true)
+    ->Arg(1)
+    ->Arg(256);
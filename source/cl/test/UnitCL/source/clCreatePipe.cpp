@@ -23,13 +23,21 @@ class clCreatePipeTest : public ucl::ContextTest {
     if (!UCL::isDeviceVersionAtLeast({3, 0})) {
       GTEST_SKIP();
     }
+    ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_PIPE_SUPPORT,
+                                   sizeof(pipe_support), &pipe_support,
+                                   nullptr));
+    if (CL_FALSE != pipe_support) {
+      ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_PIPE_MAX_PACKET_SIZE,
+                                     sizeof(max_packet_size), &max_packet_size,
+                                     nullptr));
+    }
   }
+
+  cl_bool pipe_support = CL_FALSE;
+  cl_uint max_packet_size = 0;
 };
 
 TEST_F(clCreatePipeTest, NotImplemented) {
-  cl_bool pipe_support{};
-  ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_PIPE_SUPPORT,
-                                 sizeof(pipe_support), &pipe_support, nullptr));
   if (CL_FALSE != pipe_support) {
     // Since we test against other implementations that may implement this
     // but we aren't actually testing the functionality, just skip.
@@ -45,3 +53,125 @@ TEST_F(clCreatePipeTest, NotImplemented) {
             nullptr);
   EXPECT_EQ_ERRCODE(CL_INVALID_OPERATION, errcode);
 }
+
+TEST_F(clCreatePipeTest, Default) {
+  if (CL_FALSE == pipe_support) {
+    GTEST_SKIP();
+  }
+  cl_int errcode = !CL_SUCCESS;
+  cl_mem pipe = clCreatePipe(context, 0, sizeof(cl_int), 16, nullptr, &errcode);
+  ASSERT_SUCCESS(errcode);
+  ASSERT_NE(nullptr, pipe);
+
+  cl_mem_object_type type = 0;
+  ASSERT_SUCCESS(
+      clGetMemObjectInfo(pipe, CL_MEM_TYPE, sizeof(type), &type, nullptr));
+  EXPECT_EQ(CL_MEM_OBJECT_PIPE, type);
+  cl_mem_flags flags = 0;
+  ASSERT_SUCCESS(
+      clGetMemObjectInfo(pipe, CL_MEM_FLAGS, sizeof(flags), &flags, nullptr));
+  EXPECT_EQ(CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS, flags);
+  EXPECT_SUCCESS(clReleaseMemObject(pipe));
+}
+
+TEST_F(clCreatePipeTest, Flags) {
+  if (CL_FALSE == pipe_support) {
+    GTEST_SKIP();
+  }
+  for (const cl_mem_flags flags :
+       {cl_mem_flags(CL_MEM_READ_WRITE), cl_mem_flags(CL_MEM_HOST_NO_ACCESS),
+        cl_mem_flags(CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS)}) {
+    cl_int errcode = !CL_SUCCESS;
+    cl_mem pipe =
+        clCreatePipe(context, flags, sizeof(cl_int), 16, nullptr, &errcode);
+    EXPECT_SUCCESS(errcode);
+    ASSERT_NE(nullptr, pipe);
+    EXPECT_SUCCESS(clReleaseMemObject(pipe));
+  }
+}
+
+TEST_F(clCreatePipeTest, EmptyProperties) {
+  if (CL_FALSE == pipe_support) {
+    GTEST_SKIP();
+  }
+  const cl_pipe_properties properties[] = {0};
+  cl_int errcode = !CL_SUCCESS;
+  cl_mem pipe =
+      clCreatePipe(context, 0, sizeof(cl_int), 16, properties, &errcode);
+  EXPECT_SUCCESS(errcode);
+  ASSERT_NE(nullptr, pipe);
+  EXPECT_SUCCESS(clReleaseMemObject(pipe));
+}
+
+TEST_F(clCreatePipeTest, MaxPacketSize) {
+  if (CL_FALSE == pipe_support) {
+    GTEST_SKIP();
+  }
+  cl_int errcode = !CL_SUCCESS;
+  cl_mem pipe = clCreatePipe(context, 0, max_packet_size, 4, nullptr, &errcode);
+  EXPECT_SUCCESS(errcode);
+  ASSERT_NE(nullptr, pipe);
+  EXPECT_SUCCESS(clReleaseMemObject(pipe));
+}
+
+TEST_F(clCreatePipeTest, InvalidContext) {
+  if (CL_FALSE == pipe_support) {
+    GTEST_SKIP();
+  }
+  cl_int errcode = CL_SUCCESS;
+  EXPECT_EQ(nullptr,
+            clCreatePipe(nullptr, 0, sizeof(cl_int), 16, nullptr, &errcode));
+  EXPECT_EQ_ERRCODE(CL_INVALID_CONTEXT, errcode);
+}
+
+TEST_F(clCreatePipeTest, InvalidValueFlags) {
+  if (CL_FALSE == pipe_support) {
+    GTEST_SKIP();
+  }
+  // Pipes are only accessed by kernels, which both read and write them.
+  for (const cl_mem_flags flags :
+       {cl_mem_flags(CL_MEM_READ_ONLY), cl_mem_flags(CL_MEM_WRITE_ONLY),
+        cl_mem_flags(CL_MEM_ALLOC_HOST_PTR),
+        cl_mem_flags(CL_MEM_HOST_READ_ONLY)}) {
+    cl_int errcode = CL_SUCCESS;
+    EXPECT_EQ(nullptr, clCreatePipe(context, flags, sizeof(cl_int), 16,
+                                    nullptr, &errcode));
+    EXPECT_EQ_ERRCODE(CL_INVALID_VALUE, errcode);
+  }
+}
+
+TEST_F(clCreatePipeTest, InvalidValueProperties) {
+  if (CL_FALSE == pipe_support) {
+    GTEST_SKIP();
+  }
+  const cl_pipe_properties properties[] = {1, 0};
+  cl_int errcode = CL_SUCCESS;
+  EXPECT_EQ(nullptr, clCreatePipe(context, 0, sizeof(cl_int), 16, properties,
+                                  &errcode));
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE, errcode);
+}
+
+TEST_F(clCreatePipeTest, InvalidPipeSize) {
+  if (CL_FALSE == pipe_support) {
+    GTEST_SKIP();
+  }
+  cl_int errcode = CL_SUCCESS;
+  EXPECT_EQ(nullptr, clCreatePipe(context, 0, 0, 16, nullptr, &errcode));
+  EXPECT_EQ_ERRCODE(CL_INVALID_PIPE_SIZE, errcode);
+
+  errcode = CL_SUCCESS;
+  EXPECT_EQ(nullptr,
+            clCreatePipe(context, 0, sizeof(cl_int), 0, nullptr, &errcode));
+  EXPECT_EQ_ERRCODE(CL_INVALID_PIPE_SIZE, errcode);
+
+  errcode = CL_SUCCESS;
+  EXPECT_EQ(nullptr, clCreatePipe(context, 0, max_packet_size + 1, 16, nullptr,
+                                  &errcode));
+  EXPECT_EQ_ERRCODE(CL_INVALID_PIPE_SIZE, errcode);
+
+  // The pipe's storage can't be larger than the device can allocate.
+  errcode = CL_SUCCESS;
+  EXPECT_EQ(nullptr, clCreatePipe(context, 0, max_packet_size, CL_UINT_MAX,
+                                  nullptr, &errcode));
+  EXPECT_EQ_ERRCODE(CL_INVALID_PIPE_SIZE, errcode);
+}
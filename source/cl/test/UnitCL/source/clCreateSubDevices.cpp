@@ -81,3 +81,119 @@ TEST_F(clCreateSubDevicesTest, DevicePartitionByCounts) {
     ASSERT_SUCCESS(clReleaseDevice(*iter));
   }
 }
+
+TEST_F(clCreateSubDevicesTest, DevicePartitionByAffinityDomainNuma) {
+  if (!UCL::hasDevicePartitionSupport(device,
+                                      CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN)) {
+    GTEST_SKIP();
+  }
+  cl_device_affinity_domain domains = 0;
+  ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_PARTITION_AFFINITY_DOMAIN,
+                                 sizeof(domains), &domains, nullptr));
+  if (!(domains & CL_DEVICE_AFFINITY_DOMAIN_NUMA)) {
+    GTEST_SKIP();
+  }
+  cl_device_partition_property properties[] = {
+      CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN, CL_DEVICE_AFFINITY_DOMAIN_NUMA,
+      0};
+  cl_uint numSubDevices = 0;
+  EXPECT_SUCCESS(
+      clCreateSubDevices(device, properties, 0, nullptr, &numSubDevices));
+  ASSERT_GT(numSubDevices, 0u);
+  UCL::vector<cl_device_id> subDevices(numSubDevices);
+  ASSERT_SUCCESS(clCreateSubDevices(device, properties, numSubDevices,
+                                    subDevices.data(), nullptr));
+  cl_uint totalComputeUnits = 0;
+  for (auto subDevice : subDevices) {
+    cl_uint computeUnits = 0;
+    ASSERT_SUCCESS(clGetDeviceInfo(subDevice, CL_DEVICE_MAX_COMPUTE_UNITS,
+                                   sizeof(computeUnits), &computeUnits,
+                                   nullptr));
+    EXPECT_GT(computeUnits, 0u);
+    totalComputeUnits += computeUnits;
+  }
+  cl_uint maxComputeUnits = 0;
+  ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS,
+                                 sizeof(maxComputeUnits), &maxComputeUnits,
+                                 nullptr));
+  EXPECT_EQ(maxComputeUnits, totalComputeUnits);
+  for (auto subDevice : subDevices) {
+    ASSERT_SUCCESS(clReleaseDevice(subDevice));
+  }
+}
+
+TEST_F(clCreateSubDevicesTest, SubDeviceInfo) {
+  if (!UCL::hasDevicePartitionSupport(device, CL_DEVICE_PARTITION_BY_COUNTS)) {
+    GTEST_SKIP();
+  }
+  cl_device_partition_property properties[] = {
+      CL_DEVICE_PARTITION_BY_COUNTS,
+      static_cast<cl_device_partition_property>(1),
+      CL_DEVICE_PARTITION_BY_COUNTS_LIST_END, 0};
+  cl_device_id subDevice = nullptr;
+  ASSERT_SUCCESS(
+      clCreateSubDevices(device, properties, 1, &subDevice, nullptr));
+  cl_device_id parent = nullptr;
+  ASSERT_SUCCESS(clGetDeviceInfo(subDevice, CL_DEVICE_PARENT_DEVICE,
+                                 sizeof(parent), &parent, nullptr));
+  EXPECT_EQ(device, parent);
+  cl_uint computeUnits = 0;
+  ASSERT_SUCCESS(clGetDeviceInfo(subDevice, CL_DEVICE_MAX_COMPUTE_UNITS,
+                                 sizeof(computeUnits), &computeUnits, nullptr));
+  EXPECT_EQ(1u, computeUnits);
+  size_t size = 0;
+  ASSERT_SUCCESS(
+      clGetDeviceInfo(subDevice, CL_DEVICE_PARTITION_TYPE, 0, nullptr, &size));
+  ASSERT_EQ(sizeof(properties), size);
+  cl_device_partition_property partitionType[4] = {};
+  ASSERT_SUCCESS(clGetDeviceInfo(subDevice, CL_DEVICE_PARTITION_TYPE, size,
+                                 partitionType, nullptr));
+  for (size_t index = 0; index < 4; index++) {
+    EXPECT_EQ(properties[index], partitionType[index]);
+  }
+  cl_uint referenceCount = 0;
+  ASSERT_SUCCESS(clRetainDevice(subDevice));
+  ASSERT_SUCCESS(clGetDeviceInfo(subDevice, CL_DEVICE_REFERENCE_COUNT,
+                                 sizeof(referenceCount), &referenceCount,
+                                 nullptr));
+  EXPECT_EQ(2u, referenceCount);
+  ASSERT_SUCCESS(clReleaseDevice(subDevice));
+  ASSERT_SUCCESS(clReleaseDevice(subDevice));
+}
+
+TEST_F(clCreateSubDevicesTest, ReleasedSubDevice) {
+  if (!UCL::hasDevicePartitionSupport(device, CL_DEVICE_PARTITION_BY_COUNTS)) {
+    GTEST_SKIP();
+  }
+  cl_device_partition_property properties[] = {
+      CL_DEVICE_PARTITION_BY_COUNTS,
+      static_cast<cl_device_partition_property>(1),
+      CL_DEVICE_PARTITION_BY_COUNTS_LIST_END, 0};
+  cl_device_id subDevice = nullptr;
+  ASSERT_SUCCESS(
+      clCreateSubDevices(device, properties, 1, &subDevice, nullptr));
+  ASSERT_SUCCESS(clReleaseDevice(subDevice));
+  // The handle no longer refers to a sub-device, so must be rejected rather
+  // than have its reference count changed.
+  EXPECT_EQ_ERRCODE(CL_INVALID_DEVICE, clRetainDevice(subDevice));
+  EXPECT_EQ_ERRCODE(CL_INVALID_DEVICE, clReleaseDevice(subDevice));
+}
+
+TEST_F(clCreateSubDevicesTest, InvalidDevicePartitionCount) {
+  if (!UCL::hasDevicePartitionSupport(device, CL_DEVICE_PARTITION_BY_COUNTS)) {
+    GTEST_SKIP();
+  }
+  cl_uint maxComputeUnits = 0;
+  ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS,
+                                 sizeof(maxComputeUnits), &maxComputeUnits,
+                                 nullptr));
+  cl_device_partition_property properties[] = {
+      CL_DEVICE_PARTITION_BY_COUNTS,
+      static_cast<cl_device_partition_property>(maxComputeUnits + 1),
+      CL_DEVICE_PARTITION_BY_COUNTS_LIST_END, 0};
+  cl_device_id subDevice = nullptr;
+  EXPECT_EQ_ERRCODE(
+      CL_INVALID_DEVICE_PARTITION_COUNT,
+      clCreateSubDevices(device, properties, 1, &subDevice, nullptr));
+  ASSERT_FALSE(subDevice);
+}
@@ -277,6 +277,46 @@ TEST_F(clEnqueueMapBufferTestHostPtr, DefaultWriteInvalidateHostPtr) {
     EXPECT_EQ(-i, outBuffer[i]);
   }
 }
+
+TEST_F(clEnqueueMapBufferTestHostPtr, DefaultReadHostPtr) {
+  cl_int errcode = !CL_SUCCESS;
+  int *const map = reinterpret_cast<int *>(
+      clEnqueueMapBuffer(command_queue, inMem, CL_TRUE, CL_MAP_READ, 0,
+                         int_size, 1, &writeEvent, &mapEvent, &errcode));
+  ASSERT_SUCCESS(errcode);
+  // The mapped pointer must be derived from the unaligned host_ptr.
+  EXPECT_EQ(hostBuffer.data() + 1, map);
+
+  for (cl_int i = 0; i < static_cast<cl_int>(size); i++) {
+    EXPECT_EQ(i, map[i]);
+  }
+
+  EXPECT_SUCCESS(clEnqueueUnmapMemObject(command_queue, inMem, map, 0, nullptr,
+                                         &unMapEvent));
+  EXPECT_SUCCESS(clWaitForEvents(1, &unMapEvent));
+}
+
+TEST_F(clEnqueueMapBufferTestHostPtr, ReadSubBufferHostPtr) {
+  // Sub-buffers of an unaligned host_ptr start at the same offset from it as
+  // from the buffer.
+  const size_t origin = getDeviceMemBaseAddrAlign() / 8;
+  const cl_buffer_region region = {origin, int_size - origin};
+  cl_int errcode = !CL_SUCCESS;
+  cl_mem sub_buffer = clCreateSubBuffer(inMem, 0, CL_BUFFER_CREATE_TYPE_REGION,
+                                        &region, &errcode);
+  ASSERT_SUCCESS(errcode);
+
+  EXPECT_SUCCESS(clEnqueueReadBuffer(command_queue, sub_buffer, CL_TRUE, 0,
+                                     region.size, outBuffer.data(), 0, nullptr,
+                                     nullptr));
+  const cl_int first = static_cast<cl_int>(origin / sizeof(cl_int));
+  for (cl_int i = 0; i < static_cast<cl_int>(region.size / sizeof(cl_int));
+       i++) {
+    EXPECT_EQ(first + i, outBuffer[i]);
+  }
+  EXPECT_SUCCESS(clReleaseMemObject(sub_buffer));
+}
+
 TEST_F(clEnqueueMapBufferTest, DefaultWriteInvalidateBlocking) {
   cl_int errcode = !CL_SUCCESS;
   int *const map = static_cast<int *>(clEnqueueMapBuffer(
@@ -14,6 +14,10 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include "Common.h"
 
 class clEnqueueMapImageTestBase : public ucl::CommandQueueTest {
@@ -809,3 +813,221 @@ TEST_F(clEnqueueMapImageNegativeTest2dArray, InvalidSlicePitch) {
 TEST_F(clEnqueueMapImageNegativeTest3d, InvalidSlicePitch) {
   InvalidSlicePitchTestBody();
 }
+
+// Maps of disjoint rows of an image which share tiles, on devices which tile
+// images in memory, must not clobber each other when flushed.
+class clEnqueueMapImageTiledTest : public ucl::CommandQueueTest {
+ public:
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(CommandQueueTest::SetUp());
+    if (!getDeviceImageSupport() ||
+        !UCL::isImageFormatSupported(context, {CL_MEM_READ_WRITE},
+                                     CL_MEM_OBJECT_IMAGE2D, image_format)) {
+      GTEST_SKIP();
+    }
+    cl_image_desc image_desc = {};
+    image_desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+    image_desc.image_width = width;
+    image_desc.image_height = height;
+    cl_int error = CL_SUCCESS;
+    image = clCreateImage(context, CL_MEM_READ_WRITE, &image_format,
+                          &image_desc, nullptr, &error);
+    ASSERT_SUCCESS(error);
+
+    // Start with every pixel holding its own coordinates.
+    std::vector<cl_uchar4> pixels(width * height);
+    for (size_t y = 0; y < height; y++) {
+      for (size_t x = 0; x < width; x++) {
+        pixels[(y * width) + x] = pixel(x, y, 0);
+      }
+    }
+    const size_t origin[3] = {0, 0, 0};
+    const size_t region[3] = {width, height, 1};
+    ASSERT_SUCCESS(clEnqueueWriteImage(command_queue, image, CL_TRUE, origin,
+                                       region, 0, 0, pixels.data(), 0,
+                                       nullptr, nullptr));
+  }
+
+  void TearDown() override {
+    if (image) {
+      EXPECT_SUCCESS(clReleaseMemObject(image));
+    }
+    CommandQueueTest::TearDown();
+  }
+
+  static cl_uchar4 pixel(size_t x, size_t y, cl_uchar tag) {
+    return {{static_cast<cl_uchar>(x), static_cast<cl_uchar>(y), tag, 0xFF}};
+  }
+
+  // Maps `rows` rows of the image starting at row `y`.
+  cl_uchar4 *mapRows(size_t y, size_t rows, cl_map_flags flags,
+                     size_t &row_pitch) {
+    const size_t origin[3] = {0, y, 0};
+    const size_t region[3] = {width, rows, 1};
+    cl_int error = CL_SUCCESS;
+    void *ptr = clEnqueueMapImage(command_queue, image, CL_TRUE, flags, origin,
+                                  region, &row_pitch, nullptr, 0, nullptr,
+                                  nullptr, &error);
+    EXPECT_SUCCESS(error);
+    return static_cast<cl_uchar4 *>(ptr);
+  }
+
+  static cl_uchar4 *row(cl_uchar4 *ptr, size_t y, size_t row_pitch) {
+    return reinterpret_cast<cl_uchar4 *>(reinterpret_cast<cl_uchar *>(ptr) +
+                                         (y * row_pitch));
+  }
+
+  // Fills the mapped rows with pixels tagged with `tag`.
+  static void fillRows(cl_uchar4 *ptr, size_t y, size_t rows, size_t row_pitch,
+                       cl_uchar tag) {
+    for (size_t r = 0; r < rows; r++) {
+      for (size_t x = 0; x < width; x++) {
+        row(ptr, r, row_pitch)[x] = pixel(x, y + r, tag);
+      }
+    }
+  }
+
+  void unmap(void *ptr) {
+    ASSERT_SUCCESS(clEnqueueUnmapMemObject(command_queue, image, ptr, 0,
+                                           nullptr, nullptr));
+  }
+
+  // Checks every pixel of the image holds its coordinates and the tag the
+  // rows it is in were filled with.
+  void checkImage(cl_uchar top_tag, cl_uchar bottom_tag) {
+    std::vector<cl_uchar4> pixels(width * height);
+    const size_t origin[3] = {0, 0, 0};
+    const size_t region[3] = {width, height, 1};
+    ASSERT_SUCCESS(clEnqueueReadImage(command_queue, image, CL_TRUE, origin,
+                                      region, 0, 0, pixels.data(), 0, nullptr,
+                                      nullptr));
+    for (size_t y = 0; y < height; y++) {
+      for (size_t x = 0; x < width; x++) {
+        const cl_uchar4 expected =
+            pixel(x, y, y < split ? top_tag : bottom_tag);
+        const cl_uchar4 &actual = pixels[(y * width) + x];
+        ASSERT_EQ(0, std::memcmp(&expected, &actual, sizeof(cl_uchar4)))
+            << "pixel (" << x << ", " << y << ")";
+      }
+    }
+  }
+
+  // Neither dimension is a multiple of the tile size, and the rows either
+  // side of `split` are in the same tiles.
+  static constexpr size_t width = 21;
+  static constexpr size_t height = 13;
+  static constexpr size_t split = 5;
+  const cl_image_format image_format = {CL_RGBA, CL_UNSIGNED_INT8};
+  cl_mem image = nullptr;
+};
+
+TEST_F(clEnqueueMapImageTiledTest, DisjointWriteMappings) {
+  size_t top_pitch = 0;
+  cl_uchar4 *top = mapRows(0, split, CL_MAP_WRITE, top_pitch);
+  ASSERT_NE(nullptr, top);
+  fillRows(top, 0, split, top_pitch, 1);
+
+  // Mapping the bottom rows must not overwrite what was written to the top.
+  size_t bottom_pitch = 0;
+  cl_uchar4 *bottom =
+      mapRows(split, height - split, CL_MAP_WRITE, bottom_pitch);
+  ASSERT_NE(nullptr, bottom);
+  fillRows(bottom, split, height - split, bottom_pitch, 2);
+
+  ASSERT_NO_FATAL_FAILURE(unmap(bottom));
+  ASSERT_NO_FATAL_FAILURE(unmap(top));
+  ASSERT_NO_FATAL_FAILURE(checkImage(1, 2));
+}
+
+TEST_F(clEnqueueMapImageTiledTest, ReadMappingSharingTiles) {
+  size_t top_pitch = 0;
+  cl_uchar4 *top = mapRows(0, split, CL_MAP_WRITE, top_pitch);
+  ASSERT_NE(nullptr, top);
+  fillRows(top, 0, split, top_pitch, 3);
+
+  // The bottom rows still hold the original pixels.
+  size_t bottom_pitch = 0;
+  cl_uchar4 *bottom = mapRows(split, height - split, CL_MAP_READ, bottom_pitch);
+  ASSERT_NE(nullptr, bottom);
+  for (size_t r = 0; r < height - split; r++) {
+    for (size_t x = 0; x < width; x++) {
+      const cl_uchar4 expected = pixel(x, split + r, 0);
+      ASSERT_EQ(0, std::memcmp(&expected, &row(bottom, r, bottom_pitch)[x],
+                               sizeof(cl_uchar4)));
+    }
+  }
+
+  // Releasing the read mapping first must not lose the top rows either.
+  ASSERT_NO_FATAL_FAILURE(unmap(bottom));
+  ASSERT_NO_FATAL_FAILURE(unmap(top));
+  ASSERT_NO_FATAL_FAILURE(checkImage(3, 0));
+}
+
+TEST_F(clEnqueueMapImageTiledTest, SampleAfterUnmap) {
+  if (!getDeviceCompilerAvailable()) {
+    GTEST_SKIP();
+  }
+  size_t top_pitch = 0;
+  cl_uchar4 *top = mapRows(0, split, CL_MAP_WRITE, top_pitch);
+  ASSERT_NE(nullptr, top);
+  fillRows(top, 0, split, top_pitch, 4);
+  size_t bottom_pitch = 0;
+  cl_uchar4 *bottom =
+      mapRows(split, height - split, CL_MAP_WRITE, bottom_pitch);
+  ASSERT_NE(nullptr, bottom);
+  fillRows(bottom, split, height - split, bottom_pitch, 5);
+  ASSERT_NO_FATAL_FAILURE(unmap(top));
+  ASSERT_NO_FATAL_FAILURE(unmap(bottom));
+
+  // Sample one pixel beyond each edge so the clamped reads cross tiles too.
+  const char *source = R"(
+      const sampler_t sampler =
+          CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE |
+          CLK_FILTER_NEAREST;
+      kernel void sample(read_only image2d_t image, global uint4 *out) {
+        const int x = get_global_id(0);
+        const int y = get_global_id(1);
+        out[(y * get_global_size(0)) + x] =
+            read_imageui(image, sampler, (int2)(x - 1, y - 1));
+      })";
+  cl_int error = CL_SUCCESS;
+  cl_program program =
+      clCreateProgramWithSource(context, 1, &source, nullptr, &error);
+  ASSERT_SUCCESS(error);
+  ASSERT_SUCCESS(clBuildProgram(program, 1, &device, "", ucl::buildLogCallback,
+                                nullptr));
+  cl_kernel kernel = clCreateKernel(program, "sample", &error);
+  ASSERT_SUCCESS(error);
+
+  const size_t global[2] = {width + 2, height + 2};
+  cl_mem out = clCreateBuffer(context, CL_MEM_WRITE_ONLY,
+                              sizeof(cl_uint4) * global[0] * global[1],
+                              nullptr, &error);
+  ASSERT_SUCCESS(error);
+  ASSERT_SUCCESS(clSetKernelArg(kernel, 0, sizeof(cl_mem), &image));
+  ASSERT_SUCCESS(clSetKernelArg(kernel, 1, sizeof(cl_mem), &out));
+  ASSERT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 2, nullptr,
+                                        global, nullptr, 0, nullptr, nullptr));
+  std::vector<cl_uint4> results(global[0] * global[1]);
+  ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, out, CL_TRUE, 0,
+                                     sizeof(cl_uint4) * results.size(),
+                                     results.data(), 0, nullptr, nullptr));
+
+  for (size_t y = 0; y < global[1]; y++) {
+    for (size_t x = 0; x < global[0]; x++) {
+      const size_t image_x = std::min(std::max<size_t>(x, 1), width) - 1;
+      const size_t image_y = std::min(std::max<size_t>(y, 1), height) - 1;
+      const cl_uchar4 expected =
+          pixel(image_x, image_y, image_y < split ? 4 : 5);
+      const cl_uint4 &actual = results[(y * global[0]) + x];
+      for (size_t c = 0; c < 4; c++) {
+        ASSERT_EQ(expected.s[c], actual.s[c])
+            << "sample (" << x << ", " << y << ") channel " << c;
+      }
+    }
+  }
+
+  EXPECT_SUCCESS(clReleaseMemObject(out));
+  EXPECT_SUCCESS(clReleaseKernel(kernel));
+  EXPECT_SUCCESS(clReleaseProgram(program));
+}
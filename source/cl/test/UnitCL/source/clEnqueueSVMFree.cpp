@@ -50,3 +50,61 @@ TEST_F(clEnqueueSVMFreeTest, NotImplemented) {
                        pfn_free_func, user_data, num_events_in_wait_list,
                        event_wait_list, event));
 }
+
+TEST_F(clEnqueueSVMFreeTest, Default) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  void *svm_pointers[2] = {clSVMAlloc(context, CL_MEM_READ_WRITE, 256, 0),
+                           clSVMAlloc(context, CL_MEM_READ_WRITE, 512, 0)};
+  ASSERT_NE(nullptr, svm_pointers[0]);
+  ASSERT_NE(nullptr, svm_pointers[1]);
+  cl_event event{};
+  EXPECT_SUCCESS(clEnqueueSVMFree(command_queue, 2, svm_pointers, nullptr,
+                                  nullptr, 0, nullptr, &event));
+  EXPECT_SUCCESS(clWaitForEvents(1, &event));
+  cl_command_type type{};
+  EXPECT_SUCCESS(clGetEventInfo(event, CL_EVENT_COMMAND_TYPE, sizeof(type),
+                                &type, nullptr));
+  EXPECT_EQ(CL_COMMAND_SVM_FREE, type);
+  EXPECT_SUCCESS(clReleaseEvent(event));
+}
+
+TEST_F(clEnqueueSVMFreeTest, Callback) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  struct user_data_t {
+    cl_context context;
+    cl_uint num_svm_pointers;
+    void *svm_pointer;
+  } user_data = {context, 0, nullptr};
+  void *svm_pointers[1] = {clSVMAlloc(context, CL_MEM_READ_WRITE, 256, 0)};
+  ASSERT_NE(nullptr, svm_pointers[0]);
+  EXPECT_SUCCESS(clEnqueueSVMFree(
+      command_queue, 1, svm_pointers,
+      [](cl_command_queue, cl_uint num_svm_pointers, void *svm_pointers[],
+         void *user_data) {
+        auto data = static_cast<user_data_t *>(user_data);
+        data->num_svm_pointers = num_svm_pointers;
+        data->svm_pointer = svm_pointers[0];
+        clSVMFree(data->context, svm_pointers[0]);
+      },
+      &user_data, 0, nullptr, nullptr));
+  EXPECT_SUCCESS(clFinish(command_queue));
+  EXPECT_EQ(1, user_data.num_svm_pointers);
+  EXPECT_EQ(svm_pointers[0], user_data.svm_pointer);
+}
+
+TEST_F(clEnqueueSVMFreeTest, InvalidValue) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  void *svm_pointers[1] = {nullptr};
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clEnqueueSVMFree(command_queue, 0, svm_pointers, nullptr,
+                                     nullptr, 0, nullptr, nullptr));
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clEnqueueSVMFree(command_queue, 1, nullptr, nullptr,
+                                     nullptr, 0, nullptr, nullptr));
+}
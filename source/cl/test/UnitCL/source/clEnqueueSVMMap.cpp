@@ -14,6 +14,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cstring>
+
 #include "Common.h"
 
 class clEnqueueSVMMapTest : public ucl::CommandQueueTest {
@@ -48,3 +50,49 @@ TEST_F(clEnqueueSVMMapTest, NotImplemented) {
       clEnqueueSVMMap(command_queue, blocking_map, flags, svm_ptr, size,
                       num_events_in_wait_list, event_wait_list, event));
 }
+
+TEST_F(clEnqueueSVMMapTest, Default) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  const size_t size = 256;
+  void *svm_ptr = clSVMAlloc(context, CL_MEM_READ_WRITE, size, 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  cl_event event{};
+  EXPECT_SUCCESS(clEnqueueSVMMap(command_queue, CL_TRUE, CL_MAP_WRITE, svm_ptr,
+                                 size, 0, nullptr, &event));
+  std::memset(svm_ptr, 0x2a, size);
+  EXPECT_SUCCESS(clEnqueueSVMUnmap(command_queue, svm_ptr, 0, nullptr,
+                                   nullptr));
+  cl_command_type type{};
+  EXPECT_SUCCESS(clGetEventInfo(event, CL_EVENT_COMMAND_TYPE, sizeof(type),
+                                &type, nullptr));
+  EXPECT_EQ(CL_COMMAND_SVM_MAP, type);
+  EXPECT_SUCCESS(clReleaseEvent(event));
+
+  std::vector<unsigned char> output(size);
+  EXPECT_SUCCESS(clEnqueueSVMMemcpy(command_queue, CL_TRUE, output.data(),
+                                    svm_ptr, size, 0, nullptr, nullptr));
+  EXPECT_EQ(std::vector<unsigned char>(size, 0x2a), output);
+  clSVMFree(context, svm_ptr);
+}
+
+TEST_F(clEnqueueSVMMapTest, InvalidValue) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  void *svm_ptr = clSVMAlloc(context, CL_MEM_READ_WRITE, 256, 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clEnqueueSVMMap(command_queue, CL_TRUE, CL_MAP_READ,
+                                    nullptr, 256, 0, nullptr, nullptr));
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clEnqueueSVMMap(command_queue, CL_TRUE, CL_MAP_READ,
+                                    svm_ptr, 0, 0, nullptr, nullptr));
+  EXPECT_EQ_ERRCODE(
+      CL_INVALID_VALUE,
+      clEnqueueSVMMap(command_queue, CL_TRUE,
+                      CL_MAP_READ | CL_MAP_WRITE_INVALIDATE_REGION, svm_ptr,
+                      256, 0, nullptr, nullptr));
+  clSVMFree(context, svm_ptr);
+}
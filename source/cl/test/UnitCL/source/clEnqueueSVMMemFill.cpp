@@ -48,3 +48,39 @@ TEST_F(clEnqueueSVMMemFillTest, NotImplemented) {
       clEnqueueSVMMemFill(command_queue, svm_ptr, pattern, pattern_size, size,
                           num_events_in_wait_list, event_wait_list, event));
 }
+
+TEST_F(clEnqueueSVMMemFillTest, Default) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  const size_t count = 64;
+  void *svm_ptr =
+      clSVMAlloc(context, CL_MEM_READ_WRITE, count * sizeof(cl_int), 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  const cl_int pattern = 42;
+  EXPECT_SUCCESS(clEnqueueSVMMemFill(command_queue, svm_ptr, &pattern,
+                                     sizeof(pattern), count * sizeof(cl_int),
+                                     0, nullptr, nullptr));
+  std::vector<cl_int> output(count);
+  EXPECT_SUCCESS(clEnqueueSVMMemcpy(command_queue, CL_TRUE, output.data(),
+                                    svm_ptr, count * sizeof(cl_int), 0,
+                                    nullptr, nullptr));
+  EXPECT_EQ(std::vector<cl_int>(count, pattern), output);
+  clSVMFree(context, svm_ptr);
+}
+
+TEST_F(clEnqueueSVMMemFillTest, InvalidPatternSize) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  void *svm_ptr = clSVMAlloc(context, CL_MEM_READ_WRITE, 256, 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  const char pattern[3] = {1, 2, 3};
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clEnqueueSVMMemFill(command_queue, svm_ptr, pattern, 3, 96,
+                                        0, nullptr, nullptr));
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clEnqueueSVMMemFill(command_queue, svm_ptr, pattern, 0, 96,
+                                        0, nullptr, nullptr));
+  clSVMFree(context, svm_ptr);
+}
@@ -48,3 +48,52 @@ TEST_F(clEnqueueSVMMemcpyTest, NotImplemented) {
       clEnqueueSVMMemcpy(command_queue, blocking_copy, dst_ptr, src_ptr, size,
                          num_events_in_wait_list, event_wait_list, event));
 }
+
+TEST_F(clEnqueueSVMMemcpyTest, Default) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  const size_t count = 64;
+  void *src = clSVMAlloc(context, CL_MEM_READ_WRITE, count * sizeof(cl_int), 0);
+  void *dst = clSVMAlloc(context, CL_MEM_READ_WRITE, count * sizeof(cl_int), 0);
+  ASSERT_NE(nullptr, src);
+  ASSERT_NE(nullptr, dst);
+  std::vector<cl_int> input(count);
+  for (size_t index = 0; index < count; index++) {
+    input[index] = static_cast<cl_int>(index);
+  }
+  std::vector<cl_int> output(count, -1);
+
+  EXPECT_SUCCESS(clEnqueueSVMMemcpy(command_queue, CL_FALSE, src, input.data(),
+                                    count * sizeof(cl_int), 0, nullptr,
+                                    nullptr));
+  EXPECT_SUCCESS(clEnqueueSVMMemcpy(command_queue, CL_FALSE, dst, src,
+                                    count * sizeof(cl_int), 0, nullptr,
+                                    nullptr));
+  cl_event event{};
+  EXPECT_SUCCESS(clEnqueueSVMMemcpy(command_queue, CL_TRUE, output.data(), dst,
+                                    count * sizeof(cl_int), 0, nullptr,
+                                    &event));
+  EXPECT_EQ(input, output);
+  cl_command_type type{};
+  EXPECT_SUCCESS(clGetEventInfo(event, CL_EVENT_COMMAND_TYPE, sizeof(type),
+                                &type, nullptr));
+  EXPECT_EQ(CL_COMMAND_SVM_MEMCPY, type);
+  EXPECT_SUCCESS(clReleaseEvent(event));
+  clSVMFree(context, src);
+  clSVMFree(context, dst);
+}
+
+TEST_F(clEnqueueSVMMemcpyTest, Overlap) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  void *svm_ptr = clSVMAlloc(context, CL_MEM_READ_WRITE, 256, 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  EXPECT_EQ_ERRCODE(
+      CL_MEM_COPY_OVERLAP,
+      clEnqueueSVMMemcpy(command_queue, CL_TRUE, svm_ptr,
+                         static_cast<char *>(svm_ptr) + 64, 128, 0, nullptr,
+                         nullptr));
+  clSVMFree(context, svm_ptr);
+}
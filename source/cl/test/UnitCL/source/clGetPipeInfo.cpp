@@ -56,3 +56,94 @@ TEST_F(clGetPipeInfoTest, NotImplemented) {
                     clGetPipeInfo(buffer, param_name, param_value_size,
                                   param_value, param_value_size_ret));
 }
+
+class clGetPipeInfoPipeTest : public clGetPipeInfoTest {
+ protected:
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(clGetPipeInfoTest::SetUp());
+    cl_bool pipe_support{};
+    ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_PIPE_SUPPORT,
+                                   sizeof(pipe_support), &pipe_support,
+                                   nullptr));
+    if (CL_FALSE == pipe_support) {
+      GTEST_SKIP();
+    }
+    cl_int error{};
+    pipe = clCreatePipe(context, 0, packet_size, max_packets, nullptr, &error);
+    ASSERT_SUCCESS(error);
+    ASSERT_NE(nullptr, pipe);
+  }
+
+  void TearDown() override {
+    if (pipe) {
+      EXPECT_SUCCESS(clReleaseMemObject(pipe));
+    }
+    clGetPipeInfoTest::TearDown();
+  }
+
+  static constexpr cl_uint packet_size = 12;
+  static constexpr cl_uint max_packets = 7;
+  cl_mem pipe = nullptr;
+};
+
+TEST_F(clGetPipeInfoPipeTest, PacketSize) {
+  size_t size = 0;
+  ASSERT_SUCCESS(clGetPipeInfo(pipe, CL_PIPE_PACKET_SIZE, 0, nullptr, &size));
+  ASSERT_EQ(sizeof(cl_uint), size);
+  cl_uint value = 0;
+  ASSERT_SUCCESS(
+      clGetPipeInfo(pipe, CL_PIPE_PACKET_SIZE, size, &value, nullptr));
+  EXPECT_EQ(packet_size, value);
+}
+
+TEST_F(clGetPipeInfoPipeTest, MaxPackets) {
+  size_t size = 0;
+  ASSERT_SUCCESS(clGetPipeInfo(pipe, CL_PIPE_MAX_PACKETS, 0, nullptr, &size));
+  ASSERT_EQ(sizeof(cl_uint), size);
+  // The pipe's capacity is rounded up internally, but it still reports the
+  // number of packets it was created with.
+  cl_uint value = 0;
+  ASSERT_SUCCESS(
+      clGetPipeInfo(pipe, CL_PIPE_MAX_PACKETS, size, &value, nullptr));
+  EXPECT_EQ(max_packets, value);
+}
+
+TEST_F(clGetPipeInfoPipeTest, Properties) {
+  size_t size = 1;
+  ASSERT_SUCCESS(clGetPipeInfo(pipe, CL_PIPE_PROPERTIES, 0, nullptr, &size));
+  EXPECT_EQ(0u, size);
+}
+
+TEST_F(clGetPipeInfoPipeTest, InvalidMemObject) {
+  cl_uint value = 0;
+  EXPECT_EQ_ERRCODE(CL_INVALID_MEM_OBJECT,
+                    clGetPipeInfo(nullptr, CL_PIPE_PACKET_SIZE, sizeof(value),
+                                  &value, nullptr));
+  // Buffers aren't pipes.
+  EXPECT_EQ_ERRCODE(CL_INVALID_MEM_OBJECT,
+                    clGetPipeInfo(buffer, CL_PIPE_PACKET_SIZE, sizeof(value),
+                                  &value, nullptr));
+}
+
+TEST_F(clGetPipeInfoPipeTest, InvalidValueParamName) {
+  cl_uint value = 0;
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clGetPipeInfo(pipe, CL_MEM_SIZE, sizeof(value), &value,
+                                  nullptr));
+}
+
+TEST_F(clGetPipeInfoPipeTest, InvalidValueParamSize) {
+  cl_uint value = 0;
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clGetPipeInfo(pipe, CL_PIPE_PACKET_SIZE, sizeof(value) - 1,
+                                  &value, nullptr));
+}
+
+TEST_F(clGetPipeInfoPipeTest, InvalidMemObjectSubBuffer) {
+  // A pipe can't be used as a buffer either.
+  const cl_buffer_region region = {0, 4};
+  cl_int error = CL_SUCCESS;
+  EXPECT_EQ(nullptr, clCreateSubBuffer(pipe, 0, CL_BUFFER_CREATE_TYPE_REGION,
+                                       &region, &error));
+  EXPECT_EQ_ERRCODE(CL_INVALID_MEM_OBJECT, error);
+}
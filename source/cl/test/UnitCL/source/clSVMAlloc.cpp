@@ -14,6 +14,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cstring>
+
 #include "Common.h"
 
 class clSVMAllocTest : public ucl::ContextTest {
@@ -41,3 +43,81 @@ TEST_F(clSVMAllocTest, NotImplemented) {
   const cl_uint alignment{};
   EXPECT_EQ(nullptr, clSVMAlloc(context, flags, size, alignment));
 }
+
+TEST_F(clSVMAllocTest, Default) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  const size_t size = 256;
+  void *svm_ptr = clSVMAlloc(context, CL_MEM_READ_WRITE, size, 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  clSVMFree(context, svm_ptr);
+}
+
+TEST_F(clSVMAllocTest, Alignment) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  const cl_uint alignment = 64;
+  void *svm_ptr = clSVMAlloc(context, CL_MEM_READ_WRITE, 256, alignment);
+  ASSERT_NE(nullptr, svm_ptr);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(svm_ptr) % alignment);
+  clSVMFree(context, svm_ptr);
+}
+
+TEST_F(clSVMAllocTest, FineGrainBuffer) {
+  const cl_device_svm_capabilities svm_capabilities =
+      getDeviceSvmCapabilities();
+  if (0 == (svm_capabilities & CL_DEVICE_SVM_FINE_GRAIN_BUFFER)) {
+    GTEST_SKIP();
+  }
+  const size_t size = 256;
+  cl_svm_mem_flags flags = CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER;
+  if (svm_capabilities & CL_DEVICE_SVM_ATOMICS) {
+    flags |= CL_MEM_SVM_ATOMICS;
+  }
+  void *svm_ptr = clSVMAlloc(context, flags, size, 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  // Fine-grained allocations can be accessed by the host without mapping.
+  std::memset(svm_ptr, 0x2a, size);
+  EXPECT_EQ(0x2a, static_cast<unsigned char *>(svm_ptr)[size - 1]);
+  clSVMFree(context, svm_ptr);
+}
+
+TEST_F(clSVMAllocTest, InvalidFlags) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  EXPECT_EQ(nullptr, clSVMAlloc(context, CL_MEM_READ_ONLY | CL_MEM_WRITE_ONLY,
+                                256, 0));
+  EXPECT_EQ(nullptr, clSVMAlloc(context, CL_MEM_USE_HOST_PTR, 256, 0));
+  EXPECT_EQ(nullptr, clSVMAlloc(context, CL_MEM_SVM_ATOMICS, 256, 0));
+}
+
+TEST_F(clSVMAllocTest, AtomicsUnsupported) {
+  const cl_device_svm_capabilities svm_capabilities =
+      getDeviceSvmCapabilities();
+  if (0 == (svm_capabilities & CL_DEVICE_SVM_FINE_GRAIN_BUFFER) ||
+      (svm_capabilities & CL_DEVICE_SVM_ATOMICS)) {
+    GTEST_SKIP();
+  }
+  EXPECT_EQ(nullptr,
+            clSVMAlloc(context,
+                       CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER |
+                           CL_MEM_SVM_ATOMICS,
+                       256, 0));
+}
+
+TEST_F(clSVMAllocTest, InvalidSize) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  EXPECT_EQ(nullptr, clSVMAlloc(context, CL_MEM_READ_WRITE, 0, 0));
+}
+
+TEST_F(clSVMAllocTest, InvalidAlignment) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  EXPECT_EQ(nullptr, clSVMAlloc(context, CL_MEM_READ_WRITE, 256, 3));
+}
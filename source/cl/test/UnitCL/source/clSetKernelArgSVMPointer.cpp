@@ -74,3 +74,58 @@ TEST_F(clSetKernelArgSVMPointerTest, NotImplemented) {
   EXPECT_EQ_ERRCODE(CL_INVALID_OPERATION,
                     clSetKernelArgSVMPointer(kernel, arg_index, arg_value));
 }
+
+TEST_F(clSetKernelArgSVMPointerTest, Default) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  const size_t global_size = 64;
+  void *svm_ptr =
+      clSVMAlloc(context, CL_MEM_READ_WRITE, global_size * sizeof(cl_int), 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  EXPECT_SUCCESS(clSetKernelArgSVMPointer(kernel, 0, svm_ptr));
+
+  cl_int error{};
+  cl_command_queue command_queue =
+      clCreateCommandQueue(context, device, 0, &error);
+  ASSERT_SUCCESS(error);
+  EXPECT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 1, nullptr,
+                                        &global_size, nullptr, 0, nullptr,
+                                        nullptr));
+  EXPECT_SUCCESS(clEnqueueSVMMap(command_queue, CL_TRUE, CL_MAP_READ, svm_ptr,
+                                 global_size * sizeof(cl_int), 0, nullptr,
+                                 nullptr));
+  // The kernel wrote straight to the SVM allocation, nothing was copied.
+  const cl_int *results = static_cast<const cl_int *>(svm_ptr);
+  for (size_t index = 0; index < global_size; index++) {
+    EXPECT_EQ(static_cast<cl_int>(index), results[index]);
+  }
+  EXPECT_SUCCESS(clEnqueueSVMUnmap(command_queue, svm_ptr, 0, nullptr,
+                                   nullptr));
+  EXPECT_SUCCESS(clFinish(command_queue));
+  EXPECT_SUCCESS(clReleaseCommandQueue(command_queue));
+  clSVMFree(context, svm_ptr);
+}
+
+TEST_F(clSetKernelArgSVMPointerTest, Offset) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  void *svm_ptr = clSVMAlloc(context, CL_MEM_READ_WRITE, 256, 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  // Any pointer within an SVM allocation is a valid argument.
+  EXPECT_SUCCESS(clSetKernelArgSVMPointer(
+      kernel, 0, static_cast<cl_int *>(svm_ptr) + 4));
+  clSVMFree(context, svm_ptr);
+}
+
+TEST_F(clSetKernelArgSVMPointerTest, InvalidArgIndex) {
+  if (0 == getDeviceSvmCapabilities()) {
+    GTEST_SKIP();
+  }
+  void *svm_ptr = clSVMAlloc(context, CL_MEM_READ_WRITE, 256, 0);
+  ASSERT_NE(nullptr, svm_ptr);
+  EXPECT_EQ_ERRCODE(CL_INVALID_ARG_INDEX,
+                    clSetKernelArgSVMPointer(kernel, 1, svm_ptr));
+  clSVMFree(context, svm_ptr);
+}
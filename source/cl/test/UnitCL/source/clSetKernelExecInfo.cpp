@@ -76,6 +76,22 @@ TEST_F(clSetKernelExecInfoTest, InvalidOperation) {
                           sizeof(param_value), &param_value));
 }
 
+TEST_F(clSetKernelExecInfoTest, InvalidOperationSVMPointers) {
+  cl_device_svm_capabilities svm_capabilities;
+  clGetDeviceInfo(device, CL_DEVICE_SVM_CAPABILITIES, sizeof(svm_capabilities),
+                  &svm_capabilities, nullptr);
+  if (svm_capabilities != 0) {
+    GTEST_SKIP();
+  }
+
+  // Any pointer will do, it is never dereferenced.
+  void *svm_ptr = &param_value;
+  EXPECT_EQ_ERRCODE(
+      CL_INVALID_OPERATION,
+      clSetKernelExecInfo(kernel, CL_KERNEL_EXEC_INFO_SVM_PTRS,
+                          sizeof(svm_ptr), &svm_ptr));
+}
+
 TEST_F(clSetKernelExecInfoTest, InvalidKernel) {
   EXPECT_EQ_ERRCODE(
       CL_INVALID_KERNEL,
@@ -561,3 +561,49 @@ TEST_F(clSetProgramSpecializationConstantSuccessTest, All) {
     ASSERT_EQ(halfValue, halfResult);  // SpecId: 8
   }
 }
+
+// Rebuilding the same SPIR-V binary specializes the translation cached by the
+// first build, so each build must see the constants set before it.
+TEST_F(clSetProgramSpecializationConstantSuccessTest, Rebuild) {
+  ASSERT_SUCCESS(
+      clBuildProgram(program, 1, &device, "", ucl::buildLogCallback, nullptr));
+  cl_int error;
+  kernel = clCreateKernel(program, "test", &error);
+  ASSERT_SUCCESS(error);
+  UCL_RETURN_ON_FATAL_FAILURE(getResults());
+  ASSERT_EQ(cl_int(23), intResult);    // SpecId: 4
+  ASSERT_EQ(cl_long(23), longResult);  // SpecId: 5
+  ASSERT_SUCCESS(clReleaseKernel(kernel));
+  kernel = nullptr;
+
+  for (const cl_int intValue : {42, -7}) {
+    ASSERT_SUCCESS(clSetProgramSpecializationConstant(
+        program, 4, sizeof(intValue), &intValue));
+    ASSERT_SUCCESS(clBuildProgram(program, 1, &device, "",
+                                  ucl::buildLogCallback, nullptr));
+    kernel = clCreateKernel(program, "test", &error);
+    ASSERT_SUCCESS(error);
+    UCL_RETURN_ON_FATAL_FAILURE(getResults());
+    ASSERT_EQ(true, boolResults[0]);          // SpecId: 0
+    ASSERT_EQ(false, boolResults[1]);         // SpecId: 1
+    ASSERT_EQ(cl_char(23), charResult);       // SpecId: 2
+    ASSERT_EQ(cl_short(23), shortResult);     // SpecId: 3
+    ASSERT_EQ(intValue, intResult);           // SpecId: 4
+    ASSERT_EQ(cl_long(23), longResult);       // SpecId: 5
+    ASSERT_EQ(cl_float(23.0f), floatResult);  // SpecId: 6
+    ASSERT_SUCCESS(clReleaseKernel(kernel));
+    kernel = nullptr;
+  }
+
+  // Constants set earlier keep their values across rebuilds.
+  const cl_long longValue = 42;
+  ASSERT_SUCCESS(clSetProgramSpecializationConstant(
+      program, 5, sizeof(longValue), &longValue));
+  ASSERT_SUCCESS(
+      clBuildProgram(program, 1, &device, "", ucl::buildLogCallback, nullptr));
+  kernel = clCreateKernel(program, "test", &error);
+  ASSERT_SUCCESS(error);
+  UCL_RETURN_ON_FATAL_FAILURE(getResults());
+  ASSERT_EQ(cl_int(-7), intResult);  // SpecId: 4
+  ASSERT_EQ(longValue, longResult);  // SpecId: 5
+}
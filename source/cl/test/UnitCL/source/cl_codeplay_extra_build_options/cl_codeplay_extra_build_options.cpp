@@ -14,6 +14,10 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <CL/cl_ext_codeplay.h>
+
+#include <string>
+
 #include "Common.h"
 
 class cl_codeplay_extra_build_options_BuildFlags : public ucl::ContextTest {
@@ -121,6 +125,80 @@ TEST_F(cl_codeplay_extra_build_options_BuildFlags,
   EXPECT_SUCCESS(clReleaseCommandQueue(command_queue));
 }
 
+TEST_F(cl_codeplay_extra_build_options_BuildFlags,
+       clBuildFromBinaryAndRunPrecacheLocalSizes) {
+  ASSERT_SUCCESS(clBuildProgram(program, 0, nullptr,
+                                "-cl-precache-local-sizes=4,2:8", nullptr,
+                                nullptr));
+
+  // Devices which can't compile at enqueue time from a binary compile the
+  // precached local sizes into it, so run a program created from the binary.
+  size_t binary_size = 0;
+  ASSERT_SUCCESS(clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES,
+                                  sizeof(size_t), &binary_size, nullptr));
+  UCL::vector<unsigned char> binary(binary_size);
+  unsigned char *binary_data = binary.data();
+  ASSERT_SUCCESS(clGetProgramInfo(program, CL_PROGRAM_BINARIES,
+                                  sizeof(unsigned char *), &binary_data,
+                                  nullptr));
+  const unsigned char *const_binary_data = binary_data;
+  cl_int errorcode = CL_SUCCESS;
+  cl_program binary_program =
+      clCreateProgramWithBinary(context, 1, &device, &binary_size,
+                                &const_binary_data, nullptr, &errorcode);
+  ASSERT_TRUE(nullptr != binary_program);
+  ASSERT_SUCCESS(errorcode);
+  ASSERT_SUCCESS(
+      clBuildProgram(binary_program, 0, nullptr, nullptr, nullptr, nullptr));
+
+  cl_kernel kernel = clCreateKernel(binary_program, "foo", &errorcode);
+  ASSERT_SUCCESS(errorcode);
+
+  const cl_int input = 42;
+  cl_mem in_buffer =
+      clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                     sizeof(cl_int), const_cast<cl_int *>(&input), &errorcode);
+  ASSERT_TRUE(nullptr != in_buffer);
+  EXPECT_SUCCESS(errorcode);
+
+  cl_mem out_buffer = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(cl_int),
+                                     nullptr, &errorcode);
+  ASSERT_TRUE(nullptr != out_buffer);
+  EXPECT_SUCCESS(errorcode);
+
+  EXPECT_SUCCESS(clSetKernelArg(kernel, 0, sizeof(cl_mem),
+                                static_cast<void *>(&out_buffer)));
+  EXPECT_SUCCESS(clSetKernelArg(kernel, 1, sizeof(cl_mem),
+                                static_cast<void *>(&in_buffer)));
+
+  cl_command_queue command_queue =
+      clCreateCommandQueue(context, device, 0, &errorcode);
+  ASSERT_TRUE(nullptr != command_queue);
+  EXPECT_SUCCESS(errorcode);
+
+  // One ND-range with a precached local size and one without.
+  const size_t global_size[2] = {8, 4};
+  const size_t local_size[2] = {4, 2};
+  ASSERT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 2, nullptr,
+                                        global_size, local_size, 0, nullptr,
+                                        nullptr));
+  const size_t other_local_size[2] = {2, 2};
+  ASSERT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 2, nullptr,
+                                        global_size, other_local_size, 0,
+                                        nullptr, nullptr));
+  cl_int output = 0;
+  ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, out_buffer, CL_TRUE, 0,
+                                     sizeof(cl_int), &output, 0, nullptr,
+                                     nullptr));
+  EXPECT_EQ(input, output);
+
+  EXPECT_SUCCESS(clReleaseKernel(kernel));
+  EXPECT_SUCCESS(clReleaseMemObject(in_buffer));
+  EXPECT_SUCCESS(clReleaseMemObject(out_buffer));
+  EXPECT_SUCCESS(clReleaseCommandQueue(command_queue));
+  EXPECT_SUCCESS(clReleaseProgram(binary_program));
+}
+
 TEST_F(cl_codeplay_extra_build_options_BuildFlags,
        clBuildPrecacheLocalSizesInvalid) {
   // Local work group sizes only support up to three dimensions.
@@ -149,6 +227,32 @@ TEST_F(cl_codeplay_extra_build_options_BuildFlags,
                      nullptr, nullptr));
 }
 
+TEST_F(cl_codeplay_extra_build_options_BuildFlags, clGetBuildTelemetry) {
+  if (UCL::isInterceptLayerPresent()) {
+    GTEST_SKIP();  // Injection creates programs from binaries, no telemetry.
+  }
+  ASSERT_SUCCESS(clBuildProgram(program, 0, nullptr, "", nullptr, nullptr));
+
+  size_t size = 0;
+  ASSERT_SUCCESS(clGetProgramBuildInfo(program, device,
+                                       CL_PROGRAM_BUILD_TELEMETRY_CODEPLAY, 0,
+                                       nullptr, &size));
+  ASSERT_LT(0u, size);
+  std::string telemetry(size, '\0');
+  ASSERT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clGetProgramBuildInfo(program, device,
+                                          CL_PROGRAM_BUILD_TELEMETRY_CODEPLAY,
+                                          size - 1, telemetry.data(), nullptr));
+  ASSERT_SUCCESS(clGetProgramBuildInfo(program, device,
+                                       CL_PROGRAM_BUILD_TELEMETRY_CODEPLAY,
+                                       size, telemetry.data(), nullptr));
+  EXPECT_EQ('\0', telemetry.back());
+  EXPECT_EQ('{', telemetry.front());
+  EXPECT_NE(std::string::npos, telemetry.find("\"phases\""));
+  EXPECT_NE(std::string::npos, telemetry.find("\"passes\""));
+  EXPECT_NE(std::string::npos, telemetry.find("\"clang-codegen\""));
+}
+
 // Disabled because this test sets the global variable `Enabled`
 // from llvm::Statistics to true which causes later vecz runs to have
 // Statistics printed, which we don't want to unless explicitely asked.
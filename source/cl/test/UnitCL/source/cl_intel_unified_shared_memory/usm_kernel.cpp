@@ -719,6 +719,29 @@ TEST_F(USMVectorAddKernelTest, RepeatedEnqueue) {
   verifyOutputBuffer(half_elements, patternB, patternB);
 }
 
+// Tests writing to a device USM allocation from a kernel, then copying it back
+// without waiting for the kernel first. The copy must see the kernel's writes
+// even though the allocation isn't passed to the kernel as a buffer.
+TEST_F(USMVectorAddKernelTest, WriteThenReadBack) {
+  ASSERT_SUCCESS(clSetKernelArgMemPointerINTEL(kernel, 0, device_ptr));
+  ASSERT_SUCCESS(clSetKernelArgMemPointerINTEL(kernel, 1, device_ptrB));
+  ASSERT_SUCCESS(clSetKernelArgMemPointerINTEL(kernel, 2, device_ptrB));
+
+  ASSERT_SUCCESS(clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &elements,
+                                        nullptr, 0, nullptr, nullptr));
+
+  cargo::small_vector<cl_int, 64> output;
+  ASSERT_EQ(cargo::success, output.resize(elements));
+  ASSERT_SUCCESS(clEnqueueMemcpyINTEL(queue, CL_TRUE, output.data(),
+                                      device_ptrB, bytes, 0, nullptr,
+                                      nullptr));
+
+  for (size_t i = 0; i < elements; i++) {
+    const cl_int reference = patternA + patternB + i;
+    ASSERT_EQ(output[i], reference) << " index " << i;
+  }
+}
+
 #ifdef CL_VERSION_3_0
 // Tests interaction with `clCloneKernel()`
 TEST_F(USMVectorAddKernelTest, ClonedKernel) {
@@ -0,0 +1,141 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <CL/cl_ext_codeplay.h>
+#include <Common.h>
+
+#include <set>
+#include <vector>
+
+#include "cl_intel_unified_shared_memory.h"
+
+namespace {
+// Fixture for testing sub-allocation of small USM allocations from the
+// context's pools.
+struct USMPoolTest : public cl_intel_unified_shared_memory_Test {
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(cl_intel_unified_shared_memory_Test::SetUp());
+
+    cl_int err;
+    queue = clCreateCommandQueue(context, device, 0, &err);
+    ASSERT_TRUE(queue != nullptr);
+    ASSERT_SUCCESS(err);
+  }
+
+  void TearDown() override {
+    if (queue) {
+      EXPECT_SUCCESS(clReleaseCommandQueue(queue));
+    }
+    cl_intel_unified_shared_memory_Test::TearDown();
+  }
+
+  cl_usm_pool_stats_codeplay getStats() {
+    cl_usm_pool_stats_codeplay stats = {};
+    EXPECT_SUCCESS(clGetContextInfo(context,
+                                    CL_CONTEXT_USM_POOL_STATS_CODEPLAY,
+                                    sizeof(stats), &stats, nullptr));
+    return stats;
+  }
+
+  cl_command_queue queue = nullptr;
+};
+}  // namespace
+
+TEST_F(USMPoolTest, StatsQuerySize) {
+  size_t size = 0;
+  ASSERT_SUCCESS(clGetContextInfo(context, CL_CONTEXT_USM_POOL_STATS_CODEPLAY,
+                                  0, nullptr, &size));
+  EXPECT_EQ(sizeof(cl_usm_pool_stats_codeplay), size);
+
+  cl_usm_pool_stats_codeplay stats;
+  EXPECT_EQ_ERRCODE(
+      CL_INVALID_VALUE,
+      clGetContextInfo(context, CL_CONTEXT_USM_POOL_STATS_CODEPLAY,
+                       sizeof(stats) - 1, &stats, nullptr));
+}
+
+TEST_F(USMPoolTest, DeviceAllocReused) {
+  const size_t bytes = 64;
+  cl_int err;
+  void *first = clDeviceMemAllocINTEL(context, device, nullptr, bytes, 0, &err);
+  ASSERT_SUCCESS(err);
+  ASSERT_NE(nullptr, first);
+
+  const cl_usm_pool_stats_codeplay before = getStats();
+  if (0 == before.slab_count) {
+    // Pooling has been disabled through the environment.
+    ASSERT_SUCCESS(clMemBlockingFreeINTEL(context, first));
+    GTEST_SKIP();
+  }
+  EXPECT_LE(bytes, before.used_bytes);
+  EXPECT_LE(before.used_bytes, before.reserved_bytes);
+
+  ASSERT_SUCCESS(clMemBlockingFreeINTEL(context, first));
+
+  // With no commands in flight the slot is recycled immediately.
+  void *second =
+      clDeviceMemAllocINTEL(context, device, nullptr, bytes, 0, &err);
+  ASSERT_SUCCESS(err);
+  EXPECT_EQ(first, second);
+
+  const cl_usm_pool_stats_codeplay after = getStats();
+  EXPECT_EQ(before.slab_count, after.slab_count);
+  EXPECT_EQ(before.hit_count + 1, after.hit_count);
+  EXPECT_EQ(0u, after.pending_bytes);
+
+  ASSERT_SUCCESS(clMemBlockingFreeINTEL(context, second));
+}
+
+TEST_F(USMPoolTest, DistinctLiveAllocations) {
+  const size_t bytes = 100;
+  const size_t count = 64;
+  std::vector<cl_uint> pattern(bytes / sizeof(cl_uint));
+
+  std::set<void *> pointers;
+  std::vector<void *> allocations;
+  for (size_t i = 0; i < count; i++) {
+    cl_int err;
+    void *ptr = clDeviceMemAllocINTEL(context, device, nullptr, bytes,
+                                      sizeof(cl_uint), &err);
+    ASSERT_SUCCESS(err);
+    ASSERT_NE(nullptr, ptr);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(ptr) % sizeof(cl_uint));
+    allocations.push_back(ptr);
+    pointers.insert(ptr);
+
+    // Fill each allocation with a distinct value so overlapping slots would
+    // be detected when reading back.
+    const cl_uint value = static_cast<cl_uint>(i);
+    ASSERT_SUCCESS(clEnqueueMemFillINTEL(queue, ptr, &value, sizeof(value),
+                                         pattern.size() * sizeof(cl_uint), 0,
+                                         nullptr, nullptr));
+  }
+  EXPECT_EQ(count, pointers.size());
+
+  for (size_t i = 0; i < count; i++) {
+    ASSERT_SUCCESS(clEnqueueMemcpyINTEL(queue, CL_TRUE, pattern.data(),
+                                        allocations[i],
+                                        pattern.size() * sizeof(cl_uint), 0,
+                                        nullptr, nullptr));
+    for (auto value : pattern) {
+      EXPECT_EQ(static_cast<cl_uint>(i), value);
+    }
+  }
+
+  for (auto ptr : allocations) {
+    EXPECT_SUCCESS(clMemBlockingFreeINTEL(context, ptr));
+  }
+}
@@ -0,0 +1,322 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "cl_khr_command_buffer.h"
+
+// Consecutive ND-ranges in a command-buffer are fused into a single kernel
+// when CA_COMMAND_BUFFER_FUSION is set, these tests check the results are the
+// same as when each ND-range is executed in turn, whether or not the
+// ND-ranges could be fused.
+struct CommandBufferFusionTest : cl_khr_command_buffer_Test {
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(cl_khr_command_buffer_Test::SetUp());
+    if (!getDeviceCompilerAvailable()) {
+      GTEST_SKIP();
+    }
+
+    const char *code = R"OpenCLC(
+kernel void add_one(global const int *in, global int *out) {
+  size_t id = get_global_id(0);
+  out[id] = in[id] + 1;
+}
+
+kernel void twice(global const int *in, global int *out) {
+  size_t id = get_global_id(0);
+  out[id] = in[id] * 2;
+}
+
+kernel void next(global const int *in, global int *out) {
+  size_t id = get_global_id(0);
+  out[id] = in[id + 1];
+}
+
+kernel void reverse(global const int *in, global int *out) {
+  local int tmp[16];
+  size_t lid = get_local_id(0);
+  tmp[lid] = in[get_global_id(0)];
+  barrier(CLK_LOCAL_MEM_FENCE);
+  out[get_global_id(0)] = tmp[get_local_size(0) - lid - 1];
+}
+)OpenCLC";
+    const size_t code_length = std::strlen(code);
+    cl_int error = CL_SUCCESS;
+    program =
+        clCreateProgramWithSource(context, 1, &code, &code_length, &error);
+    ASSERT_SUCCESS(error);
+    ASSERT_SUCCESS(
+        clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr));
+    for (auto [kernel, name] : {std::pair{&add_one, "add_one"},
+                                std::pair{&twice, "twice"},
+                                std::pair{&next, "next"},
+                                std::pair{&reverse, "reverse"}}) {
+      *kernel = clCreateKernel(program, name, &error);
+      ASSERT_SUCCESS(error);
+    }
+
+    command_buffer =
+        clCreateCommandBufferKHR(1, &command_queue, nullptr, &error);
+    ASSERT_SUCCESS(error);
+  }
+
+  void TearDown() override {
+    for (cl_mem buffer : buffers) {
+      EXPECT_SUCCESS(clReleaseMemObject(buffer));
+    }
+    if (command_buffer) {
+      EXPECT_SUCCESS(clReleaseCommandBufferKHR(command_buffer));
+    }
+    for (cl_kernel kernel : {add_one, twice, next, reverse}) {
+      if (kernel) {
+        EXPECT_SUCCESS(clReleaseKernel(kernel));
+      }
+    }
+    if (program) {
+      EXPECT_SUCCESS(clReleaseProgram(program));
+    }
+    cl_khr_command_buffer_Test::TearDown();
+  }
+
+  /// @brief Creates a buffer of `size` elements holding 0, 1, 2, ...
+  cl_mem createBuffer(size_t size) {
+    std::vector<cl_int> data(size);
+    std::iota(data.begin(), data.end(), 0);
+    cl_int error = CL_SUCCESS;
+    cl_mem buffer =
+        clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                       size * sizeof(cl_int), data.data(), &error);
+    EXPECT_SUCCESS(error);
+    buffers.push_back(buffer);
+    return buffer;
+  }
+
+  /// @brief Records an ND-range of `kernel` reading `in` and writing `out`.
+  cl_int command(cl_kernel kernel, cl_mem in, cl_mem out,
+                 const size_t *local_size = nullptr,
+                 cl_uint num_sync_points = 0,
+                 const cl_sync_point_khr *wait_list = nullptr,
+                 cl_sync_point_khr *sync_point = nullptr) {
+    if (auto error = clSetKernelArg(kernel, 0, sizeof(cl_mem), &in)) {
+      return error;
+    }
+    if (auto error = clSetKernelArg(kernel, 1, sizeof(cl_mem), &out)) {
+      return error;
+    }
+    return clCommandNDRangeKernelKHR(command_buffer, nullptr, nullptr, kernel,
+                                     1, nullptr, &global_size, local_size,
+                                     num_sync_points, wait_list, sync_point,
+                                     nullptr);
+  }
+
+  /// @brief Finalizes and enqueues the command-buffer, then reads a buffer.
+  std::vector<cl_int> run(cl_mem buffer) {
+    std::vector<cl_int> result(global_size);
+    EXPECT_SUCCESS(clFinalizeCommandBufferKHR(command_buffer));
+    EXPECT_SUCCESS(clEnqueueCommandBufferKHR(0, nullptr, command_buffer, 0,
+                                             nullptr, nullptr));
+    EXPECT_SUCCESS(clEnqueueReadBuffer(command_queue, buffer, CL_TRUE, 0,
+                                       global_size * sizeof(cl_int),
+                                       result.data(), 0, nullptr, nullptr));
+    return result;
+  }
+
+  static constexpr size_t global_size = 64;
+  cl_program program = nullptr;
+  cl_kernel add_one = nullptr;
+  cl_kernel twice = nullptr;
+  cl_kernel next = nullptr;
+  cl_kernel reverse = nullptr;
+  cl_command_buffer_khr command_buffer = nullptr;
+  std::vector<cl_mem> buffers;
+};
+
+TEST_F(CommandBufferFusionTest, ProducerConsumer) {
+  cl_mem a = createBuffer(global_size);
+  cl_mem b = createBuffer(global_size);
+  cl_mem c = createBuffer(global_size);
+  cl_mem d = createBuffer(global_size);
+  ASSERT_SUCCESS(command(add_one, a, b));
+  ASSERT_SUCCESS(command(twice, b, c));
+  // The same kernel with different arguments.
+  ASSERT_SUCCESS(command(add_one, c, d));
+
+  const auto result = run(d);
+  for (size_t i = 0; i < global_size; i++) {
+    ASSERT_EQ(cl_int((i + 1) * 2 + 1), result[i]) << "at index " << i;
+  }
+}
+
+TEST_F(CommandBufferFusionTest, InPlace) {
+  cl_mem a = createBuffer(global_size);
+  ASSERT_SUCCESS(command(add_one, a, a));
+  ASSERT_SUCCESS(command(twice, a, a));
+
+  const auto result = run(a);
+  for (size_t i = 0; i < global_size; i++) {
+    ASSERT_EQ(cl_int((i + 1) * 2), result[i]) << "at index " << i;
+  }
+}
+
+TEST_F(CommandBufferFusionTest, ReadAfterWriteNotElementwise) {
+  // Work-item i reads the element work-item i + 1 wrote, so the ND-ranges
+  // can't be fused and are recorded as they were.
+  cl_mem a = createBuffer(global_size + 1);
+  cl_mem b = createBuffer(global_size + 1);
+  cl_mem c = createBuffer(global_size);
+  ASSERT_SUCCESS(command(add_one, a, b));
+  ASSERT_SUCCESS(command(next, b, c));
+
+  const auto result = run(c);
+  for (size_t i = 0; i + 1 < global_size; i++) {
+    ASSERT_EQ(cl_int(i + 2), result[i]) << "at index " << i;
+  }
+  // The last element of b isn't written.
+  ASSERT_EQ(cl_int(global_size), result[global_size - 1]);
+}
+
+TEST_F(CommandBufferFusionTest, WriteAfterReadNotElementwise) {
+  // Work-item i + 1 writes the element work-item i read.
+  cl_mem a = createBuffer(global_size + 1);
+  cl_mem b = createBuffer(global_size);
+  cl_mem c = createBuffer(global_size);
+  ASSERT_SUCCESS(command(next, a, b));
+  ASSERT_SUCCESS(command(twice, c, a));
+
+  const auto result = run(b);
+  for (size_t i = 0; i < global_size; i++) {
+    ASSERT_EQ(cl_int(i + 1), result[i]) << "at index " << i;
+  }
+}
+
+TEST_F(CommandBufferFusionTest, SubBuffers) {
+  // The sub-buffer's element i is the parent buffer's element i + offset,
+  // which another work-item writes, the compiler can't see that so the
+  // ND-ranges mustn't be fused.
+  cl_uint align_bits = 0;
+  ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_MEM_BASE_ADDR_ALIGN,
+                                 sizeof(align_bits), &align_bits, nullptr));
+  const size_t offset = align_bits / 8 / sizeof(cl_int);
+  ASSERT_NE(0u, offset);
+
+  cl_mem a = createBuffer(global_size + offset);
+  cl_mem b = createBuffer(global_size + offset);
+  cl_mem c = createBuffer(global_size);
+  const cl_buffer_region region = {offset * sizeof(cl_int),
+                                   global_size * sizeof(cl_int)};
+  cl_int error = CL_SUCCESS;
+  cl_mem sub_b = clCreateSubBuffer(b, CL_MEM_READ_WRITE,
+                                   CL_BUFFER_CREATE_TYPE_REGION, &region,
+                                   &error);
+  ASSERT_SUCCESS(error);
+  buffers.push_back(sub_b);
+  ASSERT_SUCCESS(command(add_one, a, b));
+  ASSERT_SUCCESS(command(twice, sub_b, c));
+
+  const auto result = run(c);
+  for (size_t i = 0; i < global_size; i++) {
+    // Only the first global_size elements of b are written.
+    const size_t element = i + offset;
+    const size_t expected = element < global_size ? element + 1 : element;
+    ASSERT_EQ(cl_int(expected * 2), result[i]) << "at index " << i;
+  }
+}
+
+TEST_F(CommandBufferFusionTest, Barrier) {
+  // Work-items of the second ND-range synchronize through local memory.
+  cl_mem a = createBuffer(global_size);
+  cl_mem b = createBuffer(global_size);
+  cl_mem c = createBuffer(global_size);
+  const size_t local_size = 16;
+  ASSERT_SUCCESS(command(add_one, a, b, &local_size));
+  ASSERT_SUCCESS(command(reverse, b, c, &local_size));
+
+  const auto result = run(c);
+  for (size_t i = 0; i < global_size; i++) {
+    const size_t group = i / local_size;
+    const size_t reversed =
+        group * local_size + (local_size - i % local_size - 1);
+    ASSERT_EQ(cl_int(reversed + 1), result[i]) << "at index " << i;
+  }
+}
+
+TEST_F(CommandBufferFusionTest, DifferentLocalSizes) {
+  cl_mem a = createBuffer(global_size);
+  cl_mem b = createBuffer(global_size);
+  cl_mem c = createBuffer(global_size);
+  const size_t local_sizes[] = {8, 16};
+  ASSERT_SUCCESS(command(add_one, a, b, &local_sizes[0]));
+  ASSERT_SUCCESS(command(twice, b, c, &local_sizes[1]));
+
+  const auto result = run(c);
+  for (size_t i = 0; i < global_size; i++) {
+    ASSERT_EQ(cl_int((i + 1) * 2), result[i]) << "at index " << i;
+  }
+}
+
+TEST_F(CommandBufferFusionTest, SyncPoints) {
+  // Sync-points of held back ND-ranges are only known once they are fused, and
+  // may be waited on by both ND-ranges which are fused with them and commands
+  // which aren't.
+  cl_mem a = createBuffer(global_size);
+  cl_mem b = createBuffer(global_size);
+  cl_mem c = createBuffer(global_size);
+  cl_mem d = createBuffer(global_size);
+  cl_sync_point_khr sync_points[3];
+  ASSERT_SUCCESS(command(add_one, a, b, nullptr, 0, nullptr, &sync_points[0]));
+  ASSERT_SUCCESS(
+      command(twice, b, c, nullptr, 1, &sync_points[0], &sync_points[1]));
+  ASSERT_SUCCESS(clCommandCopyBufferKHR(
+      command_buffer, nullptr, c, d, 0, 0, global_size * sizeof(cl_int), 2,
+      sync_points, &sync_points[2], nullptr));
+  ASSERT_SUCCESS(command(add_one, d, a, nullptr, 1, &sync_points[2]));
+
+  const auto result = run(a);
+  for (size_t i = 0; i < global_size; i++) {
+    ASSERT_EQ(cl_int((i + 1) * 2 + 1), result[i]) << "at index " << i;
+  }
+}
+
+TEST_F(CommandBufferFusionTest, InvalidSyncPoint) {
+  // A held back ND-range's sync-point isn't valid until it has been returned.
+  cl_mem a = createBuffer(global_size);
+  cl_mem b = createBuffer(global_size);
+  cl_sync_point_khr sync_point;
+  ASSERT_SUCCESS(command(add_one, a, b, nullptr, 0, nullptr, &sync_point));
+  const cl_sync_point_khr invalid = sync_point + 1;
+  ASSERT_EQ_ERRCODE(CL_INVALID_SYNC_POINT_WAIT_LIST_KHR,
+                    command(twice, b, a, nullptr, 1, &invalid));
+}
+
+TEST_F(CommandBufferFusionTest, Reenqueue) {
+  cl_mem a = createBuffer(global_size);
+  cl_mem b = createBuffer(global_size);
+  ASSERT_SUCCESS(command(add_one, a, b));
+  ASSERT_SUCCESS(command(add_one, b, a));
+
+  std::vector<cl_int> result = run(a);
+  ASSERT_SUCCESS(clEnqueueCommandBufferKHR(0, nullptr, command_buffer, 0,
+                                           nullptr, nullptr));
+  ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, a, CL_TRUE, 0,
+                                     global_size * sizeof(cl_int),
+                                     result.data(), 0, nullptr, nullptr));
+  for (size_t i = 0; i < global_size; i++) {
+    ASSERT_EQ(cl_int(i + 4), result[i]) << "at index " << i;
+  }
+}
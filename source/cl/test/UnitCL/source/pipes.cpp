@@ -0,0 +1,369 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "Common.h"
+
+namespace {
+const char *pipes_source = R"(
+kernel void producer(global const int *src, write_only pipe int out,
+                     global int *status) {
+  size_t id = get_global_id(0);
+  int value = src[id];
+  status[id] = write_pipe(out, &value);
+}
+
+kernel void consumer(read_only pipe int in, global int *dst,
+                     global int *status) {
+  size_t id = get_global_id(0);
+  int value = -1;
+  status[id] = read_pipe(in, &value);
+  dst[id] = value;
+}
+
+kernel void reserve_producer(global const int *src, write_only pipe int out,
+                             uint count, global int *valid) {
+  size_t id = get_global_id(0);
+  reserve_id_t rid = reserve_write_pipe(out, count);
+  valid[id] = is_valid_reserve_id(rid);
+  if (is_valid_reserve_id(rid)) {
+    for (uint i = 0; i < count; i++) {
+      int value = src[id * count + i];
+      write_pipe(out, rid, i, &value);
+    }
+    commit_write_pipe(out, rid);
+  }
+}
+
+kernel void reserve_consumer(read_only pipe int in, global int *dst,
+                             uint count, global int *valid) {
+  size_t id = get_global_id(0);
+  reserve_id_t rid = reserve_read_pipe(in, count);
+  valid[id] = is_valid_reserve_id(rid);
+  if (is_valid_reserve_id(rid)) {
+    for (uint i = 0; i < count; i++) {
+      int value;
+      read_pipe(in, rid, i, &value);
+      dst[id * count + i] = value;
+    }
+    commit_read_pipe(in, rid);
+  }
+}
+
+kernel void work_group_producer(global const int *src,
+                                write_only pipe int out) {
+  reserve_id_t rid = work_group_reserve_write_pipe(out, get_local_size(0));
+  if (is_valid_reserve_id(rid)) {
+    int value = src[get_global_id(0)];
+    write_pipe(out, rid, get_local_id(0), &value);
+    work_group_commit_write_pipe(out, rid);
+  }
+}
+
+kernel void work_group_consumer(read_only pipe int in, global int *dst) {
+  reserve_id_t rid = work_group_reserve_read_pipe(in, get_local_size(0));
+  int value = -1;
+  if (is_valid_reserve_id(rid)) {
+    read_pipe(in, rid, get_local_id(0), &value);
+    work_group_commit_read_pipe(in, rid);
+  }
+  dst[get_global_id(0)] = value;
+}
+
+kernel void query(read_only pipe int in, global uint *out) {
+  out[0] = get_pipe_num_packets(in);
+  out[1] = get_pipe_max_packets(in);
+}
+)";
+}  // namespace
+
+class PipeTest : public ucl::CommandQueueTest {
+ protected:
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(ucl::CommandQueueTest::SetUp());
+    if (!UCL::isDeviceVersionAtLeast({3, 0})) {
+      GTEST_SKIP();
+    }
+    // Requires a compiler to compile the kernels.
+    if (!getDeviceCompilerAvailable()) {
+      GTEST_SKIP();
+    }
+    cl_bool pipe_support = CL_FALSE;
+    ASSERT_SUCCESS(clGetDeviceInfo(device, CL_DEVICE_PIPE_SUPPORT,
+                                   sizeof(pipe_support), &pipe_support,
+                                   nullptr));
+    if (CL_FALSE == pipe_support) {
+      GTEST_SKIP();
+    }
+
+    const size_t length = std::strlen(pipes_source);
+    cl_int error{};
+    program =
+        clCreateProgramWithSource(context, 1, &pipes_source, &length, &error);
+    ASSERT_SUCCESS(error);
+    ASSERT_SUCCESS(clBuildProgram(program, 1, &device, "-cl-std=CL3.0",
+                                  ucl::buildLogCallback, nullptr));
+
+    src.resize(size);
+    std::iota(src.begin(), src.end(), 1);
+    src_buffer = createBuffer(CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                              src.data());
+    dst_buffer = createBuffer(CL_MEM_WRITE_ONLY, nullptr);
+    status_buffer = createBuffer(CL_MEM_READ_WRITE, nullptr);
+  }
+
+  void TearDown() override {
+    for (cl_kernel kernel : kernels) {
+      EXPECT_SUCCESS(clReleaseKernel(kernel));
+    }
+    for (cl_mem mem : {src_buffer, dst_buffer, status_buffer, pipe}) {
+      if (mem) {
+        EXPECT_SUCCESS(clReleaseMemObject(mem));
+      }
+    }
+    if (program) {
+      EXPECT_SUCCESS(clReleaseProgram(program));
+    }
+    ucl::CommandQueueTest::TearDown();
+  }
+
+  cl_mem createBuffer(cl_mem_flags flags, void *host_ptr) {
+    cl_int error{};
+    cl_mem buffer = clCreateBuffer(context, flags, size * sizeof(cl_int),
+                                   host_ptr, &error);
+    EXPECT_SUCCESS(error);
+    return buffer;
+  }
+
+  void createPipe(cl_uint max_packets) {
+    cl_int error{};
+    pipe = clCreatePipe(context, 0, sizeof(cl_int), max_packets, nullptr,
+                        &error);
+    ASSERT_SUCCESS(error);
+  }
+
+  cl_kernel createKernel(const char *name) {
+    cl_int error{};
+    cl_kernel kernel = clCreateKernel(program, name, &error);
+    EXPECT_SUCCESS(error);
+    kernels.push_back(kernel);
+    return kernel;
+  }
+
+  void run(cl_kernel kernel, size_t global_size, size_t local_size = 0) {
+    ASSERT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 1, nullptr,
+                                          &global_size,
+                                          local_size ? &local_size : nullptr,
+                                          0, nullptr, nullptr));
+  }
+
+  std::vector<cl_int> read(cl_mem buffer, size_t count) {
+    std::vector<cl_int> values(count);
+    EXPECT_SUCCESS(clEnqueueReadBuffer(command_queue, buffer, CL_TRUE, 0,
+                                       count * sizeof(cl_int), values.data(),
+                                       0, nullptr, nullptr));
+    return values;
+  }
+
+  static constexpr size_t size = 64;
+  cl_program program = nullptr;
+  std::vector<cl_kernel> kernels;
+  std::vector<cl_int> src;
+  cl_mem src_buffer = nullptr;
+  cl_mem dst_buffer = nullptr;
+  cl_mem status_buffer = nullptr;
+  cl_mem pipe = nullptr;
+};
+
+TEST_F(PipeTest, ProducerConsumer) {
+  ASSERT_NO_FATAL_FAILURE(createPipe(size));
+  cl_kernel producer = createKernel("producer");
+  cl_kernel consumer = createKernel("consumer");
+  ASSERT_SUCCESS(clSetKernelArg(producer, 0, sizeof(cl_mem), &src_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 1, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 2, sizeof(cl_mem), &status_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 0, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 1, sizeof(cl_mem), &dst_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 2, sizeof(cl_mem), &status_buffer));
+
+  run(producer, size);
+  for (const cl_int status : read(status_buffer, size)) {
+    EXPECT_EQ(0, status);
+  }
+  run(consumer, size);
+  for (const cl_int status : read(status_buffer, size)) {
+    EXPECT_EQ(0, status);
+  }
+  // Packets may be read in any order, but each exactly once.
+  auto dst = read(dst_buffer, size);
+  std::sort(dst.begin(), dst.end());
+  EXPECT_EQ(src, dst);
+
+  // The pipe is now empty.
+  run(consumer, size);
+  for (const cl_int status : read(status_buffer, size)) {
+    EXPECT_NE(0, status);
+  }
+}
+
+TEST_F(PipeTest, Full) {
+  const cl_uint max_packets = 10;
+  ASSERT_NO_FATAL_FAILURE(createPipe(max_packets));
+  cl_kernel producer = createKernel("producer");
+  cl_kernel consumer = createKernel("consumer");
+  ASSERT_SUCCESS(clSetKernelArg(producer, 0, sizeof(cl_mem), &src_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 1, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 2, sizeof(cl_mem), &status_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 0, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 1, sizeof(cl_mem), &dst_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 2, sizeof(cl_mem), &status_buffer));
+
+  // Writes fail once the pipe holds its maximum number of packets, even
+  // though its storage is rounded up.
+  run(producer, size);
+  auto status = read(status_buffer, size);
+  std::vector<cl_int> written;
+  for (size_t i = 0; i < size; i++) {
+    if (0 == status[i]) {
+      written.push_back(src[i]);
+    }
+  }
+  ASSERT_EQ(max_packets, written.size());
+
+  run(consumer, size);
+  status = read(status_buffer, size);
+  const auto dst = read(dst_buffer, size);
+  std::vector<cl_int> values;
+  for (size_t i = 0; i < size; i++) {
+    if (0 == status[i]) {
+      values.push_back(dst[i]);
+    }
+  }
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(written, values);
+}
+
+TEST_F(PipeTest, Reservations) {
+  const cl_uint count = 4;
+  const size_t items = size / count;
+  ASSERT_NO_FATAL_FAILURE(createPipe(size));
+  cl_kernel producer = createKernel("reserve_producer");
+  cl_kernel consumer = createKernel("reserve_consumer");
+  ASSERT_SUCCESS(clSetKernelArg(producer, 0, sizeof(cl_mem), &src_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 1, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 2, sizeof(cl_uint), &count));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 3, sizeof(cl_mem), &status_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 0, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 1, sizeof(cl_mem), &dst_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 2, sizeof(cl_uint), &count));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 3, sizeof(cl_mem), &status_buffer));
+
+  run(producer, items);
+  for (const cl_int valid : read(status_buffer, items)) {
+    EXPECT_NE(0, valid);
+  }
+  run(consumer, items);
+  for (const cl_int valid : read(status_buffer, items)) {
+    EXPECT_NE(0, valid);
+  }
+  // Each reservation is a contiguous run of packets, so each work-item reads
+  // back some other work-item's packets in order.
+  const auto dst = read(dst_buffer, size);
+  std::vector<cl_int> firsts;
+  for (size_t item = 0; item < items; item++) {
+    const cl_int first = dst[item * count];
+    EXPECT_EQ(1, first % count);
+    for (cl_uint i = 1; i < count; i++) {
+      EXPECT_EQ(first + cl_int(i), dst[item * count + i]);
+    }
+    firsts.push_back(first);
+  }
+  std::sort(firsts.begin(), firsts.end());
+  EXPECT_EQ(firsts.end(), std::adjacent_find(firsts.begin(), firsts.end()));
+
+  // Reading from the empty pipe can't reserve any packets.
+  run(consumer, items);
+  for (const cl_int valid : read(status_buffer, items)) {
+    EXPECT_EQ(0, valid);
+  }
+}
+
+TEST_F(PipeTest, ReservationTooLarge) {
+  const cl_uint max_packets = 8;
+  const cl_uint count = max_packets + 1;
+  ASSERT_NO_FATAL_FAILURE(createPipe(max_packets));
+  cl_kernel producer = createKernel("reserve_producer");
+  ASSERT_SUCCESS(clSetKernelArg(producer, 0, sizeof(cl_mem), &src_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 1, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 2, sizeof(cl_uint), &count));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 3, sizeof(cl_mem), &status_buffer));
+  run(producer, 1);
+  EXPECT_EQ(0, read(status_buffer, 1)[0]);
+}
+
+TEST_F(PipeTest, WorkGroupReservations) {
+  const size_t local_size = 8;
+  ASSERT_NO_FATAL_FAILURE(createPipe(size));
+  cl_kernel producer = createKernel("work_group_producer");
+  cl_kernel consumer = createKernel("work_group_consumer");
+  ASSERT_SUCCESS(clSetKernelArg(producer, 0, sizeof(cl_mem), &src_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 1, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 0, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(consumer, 1, sizeof(cl_mem), &dst_buffer));
+
+  run(producer, size, local_size);
+  run(consumer, size, local_size);
+  // Each work-group's packets are a contiguous run in the pipe, so each
+  // work-group reads back some other work-group's packets in order.
+  const auto dst = read(dst_buffer, size);
+  for (size_t group = 0; group < size / local_size; group++) {
+    const cl_int first = dst[group * local_size];
+    EXPECT_EQ(1, first % cl_int(local_size));
+    for (size_t i = 1; i < local_size; i++) {
+      EXPECT_EQ(first + cl_int(i), dst[group * local_size + i]);
+    }
+  }
+  auto sorted = dst;
+  std::sort(sorted.begin(), sorted.end());
+  EXPECT_EQ(src, sorted);
+}
+
+TEST_F(PipeTest, Query) {
+  const cl_uint max_packets = 48;
+  const size_t written = 20;
+  ASSERT_NO_FATAL_FAILURE(createPipe(max_packets));
+  cl_kernel producer = createKernel("producer");
+  cl_kernel query = createKernel("query");
+  ASSERT_SUCCESS(clSetKernelArg(producer, 0, sizeof(cl_mem), &src_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 1, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(producer, 2, sizeof(cl_mem), &status_buffer));
+  ASSERT_SUCCESS(clSetKernelArg(query, 0, sizeof(cl_mem), &pipe));
+  ASSERT_SUCCESS(clSetKernelArg(query, 1, sizeof(cl_mem), &dst_buffer));
+
+  run(query, 1);
+  auto dst = read(dst_buffer, 2);
+  EXPECT_EQ(0, dst[0]);
+  EXPECT_EQ(cl_int(max_packets), dst[1]);
+
+  run(producer, written);
+  run(query, 1);
+  dst = read(dst_buffer, 2);
+  EXPECT_EQ(cl_int(written), dst[0]);
+  EXPECT_EQ(cl_int(max_packets), dst[1]);
+}
@@ -14,7 +14,13 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "Common.h"
+#include "kts/stdout_capture.h"
 
 struct printfBuiltinTest : ucl::CommandQueueTest,
                            testing::WithParamInterface<const char *> {
@@ -229,3 +235,130 @@ INSTANTIATE_TEST_CASE_P(ValidKernels, printfBuiltinValidTest,
 
 INSTANTIATE_TEST_CASE_P(InvalidKernels, printfBuiltinInvalidTest,
                         ::testing::ValuesIn(invalid_kernels));
+
+// These tests also run with CA_PRINTF_STREAMING set, in which case the output
+// is drained from the printf buffer while the kernels are still running.
+struct printfStreamingTest : ucl::CommandQueueTest {
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(CommandQueueTest::SetUp());
+    if (!getDeviceCompilerAvailable()) {
+      GTEST_SKIP();
+    }
+    const char *source = R"(
+kernel void busy_printf(uint base, uint lines, uint spin) {
+  const uint id = base + get_global_id(0);
+  for (uint line = 0; line < lines; line++) {
+    // Keep the kernel running between calls so the buffer is polled while
+    // work-items are still printing.
+    volatile uint counter = 0;
+    for (uint i = 0; i < spin; i++) {
+      counter++;
+    }
+    printf("%u:%u\n", id, line);
+  }
+})";
+    cl_int error;
+    program = clCreateProgramWithSource(context, 1, &source, nullptr, &error);
+    ASSERT_SUCCESS(error);
+    ASSERT_SUCCESS(
+        clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr));
+    kernel = clCreateKernel(program, "busy_printf", &error);
+    ASSERT_SUCCESS(error);
+  }
+
+  void TearDown() override {
+    if (kernel) {
+      EXPECT_SUCCESS(clReleaseKernel(kernel));
+    }
+    if (program) {
+      EXPECT_SUCCESS(clReleaseProgram(program));
+    }
+    CommandQueueTest::TearDown();
+  }
+
+  void enqueue(cl_command_queue queue, cl_uint base, size_t work_items,
+               cl_uint lines, cl_uint spin) {
+    ASSERT_SUCCESS(clSetKernelArg(kernel, 0, sizeof(cl_uint), &base));
+    ASSERT_SUCCESS(clSetKernelArg(kernel, 1, sizeof(cl_uint), &lines));
+    ASSERT_SUCCESS(clSetKernelArg(kernel, 2, sizeof(cl_uint), &spin));
+    ASSERT_SUCCESS(clEnqueueNDRangeKernel(queue, kernel, 1, nullptr,
+                                          &work_items, nullptr, 0, nullptr,
+                                          nullptr));
+  }
+
+  // Work-items may print in any order relative to each other, but each
+  // work-item's lines must all be printed once and in order.
+  static void checkOutput(const std::string &output, cl_uint ids,
+                          cl_uint lines) {
+    std::vector<cl_uint> next_line(ids, 0);
+    std::istringstream stream(output);
+    std::string text;
+    while (std::getline(stream, text)) {
+      cl_uint id, line;
+      ASSERT_EQ(2, std::sscanf(text.c_str(), "%u:%u", &id, &line))
+          << "Unexpected output: " << text;
+      ASSERT_LT(id, ids);
+      ASSERT_EQ(next_line[id], line) << "Output of " << id << " out of order";
+      next_line[id]++;
+    }
+    for (cl_uint id = 0; id < ids; id++) {
+      EXPECT_EQ(lines, next_line[id]) << "Output of " << id << " incomplete";
+    }
+  }
+
+  cl_program program = nullptr;
+  cl_kernel kernel = nullptr;
+};
+
+TEST_F(printfStreamingTest, LongRunningKernel) {
+  constexpr cl_uint work_items = 8;
+  constexpr cl_uint lines = 256;
+  kts::StdoutCapture capture;
+  capture.CaptureStdout();
+  enqueue(command_queue, 0, work_items, lines, 10000);
+  EXPECT_SUCCESS(clFinish(command_queue));
+  capture.RestoreStdout();
+  checkOutput(capture.ReadBuffer(), work_items, lines);
+}
+
+TEST_F(printfStreamingTest, ReusedBuffers) {
+  // Printf buffers are returned to a pool and reused by later ND-ranges with a
+  // different number of work-groups, so each chunk header must be reset.
+  kts::StdoutCapture capture;
+  capture.CaptureStdout();
+  cl_uint base = 0;
+  for (const size_t work_items : {1, 16, 4, 16}) {
+    enqueue(command_queue, base, work_items, 8, 0);
+    EXPECT_SUCCESS(clFinish(command_queue));
+    base += static_cast<cl_uint>(work_items);
+  }
+  capture.RestoreStdout();
+  checkOutput(capture.ReadBuffer(), base, 8);
+}
+
+TEST_F(printfStreamingTest, MultipleQueues) {
+  constexpr cl_uint queue_count = 4;
+  constexpr cl_uint work_items = 4;
+  constexpr cl_uint lines = 64;
+  cl_command_queue queues[queue_count] = {};
+  for (auto &queue : queues) {
+    cl_int error;
+    queue = clCreateCommandQueue(context, device, 0, &error);
+    ASSERT_SUCCESS(error);
+  }
+
+  kts::StdoutCapture capture;
+  capture.CaptureStdout();
+  for (cl_uint index = 0; index < queue_count; index++) {
+    enqueue(queues[index], index * work_items, work_items, lines, 1000);
+  }
+  for (auto queue : queues) {
+    EXPECT_SUCCESS(clFinish(queue));
+  }
+  capture.RestoreStdout();
+  checkOutput(capture.ReadBuffer(), queue_count * work_items, lines);
+
+  for (auto queue : queues) {
+    EXPECT_SUCCESS(clReleaseCommandQueue(queue));
+  }
+}
@@ -0,0 +1,407 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/uxlfoundation/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common.h"
+
+// When CA_CL_PROGRAM_CACHE is set, programs built from the same source or IL
+// with the same options share one build. These tests check programs behave
+// the same whether or not their builds are shared.
+namespace {
+const char *value_source = R"(
+kernel void value(global int *out) {
+  out[get_global_id(0)] = VALUE;
+}
+)";
+
+const char *other_source = R"(
+kernel void value(global int *out) {
+  out[get_global_id(0)] = -VALUE;
+}
+)";
+}  // namespace
+
+struct ProgramCacheTest : ucl::CommandQueueTest {
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(ucl::CommandQueueTest::SetUp());
+    // Requires a compiler to compile the kernels.
+    if (!getDeviceCompilerAvailable()) {
+      GTEST_SKIP();
+    }
+  }
+
+  /// @brief Create a program from source and build it.
+  cl_program build(cl_context context, const char *options,
+                   const char *source = value_source) {
+    const size_t length = std::strlen(source);
+    cl_int error = CL_SUCCESS;
+    cl_program program =
+        clCreateProgramWithSource(context, 1, &source, &length, &error);
+    EXPECT_SUCCESS(error);
+    EXPECT_SUCCESS(clBuildProgram(program, 1, &device, options,
+                                  ucl::buildLogCallback, nullptr));
+    return program;
+  }
+
+  /// @brief Run the program's kernel and get the value it writes.
+  void run(cl_command_queue queue, cl_program program, cl_int &value) {
+    cl_context context = nullptr;
+    ASSERT_SUCCESS(clGetProgramInfo(program, CL_PROGRAM_CONTEXT,
+                                    sizeof(context), &context, nullptr));
+    cl_int error = CL_SUCCESS;
+    cl_kernel kernel = clCreateKernel(program, "value", &error);
+    ASSERT_SUCCESS(error);
+    cl_mem buffer = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(cl_int),
+                                   nullptr, &error);
+    EXPECT_SUCCESS(error);
+    EXPECT_SUCCESS(clSetKernelArg(kernel, 0, sizeof(buffer), &buffer));
+    const size_t global_size = 1;
+    EXPECT_SUCCESS(clEnqueueNDRangeKernel(queue, kernel, 1, nullptr,
+                                          &global_size, nullptr, 0, nullptr,
+                                          nullptr));
+    EXPECT_SUCCESS(clEnqueueReadBuffer(queue, buffer, CL_TRUE, 0,
+                                       sizeof(value), &value, 0, nullptr,
+                                       nullptr));
+    EXPECT_SUCCESS(clReleaseMemObject(buffer));
+    EXPECT_SUCCESS(clReleaseKernel(kernel));
+  }
+
+  /// @brief Check the program's build status, options and kernels.
+  void checkBuildInfo(cl_program program, const std::string &options) {
+    cl_build_status status = CL_BUILD_NONE;
+    ASSERT_SUCCESS(clGetProgramBuildInfo(program, device,
+                                         CL_PROGRAM_BUILD_STATUS,
+                                         sizeof(status), &status, nullptr));
+    EXPECT_EQ(CL_BUILD_SUCCESS, status);
+
+    size_t size = 0;
+    ASSERT_SUCCESS(clGetProgramBuildInfo(
+        program, device, CL_PROGRAM_BUILD_OPTIONS, 0, nullptr, &size));
+    std::string build_options(size, '\0');
+    ASSERT_SUCCESS(clGetProgramBuildInfo(program, device,
+                                         CL_PROGRAM_BUILD_OPTIONS, size,
+                                         build_options.data(), nullptr));
+    EXPECT_STREQ(options.c_str(), build_options.c_str());
+
+    ASSERT_SUCCESS(clGetProgramBuildInfo(program, device,
+                                         CL_PROGRAM_BUILD_LOG, 0, nullptr,
+                                         &size));
+    std::string log(size, '\0');
+    ASSERT_SUCCESS(clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG,
+                                         size, log.data(), nullptr));
+
+    ASSERT_SUCCESS(clGetProgramInfo(program, CL_PROGRAM_KERNEL_NAMES, 0,
+                                    nullptr, &size));
+    std::string names(size, '\0');
+    ASSERT_SUCCESS(clGetProgramInfo(program, CL_PROGRAM_KERNEL_NAMES, size,
+                                    names.data(), nullptr));
+    EXPECT_STREQ("value", names.c_str());
+  }
+};
+
+TEST_F(ProgramCacheTest, SameProgram) {
+  UCL::Program first = build(context, "-DVALUE=1");
+  UCL::Program second = build(context, "-DVALUE=1");
+  UCL_RETURN_ON_FATAL_FAILURE(checkBuildInfo(first, "-DVALUE=1"));
+  UCL_RETURN_ON_FATAL_FAILURE(checkBuildInfo(second, "-DVALUE=1"));
+
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, first, value));
+  EXPECT_EQ(1, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, second, value));
+  EXPECT_EQ(1, value);
+}
+
+TEST_F(ProgramCacheTest, DifferentContexts) {
+  cl_int error = CL_SUCCESS;
+  cl_context other_context =
+      clCreateContext(nullptr, 1, &device, nullptr, nullptr, &error);
+  ASSERT_SUCCESS(error);
+  cl_command_queue other_queue =
+      clCreateCommandQueue(other_context, device, 0, &error);
+  EXPECT_SUCCESS(error);
+
+  UCL::Program first = build(context, "-DVALUE=1");
+  UCL::Program second = build(other_context, "-DVALUE=1");
+  cl_int value = 0;
+  EXPECT_NO_FATAL_FAILURE(run(command_queue, first, value));
+  EXPECT_EQ(1, value);
+  EXPECT_NO_FATAL_FAILURE(run(other_queue, second, value));
+  EXPECT_EQ(1, value);
+
+  EXPECT_SUCCESS(clReleaseCommandQueue(other_queue));
+  EXPECT_SUCCESS(clReleaseContext(other_context));
+}
+
+TEST_F(ProgramCacheTest, DifferentOptions) {
+  UCL::Program first = build(context, "-DVALUE=1");
+  UCL::Program second = build(context, "-DVALUE=2");
+  UCL_RETURN_ON_FATAL_FAILURE(checkBuildInfo(second, "-DVALUE=2"));
+
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, first, value));
+  EXPECT_EQ(1, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, second, value));
+  EXPECT_EQ(2, value);
+}
+
+TEST_F(ProgramCacheTest, DifferentSource) {
+  UCL::Program first = build(context, "-DVALUE=1");
+  UCL::Program second = build(context, "-DVALUE=1", other_source);
+
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, first, value));
+  EXPECT_EQ(1, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, second, value));
+  EXPECT_EQ(-1, value);
+}
+
+TEST_F(ProgramCacheTest, Rebuild) {
+  UCL::Program first = build(context, "-DVALUE=1");
+  UCL::Program second = build(context, "-DVALUE=1");
+
+  // Rebuilding a program mustn't change the programs it shared a build with.
+  ASSERT_SUCCESS(clBuildProgram(second, 1, &device, "-DVALUE=3",
+                                ucl::buildLogCallback, nullptr));
+  UCL_RETURN_ON_FATAL_FAILURE(checkBuildInfo(second, "-DVALUE=3"));
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, second, value));
+  EXPECT_EQ(3, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, first, value));
+  EXPECT_EQ(1, value);
+
+  // Rebuild with the same options, then the original options again.
+  ASSERT_SUCCESS(clBuildProgram(second, 1, &device, "-DVALUE=3",
+                                ucl::buildLogCallback, nullptr));
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, second, value));
+  EXPECT_EQ(3, value);
+  ASSERT_SUCCESS(clBuildProgram(second, 1, &device, "-DVALUE=1",
+                                ucl::buildLogCallback, nullptr));
+  UCL_RETURN_ON_FATAL_FAILURE(checkBuildInfo(second, "-DVALUE=1"));
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, second, value));
+  EXPECT_EQ(1, value);
+
+  // The first program can be rebuilt too.
+  ASSERT_SUCCESS(clBuildProgram(first, 1, &device, "-DVALUE=4",
+                                ucl::buildLogCallback, nullptr));
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, first, value));
+  EXPECT_EQ(4, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, second, value));
+  EXPECT_EQ(1, value);
+}
+
+TEST_F(ProgramCacheTest, ReleaseFirst) {
+  // The program which built first and its context are released before the
+  // programs sharing its build.
+  cl_int error = CL_SUCCESS;
+  cl_context other_context =
+      clCreateContext(nullptr, 1, &device, nullptr, nullptr, &error);
+  ASSERT_SUCCESS(error);
+  cl_program first = build(other_context, "-DVALUE=1");
+  UCL::Program second = build(context, "-DVALUE=1");
+  EXPECT_SUCCESS(clReleaseProgram(first));
+  EXPECT_SUCCESS(clReleaseContext(other_context));
+
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, second, value));
+  EXPECT_EQ(1, value);
+  UCL::Program third = build(context, "-DVALUE=1");
+  UCL_RETURN_ON_FATAL_FAILURE(checkBuildInfo(third, "-DVALUE=1"));
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, third, value));
+  EXPECT_EQ(1, value);
+}
+
+TEST_F(ProgramCacheTest, ReleaseAll) {
+  // Once every program sharing a build is released, the next program builds
+  // again.
+  cl_program first = build(context, "-DVALUE=1");
+  cl_program second = build(context, "-DVALUE=1");
+  EXPECT_SUCCESS(clReleaseProgram(first));
+  EXPECT_SUCCESS(clReleaseProgram(second));
+
+  UCL::Program third = build(context, "-DVALUE=1");
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(command_queue, third, value));
+  EXPECT_EQ(1, value);
+}
+
+TEST_F(ProgramCacheTest, ConcurrentCreateKernel) {
+  constexpr size_t num_threads = 4;
+  constexpr size_t num_kernels = 16;
+  std::array<cl_program, num_threads> programs;
+  for (auto &program : programs) {
+    program = build(context, "-DVALUE=1");
+  }
+
+  std::array<cl_int, num_threads> errors;
+  errors.fill(CL_SUCCESS);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i] {
+      for (size_t k = 0; k < num_kernels && CL_SUCCESS == errors[i]; k++) {
+        cl_kernel kernel = clCreateKernel(programs[i], "value", &errors[i]);
+        if (kernel) {
+          errors[i] = clReleaseKernel(kernel);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < num_threads; i++) {
+    EXPECT_SUCCESS(errors[i]);
+    cl_int value = 0;
+    EXPECT_NO_FATAL_FAILURE(run(command_queue, programs[i], value));
+    EXPECT_EQ(1, value);
+    EXPECT_SUCCESS(clReleaseProgram(programs[i]));
+  }
+}
+
+// The clSetProgramSpecializationConstant.spv{32,64} binaries have a kernel
+// named "test" with a buffer argument for each type of specialization
+// constant, 32 bit integer constant 3 is written to the fourth argument.
+struct ProgramCacheILTest : ProgramCacheTest {
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(ProgramCacheTest::SetUp());
+    if (!UCL::isDeviceVersionAtLeast({3, 0})) {
+      GTEST_SKIP();
+    }
+    std::string name = "clSetProgramSpecializationConstant";
+    if (UCL::hasDeviceExtensionSupport(device, "cl_khr_fp64")) {
+      name += ".fp64";
+    }
+    if (UCL::hasDeviceExtensionSupport(device, "cl_khr_fp16")) {
+      name += ".fp16";
+    }
+    spirv = getDeviceSpirvFromFile(name);
+    ASSERT_FALSE(spirv.empty());
+  }
+
+  /// @brief Create a program from IL, specialize it and build it.
+  cl_program build(const std::vector<uint32_t> &il,
+                   const cl_int *spec_value = nullptr) {
+    cl_int error = CL_SUCCESS;
+    cl_program program = clCreateProgramWithIL(
+        context, il.data(), il.size() * sizeof(uint32_t), &error);
+    EXPECT_SUCCESS(error);
+    if (spec_value) {
+      EXPECT_SUCCESS(clSetProgramSpecializationConstant(
+          program, 3, sizeof(*spec_value), spec_value));
+    }
+    EXPECT_SUCCESS(clBuildProgram(program, 1, &device, "",
+                                  ucl::buildLogCallback, nullptr));
+    return program;
+  }
+
+  /// @brief Run the program's kernel and get the 32 bit integer constant.
+  void run(cl_program program, cl_int &value) {
+    cl_int error = CL_SUCCESS;
+    cl_kernel kernel = clCreateKernel(program, "test", &error);
+    ASSERT_SUCCESS(error);
+    cl_uint num_args = 0;
+    EXPECT_SUCCESS(clGetKernelInfo(kernel, CL_KERNEL_NUM_ARGS,
+                                   sizeof(num_args), &num_args, nullptr));
+    ASSERT_LT(3u, num_args);
+    // Every argument is a buffer large enough for any of the types.
+    std::vector<cl_mem> buffers(num_args);
+    for (cl_uint i = 0; i < num_args; i++) {
+      buffers[i] = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(cl_long),
+                                  nullptr, &error);
+      EXPECT_SUCCESS(error);
+      EXPECT_SUCCESS(clSetKernelArg(kernel, i, sizeof(cl_mem), &buffers[i]));
+    }
+    EXPECT_SUCCESS(clEnqueueTask(command_queue, kernel, 0, nullptr, nullptr));
+    EXPECT_SUCCESS(clEnqueueReadBuffer(command_queue, buffers[3], CL_TRUE, 0,
+                                       sizeof(value), &value, 0, nullptr,
+                                       nullptr));
+    for (cl_mem buffer : buffers) {
+      EXPECT_SUCCESS(clReleaseMemObject(buffer));
+    }
+    EXPECT_SUCCESS(clReleaseKernel(kernel));
+  }
+
+  /// @brief Change the default value of specialization constant 3.
+  static void setDefault(std::vector<uint32_t> &il, uint32_t value) {
+    constexpr uint32_t op_decorate = 71;
+    constexpr uint32_t op_spec_constant = 50;
+    constexpr uint32_t decoration_spec_id = 1;
+    // Instructions start after the five word header, with their word count in
+    // the upper and opcode in the lower half of their first word.
+    uint32_t id = 0;
+    for (size_t i = 5; i < il.size(); i += il[i] >> 16) {
+      const uint32_t opcode = il[i] & 0xffff;
+      if (op_decorate == opcode && decoration_spec_id == il[i + 2] &&
+          3 == il[i + 3]) {
+        id = il[i + 1];
+      } else if (op_spec_constant == opcode && id && id == il[i + 2]) {
+        il[i + 3] = value;
+        return;
+      }
+      if (0 == il[i] >> 16) {
+        break;
+      }
+    }
+    FAIL() << "Specialization constant 3 not found";
+  }
+
+  std::vector<uint32_t> spirv;
+};
+
+TEST_F(ProgramCacheILTest, SameIL) {
+  UCL::Program first = build(spirv);
+  UCL::Program second = build(spirv);
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(first, value));
+  EXPECT_EQ(23, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(second, value));
+  EXPECT_EQ(23, value);
+}
+
+TEST_F(ProgramCacheILTest, DifferentIL) {
+  std::vector<uint32_t> other = spirv;
+  UCL_RETURN_ON_FATAL_FAILURE(setDefault(other, 42));
+  UCL::Program first = build(spirv);
+  UCL::Program second = build(other);
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(first, value));
+  EXPECT_EQ(23, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(second, value));
+  EXPECT_EQ(42, value);
+}
+
+TEST_F(ProgramCacheILTest, DifferentSpecConstants) {
+  const cl_int values[] = {1, 2};
+  UCL::Program unspecialized = build(spirv);
+  UCL::Program first = build(spirv, &values[0]);
+  UCL::Program second = build(spirv, &values[1]);
+  UCL::Program third = build(spirv, &values[0]);
+  cl_int value = 0;
+  UCL_RETURN_ON_FATAL_FAILURE(run(unspecialized, value));
+  EXPECT_EQ(23, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(first, value));
+  EXPECT_EQ(1, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(second, value));
+  EXPECT_EQ(2, value);
+  UCL_RETURN_ON_FATAL_FAILURE(run(third, value));
+  EXPECT_EQ(1, value);
+}